@@ -24,6 +24,11 @@
 #include <sys/stat.h>
 
 #include "mx_osdef.h"
+
+#if defined( OS_WIN32 )
+#  include <io.h>
+#endif
+
 #include "mx_util.h"
 #include "mx_time.h"
 #include "mx_unistd.h"
@@ -34,6 +39,8 @@
 #include "mx_variable.h"
 #include "mx_socket.h"
 #include "mx_net.h"
+#include "mx_callback.h"
+#include "mx_vnet.h"
 #include "mx_syslog.h"
 
 #include "ms_autosave.h"
@@ -176,6 +183,7 @@ main( int argc, char *argv[] )
 	char autosave_list_filename[MXU_FILENAME_LENGTH+1];
 	char autosave1_filename[MXU_FILENAME_LENGTH+1];
 	char autosave2_filename[MXU_FILENAME_LENGTH+1];
+	char journal_filename[MXU_FILENAME_LENGTH+1];
 	char *autosave_filename;
 	char hostname[80];
 	char ident_string[100];
@@ -186,6 +194,7 @@ main( int argc, char *argv[] )
 	mx_bool_type wait_for_debugger, just_in_time_debugging;
 	mx_bool_type wait_at_exit;
 	mx_bool_type no_restore, restore_only, save_only;
+	mx_bool_type use_journal;
 	unsigned long network_debug_flags;
 	mx_status_type mx_status;
 
@@ -196,6 +205,7 @@ main( int argc, char *argv[] )
 "  -a             (enable network debugging summary)\n"
 "  -A             (enable verbose network debugging)\n"
 "  -d debug_level\n"
+"  -j journal_fn  (save changed values to a journal between autosaves)\n"
 "  -l log_number  (log to syslog)\n"
 "  -L log_number  (log to syslog and stderr)\n"
 "  -P display_precision\n"
@@ -245,12 +255,15 @@ main( int argc, char *argv[] )
 	restore_only = FALSE;
 	save_only = FALSE;
 
+	use_journal = FALSE;
+	journal_filename[0] = '\0';
+
 #if HAVE_GETOPT
 	/* Process command line arguments via getopt, if any. */
 
 	error_flag = FALSE;
 
-	while ((c = getopt(argc, argv, "aAd:DJl:L:P:RrsT:u:wWxY")) != -1 ) {
+	while ((c = getopt(argc, argv, "aAd:Dj:Jl:L:P:RrsT:u:wWxY")) != -1 ) {
 		switch(c) {
 		case 'a':
 			network_debug_flags |= MXF_NETDBG_SUMMARY;
@@ -264,6 +277,12 @@ main( int argc, char *argv[] )
 		case 'D':
 			start_debugger = TRUE;
 			break;
+		case 'j':
+			use_journal = TRUE;
+
+			strlcpy( journal_filename, optarg,
+					sizeof(journal_filename) );
+			break;
 		case 'J':
 			just_in_time_debugging = TRUE;
 			break;
@@ -554,7 +573,7 @@ main( int argc, char *argv[] )
 
 		mx_status = msauto_restore_fields_from_autosave_files(
 			autosave1_filename, autosave2_filename,
-			&autosave_list );
+			journal_filename, &autosave_list );
 
 		if ( mx_status.code != MXE_SUCCESS )
 			exit( (int) mx_status.code );
@@ -587,6 +606,17 @@ main( int argc, char *argv[] )
 		exit(0);
 	}
 
+	/* In journal mode, ask the servers to tell us when the saved
+	 * values change, rather than polling for them.
+	 */
+
+	if ( use_journal ) {
+		mx_status = msauto_add_autosave_callbacks( &autosave_list );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			exit( (int) mx_status.code );
+	}
+
 	/*********************** Loop forever *************************/
 
 	autosave_filename = autosave1_filename;
@@ -612,6 +642,17 @@ main( int argc, char *argv[] )
 			if ( mx_status.code == MXE_NETWORK_CONNECTION_LOST )
 				exit( (int) mx_status.code );
 
+			/* The new autosave file contains everything that
+			 * was in the journal, so start a new journal.
+			 */
+
+			if ( use_journal && ( mx_status.code == MXE_SUCCESS ) )
+			{
+				(void) msauto_start_autosave_journal(
+					journal_filename, autosave_filename,
+					&autosave_list );
+			}
+
 			if ( autosave_filename == autosave1_filename ) {
 				autosave_filename = autosave2_filename;
 			} else {
@@ -623,6 +664,20 @@ main( int argc, char *argv[] )
 						event_interval );
 		}
 
+		/* Append the values that have changed since the last
+		 * pass to the journal.
+		 */
+
+		if ( use_journal ) {
+			(void) mx_network_wait_for_messages( record_list, 0.0 );
+
+			mx_status = msauto_update_autosave_journal(
+							&autosave_list );
+
+			if ( mx_status.code == MXE_NETWORK_CONNECTION_LOST )
+				exit( (int) mx_status.code );
+		}
+
 		mx_msleep(10);
 
 		/* Check to see if the next event time for the given
@@ -1304,6 +1359,9 @@ msauto_add_to_autosave_list( MX_AUTOSAVE_LIST *autosave_list,
 
 	autosave_list_entry->write_function = write_function;
 
+	autosave_list_entry->value_changed_callback = NULL;
+	autosave_list_entry->value_changed = FALSE;
+
 	if ( write_function != NULL ) {
 		autosave_list_entry->write_value_field = NULL;
 		autosave_list_entry->write_value_pointer = NULL;
@@ -1388,6 +1446,9 @@ msauto_construct_autosave_list( MX_AUTOSAVE_LIST *autosave_list,
 
 	autosave_list->num_entries = 0;
 
+	autosave_list->journal_file = NULL;
+	autosave_list->journal_filename[0] = '\0';
+
 	autosave_list->entry_array = (MX_AUTOSAVE_LIST_ENTRY *)
 			malloc( MX_AUTOSAVE_ARRAY_BLOCK_SIZE
 				* sizeof(MX_AUTOSAVE_LIST_ENTRY) );
@@ -1641,6 +1702,13 @@ msauto_poll_autosave_list( MX_AUTOSAVE_LIST *autosave_list )
 
 		entry = &entry_array[i];
 
+		/* Entries with a value changed callback are kept up to date
+		 * by the server, so they do not need to be polled.
+		 */
+
+		if ( entry->value_changed_callback != NULL )
+			continue;
+
 		mx_status = mx_receive_variable( entry->read_record );
 
 		if ( mx_status.code != MXE_SUCCESS )
@@ -1649,6 +1717,83 @@ msauto_poll_autosave_list( MX_AUTOSAVE_LIST *autosave_list )
 	return MX_SUCCESSFUL_RESULT;
 }
 
+/* Forces the contents of an open file out to the disk. */
+
+static mx_status_type
+msauto_sync_file( FILE *file, char *filename )
+{
+	static const char fname[] = "msauto_sync_file()";
+
+	int result, saved_errno;
+
+	result = fflush( file );
+
+	if ( result == 0 ) {
+#if defined( OS_WIN32 )
+		result = _commit( _fileno( file ) );
+#else
+		result = fsync( fileno( file ) );
+#endif
+	}
+
+	if ( result != 0 ) {
+		saved_errno = errno;
+
+		return mx_error( MXE_FILE_IO_ERROR, fname,
+		"Could not flush the contents of file '%s' to disk.  "
+		"Errno = %d, error string = '%s'",
+			filename, saved_errno, strerror(saved_errno) );
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+static mx_status_type
+msauto_construct_value_string( MX_AUTOSAVE_LIST_ENTRY *autosave_list_entry,
+				char *buffer, size_t buffer_length )
+{
+	MX_RECORD_FIELD *value_field;
+	void *value_ptr;
+	mx_status_type mx_status;
+
+	buffer[0] = '\0';
+
+	value_field = autosave_list_entry->read_value_field;
+
+	value_ptr = autosave_list_entry->read_value_pointer;
+
+	if ( (value_field->num_dimensions == 0)
+	  || ((value_field->datatype == MXFT_STRING)
+	    && (value_field->num_dimensions == 1))) {
+
+		/* Single token */
+
+		mx_status = ( autosave_list_entry->token_constructor ) (
+				value_ptr,
+				buffer,
+				buffer_length,
+				autosave_list_entry->read_record,
+				value_field );
+	} else {
+		mx_status = mx_create_array_description(
+				value_ptr,
+				value_field->num_dimensions - 1,
+				buffer,
+				buffer_length,
+				autosave_list_entry->read_record,
+				value_field,
+				autosave_list_entry->token_constructor );
+	}
+
+	return mx_status;
+}
+
+/* The new contents of the autosave file are written to a temporary
+ * file which is then renamed on top of the old autosave file.  That
+ * way, the old autosave file is still intact if we crash while the
+ * new one is being written.
+ */
+
 mx_status_type
 msauto_save_fields_to_autosave_file( char *autosave_filename,
 			MX_AUTOSAVE_LIST *autosave_list )
@@ -1656,9 +1801,8 @@ msauto_save_fields_to_autosave_file( char *autosave_filename,
 	static const char fname[] = "msauto_save_fields_to_autosave_file()";
 
 	MX_AUTOSAVE_LIST_ENTRY *autosave_list_entry;
-	MX_RECORD_FIELD *value_field;
-	void *value_ptr;
 	FILE *autosave_file;
+	char temp_filename[MXU_FILENAME_LENGTH+1];
 	char buffer[500];
 	int saved_errno, result;
 	long i;
@@ -1667,39 +1811,33 @@ msauto_save_fields_to_autosave_file( char *autosave_filename,
 	MX_DEBUG( 1,("%s: saving fields to autosave file '%s'",
 		fname, autosave_filename));
 
+	/* Any changes reported to us from here on will be written
+	 * to the journal started after this autosave file.
+	 */
+
+	for ( i = 0; i < autosave_list->num_entries; i++ ) {
+		autosave_list->entry_array[i].value_changed = FALSE;
+	}
+
 	mx_status = msauto_poll_autosave_list( autosave_list );
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
-	/* Delete the previous version of the autosave file, if it exists. */
+	snprintf( temp_filename, sizeof(temp_filename),
+			"%s.tmp", autosave_filename );
 
-	result = remove( autosave_filename );
+	/* Open the temporary file for writing. */
 
-	if ( result != 0 ) {
-		saved_errno = errno;
-
-		if ( saved_errno != ENOENT ) {
-
-			(void) mx_error( MXE_FILE_IO_ERROR, fname,
-		"Error during attempt to delete old autosave file '%s'.  "
-		"Errno = %d, error string = '%s'",
-			autosave_filename, saved_errno,
-			strerror(saved_errno));
-		}
-	}
-
-	/* Open the autosave file for writing. */
-
-	autosave_file = fopen( autosave_filename, "w" );
+	autosave_file = fopen( temp_filename, "w" );
 
 	if ( autosave_file == NULL ) {
 		saved_errno = errno;
 
 		return mx_error( MXE_FILE_IO_ERROR, fname,
-		"Could not open the autosave file '%s' for writing.  "
+		"Could not open the temporary autosave file '%s' for writing.  "
 		"Errno = %d, error string = '%s'",
-			autosave_filename, saved_errno,
+			temp_filename, saved_errno,
 			strerror(saved_errno));
 	}
 
@@ -1718,37 +1856,12 @@ msauto_save_fields_to_autosave_file( char *autosave_filename,
 
 		fprintf( autosave_file, "%-s  ", buffer );
 
-		buffer[0] = '\0';
-
-		value_field = autosave_list_entry->read_value_field;
-
-		value_ptr = autosave_list_entry->read_value_pointer;
-
-		if ( (value_field->num_dimensions == 0)
-		  || ((value_field->datatype == MXFT_STRING)
-		    && (value_field->num_dimensions == 1))) {
-
-			/* Single token */
-
-			mx_status = ( autosave_list_entry->token_constructor ) (
-					value_ptr,
-					buffer,
-					sizeof(buffer),
-					autosave_list_entry->read_record,
-					value_field );
-		} else {
-			mx_status = mx_create_array_description(
-					value_ptr,
-					value_field->num_dimensions - 1,
-					buffer,
-					sizeof(buffer),
-					autosave_list_entry->read_record,
-					value_field,
-					autosave_list_entry->token_constructor );
-		}
+		mx_status = msauto_construct_value_string( autosave_list_entry,
+						buffer, sizeof(buffer) );
 
 		if ( mx_status.code != MXE_SUCCESS ) {
 			fclose( autosave_file );
+			(void) remove( temp_filename );
 
 			return mx_status;
 		}
@@ -1761,11 +1874,246 @@ msauto_save_fields_to_autosave_file( char *autosave_filename,
 	/* Write out a marker to indicate that this is the end of the file. */
 
 	fprintf( autosave_file, "********\n" );
+
+	mx_status = msauto_sync_file( autosave_file, temp_filename );
+
+	if ( ferror( autosave_file ) && ( mx_status.code == MXE_SUCCESS ) ) {
+		mx_status = mx_error( MXE_FILE_IO_ERROR, fname,
+		"An error occurred while writing temporary autosave file '%s'.",
+			temp_filename );
+	}
+
 	fclose( autosave_file );
 
+	if ( mx_status.code != MXE_SUCCESS ) {
+		(void) remove( temp_filename );
+
+		return mx_status;
+	}
+
+#if defined( OS_WIN32 )
+	/* On Windows, rename() will not replace an existing file. */
+
+	(void) remove( autosave_filename );
+#endif
+
+	result = rename( temp_filename, autosave_filename );
+
+	if ( result != 0 ) {
+		saved_errno = errno;
+
+		(void) remove( temp_filename );
+
+		return mx_error( MXE_FILE_IO_ERROR, fname,
+		"Could not rename temporary autosave file '%s' to '%s'.  "
+		"Errno = %d, error string = '%s'",
+			temp_filename, autosave_filename,
+			saved_errno, strerror(saved_errno) );
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*------------------------------------------------------------------*/
+
+static mx_status_type
+msauto_value_changed_callback( MX_CALLBACK *callback, void *argument )
+{
+	MX_AUTOSAVE_LIST_ENTRY *autosave_list_entry;
+
+	/* The new value has already been copied to the 'value' field
+	 * of the read record by mx_invoke_callback().
+	 */
+
+	autosave_list_entry = (MX_AUTOSAVE_LIST_ENTRY *) argument;
+
+	autosave_list_entry->value_changed = TRUE;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+mx_status_type
+msauto_add_autosave_callbacks( MX_AUTOSAVE_LIST *autosave_list )
+{
+	static const char fname[] = "msauto_add_autosave_callbacks()";
+
+	MX_AUTOSAVE_LIST_ENTRY *autosave_list_entry;
+	MX_NETWORK_VARIABLE *network_variable;
+	MX_NETWORK_FIELD *nf;
+	unsigned long num_callbacks;
+	long i;
+	mx_status_type mx_status;
+
+	num_callbacks = 0;
+
+	for ( i = 0; i < autosave_list->num_entries; i++ ) {
+		autosave_list_entry = &(autosave_list->entry_array)[i];
+
+		/* Only MX network variables support callbacks.
+		 * Everything else continues to be polled.
+		 */
+
+		if ( strcmp( autosave_list_entry->protocol_id, "mx" ) != 0 )
+			continue;
+
+		network_variable = (MX_NETWORK_VARIABLE *)
+			autosave_list_entry->read_record->record_class_struct;
+
+		if ( network_variable == (MX_NETWORK_VARIABLE *) NULL ) {
+			return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+			"The MX_NETWORK_VARIABLE pointer for record '%s' "
+			"is NULL.", autosave_list_entry->read_record->name );
+		}
+
+		nf = &(network_variable->value_nf);
+
+		/* Have the callback copy new values directly to the
+		 * 'value' field of the read record.
+		 */
+
+		nf->local_field = autosave_list_entry->read_value_field;
+
+		mx_status = mx_remote_field_add_callback( nf,
+				MXCBT_VALUE_CHANGED,
+				msauto_value_changed_callback,
+				autosave_list_entry,
+				&(autosave_list_entry->value_changed_callback) );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			nf->local_field = NULL;
+
+			autosave_list_entry->value_changed_callback = NULL;
+
+			if ( mx_status.code == MXE_NETWORK_CONNECTION_LOST )
+				return mx_status;
+
+			continue;
+		}
+
+		/* Entries with callbacks are not polled, so we must fetch
+		 * the starting value here.
+		 */
+
+		mx_status = mx_receive_variable(
+					autosave_list_entry->read_record );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		num_callbacks++;
+	}
+
+	mx_info( "%lu of %lu autosave entries will be journaled when "
+		"they change.  The rest will be polled.",
+		num_callbacks, autosave_list->num_entries );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* msauto_start_autosave_journal() replaces the current journal with
+ * an empty one that applies to the autosave file 'checkpoint_filename'.
+ */
+
+mx_status_type
+msauto_start_autosave_journal( char *journal_filename,
+				char *checkpoint_filename,
+				MX_AUTOSAVE_LIST *autosave_list )
+{
+	static const char fname[] = "msauto_start_autosave_journal()";
+
+	int saved_errno;
+	mx_status_type mx_status;
+
+	if ( autosave_list->journal_file != NULL ) {
+		(void) fclose( autosave_list->journal_file );
+
+		autosave_list->journal_file = NULL;
+	}
+
+	strlcpy( autosave_list->journal_filename, journal_filename,
+			sizeof(autosave_list->journal_filename) );
+
+	autosave_list->journal_file = fopen( journal_filename, "w" );
+
+	if ( autosave_list->journal_file == NULL ) {
+		saved_errno = errno;
+
+		return mx_error( MXE_FILE_IO_ERROR, fname,
+		"Could not open autosave journal '%s' for writing.  "
+		"Errno = %d, error string = '%s'",
+			journal_filename, saved_errno,
+			strerror(saved_errno) );
+	}
+
+	fprintf( autosave_list->journal_file, "%s %s\n",
+			MXAUTO_JOURNAL_HEADER, checkpoint_filename );
+
+	mx_status = msauto_sync_file( autosave_list->journal_file,
+						journal_filename );
+
 	return mx_status;
 }
 
+/* msauto_update_autosave_journal() appends the values of all of the
+ * entries that have changed since the last call to the journal.
+ */
+
+mx_status_type
+msauto_update_autosave_journal( MX_AUTOSAVE_LIST *autosave_list )
+{
+	static const char fname[] = "msauto_update_autosave_journal()";
+
+	MX_AUTOSAVE_LIST_ENTRY *autosave_list_entry;
+	char buffer[500];
+	unsigned long num_changed;
+	long i;
+	mx_status_type mx_status;
+
+	/* Until the first journal is started, changes are left marked
+	 * so that they are written to the first journal.
+	 */
+
+	if ( autosave_list->journal_file == NULL )
+		return MX_SUCCESSFUL_RESULT;
+
+	num_changed = 0;
+
+	for ( i = 0; i < autosave_list->num_entries; i++ ) {
+		autosave_list_entry = &(autosave_list->entry_array)[i];
+
+		if ( autosave_list_entry->value_changed == FALSE )
+			continue;
+
+		autosave_list_entry->value_changed = FALSE;
+
+		mx_status = msauto_construct_value_string( autosave_list_entry,
+						buffer, sizeof(buffer) );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		MX_DEBUG( 2,("%s: Journaling value of '%s.%s' = '%s'", fname,
+				autosave_list_entry->read_record_name,
+				autosave_list_entry->read_field_name, buffer ));
+
+		fprintf( autosave_list->journal_file, "%ld %s.%s  %s\n", i,
+				autosave_list_entry->read_record_name,
+				autosave_list_entry->read_field_name, buffer );
+
+		num_changed++;
+	}
+
+	if ( num_changed == 0 )
+		return MX_SUCCESSFUL_RESULT;
+
+	mx_status = msauto_sync_file( autosave_list->journal_file,
+					autosave_list->journal_filename );
+
+	return mx_status;
+}
+
+/*------------------------------------------------------------------*/
+
 #define CLOSE_AUTOSAVE_FILES \
 		do {                                           \
 			if ( autosave1 != NULL ) {             \
@@ -1929,28 +2277,236 @@ msauto_choose_autosave_file_to_use(
 
 #define SEPARATORS " \t"
 
+/* Parses the saved value in 'value_string' into the field that the
+ * entry is to be restored to.  The value is not sent to the server.
+ */
+
+static mx_status_type
+msauto_parse_autosave_value( MX_AUTOSAVE_LIST_ENTRY *autosave_list_entry,
+				char *value_string )
+{
+	MX_RECORD_FIELD *value_field;
+	void *value_ptr;
+	MX_RECORD_FIELD_PARSE_STATUS parse_status;
+	char token_buffer[500];
+	char separators[] = MX_RECORD_FIELD_SEPARATORS;
+	mx_status_type mx_status;
+
+	if ( autosave_list_entry->write_value_field == NULL ) {
+		value_field = autosave_list_entry->read_value_field;
+		value_ptr = autosave_list_entry->read_value_pointer;
+	} else {
+		value_field = autosave_list_entry->write_value_field;
+		value_ptr = autosave_list_entry->write_value_pointer;
+	}
+
+	/* Initialize the token parser. */
+
+	mx_initialize_parse_status( &parse_status, value_string, separators );
+
+	/* If this is a string field, find out what the maximum
+	 * length of a string token is for user by the token parser.
+	 */
+
+	if ( value_field->datatype == MXFT_STRING ) {
+		parse_status.max_string_token_length =
+			mx_get_max_string_token_length( value_field );
+	} else {
+		parse_status.max_string_token_length = 0L;
+	}
+
+	/* Parse the tokens. */
+
+	if ( (value_field->num_dimensions == 0)
+	  || ((value_field->datatype == MXFT_STRING)
+	    && (value_field->num_dimensions == 1))) {
+
+		/* Single token */
+
+		mx_status = mx_get_next_record_token( &parse_status,
+				token_buffer, sizeof(token_buffer) );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		mx_status = (autosave_list_entry->token_parser) (
+				value_ptr,
+				token_buffer,
+				autosave_list_entry->write_record,
+				value_field,
+				&parse_status );
+	} else {
+		/* Array of tokens. */
+
+		mx_status = mx_parse_array_description(
+				value_ptr,
+				value_field->num_dimensions - 1,
+				autosave_list_entry->write_record,
+				value_field,
+				&parse_status,
+				autosave_list_entry->token_parser );
+	}
+
+	return mx_status;
+}
+
+/* Applies the values in the autosave journal on top of the values
+ * read from the autosave file 'checkpoint_filename'.  The journal is
+ * only used if it was started after that autosave file was written.
+ * A partially written last line is ignored.
+ */
+
+static void
+msauto_replay_autosave_journal( char *journal_filename,
+				char *checkpoint_filename,
+				MX_AUTOSAVE_LIST *autosave_list,
+				mx_bool_type *restore_pending )
+{
+	static const char fname[] = "msauto_replay_autosave_journal()";
+
+	MX_AUTOSAVE_LIST_ENTRY *autosave_list_entry;
+	FILE *journal_file;
+	char buffer[500];
+	char journal_record_field_name[MXU_RECORD_FIELD_NAME_LENGTH+1];
+	char autosave_list_read_field_name[MXU_RECORD_FIELD_NAME_LENGTH+1];
+	char *buffer_ptr;
+	size_t length, header_length;
+	unsigned long entry_number, num_replayed;
+	long line_number;
+	int num_items, saved_errno;
+	mx_status_type mx_status;
+
+	journal_file = fopen( journal_filename, "r" );
+
+	if ( journal_file == NULL ) {
+		saved_errno = errno;
+
+		if ( saved_errno != ENOENT ) {
+			mx_warning( "Could not open autosave journal '%s' "
+			"for reading.  Reason = '%s'",
+				journal_filename, strerror(saved_errno) );
+		}
+		return;
+	}
+
+	/* Does this journal belong to the autosave file we restored from? */
+
+	header_length = strlen( MXAUTO_JOURNAL_HEADER );
+
+	mx_fgets( buffer, sizeof buffer, journal_file );
+
+	if ( feof( journal_file ) || ferror( journal_file )
+	  || ( strncmp( buffer, MXAUTO_JOURNAL_HEADER, header_length ) != 0 )
+	  || ( strcmp( buffer + header_length
+			+ strspn( buffer + header_length, SEPARATORS ),
+				checkpoint_filename ) != 0 ) )
+	{
+		fclose( journal_file );
+
+		mx_info( "Autosave journal '%s' does not apply to "
+			"autosave file '%s', so it will not be used.",
+			journal_filename, checkpoint_filename );
+		return;
+	}
+
+	num_replayed = 0;
+
+	for ( line_number = 1; ; line_number++ ) {
+		if ( fgets( buffer, sizeof buffer, journal_file ) == NULL )
+			break;
+
+		/* A line without a newline at the end was not completely
+		 * written, so it marks the end of the journal.
+		 */
+
+		length = strlen( buffer );
+
+		if ( ( length == 0 ) || ( buffer[length-1] != '\n' ) )
+			break;
+
+		buffer[length-1] = '\0';
+
+		num_items = sscanf( buffer, "%lu %s",
+				&entry_number, journal_record_field_name );
+
+		if ( ( num_items != 2 )
+		  || ( entry_number >= autosave_list->num_entries ) )
+		{
+			(void) mx_error( MXE_FILE_IO_ERROR, fname,
+			"Line %ld of autosave journal '%s' is incorrectly "
+			"formatted.  Contents = '%s'",
+				line_number, journal_filename, buffer );
+			break;
+		}
+
+		autosave_list_entry = &(autosave_list->entry_array)[entry_number];
+
+		snprintf( autosave_list_read_field_name,
+			sizeof(autosave_list_read_field_name),
+			"%s.%s",
+			autosave_list_entry->read_record_name,
+			autosave_list_entry->read_field_name );
+
+		if ( strcmp( journal_record_field_name,
+				autosave_list_read_field_name ) != 0 )
+		{
+			(void) mx_error( MXE_FILE_IO_ERROR, fname,
+	"Autosave journal '%s' and the autosave list are out of "
+	"synchronization at line %ld.  Journal record field name = '%s', "
+	"Autosave list read field name = '%s'", journal_filename, line_number,
+				journal_record_field_name,
+				autosave_list_read_field_name );
+			break;
+		}
+
+		buffer_ptr = buffer + strspn( buffer, SEPARATORS );
+
+		buffer_ptr += strcspn( buffer_ptr, SEPARATORS );
+
+		buffer_ptr += strspn( buffer_ptr, SEPARATORS );
+
+		buffer_ptr += strlen( journal_record_field_name );
+
+		buffer_ptr += strspn( buffer_ptr, SEPARATORS );
+
+		mx_status = msauto_parse_autosave_value( autosave_list_entry,
+								buffer_ptr );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			break;
+
+		restore_pending[ entry_number ] = TRUE;
+
+		num_replayed++;
+	}
+
+	fclose( journal_file );
+
+	mx_info( "Replayed %lu values from autosave journal '%s'",
+			num_replayed, journal_filename );
+
+	return;
+}
+
 mx_status_type
 msauto_restore_fields_from_autosave_files(
 			char *autosave1_filename, char * autosave2_filename,
+			char *journal_filename,
 			MX_AUTOSAVE_LIST *autosave_list )
 {
 	static const char fname[] =
 			"msauto_restore_fields_from_autosave_files()";
 
 	MX_AUTOSAVE_LIST_ENTRY *autosave_list_entry;
-	MX_RECORD_FIELD *value_field;
-	void *value_ptr;
-	MX_RECORD_FIELD_PARSE_STATUS parse_status;
 	FILE *autosave_to_use;
 	char *filename_to_use;
-	char token_buffer[500];
 	char buffer[500];
 	char *buffer_ptr;
 	char autosave_record_field_name[MXU_RECORD_FIELD_NAME_LENGTH+1];
 	char autosave_list_read_field_name[MXU_RECORD_FIELD_NAME_LENGTH+1];
 	char autosave_list_write_field_name[MXU_RECORD_FIELD_NAME_LENGTH+1];
-	char separators[] = MX_RECORD_FIELD_SEPARATORS;
 	char autosave_backup_filename[ MXU_FILENAME_LENGTH + 1 ];
+	mx_bool_type *restore_pending;
 	int saved_errno;
 	long i;
 	unsigned long autosave_flags;
@@ -2003,12 +2559,23 @@ msauto_restore_fields_from_autosave_files(
 		return MX_SUCCESSFUL_RESULT;
 	}
 
+	restore_pending = (mx_bool_type *)
+		calloc( autosave_list->num_entries + 1, sizeof(mx_bool_type) );
+
+	if ( restore_pending == (mx_bool_type *) NULL ) {
+		fclose( autosave_to_use );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a %lu element "
+		"restore pending array.", autosave_list->num_entries );
+	}
+
 	mx_info("Restoring parameters from autosave file '%s'",
 			filename_to_use);
 
-	/* Step through the lines in the autosave file and restore
-	 * parameters as we go.  Do _not_ return with an error status
-	 * code from here on.  To do so would cause the autosave process
+	/* Step through the lines in the autosave file and parse the
+	 * saved values.  Do _not_ return with an error status code
+	 * from here on.  To do so would cause the autosave process
 	 * to exit.
 	 */
 
@@ -2020,14 +2587,12 @@ msauto_restore_fields_from_autosave_files(
 		if ( feof( autosave_to_use ) || ferror( autosave_to_use )
 			  || (buffer[0] == '*') ) {
 
-			fclose( autosave_to_use );
-
 			(void) mx_error( MXE_FILE_IO_ERROR, fname,
 	"Only %ld autosave entries were read from autosave file '%s'.  "
 	"%lu entries were expected.",
 			i, filename_to_use, autosave_list->num_entries );
 
-			return MX_SUCCESSFUL_RESULT;
+			break;
 		}
 
 		buffer_ptr = buffer + strspn( buffer, SEPARATORS );
@@ -2044,24 +2609,14 @@ msauto_restore_fields_from_autosave_files(
 			autosave_list_entry->read_record_name,
 			autosave_list_entry->read_field_name );
 
-		snprintf( autosave_list_write_field_name,
-			sizeof(autosave_list_write_field_name),
-			"%s.%s",
-			autosave_list_entry->write_record_name,
-			autosave_list_entry->write_field_name );
-
 		MX_DEBUG( 2,("%s: autosave_record_field_name = '%s'",
 			fname, autosave_record_field_name));
 		MX_DEBUG( 2,("%s: autosave_list_read_field_name = '%s'",
 			fname, autosave_list_read_field_name));
-		MX_DEBUG( 2,("%s: autosave_list_write_field_name = '%s'",
-			fname, autosave_list_write_field_name));
 
 		if ( strcmp( autosave_record_field_name,
 				autosave_list_read_field_name ) != 0 ) {
 
-			fclose( autosave_to_use );
-
 			(void) mx_error( MXE_FILE_IO_ERROR, fname,
 	"Autosave file '%s' and the autosave list are out of "
 	"synchronization at line %ld.  Autosave record field name = '%s', "
@@ -2069,83 +2624,60 @@ msauto_restore_fields_from_autosave_files(
 				autosave_record_field_name,
 				autosave_list_read_field_name );
 
-			return MX_SUCCESSFUL_RESULT;
-		}
-		
-		if ( autosave_list_entry->write_value_field == NULL ) {
-			value_field = autosave_list_entry->read_value_field;
-			value_ptr = autosave_list_entry->read_value_pointer;
-		} else {
-			value_field = autosave_list_entry->write_value_field;
-			value_ptr = autosave_list_entry->write_value_pointer;
+			break;
 		}
 
-		/* Initialize the token parser. */
+		mx_status = msauto_parse_autosave_value( autosave_list_entry,
+								buffer_ptr );
 
-		mx_initialize_parse_status( &parse_status,
-						buffer_ptr, separators );
-
-		/* If this is a string field, find out what the maximum
-		 * length of a string token is for user by the token parser.
-		 */
+		if ( mx_status.code != MXE_SUCCESS )
+			break;
 
-		if ( value_field->datatype == MXFT_STRING ) {
-			parse_status.max_string_token_length =
-				mx_get_max_string_token_length( value_field );
-		} else {
-			parse_status.max_string_token_length = 0L;
-		}
+		restore_pending[i] = TRUE;
+	}
 
-		/* Parse the tokens. */
+	fclose( autosave_to_use );
 
-		if ( (value_field->num_dimensions == 0)
-		  || ((value_field->datatype == MXFT_STRING)
-		    && (value_field->num_dimensions == 1))) {
+	/* Values saved in the journal since the autosave file was
+	 * written replace the values from the autosave file.
+	 */
 
-			/* Single token */
+	if ( ( journal_filename != NULL ) && ( strlen(journal_filename) > 0 ) )
+	{
+		msauto_replay_autosave_journal( journal_filename,
+			filename_to_use, autosave_list, restore_pending );
+	}
 
-			mx_status = mx_get_next_record_token( &parse_status,
-					token_buffer, sizeof(token_buffer) );
+	/* Now send the restored values to the servers. */
 
-			if ( mx_status.code != MXE_SUCCESS ) {
-				fclose( autosave_to_use );
+	for ( i = 0; i < autosave_list->num_entries; i++ ) {
+		if ( restore_pending[i] == FALSE )
+			continue;
 
-				return MX_SUCCESSFUL_RESULT;
-			}
+		autosave_list_entry = &(autosave_list->entry_array)[i];
 
-			mx_status = (autosave_list_entry->token_parser) (
-					value_ptr,
-					token_buffer,
-					autosave_list_entry->write_record,
-					value_field,
-					&parse_status );
-		} else {
-			/* Array of tokens. */
-
-			mx_status = mx_parse_array_description(
-					value_ptr,
-					value_field->num_dimensions - 1,
-					autosave_list_entry->write_record,
-					value_field,
-					&parse_status,
-					autosave_list_entry->token_parser );
-		}
-		if ( mx_status.code != MXE_SUCCESS ) {
-			fclose( autosave_to_use );
+		snprintf( autosave_list_read_field_name,
+			sizeof(autosave_list_read_field_name),
+			"%s.%s",
+			autosave_list_entry->read_record_name,
+			autosave_list_entry->read_field_name );
 
-			return MX_SUCCESSFUL_RESULT;
-		}
+		snprintf( autosave_list_write_field_name,
+			sizeof(autosave_list_write_field_name),
+			"%s.%s",
+			autosave_list_entry->write_record_name,
+			autosave_list_entry->write_field_name );
 
 		if ( autosave_list_entry->write_function == NULL ) {
 			autosave_flags = autosave_list_entry->autosave_flags;
 
 			if ( autosave_flags & 0x1 ) {
 				mx_info( "Restoring value of '%s' to '%s'.",
-					autosave_record_field_name,
+					autosave_list_read_field_name,
 					autosave_list_write_field_name );
 			} else {
 				mx_info( "Restoring value of '%s'.",
-					autosave_record_field_name );
+					autosave_list_read_field_name );
 			}
 
 			(void) mx_send_variable(
@@ -2156,8 +2688,7 @@ msauto_restore_fields_from_autosave_files(
 		}
 	}
 
-	fclose( autosave_to_use );
+	mx_free( restore_pending );
 
 	return MX_SUCCESSFUL_RESULT;
 }
-
@@ -8,7 +8,8 @@
  *
  *---------------------------------------------------------------------------
  *
- * Copyright 1999, 2001-2002, 2005, 2011, 2015 Illinois Institute of Technology
+ * Copyright 1999, 2001-2002, 2005, 2011, 2015-2016
+ *    Illinois Institute of Technology
  *
  * See the file "LICENSE" for information on usage and redistribution
  * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
@@ -45,13 +46,31 @@ typedef struct {
 					MX_RECORD_FIELD_PARSE_STATUS * );
 
 	mx_status_type (*write_function) ( void * );
+
+	/* If value_changed_callback is not NULL, the server sends us the
+	 * new value of the field whenever it changes, so the entry does
+	 * not need to be polled.  The callback sets 'value_changed' to
+	 * tell us that the entry must be written to the journal.
+	 */
+
+	MX_CALLBACK *value_changed_callback;
+	mx_bool_type value_changed;
 } MX_AUTOSAVE_LIST_ENTRY;
 
 typedef struct {
 	unsigned long num_entries;
 	MX_AUTOSAVE_LIST_ENTRY *entry_array;
+
+	FILE *journal_file;
+	char journal_filename[MXU_FILENAME_LENGTH+1];
 } MX_AUTOSAVE_LIST;
 
+/* Each autosave journal starts with a header line that names the
+ * autosave file that the journal entries are to be applied on top of.
+ */
+
+#define MXAUTO_JOURNAL_HEADER	"# checkpoint"
+
 extern mx_status_type msauto_create_empty_mx_database(
 		MX_RECORD **record_list, int default_display_precision );
 
@@ -69,5 +88,16 @@ extern mx_status_type msauto_save_fields_to_autosave_file(
 
 extern mx_status_type msauto_restore_fields_from_autosave_files(
 		char *autosave1_filename, char *autosave2_filename,
+		char *journal_filename,
+		MX_AUTOSAVE_LIST *autosave_list );
+
+extern mx_status_type msauto_add_autosave_callbacks(
+		MX_AUTOSAVE_LIST *autosave_list );
+
+extern mx_status_type msauto_start_autosave_journal(
+		char *journal_filename, char *checkpoint_filename,
+		MX_AUTOSAVE_LIST *autosave_list );
+
+extern mx_status_type msauto_update_autosave_journal(
 		MX_AUTOSAVE_LIST *autosave_list );
 
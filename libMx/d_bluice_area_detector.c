@@ -39,7 +39,7 @@ MX_RECORD_FUNCTION_LIST mxd_bluice_area_detector_record_function_list = {
 	mxd_bluice_area_detector_initialize_driver,
 	mxd_bluice_area_detector_create_record_structures,
 	mx_area_detector_finish_record_initialization,
-	NULL,
+	mx_area_detector_delete_record,
 	NULL,
 	mxd_bluice_area_detector_open,
 	NULL,
@@ -34,7 +34,7 @@ MX_RECORD_FUNCTION_LIST mxd_mar345_record_function_list = {
 	mxd_mar345_initialize_driver,
 	mxd_mar345_create_record_structures,
 	mxd_mar345_finish_record_initialization,
-	NULL,
+	mx_area_detector_delete_record,
 	NULL,
 	mxd_mar345_open,
 	mxd_mar345_close
@@ -53,7 +53,7 @@ MX_RECORD_FUNCTION_LIST mxd_marccd_record_function_list = {
 	mxd_marccd_initialize_driver,
 	mxd_marccd_create_record_structures,
 	mxd_marccd_finish_record_initialization,
-	NULL,
+	mx_area_detector_delete_record,
 	NULL,
 	mxd_marccd_open,
 	mxd_marccd_close
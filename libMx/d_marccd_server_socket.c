@@ -37,7 +37,7 @@ MX_RECORD_FUNCTION_LIST mxd_marccd_server_socket_record_function_list = {
 	mxd_marccd_server_socket_initialize_driver,
 	mxd_marccd_server_socket_create_record_structures,
 	mxd_marccd_server_socket_finish_record_initialization,
-	NULL,
+	mx_area_detector_delete_record,
 	NULL,
 	mxd_marccd_server_socket_open,
 	mxd_marccd_server_socket_close,
@@ -70,7 +70,7 @@ MX_RECORD_FUNCTION_LIST mxd_merlin_medipix_record_function_list = {
 	mxd_merlin_medipix_initialize_driver,
 	mxd_merlin_medipix_create_record_structures,
 	NULL,
-	NULL,
+	mx_area_detector_delete_record,
 	NULL,
 	mxd_merlin_medipix_open,
 };
@@ -44,7 +44,7 @@ MX_RECORD_FUNCTION_LIST mxd_mlfsom_record_function_list = {
 	mxd_mlfsom_initialize_driver,
 	mxd_mlfsom_create_record_structures,
 	mxd_mlfsom_finish_record_initialization,
-	NULL,
+	mx_area_detector_delete_record,
 	NULL,
 	mxd_mlfsom_open,
 	mxd_mlfsom_close
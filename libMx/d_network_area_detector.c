@@ -34,7 +34,7 @@ MX_RECORD_FUNCTION_LIST mxd_network_area_detector_record_function_list = {
 	mxd_network_area_detector_initialize_driver,
 	mxd_network_area_detector_create_record_structures,
 	mxd_network_area_detector_finish_record_initialization,
-	NULL,
+	mx_area_detector_delete_record,
 	NULL,
 	mxd_network_area_detector_open,
 	NULL,
@@ -1342,11 +1342,12 @@ mxd_network_area_detector_transfer_frame( MX_AREA_DETECTOR *ad )
 	}
 #endif
 
-	dimension[0] = (long) destination_frame->image_length;
+	/* The frame is received directly into the image buffer. */
 
-	mx_status = mx_get_array(
+	mx_status = mx_get_bulk_array(
 			&(network_area_detector->image_frame_data_nf),
-			MXFT_CHAR, 1, dimension, destination_frame->image_data);
+			destination_frame->image_data,
+			destination_frame->image_length, NULL );
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
@@ -1489,7 +1490,6 @@ mxd_network_area_detector_get_roi_frame( MX_AREA_DETECTOR *ad )
 
 	MX_NETWORK_AREA_DETECTOR *network_area_detector = NULL;
 	MX_IMAGE_FRAME *roi_frame;
-	long dimension[1];
 	mx_status_type mx_status;
 
 	network_area_detector = NULL;
@@ -1564,10 +1564,9 @@ mxd_network_area_detector_get_roi_frame( MX_AREA_DETECTOR *ad )
 	}
 #endif
 
-	dimension[0] = (long) roi_frame->image_length;
-
-	mx_status = mx_get_array( &(network_area_detector->roi_frame_buffer_nf),
-			MXFT_CHAR, 1, dimension, roi_frame->image_data );
+	mx_status = mx_get_bulk_array(
+			&(network_area_detector->roi_frame_buffer_nf),
+			roi_frame->image_data, roi_frame->image_length, NULL );
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
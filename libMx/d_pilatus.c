@@ -34,7 +34,7 @@ MX_RECORD_FUNCTION_LIST mxd_pilatus_record_function_list = {
 	mxd_pilatus_initialize_driver,
 	mxd_pilatus_create_record_structures,
 	NULL,
-	NULL,
+	mx_area_detector_delete_record,
 	NULL,
 	mxd_pilatus_open,
 };
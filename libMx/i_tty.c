@@ -41,6 +41,8 @@
 #include "mx_rs232.h"
 #include "mx_record.h"
 #include "mx_select.h"
+#include "mx_mutex.h"
+#include "mx_circular_buffer.h"
 #include "i_tty.h"
 
 #if defined(OS_LINUX) || defined(OS_SOLARIS) || defined(OS_IRIX) \
@@ -142,7 +144,7 @@ MX_RS232_FUNCTION_LIST mxi_tty_rs232_function_list = {
 	mxi_tty_putchar,
 	mxi_tty_read,
 	mxi_tty_write,
-	NULL,
+	mxi_tty_getline,
 #if HAVE_READV_WRITEV
 	mxi_tty_putline,
 #else
@@ -224,6 +226,134 @@ mxi_tty_get_pointers( MX_RS232 *rs232,
 	return MX_SUCCESSFUL_RESULT;
 }
 
+/*---*/
+
+/* Bytes that have been read from the TTY by mxi_tty_getline() but
+ * not yet returned to the caller are kept in tty->receive_buffer.
+ * All of the other input functions must look there first.
+ */
+
+static unsigned long
+mxi_tty_num_buffered_bytes( MX_TTY *tty )
+{
+	unsigned long num_bytes_available;
+	mx_status_type mx_status;
+
+	if ( tty->receive_buffer == NULL )
+		return 0;
+
+	mx_status = mx_circular_buffer_num_bytes_available(
+			tty->receive_buffer, &num_bytes_available );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return 0;
+
+	return num_bytes_available;
+}
+
+/* mxi_tty_fill_receive_buffer() waits up to timeout_in_seconds for
+ * input to arrive at the TTY and then reads everything that is
+ * available with a single read() call.  A negative timeout means
+ * wait forever.  The receive buffer must be empty on entry.
+ */
+
+static mx_status_type
+mxi_tty_fill_receive_buffer( MX_RS232 *rs232,
+			MX_TTY *tty,
+			double timeout_in_seconds )
+{
+	static const char fname[] = "mxi_tty_fill_receive_buffer()";
+
+	char read_buffer[MXI_TTY_RECEIVE_BUFFER_SIZE];
+	struct timeval timeout, *timeout_ptr;
+	int select_status, saved_errno;
+	ssize_t result;
+	unsigned long bytes_written;
+	mx_status_type mx_status;
+
+#if HAVE_FD_SET
+	fd_set mask;
+
+	FD_ZERO( &mask );
+	FD_SET( tty->file_handle, &mask );
+#else
+	long mask;
+
+	mask = 1 << tty->file_handle;
+#endif
+
+	if ( timeout_in_seconds < 0.0 ) {
+		timeout_ptr = NULL;
+	} else {
+		timeout.tv_sec = (long) timeout_in_seconds;
+
+		timeout.tv_usec = (long) ( 1.0e6 *
+		    ( timeout_in_seconds - (double) timeout.tv_sec ) );
+
+		timeout_ptr = &timeout;
+	}
+
+	select_status = select( 1 + tty->file_handle,
+				&mask, NULL, NULL, timeout_ptr );
+
+	if ( select_status < 0 ) {
+		saved_errno = errno;
+
+		if ( saved_errno == EINTR )
+			return MX_SUCCESSFUL_RESULT;
+
+		return mx_error( MXE_INTERFACE_IO_ERROR, fname,
+		"An error occurred while waiting for input from "
+		"RS-232 port '%s'.  Errno = %d, error message = '%s'.",
+			rs232->record->name,
+			saved_errno, strerror( saved_errno ) );
+	}
+
+	if ( select_status == 0 ) {
+		return mx_error( (MXE_TIMED_OUT | MXE_QUIET), fname,
+		"No input arrived at RS-232 port '%s' within %g seconds.",
+			rs232->record->name, timeout_in_seconds );
+	}
+
+	result = read( tty->file_handle, read_buffer, sizeof(read_buffer) );
+
+	if ( result == 0 ) {
+		return mx_error( (MXE_END_OF_DATA | MXE_QUIET), fname,
+			"End of file for RS-232 port '%s'.",
+				rs232->record->name );
+	} else
+	if ( result < 0 ) {
+		saved_errno = errno;
+
+		switch( saved_errno ) {
+		case EAGAIN:
+		case EINTR:
+			return MX_SUCCESSFUL_RESULT;
+		default:
+			return mx_error( MXE_INTERFACE_IO_ERROR, fname,
+			"Error reading from RS-232 port '%s'.  "
+			"Errno = %d, error message = '%s'.",
+				rs232->record->name,
+				saved_errno, strerror( saved_errno ) );
+		}
+	}
+
+	mx_status = mx_circular_buffer_write( tty->receive_buffer,
+				read_buffer, result, &bytes_written );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	if ( bytes_written != (unsigned long) result ) {
+		return mx_error( MXE_DATA_WAS_LOST, fname,
+		"Only %lu of the %ld bytes read from RS-232 port '%s' "
+		"could be saved in its receive buffer.",
+			bytes_written, (long) result, rs232->record->name );
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
 /*==========================*/
 
 MX_EXPORT mx_status_type
@@ -258,6 +388,8 @@ mxi_tty_create_record_structures( MX_RECORD *record )
 
 	rs232->record = record;
 
+	tty->receive_buffer = NULL;
+
 	return MX_SUCCESSFUL_RESULT;
 }
 
@@ -305,6 +437,7 @@ mxi_tty_open( MX_RECORD *record )
 
 	MX_RS232 *rs232;
 	MX_TTY *tty = NULL;
+	MX_CIRCULAR_BUFFER *receive_buffer;
 	int status, flags, saved_errno;
 	unsigned long do_not_change_port_settings;
 	mx_status_type mx_status;
@@ -389,6 +522,24 @@ mxi_tty_open( MX_RECORD *record )
 			saved_errno, strerror( saved_errno ) );
 	}
 
+	/* Create the receive buffer used by mxi_tty_getline(). */
+
+	if ( tty->receive_buffer == NULL ) {
+		mx_status = mx_circular_buffer_create( &receive_buffer,
+					MXI_TTY_RECEIVE_BUFFER_SIZE );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		tty->receive_buffer = receive_buffer;
+	} else {
+		mx_status = mx_circular_buffer_discard_available_bytes(
+							tty->receive_buffer );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
 	/* If blocking was turned off for the open(), turn it back on. */
 
 #if defined(O_NDELAY) && defined(F_SETFL)
@@ -536,6 +687,7 @@ mxi_tty_getchar( MX_RS232 *rs232, char *c )
 	int num_chars, saved_flags, new_flags, result, saved_errno;
 	char c_temp;
 	unsigned char c_mask;
+	unsigned long num_buffered_chars;
 	mx_status_type mx_status;
 
 	mx_status = mxi_tty_get_pointers( rs232, &tty, fname );
@@ -543,6 +695,17 @@ mxi_tty_getchar( MX_RS232 *rs232, char *c )
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
+	/* Characters left over from mxi_tty_getline() come first. */
+
+	if ( mxi_tty_num_buffered_bytes( tty ) > 0 ) {
+		mx_status = mx_circular_buffer_read( tty->receive_buffer,
+					&c_temp, 1, &num_buffered_chars );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		num_chars = (int) num_buffered_chars;
+	} else
 	if ( rs232->transfer_flags & MXF_232_NOWAIT ) {
 		/* Set the file descriptor to be non-blocking. */
 
@@ -677,6 +840,27 @@ mxi_tty_read( MX_RS232 *rs232,
 	bytes_left_to_read = max_bytes_to_read;
 	i = 0;
 
+	/* Characters left over from mxi_tty_getline() come first. */
+
+	if ( mxi_tty_num_buffered_bytes( tty ) > 0 ) {
+		mx_status = mx_circular_buffer_read( tty->receive_buffer,
+				buffer_ptr, bytes_left_to_read,
+				&total_bytes_read );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		buffer_ptr += total_bytes_read;
+		bytes_left_to_read -= total_bytes_read;
+
+		if ( bytes_read != NULL ) {
+			*bytes_read = total_bytes_read;
+		}
+
+		if ( bytes_left_to_read == 0 )
+			return MX_SUCCESSFUL_RESULT;
+	}
+
 #if MXI_TTY_DEBUG
 	MX_DEBUG(-2,("%s: About to read %lu bytes from TTY '%s'.",
 		fname, (unsigned long) max_bytes_to_read,
@@ -878,15 +1062,226 @@ mxi_tty_write( MX_RS232 *rs232,
 
 /*------------------------------------------------------------------------*/
 
-#if HAVE_READV_WRITEV
-
-/* FIXME: mxi_tty_getline() can probably be implemented by reading into
- *        a two element iovec_array where the second element points to
- *        a buffer long enough to hold the expected read terminators.
- *        Presumably at startup time, MX_TTY structure can allocate memory
- *        for this extra read terminator buffer.
+/* mxi_tty_getline() reads from the TTY in bulk into tty->receive_buffer
+ * and then scans the buffer for the read terminators, rather than
+ * issuing a separate read() for each character like the generic
+ * mx_rs232_unbuffered_getline().  Any bytes after the terminators are
+ * left in the receive buffer for the next read.
  */
 
+MX_EXPORT mx_status_type
+mxi_tty_getline( MX_RS232 *rs232,
+		char *buffer,
+		size_t max_bytes_to_read,
+		size_t *bytes_read )
+{
+	static const char fname[] = "mxi_tty_getline()";
+
+	MX_TTY *tty = NULL;
+	char chunk[MXI_TTY_RECEIVE_BUFFER_SIZE];
+	char *array;
+	char c;
+	unsigned char c_mask;
+	unsigned long chunk_length, chunk_index;
+	size_t i;
+	long start_of_terminator;
+	int terminators_seen, tick_comparison;
+	mx_bool_type do_timeout, end_of_line;
+	MX_CLOCK_TICK timeout_clock_ticks, current_tick, finish_tick;
+	double seconds_left;
+	long error_code;
+	mx_status_type mx_status;
+
+	mx_status = mxi_tty_get_pointers( rs232, &tty, fname );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	if ( bytes_read != NULL ) {
+		*bytes_read = 0;
+	}
+
+	if ( max_bytes_to_read == 0 )
+		return MX_SUCCESSFUL_RESULT;
+
+	if ( tty->receive_buffer == NULL ) {
+		return mx_error( MXE_NOT_READY, fname,
+		"TTY port '%s' has not been opened.", rs232->record->name );
+	}
+
+	if ( rs232->timeout < 0.0 ) {
+		do_timeout = FALSE;
+	} else {
+		do_timeout = TRUE;
+
+		timeout_clock_ticks =
+		    mx_convert_seconds_to_clock_ticks( rs232->timeout );
+
+		current_tick = mx_current_clock_tick();
+
+		finish_tick = mx_add_clock_ticks( current_tick,
+						timeout_clock_ticks );
+	}
+
+	/* Note that the following code _assumes_ that chars are 8 bits. */
+
+	c_mask = 0xff >> ( 8 - rs232->word_size );
+
+	array = rs232->read_terminator_array;
+
+	terminators_seen = 0;
+	start_of_terminator = -1;
+	end_of_line = FALSE;
+
+	i = 0;
+
+	/* Leave room for the trailing null byte. */
+
+	while ( ( end_of_line == FALSE ) && ( i < max_bytes_to_read - 1 ) ) {
+
+		mx_status = mx_circular_buffer_peek( tty->receive_buffer,
+				chunk, sizeof(chunk), &chunk_length );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		if ( chunk_length == 0 ) {
+
+			/* The receive buffer is empty, so wait for
+			 * more input to arrive.
+			 */
+
+			if ( do_timeout ) {
+				current_tick = mx_current_clock_tick();
+
+				tick_comparison = mx_compare_clock_ticks(
+						current_tick, finish_tick );
+
+				if ( tick_comparison >= 0 ) {
+					buffer[i] = '\0';
+
+					if ( rs232->rs232_flags &
+				    MXF_232_SUPPRESS_TIMEOUT_ERROR_MESSAGES )
+					{
+						error_code =
+						    (MXE_TIMED_OUT | MXE_QUIET);
+					} else {
+						error_code = MXE_TIMED_OUT;
+					}
+
+					return mx_error( error_code, fname,
+					"Read from RS-232 port '%s' timed out "
+					"after %g seconds.",
+					    rs232->record->name,
+					    rs232->timeout );
+				}
+
+				seconds_left =
+				    mx_convert_clock_ticks_to_seconds(
+					mx_subtract_clock_ticks(
+						finish_tick, current_tick ) );
+			} else {
+				seconds_left = -1.0;
+			}
+
+			mx_status = mxi_tty_fill_receive_buffer( rs232,
+							tty, seconds_left );
+
+			if ( ( mx_status.code != MXE_SUCCESS )
+			  && ( mx_status.code != MXE_TIMED_OUT ) )
+			{
+				buffer[i] = '\0';
+
+				return mx_status;
+			}
+
+			continue;
+		}
+
+		/* Copy characters from the chunk until we see the
+		 * complete terminator sequence.
+		 */
+
+		for ( chunk_index = 0; chunk_index < chunk_length; ) {
+
+			if ( end_of_line || ( i >= max_bytes_to_read - 1 ) )
+				break;
+
+			c = (char) ( chunk[ chunk_index ] & c_mask );
+
+			chunk_index++;
+
+			if ( c == '\0' ) {
+				if ( rs232->transfer_flags
+						& MXF_232_IGNORE_NULLS )
+				{
+					continue;
+				}
+
+				/* Do not ignore the null. */
+
+				start_of_terminator = i;
+				end_of_line = TRUE;
+				break;
+			}
+
+			buffer[i] = c;
+
+			/* Check to see if we are in the middle of a
+			 * line terminator sequence.
+			 */
+
+			if ( c != array[ terminators_seen ] ) {
+				terminators_seen = 0;
+				start_of_terminator = -1;
+			} else {
+				if ( terminators_seen == 0 ) {
+					start_of_terminator = i;
+				}
+				terminators_seen++;
+
+				if ( (terminators_seen
+						>= MX_RS232_MAX_TERMINATORS)
+				  || (array[ terminators_seen ] == '\0') )
+				{
+					end_of_line = TRUE;
+				}
+			}
+
+			i++;
+		}
+
+		/* Remove the characters we used from the receive buffer. */
+
+		mx_status = mx_circular_buffer_increment_bytes_read(
+					tty->receive_buffer, chunk_index );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
+	if ( end_of_line && ( start_of_terminator >= 0 ) ) {
+		buffer[ start_of_terminator ] = '\0';
+	} else {
+		buffer[i] = '\0';
+	}
+
+	if ( bytes_read != NULL ) {
+		*bytes_read = strlen( buffer );
+	}
+
+#if MXI_TTY_DEBUG
+	MX_DEBUG(-2,("%s: received '%s' from '%s'",
+		fname, buffer, rs232->record->name));
+#endif
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*------------------------------------------------------------------------*/
+
+#if HAVE_READV_WRITEV
+
 MX_EXPORT mx_status_type
 mxi_tty_putline( MX_RS232 *rs232,
 		char *buffer,
@@ -1078,7 +1473,8 @@ mxi_tty_fionread_num_input_bytes_available( MX_RS232 *rs232 )
 			strerror(saved_errno) );
 	}
 
-	rs232->num_input_bytes_available = num_chars_available;
+	rs232->num_input_bytes_available = num_chars_available
+					+ mxi_tty_num_buffered_bytes( tty );
 
 	return MX_SUCCESSFUL_RESULT;
 }
@@ -1139,10 +1535,10 @@ mxi_tty_select_num_input_bytes_available( MX_RS232 *rs232 )
 
 	select_status = select( 1 + tty_fd, &mask, NULL, NULL, &timeout );
 
+	rs232->num_input_bytes_available = mxi_tty_num_buffered_bytes( tty );
+
 	if ( select_status ) {
-		rs232->num_input_bytes_available = 1;
-	} else {
-		rs232->num_input_bytes_available = 0;
+		rs232->num_input_bytes_available += 1;
 	}
 
 	return MX_SUCCESSFUL_RESULT;
@@ -1156,6 +1552,7 @@ mxi_tty_discard_unread_input( MX_RS232 *rs232 )
 {
 	static const char fname[] = "mxi_tty_discard_unread_input()";
 
+	MX_TTY *tty = NULL;
 	int debug_level;
 	unsigned long i, timeout;
 	char c;
@@ -1169,6 +1566,19 @@ mxi_tty_discard_unread_input( MX_RS232 *rs232 )
 
 	MX_DEBUG( 2,("%s invoked.", fname));
 
+	mx_status = mxi_tty_get_pointers( rs232, &tty, fname );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	if ( tty->receive_buffer != NULL ) {
+		mx_status = mx_circular_buffer_discard_available_bytes(
+							tty->receive_buffer );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
 	timeout = 10000L;
 
 	/* If input is available, read until there is no more input.
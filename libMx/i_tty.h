@@ -75,9 +75,18 @@ MX_API mx_status_type mxi_tty_set_echo( MX_RS232 *rs232 );
 
 /* Define the data structures used by a Unix TTY interface. */
 
+/* Note: The receive_buffer item in MX_TTY is actually an
+ * MX_CIRCULAR_BUFFER.  It is declared as a void pointer here
+ * so that users of this header do not need mx_circular_buffer.h.
+ */
+
+#define MXI_TTY_RECEIVE_BUFFER_SIZE	4096
+
 typedef struct {
 	int file_handle;
 	char filename[MXU_FILENAME_LENGTH + 1];
+
+	void *receive_buffer;
 } MX_TTY;
 
 extern MX_RECORD_FUNCTION_LIST mxi_tty_record_function_list;
@@ -66,6 +66,9 @@
 #include "mx_relay.h"
 #include "mx_rs232.h"
 #include "mx_image.h"
+#include "mx_image_pool.h"
+#include "mx_image_write_queue.h"
+#include "mx_metrics.h"
 #include "mx_area_detector.h"
 
 /*=======================================================================*/
@@ -256,6 +259,11 @@ mx_area_detector_finish_record_initialization( MX_RECORD *record )
 	ad->use_scaled_dark_current = FALSE;
 	ad->dark_current_exposure_time = 1.0;
 
+	ad->num_correction_threads = 1;
+	ad->correction_thread_pool = NULL;
+
+	ad->correction_plan = NULL;
+
 	ad->sequence_start_delay   = 0.0;
 	ad->total_acquisition_time = 0.0;
 	ad->detector_readout_time  = 0.0;
@@ -322,6 +330,16 @@ mx_area_detector_finish_record_initialization( MX_RECORD *record )
 
 	ad->inhibit_autosave = FALSE;
 
+	ad->num_datafile_write_threads = 0;
+	ad->datafile_write_max_bytes = MX_AREA_DETECTOR_DEFAULT_WRITE_MAX_BYTES;
+	ad->datafile_frames_pending = 0;
+	ad->datafile_bytes_pending = 0;
+	ad->datafile_last_write_latency = 0.0;
+	ad->datafile_write_queue = NULL;
+
+	ad->frame_pool = NULL;
+	ad->frame_pool_flags = 0;
+
 	ad->oscillation_motor_name[0] = '\0';
 	ad->shutter_name[0] = '\0';
 
@@ -441,6 +459,12 @@ mx_area_detector_finish_record_initialization( MX_RECORD *record )
 		ad->dezinger_correction_frame = FALSE;
 	}
 
+	if ( ad_flags & MXF_AD_FULL_FRAME_DEZINGER ) {
+		ad->streaming_dezinger = FALSE;
+	} else {
+		ad->streaming_dezinger = TRUE;
+	}
+
 	/*-------*/
 
 	/* If we are running in single-process mode (no client/server)
@@ -473,6 +497,74 @@ mx_area_detector_finish_record_initialization( MX_RECORD *record )
 	return MX_SUCCESSFUL_RESULT;
 }
 
+/*-----------------------------------------------------------------------*/
+
+/* mx_area_detector_release_resources() waits for any pending datafile
+ * writes and then destroys the datafile write queue and the frame pool.
+ * Frames that are still leased from the pool are freed when they are
+ * released, after which the pool itself is freed.
+ */
+
+MX_EXPORT mx_status_type
+mx_area_detector_release_resources( MX_RECORD *record )
+{
+	MX_AREA_DETECTOR *ad;
+	MX_IMAGE_WRITE_QUEUE *queue;
+	MX_IMAGE_POOL *pool;
+	mx_status_type mx_status;
+
+	if ( record == (MX_RECORD *) NULL ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	ad = (MX_AREA_DETECTOR *) record->record_class_struct;
+
+	if ( ad == (MX_AREA_DETECTOR *) NULL ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	queue = (MX_IMAGE_WRITE_QUEUE *) ad->datafile_write_queue;
+
+	if ( queue != (MX_IMAGE_WRITE_QUEUE *) NULL ) {
+		ad->datafile_write_queue = NULL;
+
+		mx_status = mx_image_write_queue_destroy( queue );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
+	pool = (MX_IMAGE_POOL *) ad->frame_pool;
+
+	if ( pool != (MX_IMAGE_POOL *) NULL ) {
+		ad->frame_pool = NULL;
+
+		mx_status = mx_image_pool_destroy( pool );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* Area detector drivers that have no delete_record function of their
+ * own use mx_area_detector_delete_record() in their record function list.
+ */
+
+MX_EXPORT mx_status_type
+mx_area_detector_delete_record( MX_RECORD *record )
+{
+	mx_status_type mx_status;
+
+	mx_status = mx_area_detector_release_resources( record );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	return mx_default_delete_record_handler( record );
+}
+
 /*=======================================================================*/
 
 MX_EXPORT mx_status_type
@@ -3576,6 +3668,48 @@ mx_area_detector_send_oscillation_trigger_pulse( MX_AREA_DETECTOR *ad )
 
 /*-------------------------------------------------------------------*/
 
+/* mxp_area_detector_lease_frame() is used instead of mx_image_alloc()
+ * when a new frame must be created for the detector.
+ */
+
+static mx_status_type
+mxp_area_detector_lease_frame( MX_AREA_DETECTOR *ad,
+				MX_IMAGE_FRAME **image_frame,
+				long row_framesize,
+				long column_framesize,
+				long image_format,
+				long byte_order,
+				double bytes_per_pixel,
+				size_t header_length,
+				MX_DICTIONARY *dictionary,
+				MX_RECORD *record )
+{
+	MX_IMAGE_POOL *pool;
+	mx_status_type mx_status;
+
+	if ( ad->frame_pool == NULL ) {
+		mx_status = mx_image_pool_create( &pool,
+					MX_IMAGE_POOL_DEFAULT_MAX_FREE_FRAMES,
+					MX_IMAGE_POOL_DEFAULT_ALIGNMENT,
+					ad->frame_pool_flags );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		ad->frame_pool = pool;
+	}
+
+	mx_status = mx_image_pool_lease( ad->frame_pool, image_frame,
+					row_framesize, column_framesize,
+					image_format, byte_order,
+					bytes_per_pixel, header_length,
+					dictionary, record );
+
+	return mx_status;
+}
+
+/*-------------------------------------------------------------------*/
+
 MX_EXPORT mx_status_type
 mx_area_detector_setup_frame( MX_RECORD *record,
 				MX_IMAGE_FRAME **image_frame )
@@ -3605,7 +3739,18 @@ mx_area_detector_setup_frame( MX_RECORD *record,
 	MX_HRT_START(setup_frame_timing);
 #endif
 
-	mx_status = mx_image_alloc( image_frame,
+	if ( (*image_frame) == (MX_IMAGE_FRAME *) NULL ) {
+		mx_status = mxp_area_detector_lease_frame( ad, image_frame,
+					ad->framesize[0],
+					ad->framesize[1],
+					ad->image_format,
+					ad->byte_order,
+					ad->bytes_per_pixel,
+					ad->header_length,
+					ad->dictionary,
+					ad->record );
+	} else {
+		mx_status = mx_image_alloc( image_frame,
 					ad->framesize[0],
 					ad->framesize[1],
 					ad->image_format,
@@ -3615,6 +3760,7 @@ mx_area_detector_setup_frame( MX_RECORD *record,
 					ad->bytes_per_frame,
 					ad->dictionary,
 					ad->record );
+	}
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
@@ -3674,7 +3820,18 @@ mx_area_detector_setup_correction_frame( MX_RECORD *record,
 	MX_HRT_START(setup_frame_timing);
 #endif
 
-	mx_status = mx_image_alloc( image_frame,
+	if ( (*image_frame) == (MX_IMAGE_FRAME *) NULL ) {
+		mx_status = mxp_area_detector_lease_frame( ad, image_frame,
+					ad->framesize[0],
+					ad->framesize[1],
+					image_format,
+					ad->byte_order,
+					bytes_per_pixel,
+					ad->header_length,
+					ad->dictionary,
+					ad->record );
+	} else {
+		mx_status = mx_image_alloc( image_frame,
 					ad->framesize[0],
 					ad->framesize[1],
 					image_format,
@@ -3684,6 +3841,7 @@ mx_area_detector_setup_correction_frame( MX_RECORD *record,
 					bytes_per_frame,
 					ad->dictionary,
 					ad->record );
+	}
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
@@ -3807,6 +3965,7 @@ mx_area_detector_readout_frame( MX_RECORD *record, long frame_number )
 	MX_AREA_DETECTOR *ad;
 	MX_AREA_DETECTOR_FUNCTION_LIST *flist;
 	mx_status_type ( *readout_frame_fn ) ( MX_AREA_DETECTOR * );
+	uint64_t metrics_start;
 	mx_status_type mx_status;
 
 #if MX_AREA_DETECTOR_DEBUG_FRAME_TIMING
@@ -3860,8 +4019,13 @@ mx_area_detector_readout_frame( MX_RECORD *record, long frame_number )
 	ad->frame_number  = frame_number;
 	ad->readout_frame = frame_number;
 
+	metrics_start = mx_metrics_start();
+
 	mx_status = (*readout_frame_fn)( ad );
 
+	mx_metrics_stop( mx_metrics_get_record_metric( record,
+				MX_METRIC_AD_READOUT ), metrics_start );
+
 #if MX_AREA_DETECTOR_DEBUG_FRAME_TIMING
 	MX_HRT_END(readout_frame_timing);
 	MX_HRT_RESULTS(readout_frame_timing, fname, "for frame readout");
@@ -3896,6 +4060,7 @@ mx_area_detector_correct_frame( MX_RECORD *record )
 	MX_AREA_DETECTOR *ad;
 	MX_AREA_DETECTOR_FUNCTION_LIST *flist;
 	mx_status_type ( *correct_frame_fn ) ( MX_AREA_DETECTOR * );
+	uint64_t metrics_start;
 	mx_status_type mx_status;
 
 	mx_status = mx_area_detector_get_pointers(record, &ad, &flist, fname);
@@ -3909,8 +4074,13 @@ mx_area_detector_correct_frame( MX_RECORD *record )
 		correct_frame_fn = mx_area_detector_default_correct_frame;
 	}
 
+	metrics_start = mx_metrics_start();
+
 	mx_status = (*correct_frame_fn)( ad );
 
+	mx_metrics_stop( mx_metrics_get_record_metric( record,
+				MX_METRIC_AD_CORRECT ), metrics_start );
+
 	return mx_status;
 }
 
@@ -4053,6 +4223,12 @@ mx_area_detector_transfer_frame( MX_RECORD *record,
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
+	/* Changing a correction frame invalidates the correction plan. */
+
+	if ( frame_type != MXFT_AD_IMAGE_FRAME ) {
+		mx_area_detector_discard_correction_plan( ad );
+	}
+
 	/* Some frame types need special things to happen after
 	 * they are transferred.
 	 */
@@ -4191,6 +4367,12 @@ mx_area_detector_load_frame( MX_RECORD *record,
 		return MX_SUCCESSFUL_RESULT;
 	}
 
+	/* Changing a correction frame invalidates the correction plan. */
+
+	if ( frame_type != MXFT_AD_IMAGE_FRAME ) {
+		mx_area_detector_discard_correction_plan( ad );
+	}
+
 	/* Additional things must be done for image correction frames. */
 
 	switch( frame_type ) {
@@ -4307,6 +4489,7 @@ mx_area_detector_save_frame( MX_RECORD *record,
 	MX_AREA_DETECTOR *ad;
 	MX_AREA_DETECTOR_FUNCTION_LIST *flist;
 	mx_status_type ( *save_frame_fn ) ( MX_AREA_DETECTOR * );
+	uint64_t metrics_start;
 	mx_status_type mx_status;
 
 	mx_status = mx_area_detector_get_pointers(record, &ad, &flist, fname);
@@ -4329,8 +4512,13 @@ mx_area_detector_save_frame( MX_RECORD *record,
 
 	strlcpy( ad->frame_filename, frame_filename, MXU_FILENAME_LENGTH );
 
+	metrics_start = mx_metrics_start();
+
 	mx_status = (*save_frame_fn)( ad );
 
+	mx_metrics_stop( mx_metrics_get_record_metric( record,
+				MX_METRIC_AD_SAVE ), metrics_start );
+
 	/* Additional things must be done for image correction frames. */
 
 	switch( frame_type ) {
@@ -4445,6 +4633,12 @@ mx_area_detector_copy_frame( MX_RECORD *record,
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
+	/* Changing a correction frame invalidates the correction plan. */
+
+	if ( destination_frame_type != MXFT_AD_IMAGE_FRAME ) {
+		mx_area_detector_discard_correction_plan( ad );
+	}
+
 	/* Additional things must be done for image correction frames. */
 
 	switch( destination_frame_type ) {
@@ -4832,30 +5026,6 @@ mx_area_detector_get_roi_frame( MX_RECORD *record,
 		fname, image_frame, *roi_frame));
 #endif
 
-	/* We either reuse an existing MX_IMAGE_FRAME or create a new one. */
-
-	if ( (*roi_frame) == (MX_IMAGE_FRAME *) NULL ) {
-
-#if MX_AREA_DETECTOR_DEBUG
-		MX_DEBUG(-2,("%s: Allocating a new ROI MX_IMAGE_FRAME.",fname));
-#endif
-		/* Allocate a new MX_IMAGE_FRAME. */
-
-		*roi_frame = malloc( sizeof(MX_IMAGE_FRAME) );
-
-		if ( (*roi_frame) == NULL ) {
-			return mx_error( MXE_OUT_OF_MEMORY, fname,
-			"Ran out of memory trying to allocate "
-			"a new ROI MX_IMAGE_FRAME structure." );
-		}
-
-		(*roi_frame)->header_length = 0;
-		(*roi_frame)->header_data = NULL;
-
-		(*roi_frame)->image_length = 0;
-		(*roi_frame)->image_data = NULL;
-	}
-
 	/* Fill in some parameters. */
 
 	roi_row_width     = (long) ( ad->roi[1] - ad->roi[0] + 1 );
@@ -4878,13 +5048,27 @@ mx_area_detector_get_roi_frame( MX_RECORD *record,
 		fname, (*roi_frame) ));
 #endif
 
-	mx_status = mx_image_alloc( roi_frame,
+	if ( (*roi_frame) == (MX_IMAGE_FRAME *) NULL ) {
+
+#if MX_AREA_DETECTOR_DEBUG
+		MX_DEBUG(-2,("%s: Leasing a new ROI MX_IMAGE_FRAME.",fname));
+#endif
+		mx_status = mxp_area_detector_lease_frame( ad, roi_frame,
+				roi_row_width,
+				roi_column_height,
+				image_format,
+				byte_order,
+				bytes_per_pixel,
+				0, NULL, NULL );
+	} else {
+		mx_status = mx_image_alloc( roi_frame,
 				roi_row_width,
 				roi_column_height,
 				image_format,
 				byte_order,
 				bytes_per_pixel,
 				0, 0, NULL, NULL );
+	}
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
@@ -6188,9 +6372,25 @@ mx_area_detector_copy_and_convert_frame( MX_IMAGE_FRAME **dest_frame_ptr,
 	dest_image_size_in_bytes = mx_round( bytes_per_pixel
 			* (double)( row_framesize * column_framesize ) );
 
-	/* Update the destination frame pointer. */
+	/* Update the destination frame pointer.  A new destination frame
+	 * for a pooled source frame is leased from the same pool.
+	 */
 
-	mx_status = mx_image_alloc( dest_frame_ptr,
+	if ( ( (*dest_frame_ptr) == (MX_IMAGE_FRAME *) NULL )
+	  && ( src_frame->image_pool != NULL ) )
+	{
+		mx_status = mx_image_pool_lease( src_frame->image_pool,
+					dest_frame_ptr,
+					row_framesize,
+					column_framesize,
+					dest_image_format,
+					MXIF_BYTE_ORDER( src_frame ),
+					bytes_per_pixel,
+					MXIF_HEADER_BYTES( src_frame ),
+					src_frame->dictionary,
+					src_frame->record );
+	} else {
+		mx_status = mx_image_alloc( dest_frame_ptr,
 					row_framesize,
 					column_framesize,
 					dest_image_format,
@@ -6200,6 +6400,7 @@ mx_area_detector_copy_and_convert_frame( MX_IMAGE_FRAME **dest_frame_ptr,
 					dest_image_size_in_bytes,
 					src_frame->dictionary,
 					src_frame->record );
+	}
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
@@ -7173,6 +7374,282 @@ mx_area_detector_setup_datafile_management( MX_RECORD *record,
 	return mx_status;
 }
 
+/* mxp_area_detector_handle_datafile_write_status() does the bookkeeping
+ * that follows an attempt to write an image file, whether the file was
+ * written directly by the datafile management handler or later by one
+ * of the datafile write queue threads.
+ */
+
+static void
+mxp_area_detector_handle_datafile_write_status( MX_AREA_DETECTOR *ad,
+						char *filename,
+						mx_status_type write_status )
+{
+#if MX_AREA_DETECTOR_DEBUG_DATAFILE_AUTOSAVE_FAILURE
+	static const char fname[] =
+		"mxp_area_detector_handle_datafile_write_status()";
+#endif
+
+#if 0
+	MX_DEBUG(-2,("%s: mx_image_write_file() mx_status.code = %lu",
+		fname, write_status.code));
+	MX_DEBUG(-2,("%s: ad->filename_log_record = %p",
+		fname, ad->filename_log_record));
+#endif
+
+	if ( ( write_status.code == MXE_SUCCESS )
+	  && ( ad->filename_log_record != (MX_RECORD *) NULL ) )
+	{
+		/* If we are logging individual filenames,
+		 * then do that now.
+		 */
+
+		(void) mx_area_detector_write_to_filename_log( ad, filename );
+	} else
+	if ( write_status.code != MXE_SUCCESS ) {
+
+		mx_area_detector_image_log_show_error( ad, write_status );
+
+#if MX_AREA_DETECTOR_DEBUG_DATAFILE_AUTOSAVE_FAILURE
+		MX_DEBUG(-2,("%s: Autosave of '%s' by '%s' failed "
+		"with MX error code %ld.", fname,
+		filename, ad->record->name,
+		write_status.code ));
+#endif
+		switch ( write_status.code ) {
+		case MXE_FILE_IO_ERROR:
+			ad->latched_status |= MXSF_AD_FILE_IO_ERROR;
+			break;
+		case MXE_PERMISSION_DENIED:
+			ad->latched_status |= MXSF_AD_PERMISSION_DENIED;
+			break;
+		case MXE_DISK_FULL:
+			ad->latched_status |= MXSF_AD_DISK_FULL;
+			break;
+		default:
+			break;
+		}
+
+		ad->latched_status |= MXSF_AD_ERROR;
+
+		/* Abort the running sequence. */
+
+		(void) mx_area_detector_abort( ad->record );
+	}
+}
+
+static void
+mxp_area_detector_collect_datafile_write_results( MX_AREA_DETECTOR *ad )
+{
+	char filename[MXU_FILENAME_LENGTH+1];
+	mx_status_type write_status;
+	mx_bool_type result_available;
+	mx_status_type mx_status;
+
+	if ( ad->datafile_write_queue == NULL ) {
+		return;
+	}
+
+	for (;;) {
+		mx_status = mx_image_write_queue_get_result(
+					ad->datafile_write_queue,
+					filename, sizeof(filename),
+					&write_status, &result_available );
+
+		if ( ( mx_status.code != MXE_SUCCESS )
+		  || ( result_available == FALSE ) )
+		{
+			return;
+		}
+
+		mxp_area_detector_handle_datafile_write_status( ad,
+						filename, write_status );
+	}
+}
+
+MX_EXPORT mx_status_type
+mx_area_detector_set_num_datafile_write_threads( MX_RECORD *ad_record,
+				unsigned long num_datafile_write_threads )
+{
+	static const char fname[] =
+		"mx_area_detector_set_num_datafile_write_threads()";
+
+	MX_AREA_DETECTOR *ad;
+	MX_IMAGE_WRITE_QUEUE *queue;
+	mx_status_type mx_status;
+
+	mx_status = mx_area_detector_get_pointers( ad_record, &ad, NULL, fname );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	ad->num_datafile_write_threads = num_datafile_write_threads;
+
+	queue = (MX_IMAGE_WRITE_QUEUE *) ad->datafile_write_queue;
+
+	if ( queue != (MX_IMAGE_WRITE_QUEUE *) NULL ) {
+		if ( queue->num_threads == num_datafile_write_threads ) {
+			return mx_image_write_queue_set_max_bytes( queue,
+						ad->datafile_write_max_bytes );
+		}
+
+		/* Destroying the queue waits for all of the pending
+		 * frames to be written, so we can report their results
+		 * before the queue goes away.
+		 */
+
+		mx_status = mx_image_write_queue_flush( queue );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		mxp_area_detector_collect_datafile_write_results( ad );
+
+		ad->datafile_write_queue = NULL;
+
+		mx_status = mx_image_write_queue_destroy( queue );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
+	ad->datafile_frames_pending = 0;
+	ad->datafile_bytes_pending = 0;
+
+	if ( num_datafile_write_threads == 0 ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	mx_status = mx_image_write_queue_create( &queue,
+					num_datafile_write_threads,
+					ad->datafile_write_max_bytes );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		ad->num_datafile_write_threads = 0;
+		return mx_status;
+	}
+
+#if MX_AREA_DETECTOR_DEBUG_DATAFILE_AUTOSAVE
+	MX_DEBUG(-2,("%s: area detector '%s' now uses %lu datafile "
+		"write threads.", fname, ad_record->name,
+		num_datafile_write_threads));
+#endif
+
+	ad->datafile_write_queue = queue;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+MX_EXPORT mx_status_type
+mx_area_detector_set_frame_pool_flags( MX_RECORD *ad_record,
+				unsigned long frame_pool_flags )
+{
+	static const char fname[] = "mx_area_detector_set_frame_pool_flags()";
+
+	MX_AREA_DETECTOR *ad;
+	MX_IMAGE_POOL *pool;
+	mx_status_type mx_status;
+
+	mx_status = mx_area_detector_get_pointers( ad_record, &ad, NULL, fname );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	pool = (MX_IMAGE_POOL *) ad->frame_pool;
+
+	ad->frame_pool_flags = frame_pool_flags;
+
+	if ( pool == (MX_IMAGE_POOL *) NULL ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	/* The flags only take effect when a pool is created, so we
+	 * discard the current pool and let mxp_area_detector_lease_frame()
+	 * create a new one the next time that a frame is needed.  Frames
+	 * that are still leased from the old pool remain valid until
+	 * they are freed.
+	 */
+
+	ad->frame_pool = NULL;
+
+	mx_status = mx_image_pool_destroy( pool );
+
+	return mx_status;
+}
+
+MX_EXPORT mx_status_type
+mx_area_detector_get_datafile_write_status( MX_RECORD *ad_record,
+				unsigned long *frames_pending,
+				uint64_t *bytes_pending,
+				double *last_write_latency )
+{
+	static const char fname[] =
+		"mx_area_detector_get_datafile_write_status()";
+
+	MX_AREA_DETECTOR *ad;
+	mx_status_type mx_status;
+
+	mx_status = mx_area_detector_get_pointers( ad_record, &ad, NULL, fname );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	if ( ad->datafile_write_queue != NULL ) {
+		mxp_area_detector_collect_datafile_write_results( ad );
+
+		mx_status = mx_image_write_queue_get_status(
+					ad->datafile_write_queue,
+					&(ad->datafile_frames_pending),
+					&(ad->datafile_bytes_pending),
+					&(ad->datafile_last_write_latency) );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	} else {
+		ad->datafile_frames_pending = 0;
+		ad->datafile_bytes_pending = 0;
+	}
+
+	if ( frames_pending != (unsigned long *) NULL ) {
+		*frames_pending = ad->datafile_frames_pending;
+	}
+	if ( bytes_pending != (uint64_t *) NULL ) {
+		*bytes_pending = ad->datafile_bytes_pending;
+	}
+	if ( last_write_latency != (double *) NULL ) {
+		*last_write_latency = ad->datafile_last_write_latency;
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+MX_EXPORT mx_status_type
+mx_area_detector_flush_datafile_writes( MX_RECORD *ad_record )
+{
+	static const char fname[] = "mx_area_detector_flush_datafile_writes()";
+
+	MX_AREA_DETECTOR *ad;
+	mx_status_type mx_status;
+
+	mx_status = mx_area_detector_get_pointers( ad_record, &ad, NULL, fname );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	if ( ad->datafile_write_queue == NULL ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	mx_status = mx_image_write_queue_flush( ad->datafile_write_queue );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mxp_area_detector_collect_datafile_write_results( ad );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
 MX_EXPORT mx_status_type
 mx_area_detector_default_datafile_management_handler( MX_RECORD *record )
 {
@@ -7194,6 +7671,12 @@ mx_area_detector_default_datafile_management_handler( MX_RECORD *record )
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
+	/* Report the results of any background writes that have
+	 * finished since the last time we were called.
+	 */
+
+	mxp_area_detector_collect_datafile_write_results( ad );
+
 	mx_status = MX_SUCCESSFUL_RESULT;
 
 #if MX_AREA_DETECTOR_DEBUG_DATAFILE_AUTOSAVE_SETUP
@@ -7486,65 +7969,37 @@ mx_area_detector_default_datafile_management_handler( MX_RECORD *record )
 		MX_DEBUG(-2,("%s: Saving '%s' image frame to '%s'.",
 			fname, record->name, filename));
 #endif
-		/* Write out the image file. */
+		/* Write out the image file.  If background writer threads
+		 * have been configured, then the frame is copied to the
+		 * write queue and the result of the write is handled by
+		 * a later call to this function.
+		 */
 
-		mx_status = mx_image_write_file( ad->image_frame, NULL,
+		if ( ad->datafile_write_queue != NULL ) {
+			mx_status = mx_image_write_queue_add(
+					ad->datafile_write_queue,
+					ad->image_frame,
+					ad->datafile_save_format,
+					filename );
+
+			if ( mx_status.code != MXE_SUCCESS ) {
+				mxp_area_detector_handle_datafile_write_status(
+						ad, filename, mx_status );
+			}
+		} else {
+			mx_status = mx_image_write_file( ad->image_frame, NULL,
 						ad->datafile_save_format,
 						filename );
 
+			mxp_area_detector_handle_datafile_write_status( ad,
+							filename, mx_status );
+		}
+
 #if MX_AREA_DETECTOR_DEBUG_DATAFILE_AUTOSAVE_TIMING
 		MX_HRT_END( write_file_measurement );
 		MX_HRT_START( status_measurement );
 #endif
 
-#if 0
-		MX_DEBUG(-2,("%s: mx_image_write_file() mx_status.code = %lu",
-			fname, mx_status.code));
-		MX_DEBUG(-2,("%s: ad->filename_log_record = %p",
-			fname, ad->filename_log_record));
-#endif
-
-		if ( ( mx_status.code == MXE_SUCCESS )
-		  && ( ad->filename_log_record != (MX_RECORD *) NULL ) )
-		{
-			/* If we are logging individual filenames,
-			 * then do that now.
-			 */
-
-			(void) mx_area_detector_write_to_filename_log( ad,
-								filename );
-		} else
-		if ( mx_status.code != MXE_SUCCESS ) {
-
-			mx_area_detector_image_log_show_error( ad, mx_status );
-
-#if MX_AREA_DETECTOR_DEBUG_DATAFILE_AUTOSAVE_FAILURE
-			MX_DEBUG(-2,("%s: Autosave of '%s' by '%s' failed "
-			"with MX error code %ld.", fname,
-			filename, ad->record->name,
-			mx_status.code ));
-#endif
-			switch ( mx_status.code ) {
-			case MXE_FILE_IO_ERROR:
-				ad->latched_status |= MXSF_AD_FILE_IO_ERROR;
-				break;
-			case MXE_PERMISSION_DENIED:
-				ad->latched_status |= MXSF_AD_PERMISSION_DENIED;
-				break;
-			case MXE_DISK_FULL:
-				ad->latched_status |= MXSF_AD_DISK_FULL;
-				break;
-			default:
-				break;
-			}
-
-			ad->latched_status |= MXSF_AD_ERROR;
-
-			/* Abort the running sequence. */
-
-			(void) mx_area_detector_abort( record );
-		}
-
 		/* For area detectors that read their frames into a
 		 * circular buffer, we must indicate that this frame
 		 * has been saved.  Note that datafile_last_frame_number
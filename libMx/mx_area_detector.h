@@ -40,6 +40,12 @@ extern "C" {
 #define MX_AREA_DETECTOR_DATAFILE_PATTERN_CHAR		'#'
 #define MX_AREA_DETECTOR_DATAFILE_PATTERN_STRING	"#"
 
+/* The default limit on the amount of image data waiting to be written
+ * by the background datafile writer threads.
+ */
+
+#define MX_AREA_DETECTOR_DEFAULT_WRITE_MAX_BYTES	(256UL * 1024UL * 1024UL)
+
 /* Status bit definitions for the 'status' field. */
 
 #define MXSF_AD_ACQUISITION_IN_PROGRESS			0x1
@@ -73,6 +79,14 @@ extern "C" {
 #define MXF_AD_DEZINGER_CORRECTION_FRAME           		0x8
 #define MXF_AD_BIAS_CORR_AFTER_FLAT_FIELD		   	0x10
 
+  /* Dezingered correction frames are normally computed a frame at a time
+   * by an MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR, unless that would take
+   * more memory than keeping the frames.  MXF_AD_FULL_FRAME_DEZINGER
+   * makes MX keep every frame in memory and call mx_image_dezinger() instead.
+   */
+
+#define MXF_AD_FULL_FRAME_DEZINGER				0x20
+
   /* If MXF_AD_SAVE_FRAME_AFTER_ACQUISITION is set and we are running in an
    * MX server, then the area detector datafile management routines will
    * automatically arrange to write the image frame data out to a file.
@@ -214,6 +228,34 @@ extern "C" {
 #define MXFT_AD_USE_LOW_MEMORY_METHODS	0x10000000
 #define MXFT_AD_USE_HIGH_MEMORY_METHODS	0x20000000
 
+/* An MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR computes the same dezingered
+ * average as mx_image_dezinger() without keeping all of the frames in
+ * memory.  For each pixel, it keeps the sum and the sum of squares of the
+ * pixel values, together with the num_top_values largest values seen so
+ * far.  Since the pixels that mx_image_dezinger() throws away are those
+ * that are more than 'threshold' standard deviations above the mean, no
+ * more than N(N-1)/(N(threshold^2+1)-1) of the N values for a pixel can
+ * be thrown away, so keeping that many of the largest values is enough
+ * to get the same answer.
+ *
+ * The largest values are stored as num_top_values planes of num_pixels
+ * values each, with the largest value for each pixel in the first plane.
+ */
+
+typedef struct {
+	unsigned long num_pixels;
+	unsigned long max_frames;
+	unsigned long num_frames;
+	double threshold;
+	mx_bool_type skip_dezinger;
+
+	unsigned long num_top_values;
+
+	uint32_t *sum_array;
+	uint64_t *sum_of_squares_array;
+	uint16_t *top_value_array;
+} MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR;
+
 typedef struct {
 	struct mx_area_detector_type *area_detector;
 	MX_IMAGE_FRAME *destination_frame;
@@ -225,6 +267,7 @@ typedef struct {
 	long raw_num_exposures_to_skip;
 
 	MX_IMAGE_FRAME **dezinger_frame_array;
+	MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR *dezinger_accumulator;
 
 	double *sum_array;
 
@@ -238,6 +281,39 @@ typedef struct {
 	MX_CALLBACK_MESSAGE *callback_message;
 } MX_AREA_DETECTOR_CORRECTION_MEASUREMENT;
 
+/* A correction plan combines the dark current offset, the flat field
+ * scale, and the flat field bias for each pixel into a single table, so
+ * that the dark current and flat field corrections of a 16-bit image can
+ * be done in one pass through memory.  The table is stored in blocks of
+ * MXU_AD_CORRECTION_PLAN_BLOCK_SIZE pixels so that the vectorized kernels
+ * can load each of the values for a block directly.
+ *
+ * Masked off pixels are given an offset of -FLT_MAX, which forces them
+ * to 0 just like the separate mask correction does.
+ */
+
+#define MXU_AD_CORRECTION_PLAN_BLOCK_SIZE	8
+
+typedef struct {
+	float offset[MXU_AD_CORRECTION_PLAN_BLOCK_SIZE];
+	float scale[MXU_AD_CORRECTION_PLAN_BLOCK_SIZE];
+	uint16_t bias[MXU_AD_CORRECTION_PLAN_BLOCK_SIZE];
+} MX_AREA_DETECTOR_CORRECTION_PLAN_BLOCK;
+
+typedef struct {
+	unsigned long num_pixels;
+	unsigned long num_blocks;
+	MX_AREA_DETECTOR_CORRECTION_PLAN_BLOCK *block_array;
+
+	/* The plan is only valid for the inputs it was built from. */
+
+	MX_IMAGE_FRAME *mask_frame;
+	MX_IMAGE_FRAME *bias_frame;
+	float *dark_current_offset_array;
+	float *flat_field_scale_array;
+	mx_bool_type bias_corr_after_flat_field;
+} MX_AREA_DETECTOR_CORRECTION_PLAN;
+
 typedef struct mx_area_detector_type {
 	MX_RECORD *record;
 
@@ -491,6 +567,14 @@ typedef struct mx_area_detector_type {
 
 	double dezinger_threshold;	/* in units of standard deviation */
 
+	/* If streaming_dezinger is TRUE, correction frames are dezingered
+	 * as they arrive rather than after all of them have been read out,
+	 * as long as mx_area_detector_use_streaming_dezinger() says that
+	 * this saves memory.
+	 */
+
+	mx_bool_type streaming_dezinger;
+
 	/* saved_correction_flags is a place to store the original value
 	 * of the correction_flags field during a correction measurement.
 	 */
@@ -631,6 +715,24 @@ typedef struct mx_area_detector_type {
 
 	MX_IMAGE_FRAME *correction_calc_frame;
 
+	/* If num_correction_threads is greater than 1, then the mask,
+	 * bias, dark current, and flat field steps of the classic frame
+	 * correction for 16-bit images are split into bands of rows that
+	 * are corrected in parallel by a pool of that many threads.
+	 * correction_thread_pool points to an MX_THREAD_POOL.
+	 */
+
+	unsigned long num_correction_threads;
+
+	void *correction_thread_pool;
+
+	/* correction_plan is built the first time that a 16-bit image is
+	 * corrected after the correction frames or the correction flags
+	 * have been changed.
+	 */
+
+	MX_AREA_DETECTOR_CORRECTION_PLAN *correction_plan;
+
 	/* The datafile_... fields are used for the implementation
 	 * of automatic saving or loading of image frames.
 	 */
@@ -674,6 +776,39 @@ typedef struct mx_area_detector_type {
 
 	uint64_t disk_space[2];
 
+	/* If num_datafile_write_threads is greater than 0, then frames
+	 * saved by the datafile management handler are copied to an
+	 * image write queue and written to disk by that many background
+	 * threads.  No more than datafile_write_max_bytes of image data
+	 * may be waiting to be written at any one time.  A value of 0
+	 * for num_datafile_write_threads means that frames are written
+	 * synchronously.  datafile_write_queue points to an
+	 * MX_IMAGE_WRITE_QUEUE.
+	 */
+
+	unsigned long num_datafile_write_threads;
+	uint64_t datafile_write_max_bytes;
+
+	unsigned long datafile_frames_pending;
+	uint64_t datafile_bytes_pending;
+	double datafile_last_write_latency;
+
+	void *datafile_write_queue;
+
+	/* frame_pool points to an MX_IMAGE_POOL that is created the first
+	 * time that a frame is set up for this detector.  New image, ROI
+	 * and correction frames are leased from this pool, so that frames
+	 * that are repeatedly created and freed during an acquisition
+	 * reuse their buffers.  frame_pool_flags is passed to
+	 * mx_image_pool_create().  Changing frame_pool_flags destroys
+	 * the current pool, so that the next frame set up for the
+	 * detector comes from a new pool created with the new flags.
+	 * The pool is destroyed when the record is deleted.
+	 */
+
+	void *frame_pool;
+	unsigned long frame_pool_flags;
+
 	/* The following entries are used for oscillation exposures that 
 	 * are synchronized with a motor and a shutter.
 	 */
@@ -831,6 +966,7 @@ typedef struct mx_area_detector_type {
 #define MXLV_AD_SHOW_IMAGE_FRAME		12074
 #define MXLV_AD_IMAGE_FRAME_EXPOSURE_TIME	12075
 #define MXLV_AD_DARK_FRAME_EXPOSURE_TIME	12076
+#define MXLV_AD_NUM_CORRECTION_THREADS		12077
 
 #define MXLV_AD_AREA_DETECTOR_FLAGS		12100
 #define MXLV_AD_INITIAL_CORRECTION_FLAGS	12101
@@ -860,6 +996,12 @@ typedef struct mx_area_detector_type {
 #define MXLV_AD_DATAFILE_TOTAL_NUM_FRAMES	12516
 #define MXLV_AD_DATAFILE_LAST_FRAME_NUMBER	12517
 #define MXLV_AD_DISK_SPACE			12518
+#define MXLV_AD_NUM_DATAFILE_WRITE_THREADS	12519
+#define MXLV_AD_DATAFILE_WRITE_MAX_BYTES	12520
+#define MXLV_AD_DATAFILE_FRAMES_PENDING		12521
+#define MXLV_AD_DATAFILE_BYTES_PENDING		12522
+#define MXLV_AD_DATAFILE_LAST_WRITE_LATENCY	12523
+#define MXLV_AD_FRAME_POOL_FLAGS		12524
 
 #define MXLV_AD_OSCILLATION_MOTOR_NAME		12600
 #define MXLV_AD_SHUTTER_NAME			12601
@@ -1247,6 +1389,10 @@ typedef struct mx_area_detector_type {
 	MXF_REC_CLASS_STRUCT, offsetof(MX_AREA_DETECTOR, dezinger_threshold), \
 	{0}, NULL, 0}, \
   \
+  {-1, -1, "streaming_dezinger", MXFT_BOOL, NULL, 0, {0}, \
+	MXF_REC_CLASS_STRUCT, offsetof(MX_AREA_DETECTOR, streaming_dezinger), \
+	{0}, NULL, 0}, \
+  \
   {-1, -1, "saved_correction_flags", MXFT_HEX, NULL, 0, {0}, \
 	MXF_REC_CLASS_STRUCT, \
 		offsetof(MX_AREA_DETECTOR, saved_correction_flags), \
@@ -1328,7 +1474,13 @@ typedef struct mx_area_detector_type {
 				MXFT_DOUBLE, NULL, 0, {0}, \
 	MXF_REC_CLASS_STRUCT, \
 		offsetof( MX_AREA_DETECTOR, dark_frame_exposure_time ), \
-	{0}, NULL, MXFF_READ_ONLY }
+	{0}, NULL, MXFF_READ_ONLY }, \
+  \
+  {MXLV_AD_NUM_CORRECTION_THREADS, -1, "num_correction_threads", \
+				MXFT_ULONG, NULL, 0, {0}, \
+	MXF_REC_CLASS_STRUCT, \
+		offsetof( MX_AREA_DETECTOR, num_correction_threads ), \
+	{0}, NULL, 0 }
 
 #define MX_AREA_DETECTOR_CORRECTION_STANDARD_FIELDS \
   {MXLV_AD_AREA_DETECTOR_FLAGS, -1, "area_detector_flags", \
@@ -1483,6 +1635,41 @@ typedef struct mx_area_detector_type {
 	MXF_REC_CLASS_STRUCT, offsetof(MX_AREA_DETECTOR, disk_space), \
 	{sizeof(uint64_t)}, NULL, 0}, \
   \
+  {MXLV_AD_NUM_DATAFILE_WRITE_THREADS, -1, "num_datafile_write_threads", \
+				MXFT_ULONG, NULL, 0, {0}, \
+	MXF_REC_CLASS_STRUCT, \
+		offsetof(MX_AREA_DETECTOR, num_datafile_write_threads), \
+	{0}, NULL, 0}, \
+  \
+  {MXLV_AD_DATAFILE_WRITE_MAX_BYTES, -1, "datafile_write_max_bytes", \
+				MXFT_UINT64, NULL, 0, {0}, \
+	MXF_REC_CLASS_STRUCT, \
+		offsetof(MX_AREA_DETECTOR, datafile_write_max_bytes), \
+	{0}, NULL, 0}, \
+  \
+  {MXLV_AD_DATAFILE_FRAMES_PENDING, -1, "datafile_frames_pending", \
+				MXFT_ULONG, NULL, 0, {0}, \
+	MXF_REC_CLASS_STRUCT, \
+		offsetof(MX_AREA_DETECTOR, datafile_frames_pending), \
+	{0}, NULL, MXFF_READ_ONLY}, \
+  \
+  {MXLV_AD_DATAFILE_BYTES_PENDING, -1, "datafile_bytes_pending", \
+				MXFT_UINT64, NULL, 0, {0}, \
+	MXF_REC_CLASS_STRUCT, \
+		offsetof(MX_AREA_DETECTOR, datafile_bytes_pending), \
+	{0}, NULL, MXFF_READ_ONLY}, \
+  \
+  {MXLV_AD_DATAFILE_LAST_WRITE_LATENCY, -1, "datafile_last_write_latency", \
+				MXFT_DOUBLE, NULL, 0, {0}, \
+	MXF_REC_CLASS_STRUCT, \
+		offsetof(MX_AREA_DETECTOR, datafile_last_write_latency), \
+	{0}, NULL, MXFF_READ_ONLY}, \
+  \
+  {MXLV_AD_FRAME_POOL_FLAGS, -1, "frame_pool_flags", \
+				MXFT_HEX, NULL, 0, {0}, \
+	MXF_REC_CLASS_STRUCT, offsetof(MX_AREA_DETECTOR, frame_pool_flags), \
+	{0}, NULL, 0}, \
+  \
   {MXLV_AD_OSCILLATION_MOTOR_NAME, -1, "oscillation_motor_name", \
 			MXFT_STRING, NULL, 1, {MXU_RECORD_NAME_LENGTH}, \
 	MXF_REC_CLASS_STRUCT, \
@@ -1611,6 +1798,10 @@ MX_API mx_status_type mx_area_detector_initialize_driver( MX_DRIVER *driver,
 MX_API mx_status_type mx_area_detector_finish_record_initialization(
 						MX_RECORD *record );
 
+MX_API mx_status_type mx_area_detector_release_resources( MX_RECORD *record );
+
+MX_API mx_status_type mx_area_detector_delete_record( MX_RECORD *record );
+
 /*---*/
 
 MX_API mx_status_type mx_area_detector_get_register( MX_RECORD *record,
@@ -1980,6 +2171,23 @@ MX_API mx_status_type mx_area_detector_setup_datafile_management(
 MX_API mx_status_type mx_area_detector_default_datafile_management_handler(
 							MX_RECORD *ad_record );
 
+MX_API mx_status_type mx_area_detector_set_num_datafile_write_threads(
+				MX_RECORD *ad_record,
+				unsigned long num_datafile_write_threads );
+
+MX_API mx_status_type mx_area_detector_set_frame_pool_flags(
+				MX_RECORD *ad_record,
+				unsigned long frame_pool_flags );
+
+MX_API mx_status_type mx_area_detector_get_datafile_write_status(
+				MX_RECORD *ad_record,
+				unsigned long *frames_pending,
+				uint64_t *bytes_pending,
+				double *last_write_latency );
+
+MX_API mx_status_type mx_area_detector_flush_datafile_writes(
+				MX_RECORD *ad_record );
+
 /*---*/
 
 MX_API_PRIVATE mx_status_type mx_area_detector_vctest_extended_status(
@@ -2109,6 +2317,41 @@ MX_API mx_status_type mx_area_detector_check_for_low_memory(
 					MX_AREA_DETECTOR *ad,
 					mx_bool_type *memory_is_low );
 
+MX_API mx_status_type mx_area_detector_set_num_correction_threads(
+					MX_RECORD *ad_record,
+					unsigned long num_correction_threads );
+
+MX_API void mx_area_detector_discard_correction_plan( MX_AREA_DETECTOR *ad );
+
+MX_API mx_bool_type mx_area_detector_use_streaming_dezinger(
+			unsigned long max_frames,
+			double threshold );
+
+MX_API mx_status_type mx_area_detector_create_dezinger_accumulator(
+			MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR **accumulator,
+			unsigned long num_pixels,
+			unsigned long max_frames,
+			double threshold );
+
+MX_API void mx_area_detector_free_dezinger_accumulator(
+			MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR *accumulator );
+
+MX_API mx_status_type mx_area_detector_add_to_dezinger_accumulator(
+			MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR *accumulator,
+			MX_IMAGE_FRAME *frame );
+
+MX_API mx_status_type mx_area_detector_finish_dezinger_accumulator(
+			MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR *accumulator,
+			MX_IMAGE_FRAME *dezingered_frame );
+
+MX_API mx_status_type mx_area_detector_u16_fused_correction(
+					MX_AREA_DETECTOR *ad,
+					MX_IMAGE_FRAME *image_frame,
+					MX_IMAGE_FRAME *mask_frame,
+					MX_IMAGE_FRAME *bias_frame,
+					MX_IMAGE_FRAME *dark_current_frame,
+					MX_IMAGE_FRAME *flat_field_frame );
+
 /*---*/
 
 MX_API mx_status_type mx_area_detector_open_filename_log(MX_AREA_DETECTOR *ad);
@@ -2249,6 +2492,83 @@ MX_API mx_status_type mx_area_detector_dbl_plain_flat_field(
 					MX_IMAGE_FRAME *bias_frame,
 					MX_IMAGE_FRAME *flat_field_frame );
 
+/*---*/
+
+/* Per-pixel kernels for 16-bit images in mx_area_detector_simd.c.  They
+ * give bit-for-bit the same results as the scalar loops above, but use
+ * SSE2 or AVX2 instructions where the CPU supports them.  The bias_data
+ * pointer should be passed as NULL if bias correction is to be done after
+ * the flat field correction.
+ */
+
+#define MXT_AD_CORRECTION_KERNEL_AUTO		0
+#define MXT_AD_CORRECTION_KERNEL_SCALAR		1
+#define MXT_AD_CORRECTION_KERNEL_SSE2		2
+#define MXT_AD_CORRECTION_KERNEL_AVX2		3
+
+MX_API long mx_area_detector_get_correction_kernel( void );
+
+MX_API mx_status_type mx_area_detector_set_correction_kernel(
+					long kernel_type );
+
+MX_API void mx_area_detector_u16_precomp_dark_kernel(
+					uint16_t *image_data,
+					const uint16_t *mask_data,
+					const float *dark_current_offset,
+					unsigned long num_pixels );
+
+MX_API void mx_area_detector_u16_plain_dark_kernel(
+					uint16_t *image_data,
+					const uint16_t *mask_data,
+					const uint16_t *bias_data,
+					const uint16_t *dark_current_data,
+					double exposure_time_ratio,
+					unsigned long num_pixels );
+
+MX_API void mx_area_detector_u16_precomp_flat_kernel(
+					uint16_t *image_data,
+					const uint16_t *mask_data,
+					const uint16_t *bias_data,
+					const float *flat_field_scale,
+					unsigned long num_pixels );
+
+/* Returns TRUE if at least one unmasked pixel in the flat field
+ * was greater than the corresponding bias pixel.
+ */
+
+MX_API mx_bool_type mx_area_detector_u16_plain_flat_kernel(
+					uint16_t *image_data,
+					const uint16_t *mask_data,
+					const uint16_t *bias_data,
+					const uint16_t *flat_field_data,
+					double ffs_numerator,
+					double flat_field_scale_min,
+					double flat_field_scale_max,
+					unsigned long num_pixels );
+
+/* Does the combined dark current and flat field correction for pixels
+ * first_pixel through first_pixel + num_pixels - 1 of image_data using
+ * a correction plan.
+ */
+
+MX_API void mx_area_detector_u16_fused_kernel(
+			uint16_t *image_data,
+			const MX_AREA_DETECTOR_CORRECTION_PLAN_BLOCK *block_array,
+			unsigned long first_pixel,
+			unsigned long num_pixels );
+
+/* Adds the pixels of a 16-bit image to the sums and the planes of largest
+ * values of a dezinger accumulator.  sum_of_squares_array may be NULL.
+ */
+
+MX_API void mx_area_detector_u16_dezinger_kernel(
+					const uint16_t *image_data,
+					uint32_t *sum_array,
+					uint64_t *sum_of_squares_array,
+					uint16_t *top_value_array,
+					unsigned long num_top_values,
+					unsigned long num_pixels );
+
 #ifdef __cplusplus
 }
 #endif
@@ -50,7 +50,9 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
+#include <float.h>
 
 #include "mx_util.h"
 #include "mx_record.h"
@@ -58,6 +60,7 @@
 #include "mx_hrt_debug.h"
 #include "mx_memory.h"
 #include "mx_image.h"
+#include "mx_thread_pool.h"
 #include "mx_area_detector.h"
 
 /*=======================================================================*/
@@ -263,6 +266,10 @@ mx_area_detector_set_correction_flags( MX_RECORD *record,
 		mx_free( ad->flat_field_scale_array );
 	}
 
+	/* The frames used for correction may be different now. */
+
+	mx_area_detector_discard_correction_plan( ad );
+
 	ad->parameter_type = MXLV_AD_CORRECTION_FLAGS;
 	ad->correction_flags = correction_flags;
 
@@ -360,6 +367,8 @@ mx_area_detector_measure_correction_frame( MX_RECORD *record,
 		break;
 	}
 
+	mx_area_detector_discard_correction_plan( ad );
+
 	ad_flags = ad->area_detector_flags;
 
 	if ( ad_flags & MXF_AD_SAVE_AVERAGED_CORRECTION_FRAME ) {
@@ -868,6 +877,393 @@ mx_area_detector_default_correct_frame( MX_AREA_DETECTOR *ad )
 
 /*=======================================================================*/
 
+/* The streaming dezinger.  See the description of
+ * MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR in mx_area_detector.h.
+ */
+
+/* The sums are kept as 32-bit and 64-bit integers, which means that
+ * they are exact as long as there are no more than 65536 frames.
+ */
+
+#define MXP_AD_DEZINGER_MAX_FRAMES	65536
+
+/* mxp_ad_dezinger_num_top_values() returns the number of largest values
+ * per pixel that the accumulator must keep, or 0 if the threshold is so
+ * large that the frames are just averaged.
+ */
+
+static unsigned long
+mxp_ad_dezinger_num_top_values( unsigned long max_frames, double threshold,
+				mx_bool_type *skip_dezinger )
+{
+	double n, max_rejected;
+
+	threshold = fabs(threshold);
+
+	/* As in mx_image_dezinger(), a threshold very close to DBL_MAX
+	 * means that we just average the frames.
+	 */
+
+	if ( threshold > (DBL_MAX / 1.01) ) {
+		*skip_dezinger = TRUE;
+		return 0;
+	}
+
+	*skip_dezinger = FALSE;
+
+	/* The bound on the number of values that can be thrown away grows
+	 * with the number of frames, so the bound for max_frames also works
+	 * for any smaller number of frames.  At least one value is always
+	 * kept.
+	 */
+
+	n = (double) max_frames;
+
+	max_rejected = n * (n - 1.0) / ( n * (threshold * threshold + 1.0) - 1.0 );
+
+	if ( max_rejected >= (n - 1.0) ) {
+		return ( max_frames - 1 );
+	}
+
+	return (unsigned long) floor( max_rejected + 1.0e-6 );
+}
+
+/* The accumulator needs 4 bytes for the sum, 8 bytes for the sum of
+ * squares and 2 bytes for each of the K largest values of each pixel.
+ * The full-frame path needs 2 bytes per pixel for each of N frames.
+ * When the threshold is low, K approaches N-1 and the full-frame path
+ * uses less memory, so mx_area_detector_use_streaming_dezinger() tells
+ * the callers to use it instead.
+ */
+
+MX_EXPORT mx_bool_type
+mx_area_detector_use_streaming_dezinger( unsigned long max_frames,
+					double threshold )
+{
+	unsigned long num_top_values, streaming_bytes;
+	mx_bool_type skip_dezinger;
+
+	if ( ( max_frames < 2 ) || ( max_frames > MXP_AD_DEZINGER_MAX_FRAMES ) )
+	{
+		return FALSE;
+	}
+
+	num_top_values = mxp_ad_dezinger_num_top_values( max_frames,
+						threshold, &skip_dezinger );
+
+	if ( skip_dezinger ) {
+		streaming_bytes = sizeof(uint32_t);
+	} else {
+		streaming_bytes = sizeof(uint32_t) + sizeof(uint64_t)
+				+ num_top_values * sizeof(uint16_t);
+	}
+
+	if ( streaming_bytes >= max_frames * sizeof(uint16_t) ) {
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+MX_EXPORT mx_status_type
+mx_area_detector_create_dezinger_accumulator(
+			MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR **accumulator,
+			unsigned long num_pixels,
+			unsigned long max_frames,
+			double threshold )
+{
+	static const char fname[] =
+		"mx_area_detector_create_dezinger_accumulator()";
+
+	MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR *acc;
+
+	if ( accumulator == (MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR **) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR pointer "
+		"passed was NULL." );
+	}
+
+	*accumulator = NULL;
+
+	if ( ( max_frames < 2 ) || ( max_frames > MXP_AD_DEZINGER_MAX_FRAMES ) )
+	{
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"The number of frames to be dezingered (%lu) is outside "
+		"the allowed range of 2 to %lu.",
+			max_frames, (unsigned long) MXP_AD_DEZINGER_MAX_FRAMES );
+	}
+
+	acc = (MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR *)
+		calloc( 1, sizeof(MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR) );
+
+	if ( acc == (MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate an "
+		"MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR structure." );
+	}
+
+	acc->num_pixels = num_pixels;
+	acc->max_frames = max_frames;
+	acc->num_frames = 0;
+	acc->threshold = fabs(threshold);
+
+	acc->num_top_values = mxp_ad_dezinger_num_top_values( max_frames,
+					threshold, &(acc->skip_dezinger) );
+
+	acc->sum_array = (uint32_t *) calloc( num_pixels, sizeof(uint32_t) );
+
+	if ( acc->sum_array == (uint32_t *) NULL ) {
+		mx_area_detector_free_dezinger_accumulator( acc );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a %lu pixel "
+		"dezinger sum array.", num_pixels );
+	}
+
+	if ( acc->skip_dezinger == FALSE ) {
+		acc->sum_of_squares_array = (uint64_t *)
+				calloc( num_pixels, sizeof(uint64_t) );
+
+		if ( acc->sum_of_squares_array == (uint64_t *) NULL ) {
+			mx_area_detector_free_dezinger_accumulator( acc );
+
+			return mx_error( MXE_OUT_OF_MEMORY, fname,
+			"Ran out of memory trying to allocate a %lu pixel "
+			"dezinger sum of squares array.", num_pixels );
+		}
+	}
+
+	if ( acc->num_top_values > 0 ) {
+		acc->top_value_array = (uint16_t *) calloc(
+			acc->num_top_values * num_pixels, sizeof(uint16_t) );
+
+		if ( acc->top_value_array == (uint16_t *) NULL ) {
+			mx_area_detector_free_dezinger_accumulator( acc );
+
+			return mx_error( MXE_OUT_OF_MEMORY, fname,
+			"Ran out of memory trying to allocate %lu planes "
+			"of %lu pixels for the largest dezinger values.",
+				acc->num_top_values, num_pixels );
+		}
+	}
+
+#if MX_AREA_DETECTOR_DEBUG_DEZINGER
+	MX_DEBUG(-2,("%s: %lu pixels, %lu frames, threshold = %g, "
+		"num_top_values = %lu", fname, num_pixels, max_frames,
+		acc->threshold, acc->num_top_values));
+#endif
+
+	*accumulator = acc;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*---*/
+
+MX_EXPORT void
+mx_area_detector_free_dezinger_accumulator(
+			MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR *accumulator )
+{
+	if ( accumulator == (MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR *) NULL )
+		return;
+
+	mx_free( accumulator->sum_array );
+	mx_free( accumulator->sum_of_squares_array );
+	mx_free( accumulator->top_value_array );
+	mx_free( accumulator );
+}
+
+/*---*/
+
+MX_EXPORT mx_status_type
+mx_area_detector_add_to_dezinger_accumulator(
+			MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR *accumulator,
+			MX_IMAGE_FRAME *frame )
+{
+	static const char fname[] =
+		"mx_area_detector_add_to_dezinger_accumulator()";
+
+	if ( accumulator == (MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR pointer "
+		"passed was NULL." );
+	}
+	if ( frame == (MX_IMAGE_FRAME *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_IMAGE_FRAME pointer passed was NULL." );
+	}
+
+	if ( MXIF_IMAGE_FORMAT(frame) != MXT_IMAGE_FORMAT_GREY16 ) {
+		return mx_error( MXE_NOT_YET_IMPLEMENTED, fname,
+		"Image dezingering is currently only supported for "
+		"16-bit greyscale images." );
+	}
+
+	if ( frame->image_length < accumulator->num_pixels * sizeof(uint16_t) )
+	{
+		return mx_error( MXE_TYPE_MISMATCH, fname,
+		"The image length %lu of the frame is too short for "
+		"the %lu pixels of the dezinger accumulator.",
+			(unsigned long) frame->image_length,
+			accumulator->num_pixels );
+	}
+
+	if ( accumulator->num_frames >= accumulator->max_frames ) {
+		return mx_error( MXE_LIMIT_WAS_EXCEEDED, fname,
+		"The dezinger accumulator already contains the maximum "
+		"number of frames (%lu).", accumulator->max_frames );
+	}
+
+	mx_area_detector_u16_dezinger_kernel( frame->image_data,
+					accumulator->sum_array,
+					accumulator->sum_of_squares_array,
+					accumulator->top_value_array,
+					accumulator->num_top_values,
+					accumulator->num_pixels );
+
+	accumulator->num_frames++;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*---*/
+
+MX_EXPORT mx_status_type
+mx_area_detector_finish_dezinger_accumulator(
+			MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR *accumulator,
+			MX_IMAGE_FRAME *dezingered_frame )
+{
+	static const char fname[] =
+		"mx_area_detector_finish_dezinger_accumulator()";
+
+	unsigned long i, j, num_frames, num_pixels, num_top_values;
+	unsigned long dz_num_frames;
+	uint64_t sum, dz_sum, variance_numerator;
+	uint16_t top_value;
+	double mean, standard_deviation, scaled_threshold, dz_mean;
+	uint16_t *u16_dest_array;
+	float *flt_dest_array;
+	long dest_format;
+
+	if ( accumulator == (MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR pointer "
+		"passed was NULL." );
+	}
+	if ( dezingered_frame == (MX_IMAGE_FRAME *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The dezingered_frame pointer passed was NULL." );
+	}
+
+	num_frames = accumulator->num_frames;
+	num_pixels = accumulator->num_pixels;
+
+	if ( num_frames < 2 ) {
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"The number of frames to be dezingered (%lu) "
+		"is less than the minimum value of 2.", num_frames );
+	}
+
+	dest_format = MXIF_IMAGE_FORMAT(dezingered_frame);
+
+	switch( dest_format ) {
+	case MXT_IMAGE_FORMAT_GREY16:
+		if ( dezingered_frame->image_length
+			< num_pixels * sizeof(uint16_t) )
+		{
+			return mx_error( MXE_TYPE_MISMATCH, fname,
+			"The dezingered frame is too short to hold "
+			"%lu pixels.", num_pixels );
+		}
+		break;
+	case MXT_IMAGE_FORMAT_FLOAT:
+		if ( dezingered_frame->image_length
+			< num_pixels * sizeof(float) )
+		{
+			return mx_error( MXE_TYPE_MISMATCH, fname,
+			"The dezingered frame is too short to hold "
+			"%lu pixels.", num_pixels );
+		}
+		break;
+	default:
+		return mx_error( MXE_UNSUPPORTED, fname,
+		"Dezingered image format %ld is not supported.", dest_format );
+	}
+
+	u16_dest_array = dezingered_frame->image_data;
+	flt_dest_array = dezingered_frame->image_data;
+
+	/* If fewer than num_top_values frames were added, only the first
+	 * num_frames planes of largest values contain real pixel values.
+	 */
+
+	num_top_values = accumulator->num_top_values;
+
+	if ( num_top_values > num_frames ) {
+		num_top_values = num_frames;
+	}
+
+	for ( i = 0; i < num_pixels; i++ ) {
+		sum = accumulator->sum_array[i];
+
+		mean = (double) sum / (double) num_frames;
+
+		dz_mean = mean;
+
+		if ( accumulator->skip_dezinger == FALSE ) {
+
+			/* N * sum_of_squares - sum^2 is computed exactly,
+			 * so the standard deviation matches the two pass
+			 * calculation in mx_image_dezinger() to within
+			 * rounding.
+			 */
+
+			variance_numerator = num_frames
+				* accumulator->sum_of_squares_array[i]
+				- sum * sum;
+
+			standard_deviation = sqrt(
+				( (double) variance_numerator / num_frames )
+				/ ( ((double) num_frames) - 1.0 ) );
+
+			scaled_threshold = mx_multiply_safely(
+				accumulator->threshold, standard_deviation );
+
+			if ( fabs(scaled_threshold) >= 1.0e-30 ) {
+				dz_sum = sum;
+				dz_num_frames = num_frames;
+
+				for ( j = 0; j < num_top_values; j++ ) {
+					top_value = accumulator->top_value_array[
+							j * num_pixels + i ];
+
+					if ( ( top_value - mean )
+						< scaled_threshold )
+					{
+						break;
+					}
+
+					dz_sum -= top_value;
+					dz_num_frames--;
+				}
+
+				dz_mean = (double) dz_sum
+						/ (double) dz_num_frames;
+			}
+		}
+
+		if ( dest_format == MXT_IMAGE_FORMAT_GREY16 ) {
+			u16_dest_array[i] = (uint16_t) mx_round( dz_mean );
+		} else {
+			flt_dest_array[i] = (float) dz_mean;
+		}
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*=======================================================================*/
+
 #define MXP_AREA_DETECTOR_CLEANUP_AFTER_CORRECTION \
 do {                                                                          \
 	if ( ad->dezinger_correction_frame ) {                                             \
@@ -1001,7 +1397,7 @@ mx_area_detector_default_measure_correction( MX_AREA_DETECTOR *ad )
 		 * dezinger array.
 		 */
 
-		if ( ad->dezinger_correction_frame ) {
+		if ( corr->dezinger_frame_array != (MX_IMAGE_FRAME **) NULL ) {
 			dezinger_frame_ptr = &(corr->dezinger_frame_array[n]);
 		} else {
 			dezinger_frame_ptr = NULL;
@@ -1114,6 +1510,8 @@ mx_area_detector_cleanup_after_correction( MX_AREA_DETECTOR *ad,
 		mx_free( corr->dezinger_frame_array );
 	}
 
+	mx_area_detector_free_dezinger_accumulator( corr->dezinger_accumulator );
+
 	if ( corr->sum_array != NULL ) {
 		mx_free( corr->sum_array );
 	}
@@ -1202,6 +1600,12 @@ mx_area_detector_prepare_for_correction( MX_AREA_DETECTOR *ad,
 
 	corr->area_detector = ad;
 
+	/* mx_area_detector_process_correction_frame() finds the dezinger
+	 * accumulator through ad->correction_measurement.
+	 */
+
+	ad->correction_measurement = corr;
+
 #if MX_AREA_DETECTOR_DEBUG_MEMORY_CORRUPTION
 	mx_global_debug_pointer[0] = ad;
 
@@ -1319,6 +1723,7 @@ mx_area_detector_prepare_for_correction( MX_AREA_DETECTOR *ad,
 	}
 
 	corr->dezinger_frame_array = NULL;
+	corr->dezinger_accumulator = NULL;
 	corr->sum_array = NULL;
 
 	if ( ad->dezinger_correction_frame ) {
@@ -1331,6 +1736,29 @@ mx_area_detector_prepare_for_correction( MX_AREA_DETECTOR *ad,
 			"of correction frames if only 1 measurement "
 			"is to be performed.", ad->record->name );
 		}
+	}
+
+	if ( ad->dezinger_correction_frame && ad->streaming_dezinger
+	  && mx_area_detector_use_streaming_dezinger( corr->num_exposures,
+						ad->dezinger_threshold ) )
+	{
+
+		/* Dezinger the frames as they arrive. */
+
+		mx_status = mx_area_detector_create_dezinger_accumulator(
+					&(corr->dezinger_accumulator),
+					pixels_per_frame,
+					corr->num_exposures,
+					ad->dezinger_threshold );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			mx_area_detector_cleanup_after_correction( NULL, corr );
+			return mx_status;
+		}
+	} else
+	if ( ad->dezinger_correction_frame ) {
+
+		/* Keep all of the frames for mx_image_dezinger(). */
 
 		corr->dezinger_frame_array =
 		    calloc( corr->num_exposures, sizeof(MX_IMAGE_FRAME *) );
@@ -1402,6 +1830,7 @@ mx_area_detector_process_correction_frame( MX_AREA_DETECTOR *ad,
 	static const char fname[] =
 		"mx_area_detector_process_correction_frame()";
 
+	MX_AREA_DETECTOR_CORRECTION_MEASUREMENT *corr;
 	long i, pixels_per_frame;
 	void *void_image_data_pointer;
 	uint16_t *src_array;
@@ -1453,6 +1882,21 @@ mx_area_detector_process_correction_frame( MX_AREA_DETECTOR *ad,
 			return mx_status;
 	}
 
+	corr = ad->correction_measurement;
+
+	if ( ad->dezinger_correction_frame
+	  && ( corr != (MX_AREA_DETECTOR_CORRECTION_MEASUREMENT *) NULL )
+	  && ( corr->dezinger_accumulator != NULL ) )
+	{
+		/* Add the image frame to the streaming dezinger. */
+
+		mx_status = mx_area_detector_add_to_dezinger_accumulator(
+						corr->dezinger_accumulator,
+						ad->image_frame );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	} else
 	if ( ad->dezinger_correction_frame ) {
 		/* Copy the image frame to the dezinger frame array. */
 
@@ -1552,10 +1996,16 @@ mx_area_detector_finish_correction_calculation( MX_AREA_DETECTOR *ad,
 		MX_HRT_START( measurement );
 #endif
 
-		mx_status = mx_image_dezinger( &dest_frame,
+		if ( corr->dezinger_accumulator != NULL ) {
+			mx_status = mx_area_detector_finish_dezinger_accumulator(
+						corr->dezinger_accumulator,
+						dest_frame );
+		} else {
+			mx_status = mx_image_dezinger( &dest_frame,
 					corr->num_exposures,
 					corr->dezinger_frame_array,
 					fabs(ad->dezinger_threshold) );
+		}
 
 #if MX_AREA_DETECTOR_DEBUG_DEZINGER
 		MX_HRT_END( measurement );
@@ -1663,6 +2113,7 @@ mx_area_detector_finish_correction_calculation( MX_AREA_DETECTOR *ad,
 				mx_image_free( image_frame_array[z] );	\
 			}						\
 		}							\
+		mx_area_detector_free_dezinger_accumulator( accumulator ); \
 	} while(0)
 
 MX_EXPORT mx_status_type
@@ -1673,6 +2124,7 @@ mx_area_detector_default_dezinger_correction( MX_AREA_DETECTOR *ad )
 
 	MX_IMAGE_FRAME *dest_frame;
 	MX_IMAGE_FRAME **image_frame_array;
+	MX_AREA_DETECTOR_DEZINGER_ACCUMULATOR *accumulator;
 	unsigned long saved_correction_flags, desired_correction_flags;
 	long i, n, z, num_exposures;
 	double exposure_time;
@@ -1755,25 +2207,45 @@ mx_area_detector_default_dezinger_correction( MX_AREA_DETECTOR *ad )
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
-	/* Allocate an array of images to store the images to be used
-	 * for dezingering.
-	 */
+	image_frame_array = NULL;
+	accumulator = NULL;
+
+	if ( ad->streaming_dezinger
+	  && mx_area_detector_use_streaming_dezinger( num_exposures,
+						ad->dezinger_threshold ) )
+	{
+		/* Dezinger the images as they are read out. */
 
-	image_frame_array = malloc( num_exposures * sizeof(MX_IMAGE_FRAME *) );
+		mx_status = mx_area_detector_create_dezinger_accumulator(
+					&accumulator,
+					ad->framesize[0] * ad->framesize[1],
+					num_exposures,
+					ad->dezinger_threshold );
 
-	if ( image_frame_array == (MX_IMAGE_FRAME **) NULL ) {
-		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	} else {
+		/* Allocate an array of images to store the images to be used
+		 * for dezingering.
+		 */
+
+		image_frame_array =
+			malloc( num_exposures * sizeof(MX_IMAGE_FRAME *) );
+
+		if ( image_frame_array == (MX_IMAGE_FRAME **) NULL ) {
+			return mx_error( MXE_OUT_OF_MEMORY, fname,
 	"Could not allocate a %lu element array of MX_IMAGE_FRAME pointers.",
-			num_exposures );
-	}
+				num_exposures );
+		}
 
-	for ( i = 0; i < num_exposures; i++ ) {
-		mx_status = mx_area_detector_setup_frame( ad->record,
+		for ( i = 0; i < num_exposures; i++ ) {
+			mx_status = mx_area_detector_setup_frame( ad->record,
 						&(image_frame_array[i]) );
 
-		if ( mx_status.code != MXE_SUCCESS ) {
-			FREE_DEZINGER_ARRAYS;
-			return mx_status;
+			if ( mx_status.code != MXE_SUCCESS ) {
+				FREE_DEZINGER_ARRAYS;
+				return mx_status;
+			}
 		}
 	}
 
@@ -1878,11 +2350,18 @@ mx_area_detector_default_dezinger_correction( MX_AREA_DETECTOR *ad )
 			}
 		}
 
-		/* Transfer the frame to the image frame array. */
+		/* Add the frame to the dezinger accumulator or transfer it
+		 * to the image frame array.
+		 */
 
-		mx_status = mx_area_detector_transfer_frame( ad->record,
+		if ( accumulator != NULL ) {
+			mx_status = mx_area_detector_add_to_dezinger_accumulator(
+						accumulator, ad->image_frame );
+		} else {
+			mx_status = mx_area_detector_transfer_frame( ad->record,
 						MXFT_AD_IMAGE_FRAME,
 						&(image_frame_array[n]) );
+		}
 
 		if ( mx_status.code != MXE_SUCCESS ) {
 			FREE_DEZINGER_ARRAYS;
@@ -1894,17 +2373,23 @@ mx_area_detector_default_dezinger_correction( MX_AREA_DETECTOR *ad )
 	MX_DEBUG(-2,("%s: Dezingering images.", fname));
 #endif
 
-	mx_status = mx_image_dezinger( &dest_frame,
+	if ( accumulator != NULL ) {
+		mx_status = mx_area_detector_finish_dezinger_accumulator(
+						accumulator, dest_frame );
+	} else {
+		mx_status = mx_image_dezinger( &dest_frame,
 					num_exposures,
 					image_frame_array,
 					ad->dezinger_threshold );
+	}
+
 	FREE_DEZINGER_ARRAYS;
 
 #if MX_AREA_DETECTOR_DEBUG
 	MX_DEBUG(-2,("%s: correction measurement complete.", fname));
 #endif
 	
-	return MX_SUCCESSFUL_RESULT;
+	return mx_status;
 }
 
 /*-----------------------------------------------------------------------*/
@@ -2008,6 +2493,8 @@ mx_area_detector_compute_dark_current_offset( MX_AREA_DETECTOR *ad,
 	 * of the dark current offset array.
 	 */
 
+	mx_area_detector_discard_correction_plan( ad );
+
 	if ( ad->dark_current_offset_array != NULL ) {
 		mx_free( ad->dark_current_offset_array );
 	}
@@ -2248,6 +2735,8 @@ mx_area_detector_compute_flat_field_scale( MX_AREA_DETECTOR *ad,
 	 * of the flat field scale array.
 	 */
 
+	mx_area_detector_discard_correction_plan( ad );
+
 	if ( ad->flat_field_scale_array != NULL ) {
 		mx_free( ad->flat_field_scale_array );
 	}
@@ -2527,6 +3016,11 @@ mx_area_detector_check_for_low_memory( MX_AREA_DETECTOR *ad,
 	if ( ad->flat_field_scale_array == NULL ) {
 		extra_memory_needed += bytes_per_float_array;
 	}
+	if ( ad->correction_plan == NULL ) {
+		extra_memory_needed += row_framesize * column_framesize
+		    * sizeof(MX_AREA_DETECTOR_CORRECTION_PLAN_BLOCK)
+				/ MXU_AD_CORRECTION_PLAN_BLOCK_SIZE;
+	}
 
 #if MX_AREA_DETECTOR_DEBUG_USE_LOWMEM_METHOD
 	MX_DEBUG(-2,("%s: extra_memory_needed = %lu",
@@ -2567,22 +3061,556 @@ mx_area_detector_check_for_low_memory( MX_AREA_DETECTOR *ad,
 
 /*=======================================================================*/
 
-/* mx_area_detector_u16_precomp_dark_correction() is for use when enough
- * free memory is available that page swapping will not be required.
+/* The 16-bit classic corrections may optionally be split into bands of
+ * whole rows that are run in parallel on a thread pool belonging to the
+ * area detector.  The number of threads is set by the area detector field
+ * 'num_correction_threads'.  A value of 0 or 1 means that the correction
+ * is done entirely in the calling thread.
+ *
+ * Each pixel of the corrected image depends only on the same pixel of
+ * the image, mask, bias, dark current, and flat field frames, so the
+ * bands are independent of each other and the result is the same
+ * regardless of the number of threads used.
  */
 
-MX_EXPORT mx_status_type
-mx_area_detector_u16_precomp_dark_correction( MX_AREA_DETECTOR *ad,
-					MX_IMAGE_FRAME *image_frame,
-					MX_IMAGE_FRAME *mask_frame,
-					MX_IMAGE_FRAME *bias_frame,
-					MX_IMAGE_FRAME *dark_current_frame )
-{
-	static const char fname[] =
+#define MXP_AD_U16_PRECOMP_DARK		1
+#define MXP_AD_U16_PLAIN_DARK		2
+#define MXP_AD_U16_PRECOMP_FLAT		3
+#define MXP_AD_U16_PLAIN_FLAT		4
+#define MXP_AD_U16_FUSED		5
+
+typedef struct {
+	long kernel_type;
+	unsigned long first_pixel;
+	unsigned long num_pixels;
+
+	uint16_t *image_data_array;
+	uint16_t *mask_data_array;
+	uint16_t *bias_data_array;
+	uint16_t *correction_data_array;
+	float *correction_scale_array;
+	MX_AREA_DETECTOR_CORRECTION_PLAN_BLOCK *plan_block_array;
+
+	double exposure_time_ratio;
+	double ffs_numerator;
+	double scale_min;
+	double scale_max;
+
+	mx_bool_type some_pixels_valid;
+} MXP_AD_CORRECTION_BAND;
+
+#define MXP_AD_BAND_OFFSET(p,n)	( ((p) == NULL) ? NULL : ((p) + (n)) )
+
+static void
+mxp_area_detector_correct_band( void *task )
+{
+	MXP_AD_CORRECTION_BAND *band;
+	unsigned long first, n;
+	uint16_t *image, *mask, *bias, *correction;
+	float *scale;
+
+	band = (MXP_AD_CORRECTION_BAND *) task;
+
+	first = band->first_pixel;
+	n     = band->num_pixels;
+
+	image      = band->image_data_array + first;
+	mask       = MXP_AD_BAND_OFFSET( band->mask_data_array, first );
+	bias       = MXP_AD_BAND_OFFSET( band->bias_data_array, first );
+	correction = MXP_AD_BAND_OFFSET( band->correction_data_array, first );
+	scale      = MXP_AD_BAND_OFFSET( band->correction_scale_array, first );
+
+	switch( band->kernel_type ) {
+	case MXP_AD_U16_PRECOMP_DARK:
+		mx_area_detector_u16_precomp_dark_kernel( image,
+							mask, scale, n );
+		break;
+	case MXP_AD_U16_PLAIN_DARK:
+		mx_area_detector_u16_plain_dark_kernel( image, mask,
+				bias, correction, band->exposure_time_ratio, n );
+		break;
+	case MXP_AD_U16_PRECOMP_FLAT:
+		mx_area_detector_u16_precomp_flat_kernel( image, mask,
+							bias, scale, n );
+		break;
+	case MXP_AD_U16_PLAIN_FLAT:
+		band->some_pixels_valid =
+			mx_area_detector_u16_plain_flat_kernel( image, mask,
+					bias, correction, band->ffs_numerator,
+					band->scale_min, band->scale_max, n );
+		break;
+	case MXP_AD_U16_FUSED:
+		/* The plan is indexed from the start of the frame. */
+
+		mx_area_detector_u16_fused_kernel( band->image_data_array,
+					band->plan_block_array, first, n );
+		break;
+	}
+}
+
+/*-----------------------------------------------------------------------*/
+
+static mx_status_type
+mxp_area_detector_run_u16_correction( MX_AREA_DETECTOR *ad,
+					MX_IMAGE_FRAME *image_frame,
+					MXP_AD_CORRECTION_BAND *frame_band )
+{
+	static const char fname[] = "mxp_area_detector_run_u16_correction()";
+
+	MX_THREAD_POOL *pool;
+	MXP_AD_CORRECTION_BAND *band_array;
+	unsigned long i, num_bands, row_framesize, column_framesize;
+	unsigned long rows_per_band, extra_rows, first_row, num_rows;
+	mx_status_type mx_status;
+
+	row_framesize    = MXIF_ROW_FRAMESIZE(image_frame);
+	column_framesize = MXIF_COLUMN_FRAMESIZE(image_frame);
+
+	frame_band->first_pixel = 0;
+	frame_band->num_pixels = row_framesize * column_framesize;
+	frame_band->some_pixels_valid = FALSE;
+
+	num_bands = ad->num_correction_threads;
+
+	if ( num_bands > column_framesize ) {
+		num_bands = column_framesize;
+	}
+
+	if ( num_bands <= 1 ) {
+		mxp_area_detector_correct_band( frame_band );
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	/* Create the thread pool if it does not exist yet or if the
+	 * number of threads has been changed behind our back.
+	 */
+
+	pool = (MX_THREAD_POOL *) ad->correction_thread_pool;
+
+	if ( ( pool == (MX_THREAD_POOL *) NULL )
+	  || ( pool->num_threads != ad->num_correction_threads ) )
+	{
+		mx_status = mx_area_detector_set_num_correction_threads(
+				ad->record, ad->num_correction_threads );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		pool = (MX_THREAD_POOL *) ad->correction_thread_pool;
+	}
+
+	band_array = (MXP_AD_CORRECTION_BAND *)
+			malloc( num_bands * sizeof(MXP_AD_CORRECTION_BAND) );
+
+	if ( band_array == (MXP_AD_CORRECTION_BAND *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a %lu element "
+		"correction band array for area detector '%s'.",
+			num_bands, ad->record->name );
+	}
+
+	/* Divide the rows as evenly as possible between the bands. */
+
+	rows_per_band = column_framesize / num_bands;
+	extra_rows    = column_framesize % num_bands;
+
+	first_row = 0;
+
+	for ( i = 0; i < num_bands; i++ ) {
+		num_rows = rows_per_band;
+
+		if ( i < extra_rows ) {
+			num_rows++;
+		}
+
+		band_array[i] = *frame_band;
+
+		band_array[i].first_pixel = first_row * row_framesize;
+		band_array[i].num_pixels  = num_rows * row_framesize;
+
+		first_row += num_rows;
+	}
+
+	mx_status = mx_thread_pool_run( pool, mxp_area_detector_correct_band,
+				band_array, sizeof(MXP_AD_CORRECTION_BAND),
+				num_bands );
+
+	for ( i = 0; i < num_bands; i++ ) {
+		if ( band_array[i].some_pixels_valid ) {
+			frame_band->some_pixels_valid = TRUE;
+		}
+	}
+
+	mx_free( band_array );
+
+	return mx_status;
+}
+
+/*-----------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_area_detector_set_num_correction_threads( MX_RECORD *ad_record,
+				unsigned long num_correction_threads )
+{
+	static const char fname[] =
+		"mx_area_detector_set_num_correction_threads()";
+
+	MX_AREA_DETECTOR *ad;
+	MX_THREAD_POOL *pool;
+	mx_status_type mx_status;
+
+	mx_status = mx_area_detector_get_pointers( ad_record, &ad, NULL, fname );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	if ( num_correction_threads == 0 ) {
+		num_correction_threads = 1;
+	}
+
+	ad->num_correction_threads = num_correction_threads;
+
+	pool = (MX_THREAD_POOL *) ad->correction_thread_pool;
+
+	if ( pool != (MX_THREAD_POOL *) NULL ) {
+		if ( pool->num_threads == num_correction_threads ) {
+			return MX_SUCCESSFUL_RESULT;
+		}
+
+		ad->correction_thread_pool = NULL;
+
+		mx_status = mx_thread_pool_destroy( pool );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
+	if ( num_correction_threads <= 1 ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	mx_status = mx_thread_pool_create( &pool, num_correction_threads );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		ad->num_correction_threads = 1;
+		return mx_status;
+	}
+
+#if MX_AREA_DETECTOR_DEBUG_CORRECTION
+	MX_DEBUG(-2,("%s: area detector '%s' now uses %lu correction threads.",
+		fname, ad_record->name, num_correction_threads));
+#endif
+
+	ad->correction_thread_pool = pool;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*=======================================================================*/
+
+/* The correction plan used by mx_area_detector_u16_fused_correction() is
+ * built from the same dark current offset and flat field scale arrays
+ * that are used by the precomp functions below.  Any function that
+ * creates a new version of those arrays or changes a correction frame
+ * must discard the plan.
+ */
+
+MX_EXPORT void
+mx_area_detector_discard_correction_plan( MX_AREA_DETECTOR *ad )
+{
+	MX_AREA_DETECTOR_CORRECTION_PLAN *plan;
+
+	if ( ad == (MX_AREA_DETECTOR *) NULL ) {
+		return;
+	}
+
+	plan = ad->correction_plan;
+
+	if ( plan == (MX_AREA_DETECTOR_CORRECTION_PLAN *) NULL ) {
+		return;
+	}
+
+	ad->correction_plan = NULL;
+
+	mx_free( plan->block_array );
+	mx_free( plan );
+}
+
+/*-----------------------------------------------------------------------*/
+
+static mx_status_type
+mxp_area_detector_build_correction_plan( MX_AREA_DETECTOR *ad,
+					unsigned long num_pixels,
+					MX_IMAGE_FRAME *mask_frame,
+					MX_IMAGE_FRAME *bias_frame,
+					float *dark_current_offset_array,
+					float *flat_field_scale_array )
+{
+	static const char fname[] = "mxp_area_detector_build_correction_plan()";
+
+	MX_AREA_DETECTOR_CORRECTION_PLAN *plan;
+	MX_AREA_DETECTOR_CORRECTION_PLAN_BLOCK *block;
+	uint16_t *mask_data_array, *bias_data_array;
+	unsigned long i, j, num_blocks;
+
+#if MX_AREA_DETECTOR_DEBUG_CORRECTION_TIMING
+	MX_HRT_TIMING plan_timing;
+
+	MX_HRT_START( plan_timing );
+#endif
+
+	mx_area_detector_discard_correction_plan( ad );
+
+	if ( mask_frame == NULL ) {
+		mask_data_array = NULL;
+	} else {
+		mask_data_array = mask_frame->image_data;
+	}
+
+	/* The bias is only used by the flat field step of the plan.
+	 * If the bias correction is done after the flat field, it
+	 * is skipped here, just as in the precomp flat field function.
+	 */
+
+	if ( ( bias_frame == NULL ) || ( flat_field_scale_array == NULL )
+	  || ad->bias_corr_after_flat_field )
+	{
+		bias_data_array = NULL;
+	} else {
+		bias_data_array = bias_frame->image_data;
+	}
+
+	plan = (MX_AREA_DETECTOR_CORRECTION_PLAN *)
+			calloc( 1, sizeof(MX_AREA_DETECTOR_CORRECTION_PLAN) );
+
+	if ( plan == (MX_AREA_DETECTOR_CORRECTION_PLAN *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a correction plan "
+		"for area detector '%s'.", ad->record->name );
+	}
+
+	num_blocks = ( num_pixels + MXU_AD_CORRECTION_PLAN_BLOCK_SIZE - 1 )
+				/ MXU_AD_CORRECTION_PLAN_BLOCK_SIZE;
+
+	plan->block_array = (MX_AREA_DETECTOR_CORRECTION_PLAN_BLOCK *)
+	    malloc( num_blocks * sizeof(MX_AREA_DETECTOR_CORRECTION_PLAN_BLOCK) );
+
+	if ( plan->block_array == NULL ) {
+		mx_free( plan );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a %lu block correction "
+		"plan for area detector '%s'.", num_blocks, ad->record->name );
+	}
+
+	/* A pixel with an offset of 0, a scale of 1, and a bias of 0
+	 * is left unchanged by the fused kernels.  This is also used to
+	 * fill out the unused end of the last block.
+	 */
+
+	for ( i = 0; i < ( num_blocks * MXU_AD_CORRECTION_PLAN_BLOCK_SIZE ); i++ )
+	{
+		block = &(plan->block_array[ i / MXU_AD_CORRECTION_PLAN_BLOCK_SIZE ]);
+
+		j = i % MXU_AD_CORRECTION_PLAN_BLOCK_SIZE;
+
+		block->offset[j] = 0.0;
+		block->scale[j]  = 1.0;
+		block->bias[j]   = 0;
+
+		if ( i >= num_pixels ) {
+			continue;
+		}
+
+		if ( mask_data_array != NULL ) {
+			if ( mask_data_array[i] == 0 ) {
+				block->offset[j] = -FLT_MAX;
+				continue;
+			}
+		}
+
+		if ( dark_current_offset_array != NULL ) {
+			block->offset[j] = dark_current_offset_array[i];
+		}
+
+		if ( flat_field_scale_array != NULL ) {
+			block->scale[j] = flat_field_scale_array[i];
+
+			if ( bias_data_array != NULL ) {
+				block->bias[j] = bias_data_array[i];
+			}
+		}
+	}
+
+	plan->num_pixels = num_pixels;
+	plan->num_blocks = num_blocks;
+
+	plan->mask_frame = mask_frame;
+	plan->bias_frame = bias_frame;
+	plan->dark_current_offset_array = dark_current_offset_array;
+	plan->flat_field_scale_array = flat_field_scale_array;
+	plan->bias_corr_after_flat_field = ad->bias_corr_after_flat_field;
+
+	ad->correction_plan = plan;
+
+#if MX_AREA_DETECTOR_DEBUG_CORRECTION_TIMING
+	MX_HRT_END( plan_timing );
+	MX_HRT_RESULTS( plan_timing, fname,
+		"for building a %lu pixel correction plan.", num_pixels );
+#endif
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/* mx_area_detector_u16_fused_correction() does the mask, bias, dark
+ * current, and flat field corrections of a 16-bit image in a single pass.
+ * The results are the same as calling the precomp dark correction and
+ * precomp flat field functions one after the other, so it may only be
+ * used when no geometrical correction is done between them.
+ */
+
+MX_EXPORT mx_status_type
+mx_area_detector_u16_fused_correction( MX_AREA_DETECTOR *ad,
+					MX_IMAGE_FRAME *image_frame,
+					MX_IMAGE_FRAME *mask_frame,
+					MX_IMAGE_FRAME *bias_frame,
+					MX_IMAGE_FRAME *dark_current_frame,
+					MX_IMAGE_FRAME *flat_field_frame )
+{
+	static const char fname[] = "mx_area_detector_u16_fused_correction()";
+
+	MX_AREA_DETECTOR_CORRECTION_PLAN *plan;
+	MXP_AD_CORRECTION_BAND band;
+	float *dark_current_offset_array, *flat_field_scale_array;
+	unsigned long num_pixels;
+	double image_exposure_time;
+	long image_format;
+	mx_status_type mx_status;
+
+	if ( image_frame == NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The image_frame pointer passed was NULL." );
+	}
+
+	image_format = MXIF_IMAGE_FORMAT(image_frame);
+
+	if ( image_format != MXT_IMAGE_FORMAT_GREY16 ) {
+		return mx_error( MXE_UNSUPPORTED, fname,
+		"Image correction calculation format %ld is not supported "
+		"by this function for area detector '%s'.",
+			image_format, ad->record->name );
+	}
+
+	/* Discard the old dark current offset array if the exposure time
+	 * has changed significantly.
+	 */
+
+	mx_status = mx_image_get_exposure_time( image_frame,
+						&image_exposure_time );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	if ( mx_difference( image_exposure_time,
+				ad->old_exposure_time ) > 0.001 )
+	{
+		mx_free( ad->dark_current_offset_array );
+	}
+
+	ad->old_exposure_time = image_exposure_time;
+
+	/* Get the dark current offset and flat field scale arrays,
+	 * creating new ones if necessary.
+	 */
+
+	if ( dark_current_frame == NULL ) {
+		dark_current_offset_array = NULL;
+	} else {
+		if ( ad->dark_current_offset_array == NULL ) {
+		    mx_status = mx_area_detector_compute_dark_current_offset(
+					ad, bias_frame, dark_current_frame );
+
+		    if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+		}
+
+		dark_current_offset_array = ad->dark_current_offset_array;
+	}
+
+	if ( flat_field_frame == NULL ) {
+		flat_field_scale_array = NULL;
+	} else {
+		if ( ad->flat_field_scale_array == NULL ) {
+		    mx_status = mx_area_detector_compute_flat_field_scale(
+					ad, bias_frame, flat_field_frame );
+
+		    if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+		}
+
+		flat_field_scale_array = ad->flat_field_scale_array;
+	}
+
+	/* Rebuild the correction plan if any of its inputs have changed. */
+
+	num_pixels = MXIF_ROW_FRAMESIZE(image_frame)
+			* MXIF_COLUMN_FRAMESIZE(image_frame);
+
+	plan = ad->correction_plan;
+
+	if ( ( plan == (MX_AREA_DETECTOR_CORRECTION_PLAN *) NULL )
+	  || ( plan->num_pixels != num_pixels )
+	  || ( plan->mask_frame != mask_frame )
+	  || ( plan->bias_frame != bias_frame )
+	  || ( plan->dark_current_offset_array != dark_current_offset_array )
+	  || ( plan->flat_field_scale_array != flat_field_scale_array )
+	  || ( plan->bias_corr_after_flat_field
+	  		!= ad->bias_corr_after_flat_field ) )
+	{
+		mx_status = mxp_area_detector_build_correction_plan( ad,
+				num_pixels, mask_frame, bias_frame,
+				dark_current_offset_array,
+				flat_field_scale_array );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		plan = ad->correction_plan;
+	}
+
+	memset( &band, 0, sizeof(band) );
+
+	band.kernel_type = MXP_AD_U16_FUSED;
+	band.image_data_array = image_frame->image_data;
+	band.plan_block_array = plan->block_array;
+
+	mx_status = mxp_area_detector_run_u16_correction( ad,
+						image_frame, &band );
+
+	return mx_status;
+}
+
+/*=======================================================================*/
+
+/* mx_area_detector_u16_precomp_dark_correction() is for use when enough
+ * free memory is available that page swapping will not be required.
+ */
+
+MX_EXPORT mx_status_type
+mx_area_detector_u16_precomp_dark_correction( MX_AREA_DETECTOR *ad,
+					MX_IMAGE_FRAME *image_frame,
+					MX_IMAGE_FRAME *mask_frame,
+					MX_IMAGE_FRAME *bias_frame,
+					MX_IMAGE_FRAME *dark_current_frame )
+{
+	static const char fname[] =
 		"mx_area_detector_u16_precomp_dark_correction()";
 
-	unsigned long i, num_pixels;
-	double image_pixel, image_exposure_time;
+	MXP_AD_CORRECTION_BAND band;
+	double image_exposure_time;
 	float *dark_current_offset_array;
 	uint16_t *mask_data_array;
 	uint16_t *u16_image_data_array;
@@ -2668,108 +3696,17 @@ mx_area_detector_u16_precomp_dark_correction( MX_AREA_DETECTOR *ad,
 	MX_DEBUG(-2,("%s: dark_current_offset_array = %p",
 			fname, dark_current_offset_array));
 #endif
-	/* This loop _must_ _not_ invoke any functions.  Function calls
-	 * have too high an overhead to be used in a loop that may loop
-	 * 32 million times or more.
-	 */
-
-	num_pixels = MXIF_ROW_FRAMESIZE(image_frame)
-			* MXIF_COLUMN_FRAMESIZE(image_frame);
-
-	for ( i = 0; i < num_pixels; i++ ) {
-
-#if MX_AREA_DETECTOR_DEBUG_CORRECTION
-		if ( i < 10 ) {
-			fprintf(stderr, "i = %lu, ", i);
-		}
-#endif
-		/* See if the pixel is masked off. */
-
-		if ( mask_data_array != NULL ) {
-
-#if MX_AREA_DETECTOR_DEBUG_CORRECTION
-			if ( i < 10 ) {
-				fprintf(stderr, "mask_data_array[%lu] = %d, ",
-				    i, (int) mask_data_array[i] );
-			}
-#endif
-			if ( mask_data_array[i] == 0 ) {
-
-				/* If the pixel is masked off, skip this
-				 * pixel and return to the top of the loop
-				 * for the next pixel.
-				 */
-
-				u16_image_data_array[i] = 0;
-
-#if MX_AREA_DETECTOR_DEBUG_CORRECTION
-				if ( i < 10 ) {
-					fprintf(stderr,
-					"u16_image_data_array[%lu] = %ld\n",
-					i, (long) u16_image_data_array[i]);
-				}
-#endif
-				continue;
-			}
-		}
-
-		/* If requested, apply the dark current correction. */
-
-		if ( dark_current_offset_array != NULL ) {
-
-			/* Get the raw image pixel. */
-
-			image_pixel = (double) u16_image_data_array[i];
-
-#if MX_AREA_DETECTOR_DEBUG_CORRECTION
-			if ( i < 10 ) {
-				fprintf( stderr, "BEFORE image_pixel = %g, ",
-						image_pixel );
-				fprintf( stderr,
-				"dark_current_offset_array[%lu] = %g, ",
-					i, dark_current_offset_array[i] );
-			}
-#endif
-			image_pixel = image_pixel
-					+ dark_current_offset_array[i];
-
-#if MX_AREA_DETECTOR_DEBUG_CORRECTION
-			if ( i < 10 ) {
-				fprintf( stderr, "AFTER image_pixel = %g, ",
-						image_pixel );
-			}
-#endif
-
-			/* Round to the nearest integer by adding 0.5 and
-			 * then truncating.
-			 *
-			 * We _must_ _not_ use mx_round() here since function
-			 * calls have too high of an overhead to be used
-			 * in this loop.
-			 */
+	memset( &band, 0, sizeof(band) );
 
-			if ( image_pixel < 0.0 ) {
-				u16_image_data_array[i] = 0;
-			} else {
-				u16_image_data_array[i] = image_pixel + 0.5;
-			}
+	band.kernel_type = MXP_AD_U16_PRECOMP_DARK;
+	band.image_data_array = u16_image_data_array;
+	band.mask_data_array = mask_data_array;
+	band.correction_scale_array = dark_current_offset_array;
 
-#if MX_AREA_DETECTOR_DEBUG_CORRECTION
-			if ( i < 10 ) {
-				fprintf( stderr,
-				"Final u16_image_data_array[%lu] = %ld, ",
-					i, (long) u16_image_data_array[i]);
-			}
-#endif
-		}
-#if MX_AREA_DETECTOR_DEBUG_CORRECTION
-		if ( i < 10 ) {
-			fprintf( stderr, "\n" );
-		}
-#endif
-	}
+	mx_status = mxp_area_detector_run_u16_correction( ad,
+						image_frame, &band );
 
-	return MX_SUCCESSFUL_RESULT;
+	return mx_status;
 }
 
 /*-----------------------------------------------------------------------*/
@@ -3402,14 +4339,12 @@ mx_area_detector_u16_plain_dark_correction( MX_AREA_DETECTOR *ad,
 	static const char fname[] =
 		"mxp_area_detector_u16_plain_dark_correction()";
 
-	unsigned long i, num_pixels;
+	MXP_AD_CORRECTION_BAND band;
 	uint16_t *mask_data_array, *bias_data_array, *dark_current_data_array;
 	uint16_t *u16_image_data_array;
 	long image_format;
 	double image_exposure_time, dark_current_exposure_time;
 	double exposure_time_ratio;
-	double image_pixel, raw_dark_current, scaled_dark_current;
-	unsigned long bias_offset;
 	mx_bool_type use_scaled_dark_current;
 	mx_status_type mx_status;
 
@@ -3456,202 +4391,84 @@ mx_area_detector_u16_plain_dark_correction( MX_AREA_DETECTOR *ad,
 		bias_data_array = NULL;
 	} else {
 		bias_data_array = bias_frame->image_data;
-	}
-
-#if MX_AREA_DETECTOR_DEBUG_CORRECTION
-	MX_DEBUG(-2,("%s: bias_data_array = %p", fname, bias_data_array));
-#endif
-
-	if ( dark_current_frame == NULL ) {
-		dark_current_data_array = NULL;
-	} else {
-		dark_current_data_array = dark_current_frame->image_data;
-	}
-
-#if MX_AREA_DETECTOR_DEBUG_CORRECTION
-	MX_DEBUG(-2,("%s: dark_current_frame = %p",
-			fname, dark_current_frame));
-	MX_DEBUG(-2,("%s: dark_current_data_array = %p",
-			fname, dark_current_data_array));
-#endif
-
-	/* Compute the exposure time ratio. */
-
-	if ( ad->use_scaled_dark_current == FALSE ) {
-		use_scaled_dark_current = FALSE;
-	} else
-	if ( dark_current_frame == NULL ) {
-		use_scaled_dark_current = FALSE;
-	} else {
-		use_scaled_dark_current = TRUE;
-	}
-
-#if MX_AREA_DETECTOR_DEBUG_CORRECTION
-	MX_DEBUG(-2,("%s: use_scaled_dark_current = %d",
-		fname, (int) use_scaled_dark_current));
-#endif
-
-	if ( use_scaled_dark_current == FALSE ) {
-		exposure_time_ratio = 1.0;
-	} else {
-		mx_status = mx_image_get_exposure_time( image_frame,
-							&image_exposure_time );
-		if ( mx_status.code != MXE_SUCCESS )
-			return mx_status;
-
-		mx_status = mx_image_get_exposure_time( dark_current_frame,
-						&dark_current_exposure_time );
-
-		if ( mx_status.code != MXE_SUCCESS )
-			return mx_status;
-
-		exposure_time_ratio = mx_divide_safely( image_exposure_time,
-						dark_current_exposure_time );
-	}
-
-#if MX_AREA_DETECTOR_DEBUG_CORRECTION
-	MX_DEBUG(-2,("%s: exposure_time_ratio = %g",
-		fname, exposure_time_ratio));
-#endif
-
-	num_pixels = MXIF_ROW_FRAMESIZE(image_frame)
-			* MXIF_COLUMN_FRAMESIZE(image_frame);
-
-	/* Do the mask, bias, and dark current corrections. */
-
-	/* This loop _must_ _not_ invoke any functions.  Function calls
-	 * have too high an overhead to be used in a loop that may loop
-	 * 32 million times or more.
-	 */
-
-	for ( i = 0; i < num_pixels; i++ ) {
-
-#if MX_AREA_DETECTOR_DEBUG_CORRECTION
-		if ( i < 10 ) {
-			fprintf(stderr, "i = %lu, ", i);
-		}
-#endif
-		/* See if the pixel is masked off. */
-
-		if ( mask_data_array != NULL ) {
-
-#if MX_AREA_DETECTOR_DEBUG_CORRECTION
-			if ( i < 10 ) {
-				fprintf(stderr, "mask_data_array[%lu] = %d, ",
-				    i, (int) mask_data_array[i] );
-			}
-#endif
-			if ( mask_data_array[i] == 0 ) {
-
-				/* If the pixel is masked off, skip this
-				 * pixel and return to the top of the loop
-				 * for the next pixel.
-				 */
-
-				u16_image_data_array[i] = 0;
-
-#if MX_AREA_DETECTOR_DEBUG_CORRECTION
-				if ( i < 10 ) {
-					fprintf(stderr,
-					"u16_image_data_array[%lu] = %d\n",
-					i, (int) u16_image_data_array[i]);
-				}
-#endif
-				continue;
-			}
-		}
-
-		/* Get the bias offset for this pixel. */
-
-		if ( ad->bias_corr_after_flat_field ) {
-			bias_offset = 0;
-		} else
-		if ( bias_data_array == NULL ) {
-			bias_offset = 0;
-		} else {
-			bias_offset = bias_data_array[i];
-		}
-
-#if MX_AREA_DETECTOR_DEBUG_CORRECTION
-		if ( i < 10 ) {
-			fprintf( stderr, "bias_offset = %d, ",
-					(int) bias_offset );
-		}
-#endif
-		/* Get the raw image pixel. */
-
-		image_pixel = (double) u16_image_data_array[i];
-
-#if MX_AREA_DETECTOR_DEBUG_CORRECTION
-		if ( i < 10 ) {
-			fprintf( stderr, "BEFORE image_pixel = %g, ",
-				image_pixel );
-		}
-#endif
-
-		/* If requested, apply the dark current correction. */
-
-		if ( dark_current_data_array != NULL ) {
-			raw_dark_current = (double) dark_current_data_array[i];
-
-#if MX_AREA_DETECTOR_DEBUG_CORRECTION
-			if ( i < 10 ) {
-				fprintf( stderr, "raw_dark_current = %g, ",
-					raw_dark_current );
-			}
-#endif
-			scaled_dark_current = exposure_time_ratio
-			    * (raw_dark_current - bias_offset) + bias_offset;
+	}
 
 #if MX_AREA_DETECTOR_DEBUG_CORRECTION
-			if ( i < 10 ) {
-				fprintf( stderr, "scaled_dark_current = %g, ",
-					scaled_dark_current );
-			}
+	MX_DEBUG(-2,("%s: bias_data_array = %p", fname, bias_data_array));
 #endif
-			image_pixel = image_pixel + bias_offset;
+
+	if ( dark_current_frame == NULL ) {
+		dark_current_data_array = NULL;
+	} else {
+		dark_current_data_array = dark_current_frame->image_data;
+	}
 
 #if MX_AREA_DETECTOR_DEBUG_CORRECTION
-			if ( i < 10 ) {
-				fprintf( stderr,
-				"AFTER adding bias, image_pixel = %g, ",
-					image_pixel );
-			}
+	MX_DEBUG(-2,("%s: dark_current_frame = %p",
+			fname, dark_current_frame));
+	MX_DEBUG(-2,("%s: dark_current_data_array = %p",
+			fname, dark_current_data_array));
 #endif
-			image_pixel = image_pixel - scaled_dark_current;
+
+	/* Compute the exposure time ratio. */
+
+	if ( ad->use_scaled_dark_current == FALSE ) {
+		use_scaled_dark_current = FALSE;
+	} else
+	if ( dark_current_frame == NULL ) {
+		use_scaled_dark_current = FALSE;
+	} else {
+		use_scaled_dark_current = TRUE;
+	}
 
 #if MX_AREA_DETECTOR_DEBUG_CORRECTION
-			if ( i < 10 ) {
-				fprintf( stderr,
-			"AFTER subtracting dark current, image_pixel = %g, ",
-					image_pixel );
-			}
+	MX_DEBUG(-2,("%s: use_scaled_dark_current = %d",
+		fname, (int) use_scaled_dark_current));
 #endif
-		}
 
-		/* Round to the nearest integer by adding 0.5 and
-		 * then truncating.
-		 *
-		 * We _must_ _not_ use mx_round() here since function
-		 * calls have too high of an overhead to be used
-		 * in this loop.
-		 */
+	if ( use_scaled_dark_current == FALSE ) {
+		exposure_time_ratio = 1.0;
+	} else {
+		mx_status = mx_image_get_exposure_time( image_frame,
+							&image_exposure_time );
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
 
-		if ( image_pixel < 0.0 ) {
-			u16_image_data_array[i] = 0;
-		} else {
-			u16_image_data_array[i] = image_pixel + 0.5;
-		}
+		mx_status = mx_image_get_exposure_time( dark_current_frame,
+						&dark_current_exposure_time );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		exposure_time_ratio = mx_divide_safely( image_exposure_time,
+						dark_current_exposure_time );
+	}
 
 #if MX_AREA_DETECTOR_DEBUG_CORRECTION
-		if ( i < 10 ) {
-			fprintf( stderr, "u16_image_data_array[%lu] = %ld\n",
-				i, (long) u16_image_data_array[i] );
-		}
+	MX_DEBUG(-2,("%s: exposure_time_ratio = %g",
+		fname, exposure_time_ratio));
 #endif
+
+	/* Do the mask, bias, and dark current corrections.  If the bias
+	 * correction is done after the flat field, it is skipped here.
+	 */
+
+	memset( &band, 0, sizeof(band) );
+
+	band.kernel_type = MXP_AD_U16_PLAIN_DARK;
+	band.image_data_array = u16_image_data_array;
+	band.mask_data_array = mask_data_array;
+	band.correction_data_array = dark_current_data_array;
+	band.exposure_time_ratio = exposure_time_ratio;
+
+	if ( ad->bias_corr_after_flat_field == FALSE ) {
+		band.bias_data_array = bias_data_array;
 	}
 
-	return MX_SUCCESSFUL_RESULT;
+	mx_status = mxp_area_detector_run_u16_correction( ad,
+						image_frame, &band );
+
+	return mx_status;
 }
 
 /*-----------------------------------------------------------------------*/
@@ -4463,8 +5280,7 @@ mx_area_detector_u16_precomp_flat_field( MX_AREA_DETECTOR *ad,
 	static const char fname[] =
 		"mx_area_detector_u16_precomp_flat_field()";
 
-	unsigned long i, num_pixels;
-	double image_pixel, bias_offset;
+	MXP_AD_CORRECTION_BAND band;
 	float *flat_field_scale_array;
 	uint16_t *mask_data_array, *bias_data_array;
 	uint16_t *u16_image_data_array;
@@ -4523,64 +5339,25 @@ mx_area_detector_u16_precomp_flat_field( MX_AREA_DETECTOR *ad,
 
 	/* If requested, do the flat field correction. */
 
-	/* This loop _must_ _not_ invoke any functions.  Function calls
-	 * have too high an overhead to be used in a loop that may loop
-	 * 32 million times or more.
-	 */
-
-	if ( flat_field_scale_array != NULL ) {
-
-		num_pixels = MXIF_ROW_FRAMESIZE(image_frame)
-				* MXIF_COLUMN_FRAMESIZE(image_frame);
-
-		for ( i = 0; i < num_pixels; i++ ) {
-
-			if ( mask_data_array != NULL ) {
-				if ( mask_data_array[i] == 0 ) {
-
-					/* If the pixel is masked off, skip
-					 * this pixel and return to the top
-					 * of the loop for the next pixel.
-					 */
-
-					continue;
-				}
-			}
-
-			if ( ad->bias_corr_after_flat_field ) {
-				bias_offset = 0;
-			} else
-			if ( bias_data_array == NULL ) {
-				bias_offset = 0;
-			} else {
-				bias_offset = bias_data_array[i];
-			}
-
-			image_pixel = (double) u16_image_data_array[i];
-
-			image_pixel = image_pixel - bias_offset;
-
-			image_pixel = image_pixel * flat_field_scale_array[i];
+	if ( flat_field_scale_array == NULL ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
 
-			image_pixel = image_pixel + bias_offset;
+	memset( &band, 0, sizeof(band) );
 
-			/* Round to the nearest integer by adding 0.5 and
-			 * then truncating.
-			 *
-			 * We _must_ _not_ use mx_round() here since function
-			 * calls have too high of an overhead to be used
-			 * in this loop.
-			 */
+	band.kernel_type = MXP_AD_U16_PRECOMP_FLAT;
+	band.image_data_array = u16_image_data_array;
+	band.mask_data_array = mask_data_array;
+	band.correction_scale_array = flat_field_scale_array;
 
-			if ( image_pixel < 0.0 ) {
-				u16_image_data_array[i] = 0;
-			} else {
-				u16_image_data_array[i] = image_pixel + 0.5;
-			}
-		}
+	if ( ad->bias_corr_after_flat_field == FALSE ) {
+		band.bias_data_array = bias_data_array;
 	}
 
-	return MX_SUCCESSFUL_RESULT;
+	mx_status = mxp_area_detector_run_u16_correction( ad,
+						image_frame, &band );
+
+	return mx_status;
 }
 
 /*-----------------------------------------------------------------------*/
@@ -4982,17 +5759,13 @@ mx_area_detector_u16_plain_flat_field( MX_AREA_DETECTOR *ad,
 {
 	static const char fname[] = "mx_area_detector_u16_plain_flat_field()";
 
-	unsigned long i, num_pixels;
+	MXP_AD_CORRECTION_BAND band;
 	uint16_t *mask_data_array, *bias_data_array;
 	uint16_t *flat_field_data_array;
 	uint16_t *u16_image_data_array;
 	long image_format;
-	unsigned long raw_flat_field, bias_offset;
-	double bias_average;
-	double image_pixel, flat_field_scale_factor;
-	double ffs_numerator, ffs_denominator;
-	double flat_field_scale_max, flat_field_scale_min;
 	mx_bool_type all_pixels_underflowed;
+	mx_status_type mx_status;
 
 	/* Return now if we have not been provided with a flat field frame. */
 
@@ -5038,98 +5811,38 @@ mx_area_detector_u16_plain_flat_field( MX_AREA_DETECTOR *ad,
 		bias_data_array = bias_frame->image_data;
 	}
 
-	num_pixels = MXIF_ROW_FRAMESIZE(image_frame)
-			* MXIF_COLUMN_FRAMESIZE(image_frame);
-
-	if ( bias_data_array == NULL ) {
-		all_pixels_underflowed = FALSE;
-	} else {
-		all_pixels_underflowed = TRUE;
-	}
-
-	flat_field_scale_max = ad->flat_field_scale_max;
-	flat_field_scale_min = ad->flat_field_scale_min;
-
 	/* Now do the flat field correction. */
 
-	for ( i = 0; i < num_pixels; i++ ) {
-
-		/* See if the pixel is masked off. */
-
-		if ( mask_data_array != NULL ) {
-			if ( mask_data_array[i] == 0 ) {
-
-				/* If the pixel is masked off, skip this
-				 * pixel and return to the top of the loop
-				 * for the next pixel.
-				 */
-
-				u16_image_data_array[i] = 0;
-				continue;
-			}
-		}
-
-		image_pixel = (double) u16_image_data_array[i];
-
-		raw_flat_field = flat_field_data_array[i];
-
-		if ( ad->bias_corr_after_flat_field ) {
-			bias_offset = 0;
-			bias_average = 0;
-		} else
-		if ( bias_data_array == NULL ) {
-			bias_offset = 0;
-			bias_average = 0;
-		} else {
-			bias_offset = bias_data_array[i];
-			bias_average = ad->bias_average_intensity;
-		}
-
-		/* We _must_ _not_ use mx_divide_safely() here since function
-		 * calls have too high of an overhead to be used in this loop.
-		 */
-
-		if ( raw_flat_field <= bias_offset ) {
-			u16_image_data_array[i] = 0;
-			continue;	/* Skip to the next pixel. */
-		} else {
-			all_pixels_underflowed = FALSE;
-		}
-
-		ffs_denominator = raw_flat_field - bias_offset;
-
-		ffs_numerator = ad->flat_field_average_intensity
-					- bias_average;
-
-		flat_field_scale_factor = ffs_numerator / ffs_denominator;
+	memset( &band, 0, sizeof(band) );
 
-		if ( flat_field_scale_factor > flat_field_scale_max ) {
-			u16_image_data_array[i] = 0;
-			continue;		/* Skip to the next pixel. */
-		}
-		if ( flat_field_scale_factor < flat_field_scale_min ) {
-			u16_image_data_array[i] = 0;
-			continue;		/* Skip to the next pixel. */
-		}
+	band.kernel_type = MXP_AD_U16_PLAIN_FLAT;
+	band.image_data_array = u16_image_data_array;
+	band.mask_data_array = mask_data_array;
+	band.correction_data_array = flat_field_data_array;
+	band.scale_min = ad->flat_field_scale_min;
+	band.scale_max = ad->flat_field_scale_max;
 
-		image_pixel = image_pixel - bias_offset;
+	if ( ad->bias_corr_after_flat_field || ( bias_data_array == NULL ) ) {
+		band.ffs_numerator = ad->flat_field_average_intensity;
+	} else {
+		band.ffs_numerator = ad->flat_field_average_intensity
+					- ad->bias_average_intensity;
 
-		image_pixel = image_pixel * flat_field_scale_factor;
+		band.bias_data_array = bias_data_array;
+	}
 
-		image_pixel = image_pixel + bias_offset;
+	mx_status = mxp_area_detector_run_u16_correction( ad,
+						image_frame, &band );
 
-		/* Round to the nearest integer by adding 0.5 and then
-		 * truncating.
-		 *
-		 * We _must_ _not_ use mx_round() here since function calls
-		 * have too high of an overhead to be used in this loop.
-		 */
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
 
-		if ( image_pixel < 0.0 ) {
-			u16_image_data_array[i] = 0;
-		} else {
-			u16_image_data_array[i] = image_pixel + 0.5;
-		}
+	if ( ( bias_data_array != NULL )
+	  && ( band.some_pixels_valid == FALSE ) )
+	{
+		all_pixels_underflowed = TRUE;
+	} else {
+		all_pixels_underflowed = FALSE;
 	}
 
 	if ( all_pixels_underflowed ) {
@@ -5993,6 +6706,7 @@ mx_area_detector_classic_frame_correction( MX_RECORD *record,
 	mx_bool_type geom_corr_after_flat_field;
 	mx_bool_type correction_measurement_in_progress;
 	mx_bool_type geometrical_correction_requested;
+	mx_bool_type use_correction_plan;
 	mx_status_type mx_status;
 
 #if MX_AREA_DETECTOR_DEBUG_CORRECTION_TIMING
@@ -6252,6 +6966,33 @@ mx_area_detector_classic_frame_correction( MX_RECORD *record,
 
 	/*---*/
 
+	/* If no geometrical correction is done between the dark current
+	 * and flat field corrections, then 16-bit images can have both
+	 * corrections done in a single pass using a correction plan.
+	 * Without a flat field frame, the dark current correction is
+	 * already a single pass, so the plan is not needed.  When memory
+	 * is low, we release the memory used by the plan.
+	 */
+
+	if ( memory_is_low ) {
+		mx_area_detector_discard_correction_plan( ad );
+
+		use_correction_plan = FALSE;
+	} else
+	if ( ( correction_format == MXT_IMAGE_FORMAT_GREY16 )
+	  && ( geom_corr_before_flat == FALSE )
+	  && ( flat_field_frame != NULL ) )
+	{
+		use_correction_plan = TRUE;
+	} else {
+		use_correction_plan = FALSE;
+	}
+
+#if MX_AREA_DETECTOR_DEBUG_CORRECTION
+	MX_DEBUG(-2,("%s: use_correction_plan = %d",
+		fname, (int) use_correction_plan));
+#endif
+
 #if MX_AREA_DETECTOR_DEBUG_CORRECTION_TIMING
 	MX_HRT_START( initial_timing );
 #endif
@@ -6266,6 +7007,17 @@ mx_area_detector_classic_frame_correction( MX_RECORD *record,
 	MX_DEBUG(-2,("%s: dark_current_frame = %p", fname, dark_current_frame));
 #endif
 
+	if ( use_correction_plan ) {
+
+		/* Do the dark current and flat field corrections together. */
+
+		mx_status = mx_area_detector_u16_fused_correction( ad,
+							correction_calc_frame,
+							mask_frame,
+							bias_frame,
+							dark_current_frame,
+							flat_field_frame );
+	} else
 	if ( memory_is_low ) {
 
 		/* Do not use a precomputed dark current offset array.
@@ -6396,6 +7148,12 @@ mx_area_detector_classic_frame_correction( MX_RECORD *record,
 
 	/******* Flat field correction *******/
 
+	if ( use_correction_plan ) {
+
+		/* The flat field correction was done by the fused pass. */
+
+		mx_status = MX_SUCCESSFUL_RESULT;
+	} else
 	if ( memory_is_low ) {
 		switch( correction_format ) {
 		case MXT_IMAGE_FORMAT_GREY16:
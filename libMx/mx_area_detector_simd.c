@@ -0,0 +1,1514 @@
+/*
+ * Name:    mx_area_detector_simd.c
+ *
+ * Purpose: Vectorized per-pixel kernels for the classic 16-bit mask, bias,
+ *          dark current, and flat field corrections, and for accumulating
+ *          frames in a streaming dezinger.
+ *
+ *          Each kernel produces results that are bit-for-bit identical to
+ *          the scalar loops they replace in mx_area_detector_correction.c.
+ *          All intermediate arithmetic is done in double precision in the
+ *          same order as the scalar code, fused multiply-add instructions
+ *          are not used, and the final conversion to uint16_t uses the
+ *          same truncate-to-int32 and keep-the-low-16-bits behavior as
+ *          the scalar conversion generated by the compiler on x86.
+ *
+ *          On x86 and x86_64 systems compiled with GCC or Clang, SSE2 and
+ *          AVX2 versions of the kernels are selected at run time based on
+ *          what the CPU supports.  On all other platforms, only the scalar
+ *          versions are available.
+ *
+ * Author:  William Lavender
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Copyright 2016 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#define MX_AREA_DETECTOR_SIMD_DEBUG	FALSE
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mx_util.h"
+#include "mx_record.h"
+#include "mx_image.h"
+#include "mx_area_detector.h"
+
+#if ( defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) ) \
+	&& ( defined(__clang__) || ( __GNUC__ > 4 ) \
+		|| ( ( __GNUC__ == 4 ) && ( __GNUC_MINOR__ >= 9 ) ) ) )
+#  define MXP_HAVE_X86_SIMD	TRUE
+#else
+#  define MXP_HAVE_X86_SIMD	FALSE
+#endif
+
+#if MXP_HAVE_X86_SIMD
+#  include <immintrin.h>
+
+#  define MXP_SSE2	__attribute__((target("sse2")))
+#  define MXP_AVX2	__attribute__((target("avx2")))
+
+/* MX is normally compiled without optimization, so the small helper
+ * functions below must be inlined explicitly.
+ */
+
+#  define MXP_SSE2_INLINE \
+		static inline __attribute__((target("sse2"), always_inline))
+#  define MXP_AVX2_INLINE \
+		static inline __attribute__((target("avx2"), always_inline))
+#endif
+
+static long mxp_correction_kernel = -1;
+
+/*=======================================================================*/
+
+/* The scalar kernels.  These are the reference implementations and are
+ * also used for the leftover pixels at the end of the vectorized loops.
+ */
+
+static void
+mxp_scalar_u16_precomp_dark( uint16_t *image_data,
+				const uint16_t *mask_data,
+				const float *dark_current_offset,
+				unsigned long num_pixels )
+{
+	unsigned long i;
+	double image_pixel;
+
+	for ( i = 0; i < num_pixels; i++ ) {
+		if ( mask_data != NULL ) {
+			if ( mask_data[i] == 0 ) {
+				image_data[i] = 0;
+				continue;
+			}
+		}
+
+		if ( dark_current_offset != NULL ) {
+			image_pixel = (double) image_data[i];
+
+			image_pixel = image_pixel + dark_current_offset[i];
+
+			if ( image_pixel < 0.0 ) {
+				image_data[i] = 0;
+			} else {
+				image_data[i] = image_pixel + 0.5;
+			}
+		}
+	}
+}
+
+static void
+mxp_scalar_u16_plain_dark( uint16_t *image_data,
+				const uint16_t *mask_data,
+				const uint16_t *bias_data,
+				const uint16_t *dark_current_data,
+				double exposure_time_ratio,
+				unsigned long num_pixels )
+{
+	unsigned long i, bias_offset;
+	double image_pixel, raw_dark_current, scaled_dark_current;
+
+	for ( i = 0; i < num_pixels; i++ ) {
+		if ( mask_data != NULL ) {
+			if ( mask_data[i] == 0 ) {
+				image_data[i] = 0;
+				continue;
+			}
+		}
+
+		if ( bias_data == NULL ) {
+			bias_offset = 0;
+		} else {
+			bias_offset = bias_data[i];
+		}
+
+		image_pixel = (double) image_data[i];
+
+		if ( dark_current_data != NULL ) {
+			raw_dark_current = (double) dark_current_data[i];
+
+			scaled_dark_current = exposure_time_ratio
+			    * (raw_dark_current - bias_offset) + bias_offset;
+
+			image_pixel = image_pixel + bias_offset;
+
+			image_pixel = image_pixel - scaled_dark_current;
+		}
+
+		if ( image_pixel < 0.0 ) {
+			image_data[i] = 0;
+		} else {
+			image_data[i] = image_pixel + 0.5;
+		}
+	}
+}
+
+static void
+mxp_scalar_u16_precomp_flat( uint16_t *image_data,
+				const uint16_t *mask_data,
+				const uint16_t *bias_data,
+				const float *flat_field_scale,
+				unsigned long num_pixels )
+{
+	unsigned long i;
+	double image_pixel, bias_offset;
+
+	for ( i = 0; i < num_pixels; i++ ) {
+		if ( mask_data != NULL ) {
+			if ( mask_data[i] == 0 ) {
+				continue;
+			}
+		}
+
+		if ( bias_data == NULL ) {
+			bias_offset = 0;
+		} else {
+			bias_offset = bias_data[i];
+		}
+
+		image_pixel = (double) image_data[i];
+
+		image_pixel = image_pixel - bias_offset;
+
+		image_pixel = image_pixel * flat_field_scale[i];
+
+		image_pixel = image_pixel + bias_offset;
+
+		if ( image_pixel < 0.0 ) {
+			image_data[i] = 0;
+		} else {
+			image_data[i] = image_pixel + 0.5;
+		}
+	}
+}
+
+static mx_bool_type
+mxp_scalar_u16_plain_flat( uint16_t *image_data,
+				const uint16_t *mask_data,
+				const uint16_t *bias_data,
+				const uint16_t *flat_field_data,
+				double ffs_numerator,
+				double flat_field_scale_min,
+				double flat_field_scale_max,
+				unsigned long num_pixels )
+{
+	unsigned long i, raw_flat_field, bias_offset;
+	double image_pixel, flat_field_scale_factor, ffs_denominator;
+	mx_bool_type some_pixels_valid;
+
+	some_pixels_valid = FALSE;
+
+	for ( i = 0; i < num_pixels; i++ ) {
+		if ( mask_data != NULL ) {
+			if ( mask_data[i] == 0 ) {
+				image_data[i] = 0;
+				continue;
+			}
+		}
+
+		image_pixel = (double) image_data[i];
+
+		raw_flat_field = flat_field_data[i];
+
+		if ( bias_data == NULL ) {
+			bias_offset = 0;
+		} else {
+			bias_offset = bias_data[i];
+		}
+
+		if ( raw_flat_field <= bias_offset ) {
+			image_data[i] = 0;
+			continue;
+		} else {
+			some_pixels_valid = TRUE;
+		}
+
+		ffs_denominator = raw_flat_field - bias_offset;
+
+		flat_field_scale_factor = ffs_numerator / ffs_denominator;
+
+		if ( flat_field_scale_factor > flat_field_scale_max ) {
+			image_data[i] = 0;
+			continue;
+		}
+		if ( flat_field_scale_factor < flat_field_scale_min ) {
+			image_data[i] = 0;
+			continue;
+		}
+
+		image_pixel = image_pixel - bias_offset;
+
+		image_pixel = image_pixel * flat_field_scale_factor;
+
+		image_pixel = image_pixel + bias_offset;
+
+		if ( image_pixel < 0.0 ) {
+			image_data[i] = 0;
+		} else {
+			image_data[i] = image_pixel + 0.5;
+		}
+	}
+
+	return some_pixels_valid;
+}
+
+/* The fused kernel does the same arithmetic as the precomp dark kernel
+ * followed by the precomp flat kernel, including the rounding of the
+ * intermediate result to 16 bits, but only reads and writes each image
+ * pixel once.
+ */
+
+static void
+mxp_scalar_u16_fused( uint16_t *image_data,
+		const MX_AREA_DETECTOR_CORRECTION_PLAN_BLOCK *block_array,
+		unsigned long first_pixel,
+		unsigned long num_pixels )
+{
+	const MX_AREA_DETECTOR_CORRECTION_PLAN_BLOCK *block;
+	unsigned long i, j, end;
+	double image_pixel, bias_offset;
+	uint16_t dark_corrected_pixel;
+
+	end = first_pixel + num_pixels;
+
+	for ( i = first_pixel; i < end; i++ ) {
+		block = &block_array[ i / MXU_AD_CORRECTION_PLAN_BLOCK_SIZE ];
+
+		j = i % MXU_AD_CORRECTION_PLAN_BLOCK_SIZE;
+
+		/* Mask and dark current correction. */
+
+		image_pixel = (double) image_data[i];
+
+		image_pixel = image_pixel + block->offset[j];
+
+		if ( image_pixel < 0.0 ) {
+			dark_corrected_pixel = 0;
+		} else {
+			dark_corrected_pixel = image_pixel + 0.5;
+		}
+
+		/* Flat field correction. */
+
+		bias_offset = block->bias[j];
+
+		image_pixel = (double) dark_corrected_pixel;
+
+		image_pixel = image_pixel - bias_offset;
+
+		image_pixel = image_pixel * block->scale[j];
+
+		image_pixel = image_pixel + bias_offset;
+
+		if ( image_pixel < 0.0 ) {
+			image_data[i] = 0;
+		} else {
+			image_data[i] = image_pixel + 0.5;
+		}
+	}
+}
+
+/* Returns the number of pixels from first_pixel to the start of the
+ * next plan block, but no more than num_pixels.
+ */
+
+static unsigned long
+mxp_fused_head_length( unsigned long first_pixel, unsigned long num_pixels )
+{
+	unsigned long head_length;
+
+	head_length = ( MXU_AD_CORRECTION_PLAN_BLOCK_SIZE
+			- first_pixel % MXU_AD_CORRECTION_PLAN_BLOCK_SIZE )
+				% MXU_AD_CORRECTION_PLAN_BLOCK_SIZE;
+
+	if ( head_length > num_pixels ) {
+		head_length = num_pixels;
+	}
+
+	return head_length;
+}
+
+/* The dezinger kernel adds each pixel value to the running sums and then
+ * inserts it into that pixel's list of largest values.  The insertion is
+ * written as a chain of max/min steps so that the vectorized versions can
+ * do exactly the same thing without branches.
+ */
+
+static void
+mxp_scalar_u16_dezinger( const uint16_t *image_data,
+				uint32_t *sum_array,
+				uint64_t *sum_of_squares_array,
+				uint16_t *top_value_array,
+				unsigned long num_top_values,
+				unsigned long plane_size,
+				unsigned long first_pixel,
+				unsigned long end )
+{
+	unsigned long i, j;
+	uint16_t pixel, top_value;
+	uint16_t *top_ptr;
+
+	for ( i = first_pixel; i < end; i++ ) {
+		pixel = image_data[i];
+
+		sum_array[i] += pixel;
+
+		if ( sum_of_squares_array != NULL ) {
+			sum_of_squares_array[i] += (uint32_t) pixel * pixel;
+		}
+
+		for ( j = 0; j < num_top_values; j++ ) {
+			top_ptr = top_value_array + j * plane_size + i;
+
+			top_value = *top_ptr;
+
+			if ( pixel > top_value ) {
+				*top_ptr = pixel;
+				pixel = top_value;
+			}
+		}
+	}
+}
+
+/*=======================================================================*/
+
+#if MXP_HAVE_X86_SIMD
+
+/* The SSE2 kernels process 4 pixels per pass as two pairs of doubles. */
+
+/* Convert 4 unsigned 16-bit pixels to two pairs of doubles. */
+
+MXP_SSE2_INLINE void
+mxp_sse2_u16_to_pd( __m128i v, __m128d *lo, __m128d *hi )
+{
+	v = _mm_unpacklo_epi16( v, _mm_setzero_si128() );
+
+	*lo = _mm_cvtepi32_pd( v );
+	*hi = _mm_cvtepi32_pd( _mm_shuffle_epi32( v, _MM_SHUFFLE(1,0,3,2) ) );
+}
+
+MXP_SSE2_INLINE void
+mxp_sse2_load_u16( const uint16_t *src, __m128d *lo, __m128d *hi )
+{
+	mxp_sse2_u16_to_pd( _mm_loadl_epi64( (const __m128i *) src ),
+				lo, hi );
+}
+
+MXP_SSE2_INLINE void
+mxp_sse2_load_flt( const float *src, __m128d *lo, __m128d *hi )
+{
+	__m128 f;
+
+	f = _mm_loadu_ps( src );
+
+	*lo = _mm_cvtps_pd( f );
+	*hi = _mm_cvtps_pd( _mm_movehl_ps( f, f ) );
+}
+
+/* Round two pairs of doubles to 4 unsigned 16-bit pixels in the low
+ * 64 bits of the result.  Negative values and NaNs become 0, just as
+ * in the scalar code.  Values that do not fit in 16 bits keep only
+ * their low 16 bits, which is what the scalar conversion does too.
+ */
+
+MXP_SSE2_INLINE __m128i
+mxp_sse2_round_u16( __m128d lo, __m128d hi )
+{
+	const __m128d zero = _mm_setzero_pd();
+	const __m128d half = _mm_set1_pd( 0.5 );
+	__m128i ilo, ihi, v;
+
+	lo = _mm_and_pd( lo, _mm_cmpge_pd( lo, zero ) );
+	hi = _mm_and_pd( hi, _mm_cmpge_pd( hi, zero ) );
+
+	ilo = _mm_cvttpd_epi32( _mm_add_pd( lo, half ) );
+	ihi = _mm_cvttpd_epi32( _mm_add_pd( hi, half ) );
+
+	v = _mm_unpacklo_epi64( ilo, ihi );
+
+	v = _mm_srai_epi32( _mm_slli_epi32( v, 16 ), 16 );
+
+	return _mm_packs_epi32( v, v );
+}
+
+/* Returns all ones in each 16-bit lane whose mask pixel is 0. */
+
+MXP_SSE2_INLINE __m128i
+mxp_sse2_masked_off( const uint16_t *mask_data )
+{
+	return _mm_cmpeq_epi16(
+		_mm_loadl_epi64( (const __m128i *) mask_data ),
+		_mm_setzero_si128() );
+}
+
+static MXP_SSE2 void
+mxp_sse2_u16_precomp_dark( uint16_t *image_data,
+				const uint16_t *mask_data,
+				const float *dark_current_offset,
+				unsigned long num_pixels )
+{
+	unsigned long i, num_vector_pixels;
+	__m128d img_lo, img_hi, off_lo, off_hi;
+	__m128i result;
+
+	num_vector_pixels = num_pixels & ~3UL;
+
+	if ( dark_current_offset == NULL ) {
+		mxp_scalar_u16_precomp_dark( image_data, mask_data,
+						NULL, num_pixels );
+		return;
+	}
+
+	for ( i = 0; i < num_vector_pixels; i += 4 ) {
+		mxp_sse2_load_u16( image_data + i, &img_lo, &img_hi );
+		mxp_sse2_load_flt( dark_current_offset + i, &off_lo, &off_hi );
+
+		result = mxp_sse2_round_u16( _mm_add_pd( img_lo, off_lo ),
+					_mm_add_pd( img_hi, off_hi ) );
+
+		if ( mask_data != NULL ) {
+			result = _mm_andnot_si128(
+				mxp_sse2_masked_off( mask_data + i ), result );
+		}
+
+		_mm_storel_epi64( (__m128i *) (image_data + i), result );
+	}
+
+	mxp_scalar_u16_precomp_dark( image_data + i,
+			( mask_data == NULL ) ? NULL : mask_data + i,
+			dark_current_offset + i, num_pixels - i );
+}
+
+static MXP_SSE2 void
+mxp_sse2_u16_plain_dark( uint16_t *image_data,
+				const uint16_t *mask_data,
+				const uint16_t *bias_data,
+				const uint16_t *dark_current_data,
+				double exposure_time_ratio,
+				unsigned long num_pixels )
+{
+	unsigned long i, num_vector_pixels;
+	const __m128d ratio = _mm_set1_pd( exposure_time_ratio );
+	__m128d img_lo, img_hi, bias_lo, bias_hi, dark_lo, dark_hi;
+	__m128i result;
+
+	num_vector_pixels = num_pixels & ~3UL;
+
+	bias_lo = bias_hi = _mm_setzero_pd();
+
+	for ( i = 0; i < num_vector_pixels; i += 4 ) {
+		mxp_sse2_load_u16( image_data + i, &img_lo, &img_hi );
+
+		if ( dark_current_data != NULL ) {
+			if ( bias_data != NULL ) {
+				mxp_sse2_load_u16( bias_data + i,
+						&bias_lo, &bias_hi );
+			}
+
+			mxp_sse2_load_u16( dark_current_data + i,
+						&dark_lo, &dark_hi );
+
+			dark_lo = _mm_add_pd( _mm_mul_pd( ratio,
+					_mm_sub_pd( dark_lo, bias_lo ) ),
+					bias_lo );
+			dark_hi = _mm_add_pd( _mm_mul_pd( ratio,
+					_mm_sub_pd( dark_hi, bias_hi ) ),
+					bias_hi );
+
+			img_lo = _mm_sub_pd( _mm_add_pd( img_lo, bias_lo ),
+						dark_lo );
+			img_hi = _mm_sub_pd( _mm_add_pd( img_hi, bias_hi ),
+						dark_hi );
+		}
+
+		result = mxp_sse2_round_u16( img_lo, img_hi );
+
+		if ( mask_data != NULL ) {
+			result = _mm_andnot_si128(
+				mxp_sse2_masked_off( mask_data + i ), result );
+		}
+
+		_mm_storel_epi64( (__m128i *) (image_data + i), result );
+	}
+
+	mxp_scalar_u16_plain_dark( image_data + i,
+			( mask_data == NULL ) ? NULL : mask_data + i,
+			( bias_data == NULL ) ? NULL : bias_data + i,
+			( dark_current_data == NULL ) ?
+				NULL : dark_current_data + i,
+			exposure_time_ratio, num_pixels - i );
+}
+
+static MXP_SSE2 void
+mxp_sse2_u16_precomp_flat( uint16_t *image_data,
+				const uint16_t *mask_data,
+				const uint16_t *bias_data,
+				const float *flat_field_scale,
+				unsigned long num_pixels )
+{
+	unsigned long i, num_vector_pixels;
+	__m128d img_lo, img_hi, bias_lo, bias_hi, scale_lo, scale_hi;
+	__m128i original, result, masked_off;
+
+	num_vector_pixels = num_pixels & ~3UL;
+
+	bias_lo = bias_hi = _mm_setzero_pd();
+
+	for ( i = 0; i < num_vector_pixels; i += 4 ) {
+		original = _mm_loadl_epi64( (const __m128i *) (image_data + i) );
+
+		mxp_sse2_load_u16( image_data + i, &img_lo, &img_hi );
+		mxp_sse2_load_flt( flat_field_scale + i, &scale_lo, &scale_hi );
+
+		if ( bias_data != NULL ) {
+			mxp_sse2_load_u16( bias_data + i, &bias_lo, &bias_hi );
+		}
+
+		img_lo = _mm_add_pd( _mm_mul_pd(
+			_mm_sub_pd( img_lo, bias_lo ), scale_lo ), bias_lo );
+		img_hi = _mm_add_pd( _mm_mul_pd(
+			_mm_sub_pd( img_hi, bias_hi ), scale_hi ), bias_hi );
+
+		result = mxp_sse2_round_u16( img_lo, img_hi );
+
+		/* Masked off pixels are left unchanged. */
+
+		if ( mask_data != NULL ) {
+			masked_off = mxp_sse2_masked_off( mask_data + i );
+
+			result = _mm_or_si128(
+				_mm_and_si128( masked_off, original ),
+				_mm_andnot_si128( masked_off, result ) );
+		}
+
+		_mm_storel_epi64( (__m128i *) (image_data + i), result );
+	}
+
+	mxp_scalar_u16_precomp_flat( image_data + i,
+			( mask_data == NULL ) ? NULL : mask_data + i,
+			( bias_data == NULL ) ? NULL : bias_data + i,
+			flat_field_scale + i, num_pixels - i );
+}
+
+static MXP_SSE2 mx_bool_type
+mxp_sse2_u16_plain_flat( uint16_t *image_data,
+				const uint16_t *mask_data,
+				const uint16_t *bias_data,
+				const uint16_t *flat_field_data,
+				double ffs_numerator,
+				double flat_field_scale_min,
+				double flat_field_scale_max,
+				unsigned long num_pixels )
+{
+	unsigned long i, num_vector_pixels;
+	const __m128i zero = _mm_setzero_si128();
+	const __m128d numerator = _mm_set1_pd( ffs_numerator );
+	const __m128d scale_min = _mm_set1_pd( flat_field_scale_min );
+	const __m128d scale_max = _mm_set1_pd( flat_field_scale_max );
+	__m128i img32, flat32, bias32, valid32, valid_any;
+	__m128d img_lo, img_hi, bias_lo, bias_hi, scale_lo, scale_hi;
+	__m128d keep_lo, keep_hi;
+	mx_bool_type some_pixels_valid;
+
+	num_vector_pixels = num_pixels & ~3UL;
+
+	bias32 = zero;
+	valid_any = zero;
+
+	for ( i = 0; i < num_vector_pixels; i += 4 ) {
+		img32 = _mm_unpacklo_epi16( _mm_loadl_epi64(
+			(const __m128i *) (image_data + i) ), zero );
+		flat32 = _mm_unpacklo_epi16( _mm_loadl_epi64(
+			(const __m128i *) (flat_field_data + i) ), zero );
+
+		if ( bias_data != NULL ) {
+			bias32 = _mm_unpacklo_epi16( _mm_loadl_epi64(
+				(const __m128i *) (bias_data + i) ), zero );
+		}
+
+		/* A pixel is usable if it is not masked off and its
+		 * flat field value is above the bias.
+		 */
+
+		valid32 = _mm_cmpgt_epi32( flat32, bias32 );
+
+		if ( mask_data != NULL ) {
+			valid32 = _mm_andnot_si128( _mm_cmpeq_epi32(
+				_mm_unpacklo_epi16( _mm_loadl_epi64(
+				    (const __m128i *) (mask_data + i) ), zero ),
+				zero ), valid32 );
+		}
+
+		valid_any = _mm_or_si128( valid_any, valid32 );
+
+		/* The denominator is exact in 32-bit integers.  Lanes that
+		 * are not usable may divide by zero, but they are discarded
+		 * below.
+		 */
+
+		flat32 = _mm_sub_epi32( flat32, bias32 );
+
+		scale_lo = _mm_div_pd( numerator, _mm_cvtepi32_pd( flat32 ) );
+		scale_hi = _mm_div_pd( numerator, _mm_cvtepi32_pd(
+			_mm_shuffle_epi32( flat32, _MM_SHUFFLE(1,0,3,2) ) ) );
+
+		keep_lo = _mm_and_pd(
+			_mm_castsi128_pd( _mm_unpacklo_epi32(valid32, valid32) ),
+			_mm_and_pd( _mm_cmple_pd( scale_lo, scale_max ),
+				_mm_cmpge_pd( scale_lo, scale_min ) ) );
+		keep_hi = _mm_and_pd(
+			_mm_castsi128_pd( _mm_unpackhi_epi32(valid32, valid32) ),
+			_mm_and_pd( _mm_cmple_pd( scale_hi, scale_max ),
+				_mm_cmpge_pd( scale_hi, scale_min ) ) );
+
+		img_lo = _mm_cvtepi32_pd( img32 );
+		img_hi = _mm_cvtepi32_pd(
+			_mm_shuffle_epi32( img32, _MM_SHUFFLE(1,0,3,2) ) );
+
+		bias_lo = _mm_cvtepi32_pd( bias32 );
+		bias_hi = _mm_cvtepi32_pd(
+			_mm_shuffle_epi32( bias32, _MM_SHUFFLE(1,0,3,2) ) );
+
+		img_lo = _mm_add_pd( _mm_mul_pd(
+			_mm_sub_pd( img_lo, bias_lo ), scale_lo ), bias_lo );
+		img_hi = _mm_add_pd( _mm_mul_pd(
+			_mm_sub_pd( img_hi, bias_hi ), scale_hi ), bias_hi );
+
+		/* Discarded pixels are forced to 0.0, which rounds to 0. */
+
+		img_lo = _mm_and_pd( img_lo, keep_lo );
+		img_hi = _mm_and_pd( img_hi, keep_hi );
+
+		_mm_storel_epi64( (__m128i *) (image_data + i),
+				mxp_sse2_round_u16( img_lo, img_hi ) );
+	}
+
+	some_pixels_valid = ( _mm_movemask_epi8( valid_any ) != 0 );
+
+	if ( mxp_scalar_u16_plain_flat( image_data + i,
+			( mask_data == NULL ) ? NULL : mask_data + i,
+			( bias_data == NULL ) ? NULL : bias_data + i,
+			flat_field_data + i, ffs_numerator,
+			flat_field_scale_min, flat_field_scale_max,
+			num_pixels - i ) )
+	{
+		some_pixels_valid = TRUE;
+	}
+
+	return some_pixels_valid;
+}
+
+static MXP_SSE2 void
+mxp_sse2_u16_fused( uint16_t *image_data,
+		const MX_AREA_DETECTOR_CORRECTION_PLAN_BLOCK *block_array,
+		unsigned long first_pixel,
+		unsigned long num_pixels )
+{
+	const MX_AREA_DETECTOR_CORRECTION_PLAN_BLOCK *block;
+	unsigned long i, j, end;
+	__m128d img_lo, img_hi, off_lo, off_hi;
+	__m128d bias_lo, bias_hi, scale_lo, scale_hi;
+	__m128i dark_corrected;
+
+	end = first_pixel + num_pixels;
+
+	i = first_pixel + mxp_fused_head_length( first_pixel, num_pixels );
+
+	mxp_scalar_u16_fused( image_data, block_array,
+				first_pixel, i - first_pixel );
+
+	for ( ; ( i + MXU_AD_CORRECTION_PLAN_BLOCK_SIZE ) <= end;
+			i += MXU_AD_CORRECTION_PLAN_BLOCK_SIZE )
+	{
+		block = &block_array[ i / MXU_AD_CORRECTION_PLAN_BLOCK_SIZE ];
+
+		for ( j = 0; j < MXU_AD_CORRECTION_PLAN_BLOCK_SIZE; j += 4 ) {
+			mxp_sse2_load_u16( image_data + i + j,
+						&img_lo, &img_hi );
+			mxp_sse2_load_flt( block->offset + j,
+						&off_lo, &off_hi );
+
+			dark_corrected = mxp_sse2_round_u16(
+						_mm_add_pd( img_lo, off_lo ),
+						_mm_add_pd( img_hi, off_hi ) );
+
+			mxp_sse2_u16_to_pd( dark_corrected, &img_lo, &img_hi );
+
+			mxp_sse2_load_u16( block->bias + j,
+						&bias_lo, &bias_hi );
+			mxp_sse2_load_flt( block->scale + j,
+						&scale_lo, &scale_hi );
+
+			img_lo = _mm_add_pd( _mm_mul_pd(
+				_mm_sub_pd( img_lo, bias_lo ), scale_lo ),
+				bias_lo );
+			img_hi = _mm_add_pd( _mm_mul_pd(
+				_mm_sub_pd( img_hi, bias_hi ), scale_hi ),
+				bias_hi );
+
+			_mm_storel_epi64( (__m128i *) (image_data + i + j),
+				mxp_sse2_round_u16( img_lo, img_hi ) );
+		}
+	}
+
+	mxp_scalar_u16_fused( image_data, block_array, i, end - i );
+}
+
+/* Adds four 32-bit values to four 64-bit sums. */
+
+MXP_SSE2_INLINE void
+mxp_sse2_add_u32_to_u64( uint64_t *dest, __m128i v )
+{
+	__m128i zero, sum;
+
+	zero = _mm_setzero_si128();
+
+	sum = _mm_loadu_si128( (const __m128i *) dest );
+	sum = _mm_add_epi64( sum, _mm_unpacklo_epi32( v, zero ) );
+	_mm_storeu_si128( (__m128i *) dest, sum );
+
+	sum = _mm_loadu_si128( (const __m128i *) (dest + 2) );
+	sum = _mm_add_epi64( sum, _mm_unpackhi_epi32( v, zero ) );
+	_mm_storeu_si128( (__m128i *) (dest + 2), sum );
+}
+
+/* SSE2 has no unsigned 16-bit max or min, so they are made out of
+ * saturating subtraction.  The dezinger kernel does 8 pixels per pass.
+ */
+
+static MXP_SSE2 void
+mxp_sse2_u16_dezinger( const uint16_t *image_data,
+				uint32_t *sum_array,
+				uint64_t *sum_of_squares_array,
+				uint16_t *top_value_array,
+				unsigned long num_top_values,
+				unsigned long num_pixels )
+{
+	unsigned long i, j;
+	uint16_t *top_ptr;
+	__m128i zero, pixel, sum, square_lo, square_hi, top, excess;
+
+	zero = _mm_setzero_si128();
+
+	for ( i = 0; ( i + 8 ) <= num_pixels; i += 8 ) {
+		pixel = _mm_loadu_si128( (const __m128i *) (image_data + i) );
+
+		sum = _mm_loadu_si128( (const __m128i *) (sum_array + i) );
+		sum = _mm_add_epi32( sum, _mm_unpacklo_epi16( pixel, zero ) );
+		_mm_storeu_si128( (__m128i *) (sum_array + i), sum );
+
+		sum = _mm_loadu_si128( (const __m128i *) (sum_array + i + 4) );
+		sum = _mm_add_epi32( sum, _mm_unpackhi_epi16( pixel, zero ) );
+		_mm_storeu_si128( (__m128i *) (sum_array + i + 4), sum );
+
+		if ( sum_of_squares_array != NULL ) {
+			square_lo = _mm_mullo_epi16( pixel, pixel );
+			square_hi = _mm_mulhi_epu16( pixel, pixel );
+
+			mxp_sse2_add_u32_to_u64( sum_of_squares_array + i,
+				_mm_unpacklo_epi16( square_lo, square_hi ) );
+
+			mxp_sse2_add_u32_to_u64( sum_of_squares_array + i + 4,
+				_mm_unpackhi_epi16( square_lo, square_hi ) );
+		}
+
+		for ( j = 0; j < num_top_values; j++ ) {
+			top_ptr = top_value_array + j * num_pixels + i;
+
+			top = _mm_loadu_si128( (const __m128i *) top_ptr );
+
+			excess = _mm_subs_epu16( top, pixel );
+
+			_mm_storeu_si128( (__m128i *) top_ptr,
+					_mm_add_epi16( pixel, excess ) );
+
+			pixel = _mm_sub_epi16( top, excess );
+		}
+	}
+
+	mxp_scalar_u16_dezinger( image_data, sum_array, sum_of_squares_array,
+				top_value_array, num_top_values, num_pixels,
+				i, num_pixels );
+}
+
+/*-----------------------------------------------------------------------*/
+
+/* The AVX2 kernels process 8 pixels per pass as two groups of 4 doubles. */
+
+MXP_AVX2_INLINE void
+mxp_avx2_u16_to_pd( __m128i v16, __m256d *lo, __m256d *hi )
+{
+	__m256i v;
+
+	v = _mm256_cvtepu16_epi32( v16 );
+
+	*lo = _mm256_cvtepi32_pd( _mm256_castsi256_si128( v ) );
+	*hi = _mm256_cvtepi32_pd( _mm256_extracti128_si256( v, 1 ) );
+}
+
+MXP_AVX2_INLINE void
+mxp_avx2_load_u16( const uint16_t *src, __m256d *lo, __m256d *hi )
+{
+	mxp_avx2_u16_to_pd( _mm_loadu_si128( (const __m128i *) src ),
+				lo, hi );
+}
+
+MXP_AVX2_INLINE void
+mxp_avx2_load_flt( const float *src, __m256d *lo, __m256d *hi )
+{
+	__m256 f;
+
+	f = _mm256_loadu_ps( src );
+
+	*lo = _mm256_cvtps_pd( _mm256_castps256_ps128( f ) );
+	*hi = _mm256_cvtps_pd( _mm256_extractf128_ps( f, 1 ) );
+}
+
+MXP_AVX2_INLINE __m128i
+mxp_avx2_round_u16( __m256d lo, __m256d hi )
+{
+	const __m256d zero = _mm256_setzero_pd();
+	const __m256d half = _mm256_set1_pd( 0.5 );
+	__m128i ilo, ihi;
+
+	lo = _mm256_and_pd( lo, _mm256_cmp_pd( lo, zero, _CMP_GE_OQ ) );
+	hi = _mm256_and_pd( hi, _mm256_cmp_pd( hi, zero, _CMP_GE_OQ ) );
+
+	ilo = _mm256_cvttpd_epi32( _mm256_add_pd( lo, half ) );
+	ihi = _mm256_cvttpd_epi32( _mm256_add_pd( hi, half ) );
+
+	ilo = _mm_srai_epi32( _mm_slli_epi32( ilo, 16 ), 16 );
+	ihi = _mm_srai_epi32( _mm_slli_epi32( ihi, 16 ), 16 );
+
+	return _mm_packs_epi32( ilo, ihi );
+}
+
+MXP_AVX2_INLINE __m128i
+mxp_avx2_masked_off( const uint16_t *mask_data )
+{
+	return _mm_cmpeq_epi16(
+		_mm_loadu_si128( (const __m128i *) mask_data ),
+		_mm_setzero_si128() );
+}
+
+static MXP_AVX2 void
+mxp_avx2_u16_precomp_dark( uint16_t *image_data,
+				const uint16_t *mask_data,
+				const float *dark_current_offset,
+				unsigned long num_pixels )
+{
+	unsigned long i, num_vector_pixels;
+	__m256d img_lo, img_hi, off_lo, off_hi;
+	__m128i result;
+
+	num_vector_pixels = num_pixels & ~7UL;
+
+	if ( dark_current_offset == NULL ) {
+		mxp_scalar_u16_precomp_dark( image_data, mask_data,
+						NULL, num_pixels );
+		return;
+	}
+
+	for ( i = 0; i < num_vector_pixels; i += 8 ) {
+		mxp_avx2_load_u16( image_data + i, &img_lo, &img_hi );
+		mxp_avx2_load_flt( dark_current_offset + i, &off_lo, &off_hi );
+
+		result = mxp_avx2_round_u16( _mm256_add_pd( img_lo, off_lo ),
+					_mm256_add_pd( img_hi, off_hi ) );
+
+		if ( mask_data != NULL ) {
+			result = _mm_andnot_si128(
+				mxp_avx2_masked_off( mask_data + i ), result );
+		}
+
+		_mm_storeu_si128( (__m128i *) (image_data + i), result );
+	}
+
+	mxp_scalar_u16_precomp_dark( image_data + i,
+			( mask_data == NULL ) ? NULL : mask_data + i,
+			dark_current_offset + i, num_pixels - i );
+}
+
+static MXP_AVX2 void
+mxp_avx2_u16_plain_dark( uint16_t *image_data,
+				const uint16_t *mask_data,
+				const uint16_t *bias_data,
+				const uint16_t *dark_current_data,
+				double exposure_time_ratio,
+				unsigned long num_pixels )
+{
+	unsigned long i, num_vector_pixels;
+	const __m256d ratio = _mm256_set1_pd( exposure_time_ratio );
+	__m256d img_lo, img_hi, bias_lo, bias_hi, dark_lo, dark_hi;
+	__m128i result;
+
+	num_vector_pixels = num_pixels & ~7UL;
+
+	bias_lo = bias_hi = _mm256_setzero_pd();
+
+	for ( i = 0; i < num_vector_pixels; i += 8 ) {
+		mxp_avx2_load_u16( image_data + i, &img_lo, &img_hi );
+
+		if ( dark_current_data != NULL ) {
+			if ( bias_data != NULL ) {
+				mxp_avx2_load_u16( bias_data + i,
+						&bias_lo, &bias_hi );
+			}
+
+			mxp_avx2_load_u16( dark_current_data + i,
+						&dark_lo, &dark_hi );
+
+			dark_lo = _mm256_add_pd( _mm256_mul_pd( ratio,
+					_mm256_sub_pd( dark_lo, bias_lo ) ),
+					bias_lo );
+			dark_hi = _mm256_add_pd( _mm256_mul_pd( ratio,
+					_mm256_sub_pd( dark_hi, bias_hi ) ),
+					bias_hi );
+
+			img_lo = _mm256_sub_pd(
+				_mm256_add_pd( img_lo, bias_lo ), dark_lo );
+			img_hi = _mm256_sub_pd(
+				_mm256_add_pd( img_hi, bias_hi ), dark_hi );
+		}
+
+		result = mxp_avx2_round_u16( img_lo, img_hi );
+
+		if ( mask_data != NULL ) {
+			result = _mm_andnot_si128(
+				mxp_avx2_masked_off( mask_data + i ), result );
+		}
+
+		_mm_storeu_si128( (__m128i *) (image_data + i), result );
+	}
+
+	mxp_scalar_u16_plain_dark( image_data + i,
+			( mask_data == NULL ) ? NULL : mask_data + i,
+			( bias_data == NULL ) ? NULL : bias_data + i,
+			( dark_current_data == NULL ) ?
+				NULL : dark_current_data + i,
+			exposure_time_ratio, num_pixels - i );
+}
+
+static MXP_AVX2 void
+mxp_avx2_u16_precomp_flat( uint16_t *image_data,
+				const uint16_t *mask_data,
+				const uint16_t *bias_data,
+				const float *flat_field_scale,
+				unsigned long num_pixels )
+{
+	unsigned long i, num_vector_pixels;
+	__m256d img_lo, img_hi, bias_lo, bias_hi, scale_lo, scale_hi;
+	__m128i original, result, masked_off;
+
+	num_vector_pixels = num_pixels & ~7UL;
+
+	bias_lo = bias_hi = _mm256_setzero_pd();
+
+	for ( i = 0; i < num_vector_pixels; i += 8 ) {
+		original = _mm_loadu_si128( (const __m128i *) (image_data + i) );
+
+		mxp_avx2_load_u16( image_data + i, &img_lo, &img_hi );
+		mxp_avx2_load_flt( flat_field_scale + i, &scale_lo, &scale_hi );
+
+		if ( bias_data != NULL ) {
+			mxp_avx2_load_u16( bias_data + i, &bias_lo, &bias_hi );
+		}
+
+		img_lo = _mm256_add_pd( _mm256_mul_pd(
+			_mm256_sub_pd( img_lo, bias_lo ), scale_lo ), bias_lo );
+		img_hi = _mm256_add_pd( _mm256_mul_pd(
+			_mm256_sub_pd( img_hi, bias_hi ), scale_hi ), bias_hi );
+
+		result = mxp_avx2_round_u16( img_lo, img_hi );
+
+		if ( mask_data != NULL ) {
+			masked_off = mxp_avx2_masked_off( mask_data + i );
+
+			result = _mm_blendv_epi8( result, original, masked_off );
+		}
+
+		_mm_storeu_si128( (__m128i *) (image_data + i), result );
+	}
+
+	mxp_scalar_u16_precomp_flat( image_data + i,
+			( mask_data == NULL ) ? NULL : mask_data + i,
+			( bias_data == NULL ) ? NULL : bias_data + i,
+			flat_field_scale + i, num_pixels - i );
+}
+
+static MXP_AVX2 mx_bool_type
+mxp_avx2_u16_plain_flat( uint16_t *image_data,
+				const uint16_t *mask_data,
+				const uint16_t *bias_data,
+				const uint16_t *flat_field_data,
+				double ffs_numerator,
+				double flat_field_scale_min,
+				double flat_field_scale_max,
+				unsigned long num_pixels )
+{
+	unsigned long i, num_vector_pixels;
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256d numerator = _mm256_set1_pd( ffs_numerator );
+	const __m256d scale_min = _mm256_set1_pd( flat_field_scale_min );
+	const __m256d scale_max = _mm256_set1_pd( flat_field_scale_max );
+	__m256i img32, flat32, bias32, valid32, valid_any;
+	__m256d img_lo, img_hi, bias_lo, bias_hi, scale_lo, scale_hi;
+	__m256d keep_lo, keep_hi;
+	mx_bool_type some_pixels_valid;
+
+	num_vector_pixels = num_pixels & ~7UL;
+
+	bias32 = zero;
+	valid_any = zero;
+
+	for ( i = 0; i < num_vector_pixels; i += 8 ) {
+		img32 = _mm256_cvtepu16_epi32(
+			_mm_loadu_si128( (const __m128i *) (image_data + i) ) );
+		flat32 = _mm256_cvtepu16_epi32(
+		    _mm_loadu_si128( (const __m128i *) (flat_field_data + i) ));
+
+		if ( bias_data != NULL ) {
+			bias32 = _mm256_cvtepu16_epi32(
+			    _mm_loadu_si128( (const __m128i *) (bias_data + i) ));
+		}
+
+		valid32 = _mm256_cmpgt_epi32( flat32, bias32 );
+
+		if ( mask_data != NULL ) {
+			valid32 = _mm256_andnot_si256( _mm256_cmpeq_epi32(
+			    _mm256_cvtepu16_epi32( _mm_loadu_si128(
+				(const __m128i *) (mask_data + i) ) ),
+			    zero ), valid32 );
+		}
+
+		valid_any = _mm256_or_si256( valid_any, valid32 );
+
+		flat32 = _mm256_sub_epi32( flat32, bias32 );
+
+		scale_lo = _mm256_div_pd( numerator, _mm256_cvtepi32_pd(
+				_mm256_castsi256_si128( flat32 ) ) );
+		scale_hi = _mm256_div_pd( numerator, _mm256_cvtepi32_pd(
+				_mm256_extracti128_si256( flat32, 1 ) ) );
+
+		keep_lo = _mm256_and_pd( _mm256_castsi256_pd(
+			_mm256_cvtepi32_epi64( _mm256_castsi256_si128(valid32) )),
+			_mm256_and_pd(
+			    _mm256_cmp_pd( scale_lo, scale_max, _CMP_LE_OQ ),
+			    _mm256_cmp_pd( scale_lo, scale_min, _CMP_GE_OQ ) ) );
+		keep_hi = _mm256_and_pd( _mm256_castsi256_pd(
+			_mm256_cvtepi32_epi64(
+				_mm256_extracti128_si256( valid32, 1 ) ) ),
+			_mm256_and_pd(
+			    _mm256_cmp_pd( scale_hi, scale_max, _CMP_LE_OQ ),
+			    _mm256_cmp_pd( scale_hi, scale_min, _CMP_GE_OQ ) ) );
+
+		img_lo = _mm256_cvtepi32_pd( _mm256_castsi256_si128( img32 ) );
+		img_hi = _mm256_cvtepi32_pd(
+				_mm256_extracti128_si256( img32, 1 ) );
+
+		bias_lo = _mm256_cvtepi32_pd( _mm256_castsi256_si128( bias32 ) );
+		bias_hi = _mm256_cvtepi32_pd(
+				_mm256_extracti128_si256( bias32, 1 ) );
+
+		img_lo = _mm256_add_pd( _mm256_mul_pd(
+			_mm256_sub_pd( img_lo, bias_lo ), scale_lo ), bias_lo );
+		img_hi = _mm256_add_pd( _mm256_mul_pd(
+			_mm256_sub_pd( img_hi, bias_hi ), scale_hi ), bias_hi );
+
+		img_lo = _mm256_and_pd( img_lo, keep_lo );
+		img_hi = _mm256_and_pd( img_hi, keep_hi );
+
+		_mm_storeu_si128( (__m128i *) (image_data + i),
+				mxp_avx2_round_u16( img_lo, img_hi ) );
+	}
+
+	some_pixels_valid = ( _mm256_movemask_epi8( valid_any ) != 0 );
+
+	if ( mxp_scalar_u16_plain_flat( image_data + i,
+			( mask_data == NULL ) ? NULL : mask_data + i,
+			( bias_data == NULL ) ? NULL : bias_data + i,
+			flat_field_data + i, ffs_numerator,
+			flat_field_scale_min, flat_field_scale_max,
+			num_pixels - i ) )
+	{
+		some_pixels_valid = TRUE;
+	}
+
+	return some_pixels_valid;
+}
+
+static MXP_AVX2 void
+mxp_avx2_u16_fused( uint16_t *image_data,
+		const MX_AREA_DETECTOR_CORRECTION_PLAN_BLOCK *block_array,
+		unsigned long first_pixel,
+		unsigned long num_pixels )
+{
+	const MX_AREA_DETECTOR_CORRECTION_PLAN_BLOCK *block;
+	unsigned long i, end;
+	__m256d img_lo, img_hi, off_lo, off_hi;
+	__m256d bias_lo, bias_hi, scale_lo, scale_hi;
+	__m128i dark_corrected;
+
+	end = first_pixel + num_pixels;
+
+	i = first_pixel + mxp_fused_head_length( first_pixel, num_pixels );
+
+	mxp_scalar_u16_fused( image_data, block_array,
+				first_pixel, i - first_pixel );
+
+	for ( ; ( i + MXU_AD_CORRECTION_PLAN_BLOCK_SIZE ) <= end;
+			i += MXU_AD_CORRECTION_PLAN_BLOCK_SIZE )
+	{
+		block = &block_array[ i / MXU_AD_CORRECTION_PLAN_BLOCK_SIZE ];
+
+		mxp_avx2_load_u16( image_data + i, &img_lo, &img_hi );
+		mxp_avx2_load_flt( block->offset, &off_lo, &off_hi );
+
+		dark_corrected = mxp_avx2_round_u16(
+					_mm256_add_pd( img_lo, off_lo ),
+					_mm256_add_pd( img_hi, off_hi ) );
+
+		mxp_avx2_u16_to_pd( dark_corrected, &img_lo, &img_hi );
+
+		mxp_avx2_load_u16( block->bias, &bias_lo, &bias_hi );
+		mxp_avx2_load_flt( block->scale, &scale_lo, &scale_hi );
+
+		img_lo = _mm256_add_pd( _mm256_mul_pd(
+			_mm256_sub_pd( img_lo, bias_lo ), scale_lo ), bias_lo );
+		img_hi = _mm256_add_pd( _mm256_mul_pd(
+			_mm256_sub_pd( img_hi, bias_hi ), scale_hi ), bias_hi );
+
+		_mm_storeu_si128( (__m128i *) (image_data + i),
+				mxp_avx2_round_u16( img_lo, img_hi ) );
+	}
+
+	mxp_scalar_u16_fused( image_data, block_array, i, end - i );
+}
+
+/* Adds eight 32-bit values to eight 64-bit sums. */
+
+MXP_AVX2_INLINE void
+mxp_avx2_add_u32_to_u64( uint64_t *dest, __m256i v )
+{
+	__m256i sum;
+
+	sum = _mm256_loadu_si256( (const __m256i *) dest );
+	sum = _mm256_add_epi64( sum,
+		_mm256_cvtepu32_epi64( _mm256_castsi256_si128( v ) ) );
+	_mm256_storeu_si256( (__m256i *) dest, sum );
+
+	sum = _mm256_loadu_si256( (const __m256i *) (dest + 4) );
+	sum = _mm256_add_epi64( sum,
+		_mm256_cvtepu32_epi64( _mm256_extracti128_si256( v, 1 ) ) );
+	_mm256_storeu_si256( (__m256i *) (dest + 4), sum );
+}
+
+/* Adds eight 16-bit pixels to the sums for those pixels. */
+
+MXP_AVX2_INLINE void
+mxp_avx2_dezinger_sums( const uint16_t *image_data,
+			uint32_t *sum_array,
+			uint64_t *sum_of_squares_array )
+{
+	__m256i pixel, sum;
+
+	pixel = _mm256_cvtepu16_epi32(
+			_mm_loadu_si128( (const __m128i *) image_data ) );
+
+	sum = _mm256_loadu_si256( (const __m256i *) sum_array );
+	_mm256_storeu_si256( (__m256i *) sum_array,
+				_mm256_add_epi32( sum, pixel ) );
+
+	if ( sum_of_squares_array != NULL ) {
+		mxp_avx2_add_u32_to_u64( sum_of_squares_array,
+					_mm256_mullo_epi32( pixel, pixel ) );
+	}
+}
+
+/* The AVX2 dezinger kernel does 16 pixels per pass. */
+
+static MXP_AVX2 void
+mxp_avx2_u16_dezinger( const uint16_t *image_data,
+				uint32_t *sum_array,
+				uint64_t *sum_of_squares_array,
+				uint16_t *top_value_array,
+				unsigned long num_top_values,
+				unsigned long num_pixels )
+{
+	unsigned long i, j;
+	uint16_t *top_ptr;
+	__m256i pixel, top;
+
+	for ( i = 0; ( i + 16 ) <= num_pixels; i += 16 ) {
+		mxp_avx2_dezinger_sums( image_data + i, sum_array + i,
+			sum_of_squares_array == NULL ?
+				NULL : sum_of_squares_array + i );
+
+		mxp_avx2_dezinger_sums( image_data + i + 8, sum_array + i + 8,
+			sum_of_squares_array == NULL ?
+				NULL : sum_of_squares_array + i + 8 );
+
+		pixel = _mm256_loadu_si256( (const __m256i *) (image_data + i) );
+
+		for ( j = 0; j < num_top_values; j++ ) {
+			top_ptr = top_value_array + j * num_pixels + i;
+
+			top = _mm256_loadu_si256( (const __m256i *) top_ptr );
+
+			_mm256_storeu_si256( (__m256i *) top_ptr,
+					_mm256_max_epu16( top, pixel ) );
+
+			pixel = _mm256_min_epu16( top, pixel );
+		}
+	}
+
+	mxp_scalar_u16_dezinger( image_data, sum_array, sum_of_squares_array,
+				top_value_array, num_top_values, num_pixels,
+				i, num_pixels );
+}
+
+#endif /* MXP_HAVE_X86_SIMD */
+
+/*=======================================================================*/
+
+static long
+mxp_best_correction_kernel( void )
+{
+#if MXP_HAVE_X86_SIMD
+	__builtin_cpu_init();
+
+	if ( __builtin_cpu_supports( "avx2" ) ) {
+		return MXT_AD_CORRECTION_KERNEL_AVX2;
+	}
+	if ( __builtin_cpu_supports( "sse2" ) ) {
+		return MXT_AD_CORRECTION_KERNEL_SSE2;
+	}
+#endif
+	return MXT_AD_CORRECTION_KERNEL_SCALAR;
+}
+
+/* The kernel type is chosen the first time any kernel is called.  If two
+ * threads race to do this, they both store the same value, so no locking
+ * is needed.
+ */
+
+static inline long
+mxp_get_correction_kernel( void )
+{
+	if ( mxp_correction_kernel < 0 ) {
+		mxp_correction_kernel = mxp_best_correction_kernel();
+
+#if MX_AREA_DETECTOR_SIMD_DEBUG
+		MX_DEBUG(-2,("mxp_get_correction_kernel(): kernel type = %ld",
+			mxp_correction_kernel));
+#endif
+	}
+
+	return mxp_correction_kernel;
+}
+
+MX_EXPORT long
+mx_area_detector_get_correction_kernel( void )
+{
+	return mxp_get_correction_kernel();
+}
+
+MX_EXPORT mx_status_type
+mx_area_detector_set_correction_kernel( long kernel_type )
+{
+	static const char fname[] = "mx_area_detector_set_correction_kernel()";
+
+	long best_kernel;
+
+	best_kernel = mxp_best_correction_kernel();
+
+	switch( kernel_type ) {
+	case MXT_AD_CORRECTION_KERNEL_AUTO:
+		mxp_correction_kernel = best_kernel;
+		break;
+	case MXT_AD_CORRECTION_KERNEL_SCALAR:
+	case MXT_AD_CORRECTION_KERNEL_SSE2:
+	case MXT_AD_CORRECTION_KERNEL_AVX2:
+		if ( kernel_type > best_kernel ) {
+			return mx_error( MXE_UNSUPPORTED, fname,
+			"Correction kernel type %ld is not supported "
+			"on this computer.  The best available type is %ld.",
+				kernel_type, best_kernel );
+		}
+
+		mxp_correction_kernel = kernel_type;
+		break;
+	default:
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"Unrecognized correction kernel type %ld.", kernel_type );
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-----------------------------------------------------------------------*/
+
+MX_EXPORT void
+mx_area_detector_u16_precomp_dark_kernel( uint16_t *image_data,
+				const uint16_t *mask_data,
+				const float *dark_current_offset,
+				unsigned long num_pixels )
+{
+	switch( mxp_get_correction_kernel() ) {
+#if MXP_HAVE_X86_SIMD
+	case MXT_AD_CORRECTION_KERNEL_AVX2:
+		mxp_avx2_u16_precomp_dark( image_data, mask_data,
+					dark_current_offset, num_pixels );
+		break;
+	case MXT_AD_CORRECTION_KERNEL_SSE2:
+		mxp_sse2_u16_precomp_dark( image_data, mask_data,
+					dark_current_offset, num_pixels );
+		break;
+#endif
+	default:
+		mxp_scalar_u16_precomp_dark( image_data, mask_data,
+					dark_current_offset, num_pixels );
+		break;
+	}
+}
+
+MX_EXPORT void
+mx_area_detector_u16_plain_dark_kernel( uint16_t *image_data,
+				const uint16_t *mask_data,
+				const uint16_t *bias_data,
+				const uint16_t *dark_current_data,
+				double exposure_time_ratio,
+				unsigned long num_pixels )
+{
+	switch( mxp_get_correction_kernel() ) {
+#if MXP_HAVE_X86_SIMD
+	case MXT_AD_CORRECTION_KERNEL_AVX2:
+		mxp_avx2_u16_plain_dark( image_data, mask_data, bias_data,
+			dark_current_data, exposure_time_ratio, num_pixels );
+		break;
+	case MXT_AD_CORRECTION_KERNEL_SSE2:
+		mxp_sse2_u16_plain_dark( image_data, mask_data, bias_data,
+			dark_current_data, exposure_time_ratio, num_pixels );
+		break;
+#endif
+	default:
+		mxp_scalar_u16_plain_dark( image_data, mask_data, bias_data,
+			dark_current_data, exposure_time_ratio, num_pixels );
+		break;
+	}
+}
+
+MX_EXPORT void
+mx_area_detector_u16_precomp_flat_kernel( uint16_t *image_data,
+				const uint16_t *mask_data,
+				const uint16_t *bias_data,
+				const float *flat_field_scale,
+				unsigned long num_pixels )
+{
+	switch( mxp_get_correction_kernel() ) {
+#if MXP_HAVE_X86_SIMD
+	case MXT_AD_CORRECTION_KERNEL_AVX2:
+		mxp_avx2_u16_precomp_flat( image_data, mask_data, bias_data,
+					flat_field_scale, num_pixels );
+		break;
+	case MXT_AD_CORRECTION_KERNEL_SSE2:
+		mxp_sse2_u16_precomp_flat( image_data, mask_data, bias_data,
+					flat_field_scale, num_pixels );
+		break;
+#endif
+	default:
+		mxp_scalar_u16_precomp_flat( image_data, mask_data, bias_data,
+					flat_field_scale, num_pixels );
+		break;
+	}
+}
+
+MX_EXPORT mx_bool_type
+mx_area_detector_u16_plain_flat_kernel( uint16_t *image_data,
+				const uint16_t *mask_data,
+				const uint16_t *bias_data,
+				const uint16_t *flat_field_data,
+				double ffs_numerator,
+				double flat_field_scale_min,
+				double flat_field_scale_max,
+				unsigned long num_pixels )
+{
+	switch( mxp_get_correction_kernel() ) {
+#if MXP_HAVE_X86_SIMD
+	case MXT_AD_CORRECTION_KERNEL_AVX2:
+		return mxp_avx2_u16_plain_flat( image_data, mask_data,
+			bias_data, flat_field_data, ffs_numerator,
+			flat_field_scale_min, flat_field_scale_max,
+			num_pixels );
+	case MXT_AD_CORRECTION_KERNEL_SSE2:
+		return mxp_sse2_u16_plain_flat( image_data, mask_data,
+			bias_data, flat_field_data, ffs_numerator,
+			flat_field_scale_min, flat_field_scale_max,
+			num_pixels );
+#endif
+	default:
+		return mxp_scalar_u16_plain_flat( image_data, mask_data,
+			bias_data, flat_field_data, ffs_numerator,
+			flat_field_scale_min, flat_field_scale_max,
+			num_pixels );
+	}
+}
+
+MX_EXPORT void
+mx_area_detector_u16_fused_kernel( uint16_t *image_data,
+		const MX_AREA_DETECTOR_CORRECTION_PLAN_BLOCK *block_array,
+		unsigned long first_pixel,
+		unsigned long num_pixels )
+{
+	switch( mxp_get_correction_kernel() ) {
+#if MXP_HAVE_X86_SIMD
+	case MXT_AD_CORRECTION_KERNEL_AVX2:
+		mxp_avx2_u16_fused( image_data, block_array,
+					first_pixel, num_pixels );
+		break;
+	case MXT_AD_CORRECTION_KERNEL_SSE2:
+		mxp_sse2_u16_fused( image_data, block_array,
+					first_pixel, num_pixels );
+		break;
+#endif
+	default:
+		mxp_scalar_u16_fused( image_data, block_array,
+					first_pixel, num_pixels );
+		break;
+	}
+}
+
+MX_EXPORT void
+mx_area_detector_u16_dezinger_kernel( const uint16_t *image_data,
+					uint32_t *sum_array,
+					uint64_t *sum_of_squares_array,
+					uint16_t *top_value_array,
+					unsigned long num_top_values,
+					unsigned long num_pixels )
+{
+	switch( mxp_get_correction_kernel() ) {
+#if MXP_HAVE_X86_SIMD
+	case MXT_AD_CORRECTION_KERNEL_AVX2:
+		mxp_avx2_u16_dezinger( image_data, sum_array,
+				sum_of_squares_array, top_value_array,
+				num_top_values, num_pixels );
+		break;
+	case MXT_AD_CORRECTION_KERNEL_SSE2:
+		mxp_sse2_u16_dezinger( image_data, sum_array,
+				sum_of_squares_array, top_value_array,
+				num_top_values, num_pixels );
+		break;
+#endif
+	default:
+		mxp_scalar_u16_dezinger( image_data, sum_array,
+				sum_of_squares_array, top_value_array,
+				num_top_values, num_pixels, 0, num_pixels );
+		break;
+	}
+}
+
@@ -68,10 +68,12 @@
 #include "mx_socket.h"
 #include "mx_net.h"
 #include "mx_pipe.h"
+#include "mx_mutex.h"
 #include "mx_unistd.h"
 #include "mx_vm_alloc.h"
 #include "mx_process.h"
 #include "mx_callback.h"
+#include "mx_metrics.h"
 
 #if MX_CALLBACK_DEBUG_PROCESS_CALLBACKS_TIMING
 #include "mx_hrt_debug.h"
@@ -1407,6 +1409,295 @@ mx_local_field_add_socket_handler_to_callback(
 
 /*--------------------------------------------------------------------------*/
 
+/* The poll schedule holds the record fields that mx_poll_callback_handler()
+ * must look at, so that it does not have to visit every callback in the
+ * callback handle table on each poll.
+ *
+ * Fields on the polled list have their value read from the hardware once
+ * every 'timer_interval' polls.  A field stays on the polled list only
+ * while it has the MXFF_POLL flag set or has not yet had its first poll.
+ *
+ * Fields on the dirty list have been marked as changed by a call to
+ * mx_local_field_mark_dirty().  mx_local_field_mark_dirty() may be called
+ * from any thread, so the lists and the 'poll_state' flags of the fields
+ * are protected by the schedule's mutex.  The poller copies the fields
+ * that it must visit to the work array and releases the mutex before
+ * it invokes any callbacks.
+ */
+
+typedef struct {
+	MX_RECORD_FIELD *record_field;
+	mx_bool_type get_new_value;
+} MXP_POLL_WORK_ITEM;
+
+typedef struct {
+	MX_MUTEX *mutex;
+
+	unsigned long num_dirty_fields;
+	unsigned long dirty_array_size;
+	MX_RECORD_FIELD **dirty_field_array;
+
+	unsigned long num_polled_fields;
+	unsigned long polled_array_size;
+	MX_RECORD_FIELD **polled_field_array;
+
+	unsigned long num_work_items;
+	unsigned long work_array_size;
+	MXP_POLL_WORK_ITEM *work_array;
+} MXP_POLL_SCHEDULE;
+
+#define MXP_POLL_SCHEDULE_BLOCK_SIZE	100
+
+static mx_status_type
+mxp_poll_schedule_grow( void **array_ptr,
+			unsigned long *array_size,
+			size_t element_size,
+			unsigned long minimum_size )
+{
+	static const char fname[] = "mxp_poll_schedule_grow()";
+
+	void *new_array;
+	unsigned long new_size;
+
+	new_size = MXP_POLL_SCHEDULE_BLOCK_SIZE
+		* ( 1 + minimum_size / MXP_POLL_SCHEDULE_BLOCK_SIZE );
+
+	new_array = realloc( *array_ptr, new_size * element_size );
+
+	if ( new_array == NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to increase the size of a "
+		"poll schedule array to %lu elements.", new_size );
+	}
+
+	*array_ptr = new_array;
+	*array_size = new_size;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+static mx_status_type
+mxp_poll_schedule_add_field( MX_RECORD_FIELD ***field_array,
+				unsigned long *num_fields,
+				unsigned long *array_size,
+				MX_RECORD_FIELD *record_field )
+{
+	mx_status_type mx_status;
+
+	if ( *num_fields >= *array_size ) {
+		mx_status = mxp_poll_schedule_grow( (void **) field_array,
+					array_size, sizeof(MX_RECORD_FIELD *),
+					*num_fields + 1 );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
+	(*field_array)[ *num_fields ] = record_field;
+
+	(*num_fields)++;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+static mx_status_type
+mxp_get_poll_schedule( MX_LIST_HEAD *list_head,
+			MXP_POLL_SCHEDULE **schedule )
+{
+	static const char fname[] = "mxp_get_poll_schedule()";
+
+	MXP_POLL_SCHEDULE *new_schedule;
+	mx_status_type mx_status;
+
+	if ( list_head->poll_schedule != NULL ) {
+		*schedule = list_head->poll_schedule;
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	new_schedule = (MXP_POLL_SCHEDULE *)
+				calloc( 1, sizeof(MXP_POLL_SCHEDULE) );
+
+	if ( new_schedule == (MXP_POLL_SCHEDULE *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a value changed "
+		"poll schedule." );
+	}
+
+	mx_status = mx_mutex_create( &(new_schedule->mutex) );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mx_free( new_schedule );
+		return mx_status;
+	}
+
+	list_head->poll_schedule = new_schedule;
+
+	*schedule = new_schedule;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* Add a field to the polled list if it is not already there.
+ * The schedule mutex must be locked by the caller.
+ */
+
+static mx_status_type
+mxp_poll_schedule_add_polled_field( MXP_POLL_SCHEDULE *schedule,
+					MX_RECORD_FIELD *record_field )
+{
+	mx_status_type mx_status;
+
+	if ( record_field->poll_state & MXFPS_POLL_QUEUED ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	mx_status = mxp_poll_schedule_add_field(
+					&(schedule->polled_field_array),
+					&(schedule->num_polled_fields),
+					&(schedule->polled_array_size),
+					record_field );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	record_field->poll_state |= MXFPS_POLL_QUEUED;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* Drivers that change the value of a record field outside of
+ * mx_process_record_field() should call mx_local_field_mark_dirty(),
+ * so that the next value changed poll tests the field for a change
+ * and sends out any callbacks that are needed.
+ */
+
+MX_EXPORT mx_status_type
+mx_local_field_mark_dirty( MX_RECORD_FIELD *record_field )
+{
+	static const char fname[] = "mx_local_field_mark_dirty()";
+
+	MX_LIST_HEAD *list_head;
+	MXP_POLL_SCHEDULE *schedule;
+	mx_status_type mx_status;
+
+	if ( record_field == (MX_RECORD_FIELD *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_RECORD_FIELD pointer passed was NULL." );
+	}
+
+	record_field->generation++;
+
+	/* Fields that nobody has asked for callbacks from do not
+	 * need to be queued.
+	 */
+
+	if ( ( record_field->record == (MX_RECORD *) NULL )
+	  || ( record_field->callback_list == NULL ) )
+	{
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	list_head = mx_get_record_list_head_struct( record_field->record );
+
+	if ( list_head == (MX_LIST_HEAD *) NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"The MX_LIST_HEAD pointer for record '%s' is NULL.",
+			record_field->record->name );
+	}
+
+	schedule = list_head->poll_schedule;
+
+	if ( schedule == (MXP_POLL_SCHEDULE *) NULL ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	/* If every poll sweeps all of the fields with callbacks, then
+	 * the sweep will find this field anyway.
+	 */
+
+	if ( list_head->poll_sweep_interval == 1 ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	mx_status = MX_SUCCESSFUL_RESULT;
+
+	mx_mutex_lock( schedule->mutex );
+
+	if ( ( record_field->poll_state & MXFPS_DIRTY_QUEUED ) == 0 ) {
+		mx_status = mxp_poll_schedule_add_field(
+					&(schedule->dirty_field_array),
+					&(schedule->num_dirty_fields),
+					&(schedule->dirty_array_size),
+					record_field );
+
+		if ( mx_status.code == MXE_SUCCESS ) {
+			record_field->poll_state |= MXFPS_DIRTY_QUEUED;
+		}
+	}
+
+	mx_mutex_unlock( schedule->mutex );
+
+	return mx_status;
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* mx_local_field_update_poll_schedule() must be called after the MXFF_POLL
+ * flag of a record field that may have callbacks has been turned on.
+ * Fields whose MXFF_POLL flag has been turned off are dropped from the
+ * polled list by the poller itself.
+ */
+
+MX_EXPORT mx_status_type
+mx_local_field_update_poll_schedule( MX_RECORD_FIELD *record_field )
+{
+	static const char fname[] = "mx_local_field_update_poll_schedule()";
+
+	MX_LIST_HEAD *list_head;
+	MXP_POLL_SCHEDULE *schedule;
+	mx_status_type mx_status;
+
+	if ( record_field == (MX_RECORD_FIELD *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_RECORD_FIELD pointer passed was NULL." );
+	}
+
+	if ( ( record_field->record == (MX_RECORD *) NULL )
+	  || ( record_field->callback_list == NULL )
+	  || ( ( record_field->flags & MXFF_POLL ) == 0 ) )
+	{
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	list_head = mx_get_record_list_head_struct( record_field->record );
+
+	if ( list_head == (MX_LIST_HEAD *) NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"The MX_LIST_HEAD pointer for record '%s' is NULL.",
+			record_field->record->name );
+	}
+
+	schedule = list_head->poll_schedule;
+
+	if ( schedule == (MXP_POLL_SCHEDULE *) NULL ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	mx_mutex_lock( schedule->mutex );
+
+	mx_status = mxp_poll_schedule_add_polled_field( schedule,
+							record_field );
+
+	mx_mutex_unlock( schedule->mutex );
+
+	return mx_status;
+}
+
+/*--------------------------------------------------------------------------*/
+
 MX_EXPORT mx_status_type
 mx_local_field_add_new_callback( MX_RECORD_FIELD *record_field,
 			unsigned long supported_callback_types,
@@ -1424,6 +1715,7 @@ mx_local_field_add_new_callback( MX_RECORD_FIELD *record_field,
 	MX_RECORD *record;
 	MX_LIST_HEAD *list_head;
 	MX_HANDLE_TABLE *callback_handle_table;
+	MXP_POLL_SCHEDULE *schedule;
 	signed long callback_handle;
 	mx_status_type mx_status;
 
@@ -1611,6 +1903,29 @@ mx_local_field_add_new_callback( MX_RECORD_FIELD *record_field,
 		record->name, record_field->name, list_entry ));
 #endif
 
+	/* The first poll after a callback is added always reads
+	 * a new value from the hardware.
+	 */
+
+	mx_status = mxp_get_poll_schedule( list_head, &schedule );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_mutex_lock( schedule->mutex );
+
+	mx_status = mxp_poll_schedule_add_polled_field( schedule,
+							record_field );
+
+	if ( mx_status.code == MXE_SUCCESS ) {
+		record_field->poll_state |= MXFPS_FIRST_POLL;
+	}
+
+	mx_mutex_unlock( schedule->mutex );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
 	/* If requested, return the new callback object to the caller. */
 
 	if ( callback_object != (MX_CALLBACK **) NULL ) {
@@ -1758,6 +2073,26 @@ mx_local_field_find_old_callback( MX_RECORD_FIELD *record_field,
 
 /*--------------------------------------------------------------------------*/
 
+/* If a callback deferral function has been installed, it is given the
+ * first look at each invocation of mx_local_field_invoke_callback_list().
+ * If it returns TRUE, the caller has taken responsibility for invoking
+ * the callback list later and nothing more is done here.  This is used
+ * by mxserver worker threads, which must not send callback messages to
+ * other clients while the main thread is using their sockets.
+ */
+
+static mx_bool_type ( *mxp_callback_deferral_function )
+				( MX_RECORD_FIELD *, unsigned long ) = NULL;
+
+MX_EXPORT void
+mx_set_callback_deferral_function( mx_bool_type ( *deferral_function )
+					( MX_RECORD_FIELD *, unsigned long ) )
+{
+	mxp_callback_deferral_function = deferral_function;
+}
+
+/*--------------------------------------------------------------------------*/
+
 MX_EXPORT mx_status_type
 mx_local_field_invoke_callback_list( MX_RECORD_FIELD *record_field,
 				unsigned long callback_type )
@@ -1775,6 +2110,18 @@ mx_local_field_invoke_callback_list( MX_RECORD_FIELD *record_field,
 		"The MX_RECORD_FIELD pointer passed was NULL." );
 	}
 
+	if ( record_field->callback_list == (MX_LIST *) NULL ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	if ( mxp_callback_deferral_function != NULL ) {
+		if ( (*mxp_callback_deferral_function)( record_field,
+							callback_type ) )
+		{
+			return MX_SUCCESSFUL_RESULT;
+		}
+	}
+
 	if ( callback_type == MXCBT_POLL ) {
 		get_new_value = TRUE;
 	} else {
@@ -2076,6 +2423,55 @@ mx_function_delete_callback( MX_CALLBACK_MESSAGE *callback_message )
 
 /*--------------------------------------------------------------------------*/
 
+/* Callback delivery is measured separately for each type of callback. */
+
+static MX_METRIC *
+mxp_callback_metric( unsigned long callback_type )
+{
+	static const char *type_name[] =
+		{ "value_changed", "poll", "motor_backlash", "function", "other" };
+
+	static MX_METRIC *metric_table[] = { NULL, NULL, NULL, NULL, NULL };
+
+	MX_METRIC *metric;
+	char labels[MXU_METRIC_LABELS_LENGTH+1];
+	int i;
+	mx_status_type mx_status;
+
+	switch( callback_type ) {
+	case MXCBT_VALUE_CHANGED:
+		i = 0;
+		break;
+	case MXCBT_POLL:
+		i = 1;
+		break;
+	case MXCBT_MOTOR_BACKLASH:
+		i = 2;
+		break;
+	case MXCBT_FUNCTION:
+		i = 3;
+		break;
+	default:
+		i = 4;
+		break;
+	}
+
+	if ( metric_table[i] != (MX_METRIC *) NULL )
+		return metric_table[i];
+
+	snprintf( labels, sizeof(labels), "type=\"%s\"", type_name[i] );
+
+	mx_status = mx_metrics_find( "mx_callback_seconds", labels,
+					MXT_METRIC_HISTOGRAM, &metric );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return NULL;
+
+	metric_table[i] = metric;
+
+	return metric;
+}
+
 MX_EXPORT mx_status_type
 mx_invoke_callback( MX_CALLBACK *callback,
 		unsigned long callback_type,
@@ -2083,6 +2479,7 @@ mx_invoke_callback( MX_CALLBACK *callback,
 {
 	mx_status_type (*function)( MX_CALLBACK *, void * );
 	void *argument;
+	uint64_t metrics_start;
 	mx_status_type mx_status;
 
 #if MX_CALLBACK_DEBUG
@@ -2124,6 +2521,15 @@ mx_invoke_callback( MX_CALLBACK *callback,
 #endif
 				mx_status = mx_network_copy_message_to_field(
 					nf->server_record, nf->local_field );
+
+				/* Let the poller know that the local field
+				 * has a new value.
+				 */
+
+				if ( mx_status.code == MXE_SUCCESS ) {
+					mx_status = mx_local_field_mark_dirty(
+							nf->local_field );
+				}
 			}
 		}
 	}
@@ -2178,8 +2584,15 @@ mx_invoke_callback( MX_CALLBACK *callback,
 #endif
 	callback->active = TRUE;
 
+	metrics_start = mx_metrics_start();
+
 	mx_status = (*function)( callback, argument );
 
+	if ( metrics_start != 0 ) {
+		mx_metrics_stop( mxp_callback_metric( callback_type ),
+					metrics_start );
+	}
+
 	callback->active = FALSE;
 
 #if MX_CALLBACK_DEBUG
@@ -2404,8 +2817,192 @@ mx_callback_standard_vtimer_handler( MX_VIRTUAL_TIMER *vtimer, void *args )
 
 /*--------------------------------------------------------------------------*/
 
-/* mx_poll_callback_handler() polls all record fields that
- * currently have value changed callback handlers.
+static mx_status_type
+mxp_poll_scheduled_fields( MX_LIST_HEAD *list_head )
+{
+#if MX_CALLBACK_DEBUG
+	static const char fname[] = "mxp_poll_scheduled_fields()";
+#endif
+	MXP_POLL_SCHEDULE *schedule;
+	MXP_POLL_WORK_ITEM *work_item;
+	MX_RECORD_FIELD *record_field;
+	MX_LIST *callback_list;
+	unsigned long i, j, num_polls, num_work_items_needed;
+	long interval;
+	mx_bool_type keep_field, value_changed;
+	mx_status_type mx_status, return_status;
+
+	schedule = list_head->poll_schedule;
+
+	if ( schedule == (MXP_POLL_SCHEDULE *) NULL ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	num_polls = list_head->num_poll_callbacks;
+
+	mx_mutex_lock( schedule->mutex );
+
+	num_work_items_needed = schedule->num_dirty_fields
+				+ schedule->num_polled_fields;
+
+	if ( num_work_items_needed > schedule->work_array_size ) {
+		mx_status = mxp_poll_schedule_grow(
+					(void **) &(schedule->work_array),
+					&(schedule->work_array_size),
+					sizeof(MXP_POLL_WORK_ITEM),
+					num_work_items_needed );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			mx_mutex_unlock( schedule->mutex );
+			return mx_status;
+		}
+	}
+
+	schedule->num_work_items = 0;
+
+	/* Dirty fields only need to have their value changed test rerun. */
+
+	for ( i = 0; i < schedule->num_dirty_fields; i++ ) {
+		record_field = schedule->dirty_field_array[i];
+
+		record_field->poll_state &= (~MXFPS_DIRTY_QUEUED);
+
+		work_item = &(schedule->work_array[schedule->num_work_items]);
+
+		work_item->record_field  = record_field;
+		work_item->get_new_value = FALSE;
+
+		schedule->num_work_items++;
+	}
+
+	schedule->num_dirty_fields = 0;
+
+	/* Fields on the polled list are read from the hardware when their
+	 * timer interval is up.  Fields that no longer have any callbacks
+	 * or that no longer have MXFF_POLL set are dropped from the list.
+	 */
+
+	j = 0;
+
+	for ( i = 0; i < schedule->num_polled_fields; i++ ) {
+		record_field = schedule->polled_field_array[i];
+
+		callback_list = record_field->callback_list;
+
+		if ( ( callback_list == (MX_LIST *) NULL )
+		  || ( callback_list->list_start == (MX_LIST_ENTRY *) NULL ) )
+		{
+			keep_field = FALSE;
+		} else
+		if ( record_field->poll_state & MXFPS_FIRST_POLL ) {
+			keep_field = TRUE;
+		} else
+		if ( record_field->flags & MXFF_POLL ) {
+			keep_field = TRUE;
+		} else {
+			keep_field = FALSE;
+		}
+
+		if ( keep_field == FALSE ) {
+			record_field->poll_state &=
+				~(MXFPS_POLL_QUEUED | MXFPS_FIRST_POLL);
+
+			continue;
+		}
+
+		schedule->polled_field_array[j] = record_field;
+
+		j++;
+
+		interval = record_field->timer_interval;
+
+		if ( ( ( record_field->poll_state & MXFPS_FIRST_POLL ) == 0 )
+		  && ( interval > 0 )
+		  && ( ( num_polls % interval ) != 0 ) )
+		{
+			/* This field is not due to be polled yet. */
+
+			continue;
+		}
+
+		record_field->poll_state &= (~MXFPS_FIRST_POLL);
+
+		work_item = &(schedule->work_array[schedule->num_work_items]);
+
+		work_item->record_field  = record_field;
+		work_item->get_new_value = TRUE;
+
+		schedule->num_work_items++;
+	}
+
+	schedule->num_polled_fields = j;
+
+	mx_mutex_unlock( schedule->mutex );
+
+	/* Now visit the fields without holding the mutex.  An error for
+	 * one field does not prevent the rest of them from being visited.
+	 */
+
+	return_status = MX_SUCCESSFUL_RESULT;
+
+	for ( i = 0; i < schedule->num_work_items; i++ ) {
+		work_item = &(schedule->work_array[i]);
+
+		record_field = work_item->record_field;
+
+		callback_list = record_field->callback_list;
+
+		if ( ( callback_list == (MX_LIST *) NULL )
+		  || ( callback_list->list_start == (MX_LIST_ENTRY *) NULL ) )
+		{
+			continue;
+		}
+
+		if ( work_item->get_new_value ) {
+
+#if MX_CALLBACK_DEBUG
+			MX_DEBUG(-2,("%s: Processing '%s.%s'",
+			fname, record_field->record->name, record_field->name));
+#endif
+			/* mx_process_record_field() will automatically
+			 * send out any value changed messages that are
+			 * necessary.
+			 */
+
+			mx_status = mx_process_record_field(
+						record_field->record,
+						record_field,
+						MX_PROCESS_GET, NULL );
+		} else {
+			mx_status = mx_test_for_value_changed( record_field,
+						MX_PROCESS_GET,
+						&value_changed );
+
+			if ( ( mx_status.code == MXE_SUCCESS )
+			  && value_changed )
+			{
+				mx_status = mx_local_field_invoke_callback_list(
+					record_field, MXCBT_VALUE_CHANGED );
+			}
+		}
+
+		if ( ( mx_status.code != MXE_SUCCESS )
+		  && ( return_status.code == MXE_SUCCESS ) )
+		{
+			return_status = mx_status;
+		}
+	}
+
+	return return_status;
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* mx_poll_callback_handler() polls the record fields that currently
+ * have value changed callback handlers.  Each poll only visits the fields
+ * that have been marked dirty or that are due to be read from the hardware.
+ * Every list_head->poll_sweep_interval polls, all of the other fields
+ * are checked as well.
  */
 
 MX_EXPORT mx_status_type
@@ -2420,9 +3017,8 @@ mx_poll_callback_handler( MX_CALLBACK_MESSAGE *callback_message )
 	MX_CALLBACK *callback;
 	MX_RECORD_FIELD *record_field;
 	MX_RECORD *record;
-	mx_bool_type get_new_value, send_value_changed_callback;
-	unsigned long i, array_size;
-	long interval;
+	mx_bool_type send_value_changed_callback;
+	unsigned long i, array_size, sweep_interval;
 	mx_status_type mx_status;
 
 #if MX_CALLBACK_DEBUG
@@ -2518,6 +3114,24 @@ mx_poll_callback_handler( MX_CALLBACK_MESSAGE *callback_message )
 
 	/*---*/
 
+	/* Visit the fields that are dirty or are due to be polled. */
+
+	mx_status = mxp_poll_scheduled_fields( list_head );
+
+	/* Fields whose drivers do not call mx_local_field_mark_dirty()
+	 * would never be found by the loop above, so once every
+	 * poll_sweep_interval polls we test every field that has
+	 * callbacks for a change in its value.
+	 */
+
+	sweep_interval = list_head->poll_sweep_interval;
+
+	if ( ( sweep_interval == 0 )
+	  || ( ( list_head->num_poll_callbacks % sweep_interval ) != 0 ) )
+	{
+		return mx_status;
+	}
+
 	handle_table = list_head->server_callback_handle_table;
 
 	if ( handle_table == (MX_HANDLE_TABLE *) NULL ) {
@@ -2526,7 +3140,7 @@ mx_poll_callback_handler( MX_CALLBACK_MESSAGE *callback_message )
 		("%s: No callback handle table installed.", fname));
 #endif
 
-		return MX_SUCCESSFUL_RESULT;
+		return mx_status;
 	}
 
 	if ( handle_table->handle_struct_array
@@ -2555,171 +3169,75 @@ mx_poll_callback_handler( MX_CALLBACK_MESSAGE *callback_message )
 #endif
 
 	    if ( ( handle == MX_ILLEGAL_HANDLE )
-	      || ( callback == NULL ) )
+	      || ( callback == NULL )
+	      || ( callback->callback_function == NULL ) )
 	    {
 		/* Skip unused handles. */
 
 		continue;
 	    }
 
-#if 0
-	    MX_DEBUG(-2,
-    ("%s: handle_struct_array[%lu] = %p, handle = %ld, callback = %p",
-			fname, i, handle_struct, handle, callback));
-#endif
-
-	    /* If this callback has a timer interval,
-	     * check to see if this is the right time
-	     * to invoke the callback.
-	     */
+	    record_field = callback->u.record_field;
 
-	    interval = callback->timer_interval;
+	    if ( record_field == (MX_RECORD_FIELD *) NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"No MX_RECORD_FIELD pointer was specified for "
+		"callback %p", callback );
+	    }
 
-	    if ( interval > 0 ) {
-		unsigned long num_polls;
+	    record = record_field->record;
 
-		num_polls = list_head->num_poll_callbacks;
-#if 1
-		MX_DEBUG(-2,
-		("%s: callback = %p, interval = %ld, num_polls = %lu",
-				fname, callback, interval, num_polls));
-#endif
-		if ( (num_polls % interval) != 0 ) {
-		    /* This is the wrong time,
-		     * so skip this callback.
-		     */
-
-		    continue;
-		}
-#if 1
-		MX_DEBUG(-2,("%s: will perform callback %p",
-				fname, callback));
-#endif
+	    if ( record == (MX_RECORD *) NULL ) {
+		return mx_error( MXE_UNSUPPORTED, fname,
+		"Callbacks are not supported for temporary "
+		"record fields.  Field name = '%s'.",
+			record_field->name );
 	    }
-#if 0
-	    MX_DEBUG(-2,("%s: callback->callback_function = %p",
-			fname, callback->callback_function));
-#endif
-	    /* If a callback function is defined, then we invoke it
-	     * via mx_invoke_callback().
+
+	    /* Fields with MXFF_POLL set are read from the hardware
+	     * by mxp_poll_scheduled_fields(), so we skip them here.
 	     *
-	     * We must decide whether or not a new value will be
-	     * fetched from the hardware and store that decision
-	     * in the variable get_new_value.
+	     * MX client programs can modify the state of the MXFF_POLL
+	     * flag by setting the MX_NETWORK_ATTRIBUTE_POLL (2) attribute
+	     * via the mx_network_field_set_attribute() function.
 	     */
 
-	    if ( callback->callback_function != NULL ) {
-
-	    	record_field = callback->u.record_field;
-
-		if ( record_field == (MX_RECORD_FIELD *) NULL ) {
-			return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
-			"No MX_RECORD_FIELD pointer was specified for "
-			"callback %p", callback );
-		}
+	    if ( ( callback->callback_class == MXCBC_FIELD )
+	      && ( record_field->flags & MXFF_POLL ) )
+	    {
+		continue;
+	    }
 
-		record = record_field->record;
+	    /* We do _not_ process the record field, but we _do_ 
+	     * check to see if the contents of the field have 
+	     * changed since the last time that we looked.
+	     */
 
-		if ( record == (MX_RECORD *) NULL ) {
-			return mx_error( MXE_UNSUPPORTED, fname,
-			"Callbacks are not supported for temporary "
-			"record fields.  Field name = '%s'.",
-				record_field->name );
-		}
+	    mx_status = mx_test_for_value_changed( record_field,
+					MX_PROCESS_GET,
+					&send_value_changed_callback );
 
-		/* If this is the first time that this callback
-		 * has been invoked, then we unconditionally 
-		 * get a new value from the hardware.
-		 */
+	    if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
 
-		if ( callback->first_callback ) {
-		    callback->first_callback = FALSE;
-
-		    get_new_value = TRUE;
-
-		/* Else, if this is a local field callback, we
-		 * check to see if the MXFF_POLL flag is set.
-		 * If MXFF_POLL is set, then we fetch a new
-		 * value from the hardware.  Otherwise, we
-		 * do not.
-		 *
-		 * MX client programs can modify the state
-		 * of the MXFF_POLL flag by setting the
-		 * MX_NETWORK_ATTRIBUTE_POLL (2) attribute
-		 * via the mx_network_field_set_attribute()
-		 * function.
-		 */
-		 
-		} else
-		if ( callback->callback_class == MXCBC_FIELD ) {
-		    if ( record_field->flags & MXFF_POLL ) {
-		    	get_new_value = TRUE;
-		    } else {
-		    	get_new_value = FALSE;
-		    }
+	    if ( send_value_changed_callback ) {
+		record_field->generation++;
 
-		/* If none of the above conditions apply, then
-		 * we will not get a new value from the hardware.
+		/* mx_test_for_value_changed() does _not_ automatically
+		 * send out any value changed messages, so we must
+		 * explicitly do that here.  All of the callbacks for
+		 * the field are invoked, since the next callback for
+		 * the same field would no longer see the change.
 		 */
 
-		} else {
-		    get_new_value = FALSE;
-		}
-
-		/* Do we need to get a new field value? */
-
-		if ( get_new_value ) {
-
-			/* Process the record field to get the new value.
-			 *
-			 * mx_process_record_field() will automatically
-			 * send out any value changed messages that are
-			 * necessary.
-			 */
-
-			record = record_field->record;
-
-#if MX_CALLBACK_DEBUG
-			MX_DEBUG(-2,("%s: Processing '%s.%s'",
-			fname, record->name, record_field->name));
-#endif
-			mx_status = mx_process_record_field(
-						record, record_field,
-						MX_PROCESS_GET, NULL );
-
-			if ( mx_status.code != MXE_SUCCESS )
-				return mx_status;
-		} else {
-			/* We do _not_ process the record field, but we _do_ 
-			 * check to see if the contents of the field have 
-			 * changed since the last time that we looked.
-			 */
-					
-			mx_status = mx_test_for_value_changed( record_field,
-						MX_PROCESS_GET,
-						&send_value_changed_callback );
-
-			if ( mx_status.code != MXE_SUCCESS )
-				return mx_status;
-
-			if ( send_value_changed_callback ) {
+		mx_status = mx_local_field_invoke_callback_list( record_field,
+						MXCBT_VALUE_CHANGED );
 
-				/* mx_test_for_value_changed() does _not_
-				 * automatically send out any value changed
-				 * messages, so we must explicitly do that
-				 * here.
-				 */
-
-				mx_status = mx_invoke_callback( callback,
-						MXCBT_VALUE_CHANGED, FALSE );
-
-				if ( mx_status.code != MXE_SUCCESS )
-					return mx_status;
-			}
-		}
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
 	    }
 	}
 
-	return MX_SUCCESSFUL_RESULT;
+	return mx_status;
 }
 
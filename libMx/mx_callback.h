@@ -146,6 +146,11 @@ MX_API mx_status_type mx_local_field_add_new_callback( MX_RECORD_FIELD *rf,
 
 MX_API mx_status_type mx_local_field_delete_callback( MX_CALLBACK *cb );
 
+MX_API mx_status_type mx_local_field_mark_dirty( MX_RECORD_FIELD *rf );
+
+MX_API mx_status_type mx_local_field_update_poll_schedule(
+						MX_RECORD_FIELD *rf );
+
 MX_API mx_status_type mx_local_field_find_old_callback( MX_RECORD_FIELD *rf,
 					unsigned long *supported_callback_types,
 					uint32_t      *callback_id,
@@ -154,6 +159,10 @@ MX_API mx_status_type mx_local_field_find_old_callback( MX_RECORD_FIELD *rf,
 					void          *callback_argument,
 					MX_CALLBACK **callback_object );
 
+MX_API void mx_set_callback_deferral_function(
+				mx_bool_type ( *deferral_function )
+					( MX_RECORD_FIELD *, unsigned long ) );
+
 MX_API mx_status_type mx_local_field_invoke_callback_list(
 						MX_RECORD_FIELD *field,
 						unsigned long callback_type );
@@ -146,6 +146,10 @@ mx_circular_buffer_read( MX_CIRCULAR_BUFFER *buffer,
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
+	if ( num_bytes_read != (unsigned long *) NULL ) {
+		*num_bytes_read = num_bytes_peeked;
+	}
+
 	/* Unlock the mutex. */
 
 	mx_status_code = mx_mutex_unlock( buffer->mutex );
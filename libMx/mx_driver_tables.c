@@ -285,6 +285,10 @@ mx_get_driver_for_record( MX_RECORD *record )
 		return NULL;
 	}
 
+	if ( record->driver != NULL ) {
+		return (MX_DRIVER *) record->driver;
+	}
+
 	field = mx_get_record_field( record, "mx_type" );
 
 	if ( field == (MX_RECORD_FIELD *) NULL ) {
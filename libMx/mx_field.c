@@ -27,6 +27,7 @@
 #include "mx_driver.h"
 #include "mx_record.h"
 #include "mx_array.h"
+#include "mx_hash_table.h"
 #include "mx_unistd.h"
 
 #include "mx_variable.h"
@@ -327,6 +328,138 @@ mx_get_field_type_string( long field_type )
 
 /*=====================================================================*/
 
+MX_EXPORT mx_status_type
+mx_create_field_name_index( MX_DRIVER *driver )
+{
+	static const char fname[] = "mx_create_field_name_index()";
+
+	MX_HASH_TABLE *field_name_index;
+	MX_RECORD_FIELD_DEFAULTS *record_field_defaults_array;
+	long i, num_record_fields;
+	mx_status_type mx_status;
+
+	if ( driver == (MX_DRIVER *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_DRIVER pointer passed was NULL." );
+	}
+
+	if ( driver->field_name_index != NULL ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	if ( ( driver->num_record_fields == NULL )
+	  || ( driver->record_field_defaults_ptr == NULL ) )
+	{
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	num_record_fields = *(driver->num_record_fields);
+
+	record_field_defaults_array = *(driver->record_field_defaults_ptr);
+
+	if ( ( num_record_fields <= 0 )
+	  || ( record_field_defaults_array == NULL ) )
+	{
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	mx_status = mx_hash_table_create( &field_name_index,
+				MXU_FIELD_NAME_LENGTH + 1,
+				num_record_fields, NULL );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	/* The fields are inserted in reverse order, so that if a driver
+	 * has two fields with the same name, the index finds the first
+	 * one, just like a linear search would.
+	 */
+
+	for ( i = num_record_fields - 1; i >= 0; i-- ) {
+		mx_status = mx_hash_table_insert_key( field_name_index,
+					record_field_defaults_array[i].name,
+					&record_field_defaults_array[i] );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			mx_hash_table_destroy( field_name_index );
+
+			return mx_status;
+		}
+	}
+
+	driver->field_name_index = field_name_index;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* mxp_find_indexed_field_defaults_index() looks for a field name in the
+ * field name index of a driver.  It returns -1 if the driver does not
+ * have an index or the name is not in it.
+ */
+
+static long
+mxp_find_indexed_field_defaults_index( MX_DRIVER *driver,
+					const char *field_name )
+{
+	MX_RECORD_FIELD_DEFAULTS *field_defaults;
+	void *indexed_value;
+	mx_status_type mx_status;
+
+	if ( ( driver == (MX_DRIVER *) NULL )
+	  || ( driver->field_name_index == NULL ) )
+	{
+		return -1;
+	}
+
+	mx_status = mx_hash_table_lookup_key( driver->field_name_index,
+						field_name, &indexed_value );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		return -1;
+	}
+
+	field_defaults = (MX_RECORD_FIELD_DEFAULTS *) indexed_value;
+
+	return (long) ( field_defaults - *(driver->record_field_defaults_ptr) );
+}
+
+/* mxp_find_indexed_record_field() uses the field name index of the
+ * record's driver to find a record field.  The fields of a record are
+ * copied from the driver's field defaults in order, so the index of the
+ * field defaults is also the index of the record field.  We still check
+ * the name, since a driver is free to rearrange its record fields.
+ * If anything does not match, NULL is returned and the caller must
+ * fall back to a linear search.
+ */
+
+static MX_RECORD_FIELD *
+mxp_find_indexed_record_field( MX_RECORD *record, const char *field_name )
+{
+	MX_RECORD_FIELD *field;
+	long i;
+
+	i = mxp_find_indexed_field_defaults_index(
+				(MX_DRIVER *) record->driver, field_name );
+
+	if ( ( i < 0 ) || ( i >= record->num_record_fields ) ) {
+		return NULL;
+	}
+
+	field = &(record->record_field_array[i]);
+
+	if ( field->name == NULL ) {
+		return NULL;
+	}
+
+	if ( strcmp( field_name, field->name ) != 0 ) {
+		return NULL;
+	}
+
+	return field;
+}
+
+/*=====================================================================*/
+
 MX_EXPORT MX_RECORD_FIELD *
 mx_get_record_field( MX_RECORD *record, const char *field_name )
 {
@@ -364,6 +497,12 @@ mx_get_record_field( MX_RECORD *record, const char *field_name )
 		return NULL;
 	}
 
+	field = mxp_find_indexed_record_field( record, field_name );
+
+	if ( field != (MX_RECORD_FIELD *) NULL ) {
+		return field;
+	}
+
 	for ( i = 0; i < num_record_fields; i++ ) {
 
 		field = &field_array[i];
@@ -441,7 +580,12 @@ mx_find_record_field( MX_RECORD *record, const char *name_of_field_to_find,
 			record->name );
 	}
 
-	*field_that_was_found = NULL;
+	*field_that_was_found = mxp_find_indexed_record_field( record,
+							name_of_field_to_find );
+
+	if ( *field_that_was_found != (MX_RECORD_FIELD *) NULL ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
 
 	for ( i = 0; i < num_record_fields; i++ ) {
 		if ( strcmp( name_of_field_to_find, field[i].name ) == 0 ) {
@@ -543,6 +687,15 @@ mx_find_record_field_defaults_index( MX_DRIVER *driver,
 			driver->name );
 	}
 
+	i = mxp_find_indexed_field_defaults_index( driver,
+						name_of_field_to_find );
+
+	if ( ( i >= 0 ) && ( i < num_record_fields ) ) {
+		*index_of_field_that_was_found = i;
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
 	*index_of_field_that_was_found = -1;
 
 	for ( i = 0; i < num_record_fields; i++ ) {
@@ -1014,6 +1167,20 @@ mx_create_record_from_description(
 
 			return mx_status;
 		}
+
+		/* Now that the record fields have their names, lookups
+		 * of the fields can use the driver's field name index.
+		 */
+
+		mx_status = mx_create_field_name_index( type_driver );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			mx_delete_record( current_record );
+
+			return mx_status;
+		}
+
+		current_record->driver = type_driver;
 	}
 
 	*created_record = current_record;
@@ -2209,6 +2376,8 @@ mx_copy_defaults_to_record_field( MX_RECORD_FIELD *field,
 	field->value_has_changed_manual_override = FALSE;
 	field->value_changed_test_function
 				= field_defaults->value_changed_test_function;
+	field->generation           = 0;
+	field->poll_state           = 0;
 	field->callback_list        = NULL;
 	field->application_ptr      = NULL;
 	field->record               = NULL;
@@ -3873,6 +4042,8 @@ mx_initialize_temp_record_field( MX_RECORD_FIELD *temp_record_field,
 	temp_record_field->data_element_size = data_element_size;
 	temp_record_field->process_function = NULL;
 	temp_record_field->flags = MXFF_VARARGS;
+	temp_record_field->generation = 0;
+	temp_record_field->poll_state = 0;
 	temp_record_field->callback_list = NULL;
 	temp_record_field->application_ptr = NULL;
 	temp_record_field->record = NULL;
@@ -25,6 +25,221 @@
 #include "mx_record.h"
 #include "mx_handle.h"
 
+/*--------------------------------------------------------------------------*/
+
+/* The pointer index is an open addressing hash table with linear probing.
+ * Its size is a power of two that is at least twice the number of slots
+ * in handle_struct_array, so it is never more than half full.
+ */
+
+#define MXP_MINIMUM_POINTER_INDEX_SIZE	16
+
+static unsigned long
+mxp_handle_pointer_hash( MX_HANDLE_TABLE *handle_table, void *pointer )
+{
+	unsigned long hash;
+
+	/* The low bits of most pointers are always zero, so they are
+	 * discarded and the remaining bits are mixed together.
+	 */
+
+	hash = (unsigned long) ( ((size_t) pointer) >> 3 );
+
+	hash ^= ( hash >> 16 );
+	hash *= 2654435761UL;
+	hash ^= ( hash >> 16 );
+
+	return ( hash & ( handle_table->pointer_index_size - 1 ) );
+}
+
+static void
+mxp_handle_index_insert( MX_HANDLE_TABLE *handle_table, signed long slot )
+{
+	unsigned long i, mask;
+
+	mask = handle_table->pointer_index_size - 1;
+
+	i = mxp_handle_pointer_hash( handle_table,
+			handle_table->handle_struct_array[slot].pointer );
+
+	while ( handle_table->pointer_index[i] != MX_ILLEGAL_HANDLE ) {
+		i = ( i + 1 ) & mask;
+	}
+
+	handle_table->pointer_index[i] = slot;
+}
+
+/* mxp_handle_index_remove() must be called while the slot still
+ * contains the pointer that it was indexed with.
+ */
+
+static void
+mxp_handle_index_remove( MX_HANDLE_TABLE *handle_table, signed long slot )
+{
+	MX_HANDLE_STRUCT *handle_struct_array;
+	signed long *pointer_index;
+	unsigned long i, j, k, mask;
+
+	handle_struct_array = handle_table->handle_struct_array;
+	pointer_index = handle_table->pointer_index;
+	mask = handle_table->pointer_index_size - 1;
+
+	i = mxp_handle_pointer_hash( handle_table,
+				handle_struct_array[slot].pointer );
+
+	while ( pointer_index[i] != slot ) {
+		if ( pointer_index[i] == MX_ILLEGAL_HANDLE ) {
+			return;		/* The slot was not indexed. */
+		}
+
+		i = ( i + 1 ) & mask;
+	}
+
+	/* Move later entries of the probe sequence back into the hole,
+	 * so that lookups never need to skip over deleted entries.
+	 */
+
+	j = i;
+
+	for (;;) {
+		j = ( j + 1 ) & mask;
+
+		if ( pointer_index[j] == MX_ILLEGAL_HANDLE ) {
+			break;
+		}
+
+		k = mxp_handle_pointer_hash( handle_table,
+			handle_struct_array[ pointer_index[j] ].pointer );
+
+		if ( ( (j > i) && ( (k <= i) || (k > j) ) )
+		  || ( (j < i) && ( (k <= i) && (k > j) ) ) )
+		{
+			pointer_index[i] = pointer_index[j];
+			i = j;
+		}
+	}
+
+	pointer_index[i] = MX_ILLEGAL_HANDLE;
+}
+
+static signed long
+mxp_handle_index_find( MX_HANDLE_TABLE *handle_table, void *pointer )
+{
+	signed long slot;
+	unsigned long i, mask;
+
+	mask = handle_table->pointer_index_size - 1;
+
+	i = mxp_handle_pointer_hash( handle_table, pointer );
+
+	for (;;) {
+		slot = handle_table->pointer_index[i];
+
+		if ( slot == MX_ILLEGAL_HANDLE ) {
+			return MX_ILLEGAL_HANDLE;
+		}
+
+		if ( handle_table->handle_struct_array[slot].pointer
+							== pointer )
+		{
+			return slot;
+		}
+
+		i = ( i + 1 ) & mask;
+	}
+}
+
+static mx_status_type
+mxp_handle_index_rebuild( MX_HANDLE_TABLE *handle_table,
+			unsigned long array_size )
+{
+	static const char fname[] = "mxp_handle_index_rebuild()";
+
+	MX_HANDLE_STRUCT *handle_struct_array;
+	signed long *new_pointer_index;
+	unsigned long i, new_index_size;
+
+	new_index_size = MXP_MINIMUM_POINTER_INDEX_SIZE;
+
+	while ( new_index_size < 2 * array_size ) {
+		new_index_size *= 2;
+	}
+
+	new_pointer_index = (signed long *)
+			malloc( new_index_size * sizeof(signed long) );
+
+	if ( new_pointer_index == (signed long *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Could not allocate a %lu element pointer index for "
+		"handle table %p.", new_index_size, handle_table );
+	}
+
+	for ( i = 0; i < new_index_size; i++ ) {
+		new_pointer_index[i] = MX_ILLEGAL_HANDLE;
+	}
+
+	mx_free( handle_table->pointer_index );
+
+	handle_table->pointer_index = new_pointer_index;
+	handle_table->pointer_index_size = new_index_size;
+
+	handle_struct_array = handle_table->handle_struct_array;
+
+	for ( i = 0; i < array_size; i++ ) {
+		if ( ( handle_struct_array[i].handle >= 0 )
+		  && ( handle_struct_array[i].pointer != NULL ) )
+		{
+			mxp_handle_index_insert( handle_table,
+						(signed long) i );
+		}
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/* mxp_handle_claim_free_slot() takes a specific free slot out of the
+ * free slot bookkeeping for mx_replace_handle().
+ */
+
+static void
+mxp_handle_claim_free_slot( MX_HANDLE_TABLE *handle_table,
+				signed long slot )
+{
+	unsigned long i;
+
+	if ( (unsigned long) slot >= handle_table->next_unused_slot ) {
+
+		/* The never used slots below this one become free slots. */
+
+		for ( i = (unsigned long) slot;
+		    i > handle_table->next_unused_slot; i-- )
+		{
+			handle_table->free_slot_array[
+				handle_table->num_free_slots ]
+					= (signed long) (i - 1);
+
+			handle_table->num_free_slots++;
+		}
+
+		handle_table->next_unused_slot = (unsigned long) slot + 1;
+
+		return;
+	}
+
+	for ( i = 0; i < handle_table->num_free_slots; i++ ) {
+		if ( handle_table->free_slot_array[i] == slot ) {
+			handle_table->num_free_slots--;
+
+			handle_table->free_slot_array[i] =
+	handle_table->free_slot_array[ handle_table->num_free_slots ];
+
+			return;
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------*/
+
 MX_EXPORT mx_status_type
 mx_create_handle_table( MX_HANDLE_TABLE **handle_table,
 			unsigned long handle_table_block_size,
@@ -35,6 +250,7 @@ mx_create_handle_table( MX_HANDLE_TABLE **handle_table,
 	MX_HANDLE_TABLE *new_handle_table;
 	MX_HANDLE_STRUCT *handle_struct_array;
 	unsigned long i, handle_table_size;
+	mx_status_type mx_status;
 
 	if ( handle_table == (MX_HANDLE_TABLE **) NULL ) {
 		return mx_error( MXE_NULL_ARGUMENT, fname,
@@ -76,6 +292,32 @@ mx_create_handle_table( MX_HANDLE_TABLE **handle_table,
 		handle_struct_array[i].pointer = NULL;
 	}
 
+	/* Initialize the free slot stack and the pointer index. */
+
+	new_handle_table->next_unused_slot = 0L;
+	new_handle_table->num_free_slots = 0L;
+	new_handle_table->pointer_index_size = 0L;
+	new_handle_table->pointer_index = NULL;
+
+	new_handle_table->free_slot_array = (signed long *)
+		malloc( (handle_table_size + 1) * sizeof(signed long) );
+
+	if ( new_handle_table->free_slot_array == (signed long *) NULL ) {
+		mx_delete_handle_table( new_handle_table );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Could not allocate a %lu element free slot array.",
+				handle_table_size );
+	}
+
+	mx_status = mxp_handle_index_rebuild( new_handle_table,
+						handle_table_size );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mx_delete_handle_table( new_handle_table );
+		return mx_status;
+	}
+
 	*handle_table = new_handle_table;
 
 	return MX_SUCCESSFUL_RESULT;
@@ -88,7 +330,9 @@ mx_resize_handle_table( MX_HANDLE_TABLE *handle_table,
 	static const char fname[] = "mx_resize_handle_table()";
 
 	MX_HANDLE_STRUCT *old_handle_struct_array, *new_handle_struct_array;
+	signed long *new_free_slot_array;
 	unsigned long i, old_array_size, new_array_size;
+	mx_status_type mx_status;
 
 	if ( handle_table == (MX_HANDLE_TABLE *) NULL ) {
 		return mx_error( MXE_NULL_ARGUMENT, fname,
@@ -124,6 +368,55 @@ mx_resize_handle_table( MX_HANDLE_TABLE *handle_table,
 	handle_table->handle_struct_array = new_handle_struct_array;
 	handle_table->num_blocks = new_num_blocks;
 
+	/* The free slot stack must be able to hold every slot. */
+
+	new_free_slot_array = (signed long *) realloc(
+				handle_table->free_slot_array,
+				(new_array_size + 1) * sizeof(signed long) );
+
+	if ( new_free_slot_array == (signed long *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Failed at attempt to change the length of free_slot_array "
+		"to %lu elements.", new_array_size );
+	}
+
+	handle_table->free_slot_array = new_free_slot_array;
+
+	/* Slots that are removed by shrinking the table are
+	 * no longer available.
+	 */
+
+	if ( handle_table->next_unused_slot > new_array_size ) {
+		handle_table->next_unused_slot = new_array_size;
+
+		for ( i = 0; i < handle_table->num_free_slots; ) {
+			if ( handle_table->free_slot_array[i]
+					>= (signed long) new_array_size )
+			{
+				handle_table->num_free_slots--;
+
+				handle_table->free_slot_array[i] =
+	handle_table->free_slot_array[ handle_table->num_free_slots ];
+			} else {
+				i++;
+			}
+		}
+	}
+
+	/* The pointer index only needs to be rebuilt if it is now too
+	 * small or if slots have been removed.
+	 */
+
+	if ( ( handle_table->pointer_index_size < 2 * new_array_size )
+	  || ( new_array_size < old_array_size ) )
+	{
+		mx_status = mxp_handle_index_rebuild( handle_table,
+							new_array_size );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
 	return MX_SUCCESSFUL_RESULT;
 }
 
@@ -138,6 +431,10 @@ mx_delete_handle_table( MX_HANDLE_TABLE *handle_table )
 
 		handle_table->handle_struct_array = NULL;
 	}
+
+	mx_free( handle_table->free_slot_array );
+	mx_free( handle_table->pointer_index );
+
 	handle_table->handles_in_use = 0L;
 	handle_table->block_size = 0L;
 	handle_table->num_blocks = 0L;
@@ -181,8 +478,9 @@ mx_create_handle( signed long *handle,
 	MX_DEBUG( 8,("%s: handles_in_use = %lu, array_size = %lu",
 		fname, handle_table->handles_in_use, array_size));
 
-	if ( handle_table->handles_in_use >= array_size ) {
-
+	if ( ( handle_table->num_free_slots == 0 )
+	  && ( handle_table->next_unused_slot >= array_size ) )
+	{
 		status = mx_resize_handle_table( handle_table,
 						1 + handle_table->num_blocks );
 
@@ -198,25 +496,32 @@ mx_create_handle( signed long *handle,
 			handle_table );
 	}
 
-	array_size = handle_table->block_size * handle_table->num_blocks;
+	/* Reuse the most recently freed slot, if there is one.
+	 * Otherwise, use the first slot that has never been used.
+	 */
 
-	/* Search for a slot in the array that is not in use. */
+	if ( handle_table->num_free_slots > 0 ) {
+		( handle_table->num_free_slots )--;
 
-	for ( i = 0; i < array_size; i++ ) {
-		if ( handle_struct_array[i].handle < 0 ) {
-			break;			/* Exit the for() loop. */
-		}
+		i = (unsigned long) handle_table->free_slot_array[
+					handle_table->num_free_slots ];
+	} else {
+		i = handle_table->next_unused_slot;
+
+		( handle_table->next_unused_slot )++;
 	}
 
-	if ( i >= array_size ) {
+	if ( handle_struct_array[i].handle >= 0 ) {
 		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
-		"Can't find an empty slot in the MX handle table.  "
-		"This shouldn't be able to happen." );
+		"Free slot %lu in the MX handle table is already in use.  "
+		"This shouldn't be able to happen.", i );
 	}
 
 	handle_struct_array[i].handle = (signed long) i;
 	handle_struct_array[i].pointer = pointer;
 
+	mxp_handle_index_insert( handle_table, (signed long) i );
+
 	*handle = (signed long) i;
 
 	( handle_table->handles_in_use )++;
@@ -251,9 +556,29 @@ mx_delete_handle( signed long handle, MX_HANDLE_TABLE *handle_table )
 			handle_table );
 	}
 
+	if ( handle >= (signed long)
+		( handle_table->block_size * handle_table->num_blocks ) )
+	{
+		return mx_error( MXE_WOULD_EXCEED_LIMIT, fname,
+		"The handle %ld is outside the range of handle values "
+		"for handle table %p.", handle, handle_table );
+	}
+
+	/* Deleting a handle that is not in use does nothing. */
+
+	if ( handle_struct_array[handle].handle != handle ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	mxp_handle_index_remove( handle_table, handle );
+
 	handle_struct_array[handle].handle = MX_ILLEGAL_HANDLE;
 	handle_struct_array[handle].pointer = NULL;
 
+	handle_table->free_slot_array[ handle_table->num_free_slots ] = handle;
+
+	(handle_table->num_free_slots)++;
+
 	(handle_table->handles_in_use)--;
 
 	return MX_SUCCESSFUL_RESULT;
@@ -267,7 +592,7 @@ mx_get_handle_from_pointer( signed long *handle,
 	static const char fname[] = "mx_get_handle_from_pointer()";
 
 	MX_HANDLE_STRUCT *handle_struct_array;
-	unsigned long i, array_size;
+	signed long slot;
 	mx_status_type status;
 
 	if ( handle == NULL ) {
@@ -295,16 +620,10 @@ mx_get_handle_from_pointer( signed long *handle,
 
 	/* Does the handle already exist? */
 
-	array_size = handle_table->block_size * handle_table->num_blocks;
+	slot = mxp_handle_index_find( handle_table, pointer );
 
-	for ( i = 0; i < array_size; i++ ) {
-		if ( handle_struct_array[i].pointer == pointer ) {
-			break;			/* Exit the for() loop. */
-		}
-	}
-
-	if ( i < array_size ) {
-		*handle = handle_struct_array[i].handle;
+	if ( slot >= 0 ) {
+		*handle = handle_struct_array[slot].handle;
 	} else {
 		/* Need to create a new handle. */
 
@@ -425,9 +744,19 @@ mx_replace_handle( signed long handle,
 			handle, array_size-1, handle_table );
 	}
 
+	if ( handle_struct_array[ handle ].handle == handle ) {
+		mxp_handle_index_remove( handle_table, handle );
+	} else {
+		mxp_handle_claim_free_slot( handle_table, handle );
+
+		(handle_table->handles_in_use)++;
+	}
+
 	handle_struct_array[ handle ].handle = handle;
 	handle_struct_array[ handle ].pointer = pointer;
 
+	mxp_handle_index_insert( handle_table, handle );
+
 	return MX_SUCCESSFUL_RESULT;
 }
 
@@ -37,6 +37,27 @@ typedef struct {
 	unsigned long block_size;
 	unsigned long num_blocks;
 	MX_HANDLE_STRUCT *handle_struct_array;
+
+	/* The remaining fields are maintained by the functions in
+	 * mx_handle.c so that creating a handle and finding the handle
+	 * for a pointer do not have to search handle_struct_array.
+	 *
+	 * Slots at or above next_unused_slot have never been used.
+	 * Slots below it that have been freed again are kept in the
+	 * free_slot_array stack.
+	 *
+	 * pointer_index is an open addressing hash table with
+	 * pointer_index_size entries that maps the pointer of each
+	 * active handle to its slot in handle_struct_array.  Empty
+	 * entries contain MX_ILLEGAL_HANDLE.
+	 */
+
+	unsigned long next_unused_slot;
+	unsigned long num_free_slots;
+	signed long *free_slot_array;
+
+	unsigned long pointer_index_size;
+	signed long *pointer_index;
 } MX_HANDLE_TABLE;
 
 #define MX_ILLEGAL_HANDLE	(-1L)
@@ -43,11 +43,14 @@ mx_default_hash_table_function( MX_HASH_TABLE *hash_table, const char *key )
 		return -1;
 	}
 
-	/* Compute the sum of all of the characters in the key. */
+	/* Compute a 32-bit FNV-1a hash of the characters in the key.  A plain
+	 * sum of the characters clusters similar names like 'theta1', 'theta2'
+	 * into neighboring buckets, which makes large tables behave badly.
+	 */
 
 	max_key_length = hash_table->key_length;
 
-	sum = 0;
+	sum = 2166136261UL;
 
 	for ( i = 0; ; i++ ) {
 		if ( i >= max_key_length ) {
@@ -60,7 +63,9 @@ mx_default_hash_table_function( MX_HASH_TABLE *hash_table, const char *key )
 			break;
 		}
 
-		sum = sum + c;
+		sum = sum ^ (unsigned char) c;
+
+		sum = ( sum * 16777619UL ) & 0xffffffffUL;
 	}
 
 	hash = (long) ( sum % (hash_table->table_size) );
@@ -90,6 +95,7 @@ mx_hash_table_create( MX_HASH_TABLE **hash_table,
 
 	(*hash_table)->key_length = key_length;
 	(*hash_table)->table_size = table_size;
+	(*hash_table)->num_keys = 0;
 
 	(*hash_table)->array = calloc(table_size, sizeof(MX_KEY_VALUE_PAIR *));
 
@@ -153,6 +159,7 @@ mx_hash_table_destroy( MX_HASH_TABLE *hash_table )
 		}
 	}
 
+	mx_free( hash_table->array );
 	mx_free( hash_table );
 
 	return;
@@ -239,6 +246,8 @@ mx_hash_table_insert_key( MX_HASH_TABLE *hash_table,
 	new_list_entry->key = malloc( hash_table->key_length );
 
 	if ( new_list_entry->key == (char *) NULL ) {
+		mx_free( new_list_entry );
+
 		return mx_error( MXE_OUT_OF_MEMORY, fname,
 		"Ran out of memory trying to copy key '%s'.", key );
 	}
@@ -250,6 +259,18 @@ mx_hash_table_insert_key( MX_HASH_TABLE *hash_table,
 
 	*new_list_entry_ptr = new_list_entry;
 
+	hash_table->num_keys++;
+
+	/* If the chains are getting long, then make the table bigger.
+	 * A failure to grow the table is not fatal, since the table
+	 * still works, just more slowly.
+	 */
+
+	if ( hash_table->num_keys > 2 * hash_table->table_size ) {
+		(void) mx_hash_table_resize( hash_table,
+					4 * hash_table->table_size + 1 );
+	}
+
 	return MX_SUCCESSFUL_RESULT;
 }
 
@@ -310,6 +331,8 @@ mx_hash_table_delete_key( MX_HASH_TABLE *hash_table,
 		mx_free( first_list_entry->key );
 		mx_free( first_list_entry );
 
+		hash_table->num_keys--;
+
 		return MX_SUCCESSFUL_RESULT;
 	}
 
@@ -330,6 +353,8 @@ mx_hash_table_delete_key( MX_HASH_TABLE *hash_table,
 			mx_free( current_list_entry->key );
 			mx_free( current_list_entry );
 
+			hash_table->num_keys--;
+
 			return MX_SUCCESSFUL_RESULT;
 		}
 
@@ -425,3 +450,66 @@ mx_hash_table_lookup_key( MX_HASH_TABLE *hash_table,
 #endif
 }
 
+MX_EXPORT mx_status_type
+mx_hash_table_resize( MX_HASH_TABLE *hash_table, long new_table_size )
+{
+	static const char fname[] = "mx_hash_table_resize()";
+
+	MX_KEY_VALUE_PAIR **old_array, **new_array;
+	MX_KEY_VALUE_PAIR *list_entry, *next_list_entry;
+	long i, old_table_size, hash;
+
+	if ( hash_table == (MX_HASH_TABLE *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_HASH_TABLE pointer passed was NULL." );
+	}
+	if ( new_table_size <= 0 ) {
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"The requested table size %ld for hash table %p "
+		"is not a positive number.", new_table_size, hash_table );
+	}
+
+	new_array = calloc( new_table_size, sizeof(MX_KEY_VALUE_PAIR *) );
+
+	if ( new_array == (MX_KEY_VALUE_PAIR **) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a %ld element "
+		"table of MX_KEY_VALUE_PAIR structures.", new_table_size );
+	}
+
+	old_array = hash_table->array;
+	old_table_size = hash_table->table_size;
+
+	/* The hash function uses table_size, so it must be changed before
+	 * we start rehashing the existing keys.  Moving the list entries
+	 * rather than copying them means that nothing can fail from here on.
+	 */
+
+	hash_table->array = new_array;
+	hash_table->table_size = new_table_size;
+
+	for ( i = 0; i < old_table_size; i++ ) {
+		list_entry = old_array[i];
+
+		while ( list_entry != (MX_KEY_VALUE_PAIR *) NULL ) {
+			next_list_entry = list_entry->next_list_entry;
+
+			hash = hash_table->hash_function( hash_table,
+							list_entry->key );
+
+			if ( ( hash < 0 ) || ( hash >= new_table_size ) ) {
+				hash = 0;
+			}
+
+			list_entry->next_list_entry = new_array[hash];
+			new_array[hash] = list_entry;
+
+			list_entry = next_list_entry;
+		}
+	}
+
+	mx_free( old_array );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
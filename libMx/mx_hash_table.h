@@ -32,6 +32,7 @@ typedef struct mx_key_value_pair_t {
 typedef struct mx_hash_table_t {
 	long key_length;
 	long table_size;
+	long num_keys;
 	MX_KEY_VALUE_PAIR **array;
 	long (*hash_function)( struct mx_hash_table_t *, const char * );
 } MX_HASH_TABLE;
@@ -53,6 +54,14 @@ MX_API mx_status_type mx_hash_table_delete_key( MX_HASH_TABLE *hash_table,
 MX_API mx_status_type mx_hash_table_lookup_key( MX_HASH_TABLE *hash_table,
 						const char *key, void **value );
 
+/* mx_hash_table_insert_key() grows the table automatically when the
+ * average chain length goes above 2, so the table_size passed to
+ * mx_hash_table_create() is only a starting size.
+ */
+
+MX_API mx_status_type mx_hash_table_resize( MX_HASH_TABLE *hash_table,
+						long new_table_size );
+
 
 #ifdef __cplusplus
 }
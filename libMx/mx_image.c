@@ -35,6 +35,16 @@
 
 #define MX_IMAGE_TEST_DEZINGER		FALSE
 
+#define MX_IMAGE_DEBUG_FILE_IO		FALSE
+
+/* On Linux, we must define _GNU_SOURCE before including any C library header
+ * in order to get O_DIRECT from fcntl.h
+ */
+
+#if defined(OS_LINUX)
+#  define _GNU_SOURCE
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <errno.h>
@@ -47,7 +57,7 @@
 #  include <windows.h>
 #endif
 
-#if defined(__GNUC__)
+#if defined(__GNUC__) && !defined(__USE_XOPEN)
 #  define __USE_XOPEN		/* For strptime() */
 #endif
 
@@ -66,6 +76,13 @@
 #include "mx_console.h"
 #include "mx_image.h"
 #include "mx_image_noir.h"
+#include "mx_image_pool.h"
+#include "mx_metrics.h"
+
+#if defined(OS_UNIX)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#endif
 
 typedef struct {
 	int num_source_bytes;
@@ -566,6 +583,359 @@ mx_image_format_get_bytes_per_pixel( long image_format,
 
 /*--------------------------------------------------------------------------*/
 
+/* Image files whose pixel data is at least MXP_IMAGE_MMAP_READ_MIN_BYTES
+ * long are mapped into memory when MXF_IMAGE_FILE_IO_MMAP_READ is set.
+ * Smaller files are cheaper to just read.
+ *
+ * Images that are at least MXP_IMAGE_DIRECT_WRITE_MIN_BYTES long are
+ * written with O_DIRECT when MXF_IMAGE_FILE_IO_DIRECT_WRITE is set.
+ * O_DIRECT requires the file offset, the length and the address of the
+ * buffer for each write to be multiples of the logical block size of
+ * the device.  If the device or filesystem rejects the write, then the
+ * rest of the image is written through the page cache instead.
+ */
+
+#define MXP_IMAGE_MMAP_READ_MIN_BYTES		(1024L * 1024L)
+
+#define MXP_IMAGE_DIRECT_WRITE_MIN_BYTES	(4L * 1024L * 1024L)
+
+#define MXP_IMAGE_DIRECT_IO_ALIGNMENT		512
+#define MXP_IMAGE_DIRECT_IO_BUFFER_ALIGNMENT	4096
+#define MXP_IMAGE_DIRECT_IO_CHUNK_SIZE		(4L * 1024L * 1024L)
+
+#if defined(OS_UNIX)
+#  define MXP_IMAGE_HAVE_MMAP		TRUE
+#else
+#  define MXP_IMAGE_HAVE_MMAP		FALSE
+#endif
+
+#if defined(OS_LINUX) && defined(O_DIRECT)
+#  define MXP_IMAGE_HAVE_O_DIRECT	TRUE
+#else
+#  define MXP_IMAGE_HAVE_O_DIRECT	FALSE
+#endif
+
+static unsigned long mxp_image_file_io_flags = MXF_IMAGE_FILE_IO_DEFAULT;
+
+MX_EXPORT void
+mx_image_set_file_io_flags( unsigned long flags )
+{
+	mxp_image_file_io_flags = flags;
+}
+
+MX_EXPORT unsigned long
+mx_image_get_file_io_flags( void )
+{
+	return mxp_image_file_io_flags;
+}
+
+/* mxp_image_unmap_data() releases the file mapping used by a frame.
+ * If 'keep_data' is TRUE, then the pixel data is first copied to a new
+ * buffer owned by the frame.  Otherwise, the frame is left without
+ * an image buffer.
+ */
+
+static mx_status_type
+mxp_image_unmap_data( MX_IMAGE_FRAME *frame, mx_bool_type keep_data )
+{
+	static const char fname[] = "mxp_image_unmap_data()";
+
+	void *new_image_data;
+
+	if ( frame == (MX_IMAGE_FRAME *) NULL ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+	if ( frame->mapped_data == NULL ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	new_image_data = NULL;
+
+	if ( keep_data && ( frame->image_length > 0 ) ) {
+		new_image_data = malloc( frame->image_length );
+
+		if ( new_image_data == NULL ) {
+			return mx_error( MXE_OUT_OF_MEMORY, fname,
+			"Ran out of memory trying to allocate a %lu byte "
+			"image buffer for frame %p.",
+				(unsigned long) frame->image_length, frame );
+		}
+
+		memcpy( new_image_data, frame->image_data,
+					frame->image_length );
+	}
+
+#if MXP_IMAGE_HAVE_MMAP
+	(void) munmap( frame->mapped_data, frame->mapped_length );
+#endif
+
+	frame->mapped_data = NULL;
+	frame->mapped_length = 0;
+
+	frame->image_data = new_image_data;
+
+	if ( new_image_data == NULL ) {
+		frame->image_length = 0;
+		frame->allocated_image_length = 0;
+	} else {
+		frame->allocated_image_length = frame->image_length;
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+#if MXP_IMAGE_HAVE_MMAP
+
+/* mxp_image_map_data() tries to point the frame's image_data at the
+ * next 'num_bytes' bytes of 'file' via a private mapping of the file.
+ * The mapping is copy-on-write, so byteswapping or correcting the frame
+ * in place only copies the pages that are actually modified and never
+ * changes the file.
+ */
+
+static mx_bool_type
+mxp_image_map_data( MX_IMAGE_FRAME *frame, size_t num_bytes, FILE *file )
+{
+#if MX_IMAGE_DEBUG_FILE_IO
+	static const char fname[] = "mxp_image_map_data()";
+#endif
+
+	struct stat file_stat;
+	off_t offset;
+	size_t map_length;
+	void *map_address;
+	int fd;
+
+	offset = ftello( file );
+
+	if ( offset < 0 ) {
+		return FALSE;
+	}
+
+	fd = fileno( file );
+
+	if ( fstat( fd, &file_stat ) != 0 ) {
+		return FALSE;
+	}
+
+	map_length = (size_t) offset + num_bytes;
+
+	/* If the file is too short, let fread() report the problem. */
+
+	if ( (size_t) file_stat.st_size < map_length ) {
+		return FALSE;
+	}
+
+	map_address = mmap( NULL, map_length, PROT_READ | PROT_WRITE,
+					MAP_PRIVATE, fd, 0 );
+
+	if ( map_address == MAP_FAILED ) {
+		return FALSE;
+	}
+
+#if defined(MADV_WILLNEED)
+	(void) madvise( map_address, map_length, MADV_WILLNEED );
+#endif
+
+	/* Replace the frame's own image buffer with the mapping. */
+
+	(void) mxp_image_unmap_data( frame, FALSE );
+
+	mx_free( frame->image_data );
+
+	frame->mapped_data = map_address;
+	frame->mapped_length = map_length;
+
+	frame->image_data = (char *) map_address + offset;
+	frame->image_length = num_bytes;
+	frame->allocated_image_length = num_bytes;
+
+#if MX_IMAGE_DEBUG_FILE_IO
+	MX_DEBUG(-2,("%s: mapped %lu bytes at offset %ld for frame %p.",
+		fname, (unsigned long) num_bytes, (long) offset, frame));
+#endif
+
+	return TRUE;
+}
+
+#endif /* MXP_IMAGE_HAVE_MMAP */
+
+/* mxp_image_read_data() is used by the image file readers in place of
+ * fread() to fill in the image data of a frame that has already been
+ * set up by mx_image_alloc().  It returns the number of bytes read.
+ */
+
+static size_t
+mxp_image_read_data( MX_IMAGE_FRAME *frame, size_t num_bytes, FILE *file )
+{
+#if MXP_IMAGE_HAVE_MMAP
+	if ( ( mxp_image_file_io_flags & MXF_IMAGE_FILE_IO_MMAP_READ )
+	  && ( num_bytes >= MXP_IMAGE_MMAP_READ_MIN_BYTES ) )
+	{
+		if ( mxp_image_map_data( frame, num_bytes, file ) ) {
+			return num_bytes;
+		}
+	}
+#endif
+
+	return fread( frame->image_data, sizeof(unsigned char),
+				num_bytes, file );
+}
+
+#if MXP_IMAGE_HAVE_O_DIRECT
+
+static size_t
+mxp_image_write_direct( void *data, size_t num_bytes, FILE *file )
+{
+#if MX_IMAGE_DEBUG_FILE_IO
+	static const char fname[] = "mxp_image_write_direct()";
+#endif
+
+	char *src, *bounce_buffer;
+	off_t offset;
+	size_t aligned_bytes, bytes_done, chunk_size;
+	ssize_t pwrite_status;
+	int fd, fd_flags, saved_errno;
+
+	if ( fflush( file ) != 0 ) {
+		return 0;
+	}
+
+	offset = ftello( file );
+
+	if ( ( offset < 0 ) || ( (offset % MXP_IMAGE_DIRECT_IO_ALIGNMENT) != 0 ) )
+	{
+		return fwrite( data, 1, num_bytes, file );
+	}
+
+	fd = fileno( file );
+
+	fd_flags = fcntl( fd, F_GETFL );
+
+	if ( fd_flags == -1 ) {
+		return fwrite( data, 1, num_bytes, file );
+	}
+
+	bounce_buffer = NULL;
+
+	if ( ( ((unsigned long) data) % MXP_IMAGE_DIRECT_IO_BUFFER_ALIGNMENT )
+		!= 0 )
+	{
+		if ( posix_memalign( (void **) &bounce_buffer,
+				MXP_IMAGE_DIRECT_IO_BUFFER_ALIGNMENT,
+				MXP_IMAGE_DIRECT_IO_CHUNK_SIZE ) != 0 )
+		{
+			return fwrite( data, 1, num_bytes, file );
+		}
+	}
+
+	aligned_bytes = num_bytes
+		- ( num_bytes % MXP_IMAGE_DIRECT_IO_ALIGNMENT );
+
+	bytes_done = 0;
+	saved_errno = 0;
+
+	if ( fcntl( fd, F_SETFL, fd_flags | O_DIRECT ) == 0 ) {
+
+		while ( bytes_done < aligned_bytes ) {
+			chunk_size = aligned_bytes - bytes_done;
+
+			if ( chunk_size > MXP_IMAGE_DIRECT_IO_CHUNK_SIZE ) {
+				chunk_size = MXP_IMAGE_DIRECT_IO_CHUNK_SIZE;
+			}
+
+			src = (char *) data + bytes_done;
+
+			if ( bounce_buffer != NULL ) {
+				memcpy( bounce_buffer, src, chunk_size );
+				src = bounce_buffer;
+			}
+
+			pwrite_status = pwrite( fd, src, chunk_size,
+						offset + bytes_done );
+
+			if ( pwrite_status < 0 ) {
+				if ( errno == EINTR ) {
+					continue;
+				}
+				if ( errno != EINVAL ) {
+					saved_errno = errno;
+				}
+				break;
+			}
+
+			bytes_done += pwrite_status;
+
+			/* A short write leaves us unaligned, so the
+			 * rest must go through the page cache.
+			 */
+
+			if ( (size_t) pwrite_status < chunk_size ) {
+				break;
+			}
+		}
+
+		(void) fcntl( fd, F_SETFL, fd_flags );
+	}
+
+	mx_free( bounce_buffer );
+
+#if MX_IMAGE_DEBUG_FILE_IO
+	MX_DEBUG(-2,("%s: wrote %lu of %lu bytes with O_DIRECT.",
+		fname, (unsigned long) bytes_done,
+		(unsigned long) num_bytes));
+#endif
+
+	/* Write whatever is left without O_DIRECT. */
+
+	while ( ( saved_errno == 0 ) && ( bytes_done < num_bytes ) ) {
+		pwrite_status = pwrite( fd, (char *) data + bytes_done,
+					num_bytes - bytes_done,
+					offset + bytes_done );
+
+		if ( pwrite_status < 0 ) {
+			if ( errno == EINTR ) {
+				continue;
+			}
+			saved_errno = errno;
+			break;
+		}
+
+		bytes_done += pwrite_status;
+	}
+
+	/* Move the stdio file position past the data we just wrote. */
+
+	(void) fseeko( file, offset + bytes_done, SEEK_SET );
+
+	errno = saved_errno;
+
+	return bytes_done;
+}
+
+#endif /* MXP_IMAGE_HAVE_O_DIRECT */
+
+/* mxp_image_write_data() is used by the image file writers in place of
+ * fwrite() to write out the image data.  It returns the number of bytes
+ * written and leaves errno set if not all of them could be written.
+ */
+
+static size_t
+mxp_image_write_data( void *data, size_t num_bytes, FILE *file )
+{
+#if MXP_IMAGE_HAVE_O_DIRECT
+	if ( ( mxp_image_file_io_flags & MXF_IMAGE_FILE_IO_DIRECT_WRITE )
+	  && ( num_bytes >= MXP_IMAGE_DIRECT_WRITE_MIN_BYTES ) )
+	{
+		return mxp_image_write_direct( data, num_bytes, file );
+	}
+#endif
+
+	return fwrite( data, 1, num_bytes, file );
+}
+
+/*--------------------------------------------------------------------------*/
+
 MX_EXPORT mx_status_type
 mx_image_alloc( MX_IMAGE_FRAME **frame,
 			long row_framesize,
@@ -746,6 +1116,19 @@ mx_image_alloc( MX_IMAGE_FRAME **frame,
 	MX_DEBUG(-2,("%s: *frame = %p", fname, *frame));
 #endif
 
+	/* A frame whose image data is in a file mapping is given its own
+	 * buffer before the buffer is reused or resized.
+	 */
+
+	if ( (*frame)->mapped_data != NULL ) {
+		mx_status_type mx_status;
+
+		mx_status = mxp_image_unmap_data( *frame, TRUE );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
 	if ( ((*frame)->image_length == 0) && (bytes_per_frame == 0)) {
 
 		/* Zero length image buffers are not allowed. */
@@ -782,6 +1165,33 @@ mx_image_alloc( MX_IMAGE_FRAME **frame,
 		("%s: The image buffer is already big enough.", fname));
 #endif
 		(*frame)->image_length = bytes_per_frame;
+	} else
+	if ( (*frame)->image_pool != NULL ) {
+		void *new_image_data;
+
+		/* realloc() would not preserve the alignment of a pooled
+		 * frame's buffer, so we get a new buffer from the pool.
+		 */
+
+		new_image_data = mx_image_pool_alloc_buffer(
+						(*frame)->image_pool,
+						bytes_per_frame );
+
+		if ( new_image_data == NULL ) {
+			return mx_error( MXE_OUT_OF_MEMORY, fname,
+			"Ran out of memory trying to allocate a %ld byte "
+			"image buffer for frame %p",
+				bytes_per_frame, *frame );
+		}
+
+		memcpy( new_image_data, (*frame)->image_data,
+					(*frame)->image_length );
+
+		free( (*frame)->image_data );
+
+		(*frame)->image_data = new_image_data;
+		(*frame)->image_length = bytes_per_frame;
+		(*frame)->allocated_image_length = bytes_per_frame;
 	} else {
 
 #if MX_IMAGE_DEBUG
@@ -872,10 +1282,21 @@ mx_image_free( MX_IMAGE_FRAME *frame )
 		return;
 	}
 
+	/* Frames leased from an image pool go back to the pool. */
+
+	if ( frame->image_pool != NULL ) {
+		if ( mx_image_pool_release( frame ) ) {
+			return;
+		}
+	}
+
 	if ( frame->header_data != NULL ) {
 		free( frame->header_data );
 	}
 
+	if ( frame->mapped_data != NULL ) {
+		(void) mxp_image_unmap_data( frame, FALSE );
+	} else
 	if ( frame->image_data != NULL ) {
 		free( frame->image_data );
 	}
@@ -1497,14 +1918,11 @@ mx_image_statistics( MX_IMAGE_FRAME *frame )
 {
 	static const char fname[] = "mx_image_statistics()";
 
-	uint8_t  *uint8_array  = NULL;
-	uint16_t *uint16_array = NULL;
-	int32_t  *int32_array  = NULL;
-	float    *float_array  = NULL;
-	double   *double_array = NULL;
 	char image_format_name[20];
-	unsigned long i, num_pixels, image_format;
+	unsigned long i, num_pixels, image_format, num_values;
 	unsigned long row_framesize, column_framesize;
+	unsigned long *value_counts;
+	uint64_t value_sum;
 	double sum, sum_of_squares, mean, standard_deviation;
 	double pixel, diff, pixel_sd;
 	double min_pixel, max_pixel;
@@ -1530,8 +1948,6 @@ mx_image_statistics( MX_IMAGE_FRAME *frame )
 
 	/*---*/
 
-	pixel = 0.0;
-
 	row_framesize = MXIF_ROW_FRAMESIZE(frame);
 	column_framesize = MXIF_COLUMN_FRAMESIZE(frame);
 	image_format = MXIF_IMAGE_FORMAT(frame);
@@ -1545,31 +1961,25 @@ mx_image_statistics( MX_IMAGE_FRAME *frame )
 
 	num_pixels = row_framesize * column_framesize;
 
+	num_values = 0;
+
 	switch( image_format ) {
 	case MXT_IMAGE_FORMAT_GREY8:
-		uint8_array = frame->image_data;
-
-		first_pixel = uint8_array[0];
+		first_pixel = ((uint8_t *) frame->image_data)[0];
+		num_values = 256;
 		break;
 	case MXT_IMAGE_FORMAT_GREY16:
-		uint16_array = frame->image_data;
-
-		first_pixel = uint16_array[0];
+		first_pixel = ((uint16_t *) frame->image_data)[0];
+		num_values = 65536;
 		break;
 	case MXT_IMAGE_FORMAT_INT32:
-		int32_array = frame->image_data;
-
-		first_pixel = int32_array[0];
+		first_pixel = ((int32_t *) frame->image_data)[0];
 		break;
 	case MXT_IMAGE_FORMAT_FLOAT:
-		float_array = frame->image_data;
-
-		first_pixel = float_array[0];
+		first_pixel = ((float *) frame->image_data)[0];
 		break;
 	case MXT_IMAGE_FORMAT_DOUBLE:
-		double_array = frame->image_data;
-
-		first_pixel = double_array[0];
+		first_pixel = ((double *) frame->image_data)[0];
 		break;
 	default:
 		return mx_error( MXE_UNSUPPORTED, fname,
@@ -1577,49 +1987,78 @@ mx_image_statistics( MX_IMAGE_FRAME *frame )
 		"is not supported by this routine.", image_format );
 	}
 
-	/* First compute the mean. */
+	/* 8-bit and 16-bit images with at least as many pixels as there
+	 * are possible pixel values are summarized with a histogram of the
+	 * pixel values, so that the image is only read once.  All of the
+	 * statistics are then computed from the histogram.  Other images
+	 * use the vectorized kernels in mx_image_simd.c.
+	 */
 
-	sum = 0.0;
-	pixels_are_all_equal = TRUE;
+	if ( num_pixels < num_values ) {
+		num_values = 0;
+	}
 
-	min_pixel = 1.0e38;
-	max_pixel = -1.0e38;
+	value_counts = NULL;
 
-	for ( i = 0; i < num_pixels; i++ ) {
-		switch( image_format ) {
-		case MXT_IMAGE_FORMAT_GREY8:
-			pixel = uint8_array[i];
-			break;
-		case MXT_IMAGE_FORMAT_GREY16:
-			pixel = uint16_array[i];
-			break;
-		case MXT_IMAGE_FORMAT_INT32:
-			pixel = int32_array[i];
-			break;
-		case MXT_IMAGE_FORMAT_FLOAT:
-			pixel = float_array[i];
-			break;
-		case MXT_IMAGE_FORMAT_DOUBLE:
-			pixel = double_array[i];
-			break;
+	if ( num_values > 0 ) {
+		value_counts = malloc( num_values * sizeof(unsigned long) );
+
+		if ( value_counts == (unsigned long *) NULL ) {
+			return mx_error( MXE_OUT_OF_MEMORY, fname,
+			"Ran out of memory trying to allocate a %lu element "
+			"pixel value histogram.", num_values );
 		}
 
-		if ( pixels_are_all_equal ) {
-			if ( fabs(pixel - first_pixel) > 0.1 ) {
-				pixels_are_all_equal = FALSE;
-			}
+		mx_status = mx_image_value_histogram_kernel( image_format,
+						frame->image_data, num_pixels,
+						value_counts );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			mx_free( value_counts );
+			return mx_status;
 		}
 
-		if ( pixel < min_pixel )
-			min_pixel = pixel;
+		min_pixel = HUGE_VAL;
+		max_pixel = -HUGE_VAL;
+		value_sum = 0;
 
-		if ( pixel > max_pixel )
-			max_pixel = pixel;
+		for ( i = 0; i < num_values; i++ ) {
+			if ( value_counts[i] == 0 )
+				continue;
 
-		sum += pixel;
+			if ( i < min_pixel )
+				min_pixel = i;
+
+			max_pixel = i;
+
+			value_sum += ((uint64_t) i) * value_counts[i];
+		}
+
+		sum = (double) value_sum;
+	} else {
+		mx_status = mx_image_pixel_summary_kernel( image_format,
+						frame->image_data, num_pixels,
+						&min_pixel, &max_pixel, &sum );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
+	/* The pixels are all equal if none of them differ from the first
+	 * pixel by more than 0.1.  NaN pixels are ignored.
+	 */
+
+	if ( ( (max_pixel - first_pixel) > 0.1 )
+	  || ( (first_pixel - min_pixel) > 0.1 ) )
+	{
+		pixels_are_all_equal = FALSE;
+	} else {
+		pixels_are_all_equal = TRUE;
 	}
 
 	if ( pixels_are_all_equal ) {
+		mx_free( value_counts );
+
 		mx_info( "(%lux%lu) %s image frame, exposure time = %f sec",
 			row_framesize, column_framesize,
 			image_format_name, exposure_time );
@@ -1630,34 +2069,38 @@ mx_image_statistics( MX_IMAGE_FRAME *frame )
 		return MX_SUCCESSFUL_RESULT;
 	}
 
+	/* The minimum and maximum are reported relative to starting values
+	 * of 1.0e38 and -1.0e38.
+	 */
+
+	if ( min_pixel > 1.0e38 )
+		min_pixel = 1.0e38;
+
+	if ( max_pixel < -1.0e38 )
+		max_pixel = -1.0e38;
+
 	mean = sum / (double) num_pixels;
 
 	/* Next compute the standard deviation. */
 
-	sum_of_squares = 0.0;
+	if ( value_counts != (unsigned long *) NULL ) {
+		sum_of_squares = 0.0;
 
-	for ( i = 0; i < num_pixels; i++ ) {
-		switch( image_format ) {
-		case MXT_IMAGE_FORMAT_GREY8:
-			pixel = uint8_array[i];
-			break;
-		case MXT_IMAGE_FORMAT_GREY16:
-			pixel = uint16_array[i];
-			break;
-		case MXT_IMAGE_FORMAT_INT32:
-			pixel = int32_array[i];
-			break;
-		case MXT_IMAGE_FORMAT_FLOAT:
-			pixel = float_array[i];
-			break;
-		case MXT_IMAGE_FORMAT_DOUBLE:
-			pixel = double_array[i];
-			break;
-		}
+		for ( i = 0; i < num_values; i++ ) {
+			if ( value_counts[i] == 0 )
+				continue;
+
+			diff = ((double) i) - mean;
 
-		diff = pixel - mean;
+			sum_of_squares += value_counts[i] * (diff * diff);
+		}
+	} else {
+		mx_status = mx_image_sum_of_squares_kernel( image_format,
+						frame->image_data, num_pixels,
+						mean, &sum_of_squares );
 
-		sum_of_squares += (diff * diff);
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
 	}
 
 	standard_deviation = sqrt( sum_of_squares
@@ -1665,41 +2108,42 @@ mx_image_statistics( MX_IMAGE_FRAME *frame )
 
 	/* Finish by generating a simple histogram of pixel values. */
 
-	for ( i = 0; i < MX_IMAGE_STATISTICS_BINS; i++ ) {
-		sd_histogram[i] = 0;
-	}
-
-	for ( i = 0; i < num_pixels; i++ ) {
-		switch( image_format ) {
-		case MXT_IMAGE_FORMAT_GREY8:
-			pixel = uint8_array[i];
-			break;
-		case MXT_IMAGE_FORMAT_GREY16:
-			pixel = uint16_array[i];
-			break;
-		case MXT_IMAGE_FORMAT_INT32:
-			pixel = int32_array[i];
-			break;
-		case MXT_IMAGE_FORMAT_FLOAT:
-			pixel = float_array[i];
-			break;
-		case MXT_IMAGE_FORMAT_DOUBLE:
-			pixel = double_array[i];
-			break;
+	if ( value_counts != (unsigned long *) NULL ) {
+		for ( i = 0; i < MX_IMAGE_STATISTICS_BINS; i++ ) {
+			sd_histogram[i] = 0;
 		}
 
-		pixel_sd = ( ( pixel - mean ) / standard_deviation );
+		for ( i = 0; i < num_values; i++ ) {
+			if ( value_counts[i] == 0 )
+				continue;
 
-		pixel_bin = mx_round( pixel_sd + MX_IMAGE_STATISTICS_MAX_SD );
+			pixel = i;
 
-		if ( pixel_bin >= MX_IMAGE_STATISTICS_BINS ) {
-			(sd_histogram[MX_IMAGE_STATISTICS_BINS - 1])++;
-		} else
-		if ( pixel_bin < 0 ) {
-			(sd_histogram[0])++;
-		} else {
-			(sd_histogram[pixel_bin])++;
+			pixel_sd = ( ( pixel - mean ) / standard_deviation );
+
+			pixel_bin = mx_round( pixel_sd
+					+ MX_IMAGE_STATISTICS_MAX_SD );
+
+			if ( pixel_bin >= MX_IMAGE_STATISTICS_BINS ) {
+				pixel_bin = MX_IMAGE_STATISTICS_BINS - 1;
+			} else
+			if ( pixel_bin < 0 ) {
+				pixel_bin = 0;
+			}
+
+			sd_histogram[pixel_bin] += value_counts[i];
 		}
+
+		mx_free( value_counts );
+	} else {
+		mx_status = mx_image_sd_histogram_kernel( image_format,
+						frame->image_data, num_pixels,
+						mean, standard_deviation,
+						MX_IMAGE_STATISTICS_MAX_SD,
+						sd_histogram );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
 	}
 
 	/* Show the results. */
@@ -1817,7 +2261,23 @@ mx_image_copy_frame( MX_IMAGE_FRAME *old_frame,
 		"The old frame pointer passed was NULL." );
 	}
 
-	mx_status = mx_image_alloc( new_frame_ptr,
+	/* Copies of pooled frames are leased from the same pool. */
+
+	if ( ( *new_frame_ptr == (MX_IMAGE_FRAME *) NULL )
+	  && ( old_frame->image_pool != NULL ) )
+	{
+		mx_status = mx_image_pool_lease( old_frame->image_pool,
+				new_frame_ptr,
+				(long) MXIF_ROW_FRAMESIZE(old_frame),
+				(long) MXIF_COLUMN_FRAMESIZE(old_frame),
+				(long) MXIF_IMAGE_FORMAT(old_frame),
+				(long) MXIF_BYTE_ORDER(old_frame),
+				MXIF_BYTES_PER_PIXEL(old_frame),
+				old_frame->header_length,
+				old_frame->dictionary,
+				old_frame->record );
+	} else {
+		mx_status = mx_image_alloc( new_frame_ptr,
 				(long) MXIF_ROW_FRAMESIZE(old_frame),
 				(long) MXIF_COLUMN_FRAMESIZE(old_frame),
 				(long) MXIF_IMAGE_FORMAT(old_frame),
@@ -1827,6 +2287,7 @@ mx_image_copy_frame( MX_IMAGE_FRAME *old_frame,
 				old_frame->image_length,
 				old_frame->dictionary,
 				old_frame->record );
+	}
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
@@ -1971,18 +2432,19 @@ mx_image_rebin( MX_IMAGE_FRAME **rebinned_frame,
 			MXIF_BYTES_PER_PIXEL(original_frame) );
 	}
 
-	/* Actually, we currently only support 8, 16, or 32 bit pixels. */
+	/* Actually, we currently only support 8, 16, 32, or 64 bit pixels. */
 
 	switch( bytes_per_pixel ) {
 	case 1:
 	case 2:
 	case 4:
+	case 8:
 		break;
 	default:
 		return mx_error( MXE_UNSUPPORTED, fname,
 			"The original image frame contains an unsupported "
 			"number of bytes per pixel (%ld).  Currently, we only "
-			"support 1, 2 or 4 bytes per pixel.",
+			"support 1, 2, 4 or 8 bytes per pixel.",
 				bytes_per_pixel );
 		break;
 	}
@@ -2102,10 +2564,36 @@ mx_image_rebin( MX_IMAGE_FRAME **rebinned_frame,
 	memset( (*rebinned_frame)->image_data, 0,
 			(*rebinned_frame)->allocated_image_length );
 
-	/* Get the new MX datatype from the original image format. */
-
 	original_image_format = MXIF_IMAGE_FORMAT(original_frame);
 
+	/* Shrinking in both directions, which is what live previews of
+	 * large detectors do, is handled for all of the monochrome image
+	 * formats by the vectorized kernel in mx_image_simd.c.
+	 */
+
+	if ( shrink_width && shrink_height ) {
+		switch( original_image_format ) {
+		case MXT_IMAGE_FORMAT_GREY8:
+		case MXT_IMAGE_FORMAT_GREY16:
+		case MXT_IMAGE_FORMAT_GREY32:
+		case MXT_IMAGE_FORMAT_INT32:
+		case MXT_IMAGE_FORMAT_FLOAT:
+		case MXT_IMAGE_FORMAT_DOUBLE:
+			mx_status = mx_image_rebin_shrink_kernel(
+					original_image_format,
+					original_frame->image_data,
+					original_width,
+					(*rebinned_frame)->image_data,
+					rebinned_width, rebinned_height,
+					width_shrink_factor,
+					height_shrink_factor );
+
+			return mx_status;
+		}
+	}
+
+	/* Get the new MX datatype from the original image format. */
+
 	switch( original_image_format ) {
 	case MXT_IMAGE_FORMAT_GREY8:
 		original_mx_datatype = MXFT_UCHAR;
@@ -2167,9 +2655,10 @@ mx_image_rebin( MX_IMAGE_FRAME **rebinned_frame,
 	switch( bytes_per_pixel ) {
 	case 1:
 	case 4:
+	case 8:
 	    return mx_error( MXE_NOT_YET_IMPLEMENTED, fname,
-			"Support for 8-bit and 32-bit arrays has not yet "
-			"been implemented." );
+			"Rebinning of 8-bit, 32-bit, and 64-bit arrays is "
+			"only implemented for shrinking in both directions." );
 	    break;
 
 	case 2:
@@ -3061,6 +3550,50 @@ mx_image_read_file( MX_IMAGE_FRAME **frame_ptr,
 	return mx_status;
 }
 
+/* Each image file format gets its own 'mx_image_write_seconds' histogram.
+ * The metrics are cached here in the same order as mxp_file_format_table,
+ * since their addresses never change.
+ */
+
+static MX_METRIC *mxp_image_write_metric_table[
+	sizeof(mxp_file_format_table) / sizeof(mxp_file_format_table[0]) ];
+
+static MX_METRIC *
+mxp_image_write_metric( unsigned long datafile_type )
+{
+	MX_IMAGE_FORMAT_ENTRY *entry;
+	MX_METRIC *metric;
+	char labels[MXU_METRIC_LABELS_LENGTH+1];
+	size_t i;
+	mx_status_type mx_status;
+
+	for ( i = 0; i < mxp_file_format_table_length; i++ ) {
+		entry = &mxp_file_format_table[i];
+
+		if ( entry->type != (long) datafile_type )
+			continue;
+
+		metric = mxp_image_write_metric_table[i];
+
+		if ( metric != (MX_METRIC *) NULL )
+			return metric;
+
+		snprintf( labels, sizeof(labels), "format=\"%s\"", entry->name );
+
+		mx_status = mx_metrics_find( "mx_image_write_seconds", labels,
+						MXT_METRIC_HISTOGRAM, &metric );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return NULL;
+
+		mxp_image_write_metric_table[i] = metric;
+
+		return metric;
+	}
+
+	return NULL;
+}
+
 MX_EXPORT mx_status_type
 mx_image_write_file( MX_IMAGE_FRAME *frame,
 			MX_DICTIONARY *dictionary,
@@ -3069,6 +3602,7 @@ mx_image_write_file( MX_IMAGE_FRAME *frame,
 {
 	static const char fname[] = "mx_image_write_file()";
 
+	uint64_t metrics_start;
 	mx_status_type mx_status;
 
 #if 0
@@ -3093,6 +3627,8 @@ mx_image_write_file( MX_IMAGE_FRAME *frame,
 	mx_image_statistics( frame );
 #endif
 
+	metrics_start = mx_metrics_start();
+
 	switch( datafile_type ) {
 	case MXT_IMAGE_FILE_NONE:
 		mx_status = mx_image_write_none_file( frame, datafile_name );
@@ -3136,6 +3672,11 @@ mx_image_write_file( MX_IMAGE_FRAME *frame,
 			datafile_type, datafile_name );
 	}
 
+	if ( ( metrics_start != 0 ) && ( mx_status.code == MXE_SUCCESS ) ) {
+		mx_metrics_stop( mxp_image_write_metric( datafile_type ),
+				metrics_start );
+	}
+
 	return mx_status;
 }
 
@@ -3185,6 +3726,8 @@ mx_image_read_none_file( MX_IMAGE_FRAME **frame, char *fake_datafile_name )
 
 	/* Create or resize the data array. */
 
+	(void) mxp_image_unmap_data( *frame, FALSE );
+
 	if ( (*frame)->image_data == NULL ) {
 		(*frame)->image_length = bytes_per_frame;
 
@@ -3874,6 +4417,15 @@ mx_image_read_raw_file( MX_IMAGE_FRAME **frame,
 
 	/* Change the size of the MX_IMAGE_FRAME to match the SMV file. */
 
+	/* Any file mapping left over from a previous read of this frame
+	 * is released rather than copied, since it is about to be
+	 * overwritten.
+	 */
+
+	if ( (*frame) != (MX_IMAGE_FRAME *) NULL ) {
+		(void) mxp_image_unmap_data( *frame, FALSE );
+	}
+
 	mx_status = mx_image_alloc( frame,
 					framesize[0],
 					framesize[1],
@@ -3902,8 +4454,8 @@ mx_image_read_raw_file( MX_IMAGE_FRAME **frame,
 
 	/* Read in the binary image. */
 
-	bytes_read = (long) fread( (*frame)->image_data, sizeof(unsigned char),
-				bytes_per_frame, file );
+	bytes_read = (long) mxp_image_read_data( *frame,
+						bytes_per_frame, file );
 
 	if ( bytes_read < bytes_per_frame ) {
 		if ( feof(file) ) {
@@ -4044,7 +4596,8 @@ mx_image_write_raw_file( MX_IMAGE_FRAME *frame,
 	MX_HRT_START( fwrite_measurement );
 #endif
 
-	bytes_written = fwrite(frame->image_data, 1, frame->image_length, file);
+	bytes_written = mxp_image_write_data( frame->image_data,
+						frame->image_length, file );
 
 	if ( bytes_written < frame->image_length ) {
 		saved_errno = errno;
@@ -4798,6 +5351,15 @@ mx_image_read_smv_file( MX_IMAGE_FRAME **frame,
 
 	/* Change the size of the MX_IMAGE_FRAME to match the SMV file. */
 
+	/* Any file mapping left over from a previous read of this frame
+	 * is released rather than copied, since it is about to be
+	 * overwritten.
+	 */
+
+	if ( (*frame) != (MX_IMAGE_FRAME *) NULL ) {
+		(void) mxp_image_unmap_data( *frame, FALSE );
+	}
+
 	mx_status = mx_image_alloc( frame,
 					framesize[0],
 					framesize[1],
@@ -4843,8 +5405,8 @@ mx_image_read_smv_file( MX_IMAGE_FRAME **frame,
 
 	/* Read in the binary part of the image file. */
 
-	bytes_read = (long) fread( (*frame)->image_data, sizeof(unsigned char),
-				bytes_per_frame, file );
+	bytes_read = (long) mxp_image_read_data( *frame,
+						bytes_per_frame, file );
 
 	if ( bytes_read < bytes_per_frame ) {
 		if ( feof(file) ) {
@@ -5396,8 +5958,8 @@ mx_image_write_smv_file( MX_IMAGE_FRAME *frame,
 
 	/* Write out the image data. */
 
-	num_items_written = fwrite( frame->image_data,
-				1, frame->image_length, file );
+	num_items_written = mxp_image_write_data( frame->image_data,
+						frame->image_length, file );
 
 	if ( num_items_written < frame->image_length ) {
 		saved_errno = errno;
@@ -5584,6 +6146,15 @@ mx_image_read_marccd_file( MX_IMAGE_FRAME **frame, char *marccd_filename )
 	
 	/* Allocate an MX_IMAGE_FRAME with the right size for the image. */
 
+	/* Any file mapping left over from a previous read of this frame
+	 * is released rather than copied, since it is about to be
+	 * overwritten.
+	 */
+
+	if ( (*frame) != (MX_IMAGE_FRAME *) NULL ) {
+		(void) mxp_image_unmap_data( *frame, FALSE );
+	}
+
 	mx_status = mx_image_alloc( frame,
 				image_width,
 				image_height,
@@ -5621,9 +6192,13 @@ mx_image_read_marccd_file( MX_IMAGE_FRAME **frame, char *marccd_filename )
 
 	/* Now read in the image data. */
 
-	items_read = fread( (*frame)->image_data,
-				image_size_in_bytes, 1,
-				marccd_file );
+	if ( mxp_image_read_data( *frame, image_size_in_bytes,
+				marccd_file ) == image_size_in_bytes )
+	{
+		items_read = 1;
+	} else {
+		items_read = 0;
+	}
 
 	fclose(marccd_file);
 
@@ -5946,6 +6521,15 @@ mx_image_read_edf_file( MX_IMAGE_FRAME **frame, char *datafile_name )
 
 	/* Change the size of the MX_IMAGE_FRAME to match the EDF file. */
 
+	/* Any file mapping left over from a previous read of this frame
+	 * is released rather than copied, since it is about to be
+	 * overwritten.
+	 */
+
+	if ( (*frame) != (MX_IMAGE_FRAME *) NULL ) {
+		(void) mxp_image_unmap_data( *frame, FALSE );
+	}
+
 	mx_status = mx_image_alloc( frame,
 					framesize[0],
 					framesize[1],
@@ -5986,8 +6570,8 @@ mx_image_read_edf_file( MX_IMAGE_FRAME **frame, char *datafile_name )
 
 	/* Read in the binary part of the image file. */
 
-	bytes_read = (long) fread( (*frame)->image_data, sizeof(unsigned char),
-				bytes_per_frame, file );
+	bytes_read = (long) mxp_image_read_data( *frame,
+						bytes_per_frame, file );
 
 	if ( bytes_read < bytes_per_frame ) {
 		if ( feof(file) ) {
@@ -191,6 +191,23 @@ typedef struct {
 
 	void *application_ptr;
 
+	/* If mapped_data is not NULL, then image_data points into a
+	 * private, copy-on-write memory mapping of an image file rather
+	 * than into a malloc()-ed buffer.  The mapping starts at the
+	 * beginning of the file and is mapped_length bytes long.
+	 */
+
+	void *mapped_data;
+	size_t mapped_length;
+
+	/* If image_pool is not NULL, then the frame was leased from an
+	 * MX_IMAGE_POOL and mx_image_free() returns it to that pool once
+	 * reference_count drops to zero.  See mx_image_pool.h.
+	 */
+
+	void *image_pool;
+	unsigned long reference_count;
+
 } MX_IMAGE_FRAME;
 
 typedef struct {
@@ -319,6 +336,31 @@ MX_API void mx_image_free( MX_IMAGE_FRAME *frame );
 
 /*----*/
 
+/* Flags for mx_image_set_file_io_flags().  Both are off by default.
+ *
+ * If MXF_IMAGE_FILE_IO_MMAP_READ is set, then the SMV, raw, EDF and MarCCD
+ * readers map large image files into memory rather than reading them with
+ * fread().  The frame's pixel data then stays backed by the file until the
+ * frame is freed or resized, so the file must not be truncated or rewritten
+ * while the frame is in use.  In particular, a frame read this way must not
+ * be saved back to the file that it was read from.
+ *
+ * If MXF_IMAGE_FILE_IO_DIRECT_WRITE is set, then the SMV and raw writers
+ * write large images with O_DIRECT, bypassing the page cache, on platforms
+ * and filesystems that support it.
+ */
+
+#define MXF_IMAGE_FILE_IO_MMAP_READ	0x1
+#define MXF_IMAGE_FILE_IO_DIRECT_WRITE	0x2
+
+#define MXF_IMAGE_FILE_IO_DEFAULT	0
+
+MX_API void mx_image_set_file_io_flags( unsigned long flags );
+
+MX_API unsigned long mx_image_get_file_io_flags( void );
+
+/*----*/
+
 MX_API mx_status_type mx_image_alloc_sector_array( MX_IMAGE_FRAME *frame,
 					long num_sector_rows,
 					long num_sector_columns,
@@ -369,6 +411,66 @@ MX_API mx_status_type mx_image_rebin( MX_IMAGE_FRAME **rebinned_frame,
 
 /*----*/
 
+/* Pixel kernels in mx_image_simd.c used by mx_image_statistics() and
+ * mx_image_rebin().  They use SSE2 or AVX2 instructions where the CPU
+ * supports them.  The summary, sum of squares, and standard deviation
+ * histogram kernels support the GREY8, GREY16, INT32, FLOAT, and DOUBLE
+ * image formats, the value histogram kernel supports GREY8 and GREY16,
+ * and the rebin shrink kernel also supports GREY32.
+ */
+
+#define MXT_IMAGE_KERNEL_AUTO		0
+#define MXT_IMAGE_KERNEL_SCALAR		1
+#define MXT_IMAGE_KERNEL_SSE2		2
+#define MXT_IMAGE_KERNEL_AVX2		3
+
+MX_API long mx_image_get_kernel( void );
+
+MX_API mx_status_type mx_image_set_kernel( long kernel_type );
+
+MX_API mx_status_type mx_image_pixel_summary_kernel( long image_format,
+					const void *image_data,
+					unsigned long num_pixels,
+					double *min_pixel,
+					double *max_pixel,
+					double *sum );
+
+MX_API mx_status_type mx_image_sum_of_squares_kernel( long image_format,
+					const void *image_data,
+					unsigned long num_pixels,
+					double mean,
+					double *sum_of_squares );
+
+/* The standard deviation histogram has 2 * max_sd + 1 bins. */
+
+MX_API mx_status_type mx_image_sd_histogram_kernel( long image_format,
+					const void *image_data,
+					unsigned long num_pixels,
+					double mean,
+					double standard_deviation,
+					long max_sd,
+					unsigned long *sd_histogram );
+
+/* The value_counts array must have room for 256 entries for GREY8 images
+ * and 65536 entries for GREY16 images.
+ */
+
+MX_API mx_status_type mx_image_value_histogram_kernel( long image_format,
+					const void *image_data,
+					unsigned long num_pixels,
+					unsigned long *value_counts );
+
+MX_API mx_status_type mx_image_rebin_shrink_kernel( long image_format,
+					const void *original_data,
+					unsigned long original_width,
+					void *rebinned_data,
+					unsigned long rebinned_width,
+					unsigned long rebinned_height,
+					unsigned long width_shrink_factor,
+					unsigned long height_shrink_factor );
+
+/*----*/
+
 MX_API mx_status_type mx_image_dezinger( MX_IMAGE_FRAME **dezingered_frame,
 					unsigned long num_original_frames,
 					MX_IMAGE_FRAME **original_frame_array,
@@ -0,0 +1,517 @@
+/*
+ * Name:    mx_image_pool.c
+ *
+ * Purpose: MX image frame pools for reusing image frames without
+ *          calling malloc() and free() for each frame.
+ *
+ * Author:  William Lavender
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Copyright 2016 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#define MX_IMAGE_POOL_DEBUG	FALSE
+
+/* On Linux, we must define _GNU_SOURCE before including any C library header
+ * in order to get posix_memalign() and MADV_HUGEPAGE.
+ */
+
+#if defined(OS_LINUX)
+#  define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mx_osdef.h"
+#include "mx_util.h"
+#include "mx_record.h"
+#include "mx_image_pool.h"
+
+#if defined(OS_LINUX)
+#  include <sys/mman.h>
+#endif
+
+#if defined(OS_UNIX)
+#  define MXP_HAVE_POSIX_MEMALIGN	TRUE
+#else
+#  define MXP_HAVE_POSIX_MEMALIGN	FALSE
+#endif
+
+#if defined(OS_LINUX) && defined(MADV_HUGEPAGE)
+#  define MXP_HAVE_HUGEPAGES	TRUE
+#  define MXP_HUGEPAGE_SIZE	(2*1024*1024)
+#else
+#  define MXP_HAVE_HUGEPAGES	FALSE
+#endif
+
+/*-------------------------------------------------------------------------*/
+
+static void
+mxp_image_pool_free( MX_IMAGE_POOL *pool )
+{
+	if ( pool->mutex != (MX_MUTEX *) NULL ) {
+		(void) mx_mutex_destroy( pool->mutex );
+	}
+
+	mx_free( pool->free_frame_array );
+
+	free( pool );
+}
+
+/*-------------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_image_pool_create( MX_IMAGE_POOL **pool,
+			unsigned long max_free_frames,
+			size_t alignment,
+			unsigned long flags )
+{
+	static const char fname[] = "mx_image_pool_create()";
+
+	MX_IMAGE_POOL *new_pool;
+	mx_status_type mx_status;
+
+	if ( pool == (MX_IMAGE_POOL **) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_IMAGE_POOL pointer passed was NULL." );
+	}
+
+	*pool = NULL;
+
+	if ( max_free_frames == 0 ) {
+		max_free_frames = MX_IMAGE_POOL_DEFAULT_MAX_FREE_FRAMES;
+	}
+
+	if ( alignment == 0 ) {
+		alignment = MX_IMAGE_POOL_DEFAULT_ALIGNMENT;
+	}
+
+	/* posix_memalign() requires the alignment to be a power of two
+	 * and a multiple of sizeof(void *).
+	 */
+
+	if ( ( (alignment & (alignment - 1)) != 0 )
+	  || ( (alignment % sizeof(void *)) != 0 ) )
+	{
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"The requested image pool alignment of %lu bytes is not "
+		"a power of two that is a multiple of %lu bytes.",
+			(unsigned long) alignment,
+			(unsigned long) sizeof(void *) );
+	}
+
+	new_pool = (MX_IMAGE_POOL *) calloc( 1, sizeof(MX_IMAGE_POOL) );
+
+	if ( new_pool == (MX_IMAGE_POOL *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate an MX_IMAGE_POOL." );
+	}
+
+	new_pool->flags = flags;
+	new_pool->alignment = alignment;
+	new_pool->max_free_frames = max_free_frames;
+
+	new_pool->free_frame_array = (MX_IMAGE_FRAME **)
+			calloc( max_free_frames, sizeof(MX_IMAGE_FRAME *) );
+
+	if ( new_pool->free_frame_array == (MX_IMAGE_FRAME **) NULL ) {
+		mxp_image_pool_free( new_pool );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a %lu element "
+		"free frame array for an image pool.", max_free_frames );
+	}
+
+	mx_status = mx_mutex_create( &(new_pool->mutex) );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mxp_image_pool_free( new_pool );
+		return mx_status;
+	}
+
+#if MX_IMAGE_POOL_DEBUG
+	MX_DEBUG(-2,("%s: created image pool %p, max_free_frames = %lu, "
+		"alignment = %lu, flags = %#lx", fname, new_pool,
+		max_free_frames, (unsigned long) alignment, flags));
+#endif
+
+	*pool = new_pool;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_image_pool_destroy( MX_IMAGE_POOL *pool )
+{
+	unsigned long i;
+	mx_bool_type destroy_pool;
+
+	if ( pool == (MX_IMAGE_POOL *) NULL ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	mx_mutex_lock( pool->mutex );
+
+	pool->shutdown = TRUE;
+
+	/* Detach the free frames from the pool so that mx_image_free()
+	 * really frees them.
+	 */
+
+	for ( i = 0; i < pool->num_free_frames; i++ ) {
+		pool->free_frame_array[i]->image_pool = NULL;
+
+		mx_image_free( pool->free_frame_array[i] );
+
+		pool->free_frame_array[i] = NULL;
+	}
+
+	pool->num_free_frames = 0;
+
+	/* If frames are still leased out, the last one to be released
+	 * frees the pool.
+	 */
+
+	destroy_pool = ( pool->num_leased_frames == 0 );
+
+	mx_mutex_unlock( pool->mutex );
+
+	if ( destroy_pool ) {
+		mxp_image_pool_free( pool );
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_image_pool_lease( MX_IMAGE_POOL *pool,
+			MX_IMAGE_FRAME **frame,
+			long row_framesize,
+			long column_framesize,
+			long image_format,
+			long byte_order,
+			double bytes_per_pixel,
+			size_t header_length,
+			MX_DICTIONARY *dictionary,
+			MX_RECORD *record )
+{
+	static const char fname[] = "mx_image_pool_lease()";
+
+	MX_IMAGE_FRAME *new_frame, *free_frame;
+	size_t image_length;
+	unsigned long i, best;
+	mx_status_type mx_status;
+
+	if ( pool == (MX_IMAGE_POOL *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_IMAGE_POOL pointer passed was NULL." );
+	}
+	if ( frame == (MX_IMAGE_FRAME **) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_IMAGE_FRAME pointer passed was NULL." );
+	}
+
+	image_length = mx_round( bytes_per_pixel
+		* ((double) row_framesize) * ((double) column_framesize) );
+
+	if ( image_length == 0 ) {
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"Attempted to lease a zero length image frame from "
+		"image pool %p.", pool );
+	}
+
+	mx_mutex_lock( pool->mutex );
+
+	if ( pool->shutdown ) {
+		mx_mutex_unlock( pool->mutex );
+
+		return mx_error( MXE_NOT_VALID_FOR_CURRENT_STATE, fname,
+		"Image pool %p is being destroyed.", pool );
+	}
+
+	/* Prefer a free frame that was last used for an image with the
+	 * same format and dimensions.  Otherwise, take the first free
+	 * frame whose image buffer is big enough.
+	 */
+
+	best = pool->num_free_frames;
+
+	for ( i = 0; i < pool->num_free_frames; i++ ) {
+		free_frame = pool->free_frame_array[i];
+
+		if ( free_frame->allocated_image_length < image_length ) {
+			continue;
+		}
+
+		if ( ( free_frame->image_length == image_length )
+		  && ( (long) MXIF_IMAGE_FORMAT(free_frame) == image_format )
+		  && ( (long) MXIF_ROW_FRAMESIZE(free_frame) == row_framesize )
+		  && ( (long) MXIF_COLUMN_FRAMESIZE(free_frame)
+							== column_framesize ) )
+		{
+			best = i;
+			break;
+		}
+
+		if ( best == pool->num_free_frames ) {
+			best = i;
+		}
+	}
+
+	if ( best < pool->num_free_frames ) {
+		new_frame = pool->free_frame_array[best];
+
+		pool->num_free_frames--;
+
+		pool->free_frame_array[best] =
+			pool->free_frame_array[ pool->num_free_frames ];
+
+		pool->free_frame_array[ pool->num_free_frames ] = NULL;
+
+		pool->num_reuses++;
+	} else {
+		new_frame = NULL;
+	}
+
+	pool->num_leases++;
+	pool->num_leased_frames++;
+
+	mx_mutex_unlock( pool->mutex );
+
+	if ( new_frame == (MX_IMAGE_FRAME *) NULL ) {
+		new_frame = (MX_IMAGE_FRAME *)
+				calloc( 1, sizeof(MX_IMAGE_FRAME) );
+
+		if ( new_frame != (MX_IMAGE_FRAME *) NULL ) {
+			new_frame->image_data =
+			    mx_image_pool_alloc_buffer( pool, image_length );
+
+			if ( new_frame->image_data == NULL ) {
+				mx_free( new_frame );
+			}
+		}
+
+		if ( new_frame == (MX_IMAGE_FRAME *) NULL ) {
+			mx_mutex_lock( pool->mutex );
+			pool->num_leased_frames--;
+			mx_mutex_unlock( pool->mutex );
+
+			return mx_error( MXE_OUT_OF_MEMORY, fname,
+			"Ran out of memory trying to allocate a %lu byte "
+			"image frame for image pool %p.",
+				(unsigned long) image_length, pool );
+		}
+
+		new_frame->allocated_image_length = image_length;
+	} else {
+		/* Make the reused frame look like a newly allocated one. */
+
+		if ( new_frame->header_data != NULL ) {
+			memset( new_frame->header_data, 0,
+				new_frame->allocated_header_length );
+		}
+
+		new_frame->application_ptr = NULL;
+	}
+
+	new_frame->image_pool = pool;
+	new_frame->reference_count = 1;
+
+	/* Since the frame's buffers are already big enough, mx_image_alloc()
+	 * just fills in the header here.
+	 */
+
+	mx_status = mx_image_alloc( &new_frame, row_framesize,
+					column_framesize, image_format,
+					byte_order, bytes_per_pixel,
+					header_length, image_length,
+					dictionary, record );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mx_image_free( new_frame );
+		return mx_status;
+	}
+
+#if MX_IMAGE_POOL_DEBUG
+	MX_DEBUG(-2,("%s: pool %p leased frame %p (%ld x %ld, format %ld), "
+		"leases = %lu, reuses = %lu, buffer allocations = %lu",
+		fname, pool, new_frame, row_framesize, column_framesize,
+		image_format, pool->num_leases, pool->num_reuses,
+		pool->num_buffer_allocations));
+#endif
+
+	*frame = new_frame;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_image_pool_reference( MX_IMAGE_FRAME *frame )
+{
+	static const char fname[] = "mx_image_pool_reference()";
+
+	MX_IMAGE_POOL *pool;
+
+	if ( frame == (MX_IMAGE_FRAME *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_IMAGE_FRAME pointer passed was NULL." );
+	}
+
+	pool = (MX_IMAGE_POOL *) frame->image_pool;
+
+	if ( pool == (MX_IMAGE_POOL *) NULL ) {
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"Image frame %p was not leased from an image pool.", frame );
+	}
+
+	mx_mutex_lock( pool->mutex );
+
+	frame->reference_count++;
+
+	mx_mutex_unlock( pool->mutex );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+MX_EXPORT mx_bool_type
+mx_image_pool_release( MX_IMAGE_FRAME *frame )
+{
+	MX_IMAGE_POOL *pool;
+	mx_bool_type keep_frame, destroy_pool;
+
+	if ( frame == (MX_IMAGE_FRAME *) NULL ) {
+		return FALSE;
+	}
+
+	pool = (MX_IMAGE_POOL *) frame->image_pool;
+
+	if ( pool == (MX_IMAGE_POOL *) NULL ) {
+		return FALSE;
+	}
+
+	mx_mutex_lock( pool->mutex );
+
+	if ( frame->reference_count > 1 ) {
+		frame->reference_count--;
+
+		mx_mutex_unlock( pool->mutex );
+
+		return TRUE;
+	}
+
+	frame->reference_count = 0;
+
+	pool->num_leased_frames--;
+
+	/* Frames whose image data has been replaced by a file mapping
+	 * or by an unaligned buffer are not kept.
+	 */
+
+	if ( ( pool->shutdown )
+	  || ( pool->num_free_frames >= pool->max_free_frames )
+	  || ( frame->mapped_data != NULL )
+	  || ( frame->image_data == NULL ) )
+	{
+		keep_frame = FALSE;
+	} else {
+#if MXP_HAVE_POSIX_MEMALIGN
+		keep_frame =
+		  ( ( ((size_t) frame->image_data) % pool->alignment ) == 0 );
+#else
+		keep_frame = TRUE;
+#endif
+	}
+
+	if ( keep_frame == FALSE ) {
+
+		frame->image_pool = NULL;
+	} else {
+		pool->free_frame_array[ pool->num_free_frames ] = frame;
+
+		pool->num_free_frames++;
+	}
+
+	destroy_pool = ( pool->shutdown && (pool->num_leased_frames == 0) );
+
+	mx_mutex_unlock( pool->mutex );
+
+	if ( destroy_pool ) {
+		mxp_image_pool_free( pool );
+	}
+
+	return keep_frame;
+}
+
+/*-------------------------------------------------------------------------*/
+
+MX_EXPORT void *
+mx_image_pool_alloc_buffer( MX_IMAGE_POOL *pool, size_t buffer_length )
+{
+	void *buffer;
+	size_t alignment;
+
+	if ( pool == (MX_IMAGE_POOL *) NULL ) {
+		return malloc( buffer_length );
+	}
+
+	alignment = pool->alignment;
+
+#if MXP_HAVE_HUGEPAGES
+	if ( ( pool->flags & MXF_IMAGE_POOL_HUGEPAGES )
+	  && ( buffer_length >= MXP_HUGEPAGE_SIZE )
+	  && ( alignment < MXP_HUGEPAGE_SIZE ) )
+	{
+		alignment = MXP_HUGEPAGE_SIZE;
+	}
+#endif
+
+#if MXP_HAVE_POSIX_MEMALIGN
+	if ( posix_memalign( &buffer, alignment, buffer_length ) != 0 ) {
+		return NULL;
+	}
+#else
+	buffer = malloc( buffer_length );
+
+	if ( buffer == NULL ) {
+		return NULL;
+	}
+#endif
+
+#if MXP_HAVE_HUGEPAGES
+	/* Only advise whole huge pages, so that we do not change the
+	 * behavior of memory outside of this buffer.
+	 */
+
+	if ( ( pool->flags & MXF_IMAGE_POOL_HUGEPAGES )
+	  && ( buffer_length >= MXP_HUGEPAGE_SIZE ) )
+	{
+		(void) madvise( buffer,
+			buffer_length - (buffer_length % MXP_HUGEPAGE_SIZE),
+			MADV_HUGEPAGE );
+	}
+#endif
+
+	mx_mutex_lock( pool->mutex );
+
+	pool->num_buffer_allocations++;
+
+	mx_mutex_unlock( pool->mutex );
+
+	return buffer;
+}
+
@@ -0,0 +1,136 @@
+/*
+ * Name:    mx_image_pool.h
+ *
+ * Purpose: Header file for MX image frame pools.
+ *
+ *          An MX image pool keeps a set of previously used image frames
+ *          so that code which repeatedly needs temporary frames of the
+ *          same size can reuse them rather than calling malloc() and
+ *          free() for every frame.  This avoids heap fragmentation and
+ *          the page faults caused by touching freshly allocated memory
+ *          during long acquisitions.
+ *
+ *          Frames are leased from the pool with mx_image_pool_lease().
+ *          Leased frames are reference counted.  mx_image_free() drops
+ *          one reference and, when the last reference is dropped, puts
+ *          the frame back into the pool instead of freeing it.  Callers
+ *          that already use mx_image_free() therefore do not need to
+ *          know whether a frame came from a pool.
+ *
+ *          The image buffers of pooled frames are aligned to at least
+ *          'alignment' bytes, so that they may be used directly by the
+ *          vectorized pixel kernels.  On Linux, large buffers may also
+ *          be requested to use transparent huge pages.
+ *
+ * Author:  William Lavender
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Copyright 2016 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#ifndef __MX_IMAGE_POOL_H__
+#define __MX_IMAGE_POOL_H__
+
+#include "mx_mutex.h"
+#include "mx_image.h"
+
+/* Make the header file C++ safe. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MX_IMAGE_POOL_DEFAULT_ALIGNMENT		64
+#define MX_IMAGE_POOL_DEFAULT_MAX_FREE_FRAMES	8
+
+/* Flags for mx_image_pool_create(). */
+
+#define MXF_IMAGE_POOL_HUGEPAGES	0x1
+
+typedef struct {
+	MX_MUTEX *mutex;
+
+	unsigned long flags;
+	size_t alignment;
+
+	/* Frames that are ready to be leased. */
+
+	unsigned long max_free_frames;
+	unsigned long num_free_frames;
+	MX_IMAGE_FRAME **free_frame_array;
+
+	/* Frames that are currently leased out. */
+
+	unsigned long num_leased_frames;
+
+	/* Statistics.  'num_buffer_allocations' counts the image buffers
+	 * that have had to be allocated, while 'num_reuses' counts the
+	 * leases that were satisfied by a frame that was already in
+	 * the pool.
+	 */
+
+	unsigned long num_leases;
+	unsigned long num_reuses;
+	unsigned long num_buffer_allocations;
+
+	/* If mx_image_pool_destroy() is called while frames are still
+	 * leased out, the pool is freed when the last of them is returned.
+	 */
+
+	mx_bool_type shutdown;
+} MX_IMAGE_POOL;
+
+MX_API mx_status_type mx_image_pool_create( MX_IMAGE_POOL **pool,
+					unsigned long max_free_frames,
+					size_t alignment,
+					unsigned long flags );
+
+MX_API mx_status_type mx_image_pool_destroy( MX_IMAGE_POOL *pool );
+
+/* mx_image_pool_lease() returns a frame with a reference count of 1 that
+ * has been set up by mx_image_alloc() with the requested parameters.
+ * The contents of the image buffer are undefined.
+ */
+
+MX_API mx_status_type mx_image_pool_lease( MX_IMAGE_POOL *pool,
+					MX_IMAGE_FRAME **frame,
+					long row_framesize,
+					long column_framesize,
+					long image_format,
+					long byte_order,
+					double bytes_per_pixel,
+					size_t header_length,
+					MX_DICTIONARY *dictionary,
+					MX_RECORD *record );
+
+/* mx_image_pool_reference() adds a reference to a leased frame.  Each
+ * reference must be dropped with a call to mx_image_free().
+ */
+
+MX_API mx_status_type mx_image_pool_reference( MX_IMAGE_FRAME *frame );
+
+/* mx_image_pool_release() is called by mx_image_free() for frames that
+ * were leased from a pool.  It returns TRUE if the frame was kept by
+ * the pool, or FALSE if the caller must free the frame itself.
+ */
+
+MX_API mx_bool_type mx_image_pool_release( MX_IMAGE_FRAME *frame );
+
+/* mx_image_pool_alloc_buffer() allocates an image buffer with the
+ * alignment and flags of the pool.  The buffer may be freed with free().
+ */
+
+MX_API void *mx_image_pool_alloc_buffer( MX_IMAGE_POOL *pool,
+					size_t buffer_length );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MX_IMAGE_POOL_H__ */
+
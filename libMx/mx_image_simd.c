@@ -0,0 +1,2252 @@
+/*
+ * Name:    mx_image_simd.c
+ *
+ * Purpose: Vectorized pixel kernels used by mx_image_statistics() and
+ *          mx_image_rebin().
+ *
+ *          Each kernel loops over the pixels of a single image format,
+ *          so there is no switch on the image format inside the loops.
+ *          Sums of integer pixels are accumulated exactly in 32-bit or
+ *          64-bit integers, so integer means and rebinned integer images
+ *          are the same as those computed by the original double precision
+ *          loops.  Sums of floating point pixels are accumulated in several
+ *          double precision partial sums, so they may differ from a strictly
+ *          sequential sum in the last few bits.
+ *
+ *          On x86 and x86_64 systems compiled with GCC or Clang, SSE2 and
+ *          AVX2 versions of the kernels are selected at run time based on
+ *          what the CPU supports.  On all other platforms, only the scalar
+ *          versions are available.
+ *
+ * Author:  William Lavender
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Copyright 2016 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#define MX_IMAGE_SIMD_DEBUG	FALSE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "mx_util.h"
+#include "mx_record.h"
+#include "mx_stdint.h"
+#include "mx_image.h"
+
+#if ( defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) ) \
+	&& ( defined(__clang__) || ( __GNUC__ > 4 ) \
+		|| ( ( __GNUC__ == 4 ) && ( __GNUC_MINOR__ >= 9 ) ) ) )
+#  define MXP_HAVE_X86_SIMD	TRUE
+#else
+#  define MXP_HAVE_X86_SIMD	FALSE
+#endif
+
+#if MXP_HAVE_X86_SIMD
+#  include <immintrin.h>
+
+#  define MXP_SSE2	__attribute__((target("sse2")))
+#  define MXP_AVX2	__attribute__((target("avx2")))
+
+#  define MXP_SSE2_INLINE \
+		static inline __attribute__((target("sse2"), always_inline))
+#  define MXP_AVX2_INLINE \
+		static inline __attribute__((target("avx2"), always_inline))
+#endif
+
+/* Integer column sums for 8-bit and 16-bit pixels are kept in 32-bit
+ * integers, so at most this many rows may be added to them at a time.
+ */
+
+#define MXP_MAX_U32_COLUMN_SUM_ROWS	65536UL
+
+static long mxp_image_kernel = -1;
+
+/*=======================================================================*/
+
+/* The scalar kernels.  These are the reference implementations and are
+ * also used for the leftover pixels at the end of the vectorized loops.
+ * The summary kernels update the minimum, maximum, and sum passed to them,
+ * which must be initialized by the caller.  NaN pixels never change the
+ * minimum or the maximum, just as in the original loops.
+ */
+
+static void
+mxp_scalar_u8_summary( const uint8_t *image_data, unsigned long num_pixels,
+			uint8_t *min_pixel, uint8_t *max_pixel, uint64_t *sum )
+{
+	unsigned long i;
+	uint8_t pixel;
+
+	for ( i = 0; i < num_pixels; i++ ) {
+		pixel = image_data[i];
+
+		if ( pixel < *min_pixel )
+			*min_pixel = pixel;
+
+		if ( pixel > *max_pixel )
+			*max_pixel = pixel;
+
+		*sum += pixel;
+	}
+}
+
+static void
+mxp_scalar_u16_summary( const uint16_t *image_data, unsigned long num_pixels,
+			uint16_t *min_pixel, uint16_t *max_pixel, uint64_t *sum )
+{
+	unsigned long i;
+	uint16_t pixel;
+
+	for ( i = 0; i < num_pixels; i++ ) {
+		pixel = image_data[i];
+
+		if ( pixel < *min_pixel )
+			*min_pixel = pixel;
+
+		if ( pixel > *max_pixel )
+			*max_pixel = pixel;
+
+		*sum += pixel;
+	}
+}
+
+static void
+mxp_scalar_i32_summary( const int32_t *image_data, unsigned long num_pixels,
+			int32_t *min_pixel, int32_t *max_pixel, int64_t *sum )
+{
+	unsigned long i;
+	int32_t pixel;
+
+	for ( i = 0; i < num_pixels; i++ ) {
+		pixel = image_data[i];
+
+		if ( pixel < *min_pixel )
+			*min_pixel = pixel;
+
+		if ( pixel > *max_pixel )
+			*max_pixel = pixel;
+
+		*sum += pixel;
+	}
+}
+
+static void
+mxp_scalar_flt_summary( const float *image_data, unsigned long num_pixels,
+			double *min_pixel, double *max_pixel, double *sum )
+{
+	unsigned long i;
+	double pixel;
+
+	for ( i = 0; i < num_pixels; i++ ) {
+		pixel = image_data[i];
+
+		if ( pixel < *min_pixel )
+			*min_pixel = pixel;
+
+		if ( pixel > *max_pixel )
+			*max_pixel = pixel;
+
+		*sum += pixel;
+	}
+}
+
+static void
+mxp_scalar_dbl_summary( const double *image_data, unsigned long num_pixels,
+			double *min_pixel, double *max_pixel, double *sum )
+{
+	unsigned long i;
+	double pixel;
+
+	for ( i = 0; i < num_pixels; i++ ) {
+		pixel = image_data[i];
+
+		if ( pixel < *min_pixel )
+			*min_pixel = pixel;
+
+		if ( pixel > *max_pixel )
+			*max_pixel = pixel;
+
+		*sum += pixel;
+	}
+}
+
+/*-----------------------------------------------------------------------*/
+
+static double
+mxp_scalar_u8_sum_of_squares( const uint8_t *image_data,
+			unsigned long num_pixels, double mean )
+{
+	unsigned long i;
+	double diff, sum_of_squares;
+
+	sum_of_squares = 0.0;
+
+	for ( i = 0; i < num_pixels; i++ ) {
+		diff = image_data[i] - mean;
+
+		sum_of_squares += (diff * diff);
+	}
+
+	return sum_of_squares;
+}
+
+static double
+mxp_scalar_u16_sum_of_squares( const uint16_t *image_data,
+			unsigned long num_pixels, double mean )
+{
+	unsigned long i;
+	double diff, sum_of_squares;
+
+	sum_of_squares = 0.0;
+
+	for ( i = 0; i < num_pixels; i++ ) {
+		diff = image_data[i] - mean;
+
+		sum_of_squares += (diff * diff);
+	}
+
+	return sum_of_squares;
+}
+
+static double
+mxp_scalar_i32_sum_of_squares( const int32_t *image_data,
+			unsigned long num_pixels, double mean )
+{
+	unsigned long i;
+	double diff, sum_of_squares;
+
+	sum_of_squares = 0.0;
+
+	for ( i = 0; i < num_pixels; i++ ) {
+		diff = image_data[i] - mean;
+
+		sum_of_squares += (diff * diff);
+	}
+
+	return sum_of_squares;
+}
+
+static double
+mxp_scalar_flt_sum_of_squares( const float *image_data,
+			unsigned long num_pixels, double mean )
+{
+	unsigned long i;
+	double diff, sum_of_squares;
+
+	sum_of_squares = 0.0;
+
+	for ( i = 0; i < num_pixels; i++ ) {
+		diff = image_data[i] - mean;
+
+		sum_of_squares += (diff * diff);
+	}
+
+	return sum_of_squares;
+}
+
+static double
+mxp_scalar_dbl_sum_of_squares( const double *image_data,
+			unsigned long num_pixels, double mean )
+{
+	unsigned long i;
+	double diff, sum_of_squares;
+
+	sum_of_squares = 0.0;
+
+	for ( i = 0; i < num_pixels; i++ ) {
+		diff = image_data[i] - mean;
+
+		sum_of_squares += (diff * diff);
+	}
+
+	return sum_of_squares;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/* The column sum kernels add 'num_rows' rows of 'num_columns' pixels
+ * to the 'column_sums' array.  Consecutive rows are 'row_stride' pixels
+ * apart in the image.
+ */
+
+static void
+mxp_scalar_u8_column_sums( const uint8_t *image_data,
+			unsigned long row_stride,
+			unsigned long num_rows,
+			unsigned long num_columns,
+			uint32_t *column_sums )
+{
+	unsigned long row, i;
+	const uint8_t *row_data;
+
+	for ( row = 0; row < num_rows; row++ ) {
+		row_data = image_data + row * row_stride;
+
+		for ( i = 0; i < num_columns; i++ ) {
+			column_sums[i] += row_data[i];
+		}
+	}
+}
+
+static void
+mxp_scalar_u16_column_sums( const uint16_t *image_data,
+			unsigned long row_stride,
+			unsigned long num_rows,
+			unsigned long num_columns,
+			uint32_t *column_sums )
+{
+	unsigned long row, i;
+	const uint16_t *row_data;
+
+	for ( row = 0; row < num_rows; row++ ) {
+		row_data = image_data + row * row_stride;
+
+		for ( i = 0; i < num_columns; i++ ) {
+			column_sums[i] += row_data[i];
+		}
+	}
+}
+
+static void
+mxp_scalar_u32_column_sums( const uint32_t *image_data,
+			unsigned long row_stride,
+			unsigned long num_rows,
+			unsigned long num_columns,
+			uint64_t *column_sums )
+{
+	unsigned long row, i;
+	const uint32_t *row_data;
+
+	for ( row = 0; row < num_rows; row++ ) {
+		row_data = image_data + row * row_stride;
+
+		for ( i = 0; i < num_columns; i++ ) {
+			column_sums[i] += row_data[i];
+		}
+	}
+}
+
+static void
+mxp_scalar_i32_column_sums( const int32_t *image_data,
+			unsigned long row_stride,
+			unsigned long num_rows,
+			unsigned long num_columns,
+			int64_t *column_sums )
+{
+	unsigned long row, i;
+	const int32_t *row_data;
+
+	for ( row = 0; row < num_rows; row++ ) {
+		row_data = image_data + row * row_stride;
+
+		for ( i = 0; i < num_columns; i++ ) {
+			column_sums[i] += row_data[i];
+		}
+	}
+}
+
+static void
+mxp_scalar_flt_column_sums( const float *image_data,
+			unsigned long row_stride,
+			unsigned long num_rows,
+			unsigned long num_columns,
+			double *column_sums )
+{
+	unsigned long row, i;
+	const float *row_data;
+
+	for ( row = 0; row < num_rows; row++ ) {
+		row_data = image_data + row * row_stride;
+
+		for ( i = 0; i < num_columns; i++ ) {
+			column_sums[i] += row_data[i];
+		}
+	}
+}
+
+static void
+mxp_scalar_dbl_column_sums( const double *image_data,
+			unsigned long row_stride,
+			unsigned long num_rows,
+			unsigned long num_columns,
+			double *column_sums )
+{
+	unsigned long row, i;
+	const double *row_data;
+
+	for ( row = 0; row < num_rows; row++ ) {
+		row_data = image_data + row * row_stride;
+
+		for ( i = 0; i < num_columns; i++ ) {
+			column_sums[i] += row_data[i];
+		}
+	}
+}
+
+/*=======================================================================*/
+
+#if MXP_HAVE_X86_SIMD
+
+/* SSE2 has no 32-bit signed min or max, so they are made out of
+ * compares and masks.
+ */
+
+MXP_SSE2_INLINE __m128i
+mxp_sse2_min_epi32( __m128i a, __m128i b )
+{
+	__m128i mask;
+
+	mask = _mm_cmpgt_epi32( a, b );
+
+	return _mm_or_si128( _mm_and_si128( mask, b ),
+				_mm_andnot_si128( mask, a ) );
+}
+
+MXP_SSE2_INLINE __m128i
+mxp_sse2_max_epi32( __m128i a, __m128i b )
+{
+	__m128i mask;
+
+	mask = _mm_cmpgt_epi32( b, a );
+
+	return _mm_or_si128( _mm_and_si128( mask, b ),
+				_mm_andnot_si128( mask, a ) );
+}
+
+/* Adds eight 16-bit values to eight 32-bit sums. */
+
+MXP_SSE2_INLINE void
+mxp_sse2_add_u16_to_u32( uint32_t *dest, __m128i v )
+{
+	__m128i zero, sum;
+
+	zero = _mm_setzero_si128();
+
+	sum = _mm_loadu_si128( (const __m128i *) dest );
+	sum = _mm_add_epi32( sum, _mm_unpacklo_epi16( v, zero ) );
+	_mm_storeu_si128( (__m128i *) dest, sum );
+
+	sum = _mm_loadu_si128( (const __m128i *) (dest + 4) );
+	sum = _mm_add_epi32( sum, _mm_unpackhi_epi16( v, zero ) );
+	_mm_storeu_si128( (__m128i *) (dest + 4), sum );
+}
+
+/* Adds four 32-bit values to four 64-bit sums.  'high_bits' holds the
+ * upper 32 bits of each value, that is, either zeros or the sign bits.
+ */
+
+MXP_SSE2_INLINE void
+mxp_sse2_add_32_to_64( void *dest, __m128i v, __m128i high_bits )
+{
+	__m128i sum;
+	__m128i *dest_ptr = dest;
+
+	sum = _mm_loadu_si128( dest_ptr );
+	sum = _mm_add_epi64( sum, _mm_unpacklo_epi32( v, high_bits ) );
+	_mm_storeu_si128( dest_ptr, sum );
+
+	sum = _mm_loadu_si128( dest_ptr + 1 );
+	sum = _mm_add_epi64( sum, _mm_unpackhi_epi32( v, high_bits ) );
+	_mm_storeu_si128( dest_ptr + 1, sum );
+}
+
+/*-----------------------------------------------------------------------*/
+
+/* The SSE2 summary kernels.  Minimum and maximum values of floating
+ * point pixels are found with the minps and maxps instructions, which
+ * return their second operand if either operand is a NaN.  Putting the
+ * new pixels in the first operand thus makes NaN pixels be ignored.
+ */
+
+static MXP_SSE2 void
+mxp_sse2_i32_summary( const int32_t *image_data, unsigned long num_pixels,
+			int32_t *min_pixel, int32_t *max_pixel, int64_t *sum )
+{
+	__m128i v, sign, vmin, vmax, sum0, sum1, zero;
+	int32_t min_array[4], max_array[4];
+	int64_t sum_array[2];
+	unsigned long i;
+	int j;
+
+	zero = _mm_setzero_si128();
+
+	vmin = _mm_set1_epi32( *min_pixel );
+	vmax = _mm_set1_epi32( *max_pixel );
+
+	sum0 = _mm_setzero_si128();
+	sum1 = _mm_setzero_si128();
+
+	for ( i = 0; (i + 4) <= num_pixels; i += 4 ) {
+		v = _mm_loadu_si128( (const __m128i *) (image_data + i) );
+
+		vmin = mxp_sse2_min_epi32( vmin, v );
+		vmax = mxp_sse2_max_epi32( vmax, v );
+
+		sign = _mm_cmpgt_epi32( zero, v );
+
+		sum0 = _mm_add_epi64( sum0, _mm_unpacklo_epi32( v, sign ) );
+		sum1 = _mm_add_epi64( sum1, _mm_unpackhi_epi32( v, sign ) );
+	}
+
+	_mm_storeu_si128( (__m128i *) min_array, vmin );
+	_mm_storeu_si128( (__m128i *) max_array, vmax );
+	_mm_storeu_si128( (__m128i *) sum_array, _mm_add_epi64( sum0, sum1 ) );
+
+	for ( j = 0; j < 4; j++ ) {
+		if ( min_array[j] < *min_pixel )
+			*min_pixel = min_array[j];
+
+		if ( max_array[j] > *max_pixel )
+			*max_pixel = max_array[j];
+	}
+
+	*sum += ( sum_array[0] + sum_array[1] );
+
+	mxp_scalar_i32_summary( image_data + i, num_pixels - i,
+					min_pixel, max_pixel, sum );
+}
+
+static MXP_SSE2 void
+mxp_sse2_flt_summary( const float *image_data, unsigned long num_pixels,
+			double *min_pixel, double *max_pixel, double *sum )
+{
+	__m128 f, fmin, fmax;
+	__m128d sum_lo, sum_hi;
+	float min_array[4], max_array[4];
+	double sum_array[2];
+	unsigned long i;
+	int j;
+
+	fmin = _mm_set1_ps( (float) HUGE_VAL );
+	fmax = _mm_set1_ps( (float) -HUGE_VAL );
+
+	sum_lo = _mm_setzero_pd();
+	sum_hi = _mm_setzero_pd();
+
+	for ( i = 0; (i + 4) <= num_pixels; i += 4 ) {
+		f = _mm_loadu_ps( image_data + i );
+
+		fmin = _mm_min_ps( f, fmin );
+		fmax = _mm_max_ps( f, fmax );
+
+		sum_lo = _mm_add_pd( sum_lo, _mm_cvtps_pd( f ) );
+		sum_hi = _mm_add_pd( sum_hi,
+				_mm_cvtps_pd( _mm_movehl_ps( f, f ) ) );
+	}
+
+	_mm_storeu_ps( min_array, fmin );
+	_mm_storeu_ps( max_array, fmax );
+	_mm_storeu_pd( sum_array, _mm_add_pd( sum_lo, sum_hi ) );
+
+	for ( j = 0; j < 4; j++ ) {
+		if ( min_array[j] < *min_pixel )
+			*min_pixel = min_array[j];
+
+		if ( max_array[j] > *max_pixel )
+			*max_pixel = max_array[j];
+	}
+
+	*sum += ( sum_array[0] + sum_array[1] );
+
+	mxp_scalar_flt_summary( image_data + i, num_pixels - i,
+					min_pixel, max_pixel, sum );
+}
+
+static MXP_SSE2 void
+mxp_sse2_dbl_summary( const double *image_data, unsigned long num_pixels,
+			double *min_pixel, double *max_pixel, double *sum )
+{
+	__m128d v0, v1, vmin, vmax, sum0, sum1;
+	double min_array[2], max_array[2], sum_array[2];
+	unsigned long i;
+	int j;
+
+	vmin = _mm_set1_pd( HUGE_VAL );
+	vmax = _mm_set1_pd( -HUGE_VAL );
+
+	sum0 = _mm_setzero_pd();
+	sum1 = _mm_setzero_pd();
+
+	for ( i = 0; (i + 4) <= num_pixels; i += 4 ) {
+		v0 = _mm_loadu_pd( image_data + i );
+		v1 = _mm_loadu_pd( image_data + i + 2 );
+
+		vmin = _mm_min_pd( v0, vmin );
+		vmin = _mm_min_pd( v1, vmin );
+		vmax = _mm_max_pd( v0, vmax );
+		vmax = _mm_max_pd( v1, vmax );
+
+		sum0 = _mm_add_pd( sum0, v0 );
+		sum1 = _mm_add_pd( sum1, v1 );
+	}
+
+	_mm_storeu_pd( min_array, vmin );
+	_mm_storeu_pd( max_array, vmax );
+	_mm_storeu_pd( sum_array, _mm_add_pd( sum0, sum1 ) );
+
+	for ( j = 0; j < 2; j++ ) {
+		if ( min_array[j] < *min_pixel )
+			*min_pixel = min_array[j];
+
+		if ( max_array[j] > *max_pixel )
+			*max_pixel = max_array[j];
+	}
+
+	*sum += ( sum_array[0] + sum_array[1] );
+
+	mxp_scalar_dbl_summary( image_data + i, num_pixels - i,
+					min_pixel, max_pixel, sum );
+}
+
+/*-----------------------------------------------------------------------*/
+
+MXP_SSE2_INLINE __m128d
+mxp_sse2_square_diff( __m128d v, __m128d mean )
+{
+	__m128d diff;
+
+	diff = _mm_sub_pd( v, mean );
+
+	return _mm_mul_pd( diff, diff );
+}
+
+static MXP_SSE2 double
+mxp_sse2_i32_sum_of_squares( const int32_t *image_data,
+			unsigned long num_pixels, double mean )
+{
+	__m128i v;
+	__m128d vmean, sum0, sum1;
+	double sum_array[2];
+	unsigned long i;
+
+	vmean = _mm_set1_pd( mean );
+
+	sum0 = _mm_setzero_pd();
+	sum1 = _mm_setzero_pd();
+
+	for ( i = 0; (i + 4) <= num_pixels; i += 4 ) {
+		v = _mm_loadu_si128( (const __m128i *) (image_data + i) );
+
+		sum0 = _mm_add_pd( sum0,
+			mxp_sse2_square_diff( _mm_cvtepi32_pd( v ), vmean ) );
+
+		v = _mm_shuffle_epi32( v, _MM_SHUFFLE(1,0,3,2) );
+
+		sum1 = _mm_add_pd( sum1,
+			mxp_sse2_square_diff( _mm_cvtepi32_pd( v ), vmean ) );
+	}
+
+	_mm_storeu_pd( sum_array, _mm_add_pd( sum0, sum1 ) );
+
+	return ( sum_array[0] + sum_array[1] )
+		+ mxp_scalar_i32_sum_of_squares( image_data + i,
+						num_pixels - i, mean );
+}
+
+static MXP_SSE2 double
+mxp_sse2_flt_sum_of_squares( const float *image_data,
+			unsigned long num_pixels, double mean )
+{
+	__m128 f;
+	__m128d vmean, sum0, sum1;
+	double sum_array[2];
+	unsigned long i;
+
+	vmean = _mm_set1_pd( mean );
+
+	sum0 = _mm_setzero_pd();
+	sum1 = _mm_setzero_pd();
+
+	for ( i = 0; (i + 4) <= num_pixels; i += 4 ) {
+		f = _mm_loadu_ps( image_data + i );
+
+		sum0 = _mm_add_pd( sum0,
+			mxp_sse2_square_diff( _mm_cvtps_pd( f ), vmean ) );
+
+		sum1 = _mm_add_pd( sum1,
+			mxp_sse2_square_diff(
+				_mm_cvtps_pd( _mm_movehl_ps( f, f ) ), vmean ) );
+	}
+
+	_mm_storeu_pd( sum_array, _mm_add_pd( sum0, sum1 ) );
+
+	return ( sum_array[0] + sum_array[1] )
+		+ mxp_scalar_flt_sum_of_squares( image_data + i,
+						num_pixels - i, mean );
+}
+
+static MXP_SSE2 double
+mxp_sse2_dbl_sum_of_squares( const double *image_data,
+			unsigned long num_pixels, double mean )
+{
+	__m128d vmean, sum0, sum1;
+	double sum_array[2];
+	unsigned long i;
+
+	vmean = _mm_set1_pd( mean );
+
+	sum0 = _mm_setzero_pd();
+	sum1 = _mm_setzero_pd();
+
+	for ( i = 0; (i + 4) <= num_pixels; i += 4 ) {
+		sum0 = _mm_add_pd( sum0, mxp_sse2_square_diff(
+				_mm_loadu_pd( image_data + i ), vmean ) );
+
+		sum1 = _mm_add_pd( sum1, mxp_sse2_square_diff(
+				_mm_loadu_pd( image_data + i + 2 ), vmean ) );
+	}
+
+	_mm_storeu_pd( sum_array, _mm_add_pd( sum0, sum1 ) );
+
+	return ( sum_array[0] + sum_array[1] )
+		+ mxp_scalar_dbl_sum_of_squares( image_data + i,
+						num_pixels - i, mean );
+}
+
+/*-----------------------------------------------------------------------*/
+
+static MXP_SSE2 void
+mxp_sse2_u8_column_sums( const uint8_t *image_data,
+			unsigned long row_stride,
+			unsigned long num_rows,
+			unsigned long num_columns,
+			uint32_t *column_sums )
+{
+	const __m128i zero = _mm_setzero_si128();
+	const uint8_t *row_data;
+	unsigned long row, i;
+	__m128i v;
+
+	for ( row = 0; row < num_rows; row++ ) {
+		row_data = image_data + row * row_stride;
+
+		for ( i = 0; (i + 16) <= num_columns; i += 16 ) {
+			v = _mm_loadu_si128( (const __m128i *) (row_data + i) );
+
+			mxp_sse2_add_u16_to_u32( column_sums + i,
+					_mm_unpacklo_epi8( v, zero ) );
+
+			mxp_sse2_add_u16_to_u32( column_sums + i + 8,
+					_mm_unpackhi_epi8( v, zero ) );
+		}
+
+		for ( ; i < num_columns; i++ ) {
+			column_sums[i] += row_data[i];
+		}
+	}
+}
+
+static MXP_SSE2 void
+mxp_sse2_u16_column_sums( const uint16_t *image_data,
+			unsigned long row_stride,
+			unsigned long num_rows,
+			unsigned long num_columns,
+			uint32_t *column_sums )
+{
+	const uint16_t *row_data;
+	unsigned long row, i;
+
+	for ( row = 0; row < num_rows; row++ ) {
+		row_data = image_data + row * row_stride;
+
+		for ( i = 0; (i + 8) <= num_columns; i += 8 ) {
+			mxp_sse2_add_u16_to_u32( column_sums + i,
+			    _mm_loadu_si128( (const __m128i *) (row_data + i) ));
+		}
+
+		for ( ; i < num_columns; i++ ) {
+			column_sums[i] += row_data[i];
+		}
+	}
+}
+
+static MXP_SSE2 void
+mxp_sse2_u32_column_sums( const uint32_t *image_data,
+			unsigned long row_stride,
+			unsigned long num_rows,
+			unsigned long num_columns,
+			uint64_t *column_sums )
+{
+	const __m128i zero = _mm_setzero_si128();
+	const uint32_t *row_data;
+	unsigned long row, i;
+
+	for ( row = 0; row < num_rows; row++ ) {
+		row_data = image_data + row * row_stride;
+
+		for ( i = 0; (i + 4) <= num_columns; i += 4 ) {
+			mxp_sse2_add_32_to_64( column_sums + i,
+			    _mm_loadu_si128( (const __m128i *) (row_data + i) ),
+			    zero );
+		}
+
+		for ( ; i < num_columns; i++ ) {
+			column_sums[i] += row_data[i];
+		}
+	}
+}
+
+static MXP_SSE2 void
+mxp_sse2_i32_column_sums( const int32_t *image_data,
+			unsigned long row_stride,
+			unsigned long num_rows,
+			unsigned long num_columns,
+			int64_t *column_sums )
+{
+	const __m128i zero = _mm_setzero_si128();
+	const int32_t *row_data;
+	unsigned long row, i;
+	__m128i v;
+
+	for ( row = 0; row < num_rows; row++ ) {
+		row_data = image_data + row * row_stride;
+
+		for ( i = 0; (i + 4) <= num_columns; i += 4 ) {
+			v = _mm_loadu_si128( (const __m128i *) (row_data + i) );
+
+			mxp_sse2_add_32_to_64( column_sums + i,
+					v, _mm_cmpgt_epi32( zero, v ) );
+		}
+
+		for ( ; i < num_columns; i++ ) {
+			column_sums[i] += row_data[i];
+		}
+	}
+}
+
+static MXP_SSE2 void
+mxp_sse2_flt_column_sums( const float *image_data,
+			unsigned long row_stride,
+			unsigned long num_rows,
+			unsigned long num_columns,
+			double *column_sums )
+{
+	const float *row_data;
+	double *dest;
+	unsigned long row, i;
+	__m128 f;
+
+	for ( row = 0; row < num_rows; row++ ) {
+		row_data = image_data + row * row_stride;
+
+		for ( i = 0; (i + 4) <= num_columns; i += 4 ) {
+			f = _mm_loadu_ps( row_data + i );
+
+			dest = column_sums + i;
+
+			_mm_storeu_pd( dest, _mm_add_pd( _mm_loadu_pd( dest ),
+						_mm_cvtps_pd( f ) ) );
+
+			_mm_storeu_pd( dest + 2,
+				_mm_add_pd( _mm_loadu_pd( dest + 2 ),
+				    _mm_cvtps_pd( _mm_movehl_ps( f, f ) ) ) );
+		}
+
+		for ( ; i < num_columns; i++ ) {
+			column_sums[i] += row_data[i];
+		}
+	}
+}
+
+static MXP_SSE2 void
+mxp_sse2_dbl_column_sums( const double *image_data,
+			unsigned long row_stride,
+			unsigned long num_rows,
+			unsigned long num_columns,
+			double *column_sums )
+{
+	const double *row_data;
+	double *dest;
+	unsigned long row, i;
+
+	for ( row = 0; row < num_rows; row++ ) {
+		row_data = image_data + row * row_stride;
+
+		for ( i = 0; (i + 2) <= num_columns; i += 2 ) {
+			dest = column_sums + i;
+
+			_mm_storeu_pd( dest, _mm_add_pd( _mm_loadu_pd( dest ),
+					_mm_loadu_pd( row_data + i ) ) );
+		}
+
+		for ( ; i < num_columns; i++ ) {
+			column_sums[i] += row_data[i];
+		}
+	}
+}
+
+/*=======================================================================*/
+
+static MXP_AVX2 void
+mxp_avx2_i32_summary( const int32_t *image_data, unsigned long num_pixels,
+			int32_t *min_pixel, int32_t *max_pixel, int64_t *sum )
+{
+	__m256i v, vmin, vmax, sum0, sum1;
+	int32_t min_array[8], max_array[8];
+	int64_t sum_array[4];
+	unsigned long i;
+	int j;
+
+	vmin = _mm256_set1_epi32( *min_pixel );
+	vmax = _mm256_set1_epi32( *max_pixel );
+
+	sum0 = _mm256_setzero_si256();
+	sum1 = _mm256_setzero_si256();
+
+	for ( i = 0; (i + 8) <= num_pixels; i += 8 ) {
+		v = _mm256_loadu_si256( (const __m256i *) (image_data + i) );
+
+		vmin = _mm256_min_epi32( vmin, v );
+		vmax = _mm256_max_epi32( vmax, v );
+
+		sum0 = _mm256_add_epi64( sum0,
+			_mm256_cvtepi32_epi64( _mm256_castsi256_si128( v ) ) );
+		sum1 = _mm256_add_epi64( sum1,
+			_mm256_cvtepi32_epi64(
+				_mm256_extracti128_si256( v, 1 ) ) );
+	}
+
+	_mm256_storeu_si256( (__m256i *) min_array, vmin );
+	_mm256_storeu_si256( (__m256i *) max_array, vmax );
+	_mm256_storeu_si256( (__m256i *) sum_array,
+				_mm256_add_epi64( sum0, sum1 ) );
+
+	for ( j = 0; j < 8; j++ ) {
+		if ( min_array[j] < *min_pixel )
+			*min_pixel = min_array[j];
+
+		if ( max_array[j] > *max_pixel )
+			*max_pixel = max_array[j];
+	}
+
+	for ( j = 0; j < 4; j++ ) {
+		*sum += sum_array[j];
+	}
+
+	mxp_scalar_i32_summary( image_data + i, num_pixels - i,
+					min_pixel, max_pixel, sum );
+}
+
+static MXP_AVX2 void
+mxp_avx2_flt_summary( const float *image_data, unsigned long num_pixels,
+			double *min_pixel, double *max_pixel, double *sum )
+{
+	__m256 f, fmin, fmax;
+	__m256d sum_lo, sum_hi;
+	float min_array[8], max_array[8];
+	double sum_array[4];
+	unsigned long i;
+	int j;
+
+	fmin = _mm256_set1_ps( (float) HUGE_VAL );
+	fmax = _mm256_set1_ps( (float) -HUGE_VAL );
+
+	sum_lo = _mm256_setzero_pd();
+	sum_hi = _mm256_setzero_pd();
+
+	for ( i = 0; (i + 8) <= num_pixels; i += 8 ) {
+		f = _mm256_loadu_ps( image_data + i );
+
+		fmin = _mm256_min_ps( f, fmin );
+		fmax = _mm256_max_ps( f, fmax );
+
+		sum_lo = _mm256_add_pd( sum_lo,
+			_mm256_cvtps_pd( _mm256_castps256_ps128( f ) ) );
+		sum_hi = _mm256_add_pd( sum_hi,
+			_mm256_cvtps_pd( _mm256_extractf128_ps( f, 1 ) ) );
+	}
+
+	_mm256_storeu_ps( min_array, fmin );
+	_mm256_storeu_ps( max_array, fmax );
+	_mm256_storeu_pd( sum_array, _mm256_add_pd( sum_lo, sum_hi ) );
+
+	for ( j = 0; j < 8; j++ ) {
+		if ( min_array[j] < *min_pixel )
+			*min_pixel = min_array[j];
+
+		if ( max_array[j] > *max_pixel )
+			*max_pixel = max_array[j];
+	}
+
+	*sum += ( ( sum_array[0] + sum_array[1] )
+			+ ( sum_array[2] + sum_array[3] ) );
+
+	mxp_scalar_flt_summary( image_data + i, num_pixels - i,
+					min_pixel, max_pixel, sum );
+}
+
+static MXP_AVX2 void
+mxp_avx2_dbl_summary( const double *image_data, unsigned long num_pixels,
+			double *min_pixel, double *max_pixel, double *sum )
+{
+	__m256d v0, v1, vmin, vmax, sum0, sum1;
+	double min_array[4], max_array[4], sum_array[4];
+	unsigned long i;
+	int j;
+
+	vmin = _mm256_set1_pd( HUGE_VAL );
+	vmax = _mm256_set1_pd( -HUGE_VAL );
+
+	sum0 = _mm256_setzero_pd();
+	sum1 = _mm256_setzero_pd();
+
+	for ( i = 0; (i + 8) <= num_pixels; i += 8 ) {
+		v0 = _mm256_loadu_pd( image_data + i );
+		v1 = _mm256_loadu_pd( image_data + i + 4 );
+
+		vmin = _mm256_min_pd( v0, vmin );
+		vmin = _mm256_min_pd( v1, vmin );
+		vmax = _mm256_max_pd( v0, vmax );
+		vmax = _mm256_max_pd( v1, vmax );
+
+		sum0 = _mm256_add_pd( sum0, v0 );
+		sum1 = _mm256_add_pd( sum1, v1 );
+	}
+
+	_mm256_storeu_pd( min_array, vmin );
+	_mm256_storeu_pd( max_array, vmax );
+	_mm256_storeu_pd( sum_array, _mm256_add_pd( sum0, sum1 ) );
+
+	for ( j = 0; j < 4; j++ ) {
+		if ( min_array[j] < *min_pixel )
+			*min_pixel = min_array[j];
+
+		if ( max_array[j] > *max_pixel )
+			*max_pixel = max_array[j];
+	}
+
+	*sum += ( ( sum_array[0] + sum_array[1] )
+			+ ( sum_array[2] + sum_array[3] ) );
+
+	mxp_scalar_dbl_summary( image_data + i, num_pixels - i,
+					min_pixel, max_pixel, sum );
+}
+
+/*-----------------------------------------------------------------------*/
+
+MXP_AVX2_INLINE __m256d
+mxp_avx2_square_diff( __m256d v, __m256d mean )
+{
+	__m256d diff;
+
+	diff = _mm256_sub_pd( v, mean );
+
+	return _mm256_mul_pd( diff, diff );
+}
+
+MXP_AVX2_INLINE double
+mxp_avx2_horizontal_sum( __m256d v )
+{
+	double sum_array[4];
+
+	_mm256_storeu_pd( sum_array, v );
+
+	return ( sum_array[0] + sum_array[1] )
+		+ ( sum_array[2] + sum_array[3] );
+}
+
+static MXP_AVX2 double
+mxp_avx2_i32_sum_of_squares( const int32_t *image_data,
+			unsigned long num_pixels, double mean )
+{
+	__m256i v;
+	__m256d vmean, sum0, sum1;
+	unsigned long i;
+
+	vmean = _mm256_set1_pd( mean );
+
+	sum0 = _mm256_setzero_pd();
+	sum1 = _mm256_setzero_pd();
+
+	for ( i = 0; (i + 8) <= num_pixels; i += 8 ) {
+		v = _mm256_loadu_si256( (const __m256i *) (image_data + i) );
+
+		sum0 = _mm256_add_pd( sum0, mxp_avx2_square_diff(
+			_mm256_cvtepi32_pd( _mm256_castsi256_si128( v ) ),
+			vmean ) );
+
+		sum1 = _mm256_add_pd( sum1, mxp_avx2_square_diff(
+			_mm256_cvtepi32_pd( _mm256_extracti128_si256( v, 1 ) ),
+			vmean ) );
+	}
+
+	return mxp_avx2_horizontal_sum( _mm256_add_pd( sum0, sum1 ) )
+		+ mxp_scalar_i32_sum_of_squares( image_data + i,
+						num_pixels - i, mean );
+}
+
+static MXP_AVX2 double
+mxp_avx2_flt_sum_of_squares( const float *image_data,
+			unsigned long num_pixels, double mean )
+{
+	__m256 f;
+	__m256d vmean, sum0, sum1;
+	unsigned long i;
+
+	vmean = _mm256_set1_pd( mean );
+
+	sum0 = _mm256_setzero_pd();
+	sum1 = _mm256_setzero_pd();
+
+	for ( i = 0; (i + 8) <= num_pixels; i += 8 ) {
+		f = _mm256_loadu_ps( image_data + i );
+
+		sum0 = _mm256_add_pd( sum0, mxp_avx2_square_diff(
+			_mm256_cvtps_pd( _mm256_castps256_ps128( f ) ),
+			vmean ) );
+
+		sum1 = _mm256_add_pd( sum1, mxp_avx2_square_diff(
+			_mm256_cvtps_pd( _mm256_extractf128_ps( f, 1 ) ),
+			vmean ) );
+	}
+
+	return mxp_avx2_horizontal_sum( _mm256_add_pd( sum0, sum1 ) )
+		+ mxp_scalar_flt_sum_of_squares( image_data + i,
+						num_pixels - i, mean );
+}
+
+static MXP_AVX2 double
+mxp_avx2_dbl_sum_of_squares( const double *image_data,
+			unsigned long num_pixels, double mean )
+{
+	__m256d vmean, sum0, sum1;
+	unsigned long i;
+
+	vmean = _mm256_set1_pd( mean );
+
+	sum0 = _mm256_setzero_pd();
+	sum1 = _mm256_setzero_pd();
+
+	for ( i = 0; (i + 8) <= num_pixels; i += 8 ) {
+		sum0 = _mm256_add_pd( sum0, mxp_avx2_square_diff(
+			_mm256_loadu_pd( image_data + i ), vmean ) );
+
+		sum1 = _mm256_add_pd( sum1, mxp_avx2_square_diff(
+			_mm256_loadu_pd( image_data + i + 4 ), vmean ) );
+	}
+
+	return mxp_avx2_horizontal_sum( _mm256_add_pd( sum0, sum1 ) )
+		+ mxp_scalar_dbl_sum_of_squares( image_data + i,
+						num_pixels - i, mean );
+}
+
+/*-----------------------------------------------------------------------*/
+
+MXP_AVX2_INLINE void
+mxp_avx2_add_epi32( uint32_t *dest, __m256i v )
+{
+	__m256i *dest_ptr = (__m256i *) dest;
+
+	_mm256_storeu_si256( dest_ptr,
+		_mm256_add_epi32( _mm256_loadu_si256( dest_ptr ), v ) );
+}
+
+MXP_AVX2_INLINE void
+mxp_avx2_add_epi64( void *dest, __m256i v )
+{
+	__m256i *dest_ptr = dest;
+
+	_mm256_storeu_si256( dest_ptr,
+		_mm256_add_epi64( _mm256_loadu_si256( dest_ptr ), v ) );
+}
+
+MXP_AVX2_INLINE void
+mxp_avx2_add_pd( double *dest, __m256d v )
+{
+	_mm256_storeu_pd( dest, _mm256_add_pd( _mm256_loadu_pd( dest ), v ) );
+}
+
+static MXP_AVX2 void
+mxp_avx2_u8_column_sums( const uint8_t *image_data,
+			unsigned long row_stride,
+			unsigned long num_rows,
+			unsigned long num_columns,
+			uint32_t *column_sums )
+{
+	const uint8_t *row_data;
+	unsigned long row, i;
+	__m128i v;
+
+	for ( row = 0; row < num_rows; row++ ) {
+		row_data = image_data + row * row_stride;
+
+		for ( i = 0; (i + 16) <= num_columns; i += 16 ) {
+			v = _mm_loadu_si128( (const __m128i *) (row_data + i) );
+
+			mxp_avx2_add_epi32( column_sums + i,
+					_mm256_cvtepu8_epi32( v ) );
+
+			mxp_avx2_add_epi32( column_sums + i + 8,
+				_mm256_cvtepu8_epi32( _mm_srli_si128( v, 8 ) ) );
+		}
+
+		for ( ; i < num_columns; i++ ) {
+			column_sums[i] += row_data[i];
+		}
+	}
+}
+
+static MXP_AVX2 void
+mxp_avx2_u16_column_sums( const uint16_t *image_data,
+			unsigned long row_stride,
+			unsigned long num_rows,
+			unsigned long num_columns,
+			uint32_t *column_sums )
+{
+	const uint16_t *row_data;
+	unsigned long row, i;
+
+	for ( row = 0; row < num_rows; row++ ) {
+		row_data = image_data + row * row_stride;
+
+		for ( i = 0; (i + 8) <= num_columns; i += 8 ) {
+			mxp_avx2_add_epi32( column_sums + i,
+			    _mm256_cvtepu16_epi32( _mm_loadu_si128(
+				(const __m128i *) (row_data + i) ) ) );
+		}
+
+		for ( ; i < num_columns; i++ ) {
+			column_sums[i] += row_data[i];
+		}
+	}
+}
+
+static MXP_AVX2 void
+mxp_avx2_u32_column_sums( const uint32_t *image_data,
+			unsigned long row_stride,
+			unsigned long num_rows,
+			unsigned long num_columns,
+			uint64_t *column_sums )
+{
+	const uint32_t *row_data;
+	unsigned long row, i;
+
+	for ( row = 0; row < num_rows; row++ ) {
+		row_data = image_data + row * row_stride;
+
+		for ( i = 0; (i + 4) <= num_columns; i += 4 ) {
+			mxp_avx2_add_epi64( column_sums + i,
+			    _mm256_cvtepu32_epi64( _mm_loadu_si128(
+				(const __m128i *) (row_data + i) ) ) );
+		}
+
+		for ( ; i < num_columns; i++ ) {
+			column_sums[i] += row_data[i];
+		}
+	}
+}
+
+static MXP_AVX2 void
+mxp_avx2_i32_column_sums( const int32_t *image_data,
+			unsigned long row_stride,
+			unsigned long num_rows,
+			unsigned long num_columns,
+			int64_t *column_sums )
+{
+	const int32_t *row_data;
+	unsigned long row, i;
+
+	for ( row = 0; row < num_rows; row++ ) {
+		row_data = image_data + row * row_stride;
+
+		for ( i = 0; (i + 4) <= num_columns; i += 4 ) {
+			mxp_avx2_add_epi64( column_sums + i,
+			    _mm256_cvtepi32_epi64( _mm_loadu_si128(
+				(const __m128i *) (row_data + i) ) ) );
+		}
+
+		for ( ; i < num_columns; i++ ) {
+			column_sums[i] += row_data[i];
+		}
+	}
+}
+
+static MXP_AVX2 void
+mxp_avx2_flt_column_sums( const float *image_data,
+			unsigned long row_stride,
+			unsigned long num_rows,
+			unsigned long num_columns,
+			double *column_sums )
+{
+	const float *row_data;
+	unsigned long row, i;
+
+	for ( row = 0; row < num_rows; row++ ) {
+		row_data = image_data + row * row_stride;
+
+		for ( i = 0; (i + 4) <= num_columns; i += 4 ) {
+			mxp_avx2_add_pd( column_sums + i,
+				_mm256_cvtps_pd( _mm_loadu_ps( row_data + i ) ) );
+		}
+
+		for ( ; i < num_columns; i++ ) {
+			column_sums[i] += row_data[i];
+		}
+	}
+}
+
+static MXP_AVX2 void
+mxp_avx2_dbl_column_sums( const double *image_data,
+			unsigned long row_stride,
+			unsigned long num_rows,
+			unsigned long num_columns,
+			double *column_sums )
+{
+	const double *row_data;
+	unsigned long row, i;
+
+	for ( row = 0; row < num_rows; row++ ) {
+		row_data = image_data + row * row_stride;
+
+		for ( i = 0; (i + 4) <= num_columns; i += 4 ) {
+			mxp_avx2_add_pd( column_sums + i,
+				_mm256_loadu_pd( row_data + i ) );
+		}
+
+		for ( ; i < num_columns; i++ ) {
+			column_sums[i] += row_data[i];
+		}
+	}
+}
+
+#endif /* MXP_HAVE_X86_SIMD */
+
+/*=======================================================================*/
+
+static long
+mxp_best_image_kernel( void )
+{
+#if MXP_HAVE_X86_SIMD
+	__builtin_cpu_init();
+
+	if ( __builtin_cpu_supports( "avx2" ) ) {
+		return MXT_IMAGE_KERNEL_AVX2;
+	}
+	if ( __builtin_cpu_supports( "sse2" ) ) {
+		return MXT_IMAGE_KERNEL_SSE2;
+	}
+#endif
+	return MXT_IMAGE_KERNEL_SCALAR;
+}
+
+/* The kernel type is chosen the first time any kernel is called.  If two
+ * threads race to do this, they both store the same value, so no locking
+ * is needed.
+ */
+
+static inline long
+mxp_get_image_kernel( void )
+{
+	if ( mxp_image_kernel < 0 ) {
+		mxp_image_kernel = mxp_best_image_kernel();
+
+#if MX_IMAGE_SIMD_DEBUG
+		MX_DEBUG(-2,("mxp_get_image_kernel(): kernel type = %ld",
+			mxp_image_kernel));
+#endif
+	}
+
+	return mxp_image_kernel;
+}
+
+MX_EXPORT long
+mx_image_get_kernel( void )
+{
+	return mxp_get_image_kernel();
+}
+
+MX_EXPORT mx_status_type
+mx_image_set_kernel( long kernel_type )
+{
+	static const char fname[] = "mx_image_set_kernel()";
+
+	long best_kernel;
+
+	best_kernel = mxp_best_image_kernel();
+
+	switch( kernel_type ) {
+	case MXT_IMAGE_KERNEL_AUTO:
+		mxp_image_kernel = best_kernel;
+		break;
+	case MXT_IMAGE_KERNEL_SCALAR:
+	case MXT_IMAGE_KERNEL_SSE2:
+	case MXT_IMAGE_KERNEL_AVX2:
+		if ( kernel_type > best_kernel ) {
+			return mx_error( MXE_UNSUPPORTED, fname,
+			"Image kernel type %ld is not supported "
+			"on this computer.  The best available type is %ld.",
+				kernel_type, best_kernel );
+		}
+
+		mxp_image_kernel = kernel_type;
+		break;
+	default:
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"Unrecognized image kernel type %ld.", kernel_type );
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-----------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_image_pixel_summary_kernel( long image_format,
+				const void *image_data,
+				unsigned long num_pixels,
+				double *min_pixel,
+				double *max_pixel,
+				double *sum )
+{
+	static const char fname[] = "mx_image_pixel_summary_kernel()";
+
+	uint8_t min_u8, max_u8;
+	uint16_t min_u16, max_u16;
+	int32_t min_i32, max_i32;
+	uint64_t sum_u64;
+	int64_t sum_i64;
+	long kernel;
+
+	if ( (image_data == NULL) || (min_pixel == (double *) NULL)
+	  || (max_pixel == (double *) NULL) || (sum == (double *) NULL) )
+	{
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"One or more of the pointers passed was NULL." );
+	}
+
+	kernel = mxp_get_image_kernel();
+
+	*min_pixel = HUGE_VAL;
+	*max_pixel = -HUGE_VAL;
+	*sum = 0.0;
+
+	switch( image_format ) {
+	case MXT_IMAGE_FORMAT_GREY8:
+		min_u8 = UINT8_MAX;
+		max_u8 = 0;
+		sum_u64 = 0;
+
+		mxp_scalar_u8_summary( image_data, num_pixels,
+					&min_u8, &max_u8, &sum_u64 );
+
+		if ( num_pixels > 0 ) {
+			*min_pixel = min_u8;
+			*max_pixel = max_u8;
+		}
+		*sum = (double) sum_u64;
+		break;
+
+	case MXT_IMAGE_FORMAT_GREY16:
+		min_u16 = UINT16_MAX;
+		max_u16 = 0;
+		sum_u64 = 0;
+
+		mxp_scalar_u16_summary( image_data, num_pixels,
+					&min_u16, &max_u16, &sum_u64 );
+
+		if ( num_pixels > 0 ) {
+			*min_pixel = min_u16;
+			*max_pixel = max_u16;
+		}
+		*sum = (double) sum_u64;
+		break;
+
+	case MXT_IMAGE_FORMAT_INT32:
+		min_i32 = INT32_MAX;
+		max_i32 = INT32_MIN;
+		sum_i64 = 0;
+
+		switch( kernel ) {
+#if MXP_HAVE_X86_SIMD
+		case MXT_IMAGE_KERNEL_AVX2:
+			mxp_avx2_i32_summary( image_data, num_pixels,
+					&min_i32, &max_i32, &sum_i64 );
+			break;
+		case MXT_IMAGE_KERNEL_SSE2:
+			mxp_sse2_i32_summary( image_data, num_pixels,
+					&min_i32, &max_i32, &sum_i64 );
+			break;
+#endif
+		default:
+			mxp_scalar_i32_summary( image_data, num_pixels,
+					&min_i32, &max_i32, &sum_i64 );
+			break;
+		}
+
+		if ( num_pixels > 0 ) {
+			*min_pixel = min_i32;
+			*max_pixel = max_i32;
+		}
+		*sum = (double) sum_i64;
+		break;
+
+	case MXT_IMAGE_FORMAT_FLOAT:
+		switch( kernel ) {
+#if MXP_HAVE_X86_SIMD
+		case MXT_IMAGE_KERNEL_AVX2:
+			mxp_avx2_flt_summary( image_data, num_pixels,
+					min_pixel, max_pixel, sum );
+			break;
+		case MXT_IMAGE_KERNEL_SSE2:
+			mxp_sse2_flt_summary( image_data, num_pixels,
+					min_pixel, max_pixel, sum );
+			break;
+#endif
+		default:
+			mxp_scalar_flt_summary( image_data, num_pixels,
+					min_pixel, max_pixel, sum );
+			break;
+		}
+		break;
+
+	case MXT_IMAGE_FORMAT_DOUBLE:
+		switch( kernel ) {
+#if MXP_HAVE_X86_SIMD
+		case MXT_IMAGE_KERNEL_AVX2:
+			mxp_avx2_dbl_summary( image_data, num_pixels,
+					min_pixel, max_pixel, sum );
+			break;
+		case MXT_IMAGE_KERNEL_SSE2:
+			mxp_sse2_dbl_summary( image_data, num_pixels,
+					min_pixel, max_pixel, sum );
+			break;
+#endif
+		default:
+			mxp_scalar_dbl_summary( image_data, num_pixels,
+					min_pixel, max_pixel, sum );
+			break;
+		}
+		break;
+
+	default:
+		return mx_error( MXE_UNSUPPORTED, fname,
+		"Image format %ld is not supported by this kernel.",
+			image_format );
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-----------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_image_sum_of_squares_kernel( long image_format,
+				const void *image_data,
+				unsigned long num_pixels,
+				double mean,
+				double *sum_of_squares )
+{
+	static const char fname[] = "mx_image_sum_of_squares_kernel()";
+
+	long kernel;
+
+	if ( (image_data == NULL) || (sum_of_squares == (double *) NULL) ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"One or more of the pointers passed was NULL." );
+	}
+
+	kernel = mxp_get_image_kernel();
+
+	switch( image_format ) {
+	case MXT_IMAGE_FORMAT_GREY8:
+		*sum_of_squares = mxp_scalar_u8_sum_of_squares(
+						image_data, num_pixels, mean );
+		break;
+
+	case MXT_IMAGE_FORMAT_GREY16:
+		*sum_of_squares = mxp_scalar_u16_sum_of_squares(
+						image_data, num_pixels, mean );
+		break;
+
+	case MXT_IMAGE_FORMAT_INT32:
+		switch( kernel ) {
+#if MXP_HAVE_X86_SIMD
+		case MXT_IMAGE_KERNEL_AVX2:
+			*sum_of_squares = mxp_avx2_i32_sum_of_squares(
+						image_data, num_pixels, mean );
+			break;
+		case MXT_IMAGE_KERNEL_SSE2:
+			*sum_of_squares = mxp_sse2_i32_sum_of_squares(
+						image_data, num_pixels, mean );
+			break;
+#endif
+		default:
+			*sum_of_squares = mxp_scalar_i32_sum_of_squares(
+						image_data, num_pixels, mean );
+			break;
+		}
+		break;
+
+	case MXT_IMAGE_FORMAT_FLOAT:
+		switch( kernel ) {
+#if MXP_HAVE_X86_SIMD
+		case MXT_IMAGE_KERNEL_AVX2:
+			*sum_of_squares = mxp_avx2_flt_sum_of_squares(
+						image_data, num_pixels, mean );
+			break;
+		case MXT_IMAGE_KERNEL_SSE2:
+			*sum_of_squares = mxp_sse2_flt_sum_of_squares(
+						image_data, num_pixels, mean );
+			break;
+#endif
+		default:
+			*sum_of_squares = mxp_scalar_flt_sum_of_squares(
+						image_data, num_pixels, mean );
+			break;
+		}
+		break;
+
+	case MXT_IMAGE_FORMAT_DOUBLE:
+		switch( kernel ) {
+#if MXP_HAVE_X86_SIMD
+		case MXT_IMAGE_KERNEL_AVX2:
+			*sum_of_squares = mxp_avx2_dbl_sum_of_squares(
+						image_data, num_pixels, mean );
+			break;
+		case MXT_IMAGE_KERNEL_SSE2:
+			*sum_of_squares = mxp_sse2_dbl_sum_of_squares(
+						image_data, num_pixels, mean );
+			break;
+#endif
+		default:
+			*sum_of_squares = mxp_scalar_dbl_sum_of_squares(
+						image_data, num_pixels, mean );
+			break;
+		}
+		break;
+
+	default:
+		return mx_error( MXE_UNSUPPORTED, fname,
+		"Image format %ld is not supported by this kernel.",
+			image_format );
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/* mxp_sd_bin() must compute the bin number the same way as the original
+ * loop in mx_image_statistics(), which used mx_round().  Out of range
+ * values, including those that do not fit in a long, end up in the
+ * same bins that they did there.
+ */
+
+static inline long
+mxp_sd_bin( double pixel, double mean, double standard_deviation,
+		long max_sd, long num_bins )
+{
+	double value;
+	long bin;
+
+	value = ( ( pixel - mean ) / standard_deviation ) + max_sd;
+
+	if ( value >= 0.0 ) {
+		bin = (long) ( 0.5 + value );
+	} else {
+		bin = (long) ( -0.5 + value );
+	}
+
+	if ( bin >= num_bins ) {
+		bin = num_bins - 1;
+	} else
+	if ( bin < 0 ) {
+		bin = 0;
+	}
+
+	return bin;
+}
+
+MX_EXPORT mx_status_type
+mx_image_sd_histogram_kernel( long image_format,
+				const void *image_data,
+				unsigned long num_pixels,
+				double mean,
+				double standard_deviation,
+				long max_sd,
+				unsigned long *sd_histogram )
+{
+	static const char fname[] = "mx_image_sd_histogram_kernel()";
+
+	const uint8_t  *uint8_array;
+	const uint16_t *uint16_array;
+	const int32_t  *int32_array;
+	const float    *float_array;
+	const double   *double_array;
+	unsigned long i;
+	long num_bins;
+
+	if ( (image_data == NULL) || (sd_histogram == (unsigned long *) NULL) )
+	{
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"One or more of the pointers passed was NULL." );
+	}
+	if ( max_sd < 0 ) {
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"The maximum number of standard deviations (%ld) "
+		"must not be negative.", max_sd );
+	}
+
+	num_bins = 2 * max_sd + 1;
+
+	memset( sd_histogram, 0, num_bins * sizeof(unsigned long) );
+
+	switch( image_format ) {
+	case MXT_IMAGE_FORMAT_GREY8:
+		uint8_array = image_data;
+
+		for ( i = 0; i < num_pixels; i++ ) {
+			sd_histogram[ mxp_sd_bin( uint8_array[i], mean,
+				standard_deviation, max_sd, num_bins ) ]++;
+		}
+		break;
+	case MXT_IMAGE_FORMAT_GREY16:
+		uint16_array = image_data;
+
+		for ( i = 0; i < num_pixels; i++ ) {
+			sd_histogram[ mxp_sd_bin( uint16_array[i], mean,
+				standard_deviation, max_sd, num_bins ) ]++;
+		}
+		break;
+	case MXT_IMAGE_FORMAT_INT32:
+		int32_array = image_data;
+
+		for ( i = 0; i < num_pixels; i++ ) {
+			sd_histogram[ mxp_sd_bin( int32_array[i], mean,
+				standard_deviation, max_sd, num_bins ) ]++;
+		}
+		break;
+	case MXT_IMAGE_FORMAT_FLOAT:
+		float_array = image_data;
+
+		for ( i = 0; i < num_pixels; i++ ) {
+			sd_histogram[ mxp_sd_bin( float_array[i], mean,
+				standard_deviation, max_sd, num_bins ) ]++;
+		}
+		break;
+	case MXT_IMAGE_FORMAT_DOUBLE:
+		double_array = image_data;
+
+		for ( i = 0; i < num_pixels; i++ ) {
+			sd_histogram[ mxp_sd_bin( double_array[i], mean,
+				standard_deviation, max_sd, num_bins ) ]++;
+		}
+		break;
+	default:
+		return mx_error( MXE_UNSUPPORTED, fname,
+		"Image format %ld is not supported by this kernel.",
+			image_format );
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-----------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_image_value_histogram_kernel( long image_format,
+				const void *image_data,
+				unsigned long num_pixels,
+				unsigned long *value_counts )
+{
+	static const char fname[] = "mx_image_value_histogram_kernel()";
+
+	const uint8_t  *uint8_array;
+	const uint16_t *uint16_array;
+	unsigned long i;
+
+	if ( (image_data == NULL) || (value_counts == (unsigned long *) NULL) )
+	{
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"One or more of the pointers passed was NULL." );
+	}
+
+	switch( image_format ) {
+	case MXT_IMAGE_FORMAT_GREY8:
+		uint8_array = image_data;
+
+		memset( value_counts, 0, 256 * sizeof(unsigned long) );
+
+		for ( i = 0; i < num_pixels; i++ ) {
+			value_counts[ uint8_array[i] ]++;
+		}
+		break;
+	case MXT_IMAGE_FORMAT_GREY16:
+		uint16_array = image_data;
+
+		memset( value_counts, 0, 65536 * sizeof(unsigned long) );
+
+		for ( i = 0; i < num_pixels; i++ ) {
+			value_counts[ uint16_array[i] ]++;
+		}
+		break;
+	default:
+		return mx_error( MXE_UNSUPPORTED, fname,
+		"Image format %ld is not supported by this kernel.",
+			image_format );
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-----------------------------------------------------------------------*/
+
+static void
+mxp_column_sums( long image_format, const void *image_data,
+			unsigned long row_stride,
+			unsigned long num_rows,
+			unsigned long num_columns,
+			void *column_sums )
+{
+	long kernel;
+
+	kernel = mxp_get_image_kernel();
+
+	switch( image_format ) {
+	case MXT_IMAGE_FORMAT_GREY8:
+		switch( kernel ) {
+#if MXP_HAVE_X86_SIMD
+		case MXT_IMAGE_KERNEL_AVX2:
+			mxp_avx2_u8_column_sums( image_data, row_stride,
+				num_rows, num_columns, column_sums );
+			break;
+		case MXT_IMAGE_KERNEL_SSE2:
+			mxp_sse2_u8_column_sums( image_data, row_stride,
+				num_rows, num_columns, column_sums );
+			break;
+#endif
+		default:
+			mxp_scalar_u8_column_sums( image_data, row_stride,
+				num_rows, num_columns, column_sums );
+			break;
+		}
+		break;
+
+	case MXT_IMAGE_FORMAT_GREY16:
+		switch( kernel ) {
+#if MXP_HAVE_X86_SIMD
+		case MXT_IMAGE_KERNEL_AVX2:
+			mxp_avx2_u16_column_sums( image_data, row_stride,
+				num_rows, num_columns, column_sums );
+			break;
+		case MXT_IMAGE_KERNEL_SSE2:
+			mxp_sse2_u16_column_sums( image_data, row_stride,
+				num_rows, num_columns, column_sums );
+			break;
+#endif
+		default:
+			mxp_scalar_u16_column_sums( image_data, row_stride,
+				num_rows, num_columns, column_sums );
+			break;
+		}
+		break;
+
+	case MXT_IMAGE_FORMAT_GREY32:
+		switch( kernel ) {
+#if MXP_HAVE_X86_SIMD
+		case MXT_IMAGE_KERNEL_AVX2:
+			mxp_avx2_u32_column_sums( image_data, row_stride,
+				num_rows, num_columns, column_sums );
+			break;
+		case MXT_IMAGE_KERNEL_SSE2:
+			mxp_sse2_u32_column_sums( image_data, row_stride,
+				num_rows, num_columns, column_sums );
+			break;
+#endif
+		default:
+			mxp_scalar_u32_column_sums( image_data, row_stride,
+				num_rows, num_columns, column_sums );
+			break;
+		}
+		break;
+
+	case MXT_IMAGE_FORMAT_INT32:
+		switch( kernel ) {
+#if MXP_HAVE_X86_SIMD
+		case MXT_IMAGE_KERNEL_AVX2:
+			mxp_avx2_i32_column_sums( image_data, row_stride,
+				num_rows, num_columns, column_sums );
+			break;
+		case MXT_IMAGE_KERNEL_SSE2:
+			mxp_sse2_i32_column_sums( image_data, row_stride,
+				num_rows, num_columns, column_sums );
+			break;
+#endif
+		default:
+			mxp_scalar_i32_column_sums( image_data, row_stride,
+				num_rows, num_columns, column_sums );
+			break;
+		}
+		break;
+
+	case MXT_IMAGE_FORMAT_FLOAT:
+		switch( kernel ) {
+#if MXP_HAVE_X86_SIMD
+		case MXT_IMAGE_KERNEL_AVX2:
+			mxp_avx2_flt_column_sums( image_data, row_stride,
+				num_rows, num_columns, column_sums );
+			break;
+		case MXT_IMAGE_KERNEL_SSE2:
+			mxp_sse2_flt_column_sums( image_data, row_stride,
+				num_rows, num_columns, column_sums );
+			break;
+#endif
+		default:
+			mxp_scalar_flt_column_sums( image_data, row_stride,
+				num_rows, num_columns, column_sums );
+			break;
+		}
+		break;
+
+	case MXT_IMAGE_FORMAT_DOUBLE:
+		switch( kernel ) {
+#if MXP_HAVE_X86_SIMD
+		case MXT_IMAGE_KERNEL_AVX2:
+			mxp_avx2_dbl_column_sums( image_data, row_stride,
+				num_rows, num_columns, column_sums );
+			break;
+		case MXT_IMAGE_KERNEL_SSE2:
+			mxp_sse2_dbl_column_sums( image_data, row_stride,
+				num_rows, num_columns, column_sums );
+			break;
+#endif
+		default:
+			mxp_scalar_dbl_column_sums( image_data, row_stride,
+				num_rows, num_columns, column_sums );
+			break;
+		}
+		break;
+	}
+}
+
+/* mxp_bin_sums() adds each group of 'width_shrink_factor' column sums
+ * to the corresponding bin sum.  The bin sums are 64-bit integers for
+ * integer images and doubles for floating point images.
+ */
+
+static void
+mxp_bin_sums( long image_format, const void *column_sums,
+			unsigned long num_bins,
+			unsigned long width_shrink_factor,
+			void *bin_sums )
+{
+	const uint32_t *u32_column_sums;
+	const uint64_t *u64_column_sums;
+	const int64_t *i64_column_sums;
+	const double *dbl_column_sums;
+	uint64_t *u64_bin_sums, u64_sum;
+	int64_t *i64_bin_sums, i64_sum;
+	double *dbl_bin_sums, dbl_sum;
+	unsigned long bin, i, k;
+
+	switch( image_format ) {
+	case MXT_IMAGE_FORMAT_GREY8:
+	case MXT_IMAGE_FORMAT_GREY16:
+		u32_column_sums = column_sums;
+		u64_bin_sums = bin_sums;
+
+		for ( bin = 0, i = 0; bin < num_bins; bin++ ) {
+			u64_sum = 0;
+
+			for ( k = 0; k < width_shrink_factor; k++, i++ ) {
+				u64_sum += u32_column_sums[i];
+			}
+
+			u64_bin_sums[bin] += u64_sum;
+		}
+		break;
+
+	case MXT_IMAGE_FORMAT_GREY32:
+		u64_column_sums = column_sums;
+		u64_bin_sums = bin_sums;
+
+		for ( bin = 0, i = 0; bin < num_bins; bin++ ) {
+			u64_sum = 0;
+
+			for ( k = 0; k < width_shrink_factor; k++, i++ ) {
+				u64_sum += u64_column_sums[i];
+			}
+
+			u64_bin_sums[bin] += u64_sum;
+		}
+		break;
+
+	case MXT_IMAGE_FORMAT_INT32:
+		i64_column_sums = column_sums;
+		i64_bin_sums = bin_sums;
+
+		for ( bin = 0, i = 0; bin < num_bins; bin++ ) {
+			i64_sum = 0;
+
+			for ( k = 0; k < width_shrink_factor; k++, i++ ) {
+				i64_sum += i64_column_sums[i];
+			}
+
+			i64_bin_sums[bin] += i64_sum;
+		}
+		break;
+
+	case MXT_IMAGE_FORMAT_FLOAT:
+	case MXT_IMAGE_FORMAT_DOUBLE:
+		dbl_column_sums = column_sums;
+		dbl_bin_sums = bin_sums;
+
+		for ( bin = 0, i = 0; bin < num_bins; bin++ ) {
+			dbl_sum = 0.0;
+
+			for ( k = 0; k < width_shrink_factor; k++, i++ ) {
+				dbl_sum += dbl_column_sums[i];
+			}
+
+			dbl_bin_sums[bin] += dbl_sum;
+		}
+		break;
+	}
+}
+
+/* mxp_store_bins() writes out the average of each bin.  Unsigned integer
+ * averages are rounded with the same expression used by the original
+ * 16-bit rebinning loop.  Signed integer averages are rounded to the
+ * nearest integer with mx_round()'s rules, while floating point averages
+ * are stored without rounding.
+ */
+
+static void
+mxp_store_bins( long image_format, const void *bin_sums,
+			unsigned long num_bins,
+			double pixels_per_bin,
+			void *rebinned_row )
+{
+	const uint64_t *u64_bin_sums;
+	const int64_t *i64_bin_sums;
+	const double *dbl_bin_sums;
+	uint8_t *uint8_row;
+	uint16_t *uint16_row;
+	uint32_t *uint32_row;
+	int32_t *int32_row;
+	float *float_row;
+	double *double_row;
+	double pixel_average;
+	unsigned long bin;
+
+	switch( image_format ) {
+	case MXT_IMAGE_FORMAT_GREY8:
+		u64_bin_sums = bin_sums;
+		uint8_row = rebinned_row;
+
+		for ( bin = 0; bin < num_bins; bin++ ) {
+			pixel_average = ((double) u64_bin_sums[bin])
+						/ pixels_per_bin;
+
+			uint8_row[bin] = (uint8_t) ( pixel_average + 0.5 );
+		}
+		break;
+
+	case MXT_IMAGE_FORMAT_GREY16:
+		u64_bin_sums = bin_sums;
+		uint16_row = rebinned_row;
+
+		for ( bin = 0; bin < num_bins; bin++ ) {
+			pixel_average = ((double) u64_bin_sums[bin])
+						/ pixels_per_bin;
+
+			uint16_row[bin] = (uint16_t) ( pixel_average + 0.5 );
+		}
+		break;
+
+	case MXT_IMAGE_FORMAT_GREY32:
+		u64_bin_sums = bin_sums;
+		uint32_row = rebinned_row;
+
+		for ( bin = 0; bin < num_bins; bin++ ) {
+			pixel_average = ((double) u64_bin_sums[bin])
+						/ pixels_per_bin;
+
+			uint32_row[bin] = (uint32_t) ( pixel_average + 0.5 );
+		}
+		break;
+
+	case MXT_IMAGE_FORMAT_INT32:
+		i64_bin_sums = bin_sums;
+		int32_row = rebinned_row;
+
+		for ( bin = 0; bin < num_bins; bin++ ) {
+			pixel_average = ((double) i64_bin_sums[bin])
+						/ pixels_per_bin;
+
+			if ( pixel_average >= 0.0 ) {
+				int32_row[bin] =
+					(int32_t) ( pixel_average + 0.5 );
+			} else {
+				int32_row[bin] =
+					(int32_t) ( pixel_average - 0.5 );
+			}
+		}
+		break;
+
+	case MXT_IMAGE_FORMAT_FLOAT:
+		dbl_bin_sums = bin_sums;
+		float_row = rebinned_row;
+
+		for ( bin = 0; bin < num_bins; bin++ ) {
+			float_row[bin] =
+				(float) ( dbl_bin_sums[bin] / pixels_per_bin );
+		}
+		break;
+
+	case MXT_IMAGE_FORMAT_DOUBLE:
+		dbl_bin_sums = bin_sums;
+		double_row = rebinned_row;
+
+		for ( bin = 0; bin < num_bins; bin++ ) {
+			double_row[bin] = dbl_bin_sums[bin] / pixels_per_bin;
+		}
+		break;
+	}
+}
+
+/* mx_image_rebin_shrink_kernel() shrinks an image by averaging each
+ * block of 'width_shrink_factor' by 'height_shrink_factor' pixels.
+ * Each rebinned row is computed by first adding the original rows
+ * together column by column with the vectorized column sum kernels,
+ * and then adding together groups of adjacent column sums.
+ */
+
+MX_EXPORT mx_status_type
+mx_image_rebin_shrink_kernel( long image_format,
+				const void *original_data,
+				unsigned long original_width,
+				void *rebinned_data,
+				unsigned long rebinned_width,
+				unsigned long rebinned_height,
+				unsigned long width_shrink_factor,
+				unsigned long height_shrink_factor )
+{
+	static const char fname[] = "mx_image_rebin_shrink_kernel()";
+
+	size_t bytes_per_pixel, column_sum_size;
+	unsigned long num_columns, max_rows_per_pass, num_rows;
+	unsigned long row, orow;
+	double pixels_per_bin;
+	const char *original_row;
+	char *rebinned_row;
+	void *column_sums, *bin_sums;
+
+	if ( (original_data == NULL) || (rebinned_data == NULL) ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"One or more of the pointers passed was NULL." );
+	}
+	if ( (width_shrink_factor == 0) || (height_shrink_factor == 0) ) {
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"The shrink factors (%lu, %lu) must both be greater than 0.",
+			width_shrink_factor, height_shrink_factor );
+	}
+
+	max_rows_per_pass = height_shrink_factor;
+
+	switch( image_format ) {
+	case MXT_IMAGE_FORMAT_GREY8:
+		bytes_per_pixel = sizeof(uint8_t);
+		column_sum_size = sizeof(uint32_t);
+		max_rows_per_pass = MXP_MAX_U32_COLUMN_SUM_ROWS;
+		break;
+	case MXT_IMAGE_FORMAT_GREY16:
+		bytes_per_pixel = sizeof(uint16_t);
+		column_sum_size = sizeof(uint32_t);
+		max_rows_per_pass = MXP_MAX_U32_COLUMN_SUM_ROWS;
+		break;
+	case MXT_IMAGE_FORMAT_GREY32:
+		bytes_per_pixel = sizeof(uint32_t);
+		column_sum_size = sizeof(uint64_t);
+		break;
+	case MXT_IMAGE_FORMAT_INT32:
+		bytes_per_pixel = sizeof(int32_t);
+		column_sum_size = sizeof(int64_t);
+		break;
+	case MXT_IMAGE_FORMAT_FLOAT:
+		bytes_per_pixel = sizeof(float);
+		column_sum_size = sizeof(double);
+		break;
+	case MXT_IMAGE_FORMAT_DOUBLE:
+		bytes_per_pixel = sizeof(double);
+		column_sum_size = sizeof(double);
+		break;
+	default:
+		return mx_error( MXE_UNSUPPORTED, fname,
+		"Image format %ld is not supported by this kernel.",
+			image_format );
+	}
+
+	num_columns = rebinned_width * width_shrink_factor;
+
+	if ( num_columns > original_width ) {
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"A rebinned width of %lu with a shrink factor of %lu "
+		"is too large for an original width of %lu.",
+			rebinned_width, width_shrink_factor, original_width );
+	}
+
+	pixels_per_bin = width_shrink_factor * height_shrink_factor;
+
+	/* The bin sums are always 8 bytes, whatever the image format. */
+
+	column_sums = malloc( num_columns * column_sum_size );
+
+	bin_sums = malloc( rebinned_width * sizeof(double) );
+
+	if ( (column_sums == NULL) || (bin_sums == NULL) ) {
+		mx_free( column_sums );
+		mx_free( bin_sums );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate the sum arrays "
+		"for rebinning a %lu pixel wide image.", original_width );
+	}
+
+	for ( row = 0; row < rebinned_height; row++ ) {
+
+		memset( bin_sums, 0, rebinned_width * sizeof(double) );
+
+		for ( orow = 0; orow < height_shrink_factor; orow += num_rows ) {
+
+			num_rows = height_shrink_factor - orow;
+
+			if ( num_rows > max_rows_per_pass ) {
+				num_rows = max_rows_per_pass;
+			}
+
+			original_row = (const char *) original_data
+			    + ( row * height_shrink_factor + orow )
+				* original_width * bytes_per_pixel;
+
+			memset( column_sums, 0, num_columns * column_sum_size );
+
+			mxp_column_sums( image_format, original_row,
+				original_width, num_rows, num_columns,
+				column_sums );
+
+			mxp_bin_sums( image_format, column_sums,
+				rebinned_width, width_shrink_factor, bin_sums );
+		}
+
+		rebinned_row = (char *) rebinned_data
+			+ row * rebinned_width * bytes_per_pixel;
+
+		mxp_store_bins( image_format, bin_sums, rebinned_width,
+				pixels_per_bin, rebinned_row );
+	}
+
+	mx_free( column_sums );
+	mx_free( bin_sums );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
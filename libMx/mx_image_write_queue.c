@@ -0,0 +1,621 @@
+/*
+ * Name:    mx_image_write_queue.c
+ *
+ * Purpose: MX image write queues for writing image frames to disk
+ *          in background threads.
+ *
+ * Author:  William Lavender
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Copyright 2016 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#define MX_IMAGE_WRITE_QUEUE_DEBUG	FALSE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mx_util.h"
+#include "mx_record.h"
+#include "mx_hrt.h"
+#include "mx_image_write_queue.h"
+
+#define MXP_FREE_FRAME_ARRAY_BLOCK_SIZE		10
+
+/*-------------------------------------------------------------------------*/
+
+/* The following functions must be called with the queue mutex locked. */
+
+static void
+mxp_image_write_queue_append( MX_IMAGE_WRITE_QUEUE_ENTRY **head,
+				MX_IMAGE_WRITE_QUEUE_ENTRY **tail,
+				MX_IMAGE_WRITE_QUEUE_ENTRY *entry )
+{
+	entry->next_entry = NULL;
+
+	if ( *tail == (MX_IMAGE_WRITE_QUEUE_ENTRY *) NULL ) {
+		*head = entry;
+	} else {
+		(*tail)->next_entry = entry;
+	}
+
+	*tail = entry;
+}
+
+static MX_IMAGE_WRITE_QUEUE_ENTRY *
+mxp_image_write_queue_remove_first( MX_IMAGE_WRITE_QUEUE_ENTRY **head,
+				MX_IMAGE_WRITE_QUEUE_ENTRY **tail )
+{
+	MX_IMAGE_WRITE_QUEUE_ENTRY *entry;
+
+	entry = *head;
+
+	if ( entry != (MX_IMAGE_WRITE_QUEUE_ENTRY *) NULL ) {
+		*head = entry->next_entry;
+
+		if ( *head == (MX_IMAGE_WRITE_QUEUE_ENTRY *) NULL ) {
+			*tail = NULL;
+		}
+
+		entry->next_entry = NULL;
+	}
+
+	return entry;
+}
+
+static void
+mxp_image_write_queue_recycle_frame( MX_IMAGE_WRITE_QUEUE *queue,
+					MX_IMAGE_FRAME *frame )
+{
+	MX_IMAGE_FRAME **new_array;
+	unsigned long new_size;
+
+	if ( frame == (MX_IMAGE_FRAME *) NULL ) {
+		return;
+	}
+
+	if ( queue->num_free_frames >= queue->free_frame_array_size ) {
+		new_size = queue->free_frame_array_size
+				+ MXP_FREE_FRAME_ARRAY_BLOCK_SIZE;
+
+		new_array = (MX_IMAGE_FRAME **) realloc(
+				queue->free_frame_array,
+				new_size * sizeof(MX_IMAGE_FRAME *) );
+
+		if ( new_array == (MX_IMAGE_FRAME **) NULL ) {
+			/* If we cannot keep the frame, then just free it. */
+
+			mx_image_free( frame );
+			return;
+		}
+
+		queue->free_frame_array = new_array;
+		queue->free_frame_array_size = new_size;
+	}
+
+	queue->free_frame_array[ queue->num_free_frames ] = frame;
+
+	queue->num_free_frames++;
+}
+
+/*-------------------------------------------------------------------------*/
+
+static mx_status_type
+mxp_image_write_queue_thread_fn( MX_THREAD *thread, void *args )
+{
+#if MX_IMAGE_WRITE_QUEUE_DEBUG
+	static const char fname[] = "mxp_image_write_queue_thread_fn()";
+#endif
+
+	MX_IMAGE_WRITE_QUEUE *queue;
+	MX_IMAGE_WRITE_QUEUE_ENTRY *entry;
+	double start_time;
+
+	queue = (MX_IMAGE_WRITE_QUEUE *) args;
+
+	mx_mutex_lock( queue->mutex );
+
+	for (;;) {
+		while ( ( queue->shutdown == FALSE )
+		  && ( queue->pending_head == NULL ) )
+		{
+			(void) mx_condition_variable_wait( queue->work_cv,
+								queue->mutex );
+		}
+
+		entry = mxp_image_write_queue_remove_first(
+						&(queue->pending_head),
+						&(queue->pending_tail) );
+
+		if ( entry == (MX_IMAGE_WRITE_QUEUE_ENTRY *) NULL ) {
+			/* The queue is shutting down and is empty. */
+
+			break;
+		}
+
+		mx_mutex_unlock( queue->mutex );
+
+#if MX_IMAGE_WRITE_QUEUE_DEBUG
+		MX_DEBUG(-2,("%s: writing '%s'", fname, entry->filename));
+#endif
+		start_time = mx_high_resolution_time_as_double();
+
+		entry->write_status = mx_image_write_file( entry->frame, NULL,
+							entry->datafile_type,
+							entry->filename );
+
+		entry->write_latency =
+			mx_high_resolution_time_as_double() - start_time;
+
+		mx_mutex_lock( queue->mutex );
+
+		mxp_image_write_queue_recycle_frame( queue, entry->frame );
+
+		entry->frame = NULL;
+
+		queue->frames_pending--;
+		queue->bytes_pending -= entry->num_bytes;
+
+		if ( entry->write_status.code == MXE_SUCCESS ) {
+			queue->frames_written++;
+		} else {
+			queue->write_errors++;
+		}
+
+		queue->last_write_latency = entry->write_latency;
+
+		mxp_image_write_queue_append( &(queue->done_head),
+						&(queue->done_tail), entry );
+
+		(void) mx_condition_variable_broadcast( queue->space_cv );
+	}
+
+	mx_mutex_unlock( queue->mutex );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_image_write_queue_create( MX_IMAGE_WRITE_QUEUE **queue,
+				unsigned long num_threads,
+				uint64_t max_bytes )
+{
+	static const char fname[] = "mx_image_write_queue_create()";
+
+	MX_IMAGE_WRITE_QUEUE *new_queue;
+	unsigned long i;
+	mx_status_type mx_status;
+
+	if ( queue == (MX_IMAGE_WRITE_QUEUE **) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_IMAGE_WRITE_QUEUE pointer passed was NULL." );
+	}
+	if ( num_threads == 0 ) {
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"An image write queue must have at least 1 writer thread." );
+	}
+
+	*queue = NULL;
+
+	new_queue = (MX_IMAGE_WRITE_QUEUE *)
+			calloc( 1, sizeof(MX_IMAGE_WRITE_QUEUE) );
+
+	if ( new_queue == (MX_IMAGE_WRITE_QUEUE *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate an "
+		"MX_IMAGE_WRITE_QUEUE." );
+	}
+
+	new_queue->max_bytes = max_bytes;
+
+	new_queue->thread_array = (MX_THREAD **)
+				calloc( num_threads, sizeof(MX_THREAD *) );
+
+	if ( new_queue->thread_array == (MX_THREAD **) NULL ) {
+		mx_free( new_queue );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a %lu element "
+		"thread array for an image write queue.", num_threads );
+	}
+
+	mx_status = mx_mutex_create( &(new_queue->mutex) );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		(void) mx_image_write_queue_destroy( new_queue );
+		return mx_status;
+	}
+
+	mx_status = mx_condition_variable_create( &(new_queue->work_cv) );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		(void) mx_image_write_queue_destroy( new_queue );
+		return mx_status;
+	}
+
+	mx_status = mx_condition_variable_create( &(new_queue->space_cv) );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		(void) mx_image_write_queue_destroy( new_queue );
+		return mx_status;
+	}
+
+	for ( i = 0; i < num_threads; i++ ) {
+		mx_status = mx_thread_create( &(new_queue->thread_array[i]),
+					mxp_image_write_queue_thread_fn,
+					new_queue );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			(void) mx_image_write_queue_destroy( new_queue );
+			return mx_status;
+		}
+
+		new_queue->num_threads++;
+	}
+
+#if MX_IMAGE_WRITE_QUEUE_DEBUG
+	MX_DEBUG(-2,("%s: created queue %p with %lu threads and "
+		"a limit of %lu bytes.", fname, new_queue,
+		new_queue->num_threads, (unsigned long) max_bytes));
+#endif
+
+	*queue = new_queue;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_image_write_queue_destroy( MX_IMAGE_WRITE_QUEUE *queue )
+{
+	MX_IMAGE_WRITE_QUEUE_ENTRY *entry;
+	unsigned long i;
+
+	if ( queue == (MX_IMAGE_WRITE_QUEUE *) NULL ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	/* The writer threads finish writing all of the pending frames
+	 * before they exit.
+	 */
+
+	if ( queue->mutex != NULL ) {
+		mx_mutex_lock( queue->mutex );
+
+		queue->shutdown = TRUE;
+
+		if ( queue->work_cv != NULL ) {
+			(void) mx_condition_variable_broadcast(queue->work_cv);
+		}
+
+		mx_mutex_unlock( queue->mutex );
+	}
+
+	for ( i = 0; i < queue->num_threads; i++ ) {
+		if ( queue->thread_array[i] != NULL ) {
+			(void) mx_thread_wait( queue->thread_array[i],
+					NULL, MX_THREAD_INFINITE_WAIT );
+
+			(void) mx_thread_free_data_structures(
+					queue->thread_array[i] );
+		}
+	}
+
+	/* If there were no threads, some frames may still be pending. */
+
+	while ( queue->pending_head != NULL ) {
+		entry = mxp_image_write_queue_remove_first(
+						&(queue->pending_head),
+						&(queue->pending_tail) );
+
+		mx_image_free( entry->frame );
+		mx_free( entry );
+	}
+
+	while ( queue->done_head != NULL ) {
+		entry = mxp_image_write_queue_remove_first(
+						&(queue->done_head),
+						&(queue->done_tail) );
+		mx_free( entry );
+	}
+
+	while ( queue->free_entry_list != NULL ) {
+		entry = queue->free_entry_list;
+
+		queue->free_entry_list = entry->next_entry;
+
+		mx_free( entry );
+	}
+
+	for ( i = 0; i < queue->num_free_frames; i++ ) {
+		mx_image_free( queue->free_frame_array[i] );
+	}
+
+	mx_free( queue->free_frame_array );
+
+	if ( queue->space_cv != NULL ) {
+		(void) mx_condition_variable_destroy( queue->space_cv );
+	}
+	if ( queue->work_cv != NULL ) {
+		(void) mx_condition_variable_destroy( queue->work_cv );
+	}
+	if ( queue->mutex != NULL ) {
+		(void) mx_mutex_destroy( queue->mutex );
+	}
+
+	mx_free( queue->thread_array );
+	mx_free( queue );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_image_write_queue_set_max_bytes( MX_IMAGE_WRITE_QUEUE *queue,
+					uint64_t max_bytes )
+{
+	static const char fname[] = "mx_image_write_queue_set_max_bytes()";
+
+	if ( queue == (MX_IMAGE_WRITE_QUEUE *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_IMAGE_WRITE_QUEUE pointer passed was NULL." );
+	}
+
+	mx_mutex_lock( queue->mutex );
+
+	queue->max_bytes = max_bytes;
+
+	/* A larger limit may let a waiting caller proceed. */
+
+	(void) mx_condition_variable_broadcast( queue->space_cv );
+
+	mx_mutex_unlock( queue->mutex );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_image_write_queue_add( MX_IMAGE_WRITE_QUEUE *queue,
+			MX_IMAGE_FRAME *frame,
+			unsigned long datafile_type,
+			char *filename )
+{
+	static const char fname[] = "mx_image_write_queue_add()";
+
+	MX_IMAGE_WRITE_QUEUE_ENTRY *entry;
+	MX_IMAGE_FRAME *queued_frame;
+	uint64_t num_bytes;
+	mx_status_type mx_status;
+
+	if ( queue == (MX_IMAGE_WRITE_QUEUE *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_IMAGE_WRITE_QUEUE pointer passed was NULL." );
+	}
+	if ( frame == (MX_IMAGE_FRAME *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_IMAGE_FRAME pointer passed was NULL." );
+	}
+	if ( filename == (char *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The filename pointer passed was NULL." );
+	}
+
+	num_bytes = frame->header_length + frame->image_length;
+
+	mx_mutex_lock( queue->mutex );
+
+	/* Wait until there is room in the queue for this frame.  A frame
+	 * that is bigger than the limit by itself is let through once the
+	 * queue is empty.
+	 */
+
+	while ( ( queue->bytes_pending > 0 )
+	  && ( ( queue->bytes_pending + num_bytes ) > queue->max_bytes ) )
+	{
+#if MX_IMAGE_WRITE_QUEUE_DEBUG
+		MX_DEBUG(-2,("%s: waiting for %lu bytes to be written.",
+			fname, (unsigned long) queue->bytes_pending));
+#endif
+		(void) mx_condition_variable_wait( queue->space_cv,
+							queue->mutex );
+	}
+
+	/* Reserve room for the frame and take a recycled entry and frame. */
+
+	queue->frames_pending++;
+	queue->bytes_pending += num_bytes;
+
+	entry = queue->free_entry_list;
+
+	if ( entry != (MX_IMAGE_WRITE_QUEUE_ENTRY *) NULL ) {
+		queue->free_entry_list = entry->next_entry;
+	}
+
+	if ( queue->num_free_frames > 0 ) {
+		queue->num_free_frames--;
+
+		queued_frame = queue->free_frame_array[queue->num_free_frames];
+	} else {
+		queued_frame = NULL;
+	}
+
+	mx_mutex_unlock( queue->mutex );
+
+	/* Copy the frame without holding the mutex. */
+
+	if ( entry == (MX_IMAGE_WRITE_QUEUE_ENTRY *) NULL ) {
+		entry = (MX_IMAGE_WRITE_QUEUE_ENTRY *)
+				malloc( sizeof(MX_IMAGE_WRITE_QUEUE_ENTRY) );
+
+		if ( entry == (MX_IMAGE_WRITE_QUEUE_ENTRY *) NULL ) {
+			mx_status = mx_error( MXE_OUT_OF_MEMORY, fname,
+			"Ran out of memory trying to allocate an image "
+			"write queue entry for '%s'.", filename );
+		} else {
+			mx_status = MX_SUCCESSFUL_RESULT;
+		}
+	} else {
+		mx_status = MX_SUCCESSFUL_RESULT;
+	}
+
+	if ( mx_status.code == MXE_SUCCESS ) {
+		mx_status = mx_image_copy_frame( frame, &queued_frame );
+	}
+
+	mx_mutex_lock( queue->mutex );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		queue->frames_pending--;
+		queue->bytes_pending -= num_bytes;
+
+		mxp_image_write_queue_recycle_frame( queue, queued_frame );
+
+		if ( entry != (MX_IMAGE_WRITE_QUEUE_ENTRY *) NULL ) {
+			entry->next_entry = queue->free_entry_list;
+			queue->free_entry_list = entry;
+		}
+
+		(void) mx_condition_variable_broadcast( queue->space_cv );
+
+		mx_mutex_unlock( queue->mutex );
+
+		return mx_status;
+	}
+
+	entry->frame = queued_frame;
+	entry->datafile_type = datafile_type;
+	strlcpy( entry->filename, filename, sizeof(entry->filename) );
+	entry->num_bytes = num_bytes;
+	entry->write_status = MX_SUCCESSFUL_RESULT;
+	entry->write_latency = 0.0;
+
+	mxp_image_write_queue_append( &(queue->pending_head),
+					&(queue->pending_tail), entry );
+
+	(void) mx_condition_variable_signal( queue->work_cv );
+
+	mx_mutex_unlock( queue->mutex );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_image_write_queue_get_result( MX_IMAGE_WRITE_QUEUE *queue,
+				char *filename,
+				size_t max_filename_length,
+				mx_status_type *write_status,
+				mx_bool_type *result_available )
+{
+	static const char fname[] = "mx_image_write_queue_get_result()";
+
+	MX_IMAGE_WRITE_QUEUE_ENTRY *entry;
+
+	if ( queue == (MX_IMAGE_WRITE_QUEUE *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_IMAGE_WRITE_QUEUE pointer passed was NULL." );
+	}
+	if ( result_available == (mx_bool_type *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The result_available pointer passed was NULL." );
+	}
+
+	mx_mutex_lock( queue->mutex );
+
+	entry = mxp_image_write_queue_remove_first( &(queue->done_head),
+						&(queue->done_tail) );
+
+	if ( entry == (MX_IMAGE_WRITE_QUEUE_ENTRY *) NULL ) {
+		mx_mutex_unlock( queue->mutex );
+
+		*result_available = FALSE;
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	*result_available = TRUE;
+
+	if ( filename != (char *) NULL ) {
+		strlcpy( filename, entry->filename, max_filename_length );
+	}
+	if ( write_status != (mx_status_type *) NULL ) {
+		*write_status = entry->write_status;
+	}
+
+	entry->next_entry = queue->free_entry_list;
+	queue->free_entry_list = entry;
+
+	mx_mutex_unlock( queue->mutex );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_image_write_queue_get_status( MX_IMAGE_WRITE_QUEUE *queue,
+				unsigned long *frames_pending,
+				uint64_t *bytes_pending,
+				double *last_write_latency )
+{
+	static const char fname[] = "mx_image_write_queue_get_status()";
+
+	if ( queue == (MX_IMAGE_WRITE_QUEUE *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_IMAGE_WRITE_QUEUE pointer passed was NULL." );
+	}
+
+	mx_mutex_lock( queue->mutex );
+
+	if ( frames_pending != (unsigned long *) NULL ) {
+		*frames_pending = queue->frames_pending;
+	}
+	if ( bytes_pending != (uint64_t *) NULL ) {
+		*bytes_pending = queue->bytes_pending;
+	}
+	if ( last_write_latency != (double *) NULL ) {
+		*last_write_latency = queue->last_write_latency;
+	}
+
+	mx_mutex_unlock( queue->mutex );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_image_write_queue_flush( MX_IMAGE_WRITE_QUEUE *queue )
+{
+	static const char fname[] = "mx_image_write_queue_flush()";
+
+	if ( queue == (MX_IMAGE_WRITE_QUEUE *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_IMAGE_WRITE_QUEUE pointer passed was NULL." );
+	}
+
+	mx_mutex_lock( queue->mutex );
+
+	while ( queue->frames_pending > 0 ) {
+		(void) mx_condition_variable_wait( queue->space_cv,
+							queue->mutex );
+	}
+
+	mx_mutex_unlock( queue->mutex );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
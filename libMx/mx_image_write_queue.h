@@ -0,0 +1,149 @@
+/*
+ * Name:    mx_image_write_queue.h
+ *
+ * Purpose: Header file for MX image write queues.
+ *
+ *          An MX image write queue copies image frames into a set of
+ *          recycled frame buffers and writes them to disk in one or more
+ *          writer threads, so that the thread that reads out the frames
+ *          is not stalled by slow disk or network filesystem writes.
+ *
+ *          The total size of the frames waiting to be written is limited
+ *          by 'max_bytes'.  If adding a frame would exceed that limit,
+ *          mx_image_write_queue_add() waits until enough frames have
+ *          been written.
+ *
+ * Author:  William Lavender
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Copyright 2016 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#ifndef __MX_IMAGE_WRITE_QUEUE_H__
+#define __MX_IMAGE_WRITE_QUEUE_H__
+
+#include "mx_stdint.h"
+#include "mx_thread.h"
+#include "mx_mutex.h"
+#include "mx_condition_variable.h"
+#include "mx_image.h"
+
+/* Make the header file C++ safe. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct mx_image_write_queue_entry_type {
+	MX_IMAGE_FRAME *frame;
+	unsigned long datafile_type;
+	char filename[MXU_FILENAME_LENGTH+1];
+	uint64_t num_bytes;
+
+	mx_status_type write_status;
+	double write_latency;		/* in seconds */
+
+	struct mx_image_write_queue_entry_type *next_entry;
+} MX_IMAGE_WRITE_QUEUE_ENTRY;
+
+typedef struct {
+	unsigned long num_threads;
+	MX_THREAD **thread_array;
+
+	MX_MUTEX *mutex;
+	MX_CONDITION_VARIABLE *work_cv;
+	MX_CONDITION_VARIABLE *space_cv;
+
+	uint64_t max_bytes;
+
+	/* Frames waiting for a writer thread. */
+
+	MX_IMAGE_WRITE_QUEUE_ENTRY *pending_head;
+	MX_IMAGE_WRITE_QUEUE_ENTRY *pending_tail;
+
+	/* Entries for frames that have been written, but whose results
+	 * have not yet been picked up by mx_image_write_queue_get_result().
+	 */
+
+	MX_IMAGE_WRITE_QUEUE_ENTRY *done_head;
+	MX_IMAGE_WRITE_QUEUE_ENTRY *done_tail;
+
+	/* Recycled entries and frame buffers. */
+
+	MX_IMAGE_WRITE_QUEUE_ENTRY *free_entry_list;
+
+	unsigned long num_free_frames;
+	unsigned long free_frame_array_size;
+	MX_IMAGE_FRAME **free_frame_array;
+
+	/* 'frames_pending' and 'bytes_pending' include the frames that
+	 * are currently being written.
+	 */
+
+	unsigned long frames_pending;
+	uint64_t bytes_pending;
+
+	unsigned long frames_written;
+	unsigned long write_errors;
+	double last_write_latency;	/* in seconds */
+
+	mx_bool_type shutdown;
+} MX_IMAGE_WRITE_QUEUE;
+
+MX_API mx_status_type mx_image_write_queue_create(
+					MX_IMAGE_WRITE_QUEUE **queue,
+					unsigned long num_threads,
+					uint64_t max_bytes );
+
+/* mx_image_write_queue_destroy() waits for all pending frames
+ * to be written before it returns.
+ */
+
+MX_API mx_status_type mx_image_write_queue_destroy(
+					MX_IMAGE_WRITE_QUEUE *queue );
+
+MX_API mx_status_type mx_image_write_queue_set_max_bytes(
+					MX_IMAGE_WRITE_QUEUE *queue,
+					uint64_t max_bytes );
+
+/* mx_image_write_queue_add() copies the frame, so the caller may reuse
+ * the original frame as soon as the function returns.
+ */
+
+MX_API mx_status_type mx_image_write_queue_add( MX_IMAGE_WRITE_QUEUE *queue,
+					MX_IMAGE_FRAME *frame,
+					unsigned long datafile_type,
+					char *filename );
+
+/* mx_image_write_queue_get_result() returns the result of the oldest
+ * write whose result has not yet been returned.  If there is no such
+ * write, then *result_available is set to FALSE.
+ */
+
+MX_API mx_status_type mx_image_write_queue_get_result(
+					MX_IMAGE_WRITE_QUEUE *queue,
+					char *filename,
+					size_t max_filename_length,
+					mx_status_type *write_status,
+					mx_bool_type *result_available );
+
+MX_API mx_status_type mx_image_write_queue_get_status(
+					MX_IMAGE_WRITE_QUEUE *queue,
+					unsigned long *frames_pending,
+					uint64_t *bytes_pending,
+					double *last_write_latency );
+
+MX_API mx_status_type mx_image_write_queue_flush(
+					MX_IMAGE_WRITE_QUEUE *queue );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MX_IMAGE_WRITE_QUEUE_H__ */
+
@@ -29,8 +29,10 @@
 #include "mx_util.h"
 #include "mx_record.h"
 #include "mx_driver.h"
+#include "mx_hash_table.h"
 #include "mx_version.h"
 #include "mx_list_head.h"
+#include "mx_metrics.h"
 
 /*----*/
 
@@ -68,6 +70,7 @@ mxr_create_list_head( MX_RECORD *record )
 	MX_RECORD_FIELD *record_field_array;
 	MX_RECORD_FIELD *record_field;
 	MX_RECORD_FIELD_DEFAULTS *record_field_defaults;
+	MX_HASH_TABLE *record_name_index;
 	void *field_data_ptr;
 	long i;
 	size_t cflags_length;
@@ -146,6 +149,20 @@ mxr_create_list_head( MX_RECORD *record )
 		record_field->active = FALSE;
 	}
 
+	/* The list head record is not created by the function
+	 * mx_create_record_from_description(), so we must set up
+	 * its driver pointer and field name index here.
+	 */
+
+	record->driver = mx_get_driver_by_type( MXT_LIST_HEAD );
+
+	if ( record->driver != NULL ) {
+		mx_status = mx_create_field_name_index( record->driver );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
 	/* Fill in the list head structure values by hand. */
 
 	list_head_struct->list_is_active = FALSE;
@@ -185,9 +202,33 @@ mxr_create_list_head( MX_RECORD *record )
 
 	list_head_struct->num_poll_callbacks = 0;
 	list_head_struct->poll_callback_interval = -1;
+	list_head_struct->poll_schedule = NULL;
+	list_head_struct->poll_sweep_interval = MX_DEFAULT_POLL_SWEEP_INTERVAL;
 
 	list_head_struct->module_list = NULL;
 
+	list_head_struct->num_deferred_field_settings = 0;
+	list_head_struct->deferred_field_setting_array = NULL;
+
+	/* The record name index is used by mx_get_record() to find records
+	 * by name.  mx_insert_after_record() and mx_delete_record() keep
+	 * it up to date.  The table grows as records are added to it.
+	 */
+
+	mx_status = mx_hash_table_create( &record_name_index,
+				MXU_RECORD_NAME_LENGTH + 1, 251, NULL );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	list_head_struct->record_name_index = record_name_index;
+
+	mx_status = mx_hash_table_insert_key( record_name_index,
+						record->name, record );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
 	strlcpy( list_head_struct->hostname, "", MXU_HOSTNAME_LENGTH );
 
 	(void) mx_username( list_head_struct->username, MXU_USERNAME_LENGTH );
@@ -207,6 +248,28 @@ mxr_create_list_head( MX_RECORD *record )
 			MX_TOSTRING(MX_CFLAGS), cflags_length );
 	}
 
+	/*--- The metrics text is generated each time it is read. ---*/
+
+	list_head_struct->metrics_enabled = mx_metrics_get_enabled();
+	list_head_struct->metrics_reset = FALSE;
+
+	list_head_struct->metrics = calloc( 1, sizeof(char) );
+
+	list_head_struct->metric_name =
+			calloc( MXU_METRIC_KEY_LENGTH + 1, sizeof(char) );
+
+	list_head_struct->metric_values =
+			calloc( MX_METRICS_NUM_VALUES, sizeof(uint64_t) );
+
+	if ( ( list_head_struct->metrics == NULL )
+	  || ( list_head_struct->metric_name == NULL )
+	  || ( list_head_struct->metric_values == NULL ) )
+	{
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory allocating the metrics fields "
+		"of the list head." );
+	}
+
 	/* Initialize various version strings. */
 
 	strlcpy( list_head_struct->mx_revision_string,
@@ -248,6 +311,9 @@ mxr_list_head_open( MX_RECORD *record )
 	static const char fname[] = "mxr_list_head_open()";
 
 	MX_RECORD_FIELD *cflags_field;
+	MX_RECORD_FIELD *metrics_field;
+	MX_RECORD_FIELD *metric_name_field;
+	MX_RECORD_FIELD *metric_values_field;
 	MX_LIST_HEAD *list_head_struct;
 	mx_status_type mx_status;
 
@@ -274,6 +340,31 @@ mxr_list_head_open( MX_RECORD *record )
 
 	cflags_field->dimension[0] = strlen( list_head_struct->cflags ) + 1;
 
+	/* The 'metrics' field is resized each time that it is read. */
+
+	mx_status = mx_find_record_field( record, "metrics", &metrics_field );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	metrics_field->dimension[0] = 1;
+
+	mx_status = mx_find_record_field( record, "metric_name",
+						&metric_name_field );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	metric_name_field->dimension[0] = MXU_METRIC_KEY_LENGTH + 1;
+
+	mx_status = mx_find_record_field( record, "metric_values",
+						&metric_values_field );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	metric_values_field->dimension[0] = MX_METRICS_NUM_VALUES;
+
 	return MX_SUCCESSFUL_RESULT;
 }
 
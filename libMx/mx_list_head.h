@@ -51,6 +51,11 @@ extern "C" {
 #define MXLV_LHD_REVISION_STRING		1023
 #define MXLV_LHD_BRANCH_LABEL			1024
 #define MXLV_LHD_VERSION_STRING			1025
+#define MXLV_LHD_METRICS_ENABLED		1026
+#define MXLV_LHD_METRICS_RESET			1027
+#define MXLV_LHD_METRICS			1028
+#define MXLV_LHD_METRIC_NAME			1029
+#define MXLV_LHD_METRIC_VALUES			1030
 
 #define MXR_LIST_HEAD_STANDARD_FIELDS \
   {-1, -1, "list_is_active", MXFT_BOOL, NULL, 0, {0}, \
@@ -194,7 +199,27 @@ extern "C" {
   {MXLV_LHD_VERSION_STRING, -1, "mx_version_string", \
 		MXFT_STRING, NULL, 1, {MXU_REVISION_NAME_LENGTH}, \
 	MXF_REC_SUPERCLASS_STRUCT, offsetof(MX_LIST_HEAD, mx_version_string), \
-	{sizeof(char)}, NULL, MXFF_READ_ONLY}
+	{sizeof(char)}, NULL, MXFF_READ_ONLY}, \
+  \
+  {MXLV_LHD_METRICS_ENABLED, -1, "metrics_enabled", MXFT_BOOL, NULL, 0, {0}, \
+	MXF_REC_SUPERCLASS_STRUCT, offsetof(MX_LIST_HEAD, metrics_enabled), \
+	{0}, NULL, 0}, \
+  \
+  {MXLV_LHD_METRICS_RESET, -1, "metrics_reset", MXFT_BOOL, NULL, 0, {0}, \
+	MXF_REC_SUPERCLASS_STRUCT, offsetof(MX_LIST_HEAD, metrics_reset), \
+	{0}, NULL, 0}, \
+  \
+  {MXLV_LHD_METRICS, -1, "metrics", MXFT_STRING, NULL, 1, {0}, \
+	MXF_REC_SUPERCLASS_STRUCT, offsetof(MX_LIST_HEAD, metrics), \
+	{sizeof(char)}, NULL, (MXFF_VARARGS|MXFF_READ_ONLY) }, \
+  \
+  {MXLV_LHD_METRIC_NAME, -1, "metric_name", MXFT_STRING, NULL, 1, {0}, \
+	MXF_REC_SUPERCLASS_STRUCT, offsetof(MX_LIST_HEAD, metric_name), \
+	{sizeof(char)}, NULL, MXFF_VARARGS }, \
+  \
+  {MXLV_LHD_METRIC_VALUES, -1, "metric_values", MXFT_UINT64, NULL, 1, {0}, \
+	MXF_REC_SUPERCLASS_STRUCT, offsetof(MX_LIST_HEAD, metric_values), \
+	{sizeof(uint64_t)}, NULL, (MXFF_VARARGS|MXFF_READ_ONLY) }
 
 MX_API_PRIVATE mx_status_type mxr_create_list_head( MX_RECORD *record );
 
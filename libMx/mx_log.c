@@ -24,11 +24,625 @@
 
 #include "mx_util.h"
 #include "mx_time.h"
+#include "mx_hrt.h"
 #include "mx_unistd.h"
+#include "mx_stdint.h"
+#include "mx_atomic.h"
+#include "mx_mutex.h"
+#include "mx_thread.h"
 #include "mx_record.h"
 #include "mx_variable.h"
 #include "mx_log.h"
 
+#if defined(OS_WIN32)
+#  include <io.h>
+#  define mxp_log_fsync(fd)	_commit(fd)
+#else
+#  define mxp_log_fsync(fd)	fsync(fd)
+#endif
+
+/*---------------------------------------------------------------------------*/
+
+/* Buffered log files.
+ *
+ * Messages are copied into a ring buffer by mx_log_message() and written
+ * to the log file by a background thread.  ring_head and ring_tail are
+ * free running byte counters.  Only the threads calling mx_log_message()
+ * change ring_head and they are serialized by producer_mutex, which is
+ * held just long enough to copy the message into the ring.  Only the
+ * writer thread changes ring_tail.  The writer thread never takes a lock,
+ * so a slow file system cannot delay the callers of mx_log_message().
+ * If the log file cannot be opened, the writer thread discards the
+ * pending messages and counts them as dropped, so that the ring never
+ * stays full.
+ *
+ * The writer thread polls the ring rather than waiting for a signal,
+ * so that mx_log_message() does not have to make any system calls.
+ */
+
+#define MXP_LOG_MAX_LINE_LENGTH		2500
+#define MXP_LOG_MAX_POLL_MS		50
+#define MXP_LOG_MAX_WRITE_LENGTH	65536
+#define MXP_LOG_MAX_FULL_WAIT_MS	1000
+
+typedef struct {
+	MX_LOG *log_handler;
+	MX_THREAD *thread;
+	MX_MUTEX *producer_mutex;
+
+	char *ring;
+	uint32_t ring_size;
+	int32_t ring_head;
+	int32_t ring_tail;
+	int32_t dropped_messages;
+	int32_t shutdown;
+
+	uint32_t flush_bytes;
+	double flush_interval;
+	unsigned long poll_ms;
+
+	uint64_t rotate_size;
+	mx_bool_type rotate_daily;
+
+	int fd;
+	uint64_t file_size;
+	long file_day;
+	unsigned long write_errors;
+} MXP_BUFFERED_LOG;
+
+static long
+mxp_log_current_day( struct tm *tm_ptr )
+{
+	return ( 1000L * (long) tm_ptr->tm_year ) + (long) tm_ptr->tm_yday;
+}
+
+static void
+mxp_log_buffered_write( MXP_BUFFERED_LOG *blog, char *data, size_t length )
+{
+	long bytes_written;
+
+	while ( length > 0 ) {
+		bytes_written = write( blog->fd, data, length );
+
+		if ( bytes_written < 0 ) {
+			if ( errno == EINTR )
+				continue;
+
+			blog->write_errors++;
+			return;
+		}
+
+		data += bytes_written;
+		length -= bytes_written;
+
+		blog->file_size += bytes_written;
+	}
+}
+
+/* mxp_log_buffered_reopen() is used after a rotation and by each drain
+ * for as long as the log file is not open.
+ */
+
+static void
+mxp_log_buffered_reopen( MXP_BUFFERED_LOG *blog )
+{
+	off_t file_size;
+
+	blog->fd = open( blog->log_handler->log_name,
+				O_WRONLY | O_CREAT | O_APPEND, 0644 );
+
+	if ( blog->fd < 0 ) {
+		blog->write_errors++;
+		blog->file_size = 0;
+		return;
+	}
+
+	file_size = lseek( blog->fd, 0, SEEK_END );
+
+	if ( file_size < 0 ) {
+		file_size = 0;
+	}
+
+	blog->file_size = (uint64_t) file_size;
+}
+
+/* mxp_log_buffered_discard() throws away the pending messages when there
+ * is no log file to write them to.
+ */
+
+static void
+mxp_log_buffered_discard( MXP_BUFFERED_LOG *blog,
+			uint32_t tail, uint32_t pending )
+{
+	uint32_t i;
+	int32_t num_lines;
+
+	num_lines = 0;
+
+	for ( i = 0; i < pending; i++ ) {
+		if ( blog->ring[ (tail + i) & ( blog->ring_size - 1 ) ]
+								== '\n' )
+		{
+			num_lines++;
+		}
+	}
+
+	(void) mx_atomic_add32( &(blog->dropped_messages), num_lines );
+
+	/* Release the space to mx_log_message(). */
+
+	(void) mx_atomic_add32( &(blog->ring_tail), (int32_t) pending );
+}
+
+static void
+mxp_log_buffered_rotate( MXP_BUFFERED_LOG *blog, struct tm *tm_ptr )
+{
+	char rotated_name[ MXU_FILENAME_LENGTH + 80 ];
+	char suffix[40];
+	char *log_name;
+	int i;
+
+	log_name = blog->log_handler->log_name;
+
+	strftime( suffix, sizeof(suffix), "%Y%m%d-%H%M%S", tm_ptr );
+
+	snprintf( rotated_name, sizeof(rotated_name),
+			"%s.%s", log_name, suffix );
+
+	/* Do not overwrite a file from an earlier rotation in the
+	 * same second.
+	 */
+
+	for ( i = 1;
+	    ( i < 1000 ) && ( access( rotated_name, F_OK ) == 0 ); i++ )
+	{
+		snprintf( rotated_name, sizeof(rotated_name),
+				"%s.%s.%d", log_name, suffix, i );
+	}
+
+	if ( blog->fd >= 0 ) {
+		(void) mxp_log_fsync( blog->fd );
+		(void) close( blog->fd );
+	}
+
+	(void) rename( log_name, rotated_name );
+
+	blog->fd = -1;
+
+	mxp_log_buffered_reopen( blog );
+}
+
+static void
+mxp_log_buffered_drain( MXP_BUFFERED_LOG *blog )
+{
+	char dropped_message[ MXU_USERNAME_LENGTH + 120 ];
+	char timestamp[ MXU_USERNAME_LENGTH + 40 ];
+	time_t time_struct;
+	struct tm current_time;
+	uint32_t head, tail, pending, offset, chunk, i;
+	int32_t num_dropped;
+	mx_bool_type at_line_start;
+
+	time( &time_struct );
+
+	(void) localtime_r( &time_struct, &current_time );
+
+	if ( ( blog->rotate_daily )
+	  && ( mxp_log_current_day( &current_time ) != blog->file_day ) )
+	{
+		mxp_log_buffered_rotate( blog, &current_time );
+	}
+
+	blog->file_day = mxp_log_current_day( &current_time );
+
+	if ( blog->fd < 0 ) {
+		mxp_log_buffered_reopen( blog );
+	}
+
+	head = (uint32_t) mx_atomic_read32( &(blog->ring_head) );
+	tail = (uint32_t) mx_atomic_read32( &(blog->ring_tail) );
+
+	pending = head - tail;
+
+	at_line_start = TRUE;
+
+	while ( pending > 0 ) {
+
+		/* Size based rotation is only done between lines, so that
+		 * a message is never split between two files.
+		 */
+
+		if ( at_line_start && ( blog->rotate_size > 0 )
+		  && ( blog->file_size >= blog->rotate_size ) )
+		{
+			mxp_log_buffered_rotate( blog, &current_time );
+		}
+
+		if ( blog->fd < 0 ) {
+			mxp_log_buffered_discard( blog, tail, pending );
+			return;
+		}
+
+		offset = tail & ( blog->ring_size - 1 );
+
+		chunk = blog->ring_size - offset;
+
+		if ( chunk > pending ) {
+			chunk = pending;
+		}
+
+		/* Write at most MXP_LOG_MAX_WRITE_LENGTH bytes at a time,
+		 * ending at a line boundary if possible.
+		 */
+
+		if ( chunk > MXP_LOG_MAX_WRITE_LENGTH ) {
+			chunk = MXP_LOG_MAX_WRITE_LENGTH;
+
+			for ( i = chunk; i > 0; i-- ) {
+				if ( blog->ring[ offset + i - 1 ] == '\n' )
+					break;
+			}
+
+			if ( i > 0 ) {
+				chunk = i;
+			}
+		}
+
+		mxp_log_buffered_write( blog, blog->ring + offset, chunk );
+
+		at_line_start = ( blog->ring[ offset + chunk - 1 ] == '\n' );
+
+		tail += chunk;
+		pending -= chunk;
+
+		/* Release the space to mx_log_message(). */
+
+		(void) mx_atomic_add32( &(blog->ring_tail), (int32_t) chunk );
+	}
+
+	num_dropped = mx_atomic_read32( &(blog->dropped_messages) );
+
+	if ( ( num_dropped > 0 ) && ( blog->fd >= 0 ) ) {
+		(void) mx_atomic_add32( &(blog->dropped_messages),
+							- num_dropped );
+
+		snprintf( dropped_message, sizeof(dropped_message),
+			"%s  %ld log messages were dropped because "
+			"the log buffer was full or the log file "
+			"could not be written.\n",
+			mx_log_timestamp( blog->log_handler,
+					timestamp, sizeof(timestamp) ),
+			(long) num_dropped );
+
+		mxp_log_buffered_write( blog, dropped_message,
+					strlen(dropped_message) );
+	}
+}
+
+static mx_status_type
+mxp_log_buffered_thread_fn( MX_THREAD *thread, void *args )
+{
+	MXP_BUFFERED_LOG *blog;
+	uint32_t pending;
+	double current_time, last_flush_time;
+	mx_bool_type shutdown;
+
+	blog = (MXP_BUFFERED_LOG *) args;
+
+	last_flush_time = mx_high_resolution_time_as_double();
+
+	for (;;) {
+		shutdown = mx_atomic_read32( &(blog->shutdown) );
+
+		pending = (uint32_t) mx_atomic_read32( &(blog->ring_head) )
+			- (uint32_t) mx_atomic_read32( &(blog->ring_tail) );
+
+		current_time = mx_high_resolution_time_as_double();
+
+		if ( shutdown
+		  || ( pending >= blog->flush_bytes )
+		  || ( (pending > 0)
+		    && (current_time - last_flush_time >= blog->flush_interval)))
+		{
+			mxp_log_buffered_drain( blog );
+
+			last_flush_time = current_time;
+		}
+
+		if ( shutdown ) {
+			break;
+		}
+
+		mx_msleep( blog->poll_ms );
+	}
+
+	if ( blog->fd >= 0 ) {
+		(void) mxp_log_fsync( blog->fd );
+		(void) close( blog->fd );
+
+		blog->fd = -1;
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+static void
+mxp_log_buffered_free( MXP_BUFFERED_LOG *blog )
+{
+	if ( blog == (MXP_BUFFERED_LOG *) NULL )
+		return;
+
+	if ( blog->fd >= 0 ) {
+		(void) close( blog->fd );
+	}
+
+	if ( blog->producer_mutex != (MX_MUTEX *) NULL ) {
+		(void) mx_mutex_destroy( blog->producer_mutex );
+	}
+
+	mx_free( blog->ring );
+
+	free( blog );
+}
+
+static mx_status_type
+mxp_log_buffered_open( MX_LOG *log_handler, char *options )
+{
+	static const char fname[] = "mxp_log_buffered_open()";
+
+	MXP_BUFFERED_LOG *blog;
+	char **argv;
+	int i, argc, saved_errno;
+	unsigned long ring_size;
+	time_t time_struct;
+	struct tm current_time;
+	mx_status_type mx_status;
+
+	blog = (MXP_BUFFERED_LOG *) calloc( 1, sizeof(MXP_BUFFERED_LOG) );
+
+	if ( blog == (MXP_BUFFERED_LOG *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate the buffered log "
+		"state for MX log file '%s'.", log_handler->log_name );
+	}
+
+	blog->log_handler = log_handler;
+	blog->fd = -1;
+	blog->flush_bytes = MX_LOG_DEFAULT_FLUSH_BYTES;
+	blog->flush_interval = MX_LOG_DEFAULT_FLUSH_INTERVAL;
+	blog->rotate_size = 0;
+	blog->rotate_daily = FALSE;
+
+	ring_size = MX_LOG_DEFAULT_RING_SIZE;
+
+	/* Parse the options. */
+
+	mx_status = MX_SUCCESSFUL_RESULT;
+
+	argv = NULL;
+
+	if ( mx_string_split( options, " \t", &argc, &argv ) != 0 ) {
+		argc = 0;
+	}
+
+	for ( i = 0; i < argc; i++ ) {
+		if ( strncmp( argv[i], "flush_bytes=", 12 ) == 0 ) {
+			blog->flush_bytes = strtoul( argv[i] + 12, NULL, 0 );
+		} else
+		if ( strncmp( argv[i], "flush_interval=", 15 ) == 0 ) {
+			blog->flush_interval = atof( argv[i] + 15 );
+		} else
+		if ( strncmp( argv[i], "ring_size=", 10 ) == 0 ) {
+			ring_size = strtoul( argv[i] + 10, NULL, 0 );
+		} else
+		if ( strncmp( argv[i], "rotate_size=", 12 ) == 0 ) {
+			blog->rotate_size = strtoul( argv[i] + 12, NULL, 0 );
+		} else
+		if ( strcmp( argv[i], "rotate_daily" ) == 0 ) {
+			blog->rotate_daily = TRUE;
+		} else {
+			mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+			"Unrecognized option '%s' for MX log file '%s'.",
+				argv[i], log_handler->log_name );
+			break;
+		}
+	}
+
+	mx_free( argv );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mxp_log_buffered_free( blog );
+		return mx_status;
+	}
+
+	/* The ring size must be a power of two that is big enough
+	 * for at least one maximum length line.
+	 */
+
+	blog->ring_size = 4096;
+
+	while ( ( blog->ring_size < ring_size )
+	  && ( blog->ring_size < 0x40000000 ) )
+	{
+		blog->ring_size *= 2;
+	}
+
+	if ( blog->flush_bytes > blog->ring_size / 2 ) {
+		blog->flush_bytes = blog->ring_size / 2;
+	}
+
+	if ( blog->flush_interval <= 0.0 ) {
+		blog->flush_interval = MX_LOG_DEFAULT_FLUSH_INTERVAL;
+	}
+
+	blog->poll_ms = mx_round( 250.0 * blog->flush_interval );
+
+	if ( blog->poll_ms > MXP_LOG_MAX_POLL_MS ) {
+		blog->poll_ms = MXP_LOG_MAX_POLL_MS;
+	} else
+	if ( blog->poll_ms < 1 ) {
+		blog->poll_ms = 1;
+	}
+
+	blog->ring = (char *) malloc( blog->ring_size );
+
+	if ( blog->ring == (char *) NULL ) {
+		mxp_log_buffered_free( blog );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a %lu byte ring buffer "
+		"for MX log file '%s'.", (unsigned long) blog->ring_size,
+			log_handler->log_name );
+	}
+
+	mx_status = mx_mutex_create( &(blog->producer_mutex) );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mxp_log_buffered_free( blog );
+		return mx_status;
+	}
+
+	/* Open the log file once and keep it open. */
+
+	blog->fd = open( log_handler->log_name, O_WRONLY | O_APPEND );
+
+	if ( blog->fd < 0 ) {
+		saved_errno = errno;
+
+		mxp_log_buffered_free( blog );
+
+		return mx_error( MXE_FILE_IO_ERROR, fname,
+			"Unable to open MX log file '%s'.  Error code = %d, "
+			"error text = '%s'", log_handler->log_name,
+			saved_errno, strerror( saved_errno ) );
+	}
+
+	blog->file_size = lseek( blog->fd, 0, SEEK_END );
+
+	time( &time_struct );
+
+	(void) localtime_r( &time_struct, &current_time );
+
+	blog->file_day = mxp_log_current_day( &current_time );
+
+	mx_status = mx_thread_create( &(blog->thread),
+				mxp_log_buffered_thread_fn, blog );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mxp_log_buffered_free( blog );
+		return mx_status;
+	}
+
+	log_handler->buffered_log = blog;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+static void
+mxp_log_buffered_close( MX_LOG *log_handler )
+{
+	MXP_BUFFERED_LOG *blog;
+
+	blog = (MXP_BUFFERED_LOG *) log_handler->buffered_log;
+
+	if ( blog == (MXP_BUFFERED_LOG *) NULL )
+		return;
+
+	/* The writer thread writes out everything still in the ring
+	 * and calls fsync() before it exits.
+	 */
+
+	(void) mx_atomic_add32( &(blog->shutdown), 1 );
+
+	(void) mx_thread_wait( blog->thread, NULL, MX_THREAD_INFINITE_WAIT );
+
+	(void) mx_thread_free_data_structures( blog->thread );
+
+	mxp_log_buffered_free( blog );
+
+	log_handler->buffered_log = NULL;
+}
+
+static mx_status_type
+mxp_log_buffered_message( MX_LOG *log_handler, char *message )
+{
+	MXP_BUFFERED_LOG *blog;
+	char line[ MXP_LOG_MAX_LINE_LENGTH ];
+	char buffer[ MXU_USERNAME_LENGTH + 40 ];
+	uint32_t head, tail, length, offset, chunk;
+	unsigned long ms_waited;
+
+	blog = (MXP_BUFFERED_LOG *) log_handler->buffered_log;
+
+	snprintf( line, sizeof(line), "%s  %s\n",
+		mx_log_timestamp( log_handler, buffer, sizeof(buffer) ),
+		message );
+
+	length = strlen( line );
+
+	/* Keep the newline at the end of a truncated line. */
+
+	if ( line[length - 1] != '\n' ) {
+		line[length - 1] = '\n';
+	}
+
+	/* If the ring is full, give the writer thread a chance to catch
+	 * up before giving up on the message.  We do not hold the mutex
+	 * while we wait, so other threads can still log if their
+	 * messages fit.
+	 */
+
+	ms_waited = 0;
+
+	for (;;) {
+		mx_mutex_lock( blog->producer_mutex );
+
+		head = (uint32_t) blog->ring_head;
+		tail = (uint32_t) mx_atomic_read32( &(blog->ring_tail) );
+
+		if ( length <= blog->ring_size - ( head - tail ) ) {
+			break;
+		}
+
+		mx_mutex_unlock( blog->producer_mutex );
+
+		if ( ms_waited >= MXP_LOG_MAX_FULL_WAIT_MS ) {
+			(void) mx_atomic_increment32(
+					&(blog->dropped_messages) );
+
+			return MX_SUCCESSFUL_RESULT;
+		}
+
+		mx_msleep( 1 );
+
+		ms_waited++;
+	}
+
+	offset = head & ( blog->ring_size - 1 );
+
+	chunk = blog->ring_size - offset;
+
+	if ( chunk > length ) {
+		chunk = length;
+	}
+
+	memcpy( blog->ring + offset, line, chunk );
+
+	if ( chunk < length ) {
+		memcpy( blog->ring, line + chunk, length - chunk );
+	}
+
+	/* Publish the message to the writer thread. */
+
+	(void) mx_atomic_add32( &(blog->ring_head), (int32_t) length );
+
+	mx_mutex_unlock( blog->producer_mutex );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*---------------------------------------------------------------------------*/
+
 MX_EXPORT mx_status_type
 mx_log_open( MX_RECORD *record_list )
 {
@@ -90,9 +704,12 @@ mx_log_open( MX_RECORD *record_list )
 			log_control_string, MX_LOG_RECORD_NAME );
 	}
 
-	if ( strcmp( log_type, "file" ) != 0 ) {
+	if ( ( strcmp( log_type, "file" ) != 0 )
+	  && ( strcmp( log_type, "buffered" ) != 0 ) )
+	{
 		return mx_error( MXE_NOT_YET_IMPLEMENTED, fname,
-	"Only logging to files via log type 'file' is currently supported." );
+		"Only logging to files via log types 'file' and 'buffered' "
+		"is currently supported." );
 	}
 
 	/* See if we can write to the log file.  We don't actually
@@ -148,6 +765,26 @@ mx_log_open( MX_RECORD *record_list )
 
 	strlcpy( log_handler->log_name, log_name, MXU_FILENAME_LENGTH + 1 );
 
+	log_handler->buffered_log = NULL;
+
+	log_handler->list_head = list_head;
+
+	/* Buffered logs take their options from the rest of the
+	 * log control string.
+	 */
+
+	if ( strcmp( log_type, "buffered" ) == 0 ) {
+		log_handler->log_type = MXLT_BUFFERED_FILE;
+
+		mx_status = mxp_log_buffered_open( log_handler,
+			mx_skip_string_fields( log_control_string, 2 ) );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			mx_free( log_handler );
+			return mx_status;
+		}
+	}
+
 	list_head->log_handler = log_handler;
 
 	/* Finally, add a back pointer from the log structure to the
@@ -165,6 +802,7 @@ mx_log_close( MX_RECORD *record_list )
 	static const char fname[] = "mx_log_close()";
 
 	MX_LIST_HEAD *list_head;
+	MX_LOG *log_handler;
 
 	/* Find the record list head structure so that we can see if
 	 * a log file is currently active.
@@ -179,12 +817,20 @@ mx_log_close( MX_RECORD *record_list )
 
 	/* The log file is active if the 'log_handler' pointer is not NULL. */
 
-	if ( list_head->log_handler != NULL ) {
-		free( list_head->log_handler );
-	}
+	log_handler = (MX_LOG *) list_head->log_handler;
+
+	/* Make sure that no new messages are logged while we shut down. */
 
 	list_head->log_handler = NULL;
 
+	if ( log_handler != (MX_LOG *) NULL ) {
+		if ( log_handler->log_type == MXLT_BUFFERED_FILE ) {
+			mxp_log_buffered_close( log_handler );
+		}
+
+		free( log_handler );
+	}
+
 	return MX_SUCCESSFUL_RESULT;
 }
 
@@ -199,6 +845,10 @@ mx_log_message( MX_LOG *log_handler, char *message )
 
 	/* At present we only handle logging to a file. */
 
+	if ( log_handler->log_type == MXLT_BUFFERED_FILE ) {
+		return mxp_log_buffered_message( log_handler, message );
+	}
+
 	/* Open the logfile for exclusive access.  Please note that
 	 * this is not likely to work correctly for a file accessed
 	 * via NFS.
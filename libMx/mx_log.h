@@ -28,6 +28,12 @@ typedef struct {
 
 	int  log_type;
 	char log_name[ MXU_FILENAME_LENGTH + 1 ];
+
+	/* For MXLT_BUFFERED_FILE logs, buffered_log points to the
+	 * private state of the buffered log writer in mx_log.c.
+	 */
+
+	void *buffered_log;
 } MX_LOG;
 
 /* A 1-D string variable record with the following name must exist
@@ -38,7 +44,31 @@ typedef struct {
 
 /* Log types */
 
-#define MXLT_FILE	1
+#define MXLT_FILE		1
+#define MXLT_BUFFERED_FILE	2
+
+/* A 'file' log opens, writes and closes the log file for every message.
+ *
+ * A 'buffered' log keeps the log file open.  mx_log_message() copies the
+ * formatted message into a ring buffer and a background thread writes
+ * the contents of the ring to the file.  The log control string for a
+ * buffered log may be followed by any of these options:
+ *
+ *   flush_bytes=N       Write when at least N bytes are waiting.
+ *   flush_interval=S    Write messages that have waited S seconds.
+ *   ring_size=N         Size in bytes of the ring buffer.
+ *   rotate_size=N       Rename the log file when it reaches N bytes.
+ *   rotate_daily        Rename the log file when the date changes.
+ *
+ * Rotated log files are renamed to the log file name followed by the
+ * date and time of the rotation.  If the ring buffer stays full for
+ * a second, messages are dropped and a count of the dropped messages
+ * is written to the log file later.
+ */
+
+#define MX_LOG_DEFAULT_FLUSH_BYTES	16384
+#define MX_LOG_DEFAULT_FLUSH_INTERVAL	1.0
+#define MX_LOG_DEFAULT_RING_SIZE	1048576
 
 MX_API mx_status_type mx_log_open( MX_RECORD *record_list );
 
@@ -16,6 +16,8 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 
 #include "mx_util.h"
@@ -37,6 +39,7 @@
 #include "mx_variable.h"
 #include "mx_scan.h"
 #include "mx_operation.h"
+#include "mx_thread_pool.h"
 
 #include "mx_measurement.h"
 
@@ -56,6 +59,8 @@ MX_MEASUREMENT_TYPE_ENTRY mx_measurement_type_list[] = {
 	{ -1, "", NULL }
 };
 
+static void mxp_destroy_readout_plan( void *plan_ptr );
+
 /* --------------- */
 
 MX_EXPORT mx_status_type mx_get_measurement_type_by_name( 
@@ -206,6 +211,14 @@ mx_configure_measurement_type( MX_MEASUREMENT *measurement )
 
 	measurement->measurement_type_struct = NULL;
 
+	/* Discard any readout plan left over from a previous scan. */
+
+	if ( measurement->readout_plan != NULL ) {
+		mxp_destroy_readout_plan( measurement->readout_plan );
+
+		measurement->readout_plan = NULL;
+	}
+
 	/* Now invoke the configure function. */
 
 	fptr = flist->configure;
@@ -237,6 +250,12 @@ mx_deconfigure_measurement_type( MX_MEASUREMENT *measurement )
 			"MX_MEASUREMENT pointer passed was NULL.");
 	}
 
+	if ( measurement->readout_plan != NULL ) {
+		mxp_destroy_readout_plan( measurement->readout_plan );
+
+		measurement->readout_plan = NULL;
+	}
+
 	flist = (MX_MEASUREMENT_FUNCTION_LIST *)
 			(measurement->measurement_function_list);
 
@@ -415,177 +434,656 @@ mx_acquire_data( MX_MEASUREMENT *measurement )
 	return mx_status;
 }
 
-MX_EXPORT mx_status_type
-mx_readout_data( MX_MEASUREMENT *measurement )
+/* mxp_readout_input_device() reads out a single scan input device.
+ * If *end_of_readout is set to TRUE on return, no further devices
+ * should be read for this measurement.
+ */
+
+static mx_status_type
+mxp_readout_input_device( MX_RECORD *input_device,
+			mx_bool_type *end_of_readout )
 {
-	static const char fname[] = "mx_readout_data()";
+	static const char fname[] = "mxp_readout_input_device()";
 
-	MX_SCAN *scan;
-	MX_RECORD **input_device_array;
-	MX_RECORD *input_device;
 	MX_SCALER *scaler;
 	MX_AREA_DETECTOR *ad;
 	double double_value;
 	long long_value;
 	unsigned long ulong_value;
-	long i;
 	mx_status_type mx_status;
 
-	scan = (MX_SCAN *) measurement->scan;
+	*end_of_readout = FALSE;
 
-	if ( scan == (MX_SCAN *) NULL ) {
-		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
-		"MX_SCAN pointer for measurement pointer %p is NULL.",
-			measurement );
-	}
+	switch ( input_device->mx_superclass ) {
+	case MXR_VARIABLE:
+		mx_status = mx_receive_variable( input_device );
 
-	input_device_array = scan->input_device_array;
+		if ( mx_status.code != MXE_SUCCESS ) {
+			return mx_status;
+		}
+		break;
 
-	if ( input_device_array == (MX_RECORD **) NULL ) {
-		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
-		"input_device_array pointer for scan record '%s' is NULL.",
-			scan->record->name );
-	}
+	case MXR_OPERATION:
+		mx_status = mx_operation_get_status( input_device,
+							&ulong_value );
+		break;
 
-	/* Read out and save the values from the input devices. */
+	case MXR_DEVICE:
+		switch( input_device->mx_class ) {
+		case MXC_ANALOG_INPUT:
+			mx_status = mx_analog_input_read(
+					input_device, &double_value );
+			if ( mx_status.code != MXE_SUCCESS ) {
+				return mx_status;
+			}
+			break;
+		case MXC_ANALOG_OUTPUT:
+			mx_status = mx_analog_output_read(
+					input_device, &double_value );
+			if ( mx_status.code != MXE_SUCCESS ) {
+				return mx_status;
+			}
+			break;
+		case MXC_DIGITAL_INPUT:
+			mx_status = mx_digital_input_read(
+					input_device, &ulong_value );
+			if ( mx_status.code != MXE_SUCCESS ) {
+				return mx_status;
+			}
+			break;
+		case MXC_DIGITAL_OUTPUT:
+			mx_status = mx_digital_output_read(
+					input_device, &ulong_value );
+			if ( mx_status.code != MXE_SUCCESS ) {
+				return mx_status;
+			}
+			break;
+		case MXC_MOTOR:
+			mx_status = mx_motor_get_position(
+					input_device, &double_value );
+			if ( mx_status.code != MXE_SUCCESS ) {
+				return mx_status;
+			}
+			break;
+		case MXC_SCALER:
+			mx_status = mx_scaler_read(
+					input_device, &long_value );
+			if ( mx_status.code != MXE_SUCCESS ) {
+				return mx_status;
+			}
+			scaler = (MX_SCALER *)
+				(input_device->record_class_struct);
 
-	for ( i = 0; i < scan->num_input_devices; i++ ) {
-		input_device = input_device_array[i];
+			scaler->value = long_value;
+			break;
+		case MXC_TIMER:
+			mx_status = mx_timer_read(
+					input_device, &double_value );
 
-		switch ( input_device->mx_superclass ) {
-		case MXR_VARIABLE:
-			mx_status = mx_receive_variable( input_device );
+			if ( mx_status.code != MXE_SUCCESS ) {
+				return mx_status;
+			}
+			break;
+		case MXC_AMPLIFIER:
+			mx_status = mx_amplifier_get_gain(
+					input_device, &double_value );
 
 			if ( mx_status.code != MXE_SUCCESS ) {
 				return mx_status;
 			}
 			break;
+		case MXC_RELAY:
+			mx_status = mx_get_relay_status(
+					input_device, NULL );
 
-		case MXR_OPERATION:
-			mx_status = mx_operation_get_status( input_device,
-								&ulong_value );
+			if ( mx_status.code != MXE_SUCCESS ) {
+				return mx_status;
+			}
 			break;
+		case MXC_MULTICHANNEL_ANALYZER:
+			mx_status = mx_mca_read( input_device,
+							NULL, NULL);
 
-		case MXR_DEVICE:
-			switch( input_device->mx_class ) {
-			case MXC_ANALOG_INPUT:
-				mx_status = mx_analog_input_read(
-						input_device, &double_value );
-				if ( mx_status.code != MXE_SUCCESS ) {
-					return mx_status;
-				}
-				break;
-			case MXC_ANALOG_OUTPUT:
-				mx_status = mx_analog_output_read(
-						input_device, &double_value );
-				if ( mx_status.code != MXE_SUCCESS ) {
-					return mx_status;
-				}
-				break;
-			case MXC_DIGITAL_INPUT:
-				mx_status = mx_digital_input_read(
-						input_device, &ulong_value );
-				if ( mx_status.code != MXE_SUCCESS ) {
-					return mx_status;
-				}
-				break;
-			case MXC_DIGITAL_OUTPUT:
-				mx_status = mx_digital_output_read(
-						input_device, &ulong_value );
-				if ( mx_status.code != MXE_SUCCESS ) {
-					return mx_status;
-				}
-				break;
-			case MXC_MOTOR:
-				mx_status = mx_motor_get_position(
-						input_device, &double_value );
-				if ( mx_status.code != MXE_SUCCESS ) {
-					return mx_status;
-				}
-				break;
-			case MXC_SCALER:
-				mx_status = mx_scaler_read(
-						input_device, &long_value );
-				if ( mx_status.code != MXE_SUCCESS ) {
-					return mx_status;
-				}
-				scaler = (MX_SCALER *)
-					(input_device->record_class_struct);
+			if ( mx_status.code != MXE_SUCCESS ) {
+				return mx_status;
+			}
+			break;
+		case MXC_AREA_DETECTOR:
+			ad = input_device->record_class_struct;
+
+			if ( ad == (MX_AREA_DETECTOR *) NULL ) {
+				return mx_error(
+				MXE_CORRUPT_DATA_STRUCTURE, fname,
+				"The MX_AREA_DETECTOR pointer for "
+				"input device '%s' is NULL.",
+					input_device->name );
+			}
 
-				scaler->value = long_value;
-				break;
-			case MXC_TIMER:
-				mx_status = mx_timer_read(
-						input_device, &double_value );
+			if ( ad->transfer_image_during_scan == FALSE ) {
+				*end_of_readout = TRUE;
+				return MX_SUCCESSFUL_RESULT;
+			}
 
-				if ( mx_status.code != MXE_SUCCESS ) {
-					return mx_status;
-				}
-				break;
-			case MXC_AMPLIFIER:
-				mx_status = mx_amplifier_get_gain(
-						input_device, &double_value );
+			/* Retrieve the most recently acquired image. */
 
-				if ( mx_status.code != MXE_SUCCESS ) {
-					return mx_status;
-				}
-				break;
-			case MXC_RELAY:
-				mx_status = mx_get_relay_status(
-						input_device, NULL );
+			mx_status = mx_area_detector_get_frame(
+				input_device, -1, &(ad->image_frame) );
+
+			if ( mx_status.code != MXE_SUCCESS ) {
+				*end_of_readout = TRUE;
+				return MX_SUCCESSFUL_RESULT;
+			}
+			break;
+		default:
+			return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"Device type %ld cannot be a scan input device.",
+				input_device->mx_class );
+			break;
+		}
+		break;
+
+	default:
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"Record superclass %ld cannot be a scan input device.",
+			input_device->mx_superclass );
+		break;
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*=======================================================================*/
+
+/* If MXF_SCAN_PARALLEL_READOUT is set in scan->scan_flags, the input
+ * devices are divided into readout groups and the groups are read out
+ * concurrently by a thread pool.  Two input devices are put in the same
+ * group if they have a record in common among themselves and their
+ * ancestors (found through parent_record_array).  Thus, all of the
+ * devices that talk to the same MX server or the same interface record
+ * are read out in scan order by a single thread, while devices that
+ * belong to different servers or interfaces are read out in parallel.
+ *
+ * The readout plan is built the first time that mx_readout_data() is
+ * called for a scan and is destroyed by mx_deconfigure_measurement_type().
+ */
+
+#define MXP_MAX_READOUT_THREADS		8
+
+typedef struct {
+	MX_RECORD **input_device_array;
+	long *device_index_array;
+	long num_devices;
+
+	long failed_device_index;
+	mx_bool_type end_of_readout;
+	mx_status_type mx_status;
+} MXP_READOUT_GROUP;
+
+typedef struct {
+	/* A copy of the scan's input device array at the time that
+	 * the plan was built.
+	 */
+	MX_RECORD **input_device_array;
+	long num_input_devices;
+
+	long num_groups;
+	MXP_READOUT_GROUP *group_array;
+	long *device_index_array;
+
+	MX_THREAD_POOL *thread_pool;
+} MXP_READOUT_PLAN;
 
-				if ( mx_status.code != MXE_SUCCESS ) {
-					return mx_status;
+static void
+mxp_destroy_readout_plan( void *plan_ptr )
+{
+	MXP_READOUT_PLAN *plan;
+
+	plan = (MXP_READOUT_PLAN *) plan_ptr;
+
+	if ( plan == (MXP_READOUT_PLAN *) NULL )
+		return;
+
+	(void) mx_thread_pool_destroy( plan->thread_pool );
+
+	mx_free( plan->group_array );
+	mx_free( plan->device_index_array );
+	mx_free( plan->input_device_array );
+	mx_free( plan );
+}
+
+/*---*/
+
+/* mxp_get_readout_ancestors() fills in ancestor_array with the input
+ * device itself followed by all of its ancestor records.  The return
+ * value is the number of records found.
+ */
+
+static long
+mxp_get_readout_ancestors( MX_RECORD *input_device,
+			MX_RECORD **ancestor_array,
+			long max_ancestors )
+{
+	MX_RECORD *record, *parent;
+	long i, j, num_ancestors, next_ancestor;
+	mx_bool_type already_found;
+
+	ancestor_array[0] = input_device;
+	num_ancestors = 1;
+
+	for ( next_ancestor = 0; next_ancestor < num_ancestors; next_ancestor++ )
+	{
+		record = ancestor_array[next_ancestor];
+
+		for ( i = 0; i < record->num_parent_records; i++ ) {
+			parent = record->parent_record_array[i];
+
+			if ( parent == (MX_RECORD *) NULL )
+				continue;
+
+			already_found = FALSE;
+
+			for ( j = 0; j < num_ancestors; j++ ) {
+				if ( ancestor_array[j] == parent ) {
+					already_found = TRUE;
+					break;
 				}
-				break;
-			case MXC_MULTICHANNEL_ANALYZER:
-				mx_status = mx_mca_read( input_device,
-								NULL, NULL);
+			}
+
+			if ( already_found )
+				continue;
+
+			if ( num_ancestors >= max_ancestors )
+				return num_ancestors;
+
+			ancestor_array[ num_ancestors++ ] = parent;
+		}
+	}
+
+	return num_ancestors;
+}
+
+#define MXP_MAX_READOUT_ANCESTORS	100
+
+static long
+mxp_find_readout_group_root( long *group_parent, long i )
+{
+	while ( group_parent[i] != i ) {
+		group_parent[i] = group_parent[ group_parent[i] ];
+
+		i = group_parent[i];
+	}
+
+	return i;
+}
+
+static mx_status_type
+mxp_create_readout_plan( MX_SCAN *scan, MXP_READOUT_PLAN **plan_ptr )
+{
+	static const char fname[] = "mxp_create_readout_plan()";
+
+	MXP_READOUT_PLAN *plan;
+	MXP_READOUT_GROUP *group;
+	MX_RECORD ***ancestor_table;
+	MX_RECORD *ancestor_array[MXP_MAX_READOUT_ANCESTORS];
+	long *num_ancestors_array, *group_parent, *group_number;
+	long i, j, k, m, n, num_devices, root_i, root_j, num_threads;
+	mx_bool_type shared_ancestor;
+	mx_status_type mx_status;
+
+	*plan_ptr = NULL;
+
+	num_devices = scan->num_input_devices;
+
+	plan = (MXP_READOUT_PLAN *) calloc( 1, sizeof(MXP_READOUT_PLAN) );
 
-				if ( mx_status.code != MXE_SUCCESS ) {
-					return mx_status;
+	if ( plan == (MXP_READOUT_PLAN *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a readout plan "
+		"for scan '%s'.", scan->record->name );
+	}
+
+	plan->num_input_devices = num_devices;
+
+	plan->input_device_array = (MX_RECORD **)
+				malloc( num_devices * sizeof(MX_RECORD *) );
+
+	if ( plan->input_device_array == (MX_RECORD **) NULL ) {
+		mx_free( plan );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a %ld element "
+		"input device array for scan '%s'.",
+			num_devices, scan->record->name );
+	}
+
+	memcpy( plan->input_device_array, scan->input_device_array,
+				num_devices * sizeof(MX_RECORD *) );
+
+	ancestor_table = (MX_RECORD ***) calloc( num_devices,
+						sizeof(MX_RECORD **) );
+	num_ancestors_array = (long *) calloc( num_devices, sizeof(long) );
+	group_parent = (long *) calloc( num_devices, sizeof(long) );
+	group_number = (long *) calloc( num_devices, sizeof(long) );
+
+	plan->device_index_array = (long *) calloc( num_devices, sizeof(long));
+
+	if ( ( ancestor_table == (MX_RECORD ***) NULL )
+	  || ( num_ancestors_array == (long *) NULL )
+	  || ( group_parent == (long *) NULL )
+	  || ( group_number == (long *) NULL )
+	  || ( plan->device_index_array == (long *) NULL ) )
+	{
+		mx_status = mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate readout grouping "
+		"arrays for the %ld input devices of scan '%s'.",
+			num_devices, scan->record->name );
+
+		goto error_exit;
+	}
+
+	/* Find the ancestors of each input device. */
+
+	for ( i = 0; i < num_devices; i++ ) {
+		n = mxp_get_readout_ancestors( scan->input_device_array[i],
+					ancestor_array, MXP_MAX_READOUT_ANCESTORS );
+
+		ancestor_table[i] = (MX_RECORD **)
+					malloc( n * sizeof(MX_RECORD *) );
+
+		if ( ancestor_table[i] == (MX_RECORD **) NULL ) {
+			mx_status = mx_error( MXE_OUT_OF_MEMORY, fname,
+			"Ran out of memory trying to allocate the ancestor "
+			"array for input device '%s'.",
+				scan->input_device_array[i]->name );
+
+			goto error_exit;
+		}
+
+		memcpy( ancestor_table[i], ancestor_array,
+					n * sizeof(MX_RECORD *) );
+
+		num_ancestors_array[i] = n;
+
+		group_parent[i] = i;
+	}
+
+	/* Merge the devices that share an ancestor into the same group. */
+
+	for ( i = 0; i < num_devices; i++ ) {
+		for ( j = i + 1; j < num_devices; j++ ) {
+
+			root_i = mxp_find_readout_group_root( group_parent, i );
+			root_j = mxp_find_readout_group_root( group_parent, j );
+
+			if ( root_i == root_j )
+				continue;
+
+			shared_ancestor = FALSE;
+
+			for ( k = 0; k < num_ancestors_array[i]; k++ ) {
+			    for ( m = 0; m < num_ancestors_array[j]; m++ ) {
+				if ( ancestor_table[i][k]
+					== ancestor_table[j][m] )
+				{
+					shared_ancestor = TRUE;
+					break;
 				}
+			    }
+
+			    if ( shared_ancestor )
 				break;
-			case MXC_AREA_DETECTOR:
-				ad = input_device->record_class_struct;
-
-				if ( ad == (MX_AREA_DETECTOR *) NULL ) {
-					return mx_error(
-					MXE_CORRUPT_DATA_STRUCTURE, fname,
-					"The MX_AREA_DETECTOR pointer for "
-					"input device '%s' is NULL.",
-						input_device->name );
-				}
+			}
 
-				if ( ad->transfer_image_during_scan == FALSE ) {
-					return MX_SUCCESSFUL_RESULT;
+			if ( shared_ancestor ) {
+				if ( root_i < root_j ) {
+					group_parent[root_j] = root_i;
+				} else {
+					group_parent[root_i] = root_j;
 				}
+			}
+		}
+	}
 
-				/* Retrieve the most recently acquired image. */
+	/* Number the groups in the order of their first device. */
 
-				mx_status = mx_area_detector_get_frame(
-					input_device, -1, &(ad->image_frame) );
+	plan->num_groups = 0;
 
-				if ( mx_status.code != MXE_SUCCESS ) {
-					return MX_SUCCESSFUL_RESULT;
-				}
-				break;
-			default:
-				return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
-			"Device type %ld cannot be a scan input device.",
-					input_device->mx_class );
-				break;
+	for ( i = 0; i < num_devices; i++ ) {
+		root_i = mxp_find_readout_group_root( group_parent, i );
+
+		if ( root_i == i ) {
+			group_number[i] = plan->num_groups;
+
+			plan->num_groups++;
+		} else {
+			group_number[i] = group_number[root_i];
+		}
+	}
+
+	plan->group_array = (MXP_READOUT_GROUP *)
+		calloc( plan->num_groups, sizeof(MXP_READOUT_GROUP) );
+
+	if ( plan->group_array == (MXP_READOUT_GROUP *) NULL ) {
+		mx_status = mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate %ld readout groups "
+		"for scan '%s'.", plan->num_groups, scan->record->name );
+
+		goto error_exit;
+	}
+
+	/* Lay out the device indices for each group contiguously,
+	 * keeping the devices of a group in scan order.
+	 */
+
+	n = 0;
+
+	for ( k = 0; k < plan->num_groups; k++ ) {
+		group = &(plan->group_array[k]);
+
+		group->input_device_array = plan->input_device_array;
+		group->device_index_array = &(plan->device_index_array[n]);
+		group->num_devices = 0;
+
+		for ( i = 0; i < num_devices; i++ ) {
+			if ( group_number[i] == k ) {
+				group->device_index_array[
+					group->num_devices ] = i;
+
+				group->num_devices++;
+				n++;
 			}
-			break;
+		}
+	}
 
-		default:
-			return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
-			"Record superclass %ld cannot be a scan input device.",
-				input_device->mx_superclass );
-			break;
+	/* Create the thread pool. */
+
+	num_threads = plan->num_groups;
+
+	if ( num_threads > MXP_MAX_READOUT_THREADS ) {
+		num_threads = MXP_MAX_READOUT_THREADS;
+	}
+
+	if ( num_threads > 1 ) {
+		mx_status = mx_thread_pool_create( &(plan->thread_pool),
+							num_threads );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			goto error_exit;
+	}
+
+	mx_status = MX_SUCCESSFUL_RESULT;
+
+	*plan_ptr = plan;
+	plan = NULL;
+
+error_exit:
+	if ( ancestor_table != (MX_RECORD ***) NULL ) {
+		for ( i = 0; i < num_devices; i++ ) {
+			mx_free( ancestor_table[i] );
 		}
 	}
 
+	mx_free( ancestor_table );
+	mx_free( num_ancestors_array );
+	mx_free( group_parent );
+	mx_free( group_number );
+
+	mxp_destroy_readout_plan( plan );
+
+	return mx_status;
+}
+
+/*---*/
+
+static void
+mxp_readout_group( void *task )
+{
+	MXP_READOUT_GROUP *group;
+	MX_RECORD *input_device;
+	long i, device_index;
+
+	group = (MXP_READOUT_GROUP *) task;
+
+	group->failed_device_index = -1;
+	group->end_of_readout = FALSE;
+	group->mx_status = MX_SUCCESSFUL_RESULT;
+
+	for ( i = 0; i < group->num_devices; i++ ) {
+		device_index = group->device_index_array[i];
+
+		input_device = group->input_device_array[ device_index ];
+
+		group->mx_status = mxp_readout_input_device( input_device,
+						&(group->end_of_readout) );
+
+		if ( group->mx_status.code != MXE_SUCCESS ) {
+			group->failed_device_index = device_index;
+			return;
+		}
+
+		if ( group->end_of_readout ) {
+			return;
+		}
+	}
+}
+
+static mx_status_type
+mxp_parallel_readout_data( MX_MEASUREMENT *measurement, MX_SCAN *scan )
+{
+	MXP_READOUT_PLAN *plan;
+	MXP_READOUT_GROUP *group, *failed_group;
+	long i;
+	mx_status_type mx_status;
+
+	plan = (MXP_READOUT_PLAN *) measurement->readout_plan;
+
+	/* Rebuild the plan if the input device list has changed. */
+
+	if ( plan != (MXP_READOUT_PLAN *) NULL ) {
+		if ( ( plan->num_input_devices != scan->num_input_devices )
+		  || ( memcmp( plan->input_device_array,
+				scan->input_device_array,
+				plan->num_input_devices * sizeof(MX_RECORD *) )
+			!= 0 ) )
+		{
+			mxp_destroy_readout_plan( plan );
+
+			plan = NULL;
+			measurement->readout_plan = NULL;
+		}
+	}
+
+	if ( plan == (MXP_READOUT_PLAN *) NULL ) {
+		mx_status = mxp_create_readout_plan( scan, &plan );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		measurement->readout_plan = plan;
+	}
+
+	mx_status = mx_thread_pool_run( plan->thread_pool, mxp_readout_group,
+				plan->group_array, sizeof(MXP_READOUT_GROUP),
+				plan->num_groups );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	/* Report the error for the first failed device in scan order. */
+
+	failed_group = NULL;
+
+	for ( i = 0; i < plan->num_groups; i++ ) {
+		group = &(plan->group_array[i]);
+
+		if ( group->failed_device_index < 0 )
+			continue;
+
+		if ( ( failed_group == (MXP_READOUT_GROUP *) NULL )
+		  || ( group->failed_device_index
+				< failed_group->failed_device_index ) )
+		{
+			failed_group = group;
+		}
+	}
+
+	if ( failed_group != (MXP_READOUT_GROUP *) NULL ) {
+		return failed_group->mx_status;
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*=======================================================================*/
+
+MX_EXPORT mx_status_type
+mx_readout_data( MX_MEASUREMENT *measurement )
+{
+	static const char fname[] = "mx_readout_data()";
+
+	MX_SCAN *scan;
+	MX_RECORD **input_device_array;
+	long i;
+	mx_bool_type end_of_readout;
+	mx_status_type mx_status;
+
+	scan = (MX_SCAN *) measurement->scan;
+
+	if ( scan == (MX_SCAN *) NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"MX_SCAN pointer for measurement pointer %p is NULL.",
+			measurement );
+	}
+
+	input_device_array = scan->input_device_array;
+
+	if ( input_device_array == (MX_RECORD **) NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"input_device_array pointer for scan record '%s' is NULL.",
+			scan->record->name );
+	}
+
+	if ( ( scan->scan_flags & MXF_SCAN_PARALLEL_READOUT )
+	  && ( scan->num_input_devices > 1 ) )
+	{
+		mx_status = mxp_parallel_readout_data( measurement, scan );
+
+		return mx_status;
+	}
+
+	/* Read out and save the values from the input devices. */
+
+	for ( i = 0; i < scan->num_input_devices; i++ ) {
+		mx_status = mxp_readout_input_device( input_device_array[i],
+							&end_of_readout );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		if ( end_of_readout )
+			break;
+	}
+
 	return MX_SUCCESSFUL_RESULT;
 }
 
@@ -50,6 +50,9 @@ typedef struct {
 	char *measurement_arguments;
 	void *measurement_type_struct;
 	void *measurement_function_list;
+
+	/* Used by mx_readout_data() if MXF_SCAN_PARALLEL_READOUT is set. */
+	void *readout_plan;
 } MX_MEASUREMENT;
 
 typedef struct {
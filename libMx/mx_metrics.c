@@ -0,0 +1,780 @@
+/*
+ * Name:    mx_metrics.c
+ *
+ * Purpose: MX runtime metrics registry.
+ *
+ * Author:  William Lavender
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Copyright 2016 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#define MX_METRICS_DEBUG	FALSE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include "mx_util.h"
+#include "mx_record.h"
+#include "mx_stdint.h"
+#include "mx_atomic.h"
+#include "mx_mutex.h"
+#include "mx_thread.h"
+#include "mx_hrt.h"
+#include "mx_hash_table.h"
+#include "mx_metrics.h"
+
+/* The registry.  Metrics are never freed, since callers cache pointers
+ * to them.  New metrics are added at the end of the list so that the
+ * text output comes out in the order that the metrics were first used.
+ */
+
+/* The registry is set up exactly once.  The first thread to take a ticket
+ * does the work, while any other thread that arrives in the meantime waits
+ * for mxp_metrics_init_state to leave MXP_METRICS_UNINITIALIZED.
+ */
+
+#define MXP_METRICS_UNINITIALIZED	0
+#define MXP_METRICS_READY		1
+#define MXP_METRICS_FAILED		2
+
+static int32_t mxp_metrics_init_ticket = 0;
+
+static int32_t mxp_metrics_init_state = MXP_METRICS_UNINITIALIZED;
+
+static mx_bool_type
+mxp_metrics_ready( void )
+{
+	if ( mx_atomic_read32( &mxp_metrics_init_state ) == MXP_METRICS_READY )
+		return TRUE;
+	else
+		return FALSE;
+}
+
+static mx_bool_type mxp_metrics_enabled = TRUE;
+
+static MX_MUTEX *mxp_metrics_mutex = NULL;
+
+static MX_HASH_TABLE *mxp_metrics_index = NULL;
+
+static MX_METRIC *mxp_metrics_list_head = NULL;
+static MX_METRIC *mxp_metrics_list_tail = NULL;
+
+/* Each thread is given its own shard the first time that it updates
+ * a metric.  The shard number plus one is kept in thread local storage,
+ * so that a NULL value means that no shard has been assigned yet.
+ */
+
+static MX_THREAD_LOCAL_STORAGE *mxp_metrics_shard_key = NULL;
+
+static int32_t mxp_metrics_num_threads = 0;
+
+/* The metric names and op labels used for each per-record metric. */
+
+static struct {
+	const char *name;
+	const char *op;
+} mxp_record_metric_table[MX_METRICS_NUM_RECORD_METRICS] = {
+	{ "mx_record_process_seconds",		NULL },
+	{ "mx_rs232_io_seconds",		"getchar" },
+	{ "mx_rs232_io_seconds",		"putchar" },
+	{ "mx_rs232_io_seconds",		"read" },
+	{ "mx_rs232_io_seconds",		"write" },
+	{ "mx_rs232_io_seconds",		"getline" },
+	{ "mx_rs232_io_seconds",		"putline" },
+	{ "mx_area_detector_frame_seconds",	"readout" },
+	{ "mx_area_detector_frame_seconds",	"correct" },
+	{ "mx_area_detector_frame_seconds",	"save" },
+};
+
+/*------------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_metrics_initialize( void )
+{
+	static const char fname[] = "mx_metrics_initialize()";
+
+	int32_t init_state;
+	mx_status_type mx_status;
+
+	if ( mxp_metrics_ready() ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	if ( mx_atomic_increment32( &mxp_metrics_init_ticket ) != 1 ) {
+
+		/* Another thread got here first, so wait for it to finish. */
+
+		while (1) {
+			init_state = mx_atomic_read32( &mxp_metrics_init_state );
+
+			if ( init_state != MXP_METRICS_UNINITIALIZED )
+				break;
+
+			mx_msleep(1);
+		}
+
+		if ( init_state != MXP_METRICS_READY ) {
+			return mx_error( MXE_INITIALIZATION_ERROR, fname,
+			"The MX metrics registry could not be initialized." );
+		}
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	mx_status = mx_mutex_create( &mxp_metrics_mutex );
+
+	if ( mx_status.code == MXE_SUCCESS ) {
+		mx_status = mx_hash_table_create( &mxp_metrics_index,
+				MXU_METRIC_KEY_LENGTH + 1, 256, NULL );
+	}
+
+	if ( mx_status.code == MXE_SUCCESS ) {
+		mx_status = mx_tls_alloc( &mxp_metrics_shard_key );
+	}
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mx_atomic_write32( &mxp_metrics_init_state,
+					MXP_METRICS_FAILED );
+		return mx_status;
+	}
+
+	mx_atomic_write32( &mxp_metrics_init_state, MXP_METRICS_READY );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+MX_EXPORT mx_bool_type
+mx_metrics_get_enabled( void )
+{
+	return mxp_metrics_enabled;
+}
+
+MX_EXPORT void
+mx_metrics_set_enabled( mx_bool_type enabled )
+{
+	if ( enabled ) {
+		mxp_metrics_enabled = TRUE;
+	} else {
+		mxp_metrics_enabled = FALSE;
+	}
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+mxp_metrics_make_key( char *key, size_t max_key_length,
+			const char *name, const char *labels )
+{
+	if ( ( labels == NULL ) || ( labels[0] == '\0' ) ) {
+		strlcpy( key, name, max_key_length );
+	} else {
+		snprintf( key, max_key_length, "%s{%s}", name, labels );
+	}
+}
+
+MX_EXPORT mx_status_type
+mx_metrics_find( const char *name,
+		const char *labels,
+		long metric_type,
+		MX_METRIC **metric )
+{
+	static const char fname[] = "mx_metrics_find()";
+
+	char key[MXU_METRIC_KEY_LENGTH+1];
+	MX_METRIC *new_metric;
+	void *indexed_value;
+	mx_status_type mx_status;
+
+	if ( ( name == (const char *) NULL )
+	  || ( metric == (MX_METRIC **) NULL ) )
+	{
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"One or more of the arguments passed was NULL." );
+	}
+
+	if ( ( metric_type != MXT_METRIC_COUNTER )
+	  && ( metric_type != MXT_METRIC_HISTOGRAM ) )
+	{
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"Illegal metric type %ld requested for metric '%s'.",
+			metric_type, name );
+	}
+
+	if ( mxp_metrics_ready() == FALSE ) {
+		mx_status = mx_metrics_initialize();
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
+	mxp_metrics_make_key( key, sizeof(key), name, labels );
+
+	mx_mutex_lock( mxp_metrics_mutex );
+
+	mx_status = mx_hash_table_lookup_key( mxp_metrics_index,
+						key, &indexed_value );
+
+	if ( mx_status.code == MXE_SUCCESS ) {
+		mx_mutex_unlock( mxp_metrics_mutex );
+
+		*metric = (MX_METRIC *) indexed_value;
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	new_metric = (MX_METRIC *) calloc( 1, sizeof(MX_METRIC) );
+
+	if ( new_metric == (MX_METRIC *) NULL ) {
+		mx_mutex_unlock( mxp_metrics_mutex );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate metric '%s'.", key );
+	}
+
+	strlcpy( new_metric->name, name, sizeof(new_metric->name) );
+
+	if ( labels != (const char *) NULL ) {
+		strlcpy( new_metric->labels, labels,
+				sizeof(new_metric->labels) );
+	}
+
+	new_metric->metric_type = metric_type;
+	new_metric->next_metric = NULL;
+
+	mx_status = mx_hash_table_insert_key( mxp_metrics_index,
+						key, new_metric );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mx_mutex_unlock( mxp_metrics_mutex );
+
+		mx_free( new_metric );
+
+		return mx_status;
+	}
+
+	if ( mxp_metrics_list_tail == (MX_METRIC *) NULL ) {
+		mxp_metrics_list_head = new_metric;
+	} else {
+		mxp_metrics_list_tail->next_metric = new_metric;
+	}
+
+	mxp_metrics_list_tail = new_metric;
+
+	mx_mutex_unlock( mxp_metrics_mutex );
+
+#if MX_METRICS_DEBUG
+	MX_DEBUG(-2,("%s: created metric '%s'", fname, key));
+#endif
+
+	*metric = new_metric;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+MX_EXPORT mx_status_type
+mx_metrics_find_by_key( const char *key, MX_METRIC **metric )
+{
+	static const char fname[] = "mx_metrics_find_by_key()";
+
+	void *indexed_value;
+	mx_status_type mx_status;
+
+	if ( ( key == (const char *) NULL )
+	  || ( metric == (MX_METRIC **) NULL ) )
+	{
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"One or more of the arguments passed was NULL." );
+	}
+
+	if ( mxp_metrics_ready() == FALSE ) {
+		return mx_error( MXE_NOT_FOUND, fname,
+		"Metric '%s' was not found.", key );
+	}
+
+	mx_mutex_lock( mxp_metrics_mutex );
+
+	mx_status = mx_hash_table_lookup_key( mxp_metrics_index,
+						key, &indexed_value );
+
+	mx_mutex_unlock( mxp_metrics_mutex );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		return mx_error( MXE_NOT_FOUND, fname,
+		"Metric '%s' was not found.", key );
+	}
+
+	*metric = (MX_METRIC *) indexed_value;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*------------------------------------------------------------------------*/
+
+MX_EXPORT MX_METRIC *
+mx_metrics_get_record_metric( MX_RECORD *record, unsigned long metric_index )
+{
+	MX_METRIC **metric_array;
+	MX_DRIVER *driver;
+	char labels[MXU_METRIC_LABELS_LENGTH+1];
+	const char *driver_name;
+	mx_status_type mx_status;
+
+	if ( mxp_metrics_enabled == FALSE )
+		return NULL;
+
+	if ( ( record == (MX_RECORD *) NULL )
+	  || ( metric_index >= MX_METRICS_NUM_RECORD_METRICS ) )
+	{
+		return NULL;
+	}
+
+	metric_array = (MX_METRIC **) record->metric_array;
+
+	if ( metric_array != (MX_METRIC **) NULL ) {
+		if ( metric_array[metric_index] != (MX_METRIC *) NULL ) {
+			return metric_array[metric_index];
+		}
+	}
+
+	/* This is the first use of this metric by this record. */
+
+	if ( mxp_metrics_ready() == FALSE ) {
+		mx_status = mx_metrics_initialize();
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return NULL;
+	}
+
+	driver = (MX_DRIVER *) record->driver;
+
+	if ( driver == (MX_DRIVER *) NULL ) {
+		driver_name = "";
+	} else {
+		driver_name = driver->name;
+	}
+
+	if ( mxp_record_metric_table[metric_index].op == NULL ) {
+		snprintf( labels, sizeof(labels),
+			"record=\"%s\",driver=\"%s\"",
+			record->name, driver_name );
+	} else {
+		snprintf( labels, sizeof(labels),
+			"record=\"%s\",driver=\"%s\",op=\"%s\"",
+			record->name, driver_name,
+			mxp_record_metric_table[metric_index].op );
+	}
+
+	mx_mutex_lock( mxp_metrics_mutex );
+
+	if ( record->metric_array == NULL ) {
+		record->metric_array = calloc( MX_METRICS_NUM_RECORD_METRICS,
+						sizeof(MX_METRIC *) );
+	}
+
+	metric_array = (MX_METRIC **) record->metric_array;
+
+	mx_mutex_unlock( mxp_metrics_mutex );
+
+	if ( metric_array == (MX_METRIC **) NULL )
+		return NULL;
+
+	mx_status = mx_metrics_find( mxp_record_metric_table[metric_index].name,
+				labels, MXT_METRIC_HISTOGRAM,
+				&(metric_array[metric_index]) );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return NULL;
+
+	return metric_array[metric_index];
+}
+
+/*------------------------------------------------------------------------*/
+
+static MX_METRIC_SHARD *
+mxp_metrics_get_shard( MX_METRIC *metric )
+{
+	void *tls_value;
+	unsigned long shard_number;
+
+	tls_value = mx_tls_get_value( mxp_metrics_shard_key );
+
+	if ( tls_value == NULL ) {
+		shard_number = (unsigned long)
+			mx_atomic_increment32( &mxp_metrics_num_threads );
+
+		shard_number %= MX_METRICS_NUM_SHARDS;
+
+		(void) mx_tls_set_value( mxp_metrics_shard_key,
+				(void *) (uintptr_t) ( shard_number + 1 ) );
+	} else {
+		shard_number = (unsigned long) (uintptr_t) tls_value;
+
+		shard_number--;
+	}
+
+	return &(metric->shard[shard_number]);
+}
+
+MX_EXPORT uint64_t
+mx_metrics_start( void )
+{
+	struct timespec now;
+
+	if ( mxp_metrics_enabled == FALSE )
+		return 0;
+
+	now = mx_high_resolution_time();
+
+	return 1000000000ULL * (uint64_t) now.tv_sec + (uint64_t) now.tv_nsec;
+}
+
+MX_EXPORT void
+mx_metrics_stop( MX_METRIC *metric, uint64_t start_time )
+{
+	struct timespec now;
+	uint64_t stop_time;
+
+	if ( ( metric == (MX_METRIC *) NULL ) || ( start_time == 0 ) )
+		return;
+
+	now = mx_high_resolution_time();
+
+	stop_time = 1000000000ULL * (uint64_t) now.tv_sec
+					+ (uint64_t) now.tv_nsec;
+
+	if ( stop_time < start_time ) {
+		mx_metrics_observe( metric, 0 );
+	} else {
+		mx_metrics_observe( metric, stop_time - start_time );
+	}
+}
+
+MX_EXPORT void
+mx_metrics_observe( MX_METRIC *metric, uint64_t nanoseconds )
+{
+	MX_METRIC_SHARD *shard;
+	uint64_t bucket_limit;
+	unsigned long i;
+
+	if ( ( metric == (MX_METRIC *) NULL ) || ( mxp_metrics_enabled == FALSE ) )
+		return;
+
+	shard = mxp_metrics_get_shard( metric );
+
+	bucket_limit = 1000;	/* 1 microsecond */
+
+	for ( i = 0; i < (MX_METRICS_NUM_BUCKETS - 1); i++ ) {
+		if ( nanoseconds <= bucket_limit )
+			break;
+
+		bucket_limit <<= 1;
+	}
+
+	shard->count++;
+	shard->sum += nanoseconds;
+	shard->bucket[i]++;
+}
+
+MX_EXPORT void
+mx_metrics_increment( MX_METRIC *metric, uint64_t amount )
+{
+	MX_METRIC_SHARD *shard;
+
+	if ( ( metric == (MX_METRIC *) NULL ) || ( mxp_metrics_enabled == FALSE ) )
+		return;
+
+	shard = mxp_metrics_get_shard( metric );
+
+	shard->count += amount;
+}
+
+/*------------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_metrics_get_values( MX_METRIC *metric, uint64_t *value_array )
+{
+	static const char fname[] = "mx_metrics_get_values()";
+
+	MX_METRIC_SHARD *shard;
+	unsigned long i, j;
+
+	if ( ( metric == (MX_METRIC *) NULL )
+	  || ( value_array == (uint64_t *) NULL ) )
+	{
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"One or more of the arguments passed was NULL." );
+	}
+
+	memset( value_array, 0, MX_METRICS_NUM_VALUES * sizeof(uint64_t) );
+
+	for ( i = 0; i < MX_METRICS_NUM_SHARDS; i++ ) {
+		shard = &(metric->shard[i]);
+
+		value_array[0] += shard->count;
+		value_array[1] += shard->sum;
+
+		for ( j = 0; j < MX_METRICS_NUM_BUCKETS; j++ ) {
+			value_array[j+2] += shard->bucket[j];
+		}
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+MX_EXPORT void
+mx_metrics_reset( void )
+{
+	MX_METRIC *metric;
+
+	if ( mxp_metrics_ready() == FALSE )
+		return;
+
+	mx_mutex_lock( mxp_metrics_mutex );
+
+	metric = mxp_metrics_list_head;
+
+	while ( metric != (MX_METRIC *) NULL ) {
+		memset( metric->shard, 0, sizeof(metric->shard) );
+
+		metric = metric->next_metric;
+	}
+
+	mx_mutex_unlock( mxp_metrics_mutex );
+}
+
+/*------------------------------------------------------------------------*/
+
+typedef struct {
+	char *buffer;
+	size_t length;
+	size_t allocated_length;
+	mx_bool_type out_of_memory;
+} MXP_METRICS_TEXT;
+
+static void
+mxp_metrics_append( MXP_METRICS_TEXT *text, const char *format, ... )
+{
+	va_list args;
+	char line[MXU_METRIC_KEY_LENGTH+100];
+	size_t line_length, new_length;
+	char *new_buffer;
+
+	if ( text->out_of_memory )
+		return;
+
+	va_start( args, format );
+	vsnprintf( line, sizeof(line), format, args );
+	va_end( args );
+
+	line_length = strlen( line );
+
+	if ( ( text->length + line_length + 1 ) > text->allocated_length ) {
+		new_length = 2 * text->allocated_length + line_length + 1;
+
+		new_buffer = realloc( text->buffer, new_length );
+
+		if ( new_buffer == (char *) NULL ) {
+			text->out_of_memory = TRUE;
+			return;
+		}
+
+		text->buffer = new_buffer;
+		text->allocated_length = new_length;
+	}
+
+	memcpy( text->buffer + text->length, line, line_length + 1 );
+
+	text->length += line_length;
+}
+
+/* Histograms print the buckets up to the first one that holds all of
+ * the observations, followed by the +Inf bucket.  The remaining buckets
+ * would only repeat the total count.
+ */
+
+static void
+mxp_metrics_format_histogram( MXP_METRICS_TEXT *text, MX_METRIC *metric,
+				uint64_t *value_array )
+{
+	char separator[2];
+	uint64_t cumulative_count;
+	double bucket_limit;
+	unsigned long i;
+
+	if ( metric->labels[0] == '\0' ) {
+		separator[0] = '\0';
+	} else {
+		separator[0] = ',';
+		separator[1] = '\0';
+	}
+
+	cumulative_count = 0;
+	bucket_limit = 1.0e-6;
+
+	for ( i = 0; i < (MX_METRICS_NUM_BUCKETS - 1); i++ ) {
+		cumulative_count += value_array[i+2];
+
+		mxp_metrics_append( text, "%s_bucket{%s%sle=\"%g\"} %llu\n",
+			metric->name, metric->labels, separator, bucket_limit,
+			(unsigned long long) cumulative_count );
+
+		if ( cumulative_count >= value_array[0] )
+			break;
+
+		bucket_limit *= 2.0;
+	}
+
+	mxp_metrics_append( text, "%s_bucket{%s%sle=\"+Inf\"} %llu\n",
+		metric->name, metric->labels, separator,
+		(unsigned long long) value_array[0] );
+
+	if ( metric->labels[0] == '\0' ) {
+		mxp_metrics_append( text, "%s_sum %.9f\n", metric->name,
+			1.0e-9 * (double) value_array[1] );
+
+		mxp_metrics_append( text, "%s_count %llu\n", metric->name,
+			(unsigned long long) value_array[0] );
+	} else {
+		mxp_metrics_append( text, "%s_sum{%s} %.9f\n",
+			metric->name, metric->labels,
+			1.0e-9 * (double) value_array[1] );
+
+		mxp_metrics_append( text, "%s_count{%s} %llu\n",
+			metric->name, metric->labels,
+			(unsigned long long) value_array[0] );
+	}
+}
+
+/* All of the metrics in a family (metrics with the same name) are printed
+ * together after a single '# TYPE' line.  There are only a few families,
+ * so they are found with a linear search.
+ */
+
+#define MXP_METRICS_MAX_FAMILIES	64
+
+MX_EXPORT mx_status_type
+mx_metrics_format_text( char **text_ptr )
+{
+	static const char fname[] = "mx_metrics_format_text()";
+
+	MXP_METRICS_TEXT text;
+	MX_METRIC *metric;
+	MX_METRIC *family_array[MXP_METRICS_MAX_FAMILIES];
+	uint64_t value_array[MX_METRICS_NUM_VALUES];
+	unsigned long i, num_families;
+	mx_bool_type type_printed;
+
+	if ( text_ptr == (char **) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The text pointer passed was NULL." );
+	}
+
+	memset( &text, 0, sizeof(text) );
+
+	/* Always return a valid string, even if there are no metrics. */
+
+	text.allocated_length = 4096;
+
+	text.buffer = malloc( text.allocated_length );
+
+	if ( text.buffer == (char *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory allocating the metrics text buffer." );
+	}
+
+	text.buffer[0] = '\0';
+
+	if ( mxp_metrics_ready() == FALSE ) {
+		*text_ptr = text.buffer;
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	mx_mutex_lock( mxp_metrics_mutex );
+
+	num_families = 0;
+
+	for ( metric = mxp_metrics_list_head;
+		metric != (MX_METRIC *) NULL;
+		metric = metric->next_metric )
+	{
+		for ( i = 0; i < num_families; i++ ) {
+			if ( strcmp( family_array[i]->name, metric->name ) == 0 )
+				break;
+		}
+
+		if ( ( i == num_families )
+		  && ( num_families < MXP_METRICS_MAX_FAMILIES ) )
+		{
+			family_array[num_families] = metric;
+			num_families++;
+		}
+	}
+
+	for ( i = 0; i < num_families; i++ ) {
+		type_printed = FALSE;
+
+		for ( metric = family_array[i];
+			metric != (MX_METRIC *) NULL;
+			metric = metric->next_metric )
+		{
+			if ( strcmp( metric->name, family_array[i]->name ) != 0 )
+				continue;
+
+			(void) mx_metrics_get_values( metric, value_array );
+
+			/* Skip metrics that have not been updated since
+			 * the last reset.
+			 */
+
+			if ( value_array[0] == 0 )
+				continue;
+
+			if ( type_printed == FALSE ) {
+				mxp_metrics_append( &text, "# TYPE %s %s\n",
+					metric->name,
+					( metric->metric_type
+						== MXT_METRIC_COUNTER )
+					? "counter" : "histogram" );
+
+				type_printed = TRUE;
+			}
+
+			if ( metric->metric_type == MXT_METRIC_HISTOGRAM ) {
+				mxp_metrics_format_histogram( &text,
+						metric, value_array );
+			} else
+			if ( metric->labels[0] == '\0' ) {
+				mxp_metrics_append( &text, "%s %llu\n",
+					metric->name,
+					(unsigned long long) value_array[0] );
+			} else {
+				mxp_metrics_append( &text, "%s{%s} %llu\n",
+					metric->name, metric->labels,
+					(unsigned long long) value_array[0] );
+			}
+		}
+	}
+
+	mx_mutex_unlock( mxp_metrics_mutex );
+
+	if ( text.out_of_memory ) {
+		mx_free( text.buffer );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory formatting the metrics text." );
+	}
+
+	*text_ptr = text.buffer;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
@@ -0,0 +1,174 @@
+/*
+ * Name:    mx_metrics.h
+ *
+ * Purpose: Header file for the MX runtime metrics registry.
+ *
+ *          The metrics registry keeps counters and latency histograms
+ *          for the hot paths of MX programs, so that the time spent in
+ *          each request type, record driver, serial port or detector
+ *          stage can be seen in a running server without recompiling
+ *          with the *_DEBUG_TIMING flags.
+ *
+ *          Each metric is identified by a name and an optional label
+ *          string, written in the same way as in the text exposition
+ *          format used by mx_metrics_format_text(), for example
+ *
+ *            mx_record_process_seconds{record="m1",driver="soft_motor"}
+ *
+ *          Metric updates do not take any locks.  Each metric is split
+ *          into MX_METRICS_NUM_SHARDS shards and each thread updates
+ *          only the shard that it was assigned when it first used the
+ *          registry.  The shards are summed when the metric is read.
+ *          If more than MX_METRICS_NUM_SHARDS threads update the same
+ *          metric at the same moment, an occasional update may be lost.
+ *
+ *          Latencies are measured with mx_high_resolution_time(), which
+ *          uses the CPU cycle counter where one is available.
+ *
+ * Author:  William Lavender
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Copyright 2016 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#ifndef __MX_METRICS_H__
+#define __MX_METRICS_H__
+
+#include "mx_stdint.h"
+
+/* Make the header file C++ safe. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MXU_METRIC_NAME_LENGTH		60
+#define MXU_METRIC_LABELS_LENGTH	139
+
+/* A metric key is the name followed by the labels in braces. */
+
+#define MXU_METRIC_KEY_LENGTH \
+		( MXU_METRIC_NAME_LENGTH + MXU_METRIC_LABELS_LENGTH + 2 )
+
+#define MX_METRICS_NUM_SHARDS		16
+
+/* Histogram bucket i counts the observations that took no more than
+ * 2^i microseconds.  The last bucket counts everything longer than that.
+ */
+
+#define MX_METRICS_NUM_BUCKETS		24
+
+/* mx_metrics_get_values() returns the count, the sum and then the
+ * (non-cumulative) bucket counts.
+ */
+
+#define MX_METRICS_NUM_VALUES		( MX_METRICS_NUM_BUCKETS + 2 )
+
+/* Metric types. */
+
+#define MXT_METRIC_COUNTER		1
+#define MXT_METRIC_HISTOGRAM		2
+
+/* Metrics that belong to a record are cached in the record itself, so
+ * that they do not need to be looked up by name on each use.  These are
+ * the indices of the per-record metrics.
+ */
+
+#define MX_METRIC_RECORD_PROCESS	0
+#define MX_METRIC_RS232_GETCHAR		1
+#define MX_METRIC_RS232_PUTCHAR		2
+#define MX_METRIC_RS232_READ		3
+#define MX_METRIC_RS232_WRITE		4
+#define MX_METRIC_RS232_GETLINE		5
+#define MX_METRIC_RS232_PUTLINE		6
+#define MX_METRIC_AD_READOUT		7
+#define MX_METRIC_AD_CORRECT		8
+#define MX_METRIC_AD_SAVE		9
+
+#define MX_METRICS_NUM_RECORD_METRICS	10
+
+typedef struct {
+	uint64_t count;
+	uint64_t sum;		/* Nanoseconds for histograms. */
+	uint64_t bucket[MX_METRICS_NUM_BUCKETS];
+} MX_METRIC_SHARD;
+
+typedef struct mx_metric_type {
+	char name[MXU_METRIC_NAME_LENGTH+1];
+	char labels[MXU_METRIC_LABELS_LENGTH+1];
+	long metric_type;
+
+	MX_METRIC_SHARD shard[MX_METRICS_NUM_SHARDS];
+
+	struct mx_metric_type *next_metric;
+} MX_METRIC;
+
+MX_API mx_status_type mx_metrics_initialize( void );
+
+MX_API mx_bool_type mx_metrics_get_enabled( void );
+
+MX_API void mx_metrics_set_enabled( mx_bool_type enabled );
+
+/* mx_metrics_find() returns the metric with the requested name and labels,
+ * creating it if it does not exist yet.  The returned pointer remains
+ * valid for the life of the program, so callers should cache it.
+ */
+
+MX_API mx_status_type mx_metrics_find( const char *name,
+					const char *labels,
+					long metric_type,
+					MX_METRIC **metric );
+
+/* mx_metrics_find_by_key() looks up an existing metric using the key
+ * printed by mx_metrics_format_text(), for example 'name{labels}'.
+ */
+
+MX_API mx_status_type mx_metrics_find_by_key( const char *key,
+					MX_METRIC **metric );
+
+/* mx_metrics_get_record_metric() returns one of the MX_METRIC_* per-record
+ * metrics listed above for the specified record.  It returns NULL if
+ * metrics are disabled, so the result may be passed directly to
+ * mx_metrics_stop().
+ */
+
+MX_API MX_METRIC *mx_metrics_get_record_metric( MX_RECORD *record,
+						unsigned long metric_index );
+
+/* Latencies are measured by calling mx_metrics_start() before the
+ * operation and then mx_metrics_stop() afterwards.  mx_metrics_start()
+ * returns 0 if metrics are disabled, in which case mx_metrics_stop()
+ * does nothing.
+ */
+
+MX_API uint64_t mx_metrics_start( void );
+
+MX_API void mx_metrics_stop( MX_METRIC *metric, uint64_t start_time );
+
+MX_API void mx_metrics_observe( MX_METRIC *metric, uint64_t nanoseconds );
+
+MX_API void mx_metrics_increment( MX_METRIC *metric, uint64_t amount );
+
+MX_API mx_status_type mx_metrics_get_values( MX_METRIC *metric,
+						uint64_t *value_array );
+
+MX_API void mx_metrics_reset( void );
+
+/* mx_metrics_format_text() writes all of the metrics that have been used
+ * to a newly allocated string in the Prometheus text exposition format.
+ * The caller must free() the string.
+ */
+
+MX_API mx_status_type mx_metrics_format_text( char **text );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MX_METRICS_H__ */
+
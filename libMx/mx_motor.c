@@ -1014,11 +1014,67 @@ mx_motor_array_internal_move_with_report( long num_motors,
 	return MX_SUCCESSFUL_RESULT;
 }
 
+/* Between status checks, mx_wait_for_motor_stop() and
+ * mx_wait_for_motor_array_stop() sleep for an interval that starts at
+ * MX_MOTOR_MIN_POLL_INTERVAL milliseconds and doubles after each check
+ * up to MX_MOTOR_MAX_POLL_INTERVAL milliseconds.  Short moves are thus
+ * noticed to have finished almost immediately, while long moves are
+ * polled no more often than before.  If the driver provides a
+ * wait_for_stop() method, mx_wait_for_motor_stop() uses that instead
+ * of sleeping, with the same interval as its timeout.  Thus a driver
+ * callback can only make the status check happen sooner, never later.
+ */
+
+#define MX_MOTOR_MIN_POLL_INTERVAL	1	/* in milliseconds */
+#define MX_MOTOR_MAX_POLL_INTERVAL	10	/* in milliseconds */
+
+static mx_status_type
+mxp_motor_wait_for_next_status_check( MX_MOTOR *motor,
+				MX_MOTOR_FUNCTION_LIST *function_list,
+				unsigned long *poll_interval )
+{
+	mx_status_type ( *wait_for_stop_fn )( MX_MOTOR *, double );
+	mx_bool_type waited;
+	mx_status_type mx_status;
+
+	waited = FALSE;
+
+	if ( function_list != (MX_MOTOR_FUNCTION_LIST *) NULL ) {
+		wait_for_stop_fn = function_list->wait_for_stop;
+
+		if ( wait_for_stop_fn != NULL ) {
+			mx_status = (*wait_for_stop_fn)( motor,
+					0.001 * (double) *poll_interval );
+
+			if ( mx_status.code == MXE_SUCCESS ) {
+				waited = TRUE;
+			} else
+			if ( mx_status.code != MXE_UNSUPPORTED ) {
+				return mx_status;
+			}
+		}
+	}
+
+	if ( waited == FALSE ) {
+		mx_msleep( *poll_interval );
+	}
+
+	*poll_interval *= 2;
+
+	if ( *poll_interval > MX_MOTOR_MAX_POLL_INTERVAL ) {
+		*poll_interval = MX_MOTOR_MAX_POLL_INTERVAL;
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
 MX_EXPORT mx_status_type
 mx_wait_for_motor_stop( MX_RECORD *motor_record, unsigned long flags )
 {
 	static const char fname[] = "mx_wait_for_motor_stop()";
 
+	MX_MOTOR *motor;
+	MX_MOTOR_FUNCTION_LIST *function_list;
 	int interrupt;
 	unsigned long motor_status, busy, error_bitmask;
 	unsigned long hardware_limit_bitmask, software_limit_bitmask;
@@ -1028,12 +1084,21 @@ mx_wait_for_motor_stop( MX_RECORD *motor_record, unsigned long flags )
 	MX_CLOCK_TICK show_tick_interval, current_tick, next_show_tick;
 	int comparison;
 	double position;
+	unsigned long poll_interval;
 	mx_status_type mx_status;
 
+	mx_status = mx_motor_get_pointers( motor_record, &motor,
+					&function_list, fname );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
 	MX_DEBUG( 2,("%s invoked for motor '%s'.", fname, motor_record->name ));
 
 	memset( &next_show_tick, 0, sizeof(next_show_tick) );
 
+	poll_interval = MX_MOTOR_MIN_POLL_INTERVAL;
+
 	hardware_limit_bitmask =
 		MXSF_MTR_POSITIVE_LIMIT_HIT | MXSF_MTR_NEGATIVE_LIMIT_HIT;
 
@@ -1208,7 +1273,11 @@ mx_wait_for_motor_stop( MX_RECORD *motor_record, unsigned long flags )
 			}
 		}
 
-		mx_msleep(10);
+		mx_status = mxp_motor_wait_for_next_status_check( motor,
+						function_list, &poll_interval );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
 	}
 
 	MX_DEBUG( 2,("%s complete for motor '%s'.", fname, motor_record->name));
@@ -1228,7 +1297,7 @@ mx_wait_for_motor_array_stop( long num_motor_records,
 	unsigned long motor_status, error_bitmask;
 	unsigned long hardware_limit_bitmask, software_limit_bitmask;
 	unsigned long ignore_keyboard, ignore_limit_switches;
-	unsigned long ignore_pause;
+	unsigned long ignore_pause, poll_interval;
 	mx_status_type mx_status;
 
 #if MX_MOTOR_DEBUG_WAIT_ARRAY_TIMING
@@ -1265,6 +1334,8 @@ mx_wait_for_motor_array_stop( long num_motor_records,
 	motor_is_moving = TRUE;
 	any_error_occurred = FALSE;
 
+	poll_interval = MX_MOTOR_MIN_POLL_INTERVAL;
+
 	for(;;) {
 		motor_is_moving = FALSE;
 
@@ -1404,11 +1475,17 @@ mx_wait_for_motor_array_stop( long num_motor_records,
 		if ( motor_is_moving == FALSE )
 			break;			/* Exit the for loop. */
 
-		mx_msleep(10);
+		/* Different motors may be handled by different drivers,
+		 * so we do not use the drivers' wait_for_stop() methods
+		 * here.
+		 */
+
+		(void) mxp_motor_wait_for_next_status_check( NULL, NULL,
+							&poll_interval );
 
 #if MX_MOTOR_DEBUG_WAIT_ARRAY_TIMING
 		MX_HRT_END( msleep_measurement );
-		MX_HRT_RESULTS( msleep_measurement, fname, "mx_msleep(10)" );
+		MX_HRT_RESULTS( msleep_measurement, fname, "mx_msleep()" );
 #endif
 	}
 
@@ -956,6 +956,19 @@ typedef struct {
 	mx_status_type ( *special_home_search )( MX_MOTOR *motor );
 	mx_status_type ( *setup_triggered_move )( MX_MOTOR *motor );
 	mx_status_type ( *trigger_move )( MX_MOTOR *motor );
+
+	/* wait_for_stop() is optional.  It should block until the motor
+	 * status may have changed or until timeout_in_seconds has elapsed,
+	 * whichever comes first.  mx_wait_for_motor_stop() still reads the
+	 * motor status after it returns, so spurious wakeups are harmless.
+	 * A driver that cannot wait for this motor should return
+	 * MXE_UNSUPPORTED, which makes the caller fall back to polling.
+	 * The wait must not leave the controller or a remote server with
+	 * extra work to do once the move has finished.
+	 */
+
+	mx_status_type ( *wait_for_stop )( MX_MOTOR *motor,
+					double timeout_in_seconds );
 } MX_MOTOR_FUNCTION_LIST;
 
 typedef mx_status_type
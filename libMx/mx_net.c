@@ -106,6 +106,8 @@ mx_allocate_network_buffer( MX_NETWORK_MESSAGE_BUFFER **message_buffer,
 	(*message_buffer)->buffer_length = initial_length;
 
 	(*message_buffer)->data_format = MX_NETWORK_DATAFMT_ASCII;
+	(*message_buffer)->bulk_data_ptr = NULL;
+	(*message_buffer)->bulk_data_length = 0;
 
 #if NETWORK_DEBUG_BUFFER_ALLOCATION
 	MX_DEBUG(-2,
@@ -531,6 +533,12 @@ mx_network_update_message_id( unsigned long *message_id )
 
 /* ----- */
 
+static mx_bool_type mxp_network_dispatch_response( MX_NETWORK_SERVER *,
+					MX_NETWORK_MESSAGE_BUFFER *, uint32_t );
+
+static void mxp_network_fail_pending_requests( MX_NETWORK_SERVER *,
+					mx_status_type );
+
 #define MX_NETWORK_MAX_ID_MISMATCH    10
 
 MX_EXPORT mx_status_type
@@ -643,6 +651,8 @@ mx_network_wait_for_message_id( MX_RECORD *server_record,
 			 * close the network connection.
 			 */
 
+			mxp_network_fail_pending_requests( server, mx_status );
+
 			(void) mx_close_hardware( server_record );
 
 			return mx_status;
@@ -849,6 +859,20 @@ mx_network_wait_for_message_id( MX_RECORD *server_record,
 			continue;
 		}
 
+		/* Is the message the response to an asynchronous request? */
+
+		if ( server->pending_request_list != NULL ) {
+			if ( mxp_network_dispatch_response( server, buffer,
+						received_message_id ) )
+			{
+				if ( timeout_enabled ) {
+					RETURN_IF_TIMED_OUT;
+				}
+
+				continue;
+			}
+		}
+
 		/* If we get here, then we have received an RPC message that
 		 * does not match the message ID that we were looking for.
 		 */
@@ -2151,6 +2175,40 @@ mx_network_display_message( MX_NETWORK_MESSAGE_BUFFER *message_buffer,
 
 	/*-------------------------------------------------------------------*/
 
+	case MX_NETMSG_GET_BULK_BY_HANDLE:
+		record_handle = mx_ntohl( uint32_message[0] );
+		field_handle  = mx_ntohl( uint32_message[1] );
+
+		fprintf( stderr, "  GET_BULK_BY_HANDLE: (%lu,%lu)\n",
+				(unsigned long) record_handle,
+				(unsigned long) field_handle );
+		break;
+
+	case mx_server_response(MX_NETMSG_GET_BULK_BY_HANDLE):
+		fprintf( stderr, "  GET_BULK_BY_HANDLE response = %lu bytes\n",
+				(unsigned long) message_length );
+		break;
+
+	case MX_NETMSG_GET_ARRAYS:
+	case MX_NETMSG_PUT_ARRAYS:
+	case mx_server_response(MX_NETMSG_GET_ARRAYS):
+	case mx_server_response(MX_NETMSG_PUT_ARRAYS):
+		if ( ( message_type & MX_NETMSG_SERVER_RESPONSE_FLAG ) == 0 ) {
+			fprintf( stderr, "  %s: ",
+			    ( message_type == MX_NETMSG_GET_ARRAYS )
+				? "GET_ARRAYS" : "PUT_ARRAYS" );
+		} else {
+			fprintf( stderr, "  %s response: ",
+			    ( message_type
+				== mx_server_response(MX_NETMSG_GET_ARRAYS) )
+				? "GET_ARRAYS" : "PUT_ARRAYS" );
+		}
+
+		fprintf( stderr, "%lu entries, %lu bytes\n",
+				(unsigned long) mx_ntohl( uint32_message[0] ),
+				(unsigned long) message_length );
+		break;
+
 	case MX_NETMSG_PUT_ARRAY_BY_NAME:
 		fprintf( stderr, "  PUT_ARRAY_BY_NAME: '%s' value = ",
 				char_message );
@@ -2547,6 +2605,24 @@ mx_network_display_summary( MX_NETWORK_MESSAGE_BUFFER *message_buffer,
 
 	/*-------------------------------------------------------------------*/
 
+	case MX_NETMSG_GET_BULK_BY_HANDLE:
+		/* Display nothing. */
+		break;
+
+	case mx_server_response(MX_NETMSG_GET_BULK_BY_HANDLE):
+		if ( ( record_field != NULL )
+		  && ( record_field->record != NULL ) )
+		{
+			fprintf( stderr, "MX get_bulk('%s.%s') = %lu bytes\n",
+				record_field->record->name,
+				record_field->name,
+				(unsigned long) message_length );
+		} else {
+			fprintf( stderr, "MX get_bulk('\?\?\?') = %lu bytes\n",
+				(unsigned long) message_length );
+		}
+		break;
+
 	case MX_NETMSG_PUT_ARRAY_BY_NAME:
 		fprintf( stderr, "MX put_array_by_name('%s') = ",
 				char_message );
@@ -3196,313 +3272,233 @@ mx_put_array_ascii_error_message( uint32_t status_code,
 /* ====================================================================== */
 
 MX_EXPORT mx_status_type
-mx_get_field_array( MX_RECORD *server_record,
-			char *remote_record_field_name,
-			MX_NETWORK_FIELD *nf,
-			MX_RECORD_FIELD *local_field,
-			void *value_ptr )
+mx_get_bulk_array( MX_NETWORK_FIELD *nf,
+		void *buffer,
+		size_t max_bytes,
+		size_t *bytes_received )
 {
-	static const char fname[] = "mx_get_field_array()";
+	static const char fname[] = "mx_get_bulk_array()";
 
 	MX_NETWORK_SERVER *server;
-	MX_NETWORK_SERVER_FUNCTION_LIST *function_list;
-	MX_LIST_HEAD *list_head;
-	char nf_label[NF_LABEL_LENGTH];
-	MX_RECORD_FIELD_PARSE_STATUS temp_parse_status;
-	mx_status_type ( *token_parser )
-		(void *, char *, MX_RECORD *, MX_RECORD_FIELD *,
-		MX_RECORD_FIELD_PARSE_STATUS *);
-	long datatype, num_dimensions, *dimension_array;
-	size_t *data_element_size_array;
-	mx_bool_type array_is_dynamically_allocated;
-	mx_bool_type use_network_handles;
-
 	MX_NETWORK_MESSAGE_BUFFER *aligned_buffer;
 	uint32_t *header, *uint32_message;
-	char *buffer;
 	char *message;
 	uint32_t header_length, message_length;
-	uint32_t send_message_type, receive_message_type;
-	uint32_t status_code;
+	uint32_t receive_message_type, status_code;
+	long dimension[1];
+	mx_bool_type connected;
 	mx_status_type mx_status;
-	char token_buffer[500];
-
-	static char separators[] = MX_RECORD_FIELD_SEPARATORS;
-
-#if NETWORK_DEBUG_TIMING
-	MX_HRT_TIMING measurement;
-#endif
-
-	server = NULL;
-	datatype = -1;
-	num_dimensions = -1;
-	dimension_array = NULL;
-	data_element_size_array = NULL;
-
-	use_network_handles = TRUE;
 
 	if ( nf == (MX_NETWORK_FIELD *) NULL ) {
-		use_network_handles = FALSE;
-
-		/* We are not using a network handle. */
-
-		if ( (server_record == (MX_RECORD *) NULL)
-		  || (remote_record_field_name == (char *) NULL) )
-		{
-			return mx_error( MXE_NULL_ARGUMENT, fname,
-			"If the MX_NETWORK_FIELD argument is NULL, "
-			"the server_record and remote_record_field_name "
-			"arguments must both not be NULL." );
-		}
-	} else {
-		/* In this case, we ignore the values that were passed
-		 * in the server_record and remote_record_field_name
-		 * arguments and use the values from the nf structure
-		 * instead, since we always prefer to use the values
-		 * from MX_NETWORK_FIELD structures.
-		 */
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_NETWORK_FIELD pointer passed was NULL." );
+	}
+	if ( (buffer == NULL) && (max_bytes > 0) ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The buffer pointer passed was NULL." );
+	}
 
-		server_record = nf->server_record;
-		remote_record_field_name = nf->nfname;
+	if ( bytes_received != (size_t *) NULL ) {
+		*bytes_received = 0;
 	}
 
-	mx_status = mx_network_field_get_parameters(
-			server_record, local_field,
-			&datatype, &num_dimensions,
-			&dimension_array, &data_element_size_array,
-			&server, &function_list, fname );
+	mx_status = mx_network_field_is_connected( nf, &connected );
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
-	if ( server->server_supports_network_handles == FALSE ) {
-		use_network_handles = FALSE;
+	if ( connected == FALSE ) {
+		mx_status = mx_network_field_connect( nf );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
 	}
 
-	list_head = mx_get_record_list_head_struct( server_record );
+	server = (MX_NETWORK_SERVER *) nf->server_record->record_class_struct;
 
-	if ( list_head->network_debug_flags & MXF_NETDBG_VERBOSE ) {
-		MX_DEBUG(-2,("\n*** GET ARRAY from '%s'",
-			mx_network_get_nf_label(
-				server_record,
-				remote_record_field_name,
-				nf_label, sizeof(nf_label) )
-			));
-	}
+	/* Servers that predate bulk transfers get an ordinary GET_ARRAY. */
 
-	if ( local_field->flags & MXFF_VARARGS ) {
-		array_is_dynamically_allocated = TRUE;
-	} else {
-		array_is_dynamically_allocated = FALSE;
+	if ( ( server->server_supports_bulk_transfer == FALSE )
+	  || ( server->server_supports_network_handles == FALSE )
+	  || ( mx_server_supports_message_ids(server) == FALSE ) )
+	{
+		dimension[0] = (long) max_bytes;
+
+		mx_status = mx_get_array( nf, MXFT_CHAR, 1, dimension, buffer );
+
+		if ( ( mx_status.code == MXE_SUCCESS )
+		  && ( bytes_received != (size_t *) NULL ) )
+		{
+			*bytes_received = max_bytes;
+		}
+
+		return mx_status;
 	}
 
-	mx_status = mx_network_reconnect_if_down( server_record );
+	mx_status = mx_network_reconnect_if_down( nf->server_record );
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
-	/*********** Send a 'get array' command. *************/
+	/*********** Send a 'get bulk' command. *************/
 
 	aligned_buffer = server->message_buffer;
 
-	header = &(aligned_buffer->u.uint32_buffer[0]);
-	buffer = &(aligned_buffer->u.char_buffer[0]);
+	header = aligned_buffer->u.uint32_buffer;
 
 	header_length = mx_remote_header_length(server);
 
-	header[MX_NETWORK_MAGIC]         = mx_htonl( MX_NETWORK_MAGIC_VALUE );
-	header[MX_NETWORK_HEADER_LENGTH] = mx_htonl( header_length );
-	header[MX_NETWORK_STATUS_CODE]   = mx_htonl( MXE_SUCCESS );
-
-	message = buffer + header_length;
-
 	uint32_message = header + (header_length / sizeof(uint32_t));
 
-	if ( use_network_handles == FALSE ) {
-
-		/* Use ASCII record field name */
-
-		send_message_type = MX_NETMSG_GET_ARRAY_BY_NAME;
-
-		strlcpy( message, remote_record_field_name,
-				MXU_RECORD_FIELD_NAME_LENGTH );
-
-		message_length = (uint32_t) ( strlen( message ) + 1 );
-	} else {
-
-		/* Use binary network handle */
-
-		send_message_type = MX_NETMSG_GET_ARRAY_BY_HANDLE;
-
-		uint32_message[0] = mx_htonl( nf->record_handle );
-		uint32_message[1] = mx_htonl( nf->field_handle );
-
-		message_length = 2 * sizeof( uint32_t );
-	}
-
-	header[MX_NETWORK_MESSAGE_TYPE] = mx_htonl( send_message_type );
-
-	header[MX_NETWORK_MESSAGE_LENGTH] = mx_htonl( message_length );
-
-	server->last_data_type = local_field->datatype;
-
-	if ( mx_server_supports_message_ids(server) ) {
+	header[MX_NETWORK_MAGIC]          = mx_htonl( MX_NETWORK_MAGIC_VALUE );
+	header[MX_NETWORK_HEADER_LENGTH]  = mx_htonl( header_length );
+	header[MX_NETWORK_MESSAGE_LENGTH] = mx_htonl( 2 * sizeof(uint32_t) );
+	header[MX_NETWORK_MESSAGE_TYPE]   =
+				mx_htonl( MX_NETMSG_GET_BULK_BY_HANDLE );
+	header[MX_NETWORK_STATUS_CODE]    = mx_htonl( MXE_SUCCESS );
+	header[MX_NETWORK_DATA_TYPE]      = mx_htonl( MXFT_CHAR );
 
-		header[MX_NETWORK_DATA_TYPE] =
-				mx_htonl( local_field->datatype );
+	mx_network_update_message_id( &(server->last_rpc_message_id) );
 
-		mx_network_update_message_id( &(server->last_rpc_message_id) );
+	header[MX_NETWORK_MESSAGE_ID] = mx_htonl( server->last_rpc_message_id );
 
-		header[MX_NETWORK_MESSAGE_ID] =
-				mx_htonl( server->last_rpc_message_id );
-	}
+	uint32_message[0] = mx_htonl( nf->record_handle );
+	uint32_message[1] = mx_htonl( nf->field_handle );
 
-#if NETWORK_DEBUG_TIMING
-	MX_HRT_START( measurement );
-#endif
+	server->last_data_type = MXFT_CHAR;
 
-	mx_status = mx_network_send_message( server_record, aligned_buffer );
+	mx_status = mx_network_send_message( nf->server_record, aligned_buffer );
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
 	/************* Wait for the response. **************/
 
-	mx_status = mx_network_wait_for_message_id( server_record,
+	/* While bulk_data_ptr is set, the body of a successful response
+	 * is received directly into the caller's buffer.
+	 */
+
+	aligned_buffer->bulk_data_ptr = buffer;
+	aligned_buffer->bulk_data_length = max_bytes;
+
+	mx_status = mx_network_wait_for_message_id( nf->server_record,
 						aligned_buffer,
 						server->last_rpc_message_id,
 						server->timeout );
-#if NETWORK_DEBUG_TIMING
-	MX_HRT_END( measurement );
 
-	if ( use_network_handles == FALSE ) {
-		MX_HRT_RESULTS( measurement, fname, remote_record_field_name );
-	} else {
-		MX_HRT_RESULTS( measurement, fname, "(%ld,%ld) %s",
-				nf->record_handle, nf->field_handle,
-				remote_record_field_name );
-	}
-#endif
+	aligned_buffer->bulk_data_ptr = NULL;
+	aligned_buffer->bulk_data_length = 0;
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
-	/* Update these pointers in case they were
-	 * changed by mx_reallocate_network_buffer()
-	 * in mx_network_wait_for_message_id().
-	 */
-
-	header = &(aligned_buffer->u.uint32_buffer[0]);
-	buffer = &(aligned_buffer->u.char_buffer[0]);
+	header = aligned_buffer->u.uint32_buffer;
 
 	header_length        = mx_ntohl( header[ MX_NETWORK_HEADER_LENGTH ] );
 	message_length       = mx_ntohl( header[ MX_NETWORK_MESSAGE_LENGTH ] );
 	receive_message_type = mx_ntohl( header[ MX_NETWORK_MESSAGE_TYPE ] );
 	status_code          = mx_ntohl( header[ MX_NETWORK_STATUS_CODE ] );
 
-#if 0
-	if ( nf != NULL ) {
-		MX_DEBUG(-2,("%s: nf = %p, server = '%s', field = '%s'",
-			fname, nf, nf->server_record->name, nf->nfname));
-	} else {
-		MX_DEBUG(-2,("%s: nf = %p, server = '%s', field = '%s'",
-			fname, nf, server_record->name,
-			remote_record_field_name));
-	}
-
-	MX_DEBUG(-2,("%s: header_length = %lu, message_length = %lu, "
-		"message_type = %#lx, status_code = %lu", fname,
-		(unsigned long) header_length,
-		(unsigned long) message_length,
-		(unsigned long) message_type,
-		(unsigned long) status_code));
-#endif
-	/* Check to see if the response type matches the send type. */
+	message = aligned_buffer->u.char_buffer + header_length;
 
-	if ( ( server->remote_mx_version < 1005000L )
-	  && ( send_message_type == MX_NETMSG_GET_ARRAY_BY_HANDLE )
-	  && ( receive_message_type == 
-	  		mx_server_response(MX_NETMSG_GET_ARRAY_BY_NAME) ) )
+	if ( receive_message_type
+		!= mx_server_response(MX_NETMSG_GET_BULK_BY_HANDLE) )
 	{
-		/* Bug compatibility for old MX servers. */
+		if ( receive_message_type != MX_NETMSG_UNEXPECTED_ERROR ) {
+			return mx_error( MXE_NETWORK_IO_ERROR, fname,
+			"Message type for response was not %#lx.  "
+			"Instead it was of type = %#lx",
+			(unsigned long)
+			    mx_server_response(MX_NETMSG_GET_BULK_BY_HANDLE),
+			(unsigned long) receive_message_type );
+		}
 
-		/* MX servers prior to MX 1.5 returned the wrong server
-		 * response type for 'get array by handle' messages.
-		 */
-	} else
-	if ( receive_message_type != mx_server_response(send_message_type) ) {
+		switch( status_code ) {
+		case MXE_NOT_YET_IMPLEMENTED:
+			/* The server does not know about bulk transfers,
+			 * so we do not ask again.
+			 */
 
-		if ( receive_message_type == MX_NETMSG_UNEXPECTED_ERROR ) {
-			switch( status_code ) {
-			case MXE_SUCCESS:
-				break;
-			case MXE_BAD_HANDLE:
-				MX_DEBUG( 2,
-		("%s: MXE_BAD_HANDLE seen for server '%s', nfname = '%s'.",
-				fname, nf->server_record->name, nf->nfname));
+			MX_DEBUG( 2,
+	("%s: bulk transfers not implemented for MX server '%s'.",
+				fname, nf->server_record->name ));
 
-				nf->record_handle = MX_ILLEGAL_HANDLE;
-				nf->field_handle = MX_ILLEGAL_HANDLE;
+			server->server_supports_bulk_transfer = FALSE;
 
-				/* Fall through to the default case. */
-			default:
-				return mx_get_array_ascii_error_message(
+			return mx_get_bulk_array( nf, buffer,
+						max_bytes, bytes_received );
+		case MXE_BAD_HANDLE:
+			nf->record_handle = MX_ILLEGAL_HANDLE;
+			nf->field_handle = MX_ILLEGAL_HANDLE;
+
+			/* Fall through to the default case. */
+		default:
+			return mx_get_array_ascii_error_message(
 					status_code,
-					server_record->name,
-					remote_record_field_name,
+					nf->server_record->name,
+					nf->nfname,
 					message );
-			}
 		}
+	}
 
-		return mx_error( MXE_NETWORK_IO_ERROR, fname,
-		"Message type for response was not %#lx.  "
-		"Instead it was of type = %#lx",
-			(unsigned long) mx_server_response( send_message_type ),
-			(unsigned long) receive_message_type );
+	if ( message_length > max_bytes ) {
+		return mx_error( MXE_WOULD_EXCEED_LIMIT, fname,
+		"The %lu bytes returned for '%s:%s' will not fit into "
+		"the %lu byte buffer supplied by the caller.",
+			(unsigned long) message_length,
+			nf->server_record->name, nf->nfname,
+			(unsigned long) max_bytes );
 	}
 
-	message = buffer + header_length;
+	if ( bytes_received != (size_t *) NULL ) {
+		*bytes_received = message_length;
+	}
 
-	/* If the remote command failed, the message field will include
-	 * the text of the error message rather than the array data
-	 * we wanted.
-	 */
+	return MX_SUCCESSFUL_RESULT;
+}
 
-	switch( status_code ) {
-	case MXE_SUCCESS:
-		break;
-	case MXE_BAD_HANDLE:
-		MX_DEBUG( 2,
-		("%s: MXE_BAD_HANDLE seen for server '%s', nfname = '%s'.",
-			fname, nf->server_record->name, nf->nfname));
+/* ====================================================================== */
 
-		nf->record_handle = MX_ILLEGAL_HANDLE;
-		nf->field_handle = MX_ILLEGAL_HANDLE;
+/* mxp_network_decode_field_value() converts a field value received from
+ * a server into the local representation.  It is used both for ordinary
+ * GET_ARRAY responses and for the entries of a GET_ARRAYS response.
+ */
 
-		/* Fall through to the default case. */
-	default:
-		return mx_get_array_ascii_error_message(
-				status_code,
-				server_record->name,
-				remote_record_field_name,
-				message );
-	}
+static mx_status_type
+mxp_network_decode_field_value( MX_RECORD *server_record,
+				char *remote_record_field_name,
+				MX_RECORD_FIELD *local_field,
+				void *value_ptr,
+				char *message,
+				uint32_t message_length )
+{
+	static const char fname[] = "mxp_network_decode_field_value()";
 
-	if ( list_head->network_debug_flags & MXF_NETDBG_SUMMARY ) {
-		mx_network_get_remote_field_label( NULL, server_record,
-						remote_record_field_name, NULL,
-						nf_label, sizeof(nf_label) );
+	MX_NETWORK_SERVER *server;
+	MX_RECORD_FIELD_PARSE_STATUS temp_parse_status;
+	mx_status_type ( *token_parser )
+		(void *, char *, MX_RECORD *, MX_RECORD_FIELD *,
+		MX_RECORD_FIELD_PARSE_STATUS *);
+	long datatype, num_dimensions, *dimension_array;
+	size_t *data_element_size_array;
+	mx_bool_type array_is_dynamically_allocated;
+	mx_status_type mx_status;
+	char token_buffer[500];
 
-		fprintf( stderr, "MX GET_ARRAY('%s') = ", nf_label );
+	static char separators[] = MX_RECORD_FIELD_SEPARATORS;
 
-		mx_network_buffer_show_value( message, server->data_format,
-					datatype, receive_message_type,
-					message_length,
-					server->use_64bit_network_longs );
-		fprintf( stderr, "\n" );
-	}
+	server = (MX_NETWORK_SERVER *) server_record->record_class_struct;
 
-	/************ Parse the data that was returned. ***************/
+	datatype = local_field->datatype;
+	num_dimensions = local_field->num_dimensions;
+	dimension_array = local_field->dimension;
+	data_element_size_array = local_field->data_element_size;
+
+	if ( local_field->flags & MXFF_VARARGS ) {
+		array_is_dynamically_allocated = TRUE;
+	} else {
+		array_is_dynamically_allocated = FALSE;
+	}
 
 	switch( datatype ) {
 	case MXFT_RECORD:
@@ -3662,41 +3658,29 @@ mx_get_field_array( MX_RECORD *server_record,
 /* ====================================================================== */
 
 MX_EXPORT mx_status_type
-mx_put_field_array( MX_RECORD *server_record,
+mx_get_field_array( MX_RECORD *server_record,
 			char *remote_record_field_name,
 			MX_NETWORK_FIELD *nf,
 			MX_RECORD_FIELD *local_field,
 			void *value_ptr )
 {
-	static const char fname[] = "mx_put_field_array()";
+	static const char fname[] = "mx_get_field_array()";
 
 	MX_NETWORK_SERVER *server;
 	MX_NETWORK_SERVER_FUNCTION_LIST *function_list;
 	MX_LIST_HEAD *list_head;
-	char nf_label[80];
-	mx_status_type ( *token_constructor )
-		(void *, char *, size_t, MX_RECORD *, MX_RECORD_FIELD *);
+	char nf_label[NF_LABEL_LENGTH];
 	long datatype, num_dimensions, *dimension_array;
 	size_t *data_element_size_array;
-	mx_bool_type array_is_dynamically_allocated;
 	mx_bool_type use_network_handles;
 
 	MX_NETWORK_MESSAGE_BUFFER *aligned_buffer;
 	uint32_t *header, *uint32_message;
-	char *message, *ptr, *name_ptr;
-	unsigned long i, j, max_attempts;
-
-#if defined(_WIN64)
-	uint64_t xdr_ptr_address, xdr_remainder_value, xdr_gap_size;
-#else
-	unsigned long xdr_ptr_address, xdr_remainder_value, xdr_gap_size;
-#endif
-	uint32_t header_length, field_id_length;
-	uint32_t message_length, saved_message_length, max_message_length;
+	char *buffer;
+	char *message;
+	uint32_t header_length, message_length;
 	uint32_t send_message_type, receive_message_type;
 	uint32_t status_code;
-	size_t buffer_left, num_network_bytes;
-	size_t current_length, new_length;
 	mx_status_type mx_status;
 
 #if NETWORK_DEBUG_TIMING
@@ -3752,7 +3736,7 @@ mx_put_field_array( MX_RECORD *server_record,
 	list_head = mx_get_record_list_head_struct( server_record );
 
 	if ( list_head->network_debug_flags & MXF_NETDBG_VERBOSE ) {
-		MX_DEBUG(-2,("\n*** PUT ARRAY to '%s'",
+		MX_DEBUG(-2,("\n*** GET ARRAY from '%s'",
 			mx_network_get_nf_label(
 				server_record,
 				remote_record_field_name,
@@ -3760,162 +3744,351 @@ mx_put_field_array( MX_RECORD *server_record,
 			));
 	}
 
-	if ( local_field->flags & MXFF_VARARGS ) {
-		array_is_dynamically_allocated = TRUE;
-	} else {
-		array_is_dynamically_allocated = FALSE;
-	}
-
 	mx_status = mx_network_reconnect_if_down( server_record );
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
-	/************ Construct a 'put array' command. *************/
+	/*********** Send a 'get array' command. *************/
 
 	aligned_buffer = server->message_buffer;
 
-	header  = aligned_buffer->u.uint32_buffer;
+	header = &(aligned_buffer->u.uint32_buffer[0]);
+	buffer = &(aligned_buffer->u.char_buffer[0]);
 
 	header_length = mx_remote_header_length(server);
 
-	message = aligned_buffer->u.char_buffer + header_length;
-
-	max_message_length = aligned_buffer->buffer_length - header_length;
-
-	uint32_message = header + (header_length / sizeof(uint32_t));
-
 	header[MX_NETWORK_MAGIC]         = mx_htonl( MX_NETWORK_MAGIC_VALUE );
 	header[MX_NETWORK_HEADER_LENGTH] = mx_htonl( header_length );
 	header[MX_NETWORK_STATUS_CODE]   = mx_htonl( MXE_SUCCESS );
 
-	if ( mx_server_supports_message_ids(server) ) {
-
-		header[MX_NETWORK_DATA_TYPE] =
-				mx_htonl( local_field->datatype );
-
-		mx_network_update_message_id( &(server->last_rpc_message_id) );
+	message = buffer + header_length;
 
-		header[MX_NETWORK_MESSAGE_ID] =
-				mx_htonl( server->last_rpc_message_id );
-	}
+	uint32_message = header + (header_length / sizeof(uint32_t));
 
 	if ( use_network_handles == FALSE ) {
 
 		/* Use ASCII record field name */
 
-		send_message_type = MX_NETMSG_PUT_ARRAY_BY_NAME;
+		send_message_type = MX_NETMSG_GET_ARRAY_BY_NAME;
 
-		snprintf( message, max_message_length,
-				"%*s", -MXU_RECORD_FIELD_NAME_LENGTH,
-				remote_record_field_name );
+		strlcpy( message, remote_record_field_name,
+				MXU_RECORD_FIELD_NAME_LENGTH );
 
-		field_id_length = MXU_RECORD_FIELD_NAME_LENGTH;
+		message_length = (uint32_t) ( strlen( message ) + 1 );
 	} else {
 
 		/* Use binary network handle */
 
-		send_message_type = MX_NETMSG_PUT_ARRAY_BY_HANDLE;
+		send_message_type = MX_NETMSG_GET_ARRAY_BY_HANDLE;
 
 		uint32_message[0] = mx_htonl( nf->record_handle );
 		uint32_message[1] = mx_htonl( nf->field_handle );
 
-		field_id_length = 2 * sizeof( uint32_t );
+		message_length = 2 * sizeof( uint32_t );
 	}
 
 	header[MX_NETWORK_MESSAGE_TYPE] = mx_htonl( send_message_type );
 
-	ptr = message + field_id_length;
-
-	MX_DEBUG( 2,("%s: message = %p, ptr = %p, field_id_length = %lu",
-		fname, message, ptr, (unsigned long) field_id_length));
+	header[MX_NETWORK_MESSAGE_LENGTH] = mx_htonl( message_length );
 
-	buffer_left = aligned_buffer->buffer_length
-			- header_length - field_id_length;
+	server->last_data_type = local_field->datatype;
 
-	/* Construct the data to send.   We use a retry loop here in case
-	 * we need to increase the size of the network buffer to make the
-	 * message fit.
-	 */
+	if ( mx_server_supports_message_ids(server) ) {
 
-	max_attempts = 10;
+		header[MX_NETWORK_DATA_TYPE] =
+				mx_htonl( local_field->datatype );
 
-	message_length = field_id_length;
+		mx_network_update_message_id( &(server->last_rpc_message_id) );
 
-	for ( i = 0; i < max_attempts; i++ ) {
+		header[MX_NETWORK_MESSAGE_ID] =
+				mx_htonl( server->last_rpc_message_id );
+	}
 
-	    saved_message_length = message_length;
+#if NETWORK_DEBUG_TIMING
+	MX_HRT_START( measurement );
+#endif
 
-	    switch( server->data_format ) {
-	    case MX_NETWORK_DATAFMT_ASCII:
+	mx_status = mx_network_send_message( server_record, aligned_buffer );
 
-		/* Send the data using the ASCII MX database format. */
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
 
-		mx_status = mx_get_token_constructor( datatype,
-						&token_constructor );
+	/************* Wait for the response. **************/
 
-		if ( mx_status.code != MXE_SUCCESS )
-			return mx_status;
+	mx_status = mx_network_wait_for_message_id( server_record,
+						aligned_buffer,
+						server->last_rpc_message_id,
+						server->timeout );
+#if NETWORK_DEBUG_TIMING
+	MX_HRT_END( measurement );
 
-		if ( (num_dimensions == 0)
-		  || ((datatype == MXFT_STRING) && (num_dimensions == 1)) )
-		{
-			mx_status = (*token_constructor) ( value_ptr, ptr,
-			    aligned_buffer->buffer_length -
-			    	( ptr - aligned_buffer->u.char_buffer ),
-			    NULL, local_field );
-		} else {
-			mx_status = mx_create_array_description( value_ptr, 
-			    local_field->num_dimensions - 1, ptr,
-			    aligned_buffer->buffer_length -
-			    	( ptr - aligned_buffer->u.char_buffer ),
-			    NULL, local_field, token_constructor );
-		}
+	if ( use_network_handles == FALSE ) {
+		MX_HRT_RESULTS( measurement, fname, remote_record_field_name );
+	} else {
+		MX_HRT_RESULTS( measurement, fname, "(%ld,%ld) %s",
+				nf->record_handle, nf->field_handle,
+				remote_record_field_name );
+	}
+#endif
 
-		if ( mx_status.code != MXE_SUCCESS )
-			return mx_status;
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
 
-		/* The extra 1 is for the '\0' byte at the end of the string. */
+	/* Update these pointers in case they were
+	 * changed by mx_reallocate_network_buffer()
+	 * in mx_network_wait_for_message_id().
+	 */
 
-		message_length += 1 + strlen( ptr );
+	header = &(aligned_buffer->u.uint32_buffer[0]);
+	buffer = &(aligned_buffer->u.char_buffer[0]);
 
-		/* ASCII data transfers do not currently support dynamically
-		 * resizing network buffers, so we return instead if we get
-		 * an MXE_WOULD_EXCEED_LIMIT status code.
-		 */
+	header_length        = mx_ntohl( header[ MX_NETWORK_HEADER_LENGTH ] );
+	message_length       = mx_ntohl( header[ MX_NETWORK_MESSAGE_LENGTH ] );
+	receive_message_type = mx_ntohl( header[ MX_NETWORK_MESSAGE_TYPE ] );
+	status_code          = mx_ntohl( header[ MX_NETWORK_STATUS_CODE ] );
 
-		num_network_bytes = 0;
+#if 0
+	if ( nf != NULL ) {
+		MX_DEBUG(-2,("%s: nf = %p, server = '%s', field = '%s'",
+			fname, nf, nf->server_record->name, nf->nfname));
+	} else {
+		MX_DEBUG(-2,("%s: nf = %p, server = '%s', field = '%s'",
+			fname, nf, server_record->name,
+			remote_record_field_name));
+	}
 
-		if ( mx_status.code == MXE_WOULD_EXCEED_LIMIT )
-			return mx_status;
-		break;
+	MX_DEBUG(-2,("%s: header_length = %lu, message_length = %lu, "
+		"message_type = %#lx, status_code = %lu", fname,
+		(unsigned long) header_length,
+		(unsigned long) message_length,
+		(unsigned long) message_type,
+		(unsigned long) status_code));
+#endif
+	/* Check to see if the response type matches the send type. */
 
-	    case MX_NETWORK_DATAFMT_RAW:
-		mx_status = mx_copy_array_to_network_buffer( value_ptr,
-				array_is_dynamically_allocated,
-				datatype, num_dimensions,
-				dimension_array, data_element_size_array,
-				ptr, buffer_left,
-				&num_network_bytes,
-				server->use_64bit_network_longs );
+	if ( ( server->remote_mx_version < 1005000L )
+	  && ( send_message_type == MX_NETMSG_GET_ARRAY_BY_HANDLE )
+	  && ( receive_message_type == 
+	  		mx_server_response(MX_NETMSG_GET_ARRAY_BY_NAME) ) )
+	{
+		/* Bug compatibility for old MX servers. */
 
-		switch( mx_status.code ) {
-		case MXE_SUCCESS:
-		case MXE_WOULD_EXCEED_LIMIT:
-			break;
-		default:
-			/* Only display an error message here if the returned
-			 * error code was not MXE_WOULD_EXCEED_LIMIT, since
-			 * MXE_WOULD_EXCEED_LIMIT is used to request that the
-			 * network buffer be increased in size.
-			 */
+		/* MX servers prior to MX 1.5 returned the wrong server
+		 * response type for 'get array by handle' messages.
+		 */
+	} else
+	if ( receive_message_type != mx_server_response(send_message_type) ) {
 
-			(void) mx_error( mx_status.code, fname,
-	"Buffer copy for MX_PUT of parameter '%s' in server '%s' failed.",
+		if ( receive_message_type == MX_NETMSG_UNEXPECTED_ERROR ) {
+			switch( status_code ) {
+			case MXE_SUCCESS:
+				break;
+			case MXE_BAD_HANDLE:
+				MX_DEBUG( 2,
+		("%s: MXE_BAD_HANDLE seen for server '%s', nfname = '%s'.",
+				fname, nf->server_record->name, nf->nfname));
+
+				nf->record_handle = MX_ILLEGAL_HANDLE;
+				nf->field_handle = MX_ILLEGAL_HANDLE;
+
+				/* Fall through to the default case. */
+			default:
+				return mx_get_array_ascii_error_message(
+					status_code,
+					server_record->name,
+					remote_record_field_name,
+					message );
+			}
+		}
+
+		return mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"Message type for response was not %#lx.  "
+		"Instead it was of type = %#lx",
+			(unsigned long) mx_server_response( send_message_type ),
+			(unsigned long) receive_message_type );
+	}
+
+	message = buffer + header_length;
+
+	/* If the remote command failed, the message field will include
+	 * the text of the error message rather than the array data
+	 * we wanted.
+	 */
+
+	switch( status_code ) {
+	case MXE_SUCCESS:
+		break;
+	case MXE_BAD_HANDLE:
+		MX_DEBUG( 2,
+		("%s: MXE_BAD_HANDLE seen for server '%s', nfname = '%s'.",
+			fname, nf->server_record->name, nf->nfname));
+
+		nf->record_handle = MX_ILLEGAL_HANDLE;
+		nf->field_handle = MX_ILLEGAL_HANDLE;
+
+		/* Fall through to the default case. */
+	default:
+		return mx_get_array_ascii_error_message(
+				status_code,
+				server_record->name,
+				remote_record_field_name,
+				message );
+	}
+
+	if ( list_head->network_debug_flags & MXF_NETDBG_SUMMARY ) {
+		mx_network_get_remote_field_label( NULL, server_record,
+						remote_record_field_name, NULL,
+						nf_label, sizeof(nf_label) );
+
+		fprintf( stderr, "MX GET_ARRAY('%s') = ", nf_label );
+
+		mx_network_buffer_show_value( message, server->data_format,
+					datatype, receive_message_type,
+					message_length,
+					server->use_64bit_network_longs );
+		fprintf( stderr, "\n" );
+	}
+
+	/************ Parse the data that was returned. ***************/
+
+	mx_status = mxp_network_decode_field_value( server_record,
+					remote_record_field_name,
+					local_field, value_ptr,
+					message, message_length );
+
+	return mx_status;
+}
+
+/* ====================================================================== */
+
+/* mxp_network_encode_field_value() converts a local value into the data
+ * format used by the server connection and writes it into the message
+ * buffer starting at byte 'offset'.  The buffer is made larger if the
+ * value does not fit.  It is used both for ordinary PUT_ARRAY messages
+ * and for the entries of a PUT_ARRAYS message.
+ */
+
+static mx_status_type
+mxp_network_encode_field_value( MX_RECORD *server_record,
+				char *remote_record_field_name,
+				MX_RECORD_FIELD *local_field,
+				void *value_ptr,
+				MX_NETWORK_MESSAGE_BUFFER *aligned_buffer,
+				size_t offset,
+				size_t *num_bytes_used )
+{
+	static const char fname[] = "mxp_network_encode_field_value()";
+
+	MX_NETWORK_SERVER *server;
+	mx_status_type ( *token_constructor )
+		(void *, char *, size_t, MX_RECORD *, MX_RECORD_FIELD *);
+	long datatype, num_dimensions, *dimension_array;
+	size_t *data_element_size_array;
+	mx_bool_type array_is_dynamically_allocated;
+	char *ptr;
+	unsigned long i, j, max_attempts;
+
+#if defined(_WIN64)
+	uint64_t xdr_ptr_address, xdr_remainder_value, xdr_gap_size;
+#else
+	unsigned long xdr_ptr_address, xdr_remainder_value, xdr_gap_size;
+#endif
+	size_t buffer_left, num_network_bytes;
+	size_t current_length, new_length;
+	mx_status_type mx_status;
+
+	server = (MX_NETWORK_SERVER *) server_record->record_class_struct;
+
+	datatype = local_field->datatype;
+	num_dimensions = local_field->num_dimensions;
+	dimension_array = local_field->dimension;
+	data_element_size_array = local_field->data_element_size;
+
+	if ( local_field->flags & MXFF_VARARGS ) {
+		array_is_dynamically_allocated = TRUE;
+	} else {
+		array_is_dynamically_allocated = FALSE;
+	}
+
+	*num_bytes_used = 0;
+
+	/* We use a retry loop here in case we need to increase the size
+	 * of the network buffer to make the message fit.
+	 */
+
+	max_attempts = 10;
+
+	for ( i = 0; i < max_attempts; i++ ) {
+
+	    ptr = aligned_buffer->u.char_buffer + offset;
+
+	    buffer_left = aligned_buffer->buffer_length - offset;
+
+	    num_network_bytes = 0;
+
+	    switch( server->data_format ) {
+	    case MX_NETWORK_DATAFMT_ASCII:
+
+		/* Send the data using the ASCII MX database format. */
+
+		mx_status = mx_get_token_constructor( datatype,
+						&token_constructor );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		if ( (num_dimensions == 0)
+		  || ((datatype == MXFT_STRING) && (num_dimensions == 1)) )
+		{
+			mx_status = (*token_constructor) ( value_ptr, ptr,
+					buffer_left, NULL, local_field );
+		} else {
+			mx_status = mx_create_array_description( value_ptr, 
+					local_field->num_dimensions - 1,
+					ptr, buffer_left,
+					NULL, local_field, token_constructor );
+		}
+
+		/* ASCII data transfers do not currently support dynamically
+		 * resizing network buffers, so we return instead if we get
+		 * an MXE_WOULD_EXCEED_LIMIT status code.
+		 */
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		/* The extra 1 is for the '\0' byte at the end of the string. */
+
+		*num_bytes_used = 1 + strlen( ptr );
+		break;
+
+	    case MX_NETWORK_DATAFMT_RAW:
+		mx_status = mx_copy_array_to_network_buffer( value_ptr,
+				array_is_dynamically_allocated,
+				datatype, num_dimensions,
+				dimension_array, data_element_size_array,
+				ptr, buffer_left,
+				&num_network_bytes,
+				server->use_64bit_network_longs );
+
+		switch( mx_status.code ) {
+		case MXE_SUCCESS:
+		case MXE_WOULD_EXCEED_LIMIT:
+			break;
+		default:
+			/* Only display an error message here if the returned
+			 * error code was not MXE_WOULD_EXCEED_LIMIT, since
+			 * MXE_WOULD_EXCEED_LIMIT is used to request that the
+			 * network buffer be increased in size.
+			 */
+
+			return mx_error( mx_status.code, fname,
+	"Buffer copy for MX_PUT of parameter '%s' in server '%s' failed.",
 				remote_record_field_name, server_record->name );
 		}
 
-		message_length += num_network_bytes;
+		*num_bytes_used = num_network_bytes;
 		break;
 
 	    case MX_NETWORK_DATAFMT_XDR:
@@ -3936,6 +4109,8 @@ mx_put_field_array( MX_RECORD *server_record,
 
 		xdr_remainder_value = xdr_ptr_address % 4;
 
+		xdr_gap_size = 0;
+
 		if ( xdr_remainder_value != 0 ) {
 			xdr_gap_size = 4 - xdr_remainder_value;
 
@@ -3945,7 +4120,7 @@ mx_put_field_array( MX_RECORD *server_record,
 
 			ptr += xdr_gap_size;
 
-			message_length += xdr_gap_size;
+			buffer_left -= xdr_gap_size;
 		}
 
 		/* Now we are ready to do the XDR data conversion. */
@@ -3969,12 +4144,12 @@ mx_put_field_array( MX_RECORD *server_record,
 			 * network buffer be increased in size.
 			 */
 
-			(void) mx_error( mx_status.code, fname,
+			return mx_error( mx_status.code, fname,
 	"Buffer copy for MX_PUT of parameter '%s' in server '%s' failed.",
 				remote_record_field_name, server_record->name );
 		}
 
-		message_length += num_network_bytes;
+		*num_bytes_used = xdr_gap_size + num_network_bytes;
 #else
 		return mx_error( MXE_UNSUPPORTED, fname,
 			"XDR network data format is not supported "
@@ -3988,10 +4163,7 @@ mx_put_field_array( MX_RECORD *server_record,
 			server->data_format );
 	    }
 
-	    /* If we succeeded or if some error other than 
-	     * MXE_WOULD_EXCEED_LIMIT occurred, break out
-	     * of the for(i) loop.
-	     */
+	    /* If we succeeded, break out of the for(i) loop. */
 
 	    if ( mx_status.code != MXE_WOULD_EXCEED_LIMIT ) {
 		break;
@@ -4014,82 +4186,235 @@ mx_put_field_array( MX_RECORD *server_record,
 
 	    if ( mx_status.code != MXE_SUCCESS )
 		    return mx_status;
-
-	    /* Update some values that reallocation will have changed. */
-
-	    header  = aligned_buffer->u.uint32_buffer;
-	    message = aligned_buffer->u.char_buffer + header_length;
-
-	    /* Revert back to the buffer location before the failed copy. */
-
-	    message_length = saved_message_length;
-
-	    ptr         = message + message_length;
-	    buffer_left = aligned_buffer->buffer_length
-		    		- header_length - message_length;
 	}
 
 	if ( i >= max_attempts ) {
-		if ( nf == NULL ) {
-			name_ptr = remote_record_field_name;
-		} else {
-			name_ptr = nf->nfname;
-		}
 		return mx_error( MXE_UNKNOWN_ERROR, fname,
 		"%lu attempts to increase the network buffer size for "
 		"record field '%s' failed.  "
 		"You should never see this error.",
-			max_attempts, name_ptr );
+			max_attempts, remote_record_field_name );
 	}
 
-	header[MX_NETWORK_MESSAGE_LENGTH] = mx_htonl( message_length );
-
-	MX_DEBUG( 2,("%s: message = '%s'", fname, message));
-
-	if ( list_head->network_debug_flags & MXF_NETDBG_SUMMARY ) {
-		unsigned long handle_length;
-
-		mx_network_get_remote_field_label( NULL, server_record,
-						remote_record_field_name, NULL,
-						nf_label, sizeof(nf_label) );
+	return MX_SUCCESSFUL_RESULT;
+}
 
-		fprintf( stderr, "MX PUT_ARRAY('%s', ", nf_label );
+/* ====================================================================== */
 
-		handle_length = 2 * sizeof(uint32_t);
+MX_EXPORT mx_status_type
+mx_put_field_array( MX_RECORD *server_record,
+			char *remote_record_field_name,
+			MX_NETWORK_FIELD *nf,
+			MX_RECORD_FIELD *local_field,
+			void *value_ptr )
+{
+	static const char fname[] = "mx_put_field_array()";
 
-		mx_network_buffer_show_value( message + handle_length,
-					server->data_format,
-					datatype, send_message_type,
-					message_length - handle_length,
-					server->use_64bit_network_longs );
-		fprintf( stderr, ")\n" );
-	}
+	MX_NETWORK_SERVER *server;
+	MX_NETWORK_SERVER_FUNCTION_LIST *function_list;
+	MX_LIST_HEAD *list_head;
+	char nf_label[80];
+	long datatype, num_dimensions, *dimension_array;
+	size_t *data_element_size_array;
+	mx_bool_type use_network_handles;
 
-	message_length += header_length;
+	MX_NETWORK_MESSAGE_BUFFER *aligned_buffer;
+	uint32_t *header, *uint32_message;
+	char *message;
+	uint32_t header_length, field_id_length;
+	uint32_t message_length, max_message_length;
+	uint32_t send_message_type, receive_message_type;
+	uint32_t status_code;
+	size_t num_network_bytes;
+	mx_status_type mx_status;
 
 #if NETWORK_DEBUG_TIMING
-	MX_HRT_START( measurement );
+	MX_HRT_TIMING measurement;
 #endif
 
-	/*************** Send the message. **************/
-
-	mx_status = mx_network_send_message( server_record, aligned_buffer );
+	server = NULL;
+	datatype = -1;
+	num_dimensions = -1;
+	dimension_array = NULL;
+	data_element_size_array = NULL;
 
-	if ( mx_status.code != MXE_SUCCESS )
-		return mx_status;
+	use_network_handles = TRUE;
 
-	/************** Wait for the response. ************/
+	if ( nf == (MX_NETWORK_FIELD *) NULL ) {
+		use_network_handles = FALSE;
 
-	mx_status = mx_network_wait_for_message_id( server_record,
-						aligned_buffer,
-						server->last_rpc_message_id,
-						server->timeout );
-#if NETWORK_DEBUG_TIMING
-	MX_HRT_END( measurement );
+		/* We are not using a network handle. */
 
-	if ( use_network_handles == FALSE ) {
-		MX_HRT_RESULTS( measurement, fname, remote_record_field_name );
-	} else {
+		if ( (server_record == (MX_RECORD *) NULL)
+		  || (remote_record_field_name == (char *) NULL) )
+		{
+			return mx_error( MXE_NULL_ARGUMENT, fname,
+			"If the MX_NETWORK_FIELD argument is NULL, "
+			"the server_record and remote_record_field_name "
+			"arguments must both not be NULL." );
+		}
+	} else {
+		/* In this case, we ignore the values that were passed
+		 * in the server_record and remote_record_field_name
+		 * arguments and use the values from the nf structure
+		 * instead, since we always prefer to use the values
+		 * from MX_NETWORK_FIELD structures.
+		 */
+
+		server_record = nf->server_record;
+		remote_record_field_name = nf->nfname;
+	}
+
+	mx_status = mx_network_field_get_parameters(
+			server_record, local_field,
+			&datatype, &num_dimensions,
+			&dimension_array, &data_element_size_array,
+			&server, &function_list, fname );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	if ( server->server_supports_network_handles == FALSE ) {
+		use_network_handles = FALSE;
+	}
+
+	list_head = mx_get_record_list_head_struct( server_record );
+
+	if ( list_head->network_debug_flags & MXF_NETDBG_VERBOSE ) {
+		MX_DEBUG(-2,("\n*** PUT ARRAY to '%s'",
+			mx_network_get_nf_label(
+				server_record,
+				remote_record_field_name,
+				nf_label, sizeof(nf_label) )
+			));
+	}
+
+	mx_status = mx_network_reconnect_if_down( server_record );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	/************ Construct a 'put array' command. *************/
+
+	aligned_buffer = server->message_buffer;
+
+	header  = aligned_buffer->u.uint32_buffer;
+
+	header_length = mx_remote_header_length(server);
+
+	message = aligned_buffer->u.char_buffer + header_length;
+
+	max_message_length = aligned_buffer->buffer_length - header_length;
+
+	uint32_message = header + (header_length / sizeof(uint32_t));
+
+	header[MX_NETWORK_MAGIC]         = mx_htonl( MX_NETWORK_MAGIC_VALUE );
+	header[MX_NETWORK_HEADER_LENGTH] = mx_htonl( header_length );
+	header[MX_NETWORK_STATUS_CODE]   = mx_htonl( MXE_SUCCESS );
+
+	if ( mx_server_supports_message_ids(server) ) {
+
+		header[MX_NETWORK_DATA_TYPE] =
+				mx_htonl( local_field->datatype );
+
+		mx_network_update_message_id( &(server->last_rpc_message_id) );
+
+		header[MX_NETWORK_MESSAGE_ID] =
+				mx_htonl( server->last_rpc_message_id );
+	}
+
+	if ( use_network_handles == FALSE ) {
+
+		/* Use ASCII record field name */
+
+		send_message_type = MX_NETMSG_PUT_ARRAY_BY_NAME;
+
+		snprintf( message, max_message_length,
+				"%*s", -MXU_RECORD_FIELD_NAME_LENGTH,
+				remote_record_field_name );
+
+		field_id_length = MXU_RECORD_FIELD_NAME_LENGTH;
+	} else {
+
+		/* Use binary network handle */
+
+		send_message_type = MX_NETMSG_PUT_ARRAY_BY_HANDLE;
+
+		uint32_message[0] = mx_htonl( nf->record_handle );
+		uint32_message[1] = mx_htonl( nf->field_handle );
+
+		field_id_length = 2 * sizeof( uint32_t );
+	}
+
+	header[MX_NETWORK_MESSAGE_TYPE] = mx_htonl( send_message_type );
+
+	/* Construct the data to send. */
+
+	mx_status = mxp_network_encode_field_value( server_record,
+					remote_record_field_name,
+					local_field, value_ptr,
+					aligned_buffer,
+					header_length + field_id_length,
+					&num_network_bytes );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	/* Update some values that reallocation may have changed. */
+
+	header  = aligned_buffer->u.uint32_buffer;
+	message = aligned_buffer->u.char_buffer + header_length;
+
+	message_length = (uint32_t) ( field_id_length + num_network_bytes );
+
+	header[MX_NETWORK_MESSAGE_LENGTH] = mx_htonl( message_length );
+
+	MX_DEBUG( 2,("%s: message = '%s'", fname, message));
+
+	if ( list_head->network_debug_flags & MXF_NETDBG_SUMMARY ) {
+		unsigned long handle_length;
+
+		mx_network_get_remote_field_label( NULL, server_record,
+						remote_record_field_name, NULL,
+						nf_label, sizeof(nf_label) );
+
+		fprintf( stderr, "MX PUT_ARRAY('%s', ", nf_label );
+
+		handle_length = 2 * sizeof(uint32_t);
+
+		mx_network_buffer_show_value( message + handle_length,
+					server->data_format,
+					datatype, send_message_type,
+					message_length - handle_length,
+					server->use_64bit_network_longs );
+		fprintf( stderr, ")\n" );
+	}
+
+	message_length += header_length;
+
+#if NETWORK_DEBUG_TIMING
+	MX_HRT_START( measurement );
+#endif
+
+	/*************** Send the message. **************/
+
+	mx_status = mx_network_send_message( server_record, aligned_buffer );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	/************** Wait for the response. ************/
+
+	mx_status = mx_network_wait_for_message_id( server_record,
+						aligned_buffer,
+						server->last_rpc_message_id,
+						server->timeout );
+#if NETWORK_DEBUG_TIMING
+	MX_HRT_END( measurement );
+
+	if ( use_network_handles == FALSE ) {
+		MX_HRT_RESULTS( measurement, fname, remote_record_field_name );
+	} else {
 		MX_HRT_RESULTS( measurement, fname, "(%ld,%ld) %s",
 				nf->record_handle, nf->field_handle,
 				remote_record_field_name );
@@ -4177,6 +4502,1075 @@ mx_put_field_array( MX_RECORD *server_record,
 
 /* ====================================================================== */
 
+/* The following functions implement mx_get_arrays() and mx_put_arrays().
+ * While a batch is being transferred, the status_code of each transfer
+ * is used to keep track of how far it has gotten.
+ */
+
+#define MXP_TRANSFER_PENDING	(-1L)
+#define MXP_TRANSFER_SENT	(-2L)
+
+#define MXP_ARRAYS_ENTRY_LENGTH	(4 * sizeof(uint32_t))
+
+#define mxp_arrays_padded_length(x)	( ((x) + 7) & ~((size_t) 7) )
+
+static mx_status_type
+mxp_network_setup_transfer_field( MX_NETWORK_FIELD_TRANSFER *transfer,
+				MX_RECORD_FIELD *local_field,
+				long *local_dimension_array,
+				size_t *data_element_size )
+{
+	static const char fname[] = "mxp_network_setup_transfer_field()";
+
+	long *dimension_array;
+	mx_status_type mx_status;
+
+	if ( transfer->dimension != NULL ) {
+		dimension_array = transfer->dimension;
+
+	} else if ( transfer->num_dimensions == 0 ) {
+		dimension_array = local_dimension_array;
+		dimension_array[0] = 0;
+	} else {
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+"dimension array pointer is NULL, but num_dimensions (%ld) is greater than 0",
+			transfer->num_dimensions );
+	}
+
+	data_element_size[0] = 0L;
+
+	mx_status = mx_initialize_temp_record_field( local_field,
+			transfer->datatype, transfer->num_dimensions,
+			dimension_array, data_element_size,
+			transfer->value_ptr );
+
+	return mx_status;
+}
+
+/*----*/
+
+static mx_status_type
+mxp_network_transfer_server_arrays( MX_RECORD *server_record,
+				uint32_t send_message_type,
+				long num_transfers,
+				MX_NETWORK_FIELD_TRANSFER *transfer_array )
+{
+	static const char fname[] = "mxp_network_transfer_server_arrays()";
+
+	MX_NETWORK_SERVER *server;
+	MX_NETWORK_FIELD_TRANSFER *transfer;
+	MX_NETWORK_FIELD *nf;
+	MX_RECORD_FIELD local_temp_record_field;
+	long local_dimension_array[MXU_FIELD_MAX_DIMENSIONS];
+	size_t data_element_size[MXU_FIELD_MAX_DIMENSIONS];
+	MX_NETWORK_MESSAGE_BUFFER *aligned_buffer;
+	uint32_t *header, *entry;
+	char *message, *value;
+	uint32_t header_length, message_length;
+	uint32_t receive_message_type, status_code;
+	uint32_t value_length;
+	size_t offset, entry_offset, num_value_bytes, padded_length;
+	size_t min_length;
+	long i, num_sent;
+	mx_bool_type connected;
+	mx_status_type mx_status, first_error;
+
+	server = (MX_NETWORK_SERVER *) server_record->record_class_struct;
+
+	first_error = MX_SUCCESSFUL_RESULT;
+
+	/* Make sure that all of the network fields have network handles. */
+
+	for ( i = 0; i < num_transfers; i++ ) {
+		transfer = &transfer_array[i];
+		nf = transfer->nf;
+
+		if ( ( transfer->status_code != MXP_TRANSFER_PENDING )
+		  || ( nf->server_record != server_record ) )
+		{
+			continue;
+		}
+
+		mx_status = mx_network_field_is_connected( nf, &connected );
+
+		if ( ( mx_status.code == MXE_SUCCESS ) && ( connected == FALSE ) )
+		{
+			mx_status = mx_network_field_connect( nf );
+		}
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			transfer->status_code = mx_status.code;
+
+			if ( first_error.code == MXE_SUCCESS ) {
+				first_error = mx_status;
+			}
+		}
+	}
+
+	/* Servers that predate GET_ARRAYS and PUT_ARRAYS get one message
+	 * per field.
+	 */
+
+	if ( ( server->server_supports_batch_transfer == FALSE )
+	  || ( server->server_supports_network_handles == FALSE )
+	  || ( mx_server_supports_message_ids(server) == FALSE ) )
+	{
+		for ( i = 0; i < num_transfers; i++ ) {
+			transfer = &transfer_array[i];
+			nf = transfer->nf;
+
+			if ( ( transfer->status_code != MXP_TRANSFER_PENDING )
+			  || ( nf->server_record != server_record ) )
+			{
+				continue;
+			}
+
+			if ( send_message_type == MX_NETMSG_GET_ARRAYS ) {
+				mx_status = mx_get_array( nf,
+						transfer->datatype,
+						transfer->num_dimensions,
+						transfer->dimension,
+						transfer->value_ptr );
+			} else {
+				mx_status = mx_put_array( nf,
+						transfer->datatype,
+						transfer->num_dimensions,
+						transfer->dimension,
+						transfer->value_ptr );
+			}
+
+			transfer->status_code = mx_status.code;
+
+			if ( ( mx_status.code != MXE_SUCCESS )
+			  && ( first_error.code == MXE_SUCCESS ) )
+			{
+				first_error = mx_status;
+			}
+		}
+
+		return first_error;
+	}
+
+	mx_status = mx_network_reconnect_if_down( server_record );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		for ( i = 0; i < num_transfers; i++ ) {
+			transfer = &transfer_array[i];
+
+			if ( ( transfer->status_code == MXP_TRANSFER_PENDING )
+			  && ( transfer->nf->server_record == server_record ) )
+			{
+				transfer->status_code = mx_status.code;
+			}
+		}
+
+		return mx_status;
+	}
+
+	/*********** Construct the 'get arrays' or 'put arrays' message. *****/
+
+	aligned_buffer = server->message_buffer;
+
+	header_length = mx_remote_header_length(server);
+
+	offset = header_length + sizeof(uint32_t);
+
+	num_sent = 0;
+
+	for ( i = 0; i < num_transfers; i++ ) {
+		transfer = &transfer_array[i];
+		nf = transfer->nf;
+
+		if ( ( transfer->status_code != MXP_TRANSFER_PENDING )
+		  || ( nf->server_record != server_record ) )
+		{
+			continue;
+		}
+
+		/* Any transfers beyond the per-message limit are left
+		 * pending for the next message.
+		 */
+
+		if ( num_sent >= MXU_NETWORK_MAX_ARRAYS_ENTRIES )
+			break;
+
+		/* Leave each entry at least as much room for its value
+		 * as a message of its own would have.  ASCII values
+		 * cannot grow the buffer once they have been started.
+		 */
+
+		min_length = offset + MXP_ARRAYS_ENTRY_LENGTH
+				+ MXU_NETWORK_INITIAL_MESSAGE_BUFFER_LENGTH;
+
+		if ( aligned_buffer->buffer_length < min_length ) {
+			mx_status = mx_reallocate_network_buffer(
+						aligned_buffer, min_length );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				return mx_status;
+		}
+
+		entry_offset = offset;
+
+		offset += MXP_ARRAYS_ENTRY_LENGTH;
+
+		num_value_bytes = 0;
+
+		if ( send_message_type == MX_NETMSG_PUT_ARRAYS ) {
+			mx_status = mxp_network_setup_transfer_field( transfer,
+						&local_temp_record_field,
+						local_dimension_array,
+						data_element_size );
+
+			if ( mx_status.code == MXE_SUCCESS ) {
+				mx_status = mxp_network_encode_field_value(
+						server_record, nf->nfname,
+						&local_temp_record_field,
+						transfer->value_ptr,
+						aligned_buffer, offset,
+						&num_value_bytes );
+			}
+
+			if ( mx_status.code != MXE_SUCCESS ) {
+				transfer->status_code = mx_status.code;
+
+				if ( first_error.code == MXE_SUCCESS ) {
+					first_error = mx_status;
+				}
+
+				offset = entry_offset;
+				continue;
+			}
+		}
+
+		padded_length = mxp_arrays_padded_length( num_value_bytes );
+
+		if ( aligned_buffer->buffer_length < offset + padded_length ) {
+			mx_status = mx_reallocate_network_buffer(
+				aligned_buffer, offset + padded_length );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				return mx_status;
+		}
+
+		memset( aligned_buffer->u.char_buffer + offset + num_value_bytes,
+			0, padded_length - num_value_bytes );
+
+		entry = (uint32_t *) ( aligned_buffer->u.char_buffer
+						+ entry_offset );
+
+		entry[0] = mx_htonl( nf->record_handle );
+		entry[1] = mx_htonl( nf->field_handle );
+		entry[2] = mx_htonl( transfer->datatype );
+		entry[3] = mx_htonl( num_value_bytes );
+
+		offset += padded_length;
+
+		transfer->status_code = MXP_TRANSFER_SENT;
+
+		num_sent++;
+	}
+
+	if ( num_sent == 0 ) {
+		return first_error;
+	}
+
+	header = aligned_buffer->u.uint32_buffer;
+
+	message_length = (uint32_t) ( offset - header_length );
+
+	header[MX_NETWORK_MAGIC]          = mx_htonl( MX_NETWORK_MAGIC_VALUE );
+	header[MX_NETWORK_HEADER_LENGTH]  = mx_htonl( header_length );
+	header[MX_NETWORK_MESSAGE_LENGTH] = mx_htonl( message_length );
+	header[MX_NETWORK_MESSAGE_TYPE]   = mx_htonl( send_message_type );
+	header[MX_NETWORK_STATUS_CODE]    = mx_htonl( MXE_SUCCESS );
+	header[MX_NETWORK_DATA_TYPE]      = mx_htonl( 0 );
+
+	mx_network_update_message_id( &(server->last_rpc_message_id) );
+
+	header[MX_NETWORK_MESSAGE_ID] = mx_htonl( server->last_rpc_message_id );
+
+	header[ header_length / sizeof(uint32_t) ] = mx_htonl( num_sent );
+
+	server->last_data_type = 0;
+
+	mx_status = mx_network_send_message( server_record, aligned_buffer );
+
+	/************* Wait for the response. **************/
+
+	if ( mx_status.code == MXE_SUCCESS ) {
+		mx_status = mx_network_wait_for_message_id( server_record,
+						aligned_buffer,
+						server->last_rpc_message_id,
+						server->timeout );
+	}
+
+	header = aligned_buffer->u.uint32_buffer;
+
+	header_length        = mx_ntohl( header[ MX_NETWORK_HEADER_LENGTH ] );
+	message_length       = mx_ntohl( header[ MX_NETWORK_MESSAGE_LENGTH ] );
+	receive_message_type = mx_ntohl( header[ MX_NETWORK_MESSAGE_TYPE ] );
+	status_code          = mx_ntohl( header[ MX_NETWORK_STATUS_CODE ] );
+
+	message = aligned_buffer->u.char_buffer + header_length;
+
+	if ( mx_status.code == MXE_SUCCESS ) {
+	    if ( receive_message_type == MX_NETMSG_UNEXPECTED_ERROR ) {
+		if ( status_code == MXE_NOT_YET_IMPLEMENTED ) {
+			/* The server does not know about GET_ARRAYS or
+			 * PUT_ARRAYS, so we do not ask again.
+			 */
+
+			MX_DEBUG( 2,
+		("%s: batch transfers not implemented for MX server '%s'.",
+				fname, server_record->name ));
+
+			server->server_supports_batch_transfer = FALSE;
+
+			for ( i = 0; i < num_transfers; i++ ) {
+				if ( transfer_array[i].status_code
+						== MXP_TRANSFER_SENT )
+				{
+					transfer_array[i].status_code =
+						MXP_TRANSFER_PENDING;
+				}
+			}
+
+			mx_status = mxp_network_transfer_server_arrays(
+					server_record, send_message_type,
+					num_transfers, transfer_array );
+
+			if ( first_error.code == MXE_SUCCESS ) {
+				first_error = mx_status;
+			}
+
+			return first_error;
+		}
+
+		mx_status = mx_error( (long) status_code, fname,
+			"MX server '%s' rejected a %s message: %s",
+			server_record->name,
+			( send_message_type == MX_NETMSG_GET_ARRAYS )
+				? "GET_ARRAYS" : "PUT_ARRAYS",
+			message );
+
+	    } else if ( receive_message_type
+				!= mx_server_response(send_message_type) )
+	    {
+		mx_status = mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"Message type for response was not %#lx.  "
+		"Instead it was of type = %#lx",
+			(unsigned long) mx_server_response(send_message_type),
+			(unsigned long) receive_message_type );
+
+	    } else if ( ( message_length < sizeof(uint32_t) )
+		|| ( mx_ntohl( *((uint32_t *) message) ) != num_sent ) )
+	    {
+		mx_status = mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"The response from MX server '%s' did not contain "
+		"the %ld entries that were requested.",
+			server_record->name, num_sent );
+	    }
+	}
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		for ( i = 0; i < num_transfers; i++ ) {
+			if ( transfer_array[i].status_code
+						== MXP_TRANSFER_SENT )
+			{
+				transfer_array[i].status_code = mx_status.code;
+			}
+		}
+
+		return mx_status;
+	}
+
+	/************ Parse the entries that were returned. ***************/
+
+	offset = sizeof(uint32_t);
+
+	for ( i = 0; i < num_transfers; i++ ) {
+		transfer = &transfer_array[i];
+		nf = transfer->nf;
+
+		if ( transfer->status_code != MXP_TRANSFER_SENT ) {
+			continue;
+		}
+
+		if ( (offset + MXP_ARRAYS_ENTRY_LENGTH) > message_length ) {
+			mx_status = mx_error( MXE_NETWORK_IO_ERROR, fname,
+			"The response from MX server '%s' for field '%s' "
+			"was truncated.", server_record->name, nf->nfname );
+		} else {
+			entry = (uint32_t *) ( message + offset );
+
+			status_code  = mx_ntohl( entry[0] );
+			value_length = mx_ntohl( entry[2] );
+
+			value = message + offset + MXP_ARRAYS_ENTRY_LENGTH;
+
+			offset += MXP_ARRAYS_ENTRY_LENGTH
+				+ mxp_arrays_padded_length( value_length );
+
+			if ( offset > message_length ) {
+				mx_status = mx_error( MXE_NETWORK_IO_ERROR,
+				fname, "The value returned by MX server '%s' "
+				"for field '%s' extends past the end of "
+				"the message.", server_record->name,
+					nf->nfname );
+			} else
+			if ( status_code != MXE_SUCCESS ) {
+				if ( status_code == MXE_BAD_HANDLE ) {
+					nf->record_handle = MX_ILLEGAL_HANDLE;
+					nf->field_handle = MX_ILLEGAL_HANDLE;
+				}
+
+				if ( send_message_type == MX_NETMSG_GET_ARRAYS )
+				{
+					mx_status =
+					    mx_get_array_ascii_error_message(
+						status_code,
+						server_record->name,
+						nf->nfname, value );
+				} else {
+					mx_status =
+					    mx_put_array_ascii_error_message(
+						status_code,
+						server_record->name,
+						nf->nfname, value );
+				}
+			} else
+			if ( send_message_type == MX_NETMSG_GET_ARRAYS ) {
+				mx_status = mxp_network_setup_transfer_field(
+						transfer,
+						&local_temp_record_field,
+						local_dimension_array,
+						data_element_size );
+
+				if ( mx_status.code == MXE_SUCCESS ) {
+					mx_status =
+					    mxp_network_decode_field_value(
+						server_record, nf->nfname,
+						&local_temp_record_field,
+						transfer->value_ptr,
+						value, value_length );
+				}
+			} else {
+				mx_status = MX_SUCCESSFUL_RESULT;
+			}
+		}
+
+		transfer->status_code = mx_status.code;
+
+		if ( ( mx_status.code != MXE_SUCCESS )
+		  && ( first_error.code == MXE_SUCCESS ) )
+		{
+			first_error = mx_status;
+		}
+	}
+
+	return first_error;
+}
+
+/*----*/
+
+static mx_status_type
+mxp_network_transfer_arrays( uint32_t send_message_type,
+				long num_transfers,
+				MX_NETWORK_FIELD_TRANSFER *transfer_array,
+				const char *calling_fname )
+{
+	static const char fname[] = "mxp_network_transfer_arrays()";
+
+	MX_RECORD *server_record;
+	long i;
+	mx_status_type mx_status, first_error;
+
+	if ( ( transfer_array == (MX_NETWORK_FIELD_TRANSFER *) NULL )
+	  && ( num_transfers > 0 ) )
+	{
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_NETWORK_FIELD_TRANSFER array passed to %s was NULL.",
+			calling_fname );
+	}
+
+	for ( i = 0; i < num_transfers; i++ ) {
+		if ( transfer_array[i].nf == (MX_NETWORK_FIELD *) NULL ) {
+			return mx_error( MXE_NULL_ARGUMENT, fname,
+			"The MX_NETWORK_FIELD pointer for transfer %ld "
+			"passed to %s was NULL.", i, calling_fname );
+		}
+
+		transfer_array[i].status_code = MXP_TRANSFER_PENDING;
+	}
+
+	first_error = MX_SUCCESSFUL_RESULT;
+
+	/* Each pass through this loop handles the transfers for one
+	 * MX server, up to MXU_NETWORK_MAX_ARRAYS_ENTRIES at a time.
+	 */
+
+	for ( i = 0; i < num_transfers; i++ ) {
+		if ( transfer_array[i].status_code != MXP_TRANSFER_PENDING ) {
+			continue;
+		}
+
+		server_record = transfer_array[i].nf->server_record;
+
+		mx_status = mxp_network_transfer_server_arrays( server_record,
+						send_message_type,
+						num_transfers - i,
+						&transfer_array[i] );
+
+		if ( ( mx_status.code != MXE_SUCCESS )
+		  && ( first_error.code == MXE_SUCCESS ) )
+		{
+			first_error = mx_status;
+		}
+	}
+
+	return first_error;
+}
+
+/*----*/
+
+MX_EXPORT mx_status_type
+mx_get_arrays( long num_transfers, MX_NETWORK_FIELD_TRANSFER *transfer_array )
+{
+	static const char fname[] = "mx_get_arrays()";
+
+	mx_status_type mx_status;
+
+	mx_status = mxp_network_transfer_arrays( MX_NETMSG_GET_ARRAYS,
+					num_transfers, transfer_array, fname );
+
+	return mx_status;
+}
+
+/*----*/
+
+MX_EXPORT mx_status_type
+mx_put_arrays( long num_transfers, MX_NETWORK_FIELD_TRANSFER *transfer_array )
+{
+	static const char fname[] = "mx_put_arrays()";
+
+	mx_status_type mx_status;
+
+	mx_status = mxp_network_transfer_arrays( MX_NETMSG_PUT_ARRAYS,
+					num_transfers, transfer_array, fname );
+
+	return mx_status;
+}
+
+/* ====================================================================== */
+
+/* mxp_network_complete_request() records the final status of an
+ * asynchronous request, removes it from the server's list of pending
+ * requests and then invokes its completion function.  Requests that
+ * were freed by the caller before they completed are freed here.
+ */
+
+static void
+mxp_network_complete_request( MX_NETWORK_REQUEST *request,
+				mx_status_type status )
+{
+	MX_NETWORK_SERVER *server;
+	MX_NETWORK_REQUEST **link;
+
+	server = (MX_NETWORK_SERVER *)
+			request->server_record->record_class_struct;
+
+	for ( link = &(server->pending_request_list); *link != NULL;
+					link = &((*link)->next_request) )
+	{
+		if ( *link == request ) {
+			*link = request->next_request;
+			break;
+		}
+	}
+
+	request->next_request = NULL;
+
+	if ( request->abandoned ) {
+		mx_free( request );
+		return;
+	}
+
+	request->status = status;
+	request->complete = TRUE;
+
+	if ( request->completion_function != NULL ) {
+		(request->completion_function)( request,
+					request->completion_args );
+	}
+}
+
+/*----*/
+
+/* mxp_network_finish_request() parses the server's response to an
+ * asynchronous request, which is in the message buffer passed.
+ */
+
+static void
+mxp_network_finish_request( MX_NETWORK_REQUEST *request,
+				MX_NETWORK_MESSAGE_BUFFER *buffer )
+{
+	static const char fname[] = "mxp_network_finish_request()";
+
+	MX_NETWORK_FIELD *nf;
+	uint32_t *header;
+	char *message;
+	uint32_t header_length, message_length;
+	uint32_t receive_message_type, status_code;
+	mx_status_type mx_status;
+
+	nf = request->nf;
+
+	if ( request->abandoned ) {
+		mxp_network_complete_request( request, MX_SUCCESSFUL_RESULT );
+		return;
+	}
+
+	header = buffer->u.uint32_buffer;
+
+	header_length        = mx_ntohl( header[ MX_NETWORK_HEADER_LENGTH ] );
+	message_length       = mx_ntohl( header[ MX_NETWORK_MESSAGE_LENGTH ] );
+	receive_message_type = mx_ntohl( header[ MX_NETWORK_MESSAGE_TYPE ] );
+	status_code          = mx_ntohl( header[ MX_NETWORK_STATUS_CODE ] );
+
+	message = buffer->u.char_buffer + header_length;
+
+	if ( ( receive_message_type != MX_NETMSG_UNEXPECTED_ERROR )
+	  && ( receive_message_type
+			!= mx_server_response(request->message_type) ) )
+	{
+		mx_status = mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"Message type for response was not %#lx.  "
+		"Instead it was of type = %#lx",
+		    (unsigned long) mx_server_response(request->message_type),
+		    (unsigned long) receive_message_type );
+
+	} else if ( status_code != MXE_SUCCESS ) {
+		if ( status_code == MXE_BAD_HANDLE ) {
+			nf->record_handle = MX_ILLEGAL_HANDLE;
+			nf->field_handle = MX_ILLEGAL_HANDLE;
+		}
+
+		if ( request->message_type == MX_NETMSG_GET_ARRAY_BY_HANDLE ) {
+			mx_status = mx_get_array_ascii_error_message(
+					status_code,
+					request->server_record->name,
+					nf->nfname, message );
+		} else {
+			mx_status = mx_put_array_ascii_error_message(
+					status_code,
+					request->server_record->name,
+					nf->nfname, message );
+		}
+
+	} else if ( request->message_type == MX_NETMSG_GET_ARRAY_BY_HANDLE ) {
+		mx_status = mxp_network_decode_field_value(
+					request->server_record, nf->nfname,
+					&(request->local_field),
+					request->value_ptr,
+					message, message_length );
+	} else {
+		mx_status = MX_SUCCESSFUL_RESULT;
+	}
+
+	mxp_network_complete_request( request, mx_status );
+}
+
+/*----*/
+
+/* mxp_network_dispatch_response() is called by
+ * mx_network_wait_for_message_id() for each message that is not the
+ * one it is waiting for.  If the message is the response to a pending
+ * asynchronous request, the request is completed.
+ */
+
+static mx_bool_type
+mxp_network_dispatch_response( MX_NETWORK_SERVER *server,
+				MX_NETWORK_MESSAGE_BUFFER *buffer,
+				uint32_t received_message_id )
+{
+	MX_NETWORK_REQUEST *request;
+
+	for ( request = server->pending_request_list; request != NULL;
+					request = request->next_request )
+	{
+		if ( request->message_id == received_message_id ) {
+			mxp_network_finish_request( request, buffer );
+
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+/*----*/
+
+/* If the connection to the server is lost, none of the pending requests
+ * will ever get a response.
+ */
+
+static void
+mxp_network_fail_pending_requests( MX_NETWORK_SERVER *server,
+					mx_status_type status )
+{
+	while ( server->pending_request_list != NULL ) {
+		mxp_network_complete_request( server->pending_request_list,
+						status );
+	}
+}
+
+/*----*/
+
+static mx_status_type
+mxp_network_send_request( uint32_t message_type,
+			MX_NETWORK_FIELD *nf,
+			long datatype,
+			long num_dimensions,
+			long *dimension,
+			void *value_ptr,
+			MX_NETWORK_REQUEST_FUNCTION *completion_function,
+			void *completion_args,
+			MX_NETWORK_REQUEST **request_ptr,
+			const char *calling_fname )
+{
+	static const char fname[] = "mxp_network_send_request()";
+
+	MX_NETWORK_REQUEST *request;
+	MX_NETWORK_SERVER *server;
+	MX_NETWORK_MESSAGE_BUFFER *aligned_buffer;
+	uint32_t *header, *uint32_message;
+	uint32_t header_length;
+	size_t num_value_bytes;
+	long i;
+	mx_bool_type connected;
+	mx_status_type mx_status;
+
+	if ( nf == (MX_NETWORK_FIELD *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_NETWORK_FIELD pointer passed to %s was NULL.",
+			calling_fname );
+	}
+	if ( request_ptr == (MX_NETWORK_REQUEST **) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_NETWORK_REQUEST pointer passed to %s was NULL.",
+			calling_fname );
+	}
+	if ( (num_dimensions < 0)
+	  || (num_dimensions > MXU_FIELD_MAX_DIMENSIONS) )
+	{
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"The number of dimensions (%ld) passed to %s is outside "
+		"the allowed range of 0 to %d.", num_dimensions,
+			calling_fname, MXU_FIELD_MAX_DIMENSIONS );
+	}
+	if ( (dimension == NULL) && (num_dimensions > 0) ) {
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+"dimension array pointer is NULL, but num_dimensions (%ld) is greater than 0",
+			num_dimensions );
+	}
+
+	*request_ptr = NULL;
+
+	mx_status = mx_network_field_is_connected( nf, &connected );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	if ( connected == FALSE ) {
+		mx_status = mx_network_field_connect( nf );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
+	request = (MX_NETWORK_REQUEST *) calloc( 1, sizeof(MX_NETWORK_REQUEST) );
+
+	if ( request == (MX_NETWORK_REQUEST *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate an MX_NETWORK_REQUEST "
+		"for '%s:%s'.", nf->server_record->name, nf->nfname );
+	}
+
+	request->server_record = nf->server_record;
+	request->nf = nf;
+	request->message_type = message_type;
+	request->datatype = datatype;
+	request->num_dimensions = num_dimensions;
+	request->value_ptr = value_ptr;
+	request->completion_function = completion_function;
+	request->completion_args = completion_args;
+
+	for ( i = 0; i < num_dimensions; i++ ) {
+		request->dimension[i] = dimension[i];
+	}
+
+	/* Setting the first element of data_element_size to be zero causes
+	 * mx_initialize_temp_record_field() to use a default data element
+	 * size array.
+	 */
+
+	request->data_element_size[0] = 0L;
+
+	mx_status = mx_initialize_temp_record_field( &(request->local_field),
+			datatype, num_dimensions, request->dimension,
+			request->data_element_size, value_ptr );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mx_free( request );
+		return mx_status;
+	}
+
+	server = (MX_NETWORK_SERVER *) nf->server_record->record_class_struct;
+
+	/* Responses can only be matched to requests by message ID,
+	 * so old servers get an ordinary synchronous request.
+	 */
+
+	if ( ( server->server_supports_network_handles == FALSE )
+	  || ( mx_server_supports_message_ids(server) == FALSE ) )
+	{
+		if ( message_type == MX_NETMSG_GET_ARRAY_BY_HANDLE ) {
+			mx_status = mx_get_array( nf, datatype,
+					num_dimensions, dimension, value_ptr );
+		} else {
+			mx_status = mx_put_array( nf, datatype,
+					num_dimensions, dimension, value_ptr );
+		}
+
+		*request_ptr = request;
+
+		mxp_network_complete_request( request, mx_status );
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	mx_status = mx_network_reconnect_if_down( nf->server_record );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mx_free( request );
+		return mx_status;
+	}
+
+	/*********** Send the request. *************/
+
+	aligned_buffer = server->message_buffer;
+
+	header_length = mx_remote_header_length(server);
+
+	num_value_bytes = 0;
+
+	if ( message_type == MX_NETMSG_PUT_ARRAY_BY_HANDLE ) {
+		mx_status = mxp_network_encode_field_value( nf->server_record,
+					nf->nfname, &(request->local_field),
+					value_ptr, aligned_buffer,
+					header_length + 2 * sizeof(uint32_t),
+					&num_value_bytes );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			mx_free( request );
+			return mx_status;
+		}
+	}
+
+	header = aligned_buffer->u.uint32_buffer;
+
+	uint32_message = header + (header_length / sizeof(uint32_t));
+
+	header[MX_NETWORK_MAGIC]          = mx_htonl( MX_NETWORK_MAGIC_VALUE );
+	header[MX_NETWORK_HEADER_LENGTH]  = mx_htonl( header_length );
+	header[MX_NETWORK_MESSAGE_LENGTH] =
+		mx_htonl( 2 * sizeof(uint32_t) + num_value_bytes );
+	header[MX_NETWORK_MESSAGE_TYPE]   = mx_htonl( message_type );
+	header[MX_NETWORK_STATUS_CODE]    = mx_htonl( MXE_SUCCESS );
+	header[MX_NETWORK_DATA_TYPE]      = mx_htonl( datatype );
+
+	mx_network_update_message_id( &(server->last_rpc_message_id) );
+
+	request->message_id = server->last_rpc_message_id;
+
+	header[MX_NETWORK_MESSAGE_ID] = mx_htonl( request->message_id );
+
+	uint32_message[0] = mx_htonl( nf->record_handle );
+	uint32_message[1] = mx_htonl( nf->field_handle );
+
+	server->last_data_type = datatype;
+
+	mx_status = mx_network_send_message( nf->server_record,
+						aligned_buffer );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mx_free( request );
+		return mx_status;
+	}
+
+	request->next_request = server->pending_request_list;
+
+	server->pending_request_list = request;
+
+	*request_ptr = request;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*----*/
+
+MX_EXPORT mx_status_type
+mx_get_array_async( MX_NETWORK_FIELD *nf,
+		long datatype,
+		long num_dimensions,
+		long *dimension,
+		void *value_ptr,
+		MX_NETWORK_REQUEST_FUNCTION *completion_function,
+		void *completion_args,
+		MX_NETWORK_REQUEST **request )
+{
+	static const char fname[] = "mx_get_array_async()";
+
+	mx_status_type mx_status;
+
+	mx_status = mxp_network_send_request( MX_NETMSG_GET_ARRAY_BY_HANDLE,
+					nf, datatype, num_dimensions,
+					dimension, value_ptr,
+					completion_function, completion_args,
+					request, fname );
+
+	return mx_status;
+}
+
+/*----*/
+
+MX_EXPORT mx_status_type
+mx_put_array_async( MX_NETWORK_FIELD *nf,
+		long datatype,
+		long num_dimensions,
+		long *dimension,
+		void *value_ptr,
+		MX_NETWORK_REQUEST_FUNCTION *completion_function,
+		void *completion_args,
+		MX_NETWORK_REQUEST **request )
+{
+	static const char fname[] = "mx_put_array_async()";
+
+	mx_status_type mx_status;
+
+	mx_status = mxp_network_send_request( MX_NETMSG_PUT_ARRAY_BY_HANDLE,
+					nf, datatype, num_dimensions,
+					dimension, value_ptr,
+					completion_function, completion_args,
+					request, fname );
+
+	return mx_status;
+}
+
+/*----*/
+
+MX_EXPORT mx_status_type
+mx_network_request_wait( MX_NETWORK_REQUEST *request )
+{
+	static const char fname[] = "mx_network_request_wait()";
+
+	MX_NETWORK_SERVER *server;
+	mx_status_type mx_status;
+
+	if ( request == (MX_NETWORK_REQUEST *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_NETWORK_REQUEST pointer passed was NULL." );
+	}
+
+	server = (MX_NETWORK_SERVER *)
+			request->server_record->record_class_struct;
+
+	/* Responses to other requests that arrive while we are waiting
+	 * are dispatched by mx_network_wait_for_message_id().
+	 */
+
+	if ( request->complete == FALSE ) {
+		mx_status = mx_network_wait_for_message_id(
+					request->server_record,
+					server->message_buffer,
+					request->message_id,
+					server->timeout );
+
+		if ( request->complete == FALSE ) {
+			if ( mx_status.code == MXE_SUCCESS ) {
+				mxp_network_finish_request( request,
+						server->message_buffer );
+			} else {
+				mxp_network_complete_request( request,
+								mx_status );
+			}
+		}
+	}
+
+	return request->status;
+}
+
+/*----*/
+
+MX_EXPORT mx_status_type
+mx_network_request_wait_all( long num_requests,
+			MX_NETWORK_REQUEST **request_array )
+{
+	static const char fname[] = "mx_network_request_wait_all()";
+
+	long i;
+	mx_status_type mx_status, first_error;
+
+	if ( ( request_array == (MX_NETWORK_REQUEST **) NULL )
+	  && ( num_requests > 0 ) )
+	{
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_NETWORK_REQUEST array pointer passed was NULL." );
+	}
+
+	first_error = MX_SUCCESSFUL_RESULT;
+
+	for ( i = 0; i < num_requests; i++ ) {
+		if ( request_array[i] == (MX_NETWORK_REQUEST *) NULL ) {
+			continue;
+		}
+
+		mx_status = mx_network_request_wait( request_array[i] );
+
+		if ( ( mx_status.code != MXE_SUCCESS )
+		  && ( first_error.code == MXE_SUCCESS ) )
+		{
+			first_error = mx_status;
+		}
+	}
+
+	return first_error;
+}
+
+/*----*/
+
+MX_EXPORT void
+mx_network_request_free( MX_NETWORK_REQUEST *request )
+{
+	if ( request == (MX_NETWORK_REQUEST *) NULL )
+		return;
+
+	/* A request that is still pending stays in the list of pending
+	 * requests, so that its response can be recognized and discarded.
+	 */
+
+	if ( request->complete == FALSE ) {
+		request->abandoned = TRUE;
+		request->completion_function = NULL;
+		return;
+	}
+
+	mx_free( request );
+}
+
+/* ====================================================================== */
+
 MX_EXPORT mx_status_type
 mx_network_field_connect( MX_NETWORK_FIELD *nf )
 {
@@ -76,6 +76,14 @@ typedef struct mx_network_message_buffer {
 	} u;
 	size_t buffer_length;
 	unsigned long data_format;
+
+	/* If bulk_data_ptr is not NULL, then the body of a bulk data
+	 * response is received directly into it rather than into the
+	 * message buffer.
+	 */
+
+	void *bulk_data_ptr;
+	size_t bulk_data_length;
 } MX_NETWORK_MESSAGE_BUFFER;
 
 /*
@@ -109,6 +117,8 @@ typedef struct {
 
 	mx_bool_type server_supports_network_handles;
 	mx_bool_type network_handles_are_valid;
+	mx_bool_type server_supports_bulk_transfer;
+	mx_bool_type server_supports_batch_transfer;
 	mx_bool_type use_64bit_network_longs;
 
 	unsigned long connection_status;
@@ -124,6 +134,8 @@ typedef struct {
 	struct mx_network_field_type **network_field_array;
 
 	MX_LIST *callback_list;
+
+	struct mx_network_request_type *pending_request_list;
 } MX_NETWORK_SERVER;
 
 typedef struct mx_network_field_type MX_NETWORK_FIELD;
@@ -277,6 +289,36 @@ typedef struct {
 #define MX_NETMSG_GET_ARRAY_BY_HANDLE	0x1003
 #define MX_NETMSG_PUT_ARRAY_BY_HANDLE	0x1004
 
+/* The response to GET_BULK_BY_HANDLE is the raw contents of a 1-dimensional
+ * byte array, regardless of the data format used by the connection.
+ */
+
+#define MX_NETMSG_GET_BULK_BY_HANDLE	0x1005
+
+/* GET_ARRAYS and PUT_ARRAYS read or write several record fields by handle
+ * in a single message.  All of the integers below are 32-bit values
+ * in network byte order.  The request body is the number of entries
+ * followed by one entry per field:
+ *
+ *    record handle, field handle, datatype, value length, value
+ *
+ * The response body is the number of entries followed by:
+ *
+ *    status code, datatype, value length, 0, value
+ *
+ * If the status code is not MXE_SUCCESS, the value is the text of the
+ * error message.  GET_ARRAYS requests have a value length of 0.  Each
+ * value is padded with zeros to a multiple of 8 bytes.
+ *
+ * Servers reject messages with more than MXU_NETWORK_MAX_ARRAYS_ENTRIES
+ * entries, so clients split larger batches into several messages.
+ */
+
+#define MXU_NETWORK_MAX_ARRAYS_ENTRIES	4096
+
+#define MX_NETMSG_GET_ARRAYS		0x1006
+#define MX_NETMSG_PUT_ARRAYS		0x1007
+
 #define MX_NETMSG_GET_NETWORK_HANDLE	0x2001
 #define MX_NETMSG_GET_FIELD_TYPE	0x2005
 
@@ -455,6 +497,117 @@ MX_API mx_status_type mx_put_array( MX_NETWORK_FIELD *nf,
 				long *dimension,
 				void *value );
 
+/* mx_get_bulk_array() reads a 1-dimensional byte array directly into
+ * the caller's buffer.  If the server does not support bulk transfers,
+ * it falls back to mx_get_array().
+ */
+
+MX_API mx_status_type mx_get_bulk_array( MX_NETWORK_FIELD *nf,
+				void *buffer,
+				size_t max_bytes,
+				size_t *bytes_received );
+
+/*---*/
+
+/* mx_get_arrays() and mx_put_arrays() transfer all of the fields in
+ * the array in one message exchange per MX server, or more than one if
+ * there are more than MXU_NETWORK_MAX_ARRAYS_ENTRIES fields for that
+ * server.  The status of each individual transfer is left in its
+ * status_code member, and the first error seen is returned.  Servers
+ * that do not support GET_ARRAYS and PUT_ARRAYS are sent one GET_ARRAY
+ * or PUT_ARRAY message per field.
+ */
+
+typedef struct {
+	MX_NETWORK_FIELD *nf;
+	long datatype;
+	long num_dimensions;
+	long *dimension;
+	void *value_ptr;
+	long status_code;
+} MX_NETWORK_FIELD_TRANSFER;
+
+MX_API mx_status_type mx_get_arrays( long num_transfers,
+				MX_NETWORK_FIELD_TRANSFER *transfer_array );
+
+MX_API mx_status_type mx_put_arrays( long num_transfers,
+				MX_NETWORK_FIELD_TRANSFER *transfer_array );
+
+/*---*/
+
+/* mx_get_array_async() and mx_put_array_async() send a request to
+ * the server and return at once with an MX_NETWORK_REQUEST that stands
+ * for the response.  Any number of requests may be in flight at once.
+ * Responses are matched to their requests by message ID whenever the
+ * client reads messages from the server, whether that happens in
+ * mx_network_request_wait(), in mx_network_wait_for_messages() or in
+ * an ordinary synchronous call.  When the response arrives, the value
+ * of a 'get' is stored at value_ptr, 'complete' is set to TRUE and the
+ * completion function, if any, is invoked.  The value for a 'put' is
+ * copied when the request is sent.
+ *
+ * Requests are freed with mx_network_request_free(), but not from
+ * inside their own completion function.  Freeing a request that has
+ * not yet completed causes its response to be discarded.
+ */
+
+typedef struct mx_network_request_type MX_NETWORK_REQUEST;
+
+typedef void (MX_NETWORK_REQUEST_FUNCTION)( MX_NETWORK_REQUEST *request,
+						void *completion_args );
+
+struct mx_network_request_type {
+	MX_RECORD *server_record;
+	MX_NETWORK_FIELD *nf;
+	uint32_t message_type;
+	uint32_t message_id;
+
+	long datatype;
+	long num_dimensions;
+	long dimension[MXU_FIELD_MAX_DIMENSIONS];
+	size_t data_element_size[MXU_FIELD_MAX_DIMENSIONS];
+	void *value_ptr;
+	MX_RECORD_FIELD local_field;
+
+	MX_NETWORK_REQUEST_FUNCTION *completion_function;
+	void *completion_args;
+
+	mx_bool_type complete;
+	mx_bool_type abandoned;
+	mx_status_type status;
+
+	struct mx_network_request_type *next_request;
+};
+
+MX_API mx_status_type mx_get_array_async( MX_NETWORK_FIELD *nf,
+				long datatype,
+				long num_dimensions,
+				long *dimension,
+				void *value_ptr,
+				MX_NETWORK_REQUEST_FUNCTION *completion_function,
+				void *completion_args,
+				MX_NETWORK_REQUEST **request );
+
+MX_API mx_status_type mx_put_array_async( MX_NETWORK_FIELD *nf,
+				long datatype,
+				long num_dimensions,
+				long *dimension,
+				void *value_ptr,
+				MX_NETWORK_REQUEST_FUNCTION *completion_function,
+				void *completion_args,
+				MX_NETWORK_REQUEST **request );
+
+MX_API mx_status_type mx_network_request_wait( MX_NETWORK_REQUEST *request );
+
+/* mx_network_request_wait_all() waits for every request in the array
+ * and returns the first error seen.
+ */
+
+MX_API mx_status_type mx_network_request_wait_all( long num_requests,
+					MX_NETWORK_REQUEST **request_array );
+
+MX_API void mx_network_request_free( MX_NETWORK_REQUEST *request );
+
 /*---*/
 
 #define mx_get_by_name( s, r, t, v ) \
@@ -30,6 +30,10 @@
 #include <stdlib.h>
 #include <errno.h>
 
+#if HAVE_READV_WRITEV
+#include <sys/uio.h>
+#endif
+
 #include "mx_util.h"
 #include "mx_record.h"
 #include "mx_stdint.h"
@@ -42,6 +46,158 @@
 #include "mx_hrt_debug.h"
 #endif
 
+/* mxp_network_socket_check_error() decides what to do after a failed
+ * send() or recv().  If the operation should be retried, *retry is set
+ * to TRUE.  Otherwise, the returned status describes the error.
+ */
+
+static mx_status_type
+mxp_network_socket_check_error( MX_SOCKET *mx_socket,
+				mx_bool_type no_timeout,
+				MX_CLOCK_TICK timeout_time,
+				double timeout,
+				mx_bool_type *retry,
+				const char *calling_fname )
+{
+	MX_CLOCK_TICK current_time;
+	int saved_errno, comparison;
+
+	*retry = FALSE;
+
+	saved_errno = mx_socket_get_last_error();
+
+	switch( saved_errno ) {
+	case ECONNRESET:
+	case ECONNABORTED:
+		return mx_error( (MXE_NETWORK_CONNECTION_LOST | MXE_QUIET),
+			calling_fname,
+			"Connection lost.  Errno = %d, error text = '%s'",
+			saved_errno, mx_socket_strerror(saved_errno) );
+		break;
+	case EAGAIN:
+
+#if ( EAGAIN != EWOULDBLOCK )
+	case EWOULDBLOCK:
+#endif
+		if ( no_timeout ) {
+			*retry = TRUE;
+
+			return MX_SUCCESSFUL_RESULT;
+		}
+
+		current_time = mx_current_clock_tick();
+
+		comparison = mx_compare_clock_ticks( current_time,
+							timeout_time );
+
+		if ( comparison < 0 ) {
+			*retry = TRUE;
+
+			return MX_SUCCESSFUL_RESULT;
+		}
+
+		return mx_error( (MXE_TIMED_OUT | MXE_QUIET), calling_fname,
+			"Timed out after waiting %g seconds for "
+			"MX network socket %d.",
+			timeout, (int) mx_socket->socket_fd );
+		break;
+	default:
+		return mx_error( (MXE_NETWORK_IO_ERROR | MXE_QUIET),
+			calling_fname,
+			"Error communicating with remote host.  "
+			"Errno = %d, error text = '%s'",
+			saved_errno, mx_socket_strerror(saved_errno) );
+		break;
+	}
+
+	MXW_NOT_REACHED( return MX_SUCCESSFUL_RESULT; )
+}
+
+/*---*/
+
+static mx_status_type
+mxp_network_socket_receive_bytes( MX_SOCKET *mx_socket,
+				char *ptr,
+				uint32_t bytes_left,
+				mx_bool_type no_timeout,
+				MX_CLOCK_TICK timeout_time,
+				double timeout,
+				const char *calling_fname )
+{
+	int bytes_received;
+	mx_bool_type retry;
+	mx_status_type mx_status;
+
+	while( bytes_left > 0 ) {
+
+		bytes_received = recv(mx_socket->socket_fd, ptr, bytes_left, 0);
+
+		switch( bytes_received ) {
+		case 0:
+			return mx_error(
+				(MXE_NETWORK_IO_ERROR | MXE_QUIET),
+				calling_fname,
+				"Network connection closed unexpectedly." );
+			break;
+		case MX_SOCKET_ERROR:
+			mx_status = mxp_network_socket_check_error( mx_socket,
+					no_timeout, timeout_time, timeout,
+					&retry, calling_fname );
+
+			if ( retry == FALSE )
+				return mx_status;
+			break;
+		default:
+			bytes_left -= bytes_received;
+			ptr += bytes_received;
+			break;
+		}
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*---*/
+
+#if ( HAVE_READV_WRITEV == 0 )
+
+static mx_status_type
+mxp_network_socket_send_bytes( MX_SOCKET *mx_socket,
+				char *ptr,
+				size_t bytes_left,
+				mx_bool_type no_timeout,
+				MX_CLOCK_TICK timeout_time,
+				double timeout,
+				const char *calling_fname )
+{
+	int bytes_sent;
+	mx_bool_type retry;
+	mx_status_type mx_status;
+
+	while( bytes_left > 0 ) {
+
+		bytes_sent = send( mx_socket->socket_fd, ptr, bytes_left, 0 );
+
+		if ( bytes_sent == MX_SOCKET_ERROR ) {
+			mx_status = mxp_network_socket_check_error( mx_socket,
+					no_timeout, timeout_time, timeout,
+					&retry, calling_fname );
+
+			if ( retry == FALSE )
+				return mx_status;
+		} else {
+			bytes_left -= bytes_sent;
+			ptr += bytes_sent;
+		}
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+#endif
+
+/*---*/
+
 MX_EXPORT mx_status_type
 mx_network_socket_receive_message( MX_SOCKET *mx_socket,
 				double timeout,
@@ -57,6 +213,8 @@ mx_network_socket_receive_message( MX_SOCKET *mx_socket,
 	int bytes_received, initial_recv_length;
 	uint32_t bytes_left;
 	uint32_t magic_value, header_length, message_length, total_length;
+	uint32_t message_type, status_code;
+	char *bulk_ptr;
 	mx_status_type mx_status;
 
 #if MX_NET_SOCKET_DEBUG_TOTAL_PERFORMANCE
@@ -70,6 +228,8 @@ mx_network_socket_receive_message( MX_SOCKET *mx_socket,
 
 	MX_DEBUG( 2,("%s invoked.", fname));
 
+	bulk_ptr = NULL;
+
 	if ( mx_socket == (MX_SOCKET *) NULL ) {
 		return mx_error( MXE_NETWORK_IO_ERROR, fname,
 		"The MX_SOCKET pointer passed was NULL." );
@@ -108,6 +268,8 @@ mx_network_socket_receive_message( MX_SOCKET *mx_socket,
 
 	if ( timeout < 0.0 ) {
 		no_timeout = TRUE;
+
+		timeout_time = mx_current_clock_tick();
 	} else {
 		no_timeout = FALSE;
 
@@ -242,135 +404,102 @@ mx_network_socket_receive_message( MX_SOCKET *mx_socket,
 			(unsigned long) magic_value );
 	}
 
-	/* If the message is too long to fit into the current buffer,
-	 * increase the size of the buffer.
+	/* A header shorter than the three longs we have already read
+	 * cannot be valid.
 	 */
 
-	total_length = header_length + message_length;
-
-#if 0
-	MX_DEBUG(-2,("%s: #1 message_buffer = %p, header = %p, ptr = %p",
-		fname, message_buffer, header, ptr));
-#endif
-
-	if ( total_length > message_buffer->buffer_length ) {
-
-		mx_status = mx_reallocate_network_buffer( message_buffer,
-								total_length );
-
-		if ( mx_status.code != MXE_SUCCESS )
-			return mx_status;
-
-		/* Update some pointers. */
+	if ( header_length < initial_recv_length ) {
+		return mx_error( (MXE_NETWORK_IO_ERROR | MXE_QUIET), fname,
+			"Header length %lu in received message is shorter "
+			"than the minimum allowed length of %d.",
+			(unsigned long) header_length, initial_recv_length );
+	}
 
-		header = message_buffer->u.uint32_buffer;
+	total_length = header_length + message_length;
 
-		ptr = message_buffer->u.char_buffer;
+	if ( message_buffer->bulk_data_ptr == NULL ) {
 
-		ptr += initial_recv_length;
-	}
+		/* Receive the rest of the data. */
 
-#if 0
-	MX_DEBUG(-2,("%s: #2 message_buffer = %p, header = %p, ptr = %p",
-		fname, message_buffer, header, ptr));
-#endif
+		bytes_left = total_length - initial_recv_length;
+	} else {
+		/* The caller is expecting a bulk data response, so we
+		 * receive the rest of the header first.  If the header
+		 * says that this is a successful bulk data response that
+		 * fits into the caller's buffer, then the body of the
+		 * message is received directly into that buffer.
+		 */
 
-	/* Receive the rest of the data. */
+		if ( header_length > message_buffer->buffer_length ) {
 
-	bytes_left = total_length - initial_recv_length;
+			mx_status = mx_reallocate_network_buffer(
+						message_buffer, header_length );
 
-#if MX_NET_SOCKET_DEBUG_IO_PERFORMANCE
-	n = -1;
-#endif
-	while( bytes_left > 0 ) {
+			if ( mx_status.code != MXE_SUCCESS )
+				return mx_status;
 
-#if MX_NET_SOCKET_DEBUG_IO_PERFORMANCE
-		n++;
-		MX_HRT_START( io_measurement );
-#endif
-		bytes_received = recv(mx_socket->socket_fd, ptr, bytes_left, 0);
+			header = message_buffer->u.uint32_buffer;
+		}
 
-#if MX_NET_SOCKET_DEBUG_IO_PERFORMANCE
-		MX_HRT_END( io_measurement );
+		ptr = message_buffer->u.char_buffer + initial_recv_length;
 
-		MX_HRT_RESULTS( io_measurement, fname,
-	"Rest of measurement: bytes_left = %ld, bytes_received = %d, n = %ld",
-			(long) bytes_left, bytes_received, n );
-#endif
+		mx_status = mxp_network_socket_receive_bytes( mx_socket,
+				ptr, header_length - initial_recv_length,
+				no_timeout, timeout_time, timeout, fname );
 
-		switch( bytes_received ) {
-		case 0:
-			return mx_error(
-				(MXE_NETWORK_IO_ERROR | MXE_QUIET), fname,
-				"Network connection closed unexpectedly." );
-			break;
-		case MX_SOCKET_ERROR:
-			saved_errno = mx_socket_get_last_error();
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
 
-			switch( saved_errno ) {
-			case ECONNRESET:
-			case ECONNABORTED:
-				return mx_error(
-				(MXE_NETWORK_CONNECTION_LOST | MXE_QUIET),fname,
-				"Connection lost.  "
-				"Errno = %d, error text = '%s'",
-					saved_errno,
-					mx_socket_strerror(saved_errno) );
-				break;
-			case EAGAIN:
+		if ( header_length
+			>= ((MX_NETWORK_STATUS_CODE + 1) * sizeof(uint32_t)) )
+		{
+			message_type = mx_ntohl(header[MX_NETWORK_MESSAGE_TYPE]);
+			status_code  = mx_ntohl(header[MX_NETWORK_STATUS_CODE]);
+		} else {
+			message_type = 0;
+			status_code  = MXE_SUCCESS;
+		}
 
-#if ( EAGAIN != EWOULDBLOCK )
-			case EWOULDBLOCK:
-#endif
-				if ( no_timeout ) {
-					/* In this case, we are never
-					 * supposed to time out, so
-					 * go back to the top of the
-					 * while() loop and try again.
-					 */
+		if ( ( message_type ==
+			mx_server_response(MX_NETMSG_GET_BULK_BY_HANDLE) )
+		  && ( status_code == MXE_SUCCESS )
+		  && ( message_length <= message_buffer->bulk_data_length ) )
+		{
+			bulk_ptr = message_buffer->bulk_data_ptr;
+		}
 
-					continue;
-				}
+		bytes_left = message_length;
+	}
 
-				current_time = mx_current_clock_tick();
+	if ( bulk_ptr != NULL ) {
+		mx_status = mxp_network_socket_receive_bytes( mx_socket,
+				bulk_ptr, bytes_left,
+				no_timeout, timeout_time, timeout, fname );
+	} else {
+		/* If the message is too long to fit into the current
+		 * buffer, increase the size of the buffer.
+		 */
 
-				comparison = mx_compare_clock_ticks(
-					    	current_time, timeout_time );
+		if ( total_length > message_buffer->buffer_length ) {
 
-				if ( comparison < 0 ) {
+			mx_status = mx_reallocate_network_buffer(
+						message_buffer, total_length );
 
-					/* Have not timed out yet, so
-					 * go back to the top of the
-					 * while() loop and try again.
-					 */
+			if ( mx_status.code != MXE_SUCCESS )
+				return mx_status;
+		}
 
-					continue;
-				} else {
-					return mx_error(
-					(MXE_TIMED_OUT | MXE_QUIET), fname,
-					"Timed out after waiting %g seconds to "
-					"read from the MX network socket.",
-						timeout );
-				}
-				break;
-			default:
-				return mx_error(
-				(MXE_NETWORK_IO_ERROR | MXE_QUIET), fname,
-				"Error receiving message body from "
-				"remote host.  Errno = %d, error text = '%s'",
-					saved_errno,
-					mx_socket_strerror(saved_errno) );
+		ptr = message_buffer->u.char_buffer
+					+ (total_length - bytes_left);
 
-				break;
-			}
-			break;
-		default:
-			bytes_left -= bytes_received;
-			ptr += bytes_received;
-			break;
-		}
+		mx_status = mxp_network_socket_receive_bytes( mx_socket,
+				ptr, bytes_left,
+				no_timeout, timeout_time, timeout, fname );
 	}
 
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
 #if MX_NET_SOCKET_DEBUG_TOTAL_PERFORMANCE
 	MX_HRT_END( total_measurement );
 
@@ -596,6 +725,166 @@ mx_network_socket_send_message( MX_SOCKET *mx_socket,
 	return MX_SUCCESSFUL_RESULT;
 }
 
+/* mx_network_socket_send_bulk_message() sends the header in message_buffer
+ * followed by the raw bytes in bulk_data.  The bulk data is not copied
+ * into the message buffer, so large image frames can be sent directly
+ * from wherever the driver keeps them.  The message length in the header
+ * is set to bulk_data_length by this function.
+ */
+
+MX_EXPORT mx_status_type
+mx_network_socket_send_bulk_message( MX_SOCKET *mx_socket,
+				double timeout,
+				MX_NETWORK_MESSAGE_BUFFER *message_buffer,
+				void *bulk_data,
+				size_t bulk_data_length )
+{
+	static const char fname[] = "mx_network_socket_send_bulk_message()";
+
+	uint32_t *header;
+	uint32_t header_length;
+	mx_bool_type no_timeout;
+	MX_CLOCK_TICK timeout_interval, current_time, timeout_time;
+	mx_status_type mx_status;
+
+#if HAVE_READV_WRITEV
+	struct iovec iovec_array[2];
+	struct iovec *iov;
+	int iov_count;
+	ssize_t bytes_sent;
+	mx_bool_type retry;
+#endif
+
+#if MX_NET_SOCKET_DEBUG_TOTAL_PERFORMANCE
+	MX_HRT_TIMING total_measurement;
+#endif
+
+	if ( mx_socket == (MX_SOCKET *) NULL ) {
+		return mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"The MX_SOCKET pointer passed was NULL." );
+	}
+	if ( message_buffer == (MX_NETWORK_MESSAGE_BUFFER *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_NETWORK_MESSAGE_BUFFER pointer passed was NULL." );
+	}
+	if ( (bulk_data == NULL) && (bulk_data_length > 0) ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The bulk_data pointer passed was NULL." );
+	}
+	if ( bulk_data_length > UINT32_MAX ) {
+		return mx_error( MXE_WOULD_EXCEED_LIMIT, fname,
+		"The requested bulk data length (%lu) is longer than the "
+		"maximum length (%lu) of an MX network message.",
+			(unsigned long) bulk_data_length,
+			(unsigned long) UINT32_MAX );
+	}
+
+	header = message_buffer->u.uint32_buffer;
+
+	header[MX_NETWORK_MESSAGE_LENGTH] =
+			mx_htonl( (uint32_t) bulk_data_length );
+
+	header_length = mx_ntohl( header[ MX_NETWORK_HEADER_LENGTH ] );
+
+	/* If requested, compute the timeout time for this message. */
+
+	if ( timeout < 0.0 ) {
+		no_timeout = TRUE;
+
+		timeout_time = mx_current_clock_tick();
+	} else {
+		no_timeout = FALSE;
+
+		timeout_interval = mx_convert_seconds_to_clock_ticks( timeout );
+
+		current_time = mx_current_clock_tick();
+
+		timeout_time = mx_add_clock_ticks( current_time,
+							timeout_interval );
+	}
+
+#if MX_NET_SOCKET_DEBUG_TOTAL_PERFORMANCE
+	MX_HRT_START( total_measurement );
+#endif
+
+#if HAVE_READV_WRITEV
+
+	/* Send the header and the bulk data with a single writev() call
+	 * where possible.  After a partial write, skip over the iovec
+	 * entries that have already been sent and try again.
+	 */
+
+	iovec_array[0].iov_base = message_buffer->u.char_buffer;
+	iovec_array[0].iov_len  = header_length;
+
+	iovec_array[1].iov_base = bulk_data;
+	iovec_array[1].iov_len  = bulk_data_length;
+
+	iov = iovec_array;
+	iov_count = 2;
+
+	mx_status = MX_SUCCESSFUL_RESULT;
+
+	while ( iov_count > 0 ) {
+
+		if ( iov->iov_len == 0 ) {
+			iov++;
+			iov_count--;
+			continue;
+		}
+
+		bytes_sent = writev( mx_socket->socket_fd, iov, iov_count );
+
+		if ( bytes_sent < 0 ) {
+			mx_status = mxp_network_socket_check_error( mx_socket,
+					no_timeout, timeout_time, timeout,
+					&retry, fname );
+
+			if ( retry == FALSE )
+				return mx_status;
+
+			continue;
+		}
+
+		while ( (iov_count > 0) && ((size_t) bytes_sent >= iov->iov_len) ) {
+			bytes_sent -= iov->iov_len;
+			iov++;
+			iov_count--;
+		}
+
+		if ( bytes_sent > 0 ) {
+			iov->iov_base = (char *) iov->iov_base + bytes_sent;
+			iov->iov_len -= bytes_sent;
+		}
+	}
+
+#else /* not HAVE_READV_WRITEV */
+
+	mx_status = mxp_network_socket_send_bytes( mx_socket,
+			message_buffer->u.char_buffer, header_length,
+			no_timeout, timeout_time, timeout, fname );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_status = mxp_network_socket_send_bytes( mx_socket,
+			bulk_data, bulk_data_length,
+			no_timeout, timeout_time, timeout, fname );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+#endif /* not HAVE_READV_WRITEV */
+
+#if MX_NET_SOCKET_DEBUG_TOTAL_PERFORMANCE
+	MX_HRT_END( total_measurement );
+
+	MX_HRT_RESULTS( total_measurement, fname, "Total duration" );
+#endif
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
 MX_EXPORT mx_status_type
 mx_network_socket_send_error_message( MX_SOCKET *mx_socket,
 			uint32_t message_id,
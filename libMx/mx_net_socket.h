@@ -34,6 +34,13 @@ MX_API mx_status_type mx_network_socket_send_message(
 				double timeout,
 				MX_NETWORK_MESSAGE_BUFFER *message_buffer );
 
+MX_API mx_status_type mx_network_socket_send_bulk_message(
+				MX_SOCKET *mx_socket,
+				double timeout,
+				MX_NETWORK_MESSAGE_BUFFER *message_buffer,
+				void *bulk_data,
+				size_t bulk_data_length );
+
 MX_API mx_status_type mx_network_socket_send_error_message(
 				MX_SOCKET *mx_socket,
 				uint32_t message_id,
@@ -73,6 +73,14 @@
 #  define HAVE_UNIX_DOMAIN_SOCKETS	0
 #endif
 
+/* Do we have the Linux epoll() event notification interface? */
+
+#if defined( OS_LINUX )
+#  define HAVE_EPOLL			1
+#else
+#  define HAVE_EPOLL			0
+#endif
+
 /* Do we have a version of FIONREAD that supports sockets? */
 
 #if defined( OS_LINUX ) || defined( OS_MACOSX ) || defined( OS_SOLARIS )
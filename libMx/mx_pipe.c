@@ -941,6 +941,35 @@ mx_pipe_set_blocking_mode( MX_PIPE *mx_pipe,
 	return MX_SUCCESSFUL_RESULT;
 }
 
+/* mx_pipe_get_read_fd() lets event loops built on select(), poll(),
+ * or epoll() wait on the read end of the pipe alongside their sockets.
+ */
+
+MX_EXPORT mx_status_type
+mx_pipe_get_read_fd( MX_PIPE *mx_pipe, int *read_fd )
+{
+	static const char fname[] = "mx_pipe_get_read_fd()";
+
+	MX_UNIX_PIPE *unix_pipe;
+	mx_status_type mx_status;
+
+	unix_pipe = NULL;
+
+	if ( read_fd == (int *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The read_fd pointer passed was NULL." );
+	}
+
+	mx_status = mx_pipe_get_pointers( mx_pipe, &unix_pipe, fname );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	*read_fd = unix_pipe->read_fd;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
 /************************ VxWorks ***********************/
 
 #elif defined(OS_VXWORKS)
@@ -1300,3 +1329,23 @@ mx_pipe_set_blocking_mode( MX_PIPE *mx_pipe,
 #error MX pipe functions have not yet been defined for this platform.
 
 #endif
+
+/*-------------------------------------------------------------------------*/
+
+/* Only Unix-like pipes are backed by a file descriptor. */
+
+#if !( defined(OS_UNIX) || defined(OS_CYGWIN) || defined(OS_VMS) \
+	|| defined(OS_DJGPP) || defined(OS_ANDROID) || defined(OS_MINIX) ) \
+	|| defined(OS_WIN32)
+
+MX_EXPORT mx_status_type
+mx_pipe_get_read_fd( MX_PIPE *mx_pipe, int *read_fd )
+{
+	static const char fname[] = "mx_pipe_get_read_fd()";
+
+	return mx_error( MXE_UNSUPPORTED, fname,
+	"MX pipes are not file descriptors on this operating system." );
+}
+
+#endif
+
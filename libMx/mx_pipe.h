@@ -52,6 +52,8 @@ MX_API mx_status_type mx_pipe_set_blocking_mode( MX_PIPE *mx_pipe,
 					int flags,
 					mx_bool_type blocking_mode_flag );
 
+MX_API mx_status_type mx_pipe_get_read_fd( MX_PIPE *mx_pipe, int *read_fd );
+
 #ifdef __cplusplus
 }
 #endif
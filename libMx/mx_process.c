@@ -38,6 +38,7 @@
 #include "mx_callback.h"
 #include "mx_clock.h"
 #include "mx_hrt_debug.h"
+#include "mx_metrics.h"
 
 #include "mx_process.h"
 #include "pr_handlers.h"
@@ -223,6 +224,7 @@ mx_process_record_field( MX_RECORD *record,
 	mx_status_type (*process_fn) ( void *, void *, int );
 	unsigned long rp_flags;
 	mx_bool_type value_changed;
+	uint64_t metrics_start;
 	mx_status_type mx_status;
 
 #if PROCESS_DEBUG_TIMING
@@ -327,9 +329,15 @@ mx_process_record_field( MX_RECORD *record,
 
 			/* Invoke the record processing function. */
 
+			metrics_start = mx_metrics_start();
+
 			mx_status = ( *process_fn )
 				    ( record, record_field, direction );
 
+			mx_metrics_stop( mx_metrics_get_record_metric( record,
+					MX_METRIC_RECORD_PROCESS ),
+					metrics_start );
+
 			record_field->active = FALSE;
 
 #if PROCESS_DEBUG
@@ -373,6 +381,10 @@ mx_process_record_field( MX_RECORD *record,
 			fname, value_changed));
 #endif
 
+		if ( value_changed ) {
+			record_field->generation++;
+		}
+
 		if ( value_changed
 		  && (record_field->callback_list != NULL ) )
 		{
@@ -71,6 +71,11 @@ typedef struct {
 	unsigned long remote_mx_version;
 	uint64_t      remote_mx_version_time;
 
+	/* Set while a request from this client is being executed
+	 * by an mxserver worker thread.
+	 */
+	mx_bool_type request_in_progress;
+
 	long authentication_type;
 	union {
 		struct mx_no_auth none;
@@ -81,6 +86,11 @@ typedef struct {
 
 } MX_SOCKET_HANDLER;
 
+/* Values for the 'event_loop_type' member of MX_SOCKET_HANDLER_LIST. */
+
+#define MXF_SRV_SELECT_EVENT_LOOP	1
+#define MXF_SRV_EPOLL_EVENT_LOOP	2
+
 typedef struct {
 	int max_sockets;
 	int num_sockets_in_use;
@@ -88,6 +98,13 @@ typedef struct {
 	int handler_array_size;
 	MX_SOCKET_HANDLER **array;
 	fd_set select_readfds;
+
+	int event_loop_type;
+
+	/* The following are only used by the epoll() event loop. */
+
+	int epoll_fd;
+	int *epoll_registered_fd_array;
 } MX_SOCKET_HANDLER_LIST;
 
 /* Define values for the 'event_type' member of MX_QUEUED_EVENT. */
@@ -33,6 +33,7 @@
 #include "mx_ascii.h"
 #include "mx_array.h"
 #include "mx_handle.h"
+#include "mx_hash_table.h"
 #include "mx_signal.h"
 #include "mx_list_head.h"
 #include "mx_net.h"
@@ -201,6 +202,9 @@ mx_create_record( void )
 		new_record->network_type_name[0] = '\0';
 		new_record->event_time_manager = NULL;
 		new_record->event_queue = NULL;
+		new_record->record_lock = NULL;
+		new_record->driver = NULL;
+		new_record->metric_array = NULL;
 		new_record->application_ptr = NULL;
 
 		new_record->previous_record = NULL;
@@ -341,6 +345,33 @@ mx_delete_record( MX_RECORD *record )
 			fname, record->name, list_head_struct->num_records));
 	}
 
+	/* Remove the record from the record name index.  If this is the
+	 * list head record itself, then the whole index goes away.
+	 */
+
+	if ( list_head_struct->record_name_index != NULL ) {
+		MX_HASH_TABLE *record_name_index;
+		void *indexed_record;
+
+		record_name_index = list_head_struct->record_name_index;
+
+		if ( record == record->list_head ) {
+			mx_hash_table_destroy( record_name_index );
+
+			list_head_struct->record_name_index = NULL;
+		} else {
+			mx_status = mx_hash_table_lookup_key( record_name_index,
+						record->name, &indexed_record );
+
+			if ( ( mx_status.code == MXE_SUCCESS )
+			  && ( indexed_record == record ) )
+			{
+				(void) mx_hash_table_delete_key(
+					record_name_index, record->name );
+			}
+		}
+	}
+
 	/* Find the type specific 'delete record' function to delete the
 	 * type specific parts of the record.  If anything goes wrong in
 	 * this processing, continue anyway.
@@ -376,6 +407,10 @@ mx_delete_record( MX_RECORD *record )
 
 	*(record->name) = '\0';   /* Erase the name */
 
+	/* The metrics themselves stay in the metrics registry. */
+
+	mx_free( record->metric_array );
+
 	mx_free( record );
 
 	MX_DEBUG( 8,("%s is complete.", fname));
@@ -587,6 +622,7 @@ mx_insert_after_record( MX_RECORD *old_record, MX_RECORD *new_record )
 
 	MX_RECORD *old_next_record;
 	MX_LIST_HEAD *list_head;
+	mx_status_type mx_status;
 
 	if ( old_record == (MX_RECORD *) NULL ) {
 		return mx_error( MXE_NULL_ARGUMENT, fname,
@@ -633,6 +669,23 @@ mx_insert_after_record( MX_RECORD *old_record, MX_RECORD *new_record )
 	MX_DEBUG( 8,("%s: inserted record '%s', num_records = %lu",
 		fname, new_record->name, list_head->num_records));
 
+	/* Add the record to the record name index.  If that fails, we
+	 * throw the index away, so that mx_get_record() goes back to
+	 * searching the record list one record at a time.
+	 */
+
+	if ( list_head->record_name_index != NULL ) {
+		mx_status = mx_hash_table_insert_key(
+				list_head->record_name_index,
+				new_record->name, new_record );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			mx_hash_table_destroy( list_head->record_name_index );
+
+			list_head->record_name_index = NULL;
+		}
+	}
+
 	return MX_SUCCESSFUL_RESULT;
 }
 
@@ -643,6 +696,9 @@ mx_get_record( MX_RECORD *specified_record, const char *record_name )
 
 	MX_RECORD *current_record;
 	MX_RECORD *matching_record;
+	MX_LIST_HEAD *list_head;
+	void *indexed_record;
+	mx_status_type mx_status;
 
 	if ( specified_record == (MX_RECORD *) NULL ) {
 		mx_error( MXE_ILLEGAL_ARGUMENT, fname,
@@ -657,6 +713,32 @@ mx_get_record( MX_RECORD *specified_record, const char *record_name )
 		return NULL;
 	}
 
+	/* If the record list has a record name index, then use it.  Every
+	 * record in the list is in the index, so a name that is not in
+	 * the index is not in the list either.
+	 */
+
+	list_head = NULL;
+
+	if ( specified_record->list_head != (MX_RECORD *) NULL ) {
+		list_head = (MX_LIST_HEAD *)
+		    specified_record->list_head->record_superclass_struct;
+	}
+
+	if ( ( list_head != (MX_LIST_HEAD *) NULL )
+	  && ( list_head->record_name_index != NULL ) )
+	{
+		mx_status = mx_hash_table_lookup_key(
+				list_head->record_name_index,
+				record_name, &indexed_record );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			return NULL;
+		}
+
+		return (MX_RECORD *) indexed_record;
+	}
+
 	/* Walk through the linked list looking for the record.
 	 * Since the list is a circular list, we will find the
 	 * record regardless of where in the list we start.
@@ -1218,6 +1300,191 @@ mxp_get_cfn_filename( int filename_type,
 	return mx_status;
 }
 
+/* A '!set record.field value' line in a database file gives an initial
+ * value to a record field that is not part of the record description,
+ * such as 'ad.num_correction_threads'.  The value is written to the
+ * field and then the field is processed with MX_PROCESS_PUT, just as
+ * if a client had written the value.  Since the record must be open
+ * for that to work, the settings are saved here while the database is
+ * read and then are applied in order by mx_initialize_hardware() after
+ * all of the records have been opened.
+ *
+ * Like '!include', '!set' lines are not preserved when a database is
+ * written back out.
+ */
+
+static mx_status_type
+mxp_defer_field_setting( MX_RECORD *record_list_head, char *setting )
+{
+	static const char fname[] = "mxp_defer_field_setting()";
+
+	MX_LIST_HEAD *list_head;
+	char **new_array;
+	long n;
+
+	list_head = mx_get_record_list_head_struct( record_list_head );
+
+	if ( list_head == (MX_LIST_HEAD *) NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"The MX_LIST_HEAD pointer for the record list is NULL." );
+	}
+
+	n = list_head->num_deferred_field_settings;
+
+	new_array = (char **) realloc( list_head->deferred_field_setting_array,
+						(n+1) * sizeof(char *) );
+
+	if ( new_array == (char **) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to save the database directive "
+		"'!set %s'.", setting );
+	}
+
+	list_head->deferred_field_setting_array = new_array;
+
+	new_array[n] = strdup( setting );
+
+	if ( new_array[n] == (char *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to save the database directive "
+		"'!set %s'.", setting );
+	}
+
+	list_head->num_deferred_field_settings = n+1;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+static mx_status_type
+mxp_apply_field_setting( MX_RECORD *record_list_head, char *setting )
+{
+	static const char fname[] = "mxp_apply_field_setting()";
+
+	MX_RECORD *record;
+	MX_RECORD_FIELD *field;
+	char record_name[ MXU_RECORD_NAME_LENGTH + 1 ];
+	char field_name[ MXU_FIELD_NAME_LENGTH + 1 ];
+	char *name_ptr, *dot_ptr, *value_ptr;
+	size_t name_length, record_name_length;
+	mx_status_type mx_status;
+
+	name_ptr = setting + strspn( setting, " \t" );
+
+	name_length = strcspn( name_ptr, " \t" );
+
+	value_ptr = name_ptr + name_length;
+
+	value_ptr += strspn( value_ptr, " \t" );
+
+	dot_ptr = memchr( name_ptr, '.', name_length );
+
+	if ( ( dot_ptr == NULL ) || ( dot_ptr == name_ptr )
+	  || ( dot_ptr == (name_ptr + name_length - 1) )
+	  || ( *value_ptr == '\0' ) )
+	{
+		return mx_error( MXE_SOFTWARE_CONFIGURATION_ERROR, fname,
+		"Malformed database directive '!set %s'.  "
+		"The expected format is '!set record.field value'.", setting );
+	}
+
+	record_name_length = dot_ptr - name_ptr;
+
+	if ( record_name_length > MXU_RECORD_NAME_LENGTH ) {
+		record_name_length = MXU_RECORD_NAME_LENGTH;
+	}
+
+	memcpy( record_name, name_ptr, record_name_length );
+	record_name[ record_name_length ] = '\0';
+
+	name_length -= ( dot_ptr - name_ptr ) + 1;
+
+	if ( name_length > MXU_FIELD_NAME_LENGTH ) {
+		name_length = MXU_FIELD_NAME_LENGTH;
+	}
+
+	memcpy( field_name, dot_ptr + 1, name_length );
+	field_name[ name_length ] = '\0';
+
+	record = mx_get_record( record_list_head, record_name );
+
+	if ( record == (MX_RECORD *) NULL ) {
+		return mx_error( MXE_NOT_FOUND, fname,
+		"Record '%s' named by the database directive '!set %s' "
+		"does not exist.", record_name, setting );
+	}
+
+	mx_status = mx_find_record_field( record, field_name, &field );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	if ( field->flags & MXFF_READ_ONLY ) {
+		return mx_error( MXE_READ_ONLY, fname,
+		"Field '%s.%s' is read only and may not be changed by "
+		"a '!set' database directive.", record_name, field_name );
+	}
+
+	if ( record->record_flags & MXF_REC_FAULTED ) {
+		return mx_error( MXE_NOT_READY, fname,
+		"Record '%s' named by the database directive '!set %s' "
+		"failed to initialize, so the field cannot be set.",
+			record_name, setting );
+	}
+
+	mx_status = mx_create_field_from_description( record, field,
+							NULL, value_ptr );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_status = mx_process_record_field( record, field,
+						MX_PROCESS_PUT, NULL );
+
+	return mx_status;
+}
+
+static mx_status_type
+mxp_apply_deferred_field_settings( MX_RECORD *record_list_head,
+				unsigned long inithw_flags )
+{
+	MX_LIST_HEAD *list_head;
+	long i;
+	mx_status_type mx_status;
+
+	list_head = mx_get_record_list_head_struct( record_list_head );
+
+	if ( list_head == (MX_LIST_HEAD *) NULL ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	mx_status = MX_SUCCESSFUL_RESULT;
+
+	/* A setting that fails has already been reported by mx_error().
+	 * As with records that fail to open, we only stop here if the
+	 * caller asked us to abort on faults.
+	 */
+
+	for ( i = 0; i < list_head->num_deferred_field_settings; i++ ) {
+		if ( mx_status.code == MXE_SUCCESS ) {
+			mx_status = mxp_apply_field_setting( record_list_head,
+				list_head->deferred_field_setting_array[i] );
+
+			if ( ( inithw_flags & MXF_INITHW_ABORT_ON_FAULT ) == 0 )
+			{
+				mx_status = MX_SUCCESSFUL_RESULT;
+			}
+		}
+
+		mx_free( list_head->deferred_field_setting_array[i] );
+	}
+
+	mx_free( list_head->deferred_field_setting_array );
+
+	list_head->num_deferred_field_settings = 0;
+
+	return mx_status;
+}
+
 static mx_status_type
 mx_read_database_private( MX_RECORD *record_list_head,
 			MXP_DB_SOURCE *db_source,
@@ -1362,6 +1629,14 @@ mx_read_database_private( MX_RECORD *record_list_head,
 			if ( mx_status.code != MXE_SUCCESS )
 				return mx_status;
 
+		} else if ( strncmp( buffer, "!set ", 5 ) == 0 ) {
+
+			mx_status = mxp_defer_field_setting( record_list_head,
+								buffer + 5 );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				return mx_status;
+
 		} else if ( strncmp( buffer, "!return", 7 ) == 0 ) {
 
 			return MX_SUCCESSFUL_RESULT;
@@ -1807,6 +2082,14 @@ mx_initialize_hardware( MX_RECORD *record_list_head,
 
 	} while ( current_record != record_list_head );
 
+	/* Apply any field values requested by '!set' database directives. */
+
+	mx_status = mxp_apply_deferred_field_settings( record_list_head,
+							inithw_flags );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
 	/* Now that all of the MX records have been created and
 	 * initialized, it is now time to invoke the finalize
 	 * method for all of the loaded extensions.
@@ -95,6 +95,15 @@ extern "C" {
 #define MXFF_UPDATE_ALL			0x40000000
 #define MXFF_SHOW_ALL			0x80000000
 
+/* The following bitmasks are used in the 'poll_state' field of an
+ * MX_RECORD_FIELD to keep track of which of the value changed poll
+ * queues the field is currently on.
+ */
+
+#define MXFPS_DIRTY_QUEUED		0x1
+#define MXFPS_POLL_QUEUED		0x2
+#define MXFPS_FIRST_POLL		0x4
+
 typedef struct mx_record_field_type {
 	long label_value;
 	long field_number;
@@ -116,6 +125,13 @@ typedef struct mx_record_field_type {
 	mx_status_type (*value_changed_test_function)(
 			struct mx_record_field_type *, int, mx_bool_type *);
 
+	/* 'generation' is incremented each time that the value of
+	 * the field is known to have changed.
+	 */
+
+	unsigned long generation;
+	unsigned long poll_state;
+
 	void *callback_list;
 	void *application_ptr;
 	struct mx_record_type *record;
@@ -192,6 +208,11 @@ typedef struct mx_record_type {
 
 	MX_EVENT_TIME_MANAGER *event_time_manager;
 	void *event_queue;		/* Ptr to MXSRV_QUEUED_EVENT */
+	void *record_lock;		/* Ptr to MX_MUTEX for mxserver workers*/
+
+	void *driver;			/* Ptr to MX_DRIVER for this record */
+
+	void *metric_array;		/* Ptr to array of MX_METRIC ptrs */
 
 	void *application_ptr;
 } MX_RECORD;
@@ -372,6 +393,7 @@ typedef struct mx_driver_type {
 	long *num_record_fields;
 	MX_RECORD_FIELD_DEFAULTS **record_field_defaults_ptr;
 	struct mx_driver_type *next_driver;
+	void *field_name_index;		/* Ptr to MX_HASH_TABLE */
 } MX_DRIVER;
 
 typedef struct {
@@ -401,6 +423,16 @@ typedef struct {
 
 #define MX_FIXUP_RECORD_ARRAY_BLOCK_SIZE	50
 
+/* By default, the value changed poller checks every field that has
+ * callbacks on every poll, as it always has, and fields marked by
+ * mx_local_field_mark_dirty() are not queued.  Servers whose drivers
+ * all report their own changes may set a larger sweep interval, or 0
+ * for no sweep, so that each poll only visits the dirty fields and the
+ * MXFF_POLL fields that are due.
+ */
+
+#define MX_DEFAULT_POLL_SWEEP_INTERVAL		1
+
 typedef struct {
 	MX_RECORD *record;
 
@@ -443,6 +475,17 @@ typedef struct {
 	char *cflags;
 	unsigned long vm_region[2];
 
+	/* Runtime metrics.  'metrics' is the text exposition of all of
+	 * the metrics, while 'metric_values' holds the values of the
+	 * single metric selected by 'metric_name'.  See mx_metrics.h.
+	 */
+
+	mx_bool_type metrics_enabled;
+	mx_bool_type metrics_reset;
+	char *metrics;
+	char *metric_name;
+	uint64_t *metric_values;
+
 	mx_bool_type is_server;
 	void *connection_acl;
 	mx_bool_type fixup_records_in_use;
@@ -456,6 +499,8 @@ typedef struct {
 	void *handle_table;
 	void *application_ptr;
 
+	void *record_name_index;	/* Ptr to MX_HASH_TABLE */
+
 	char hostname[ MXU_HOSTNAME_LENGTH + 1 ];
 	char username[ MXU_USERNAME_LENGTH + 1 ];
 	char program_name[ MXU_PROGRAM_NAME_LENGTH + 1 ];
@@ -474,8 +519,18 @@ typedef struct {
 	void *poll_callback_message;
 	unsigned long num_poll_callbacks;
 	double poll_callback_interval;		/* in seconds */
+	void *poll_schedule;
+	unsigned long poll_sweep_interval;	/* in poll callbacks */
 
 	void *module_list;
+
+	/* Field values from '!set' directives in the database file.
+	 * They are applied by mx_initialize_hardware() after all of
+	 * the records have been opened.
+	 */
+
+	long num_deferred_field_settings;
+	char **deferred_field_setting_array;
 } MX_LIST_HEAD;
 
 /* --- Record list handling functions. --- */
@@ -783,6 +838,15 @@ MX_API_PRIVATE mx_status_type  mx_find_record_field_defaults_index(
 		const char *name_of_field_to_find,
 		long *index_of_field_that_was_found );
 
+/* mx_create_field_name_index() builds the hash table that lets
+ * mx_get_record_field() and mx_find_record_field() find the fields of
+ * records that use this driver without a linear search.  It is called
+ * when the first record using the driver is created, which happens in
+ * the main thread while the database is being loaded.
+ */
+
+MX_API_PRIVATE mx_status_type  mx_create_field_name_index( MX_DRIVER *driver );
+
 MX_API long mx_get_datatype_from_datatype_name( const char *datatype_name );
 
 MX_API const char *mx_get_datatype_name_from_datatype( long datatype );
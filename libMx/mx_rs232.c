@@ -24,6 +24,7 @@
 #include "mx_util.h"
 #include "mx_rs232.h"
 #include "mx_driver.h"
+#include "mx_metrics.h"
 
 /*-------------------------- Internal driver functions ----------------------*/
 
@@ -774,6 +775,7 @@ mx_rs232_getchar( MX_RECORD *record,
 	MX_RS232 *rs232;
 	MX_RS232_FUNCTION_LIST *fl_ptr;
 	mx_status_type (*fptr)( MX_RS232 *, char * );
+	uint64_t metrics_start;
 	mx_status_type mx_status;
 
 	mx_status = mx_rs232_get_pointers( record, &rs232, &fl_ptr, fname );
@@ -793,8 +795,13 @@ mx_rs232_getchar( MX_RECORD *record,
 
 	rs232->transfer_flags = transfer_flags;
 
+	metrics_start = mx_metrics_start();
+
 	mx_status = (*fptr)( rs232, c );
 
+	mx_metrics_stop( mx_metrics_get_record_metric( record,
+				MX_METRIC_RS232_GETCHAR ), metrics_start );
+
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
@@ -811,6 +818,7 @@ mx_rs232_putchar( MX_RECORD *record,
 	MX_RS232 *rs232;
 	MX_RS232_FUNCTION_LIST *fl_ptr;
 	mx_status_type (*fptr)( MX_RS232 *, char );
+	uint64_t metrics_start;
 	mx_status_type mx_status;
 
 	mx_status = mx_rs232_get_pointers( record, &rs232, &fl_ptr, fname );
@@ -831,8 +839,13 @@ mx_rs232_putchar( MX_RECORD *record,
 
 	/* Invoke the function. */
 
+	metrics_start = mx_metrics_start();
+
 	mx_status = (*fptr)( rs232, c );
 
+	mx_metrics_stop( mx_metrics_get_record_metric( record,
+				MX_METRIC_RS232_PUTCHAR ), metrics_start );
+
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
@@ -940,6 +953,7 @@ mx_rs232_read( MX_RECORD *record,
 	size_t i, bytes_read_by_driver;
 	char c;
 	int buffered_io;
+	uint64_t metrics_start;
 	mx_status_type mx_status;
 
 	mx_status = mx_rs232_get_pointers( record, &rs232, &fl_ptr, fname );
@@ -960,8 +974,13 @@ mx_rs232_read( MX_RECORD *record,
 	rs232->transfer_flags = transfer_flags;
 
 	if ( buffered_io && ( fptr != NULL ) ) {
+		metrics_start = mx_metrics_start();
+
 		mx_status = (*fptr)( rs232, buffer,
 			max_bytes_to_read, &bytes_read_by_driver );
+
+		mx_metrics_stop( mx_metrics_get_record_metric( record,
+				MX_METRIC_RS232_READ ), metrics_start );
 	} else {
 		for ( i = 0; i < max_bytes_to_read; i++ ) {
 			mx_status = mx_rs232_getchar(record, &c, MXF_232_WAIT);
@@ -1009,6 +1028,7 @@ mx_rs232_write( MX_RECORD *record,
 	mx_status_type (*fptr)( MX_RS232 *, char *, size_t, size_t * );
 	size_t i, bytes_written_by_driver;
 	int buffered_io;
+	uint64_t metrics_start;
 	mx_status_type mx_status;
 
 	mx_status = mx_rs232_get_pointers( record, &rs232, &fl_ptr, fname );
@@ -1034,8 +1054,13 @@ mx_rs232_write( MX_RECORD *record,
 	rs232->transfer_flags = transfer_flags;
 
 	if ( buffered_io && ( fptr != NULL ) ) {
+		metrics_start = mx_metrics_start();
+
 		mx_status = (*fptr)( rs232, buffer,
 				bytes_to_write, &bytes_written_by_driver );
+
+		mx_metrics_stop( mx_metrics_get_record_metric( record,
+				MX_METRIC_RS232_WRITE ), metrics_start );
 	} else {
 		for ( i = 0; i < bytes_to_write; i++ ) {
 			mx_status = mx_rs232_putchar( record,
@@ -1152,6 +1177,7 @@ mx_rs232_getline( MX_RECORD *record,
 	MX_RS232_FUNCTION_LIST *fl_ptr;
 	mx_status_type (*fptr)( MX_RS232 *, char *, size_t, size_t * );
 	mx_bool_type buffered_io;
+	uint64_t metrics_start;
 	mx_status_type mx_status;
 
 	mx_status = mx_rs232_get_pointers( record, &rs232, &fl_ptr, fname );
@@ -1183,9 +1209,14 @@ mx_rs232_getline( MX_RECORD *record,
 
 		/* If so, invoke it. */
 
+		metrics_start = mx_metrics_start();
+
 		mx_status =
 			(*fptr)(rs232, buffer, max_bytes_to_read, bytes_read);
 
+		mx_metrics_stop( mx_metrics_get_record_metric( record,
+				MX_METRIC_RS232_GETLINE ), metrics_start );
+
 	} else {
 		/* Otherwise, handle input a character at a time. */
 
@@ -1219,6 +1250,7 @@ mx_rs232_putline( MX_RECORD *record,
 	mx_status_type (*write_fn)( MX_RS232 *, char *, size_t, size_t * );
 	size_t length;
 	mx_bool_type buffered_io;
+	uint64_t metrics_start;
 	mx_status_type mx_status;
 
 	mx_status = mx_rs232_get_pointers( record, &rs232, &fl_ptr, fname );
@@ -1248,8 +1280,13 @@ mx_rs232_putline( MX_RECORD *record,
 
 		/* If it has putline, invoke it. */
 
+		metrics_start = mx_metrics_start();
+
 		mx_status = (*putline_fn)( rs232, buffer, bytes_written );
 
+		mx_metrics_stop( mx_metrics_get_record_metric( record,
+				MX_METRIC_RS232_PUTLINE ), metrics_start );
+
 	} else
 	if ( buffered_io && ( write_fn != NULL ) ) {
 
@@ -110,6 +110,7 @@ mx_scan_finish_record_initialization( MX_RECORD *record )
 	scan->measurement.measurement_function_list
 			= measurement_type_entry->measurement_function_list;
 	scan->measurement.measurement_arguments = scan->measurement_arguments;
+	scan->measurement.readout_plan = NULL;
 
 	/*-------------------------------------------------------------------*/
 
@@ -40,6 +40,7 @@ extern "C" {
 
 #define MXF_SCAN_EARLY_MOVE			0x1
 #define MXF_SCAN_SUPPRESS_PROGRESS_DISPLAY	0x2
+#define MXF_SCAN_PARALLEL_READOUT		0x4
 
 /* Values for scan->shutter_policy */
 
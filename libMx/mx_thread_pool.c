@@ -0,0 +1,283 @@
+/*
+ * Name:    mx_thread_pool.c
+ *
+ * Purpose: MX thread pools for running batches of independent tasks
+ *          in parallel.
+ *
+ * Author:  William Lavender
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Copyright 2016 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#define MX_THREAD_POOL_DEBUG	FALSE
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mx_util.h"
+#include "mx_thread_pool.h"
+
+/*-------------------------------------------------------------------------*/
+
+/* Claims and runs tasks from the current batch until none are left.
+ * The pool mutex must be locked on entry and is locked on return.
+ */
+
+static void
+mxp_thread_pool_run_tasks( MX_THREAD_POOL *pool )
+{
+	unsigned long task_number;
+	void *task;
+
+	while ( pool->next_task < pool->num_tasks ) {
+		task_number = pool->next_task;
+
+		pool->next_task++;
+
+		task = pool->task_array + task_number * pool->task_size;
+
+		mx_mutex_unlock( pool->mutex );
+
+		(pool->task_function)( task );
+
+		mx_mutex_lock( pool->mutex );
+
+		pool->num_tasks_done++;
+
+		if ( pool->num_tasks_done >= pool->num_tasks ) {
+			(void) mx_condition_variable_signal( pool->done_cv );
+		}
+	}
+}
+
+static mx_status_type
+mxp_thread_pool_thread_fn( MX_THREAD *thread, void *args )
+{
+	MX_THREAD_POOL *pool;
+
+	pool = (MX_THREAD_POOL *) args;
+
+	mx_mutex_lock( pool->mutex );
+
+	for (;;) {
+		while ( ( pool->shutdown == FALSE )
+		  && ( pool->next_task >= pool->num_tasks ) )
+		{
+			(void) mx_condition_variable_wait( pool->work_cv,
+								pool->mutex );
+		}
+
+		if ( pool->shutdown ) {
+			break;
+		}
+
+		mxp_thread_pool_run_tasks( pool );
+	}
+
+	mx_mutex_unlock( pool->mutex );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_thread_pool_create( MX_THREAD_POOL **pool, unsigned long num_threads )
+{
+	static const char fname[] = "mx_thread_pool_create()";
+
+	MX_THREAD_POOL *new_pool;
+	unsigned long i;
+	mx_status_type mx_status;
+
+	if ( pool == (MX_THREAD_POOL **) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_THREAD_POOL pointer passed was NULL." );
+	}
+	if ( num_threads == 0 ) {
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"A thread pool must have at least 1 thread." );
+	}
+
+	*pool = NULL;
+
+	new_pool = (MX_THREAD_POOL *) calloc( 1, sizeof(MX_THREAD_POOL) );
+
+	if ( new_pool == (MX_THREAD_POOL *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate an MX_THREAD_POOL." );
+	}
+
+	new_pool->thread_array = (MX_THREAD **)
+				calloc( num_threads, sizeof(MX_THREAD *) );
+
+	if ( new_pool->thread_array == (MX_THREAD **) NULL ) {
+		mx_free( new_pool );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a %lu element "
+		"thread array for a thread pool.", num_threads );
+	}
+
+	mx_status = mx_mutex_create( &(new_pool->mutex) );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		(void) mx_thread_pool_destroy( new_pool );
+		return mx_status;
+	}
+
+	mx_status = mx_condition_variable_create( &(new_pool->work_cv) );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		(void) mx_thread_pool_destroy( new_pool );
+		return mx_status;
+	}
+
+	mx_status = mx_condition_variable_create( &(new_pool->done_cv) );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		(void) mx_thread_pool_destroy( new_pool );
+		return mx_status;
+	}
+
+	/* The calling thread is counted as one of the threads. */
+
+	new_pool->num_threads = 1;
+
+	for ( i = 1; i < num_threads; i++ ) {
+		mx_status = mx_thread_create( &(new_pool->thread_array[i]),
+					mxp_thread_pool_thread_fn, new_pool );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			(void) mx_thread_pool_destroy( new_pool );
+			return mx_status;
+		}
+
+		new_pool->num_threads++;
+	}
+
+#if MX_THREAD_POOL_DEBUG
+	MX_DEBUG(-2,("%s: created pool %p with %lu threads.",
+		fname, new_pool, new_pool->num_threads));
+#endif
+
+	*pool = new_pool;
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_thread_pool_destroy( MX_THREAD_POOL *pool )
+{
+	unsigned long i;
+
+	if ( pool == (MX_THREAD_POOL *) NULL ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	if ( pool->mutex != NULL ) {
+		mx_mutex_lock( pool->mutex );
+
+		pool->shutdown = TRUE;
+
+		if ( pool->work_cv != NULL ) {
+			(void) mx_condition_variable_broadcast(pool->work_cv);
+		}
+
+		mx_mutex_unlock( pool->mutex );
+	}
+
+	for ( i = 1; i < pool->num_threads; i++ ) {
+		if ( pool->thread_array[i] != NULL ) {
+			(void) mx_thread_wait( pool->thread_array[i],
+					NULL, MX_THREAD_INFINITE_WAIT );
+
+			(void) mx_thread_free_data_structures(
+					pool->thread_array[i] );
+		}
+	}
+
+	if ( pool->done_cv != NULL ) {
+		(void) mx_condition_variable_destroy( pool->done_cv );
+	}
+	if ( pool->work_cv != NULL ) {
+		(void) mx_condition_variable_destroy( pool->work_cv );
+	}
+	if ( pool->mutex != NULL ) {
+		(void) mx_mutex_destroy( pool->mutex );
+	}
+
+	mx_free( pool->thread_array );
+	mx_free( pool );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+MX_EXPORT mx_status_type
+mx_thread_pool_run( MX_THREAD_POOL *pool,
+			MX_THREAD_POOL_FUNCTION *task_function,
+			void *task_array,
+			size_t task_size,
+			unsigned long num_tasks )
+{
+	static const char fname[] = "mx_thread_pool_run()";
+
+	unsigned long i;
+
+	if ( task_function == (MX_THREAD_POOL_FUNCTION *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The task_function pointer passed was NULL." );
+	}
+
+	/* Without a pool, just run the tasks in this thread. */
+
+	if ( ( pool == (MX_THREAD_POOL *) NULL ) || ( pool->num_threads <= 1 ) )
+	{
+		for ( i = 0; i < num_tasks; i++ ) {
+			(task_function)( (char *) task_array + i * task_size );
+		}
+
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	mx_mutex_lock( pool->mutex );
+
+	if ( pool->num_tasks_done < pool->num_tasks ) {
+		mx_mutex_unlock( pool->mutex );
+
+		return mx_error( MXE_NOT_READY, fname,
+		"Thread pool %p is already running a batch of tasks.", pool );
+	}
+
+	pool->task_function  = task_function;
+	pool->task_array     = (char *) task_array;
+	pool->task_size      = task_size;
+	pool->num_tasks      = num_tasks;
+	pool->next_task      = 0;
+	pool->num_tasks_done = 0;
+
+	(void) mx_condition_variable_broadcast( pool->work_cv );
+
+	/* This thread does its share of the work too. */
+
+	mxp_thread_pool_run_tasks( pool );
+
+	while ( pool->num_tasks_done < pool->num_tasks ) {
+		(void) mx_condition_variable_wait( pool->done_cv, pool->mutex );
+	}
+
+	mx_mutex_unlock( pool->mutex );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
@@ -0,0 +1,81 @@
+/*
+ * Name:    mx_thread_pool.h
+ *
+ * Purpose: Header file for MX thread pools.
+ *
+ *          An MX thread pool is a set of persistent threads that are used
+ *          to run a batch of independent tasks in parallel.  The thread
+ *          that submits the batch also runs tasks from it and does not
+ *          return until every task in the batch has finished.
+ *
+ * Author:  William Lavender
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Copyright 2016 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#ifndef __MX_THREAD_POOL_H__
+#define __MX_THREAD_POOL_H__
+
+#include "mx_stdint.h"
+#include "mx_thread.h"
+#include "mx_mutex.h"
+#include "mx_condition_variable.h"
+
+/* Make the header file C++ safe. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (MX_THREAD_POOL_FUNCTION)( void *task );
+
+typedef struct {
+	/* num_threads counts the calling thread, so a pool with
+	 * num_threads == N starts N-1 threads of its own.
+	 */
+
+	unsigned long num_threads;
+	MX_THREAD **thread_array;
+
+	MX_MUTEX *mutex;
+	MX_CONDITION_VARIABLE *work_cv;
+	MX_CONDITION_VARIABLE *done_cv;
+
+	MX_THREAD_POOL_FUNCTION *task_function;
+	char *task_array;
+	size_t task_size;
+	unsigned long num_tasks;
+	unsigned long next_task;
+	unsigned long num_tasks_done;
+
+	mx_bool_type shutdown;
+} MX_THREAD_POOL;
+
+MX_API mx_status_type mx_thread_pool_create( MX_THREAD_POOL **pool,
+						unsigned long num_threads );
+
+MX_API mx_status_type mx_thread_pool_destroy( MX_THREAD_POOL *pool );
+
+/* mx_thread_pool_run() calls task_function() once for each of the
+ * num_tasks elements of task_array, each of which is task_size bytes
+ * long.  Only one batch at a time may be run in a given pool.
+ */
+
+MX_API mx_status_type mx_thread_pool_run( MX_THREAD_POOL *pool,
+					MX_THREAD_POOL_FUNCTION *task_function,
+					void *task_array,
+					size_t task_size,
+					unsigned long num_tasks );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MX_THREAD_POOL_H__ */
+
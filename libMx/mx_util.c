@@ -49,6 +49,7 @@
 #include "mx_record.h"
 #include "mx_signal.h"
 #include "mx_atomic.h"
+#include "mx_metrics.h"
 
 /*-------------------------------------------------------------------------*/
 
@@ -218,6 +219,13 @@ mx_initialize_runtime( void )
 
 	mx_atomic_initialize();
 
+	/* Initialize the runtime metrics registry. */
+
+	mx_status = mx_metrics_initialize();
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
 	/* We are done, so return to the caller. */
 
 	mx_status = MX_SUCCESSFUL_RESULT;
@@ -5,7 +5,7 @@
  *
  * Author:  William Lavender
  *
- * Copyright 2006-2008 Illinois Institute of Technology
+ * Copyright 2006-2008, 2016 Illinois Institute of Technology
  *
  * See the file "LICENSE" for information on usage and redistribution
  * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
@@ -18,6 +18,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
 
 #include "mx_util.h"
 #include "mx_hrt.h"
@@ -40,11 +41,22 @@
 
 /* The following are typedefs intended for the private usage of this file. */
 
+/* The pending timer events are kept in a binary min-heap ordered by
+ * expiration time, so adding, deleting and rescheduling an event each
+ * take O(log n) time.  A virtual timer never has more than one pending
+ * event, so each virtual timer owns a single event structure (pointed
+ * to by vtimer->private_ptr) that is reused every time the timer is
+ * started.
+ */
+
+#define MXP_VTIMER_NOT_SCHEDULED	ULONG_MAX
+
+#define MXP_VTIMER_HEAP_BLOCK_SIZE	64
+
 struct mx_master_timer_event_struct {
 	MX_VIRTUAL_TIMER *vtimer;
 	struct timespec expiration_time;
-	struct mx_master_timer_event_struct *previous_event;
-	struct mx_master_timer_event_struct *next_event;
+	unsigned long heap_index;
 };
 
 typedef struct mx_master_timer_event_struct MX_MASTER_TIMER_EVENT;
@@ -52,7 +64,8 @@ typedef struct mx_master_timer_event_struct MX_MASTER_TIMER_EVENT;
 typedef struct {
 	MX_MUTEX *mutex;
 	unsigned long num_timer_events;
-	MX_MASTER_TIMER_EVENT *timer_event_list;
+	unsigned long max_timer_events;
+	MX_MASTER_TIMER_EVENT **timer_event_heap;
 } MX_MASTER_TIMER_EVENT_LIST;
 
 /*--------------------------------------------------------------------------*/
@@ -82,6 +95,12 @@ mx_virtual_timer_get_pointers( MX_VIRTUAL_TIMER *vtimer,
 			vtimer );
 	}
 
+	if ( vtimer->private_ptr == NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"The timer event pointer for virtual timer %p is NULL.",
+			vtimer );
+	}
+
 	if ( master_timer != (MX_INTERVAL_TIMER **) NULL ) {
 		*master_timer = master_timer_ptr;
 	}
@@ -128,34 +147,128 @@ mx_show_event_list( const char *calling_fname,
 		return;
 	}
 
-	current_event = event_list->timer_event_list;
-
 	MX_DEBUG(-2,("Event list %p", event_list));
 	MX_DEBUG(-2,("------------------------------"));
 
-	if ( current_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
+	if ( event_list->num_timer_events == 0 ) {
 
 		MX_DEBUG(-2,("---> Event list is empty <---"));
 		return;
 	}
 
-	i = 0;
+	/* The events are shown in heap order, not in time order. */
+
+	for ( i = 0; i < event_list->num_timer_events; i++ ) {
+		current_event = event_list->timer_event_heap[i];
+
+		MX_DEBUG(-2,("Event %lu = %p, expiration_time = (%lu,%lu)",
+			i, current_event,
+			(unsigned long) current_event->expiration_time.tv_sec,
+			(unsigned long) current_event->expiration_time.tv_nsec));
+	}
+
+	MX_DEBUG(-2,("---> End of event list <---"));
+}
+
+#endif /* MX_VIRTUAL_TIMER_DEBUG */
+
+static void
+mx_place_vtimer_event( MX_MASTER_TIMER_EVENT_LIST *event_list,
+			MX_MASTER_TIMER_EVENT *event,
+			unsigned long heap_index )
+{
+	event_list->timer_event_heap[ heap_index ] = event;
+
+	event->heap_index = heap_index;
+}
+
+/* Moves an event toward the top of the heap until its parent
+ * expires no later than it does.
+ */
+
+static void
+mx_sift_vtimer_event_up( MX_MASTER_TIMER_EVENT_LIST *event_list,
+			unsigned long heap_index )
+{
+	MX_MASTER_TIMER_EVENT *event, *parent_event;
+	unsigned long parent_index;
+
+	event = event_list->timer_event_heap[ heap_index ];
+
+	while ( heap_index > 0 ) {
+		parent_index = ( heap_index - 1 ) / 2;
+
+		parent_event = event_list->timer_event_heap[ parent_index ];
+
+		if ( mx_compare_high_resolution_times(
+					event->expiration_time,
+					parent_event->expiration_time ) >= 0 )
+		{
+			break;
+		}
+
+		mx_place_vtimer_event( event_list, parent_event, heap_index );
+
+		heap_index = parent_index;
+	}
+
+	mx_place_vtimer_event( event_list, event, heap_index );
+}
+
+/* Moves an event toward the bottom of the heap until neither of its
+ * children expire before it does.
+ */
+
+static void
+mx_sift_vtimer_event_down( MX_MASTER_TIMER_EVENT_LIST *event_list,
+			unsigned long heap_index )
+{
+	MX_MASTER_TIMER_EVENT *event, *child_event, *right_event;
+	unsigned long child_index, num_events;
+
+	event = event_list->timer_event_heap[ heap_index ];
+
+	num_events = event_list->num_timer_events;
 
 	for (;;) {
+		child_index = 2 * heap_index + 1;
 
-		MX_DEBUG(-2,("Event %lu = %p", i, current_event));
+		if ( child_index >= num_events )
+			break;
 
-		current_event = current_event->next_event;
+		child_event = event_list->timer_event_heap[ child_index ];
 
-		if ( current_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
-			MX_DEBUG(-2,("---> End of event list <---"));
-			return;
+		if ( (child_index + 1) < num_events ) {
+			right_event =
+				event_list->timer_event_heap[ child_index + 1 ];
+
+			if ( mx_compare_high_resolution_times(
+					right_event->expiration_time,
+					child_event->expiration_time ) < 0 )
+			{
+				child_index++;
+				child_event = right_event;
+			}
+		}
+
+		if ( mx_compare_high_resolution_times(
+					child_event->expiration_time,
+					event->expiration_time ) >= 0 )
+		{
+			break;
 		}
-		i++;
+
+		mx_place_vtimer_event( event_list, child_event, heap_index );
+
+		heap_index = child_index;
 	}
+
+	mx_place_vtimer_event( event_list, event, heap_index );
 }
 
-#endif /* MX_VIRTUAL_TIMER_DEBUG */
+/* If the virtual timer already has a pending event, mx_add_vtimer_event()
+ * reschedules that event rather than adding a second one.
+ */
 
 static mx_status_type
 mx_add_vtimer_event( MX_MASTER_TIMER_EVENT_LIST *event_list,
@@ -166,9 +279,9 @@ mx_add_vtimer_event( MX_MASTER_TIMER_EVENT_LIST *event_list,
 	static const char fname[] = "mx_add_vtimer_event()";
 
 	MX_MASTER_TIMER_EVENT *new_event;
-	MX_MASTER_TIMER_EVENT *previous_event, *current_event, *next_event;
+	MX_MASTER_TIMER_EVENT **new_heap;
 	struct timespec current_time;
-	int comparison;
+	unsigned long new_max_timer_events;
 
 #if MX_VIRTUAL_TIMER_DEBUG
 	MX_DEBUG(-2,("%s invoked for event list %p and vtimer %p",
@@ -195,17 +308,13 @@ mx_add_vtimer_event( MX_MASTER_TIMER_EVENT_LIST *event_list,
 			MXF_VTIMER_ABSOLUTE_TIME, MXF_VTIMER_RELATIVE_TIME );
 	}
 
-	/* Create an event structure. */
-
-	new_event = (MX_MASTER_TIMER_EVENT *)
-			malloc( sizeof(MX_MASTER_TIMER_EVENT) );
+	new_event = (MX_MASTER_TIMER_EVENT *) vtimer->private_ptr;
 
 	if ( new_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
-		return mx_error( MXE_OUT_OF_MEMORY, fname,
-   "Ran out of memory trying to allocate an MX_MASTER_TIMER_EVENT structure." );
-   	}
-
-	new_event->vtimer = vtimer;
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"The timer event pointer for virtual timer %p is NULL.",
+			vtimer );
+	}
 
 	/* Compute the absolute time of the event we are adding. */
 
@@ -234,223 +343,62 @@ mx_add_vtimer_event( MX_MASTER_TIMER_EVENT_LIST *event_list,
 	}
 
 #if MX_VIRTUAL_TIMER_DEBUG
-	MX_DEBUG(-2,("%s: Created new_event = %p, expiration_time = (%lu,%lu)",
+	MX_DEBUG(-2,("%s: new_event = %p, expiration_time = (%lu,%lu)",
 		fname, new_event,
 		(unsigned long) new_event->expiration_time.tv_sec,
 		(unsigned long) new_event->expiration_time.tv_nsec));
 #endif
 
-	/* If there are no events in the event list, add new_event as the
-	 * only event in the list.
+	/* If the event is already in the heap, move it to the right
+	 * place for its new expiration time.
 	 */
 
-	current_event = event_list->timer_event_list;
+	if ( new_event->heap_index != MXP_VTIMER_NOT_SCHEDULED ) {
+		mx_sift_vtimer_event_up( event_list, new_event->heap_index );
 
-	if ( current_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
-		new_event->previous_event = NULL;
-		new_event->next_event = NULL;
-
-		event_list->timer_event_list = new_event;
+		mx_sift_vtimer_event_down( event_list, new_event->heap_index );
 
 #if MX_VIRTUAL_TIMER_DEBUG
-		MX_DEBUG(-2,("%s: event %p is the only event in the list.",
-			fname, event_list->timer_event_list));
-
 		mx_show_event_list( fname, event_list );
 #endif
-
 		return MX_SUCCESSFUL_RESULT;
 	}
 
-	/* Find the correct place in the event list for this event. */
-
-	for (;;) {
-
-#if MX_VIRTUAL_TIMER_DEBUG
-		MX_DEBUG(-2,("%s: Top of for(;;) loop, current_event = %p",
-			fname, current_event));
-#endif
-
-		comparison = mx_compare_high_resolution_times(
-					new_event->expiration_time,
-					current_event->expiration_time );
-
-		/* If the new event is scheduled to occur before the current
-		 * event, insert the new event here and then return.
-		 */
-
-		if ( comparison < 0 ) {
-			if ( current_event == event_list->timer_event_list ) {
-				new_event->previous_event = NULL;
-				new_event->next_event = current_event;
-
-				current_event->previous_event = new_event;
-				event_list->timer_event_list = new_event;
-
-#if MX_VIRTUAL_TIMER_DEBUG
-				MX_DEBUG(-2,
-			("%s: Adding event %p to the start of the list."
-			" event_list->timer_event_list->next_event = %p",
-				    fname, event_list->timer_event_list,
-				    event_list->timer_event_list->next_event));
-#endif
-			} else {
-				previous_event = current_event->previous_event;
-
-				new_event->previous_event = previous_event;
-				new_event->next_event = current_event;
-
-#if MX_VIRTUAL_TIMER_DEBUG
-				MX_DEBUG(-2,
-			("%s: Adding event %p between events %p and %p",
-			fname, new_event, previous_event, current_event));
-#endif
-
-				current_event->previous_event = new_event;
-				previous_event->next_event = new_event;
-
-#if MX_VIRTUAL_TIMER_DEBUG
-				MX_DEBUG(-2,
-			("%s: previous_event->next_event = %p, "
-			"current_event->previous_event = %p",
-				fname, previous_event->next_event,
-				current_event->previous_event));
-#endif
-			}
-			return MX_SUCCESSFUL_RESULT;
-		}
-
-		/* Proceed on to the next event in the list. */
-
-		next_event = current_event->next_event;
-
-		/* If we find that we are at the end of the list, append
-		 * the new event here.
-		 */
-
-		if ( next_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
-			new_event->next_event = NULL;
-			new_event->previous_event = current_event;
-			current_event->next_event = new_event;
-
-#if MX_VIRTUAL_TIMER_DEBUG
-			MX_DEBUG(-2,
-			("%s: Appending event %p at the end of the list.  "
-			"current_event->next_event = %p, "
-			"new_event->previous_event = %p",
-				fname, new_event,
-				current_event->next_event,
-				new_event->previous_event));
-
-			mx_show_event_list( fname, event_list );
-#endif
-
-			return MX_SUCCESSFUL_RESULT;
-		}
-
-		/* Otherwise, we must keep going. */
-
-		current_event = next_event;
-	}
-
-#if defined(OS_HPUX) && defined(__hppa)
-	return MX_SUCCESSFUL_RESULT;
-#endif
-}
+	/* Otherwise, make room for it at the end of the heap. */
 
-static mx_status_type
-mx_get_next_vtimer_event( MX_MASTER_TIMER_EVENT_LIST *event_list,
-			MX_VIRTUAL_TIMER *vtimer,
-			MX_MASTER_TIMER_EVENT *current_vtimer_event,
-			MX_MASTER_TIMER_EVENT **next_vtimer_event )
-{
-	static const char fname[] = "mx_get_next_vtimer_event()";
+	if ( event_list->num_timer_events >= event_list->max_timer_events ) {
 
-	MX_MASTER_TIMER_EVENT *current_event;
+		new_max_timer_events = event_list->max_timer_events
+					+ MXP_VTIMER_HEAP_BLOCK_SIZE
+					+ event_list->max_timer_events / 2;
 
-#if MX_VIRTUAL_TIMER_DEBUG
-	MX_DEBUG(-2,("%s invoked for event list = %p", fname, event_list));
-	MX_DEBUG(-2,("%s: vtimer = %p, current_vtimer_event = %p",
-		fname, vtimer, current_vtimer_event));
-#endif
+		new_heap = (MX_MASTER_TIMER_EVENT **)
+			realloc( event_list->timer_event_heap,
+			    new_max_timer_events * sizeof(MX_MASTER_TIMER_EVENT *));
 
-	if ( vtimer == (MX_VIRTUAL_TIMER *) NULL ) {
-		return mx_error( MXE_NULL_ARGUMENT, fname,
-		"The MX_VIRTUAL_TIMER pointer passed was NULL." );
-	}
-
-	if ( next_vtimer_event == (MX_MASTER_TIMER_EVENT **) NULL ) {
-		return mx_error( MXE_NULL_ARGUMENT, fname,
-		"The next_vtimer_event pointer passed was NULL." );
-	}
-
-	if ( current_vtimer_event != (MX_MASTER_TIMER_EVENT *) NULL ) {
-		current_event = current_vtimer_event->next_event;
-	} else {
-		/* Specify the first event in the event list. */
-
-		if ( event_list == (MX_MASTER_TIMER_EVENT_LIST *) NULL ) {
-			return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
-			"The event_list and the current_vtimer_event pointers "
-			"passed to this function cannot _both_ be NULL." );
+		if ( new_heap == (MX_MASTER_TIMER_EVENT **) NULL ) {
+			return mx_error( MXE_OUT_OF_MEMORY, fname,
+			"Ran out of memory trying to increase the size of "
+			"the timer event heap to %lu events.",
+				new_max_timer_events );
 		}
 
-		current_event = event_list->timer_event_list;
-
-		if ( current_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
-			/* This event list does not have any events right now.*/
-
-			*next_vtimer_event = NULL;
-
-#if MX_VIRTUAL_TIMER_DEBUG
-			MX_DEBUG(-2,
-			("%s: No events in this event list.", fname));
-#endif
-
-			return MX_SUCCESSFUL_RESULT;
-		}
+		event_list->timer_event_heap = new_heap;
+		event_list->max_timer_events = new_max_timer_events;
 	}
 
-	for (;;) {
+	mx_place_vtimer_event( event_list, new_event,
+				event_list->num_timer_events );
 
-		if ( current_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
-			/* This event list has no more events in it. */
+	event_list->num_timer_events++;
 
-			*next_vtimer_event = NULL;
+	mx_sift_vtimer_event_up( event_list, new_event->heap_index );
 
 #if MX_VIRTUAL_TIMER_DEBUG
-			MX_DEBUG(-2,
-			("%s: No more events in this event list.", fname));
-#endif
-
-			return MX_SUCCESSFUL_RESULT;
-		}
-
-#if MX_VIRTUAL_TIMER_DEBUG
-		MX_DEBUG(-2,
-		("%s: current_event = %p, current_event->vtimer = %p",
-			fname, current_event, current_event->vtimer));
-#endif
-
-		if ( current_event->vtimer == vtimer ) {
-			/* We have a match, so return this event. */
-
-			*next_vtimer_event = current_event;
-
-#if MX_VIRTUAL_TIMER_DEBUG
-			MX_DEBUG(-2,("%s: FOUND ---> next_vtimer_event = %p",
-				fname, *next_vtimer_event));
+	mx_show_event_list( fname, event_list );
 #endif
 
-			return MX_SUCCESSFUL_RESULT;
-		}
-
-		current_event = current_event->next_event;
-	}
-
-#if defined(OS_HPUX) && defined(__hppa)
 	return MX_SUCCESSFUL_RESULT;
-#endif
 }
 
 static mx_status_type
@@ -459,7 +407,8 @@ mx_delete_vtimer_event( MX_MASTER_TIMER_EVENT_LIST *event_list,
 {
 	static const char fname[] = "mx_delete_vtimer_event()";
 
-	MX_MASTER_TIMER_EVENT *previous_event, *next_event;
+	MX_MASTER_TIMER_EVENT *last_event;
+	unsigned long heap_index;
 
 #if MX_VIRTUAL_TIMER_DEBUG
 	MX_DEBUG(-2,("%s invoked for event list %p and event %p",
@@ -471,52 +420,44 @@ mx_delete_vtimer_event( MX_MASTER_TIMER_EVENT_LIST *event_list,
 		"The MX_MASTER_TIMER_EVENT pointer passed was NULL." );
 	}
 
-	previous_event = current_event->previous_event;
+	heap_index = current_event->heap_index;
 
-	next_event = current_event->next_event;
+	if ( heap_index == MXP_VTIMER_NOT_SCHEDULED ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
 
-#if MX_VIRTUAL_TIMER_DEBUG
-	MX_DEBUG(-2,("%s: previous_event = %p, next_event = %p",
-		fname, previous_event, next_event));
-#endif
+	if ( ( heap_index >= event_list->num_timer_events )
+	  || ( event_list->timer_event_heap[heap_index] != current_event ) )
+	{
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"Timer event %p claims to be at position %lu of the "
+		"event heap for event list %p, but it is not there.",
+			current_event, heap_index, event_list );
+	}
 
-	if ( current_event == event_list->timer_event_list ) {
-		event_list->timer_event_list = next_event;
+	current_event->heap_index = MXP_VTIMER_NOT_SCHEDULED;
 
-#if MX_VIRTUAL_TIMER_DEBUG
-		MX_DEBUG(-2,("%s: current_event = %p is at the start of the "
-		"event list.  Set event list start to next event = %p",
-		fname, current_event, event_list->timer_event_list));
-#endif
-	}
+	/* Move the last event in the heap into the hole left by the
+	 * deleted event and then restore the heap ordering.
+	 */
 
-	if ( next_event != (MX_MASTER_TIMER_EVENT *) NULL ) {
-		next_event->previous_event = previous_event;
+	event_list->num_timer_events--;
 
-#if MX_VIRTUAL_TIMER_DEBUG
-		MX_DEBUG(-2,("%s: Set next_event->previous_event to %p",
-			fname, next_event->previous_event));
-#endif
-	}
+	if ( heap_index < event_list->num_timer_events ) {
+		last_event = event_list->timer_event_heap[
+					event_list->num_timer_events ];
 
-	if ( previous_event != (MX_MASTER_TIMER_EVENT *) NULL ) {
-		previous_event->next_event = next_event;
+		mx_place_vtimer_event( event_list, last_event, heap_index );
 
-#if MX_VIRTUAL_TIMER_DEBUG
-		MX_DEBUG(-2,("%s: Set previous_event->next_event to %p",
-			fname, previous_event->next_event));
-#endif
-	}
+		mx_sift_vtimer_event_up( event_list, heap_index );
 
-#if MX_VIRTUAL_TIMER_DEBUG
-	MX_DEBUG(-2,("%s: About to free event %p", fname, current_event));
-#endif
+		mx_sift_vtimer_event_down( event_list,
+					last_event->heap_index );
+	}
 
-	mx_free( current_event );
+	event_list->timer_event_heap[ event_list->num_timer_events ] = NULL;
 
 #if MX_VIRTUAL_TIMER_DEBUG
-	MX_DEBUG(-2,("%s: Finished freeing event", fname));
-
 	mx_show_event_list( fname, event_list );
 #endif
 
@@ -529,78 +470,15 @@ mx_delete_all_vtimer_events( MX_MASTER_TIMER_EVENT_LIST *event_list,
 {
 #if MX_VIRTUAL_TIMER_DEBUG
 	static const char fname[] = "mx_delete_all_vtimer_events()";
-#endif
-
-	MX_MASTER_TIMER_EVENT *current_event, *next_event;
-	unsigned long i;
-	mx_status_type mx_status;
 
-#if MX_VIRTUAL_TIMER_DEBUG
-	MX_DEBUG(-2,("*****************************************************"));
 	MX_DEBUG(-2,("%s invoked for event list %p and vtimer %p",
 		fname, event_list, vtimer));
-
-	mx_show_event_list( fname, event_list );
-#endif
-
-	/* Look for the first event in the linked list for this timer. */
-
-	mx_status = mx_get_next_vtimer_event( event_list, vtimer,
-						NULL, &next_event );
-
-	if ( mx_status.code != MXE_SUCCESS )
-		return mx_status;
-
-	if ( next_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
-		/* There are no outstanding events for this timer,
-		 * so just return.
-		 */
-
-#if MX_VIRTUAL_TIMER_DEBUG
-		MX_DEBUG(-2,
-		("%s: No events to delete for this vtimer.", fname));
 #endif
 
-		return MX_SUCCESSFUL_RESULT;
-	}
-
-	/* Loop through the event list looking for events for this vtimer. */
-
-	i = 0;
-
-	while ( next_event != (MX_MASTER_TIMER_EVENT *) NULL ) {
-
-		current_event = next_event;
+	/* A virtual timer has at most one pending event. */
 
-		/* Find the next event. */
-
-#if MX_VIRTUAL_TIMER_DEBUG
-		MX_DEBUG(-2,("%s: finding next event for event #%lu = %p",
-			fname, i, current_event));
-#endif
-
-		mx_status = mx_get_next_vtimer_event( event_list, vtimer,
-						current_event, &next_event );
-
-		if ( mx_status.code != MXE_SUCCESS )
-			return mx_status;
-
-		/* Delete the current event from the event list. */
-
-#if MX_VIRTUAL_TIMER_DEBUG
-		MX_DEBUG(-2,("%s: deleting event #%lu = %p",
-			fname, i, current_event));
-#endif
-
-		mx_status = mx_delete_vtimer_event( event_list, current_event );
-
-		if ( mx_status.code != MXE_SUCCESS )
-			return mx_status;
-
-		i++;
-	}
-
-	return MX_SUCCESSFUL_RESULT;
+	return mx_delete_vtimer_event( event_list,
+			(MX_MASTER_TIMER_EVENT *) vtimer->private_ptr );
 }
 
 /*--------------------------------------------------------------------------*/
@@ -674,18 +552,20 @@ mx_master_timer_callback_function( MX_INTERVAL_TIMER *itimer, void *args )
 	current_time = mx_high_resolution_time();
 
 	for (;;) {
-		current_event = event_list->timer_event_list;
+		if ( event_list->num_timer_events == 0 ) {
+			/* There are no more events in the event list. */
+
+			break;	/* Exit the for(;;) loop. */
+		}
+
+		/* The event at the top of the heap expires first. */
+
+		current_event = event_list->timer_event_heap[0];
 
 #if MX_VIRTUAL_TIMER_DEBUG_MASTER_CALLBACK
 		MX_DEBUG(-2,("%s: current_event = %p", fname, current_event));
 #endif
 
-		if ( current_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
-			/* We have reached the end of the event list. */
-
-			break;	/* Exit the for(;;) loop. */
-		}
-
 		expiration_time = current_event->expiration_time;
 
 		comparison = mx_compare_high_resolution_times(
@@ -707,10 +587,6 @@ mx_master_timer_callback_function( MX_INTERVAL_TIMER *itimer, void *args )
 			break;	/* Exit the for(;;) loop. */
 		}
 
-		/* If the virtual timer is a periodic timer, then schedule
-		 * the next event.
-		 */
-
 		vtimer = current_event->vtimer;
 
 		if ( vtimer == (MX_VIRTUAL_TIMER *) NULL ) {
@@ -721,6 +597,13 @@ mx_master_timer_callback_function( MX_INTERVAL_TIMER *itimer, void *args )
 			break;	/* Exit the for(;;) loop. */
 		}
 
+		/* If the virtual timer is a periodic timer, then reschedule
+		 * the event for the next period.  Otherwise, we are done
+		 * with this event, so delete it from the event list.  This
+		 * is done before invoking the callback, so that the callback
+		 * is free to restart or stop the virtual timer.
+		 */
+
 		if ( vtimer->timer_type == MXIT_PERIODIC_TIMER ) {
 
 			/* Compute the new expiration time relative to the
@@ -737,10 +620,6 @@ mx_master_timer_callback_function( MX_INTERVAL_TIMER *itimer, void *args )
 						new_expiration_time,
 						MXF_VTIMER_ABSOLUTE_TIME );
 
-			if ( mx_status.code != MXE_SUCCESS ) {
-				break;	/* Exit the for(;;) loop. */
-			}
-
 #if MX_VIRTUAL_TIMER_DEBUG_MASTER_CALLBACK
 			MX_DEBUG(-2,
 		    ("%s: periodic timer %p, new_expiration_time = (%lu,%lu)",
@@ -748,29 +627,21 @@ mx_master_timer_callback_function( MX_INTERVAL_TIMER *itimer, void *args )
 				new_expiration_time.tv_sec,
 				new_expiration_time.tv_nsec));
 #endif
+		} else {
+			mx_status = mx_delete_vtimer_event( event_list,
+							current_event );
 		}
-		
-		/* Invoke the callback function if there is one. */
-
-		vtimer = current_event->vtimer;
-
-		if ( vtimer != (MX_VIRTUAL_TIMER *) NULL ) {
 
-			if ( vtimer->callback_function != NULL ) {
-
-				(vtimer->callback_function)( vtimer,
-							vtimer->callback_args );
-			}
+		if ( mx_status.code != MXE_SUCCESS ) {
+			break;	/* Exit the for(;;) loop. */
 		}
 
-		/* We are done with this event, so delete it
-		 * from the event list.
-		 */
+		/* Invoke the callback function if there is one. */
 
-		mx_status = mx_delete_vtimer_event( event_list, current_event );
+		if ( vtimer->callback_function != NULL ) {
 
-		if ( mx_status.code != MXE_SUCCESS ) {
-			break;	/* Exit the for(;;) loop. */
+			(vtimer->callback_function)( vtimer,
+						vtimer->callback_args );
 		}
 	}
 
@@ -823,7 +694,8 @@ mx_virtual_timer_create_master( MX_INTERVAL_TIMER **master_timer,
 	 */
 
 	event_list->num_timer_events = 0;
-	event_list->timer_event_list = NULL;
+	event_list->max_timer_events = 0;
+	event_list->timer_event_heap = NULL;
 
 	mx_status = mx_mutex_create( &(event_list->mutex) );
 
@@ -854,6 +726,7 @@ mx_virtual_timer_destroy_master( MX_INTERVAL_TIMER *master_timer )
 {
 	static const char fname[] = "mx_virtual_timer_destroy_master()";
 
+	MX_MASTER_TIMER_EVENT_LIST *event_list;
 	mx_status_type mx_status;
 
 	MX_DEBUG( 2,("%s invoked.", fname));
@@ -863,6 +736,8 @@ mx_virtual_timer_destroy_master( MX_INTERVAL_TIMER *master_timer )
 		"The MX_INTERVAL_TIMER pointer passed was NULL." );
 	}
 
+	event_list = (MX_MASTER_TIMER_EVENT_LIST *) master_timer->callback_args;
+
 	mx_status = mx_interval_timer_stop( master_timer, NULL );
 
 	if ( mx_status.code != MXE_SUCCESS )
@@ -870,7 +745,21 @@ mx_virtual_timer_destroy_master( MX_INTERVAL_TIMER *master_timer )
 
 	mx_status = mx_interval_timer_destroy( master_timer );
 
-	return mx_status;
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	/* Any virtual timers that are still using this master timer
+	 * must not be started again after this point.
+	 */
+
+	if ( event_list != (MX_MASTER_TIMER_EVENT_LIST *) NULL ) {
+		(void) mx_mutex_destroy( event_list->mutex );
+
+		mx_free( event_list->timer_event_heap );
+		mx_free( event_list );
+	}
+
+	return MX_SUCCESSFUL_RESULT;
 }
 
 MX_EXPORT mx_status_type
@@ -882,6 +771,8 @@ mx_virtual_timer_create( MX_VIRTUAL_TIMER **vtimer,
 {
 	static const char fname[] = "mx_virtual_timer_create()";
 
+	MX_MASTER_TIMER_EVENT *timer_event;
+
 	MX_DEBUG( 2,("%s invoked.", fname));
 
 	if ( vtimer == (MX_VIRTUAL_TIMER **) NULL ) {
@@ -908,7 +799,27 @@ mx_virtual_timer_create( MX_VIRTUAL_TIMER **vtimer,
 	(*vtimer)->num_overruns = 0;
 	(*vtimer)->callback_function = callback_function;
 	(*vtimer)->callback_args = callback_args;
-	(*vtimer)->private_ptr = NULL;
+
+	/* Each virtual timer has its own timer event structure that is
+	 * reused every time the timer is started.
+	 */
+
+	timer_event = (MX_MASTER_TIMER_EVENT *)
+				malloc( sizeof(MX_MASTER_TIMER_EVENT) );
+
+	if ( timer_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
+		mx_free( *vtimer );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+	"Ran out of memory trying to allocate an MX_MASTER_TIMER_EVENT structure." );
+	}
+
+	timer_event->vtimer = *vtimer;
+	timer_event->expiration_time.tv_sec = 0;
+	timer_event->expiration_time.tv_nsec = 0;
+	timer_event->heap_index = MXP_VTIMER_NOT_SCHEDULED;
+
+	(*vtimer)->private_ptr = timer_event;
 
 	return MX_SUCCESSFUL_RESULT;
 }
@@ -932,6 +843,7 @@ mx_virtual_timer_destroy( MX_VIRTUAL_TIMER *vtimer )
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
+	mx_free( vtimer->private_ptr );
 	mx_free( vtimer );
 
 	return MX_SUCCESSFUL_RESULT;
@@ -973,21 +885,13 @@ mx_virtual_timer_is_busy( MX_VIRTUAL_TIMER *vtimer,
 			master_timer, vtimer );
 	}
 
-	/* See if there are any scheduled events for this timer. */
-
-	mx_status = mx_get_next_vtimer_event( event_list, vtimer,
-						NULL, &next_event );
-
-	if ( mx_status.code != MXE_SUCCESS ) {
-		UNLOCK_EVENT_LIST( event_list );
-		return mx_status;
-	}
-
-	/* If a next_event structure is returned, then the timer is still
-	 * busy.  Otherwise, it is not busy.
+	/* If the timer's event is in the event heap, then the timer is
+	 * still busy.  Otherwise, it is not busy.
 	 */
 
-	if ( next_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
+	next_event = (MX_MASTER_TIMER_EVENT *) vtimer->private_ptr;
+
+	if ( next_event->heap_index == MXP_VTIMER_NOT_SCHEDULED ) {
 		*busy = FALSE;
 	} else {
 		*busy = TRUE;
@@ -1098,16 +1002,9 @@ mx_virtual_timer_start( MX_VIRTUAL_TIMER *vtimer,
 	}
 #endif
 
-	/* Get rid of any old events due to this virtual timer. */
-
-	mx_status = mx_delete_all_vtimer_events( event_list, vtimer );
-
-	if ( mx_status.code != MXE_SUCCESS ) {
-		UNLOCK_EVENT_LIST( event_list );
-		return mx_status;
-	}
-
-	/* Add a list entry for the next virtual timer event. */
+	/* Add a list entry for the next virtual timer event.  If the
+	 * timer was already running, its old event is rescheduled.
+	 */
 
 	mx_status = mx_add_vtimer_event( event_list,
 					vtimer, vtimer->timer_period,
@@ -1133,21 +1030,46 @@ mx_virtual_timer_stop( MX_VIRTUAL_TIMER *vtimer,
 {
 	static const char fname[] = "mx_virtual_timer_stop()";
 
+	MX_INTERVAL_TIMER *master_timer;
 	MX_MASTER_TIMER_EVENT_LIST *event_list;
+	long lock_status;
 	mx_status_type mx_status;
 
+	master_timer = NULL;
 	event_list = NULL;
 
 	mx_status = mx_virtual_timer_get_pointers( vtimer,
-					NULL, &event_list, fname );
+					&master_timer, &event_list, fname );
 
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
 	MX_DEBUG( 2,("%s invoked for vtimer %p.", fname, vtimer));
 
+	if ( seconds_left != (double *) NULL ) {
+		mx_status = mx_virtual_timer_read( vtimer, seconds_left );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
+	/* Get exclusive access to the master timer event list. */
+
+	lock_status = mx_mutex_lock( event_list->mutex );
+
+	if ( lock_status != MXE_SUCCESS ) {
+		/* The mutex is not locked, so just return an error. */
+
+		return mx_error( lock_status, fname,
+			"Unable to lock the mutex for the event list of "
+			"master timer %p used by virtual timer %p",
+			master_timer, vtimer );
+	}
+
 	mx_status = mx_delete_all_vtimer_events( event_list, vtimer );
 
+	UNLOCK_EVENT_LIST( event_list );
+
 	return mx_status;
 }
 
@@ -1189,22 +1111,14 @@ mx_virtual_timer_read( MX_VIRTUAL_TIMER *vtimer,
 			master_timer, vtimer );
 	}
 
-	/* See if there are any scheduled events for this timer. */
-
-	mx_status = mx_get_next_vtimer_event( event_list, vtimer,
-						NULL, &next_event );
-
-	if ( mx_status.code != MXE_SUCCESS ) {
-		UNLOCK_EVENT_LIST( event_list );
-		return mx_status;
-	}
-
-	/* If a next_event structure is returned, then the timer is still
-	 * busy, so we must extract the number of seconds until the next
-	 * expiration time.
+	/* If the timer's event is in the event heap, then the timer is
+	 * still busy, so we must extract the number of seconds until
+	 * the next expiration time.
 	 */
 
-	if ( next_event == (MX_MASTER_TIMER_EVENT *) NULL ) {
+	next_event = (MX_MASTER_TIMER_EVENT *) vtimer->private_ptr;
+
+	if ( next_event->heap_index == MXP_VTIMER_NOT_SCHEDULED ) {
 		*seconds_till_expiration = 0.0;
 	} else {
 		current_time = mx_high_resolution_time();
@@ -99,6 +99,8 @@ mxn_unix_server_create_record_structures( MX_RECORD *record )
 
 	network_server->server_supports_network_handles = TRUE;
 	network_server->network_handles_are_valid = TRUE;
+	network_server->server_supports_bulk_transfer = TRUE;
+	network_server->server_supports_batch_transfer = TRUE;
 
 	network_server->remote_header_length = 0;
 	network_server->last_data_type = 0;
@@ -118,6 +120,8 @@ mxn_unix_server_create_record_structures( MX_RECORD *record )
 
 	network_server->callback_list = NULL;
 
+	network_server->pending_request_list = NULL;
+
 	MX_DEBUG( 2,("%s: MX_WORDSIZE = %d, MX_PROGRAM_MODEL = %#x",
 		fname, MX_WORDSIZE, MX_PROGRAM_MODEL));
 
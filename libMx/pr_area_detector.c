@@ -191,9 +191,10 @@ mxp_area_detector_measure_correction_callback_function(
 		fname, corr->num_unread_frames ));
 #endif
 
-	/* Readout the frames and add them to either sum_array
-	 * or dezinger_frame_array (depending on the value of
-	 * ad->dezinger_correction_frame).
+	/* Readout the frames and add them to either sum_array,
+	 * the dezinger accumulator, or dezinger_frame_array
+	 * (depending on the values of ad->dezinger_correction_frame
+	 * and ad->streaming_dezinger).
 	 */
 
 	sequence_complete = FALSE;
@@ -206,7 +207,7 @@ mxp_area_detector_measure_correction_callback_function(
 		MX_DEBUG(-2,("%s: Reading frame %ld",
 				fname, corr->num_frames_read));
 #endif
-		if ( ad->dezinger_correction_frame ) {
+		if ( corr->dezinger_frame_array != (MX_IMAGE_FRAME **) NULL ) {
 		    dezinger_frame_ptr = 
 			&(corr->dezinger_frame_array[ corr->num_frames_read ]);
 		} else {
@@ -951,6 +952,9 @@ mx_setup_area_detector_process_functions( MX_RECORD *record )
 		case MXLV_AD_DATAFILE_ALLOW_OVERWRITE:
 		case MXLV_AD_DATAFILE_AUTOSELECT_NUMBER:
 		case MXLV_AD_DATAFILE_DIRECTORY:
+		case MXLV_AD_DATAFILE_BYTES_PENDING:
+		case MXLV_AD_DATAFILE_FRAMES_PENDING:
+		case MXLV_AD_DATAFILE_LAST_WRITE_LATENCY:
 		case MXLV_AD_DATAFILE_LOAD_FORMAT:
 		case MXLV_AD_DATAFILE_LOAD_FORMAT_NAME:
 		case MXLV_AD_DATAFILE_NAME:
@@ -958,12 +962,14 @@ mx_setup_area_detector_process_functions( MX_RECORD *record )
 		case MXLV_AD_DATAFILE_PATTERN:
 		case MXLV_AD_DATAFILE_SAVE_FORMAT:
 		case MXLV_AD_DATAFILE_SAVE_FORMAT_NAME:
+		case MXLV_AD_DATAFILE_WRITE_MAX_BYTES:
 		case MXLV_AD_DETECTOR_READOUT_TIME:
 		case MXLV_AD_DISK_SPACE:
 		case MXLV_AD_EXPOSURE_TIME:
 		case MXLV_AD_EXTENDED_STATUS:
 		case MXLV_AD_FILENAME_LOG:
 		case MXLV_AD_FRAME_FILENAME:
+		case MXLV_AD_FRAME_POOL_FLAGS:
 		case MXLV_AD_FRAMESIZE:
 		case MXLV_AD_GET_ROI_FRAME:
 		case MXLV_AD_IMAGE_FORMAT:
@@ -979,6 +985,8 @@ mx_setup_area_detector_process_functions( MX_RECORD *record )
 		case MXLV_AD_MAXIMUM_FRAMESIZE:
 		case MXLV_AD_MOTOR_POSITION:
 		case MXLV_AD_NUM_CORRECTION_MEASUREMENTS:
+		case MXLV_AD_NUM_CORRECTION_THREADS:
+		case MXLV_AD_NUM_DATAFILE_WRITE_THREADS:
 		case MXLV_AD_NUM_EXPOSURES:
 		case MXLV_AD_NUM_SEQUENCE_PARAMETERS:
 		case MXLV_AD_OSCILLATION_MOTOR_NAME:
@@ -1315,6 +1323,18 @@ mx_area_detector_process_function( void *record_ptr,
 			mx_status = mx_area_detector_get_num_exposures(
 								record, NULL );
 			break;
+		case MXLV_AD_NUM_CORRECTION_THREADS:
+			break;
+		case MXLV_AD_DATAFILE_BYTES_PENDING:
+		case MXLV_AD_DATAFILE_FRAMES_PENDING:
+		case MXLV_AD_DATAFILE_LAST_WRITE_LATENCY:
+			mx_status = mx_area_detector_get_datafile_write_status(
+						record, NULL, NULL, NULL );
+			break;
+		case MXLV_AD_DATAFILE_WRITE_MAX_BYTES:
+		case MXLV_AD_FRAME_POOL_FLAGS:
+		case MXLV_AD_NUM_DATAFILE_WRITE_THREADS:
+			break;
 		case MXLV_AD_TRIGGER_MODE:
 			mx_status = mx_area_detector_get_trigger_mode(
 								record, NULL );
@@ -1417,6 +1437,20 @@ mx_area_detector_process_function( void *record_ptr,
 			mx_status = mx_area_detector_correct_frame( record );
 
 			break;
+		case MXLV_AD_NUM_CORRECTION_THREADS:
+			mx_status = mx_area_detector_set_num_correction_threads(
+					record, ad->num_correction_threads );
+			break;
+		case MXLV_AD_DATAFILE_WRITE_MAX_BYTES:
+		case MXLV_AD_NUM_DATAFILE_WRITE_THREADS:
+			mx_status =
+			    mx_area_detector_set_num_datafile_write_threads(
+				record, ad->num_datafile_write_threads );
+			break;
+		case MXLV_AD_FRAME_POOL_FLAGS:
+			mx_status = mx_area_detector_set_frame_pool_flags(
+					record, ad->frame_pool_flags );
+			break;
 		case MXLV_AD_CORRECTION_FLAGS:
 			mx_status = mx_area_detector_set_correction_flags(
 							record,
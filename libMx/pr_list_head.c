@@ -16,6 +16,8 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "mx_util.h"
 #include "mx_driver.h"
@@ -25,6 +27,7 @@
 #include "mx_memory.h"
 #include "mx_bit.h"
 #include "mx_list_head.h"
+#include "mx_metrics.h"
 #include "mx_dynamic_library.h"
 #include "mx_time.h"
 
@@ -54,6 +57,11 @@ mx_setup_list_head_process_functions( MX_RECORD *record )
 		case MXLV_LHD_DEBUG_LEVEL:
 		case MXLV_LHD_DEBUGGER_STARTED:
 		case MXLV_LHD_FIELDDEF:
+		case MXLV_LHD_METRICS_ENABLED:
+		case MXLV_LHD_METRICS_RESET:
+		case MXLV_LHD_METRICS:
+		case MXLV_LHD_METRIC_NAME:
+		case MXLV_LHD_METRIC_VALUES:
 		case MXLV_LHD_NUMBERED_BREAKPOINT_STATUS:
 		case MXLV_LHD_POSIX_TIME:
 		case MXLV_LHD_REPORT:
@@ -86,6 +94,8 @@ mx_list_head_process_function( void *record_ptr,
 	MX_RECORD *record;
 	MX_RECORD_FIELD *record_field;
 	MX_LIST_HEAD *list_head;
+	MX_METRIC *metric;
+	char *metrics_text;
 	mx_status_type mx_status;
 
 	record = (MX_RECORD *) record_ptr;
@@ -119,6 +129,38 @@ mx_list_head_process_function( void *record_ptr,
 		case MXLV_LHD_POSIX_TIME:
 			list_head->posix_time = mx_posix_time();
 			break;
+		case MXLV_LHD_METRICS_ENABLED:
+			list_head->metrics_enabled = mx_metrics_get_enabled();
+			break;
+		case MXLV_LHD_METRICS_RESET:
+		case MXLV_LHD_METRIC_NAME:
+			break;
+		case MXLV_LHD_METRICS:
+			/* The text is regenerated on each read, so the
+			 * length of the field must be updated to match.
+			 */
+
+			mx_status = mx_metrics_format_text( &metrics_text );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				return mx_status;
+
+			mx_free( list_head->metrics );
+
+			list_head->metrics = metrics_text;
+
+			record_field->dimension[0] = strlen( metrics_text ) + 1;
+			break;
+		case MXLV_LHD_METRIC_VALUES:
+			mx_status = mx_metrics_find_by_key(
+					list_head->metric_name, &metric );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				return mx_status;
+
+			mx_status = mx_metrics_get_values( metric,
+						list_head->metric_values );
+			break;
 		default:
 			MX_DEBUG( 1,(
 			    "%s: *** Unknown MX_PROCESS_GET label value = %ld",
@@ -258,6 +300,18 @@ mx_list_head_process_function( void *record_ptr,
 		case MXLV_LHD_CALLBACKS_ENABLED:
 			/* Nothing to do here. */
 			break;
+		case MXLV_LHD_METRICS_ENABLED:
+			mx_metrics_set_enabled( list_head->metrics_enabled );
+			break;
+		case MXLV_LHD_METRICS_RESET:
+			if ( list_head->metrics_reset ) {
+				mx_metrics_reset();
+			}
+
+			list_head->metrics_reset = FALSE;
+			break;
+		case MXLV_LHD_METRIC_NAME:
+			break;
 		default:
 			MX_DEBUG( 1,(
 			    "%s: *** Unknown MX_PROCESS_PUT label value = %ld",
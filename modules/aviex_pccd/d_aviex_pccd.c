@@ -1704,6 +1704,11 @@ mxd_aviex_pccd_delete_record( MX_RECORD *record )
 
 	mx_status = mxd_aviex_pccd_get_pointers( ad, &aviex_pccd, fname );
 
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_status = mx_area_detector_release_resources( record );
+
 	if ( mx_status.code != MXE_SUCCESS )
 		return mx_status;
 
@@ -33,7 +33,7 @@ MX_RECORD_FUNCTION_LIST mxd_epics_ad_record_function_list = {
 	mxd_epics_ad_initialize_driver,
 	mxd_epics_ad_create_record_structures,
 	mxd_epics_ad_finish_record_initialization,
-	NULL,
+	mx_area_detector_delete_record,
 	NULL,
 	mxd_epics_ad_open
 };
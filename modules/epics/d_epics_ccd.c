@@ -32,7 +32,7 @@ MX_RECORD_FUNCTION_LIST mxd_epics_ccd_record_function_list = {
 	mxd_epics_ccd_initialize_driver,
 	mxd_epics_ccd_create_record_structures,
 	mxd_epics_ccd_finish_record_initialization,
-	NULL,
+	mx_area_detector_delete_record,
 	NULL,
 	mxd_epics_ccd_open
 };
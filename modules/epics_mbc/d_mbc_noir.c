@@ -37,7 +37,7 @@ MX_RECORD_FUNCTION_LIST mxd_mbc_noir_record_function_list = {
 	mxd_mbc_noir_initialize_driver,
 	mxd_mbc_noir_create_record_structures,
 	mxd_mbc_noir_finish_record_initialization,
-	NULL,
+	mx_area_detector_delete_record,
 	NULL,
 	mxd_mbc_noir_open
 };
@@ -67,7 +67,7 @@ MX_RECORD_FUNCTION_LIST mxd_radicon_taurus_record_function_list = {
 	mxd_radicon_taurus_initialize_driver,
 	mxd_radicon_taurus_create_record_structures,
 	mx_area_detector_finish_record_initialization,
-	NULL,
+	mx_area_detector_delete_record,
 	NULL,
 	mxd_radicon_taurus_open,
 	NULL,
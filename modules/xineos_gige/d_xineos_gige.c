@@ -52,7 +52,7 @@ MX_RECORD_FUNCTION_LIST mxd_xineos_gige_record_function_list = {
 	mxd_xineos_gige_initialize_driver,
 	mxd_xineos_gige_create_record_structures,
 	mx_area_detector_finish_record_initialization,
-	NULL,
+	mx_area_detector_delete_record,
 	NULL,
 	mxd_xineos_gige_open,
 	NULL,
@@ -112,11 +112,19 @@ int mxsrv_num_event_handlers = sizeof( mxsrv_event_handler_list )
 
 /*--------*/
 
+/* The exit handler uses this to flush and close a buffered MX log file. */
+
+static MX_RECORD *mxsrv_log_record_list = NULL;
+
 static void
 mxsrv_exit_handler( void )
 {
 	mx_info( "*** MX server process exiting. ***" );
 
+	if ( mxsrv_log_record_list != (MX_RECORD *) NULL ) {
+		(void) mx_log_close( mxsrv_log_record_list );
+	}
+
 #if defined(DEBUG_DMALLOC)
 	dmalloc_log_changed( mainloop_mark, 1, 1, 1 );
 #endif
@@ -484,6 +492,8 @@ mxserver_main( int argc, char *argv[] )
 	int install_syslog_handler, syslog_number, syslog_options;
 	int display_stack_traceback, redirect_stderr, destination_unbuffered;
 	int bypass_signal_handlers, poll_all;
+	int event_loop_type, event_loop_timeout;
+	long num_worker_threads;
 	unsigned long network_debug_flags;
 	mx_bool_type enable_remote_breakpoint;
 	mx_bool_type wait_for_debugger, just_in_time_debugging;
@@ -492,6 +502,7 @@ mxserver_main( int argc, char *argv[] )
 	double resource_monitor_interval;
 	double master_timer_period;
 	double vc_poll_callback_interval;
+	long vc_poll_sweep_interval;
 	long delay_microseconds;
 	unsigned long default_data_format;
 	FILE *new_stderr;
@@ -582,16 +593,21 @@ mxserver_main( int argc, char *argv[] )
 	master_timer_period = 0.1;		/* in seconds */
 
 	vc_poll_callback_interval = -1.0;	/* in seconds */
+	vc_poll_sweep_interval = -1;		/* in polls */
 
 	poll_all = FALSE;
 
+	event_loop_type = MXF_SRV_SELECT_EVENT_LOOP;
+
+	num_worker_threads = 0;
+
 #if HAVE_GETOPT
         /* Process command line arguments, if any. */
 
         error_flag = FALSE;
 
         while ((c = getopt(argc, argv,
-		"aAab:BcC:d:De:E:f:Jkl:L:m:M:n:p:P:rsStT:u:v:wxY:Z")) != -1)
+		"aAab:BcC:d:De:E:f:Jkl:L:m:M:n:N:O:p:P:rsStT:u:v:V:wxY:Z")) != -1)
 	{
                 switch (c) {
 		case 'a':
@@ -676,6 +692,29 @@ mxserver_main( int argc, char *argv[] )
 		case 'n':
 			delay_microseconds = atoi( optarg);
 			break;
+		case 'N':
+			num_worker_threads = atol( optarg );
+			break;
+		case 'O':
+			if ( strcmp( optarg, "select" ) == 0 ) {
+				event_loop_type = MXF_SRV_SELECT_EVENT_LOOP;
+			} else
+#if HAVE_EPOLL
+			if ( strcmp( optarg, "epoll" ) == 0 ) {
+				event_loop_type = MXF_SRV_EPOLL_EVENT_LOOP;
+			} else
+#endif
+			{
+				fprintf( stderr,
+	"mxserver: Error: unrecognized event loop type '%s'.  The allowed\n"
+	"  values are select"
+#if HAVE_EPOLL
+	" and epoll"
+#endif
+	".\n", optarg );
+				exit(1);
+			}
+			break;
                 case 'p':
                         server_port = atoi( optarg );
                         break;
@@ -711,6 +750,9 @@ mxserver_main( int argc, char *argv[] )
 		case 'v':
 			vc_poll_callback_interval = atof( optarg );
 			break;
+		case 'V':
+			vc_poll_sweep_interval = atol( optarg );
+			break;
 		case 'w':
 			wait_for_debugger = TRUE;
 			break;
@@ -895,6 +937,9 @@ mxserver_main( int argc, char *argv[] )
 	socket_handler_list.max_sockets = max_sockets;
 	socket_handler_list.num_sockets_in_use = 0;
 	socket_handler_list.handler_array_size = handler_array_size;
+	socket_handler_list.event_loop_type = event_loop_type;
+	socket_handler_list.epoll_fd = -1;
+	socket_handler_list.epoll_registered_fd_array = NULL;
 
 	socket_handler_list.array = (MX_SOCKET_HANDLER **)
 		malloc( handler_array_size * sizeof(MX_SOCKET_HANDLER *) );
@@ -965,6 +1010,10 @@ mxserver_main( int argc, char *argv[] )
 
 	list_head_struct->poll_callback_interval = vc_poll_callback_interval;
 
+	if ( vc_poll_sweep_interval >= 0 ) {
+		list_head_struct->poll_sweep_interval = vc_poll_sweep_interval;
+	}
+
 	/* Save the 'enable_remote_breakpoint' flag in the list head. */
 
 	if ( enable_remote_breakpoint ) {
@@ -1104,6 +1153,8 @@ mxserver_main( int argc, char *argv[] )
 	if ( mx_status.code != MXE_SUCCESS )
 		exit( mx_status.code );
 
+	mxsrv_log_record_list = mx_record_list;
+
 	/* Initialize all the hardware described by the record list. */
 
 	mx_status = mx_initialize_hardware( mx_record_list, init_hw_flags );
@@ -1202,6 +1253,38 @@ mxserver_main( int argc, char *argv[] )
 
 	mxsrv_update_select_fds( &socket_handler_list );
 
+	/* If requested, start the worker threads that handle record
+	 * field requests.  This must be done before the epoll() event
+	 * set is created, since the epoll() set must also watch the
+	 * worker completion pipe.
+	 */
+
+	if ( num_worker_threads > 0 ) {
+		mx_status = mxsrv_worker_pool_initialize( mx_record_list,
+							num_worker_threads );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			exit( mx_status.code );
+
+		mx_info( "Started %ld worker threads.", num_worker_threads );
+	}
+
+#if HAVE_EPOLL
+	/* The epoll() event set is created after the server sockets and
+	 * the callback pipe exist, since it needs to register both.
+	 */
+
+	if ( event_loop_type == MXF_SRV_EPOLL_EVENT_LOOP ) {
+		mx_status = mxsrv_epoll_initialize( mx_record_list,
+						&socket_handler_list );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			exit( mx_status.code );
+
+		mx_info( "Using the epoll() event loop." );
+	}
+#endif
+
 	/* We must have at least one socket in use to act as a server. */
 
 	if ( socket_handler_list.num_sockets_in_use <= 0 ) {
@@ -1221,6 +1304,16 @@ mxserver_main( int argc, char *argv[] )
 		mxsrv_display_resource_usage( TRUE, resource_monitor_interval );
 	}
 
+	/* The epoll() event loop blocks until there is something to do,
+	 * unless resource monitoring needs it to wake up periodically.
+	 */
+
+	if ( monitor_resources && ( resource_monitor_interval > 0.0 ) ) {
+		event_loop_timeout = mx_round( 1000.0 * resource_monitor_interval );
+	} else {
+		event_loop_timeout = -1;
+	}
+
 	/************ Primary event loop *************/
 
 	mx_info("mxserver: Ready to accept client connections.");
@@ -1267,8 +1360,25 @@ mxserver_main( int argc, char *argv[] )
 
 		/* Process incoming MX events. */
 
-		mxsrv_process_sockets_with_select( mx_record_list,
+#if HAVE_EPOLL
+		if ( event_loop_type == MXF_SRV_EPOLL_EVENT_LOOP ) {
+			mxsrv_process_sockets_with_epoll( mx_record_list,
+						&socket_handler_list,
+						event_loop_timeout );
+		} else
+#endif
+		{
+			mxsrv_process_sockets_with_select( mx_record_list,
 						&socket_handler_list );
+		}
+
+		/* Resume listening to clients whose requests have been
+		 * completed by worker threads.
+		 */
+
+		if ( mxsrv_worker_pool_is_active() ) {
+			(void) mxsrv_worker_pool_process_completions();
+		}
 
 		/* Check for callbacks. */
 
@@ -1282,9 +1392,13 @@ mxserver_main( int argc, char *argv[] )
 			if ( ( mx_status.code == MXE_SUCCESS )
 			  && ( num_bytes_available > 0 ) )
 			{
+				mxsrv_worker_pool_begin_exclusive();
+
 				mx_status = mx_process_callbacks(
 					mx_record_list,
 					list_head_struct->callback_pipe );
+
+				mxsrv_worker_pool_end_exclusive();
 			}
 		}
 	}
@@ -65,6 +65,7 @@
 #include "mx_process.h"
 #include "mx_callback.h"
 #include "mx_security.h"
+#include "mx_metrics.h"
 
 #include "ms_mxserver.h"
 
@@ -109,6 +110,10 @@ mxsrv_get_returning_message_type( uint32_t message_type )
 			mx_server_response(MX_NETMSG_GET_ARRAY_BY_HANDLE)},
 {MX_NETMSG_PUT_ARRAY_BY_HANDLE,
 			mx_server_response(MX_NETMSG_PUT_ARRAY_BY_HANDLE)},
+{MX_NETMSG_GET_BULK_BY_HANDLE,
+			mx_server_response(MX_NETMSG_GET_BULK_BY_HANDLE)},
+{MX_NETMSG_GET_ARRAYS,        mx_server_response(MX_NETMSG_GET_ARRAYS)},
+{MX_NETMSG_PUT_ARRAYS,        mx_server_response(MX_NETMSG_PUT_ARRAYS)},
 {MX_NETMSG_GET_FIELD_TYPE,    mx_server_response(MX_NETMSG_GET_FIELD_TYPE)},
 {MX_NETMSG_GET_ATTRIBUTE,     mx_server_response(MX_NETMSG_GET_ATTRIBUTE)},
 {MX_NETMSG_SET_ATTRIBUTE,     mx_server_response(MX_NETMSG_SET_ATTRIBUTE)},
@@ -144,9 +149,34 @@ static char ascii_line_terminators[] = "\r\n";
 
 /*--------------------------------------------------------------------------*/
 
+static mx_status_type
+mxsrv_free_client_socket_handler_exclusive( MX_SOCKET_HANDLER *socket_handler,
+			MX_SOCKET_HANDLER_LIST *socket_handler_list );
+
+/* Freeing a socket handler changes the callback lists of record fields
+ * that worker threads may be using, so it is done only while no worker
+ * threads are running.
+ */
+
 mx_status_type
 mxsrv_free_client_socket_handler( MX_SOCKET_HANDLER *socket_handler,
 			MX_SOCKET_HANDLER_LIST *socket_handler_list )
+{
+	mx_status_type mx_status;
+
+	mxsrv_worker_pool_begin_exclusive();
+
+	mx_status = mxsrv_free_client_socket_handler_exclusive( socket_handler,
+							socket_handler_list );
+
+	mxsrv_worker_pool_end_exclusive();
+
+	return mx_status;
+}
+
+static mx_status_type
+mxsrv_free_client_socket_handler_exclusive( MX_SOCKET_HANDLER *socket_handler,
+			MX_SOCKET_HANDLER_LIST *socket_handler_list )
 {
 	static const char fname[] = "mxsrv_free_client_socket_handler()";
 
@@ -1358,6 +1388,75 @@ mxsrv_mx_client_socket_init( MX_RECORD *record_list,
 
 /*--------------------------------------------------------------------------*/
 
+/* The time taken to handle each type of request is kept in the metrics
+ * registry.  The metric pointers are looked up once and cached here.
+ */
+
+typedef struct {
+	uint32_t message_type;
+	const char *name;
+	MX_METRIC *metric;
+} MXSRV_REQUEST_METRIC;
+
+static MXSRV_REQUEST_METRIC mxsrv_request_metric_table[] = {
+	{ MX_NETMSG_GET_ARRAY_BY_NAME,   "get_array_by_name",   NULL },
+	{ MX_NETMSG_PUT_ARRAY_BY_NAME,   "put_array_by_name",   NULL },
+	{ MX_NETMSG_GET_ARRAY_BY_HANDLE, "get_array_by_handle", NULL },
+	{ MX_NETMSG_PUT_ARRAY_BY_HANDLE, "put_array_by_handle", NULL },
+	{ MX_NETMSG_GET_BULK_BY_HANDLE,  "get_bulk_by_handle",  NULL },
+	{ MX_NETMSG_GET_ARRAYS,          "get_arrays",          NULL },
+	{ MX_NETMSG_PUT_ARRAYS,          "put_arrays",          NULL },
+	{ MX_NETMSG_GET_NETWORK_HANDLE,  "get_network_handle",  NULL },
+	{ MX_NETMSG_GET_FIELD_TYPE,      "get_field_type",      NULL },
+	{ MX_NETMSG_GET_ATTRIBUTE,       "get_attribute",       NULL },
+	{ MX_NETMSG_SET_ATTRIBUTE,       "set_attribute",       NULL },
+	{ MX_NETMSG_SET_CLIENT_INFO,     "set_client_info",     NULL },
+	{ MX_NETMSG_GET_OPTION,          "get_option",          NULL },
+	{ MX_NETMSG_SET_OPTION,          "set_option",          NULL },
+	{ MX_NETMSG_ADD_CALLBACK,        "add_callback",        NULL },
+	{ MX_NETMSG_DELETE_CALLBACK,     "delete_callback",     NULL },
+};
+
+static size_t mxsrv_request_metric_table_length
+	= sizeof( mxsrv_request_metric_table )
+		/ sizeof( mxsrv_request_metric_table[0] );
+
+MX_METRIC *
+mxsrv_request_metric( uint32_t message_type )
+{
+	MXSRV_REQUEST_METRIC *entry;
+	MX_METRIC *metric;
+	char labels[MXU_METRIC_LABELS_LENGTH+1];
+	size_t i;
+	mx_status_type mx_status;
+
+	for ( i = 0; i < mxsrv_request_metric_table_length; i++ ) {
+		entry = &mxsrv_request_metric_table[i];
+
+		if ( entry->message_type != message_type )
+			continue;
+
+		if ( entry->metric != (MX_METRIC *) NULL )
+			return entry->metric;
+
+		snprintf( labels, sizeof(labels), "type=\"%s\"", entry->name );
+
+		mx_status = mx_metrics_find( "mx_server_request_seconds",
+				labels, MXT_METRIC_HISTOGRAM, &metric );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return NULL;
+
+		entry->metric = metric;
+
+		return metric;
+	}
+
+	return NULL;
+}
+
+/*--------------------------------------------------------------------------*/
+
 mx_status_type
 mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 				MX_SOCKET_HANDLER *socket_handler,
@@ -1369,24 +1468,22 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 	uint32_t *header;
 	MX_NETWORK_MESSAGE_BUFFER *received_message;
 
-	int update_next_event_time;
 	int queue_a_message, value_at_message_start;
+	uint64_t metrics_start;
 	char *record_name, *field_name;
 	MX_RECORD *record;
 	MX_RECORD_FIELD *record_field;
 	MX_LIST_HEAD *list_head;
-	MX_HANDLE_TABLE *handle_table;
 	long record_handle, field_handle;
 	MX_SOCKET *client_socket;
-	void *record_ptr;
 
-	char *ptr, *message_ptr, *value_ptr;
+	char *ptr, *message_ptr;
 	uint32_t *uint32_message_body;
 	int saved_errno;
 	int bytes_left, bytes_received, initial_recv_length;
 	uint32_t magic_value, header_length, message_length, total_length;
 	uint32_t message_type, returned_message_type, message_id;
-	mx_status_type mx_status, mx_status2;
+	mx_status_type mx_status;
 
 	char separators[] = MX_RECORD_FIELD_SEPARATORS;
 
@@ -1666,6 +1763,18 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 			strlcpy( message_type_string, "PUT_ARRAY_BY_HANDLE",
 						sizeof(message_type_string) );
 			break;
+		case MX_NETMSG_GET_BULK_BY_HANDLE:
+			strlcpy( message_type_string, "GET_BULK_BY_HANDLE",
+						sizeof(message_type_string) );
+			break;
+		case MX_NETMSG_GET_ARRAYS:
+			strlcpy( message_type_string, "GET_ARRAYS",
+						sizeof(message_type_string) );
+			break;
+		case MX_NETMSG_PUT_ARRAYS:
+			strlcpy( message_type_string, "PUT_ARRAYS",
+						sizeof(message_type_string) );
+			break;
 		case MX_NETMSG_GET_NETWORK_HANDLE:
 			strlcpy( message_type_string, "GET_NETWORK_HANDLE",
 						sizeof(message_type_string) );
@@ -1746,12 +1855,15 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 
 	case MX_NETMSG_GET_ARRAY_BY_HANDLE:
 	case MX_NETMSG_PUT_ARRAY_BY_HANDLE:
+	case MX_NETMSG_GET_BULK_BY_HANDLE:
 	case MX_NETMSG_GET_ATTRIBUTE:
 	case MX_NETMSG_SET_ATTRIBUTE:
 	case MX_NETMSG_ADD_CALLBACK:
 		value_at_message_start = MXS_START_RECORD_FIELD_HANDLE;
 		break;
 
+	case MX_NETMSG_GET_ARRAYS:
+	case MX_NETMSG_PUT_ARRAYS:
 	case MX_NETMSG_SET_CLIENT_INFO:
 	case MX_NETMSG_GET_OPTION:
 	case MX_NETMSG_SET_OPTION:
@@ -1834,15 +1946,6 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 		break;
 
 	case MXS_START_RECORD_FIELD_HANDLE:
-		handle_table = (MX_HANDLE_TABLE *) list_head->handle_table;
-
-		if ( handle_table == (MX_HANDLE_TABLE *) NULL ) {
-			mx_status = mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
-		    "The 'handle_table' pointer for the MX database is NULL." );
-
-			break;	/* Exit the switch() statement. */
-		}
-
 		uint32_message_body = header +
 		  (mx_remote_header_length(socket_handler) / sizeof(uint32_t));
 
@@ -1855,60 +1958,15 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 			fname, record_handle, field_handle));
 #endif
 
-		if ( (record_handle < 0) || (field_handle < 0) ) {
-			mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
-			"Illegal network field handle (%ld,%ld) requested.  "
-			"The two values in a network field handle must both "
-			"be non-negative.", record_handle, field_handle );
-
-			break;	/* Exit the switch() statement. */
-		}
-
-		/* First find the record pointer. */
-
-		mx_status = mx_get_pointer_from_handle( &record_ptr,
-						handle_table, record_handle );
+		mx_status = mxsrv_get_field_by_handle( record_list,
+						record_handle, field_handle,
+						&record, &record_field );
 
 		if ( mx_status.code != MXE_SUCCESS ) {
 
 			break;	/* Exit the switch() statement. */
 		}
 
-		record = (MX_RECORD *) record_ptr;
-
-		if ( record == (MX_RECORD *) NULL ) {
-			mx_status = mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
-			"The MX_RECORD pointer returned for network field "
-			"(%ld,%ld) is NULL.", record_handle, field_handle );
-
-			break;	/* Exit the switch() statement. */
-		}
-
-		/* Then find the field pointer. */
-
-		if ( field_handle >= record->num_record_fields ) {
-			mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
-			"The requested field handle %ld for network field "
-			"(%ld,%ld) is greater than or equal to the "
-			"number of record fields %ld for record '%s'.",
-				field_handle, record_handle, field_handle,
-				record->num_record_fields, record->name );
-
-			break;	/* Exit the switch() statement. */
-		}
-
-		record_field = &(record->record_field_array[ field_handle ]);
-
-		if ( record_field == (MX_RECORD_FIELD *) NULL ) {
-
-			mx_status = mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
-			"The MX_RECORD_FIELD pointer returned for "
-			"network field (%ld,%ld) is NULL.",
-				record_handle, field_handle );
-
-			break;	/* Exit the switch() statement. */
-		}
-
 #if NETWORK_DEBUG_HANDLES
 		MX_DEBUG(-2,
 	("%s: network field handle = (%ld,%ld), record = '%s', field = '%s'",
@@ -1957,41 +2015,71 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 	MX_HRT_START( immediate_measurement );
 #endif
 
-	/* Here we handle messages that are to be dealt with immediately. */
-
-	update_next_event_time = FALSE;
+	/* Requests that read or write a record field may be handed off
+	 * to a worker thread, if the worker pool is running.  The reply
+	 * is then sent by the worker thread.
+	 */
 
 	switch ( message_type ) {
 	case MX_NETMSG_GET_ARRAY_BY_NAME:
 	case MX_NETMSG_GET_ARRAY_BY_HANDLE:
-		mx_status = mxsrv_handle_get_array( record_list, socket_handler,
+	case MX_NETMSG_PUT_ARRAY_BY_NAME:
+	case MX_NETMSG_PUT_ARRAY_BY_HANDLE:
+	case MX_NETMSG_GET_BULK_BY_HANDLE:
+	case MX_NETMSG_GET_ATTRIBUTE:
+	case MX_NETMSG_SET_ATTRIBUTE:
+		if ( mxsrv_worker_pool_is_active() ) {
+			mx_status = mxsrv_worker_pool_submit( record_list,
+						socket_handler,
+						socket_handler_list,
 						record, record_field,
-						received_message );
+						message_type );
 
-		update_next_event_time = TRUE;
+			queue_a_message = TRUE;
+		}
 		break;
-	case MX_NETMSG_PUT_ARRAY_BY_NAME:
-	case MX_NETMSG_PUT_ARRAY_BY_HANDLE:
-		value_ptr  = received_message->u.char_buffer;
+	default:
+		break;
+	}
 
-		value_ptr += header_length;
+	if ( queue_a_message ) {
+		MXW_UNUSED( returned_message_type );
 
-		if ( message_type == MX_NETMSG_PUT_ARRAY_BY_HANDLE ) {
+		return mx_status;
+	}
 
-			value_ptr += ( 2 * sizeof( uint32_t ) );
-		} else {
-			if ( socket_handler->remote_mx_version < 1005005L ) {
-				value_ptr += 49;
-			} else {
-				value_ptr += MXU_RECORD_FIELD_NAME_LENGTH;
-			}
-		}
+	/* Here we handle messages that are to be dealt with immediately. */
 
-		mx_status = mxsrv_handle_put_array( record_list, socket_handler,
+	metrics_start = mx_metrics_start();
+
+	switch ( message_type ) {
+	case MX_NETMSG_GET_ARRAY_BY_NAME:
+	case MX_NETMSG_GET_ARRAY_BY_HANDLE:
+	case MX_NETMSG_PUT_ARRAY_BY_NAME:
+	case MX_NETMSG_PUT_ARRAY_BY_HANDLE:
+	case MX_NETMSG_GET_BULK_BY_HANDLE:
+	case MX_NETMSG_GET_ATTRIBUTE:
+	case MX_NETMSG_SET_ATTRIBUTE:
+		mx_status = mxsrv_handle_record_field_request( record_list,
+						socket_handler,
 						record, record_field,
-						received_message, value_ptr );
+						message_type );
+		break;
+	case MX_NETMSG_GET_ARRAYS:
+	case MX_NETMSG_PUT_ARRAYS:
+		/* The fields in a batch may belong to any number of
+		 * records, so the batch is run by the main thread
+		 * while no worker threads are running.
+		 */
 
-		update_next_event_time = TRUE;
+		mxsrv_worker_pool_begin_exclusive();
+
+		mx_status = mxsrv_handle_transfer_arrays( record_list,
+						socket_handler,
+						received_message,
+						message_type );
+
+		mxsrv_worker_pool_end_exclusive();
 		break;
 	case MX_NETMSG_GET_NETWORK_HANDLE:
 		mx_status = mxsrv_handle_get_network_handle( record_list,
@@ -2003,18 +2091,6 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 						socket_handler, client_socket,
 						record_field, received_message);
 		break;
-	case MX_NETMSG_GET_ATTRIBUTE:
-		mx_status = mxsrv_handle_get_attribute( record_list,
-						socket_handler,
-						record, record_field,
-						received_message );
-		break;
-	case MX_NETMSG_SET_ATTRIBUTE:
-		mx_status = mxsrv_handle_set_attribute( record_list,
-						socket_handler,
-						record, record_field,
-						received_message );
-		break;
 	case MX_NETMSG_SET_CLIENT_INFO:
 		mx_status = mxsrv_handle_set_client_info( record_list,
 						socket_handler,
@@ -2031,15 +2107,23 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 						received_message );
 		break;
 	case MX_NETMSG_ADD_CALLBACK:
+		mxsrv_worker_pool_begin_exclusive();
+
 		mx_status = mxsrv_handle_add_callback( record_list,
 						socket_handler,
 						record, record_field,
 						received_message );
+
+		mxsrv_worker_pool_end_exclusive();
 		break;
 	case MX_NETMSG_DELETE_CALLBACK:
+		mxsrv_worker_pool_begin_exclusive();
+
 		mx_status = mxsrv_handle_delete_callback( record_list,
 						socket_handler,
 						received_message );
+
+		mxsrv_worker_pool_end_exclusive();
 		break;
 	default:
 		mx_status = mx_error( MXE_NOT_YET_IMPLEMENTED, fname,
@@ -2056,6 +2140,11 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 		break;
 	}
 
+	if ( metrics_start != 0 ) {
+		mx_metrics_stop( mxsrv_request_metric( message_type ),
+					metrics_start );
+	}
+
 #if NETWORK_DEBUG_VERBOSE
 	MX_DEBUG(-2,("socket_handler->synchronous_socket = %p",
 				socket_handler->synchronous_socket));
@@ -2093,6 +2182,107 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 	}
 #endif
 
+#if NETWORK_DEBUG_VERBOSE
+	MX_DEBUG(-2,("%s exiting.", fname));
+	MX_DEBUG(-2,
+	  ("^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^"));
+#endif
+	MXW_UNUSED( queue_a_message );
+	MXW_UNUSED( returned_message_type );
+
+	return mx_status;
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* mxsrv_handle_record_field_request() carries out the message types that
+ * read or write a record field.  It is called either directly by
+ * mxsrv_mx_client_socket_process_event() or by an mxserver worker thread.
+ * In both cases, the message being handled is the one currently in the
+ * socket handler's message buffer.
+ */
+
+mx_status_type
+mxsrv_handle_record_field_request( MX_RECORD *record_list,
+				MX_SOCKET_HANDLER *socket_handler,
+				MX_RECORD *record,
+				MX_RECORD_FIELD *record_field,
+				uint32_t message_type )
+{
+	static const char fname[] = "mxsrv_handle_record_field_request()";
+
+	MX_NETWORK_MESSAGE_BUFFER *received_message;
+	uint32_t *header;
+	uint32_t header_length;
+	char *value_ptr;
+	mx_bool_type update_next_event_time;
+	mx_status_type mx_status, mx_status2;
+
+	received_message = socket_handler->message_buffer;
+
+	header = received_message->u.uint32_buffer;
+
+	header_length = mx_ntohl( header[ MX_NETWORK_HEADER_LENGTH ] );
+
+	update_next_event_time = FALSE;
+
+	switch ( message_type ) {
+	case MX_NETMSG_GET_ARRAY_BY_NAME:
+	case MX_NETMSG_GET_ARRAY_BY_HANDLE:
+		mx_status = mxsrv_handle_get_array( record_list, socket_handler,
+						record, record_field,
+						received_message );
+
+		update_next_event_time = TRUE;
+		break;
+	case MX_NETMSG_GET_BULK_BY_HANDLE:
+		mx_status = mxsrv_handle_get_bulk( record_list, socket_handler,
+						record, record_field,
+						received_message );
+
+		update_next_event_time = TRUE;
+		break;
+	case MX_NETMSG_PUT_ARRAY_BY_NAME:
+	case MX_NETMSG_PUT_ARRAY_BY_HANDLE:
+		value_ptr  = received_message->u.char_buffer;
+
+		value_ptr += header_length;
+
+		if ( message_type == MX_NETMSG_PUT_ARRAY_BY_HANDLE ) {
+
+			value_ptr += ( 2 * sizeof( uint32_t ) );
+		} else {
+			if ( socket_handler->remote_mx_version < 1005005L ) {
+				value_ptr += 49;
+			} else {
+				value_ptr += MXU_RECORD_FIELD_NAME_LENGTH;
+			}
+		}
+
+		mx_status = mxsrv_handle_put_array( record_list, socket_handler,
+						record, record_field,
+						received_message, value_ptr );
+
+		update_next_event_time = TRUE;
+		break;
+	case MX_NETMSG_GET_ATTRIBUTE:
+		mx_status = mxsrv_handle_get_attribute( record_list,
+						socket_handler,
+						record, record_field,
+						received_message );
+		break;
+	case MX_NETMSG_SET_ATTRIBUTE:
+		mx_status = mxsrv_handle_set_attribute( record_list,
+						socket_handler,
+						record, record_field,
+						received_message );
+		break;
+	default:
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"MX message type %#lx does not refer to a record field.",
+			(unsigned long) message_type );
+	}
+
 	/* If an event time manager is in use, compute the time
 	 * of the next allowed event.
 	 */
@@ -2118,14 +2308,6 @@ mxsrv_mx_client_socket_process_event( MX_RECORD *record_list,
 			return mx_status2;
 	}
 
-#if NETWORK_DEBUG_VERBOSE
-	MX_DEBUG(-2,("%s exiting.", fname));
-	MX_DEBUG(-2,
-	  ("^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^"));
-#endif
-	MXW_UNUSED( queue_a_message );
-	MXW_UNUSED( returned_message_type );
-
 	return mx_status;
 }
 
@@ -2405,56 +2587,214 @@ mxsrv_handle_get_array( MX_RECORD *record_list,
 
 /*--------------------------------------------------------------------------*/
 
+/* mxsrv_handle_get_bulk() returns the raw contents of a 1-dimensional
+ * byte array field such as an area detector's image frame.  The array
+ * is sent directly from the record's own memory, so it is never copied
+ * into the socket handler's message buffer.
+ */
+
 mx_status_type
-mxsrv_send_field_value_to_client( 
+mxsrv_handle_get_bulk( MX_RECORD *record_list,
 			MX_SOCKET_HANDLER *socket_handler,
 			MX_RECORD *record,
 			MX_RECORD_FIELD *record_field,
-			MX_NETWORK_MESSAGE_BUFFER *network_message,
-			uint32_t message_type_for_client,
-			uint32_t message_id_for_client )
+			MX_NETWORK_MESSAGE_BUFFER *network_message )
 {
-	static const char fname[] = "mxsrv_send_field_value_to_client()";
-
-	char location[ sizeof(fname) + 40 ];
-	uint32_t *send_buffer_header;
-	char *send_buffer_message;
-	long send_buffer_header_length, send_buffer_message_length;
-	long send_buffer_message_actual_length;
-	size_t num_network_bytes;
+	static const char fname[] = "mxsrv_handle_get_bulk()";
 
-	MX_SOCKET *mx_socket;
-	void *pointer_to_value;
-	int array_is_dynamically_allocated;
-	unsigned long data_format;
-	mx_status_type ( *token_constructor )
-		(void *, char *, size_t, MX_RECORD *, MX_RECORD_FIELD *);
+	uint32_t *header;
+	uint32_t receive_buffer_message_id = 0;
+	void *pointer_to_value = NULL;
+	size_t num_bytes = 0;
 	mx_status_type mx_status;
 
-#if 0
-	if ( record_field->datatype == MXFT_RECORD ) {
-		mx_breakpoint();
-	}
+#if NETWORK_DEBUG_TIMING
+	MX_HRT_TIMING measurement;
+
+	MX_HRT_START( measurement );
 #endif
 
+	if ( socket_handler == (MX_SOCKET_HANDLER *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"the MX_SOCKET_HANDLER pointer passed was NULL." );
+	}
+
 	mx_status = MX_SUCCESSFUL_RESULT;
 
-	MX_DEBUG( 2,("%s: socket_handler = %p, network_message = %p",
-			fname, socket_handler, network_message ));
+	do {
+		if ( record == (MX_RECORD *) NULL ) {
+			mx_status = mx_error( MXE_NULL_ARGUMENT, fname,
+			"The MX_RECORD pointer passed was NULL." );
 
-	if ( socket_handler == (MX_SOCKET_HANDLER *) NULL ) {
-		return mx_error( MXE_NULL_ARGUMENT, fname,
-		"The MX_SOCKET_HANDLER pointer passed was NULL." );
+			break;		/* Exit the do...while(0) loop. */
+		}
+		if ( record_field == (MX_RECORD_FIELD *) NULL ) {
+			mx_status = mx_error( MXE_NULL_ARGUMENT, fname,
+			"The MX_RECORD_FIELD pointer passed was NULL." );
+
+			break;		/* Exit the do...while(0) loop. */
+		}
+		if ( network_message == (MX_NETWORK_MESSAGE_BUFFER *) NULL ) {
+			mx_status = mx_error( MXE_NULL_ARGUMENT, fname,
+		    "The MX_NETWORK_MESSAGE_BUFFER pointer passed was NULL." );
+
+			break;		/* Exit the do...while(0) loop. */
+		}
+
+		header = network_message->u.uint32_buffer;
+
+		if ( mx_client_supports_message_ids(socket_handler) ) {
+			receive_buffer_message_id =
+				mx_ntohl( header[ MX_NETWORK_MESSAGE_ID ] );
+		}
+
+		if ( record_field->flags & MXFF_NO_ACCESS ) {
+			mx_status = mx_error( MXE_PERMISSION_DENIED, fname,
+			"MX record field '%s.%s' can not be accessed by "
+			"an MX client program.",
+				record->name, record_field->name );
+
+			break;		/* Exit the do...while(0) loop. */
+		}
+
+		switch( record_field->datatype ) {
+		case MXFT_CHAR:
+		case MXFT_UCHAR:
+			break;
+		default:
+			mx_status = mx_error( MXE_UNSUPPORTED, fname,
+			"Bulk transfers are only supported for byte arrays, "
+			"but record field '%s.%s' has datatype %ld.",
+				record->name, record_field->name,
+				record_field->datatype );
+			break;
+		}
+
+		if ( mx_status.code != MXE_SUCCESS )
+			break;		/* Exit the do...while(0) loop. */
+
+		if ( record_field->num_dimensions != 1 ) {
+			mx_status = mx_error( MXE_UNSUPPORTED, fname,
+			"Bulk transfers are only supported for 1-dimensional "
+			"arrays, but record field '%s.%s' has %ld dimensions.",
+				record->name, record_field->name,
+				record_field->num_dimensions );
+
+			break;		/* Exit the do...while(0) loop. */
+		}
+
+		/* Get the data from the hardware. */
+
+		mx_status = mx_process_record_field( record, record_field,
+							MX_PROCESS_GET, NULL );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			break;		/* Exit the do...while(0) loop. */
+
+		/* The dimension of the array may have been changed
+		 * by the process function, so we look at it only now.
+		 */
+
+		pointer_to_value = mx_get_field_value_pointer( record_field );
+
+		if ( record_field->dimension[0] > 0 ) {
+			num_bytes = (size_t) record_field->dimension[0];
+		}
+
+		if ( (pointer_to_value == NULL) && (num_bytes > 0) ) {
+			mx_status = mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+			"The value pointer for record field '%s.%s' is NULL.",
+				record->name, record_field->name );
+
+			break;		/* Exit the do...while(0) loop. */
+		}
+	} while (0);
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mx_status = mx_network_socket_send_error_message(
+					socket_handler->synchronous_socket,
+					receive_buffer_message_id,
+					socket_handler->remote_header_length,
+					socket_handler->network_debug_flags,
+					MX_NETMSG_UNEXPECTED_ERROR,
+					mx_status );
+		return mx_status;
 	}
-	if ( network_message == (MX_NETWORK_MESSAGE_BUFFER *) NULL ) {
-		return mx_error( MXE_NULL_ARGUMENT, fname,
-		"The MX_NETWORK_MESSAGE_BUFFER pointer passed was NULL." );
+
+	/* Construct the response header.  The message length is
+	 * filled in by mx_network_socket_send_bulk_message().
+	 */
+
+	header = network_message->u.uint32_buffer;
+
+	header[ MX_NETWORK_MAGIC ] = mx_htonl( MX_NETWORK_MAGIC_VALUE );
+
+	header[ MX_NETWORK_HEADER_LENGTH ] =
+			mx_htonl( mx_remote_header_length(socket_handler) );
+
+	header[ MX_NETWORK_MESSAGE_TYPE ] =
+		mx_htonl( mx_server_response(MX_NETMSG_GET_BULK_BY_HANDLE) );
+
+	header[ MX_NETWORK_STATUS_CODE ] = mx_htonl( MXE_SUCCESS );
+
+	if ( mx_client_supports_message_ids(socket_handler) ) {
+
+		header[ MX_NETWORK_DATA_TYPE ]
+				= mx_htonl( record_field->datatype );
+
+		header[ MX_NETWORK_MESSAGE_ID ]
+				= mx_htonl( receive_buffer_message_id );
 	}
 
-	mx_socket = socket_handler->synchronous_socket;
+	mx_status = mx_network_socket_send_bulk_message(
+					socket_handler->synchronous_socket,
+					-1.0, network_message,
+					pointer_to_value, num_bytes );
 
-	MX_DEBUG( 1,("***** %s invoked for socket %d *****",
-					fname, (int) mx_socket->socket_fd));
+#if NETWORK_DEBUG_TIMING
+	MX_HRT_END( measurement );
+
+	MX_HRT_RESULTS( measurement, fname,
+		"%lu bytes for '%s.%s'", (unsigned long) num_bytes,
+		record->name, record_field->name );
+#endif
+	MXW_UNUSED( record_list );
+
+	return mx_status;
+}
+
+/*--------------------------------------------------------------------------*/
+
+/* mxsrv_encode_field_value() writes the value of a record field into
+ * a network message buffer starting at byte 'offset', using the data
+ * format of the client connection.  The buffer is made larger if the
+ * value does not fit.  On return, num_bytes_used is the number of bytes
+ * of the buffer that were used.
+ */
+
+mx_status_type
+mxsrv_encode_field_value( MX_SOCKET_HANDLER *socket_handler,
+			MX_RECORD *record,
+			MX_RECORD_FIELD *record_field,
+			MX_NETWORK_MESSAGE_BUFFER *network_message,
+			size_t offset,
+			size_t *num_bytes_used )
+{
+	static const char fname[] = "mxsrv_encode_field_value()";
+
+	char *send_buffer_message;
+	size_t send_buffer_message_length;
+	size_t num_network_bytes;
+	size_t current_length, new_length;
+	void *pointer_to_value;
+	int i, max_attempts;
+	int array_is_dynamically_allocated;
+	unsigned long data_format;
+	mx_status_type ( *token_constructor )
+		(void *, char *, size_t, MX_RECORD *, MX_RECORD_FIELD *);
+	mx_status_type mx_status;
+
+	*num_bytes_used = 0;
 
 	if ( record_field->flags & MXFF_VARARGS ) {
 		array_is_dynamically_allocated = TRUE;
@@ -2466,38 +2806,23 @@ mxsrv_send_field_value_to_client(
 
 	pointer_to_value = mx_get_field_value_pointer( record_field );
 
-	/* Construct the response header. */
-
-	send_buffer_header_length =
-		(long) mx_remote_header_length(socket_handler);
-
-	send_buffer_message_length = (long)
-		( network_message->buffer_length - send_buffer_header_length );
+	send_buffer_message = network_message->u.char_buffer + offset;
 
-	send_buffer_message_actual_length = 0;
-
-	send_buffer_header = network_message->u.uint32_buffer;;
-
-	send_buffer_message  = network_message->u.char_buffer;
-	send_buffer_message += send_buffer_header_length;
+	send_buffer_message_length = network_message->buffer_length - offset;
 
 	/* What data format do we use to send the response? */
 
 	data_format = socket_handler->data_format;
 
-	if ( mx_status.code == MXE_SUCCESS ) {
-
-	    int i, max_attempts;
-
-	    /* Loop until the output buffer is large enough for the data
-	     * that we want to send or until some other error occurs.
-	     */
+	mx_status = MX_SUCCESSFUL_RESULT;
 
-	    max_attempts = 10;
+	/* Loop until the output buffer is large enough for the data
+	 * that we want to send or until some other error occurs.
+	 */
 
-	    for ( i = 0; i < max_attempts; i++ ) {
+	max_attempts = 10;
 
-		size_t current_length, new_length;
+	for ( i = 0; i < max_attempts; i++ ) {
 
 		switch( data_format ) {
 		case MX_NETWORK_DATAFMT_ASCII:
@@ -2531,8 +2856,7 @@ mxsrv_send_field_value_to_client(
 				}
 		        }
 
-			send_buffer_message_actual_length
-				= (long) strlen( send_buffer_message ) + 1;
+			*num_bytes_used = strlen( send_buffer_message ) + 1;
 
 			/* ASCII data transfers do not currently support
 			 * dynamically resizing network buffers, so we return
@@ -2540,11 +2864,7 @@ mxsrv_send_field_value_to_client(
 			 * code.
 			 */
 
-			num_network_bytes = 0;
-
-			if ( mx_status.code == MXE_WOULD_EXCEED_LIMIT )
-				return mx_status;
-			break;
+			return mx_status;
 
 		case MX_NETWORK_DATAFMT_RAW:
 
@@ -2559,9 +2879,6 @@ mxsrv_send_field_value_to_client(
 					send_buffer_message_length,
 					&num_network_bytes,
 				    socket_handler->use_64bit_network_longs );
-
-			send_buffer_message_actual_length
-				= (long) num_network_bytes;
 			break;
 
 		case MX_NETWORK_DATAFMT_XDR:
@@ -2577,11 +2894,8 @@ mxsrv_send_field_value_to_client(
 					send_buffer_message,
 					send_buffer_message_length,
 					&num_network_bytes );
-
-			send_buffer_message_actual_length
-				= (long) num_network_bytes;
 #else
-			mx_status = mx_error( MXE_UNSUPPORTED, fname,
+			return mx_error( MXE_UNSUPPORTED, fname,
 				"XDR network data format is not supported "
 				"on this system." );
 #endif
@@ -2594,12 +2908,15 @@ mxsrv_send_field_value_to_client(
 		}
 
 		/* If we succeeded or if some error other than
-		 * MXE_WOULD_EXCEED_LIMIT occurred, break out
-		 * of the for(i) loop.
+		 * MXE_WOULD_EXCEED_LIMIT occurred, we are done.
 		 */
 
-		if ( mx_status.code != MXE_WOULD_EXCEED_LIMIT ){
-			break;
+		if ( mx_status.code != MXE_WOULD_EXCEED_LIMIT ) {
+			if ( mx_status.code == MXE_SUCCESS ) {
+				*num_bytes_used = num_network_bytes;
+			}
+
+			return mx_status;
 		}
 
 		/* The data does not fit into our existing buffer, so we must
@@ -2622,22 +2939,92 @@ mxsrv_send_field_value_to_client(
 
 		/* Update some values. */
 
-		send_buffer_header = network_message->u.uint32_buffer;;
+		send_buffer_message = network_message->u.char_buffer + offset;
 
-		send_buffer_message = network_message->u.char_buffer
-						+ send_buffer_header_length;
+		send_buffer_message_length =
+				network_message->buffer_length - offset;
+	}
 
-		send_buffer_message_length += num_network_bytes;
-	    }
+	return mx_error( MXE_UNKNOWN_ERROR, fname,
+		"%d attempts to increase the network buffer size "
+		"for record field '%s.%s' failed.  "
+		"You should never see this error.",
+		    max_attempts, record->name, record_field->name );
+}
+
+/*--------------------------------------------------------------------------*/
+
+mx_status_type
+mxsrv_send_field_value_to_client( 
+			MX_SOCKET_HANDLER *socket_handler,
+			MX_RECORD *record,
+			MX_RECORD_FIELD *record_field,
+			MX_NETWORK_MESSAGE_BUFFER *network_message,
+			uint32_t message_type_for_client,
+			uint32_t message_id_for_client )
+{
+	static const char fname[] = "mxsrv_send_field_value_to_client()";
+
+	char location[ sizeof(fname) + 40 ];
+	uint32_t *send_buffer_header;
+	char *send_buffer_message;
+	long send_buffer_header_length, send_buffer_message_length;
+	long send_buffer_message_actual_length;
+	size_t num_network_bytes;
 
-	    if ( i >= max_attempts ) {
-		return mx_error( MXE_UNKNOWN_ERROR, fname,
-			"%d attempts to increase the network buffer size "
-			"for record field '%s.%s' failed.  "
-			"You should never see this error.",
-			    max_attempts, record->name, record_field->name );
-	    }
+	MX_SOCKET *mx_socket;
+	mx_status_type mx_status;
+
+#if 0
+	if ( record_field->datatype == MXFT_RECORD ) {
+		mx_breakpoint();
 	}
+#endif
+
+	mx_status = MX_SUCCESSFUL_RESULT;
+
+	MX_DEBUG( 2,("%s: socket_handler = %p, network_message = %p",
+			fname, socket_handler, network_message ));
+
+	if ( socket_handler == (MX_SOCKET_HANDLER *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_SOCKET_HANDLER pointer passed was NULL." );
+	}
+	if ( network_message == (MX_NETWORK_MESSAGE_BUFFER *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_NETWORK_MESSAGE_BUFFER pointer passed was NULL." );
+	}
+
+	mx_socket = socket_handler->synchronous_socket;
+
+	MX_DEBUG( 1,("***** %s invoked for socket %d *****",
+					fname, (int) mx_socket->socket_fd));
+
+	/* Put the value to be returned to the remote client
+	 * just after the response header.
+	 */
+
+	send_buffer_header_length =
+		(long) mx_remote_header_length(socket_handler);
+
+	mx_status = mxsrv_encode_field_value( socket_handler,
+					record, record_field,
+					network_message,
+					send_buffer_header_length,
+					&num_network_bytes );
+
+	/* ASCII data transfers do not currently support dynamically
+	 * resizing network buffers, so we return instead if we get
+	 * an MXE_WOULD_EXCEED_LIMIT status code.
+	 */
+
+	if ( mx_status.code == MXE_WOULD_EXCEED_LIMIT )
+		return mx_status;
+
+	send_buffer_message_length = (long)
+		( network_message->buffer_length - send_buffer_header_length );
+
+	send_buffer_message_actual_length = (long) num_network_bytes;
 
 	/* Make sure these pointers are up to date. */
 
@@ -2690,7 +3077,7 @@ mxsrv_send_field_value_to_client(
 		long i, length, bytes_left;
 		long max_length = 20;
 
-		switch( data_format ) {
+		switch( socket_handler->data_format ) {
 		case MX_NETWORK_DATAFMT_ASCII:
 			snprintf( text_buffer, sizeof(text_buffer),
 				"%s: sending response = '", fname );
@@ -2726,7 +3113,7 @@ mxsrv_send_field_value_to_client(
 		default:
 			snprintf( text_buffer, sizeof(text_buffer),
 				"%s: sending response in data format %lu.",
-				fname, data_format );
+				fname, socket_handler->data_format );
 			break;
 		}
 
@@ -2800,6 +3187,205 @@ mxsrv_send_field_value_to_client(
 
 /*--------------------------------------------------------------------------*/
 
+/* mxsrv_decode_field_value() stores a value sent by a client into
+ * a record field, using the data format of the client connection.
+ * The value starts at value_buffer, and buffer_left is the number of
+ * bytes of the message that remain after that point.
+ */
+
+mx_status_type
+mxsrv_decode_field_value( MX_SOCKET_HANDLER *socket_handler,
+			MX_RECORD *record,
+			MX_RECORD_FIELD *record_field,
+			char *value_buffer,
+			long buffer_left,
+			size_t *num_value_bytes )
+{
+	static const char fname[] = "mxsrv_decode_field_value()";
+
+	MX_RECORD_FIELD_PARSE_STATUS parse_status;
+	char token_buffer[500];
+	void *pointer_to_value;
+
+#if defined(_WIN64)
+	uint64_t i, xdr_ptr_address, xdr_remainder, xdr_gap_size;
+#else
+	unsigned long i, xdr_ptr_address, xdr_remainder, xdr_gap_size;
+#endif
+	int array_is_dynamically_allocated;
+	mx_status_type ( *token_parser )
+		( void *, char *, MX_RECORD *, MX_RECORD_FIELD *,
+		MX_RECORD_FIELD_PARSE_STATUS * );
+	mx_status_type mx_status;
+
+	char separators[] = MX_RECORD_FIELD_SEPARATORS;
+
+	*num_value_bytes = 0;
+
+	if ( record_field->flags & MXFF_VARARGS ) {
+		array_is_dynamically_allocated = TRUE;
+	} else {
+		array_is_dynamically_allocated = FALSE;
+	}
+
+	pointer_to_value = mx_get_field_value_pointer( record_field );
+
+        mx_status = mx_get_token_parser(
+                        record_field->datatype, &token_parser );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	switch( socket_handler->data_format ) {
+	case MX_NETWORK_DATAFMT_ASCII:
+
+		/* The data were sent in ASCII MX database format. */
+
+#if 0 && NETWORK_DEBUG_VERBOSE
+		MX_DEBUG(-2,("%s: value_string = '%s'",
+					fname, value_string));
+#endif
+
+		mx_initialize_parse_status( &parse_status,
+					value_buffer, separators );
+
+		/* If this is a string field, get the maximum length of
+		 * a string token for use by the parser.
+		 */
+
+		if ( record_field->datatype == MXFT_STRING ) {
+			parse_status.max_string_token_length =
+			 mx_get_max_string_token_length( record_field );
+		} else {
+			parse_status.max_string_token_length = 0L;
+		}
+
+		/* Parse the tokens. */
+
+		if ( (record_field->num_dimensions == 0)
+                  || ((record_field->datatype == MXFT_STRING)
+		   && (record_field->num_dimensions == 1)) ) {
+
+                        mx_status = mx_get_next_record_token(
+				&parse_status,
+                                        token_buffer, sizeof(token_buffer) );
+
+                        if ( mx_status.code == MXE_SUCCESS ) {
+#if NETWORK_DEBUG_VERBOSE
+				MX_DEBUG(-2,
+			    ("%s: calling *token_parser() for '%s.%s'",
+			    fname, record->name, record_field->name));
+#endif
+
+	                        mx_status = ( *token_parser ) (
+					pointer_to_value,
+					token_buffer,
+					record, record_field,
+					&parse_status );
+			}
+                } else {
+
+#if NETWORK_DEBUG_VERBOSE
+			MX_DEBUG(-2,
+		("%s: calling mx_parse_array_description for '%s.%s'",
+			fname, record->name, record_field->name));
+#endif
+			mx_status = mx_parse_array_description(
+                                        pointer_to_value,
+                                        (record_field->num_dimensions - 1),
+                                        record, record_field,
+                                        &parse_status, token_parser );
+                	}
+
+		*num_value_bytes = strlen( value_buffer );
+		break;
+
+	case MX_NETWORK_DATAFMT_RAW:
+		mx_status = mx_copy_network_buffer_to_array(
+				value_buffer,
+				buffer_left,
+				pointer_to_value,
+				array_is_dynamically_allocated,
+				record_field->datatype,
+				record_field->num_dimensions,
+				record_field->dimension,
+				record_field->data_element_size,
+				num_value_bytes,
+			    socket_handler->use_64bit_network_longs );
+		break;
+
+	case MX_NETWORK_DATAFMT_XDR:
+#if HAVE_XDR
+		/* The XDR data pointer 'ptr' must be aligned on a
+		 * 4 byte address boundary for XDR data conversion
+		 * to work correctly on all architectures.  If the
+		 * pointer does not point to an address that is a
+		 * multiple of 4 bytes, we move it to the next address
+		 * that _is_ and fill the bytes inbetween with zeros.
+	 	 */
+
+#if defined(_WIN64)
+		xdr_ptr_address = (uint64_t) value_buffer;
+#else
+		xdr_ptr_address = (unsigned long) value_buffer;
+#endif
+
+		xdr_remainder = xdr_ptr_address % 4;
+
+		if ( xdr_remainder != 0 ) {
+			xdr_gap_size = 4 - xdr_remainder;
+
+			for ( i = 0; i < xdr_gap_size; i++ ) {
+				value_buffer[i] = '\0';
+			}
+
+			value_buffer += xdr_gap_size;
+
+			buffer_left -= xdr_gap_size;
+		}
+
+#if defined(_WIN64)
+		MX_DEBUG( 2,
+		("%s: ptr_address = %#I64x, value_buffer = %p",
+			fname, xdr_ptr_address, value_buffer));
+#else
+		MX_DEBUG( 2,
+		("%s: ptr_address = %#lx, value_buffer = %p",
+			fname, xdr_ptr_address, value_buffer));
+#endif
+
+		/* Now we are ready to do the XDR data conversion. */
+
+		mx_status = mx_xdr_data_transfer(
+				MX_XDR_DECODE,
+				pointer_to_value,
+				array_is_dynamically_allocated,
+				record_field->datatype,
+				record_field->num_dimensions,
+				record_field->dimension,
+				record_field->data_element_size,
+				value_buffer,
+				buffer_left,
+				num_value_bytes );
+#else
+		mx_status = mx_error( MXE_UNSUPPORTED, fname,
+			"XDR network data format is not supported "
+			"on this system." );
+#endif
+		break;
+
+	default:
+		mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+	    "Unrecognized network data format type %lu was requested.",
+	    		socket_handler->data_format );
+		break;
+	}
+
+	return mx_status;
+}
+
+/*--------------------------------------------------------------------------*/
+
 mx_status_type
 mxsrv_handle_put_array( MX_RECORD *record_list,
 			MX_SOCKET_HANDLER *socket_handler,
@@ -2827,24 +3413,9 @@ mxsrv_handle_put_array( MX_RECORD *record_list,
 	size_t num_value_bytes;
 
 	MX_SOCKET *mx_socket;
-	MX_RECORD_FIELD_PARSE_STATUS parse_status;
-	char token_buffer[500];
-	void *pointer_to_value;
 	long message_buffer_used, buffer_left;
-
-#if defined(_WIN64)
-	uint64_t i, xdr_ptr_address, xdr_remainder, xdr_gap_size;
-#else
-	unsigned long i, xdr_ptr_address, xdr_remainder, xdr_gap_size;
-#endif
-	int array_is_dynamically_allocated;
-	mx_status_type ( *token_parser )
-		( void *, char *, MX_RECORD *, MX_RECORD_FIELD *,
-		MX_RECORD_FIELD_PARSE_STATUS * );
 	mx_status_type mx_status;
 
-	char separators[] = MX_RECORD_FIELD_SEPARATORS;
-
 #if NETWORK_DEBUG_TIMING
 	MX_HRT_TIMING measurement;
 
@@ -2942,209 +3513,53 @@ mxsrv_handle_put_array( MX_RECORD *record_list,
 			break;		/* Exit the do...while(0) loop. */
 		}
 
-		/* Get some parameters from the field. */
-
-		if ( record_field->flags & MXFF_VARARGS ) {
-			array_is_dynamically_allocated = TRUE;
-		} else {
-			array_is_dynamically_allocated = FALSE;
-		}
-
 #if NETWORK_DEBUG_DEBUG_FIELD_NAMES
 	        MX_DEBUG(-2,("%s: record_name = '%s'", fname, record->name));
 		MX_DEBUG(-2,("%s: field_name = '%s'", fname,
 						record_field->name));
 #endif
 
-		pointer_to_value = mx_get_field_value_pointer( record_field );
-
-	        mx_status = mx_get_token_parser(
-                        record_field->datatype, &token_parser );
-
-		if ( mx_status.code != MXE_SUCCESS )
-			break;		/* Exit the do...while(0) loop. */
-
-		/* Get a pointer to the start of the value string. */
-
-		receive_buffer_message  = network_message->u.char_buffer;
-		receive_buffer_message += receive_buffer_header_length;
-
-		receive_buffer_message_length = 
-		   mx_ntohl(receive_buffer_header[ MX_NETWORK_MESSAGE_LENGTH ]);
-
-		value_buffer = (char *) value_buffer_ptr;
-
-		message_buffer_used = value_buffer - receive_buffer_message;
-
-		if ( message_buffer_used < 0 ) {
-			mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
-				"The 'value_buffer_ptr' (%p) passed is "
-				"located before the 'receive_buffer_message' "
-				"pointer (%p).  This should not happen.",
-				value_buffer_ptr, receive_buffer_message );
-
-			break;		/* Exit the do...while(0) loop. */
-		}
-
-		buffer_left = ((long) receive_buffer_message_length)
-					- ((long) message_buffer_used);
-
-		if ( buffer_left <= 0 ) {
-			mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
-				"The amount of buffer used (%ld) by the field "
-				"name or handle was greater than the total "
-				"amount of buffer available (%ld).",
-					message_buffer_used,
-					(long) receive_buffer_message_length );
-
-			break;		/* Exit the do...while(0) loop. */
-		}
-
-		switch( socket_handler->data_format ) {
-		case MX_NETWORK_DATAFMT_ASCII:
-
-			/* The data were sent in ASCII MX database format. */
-
-#if 0 && NETWORK_DEBUG_VERBOSE
-			MX_DEBUG(-2,("%s: value_string = '%s'",
-						fname, value_string));
-#endif
-
-			mx_initialize_parse_status( &parse_status,
-						value_buffer, separators );
-
-			/* If this is a string field, get the maximum length of
-			 * a string token for use by the parser.
-			 */
-
-			if ( record_field->datatype == MXFT_STRING ) {
-				parse_status.max_string_token_length =
-				 mx_get_max_string_token_length( record_field );
-			} else {
-				parse_status.max_string_token_length = 0L;
-			}
-
-			/* Parse the tokens. */
-
-			if ( (record_field->num_dimensions == 0)
-	                  || ((record_field->datatype == MXFT_STRING)
-			   && (record_field->num_dimensions == 1)) ) {
-
-	                        mx_status = mx_get_next_record_token(
-					&parse_status,
-                                        token_buffer, sizeof(token_buffer) );
-
-	                        if ( mx_status.code == MXE_SUCCESS ) {
-#if NETWORK_DEBUG_VERBOSE
-					MX_DEBUG(-2,
-				    ("%s: calling *token_parser() for '%s.%s'",
-				    fname, record->name, record_field->name));
-#endif
-
-		                        mx_status = ( *token_parser ) (
-						pointer_to_value,
-						token_buffer,
-						record, record_field,
-						&parse_status );
-				}
-	                } else {
-
-#if NETWORK_DEBUG_VERBOSE
-				MX_DEBUG(-2,
-			("%s: calling mx_parse_array_description for '%s.%s'",
-				fname, record->name, record_field->name));
-#endif
-				mx_status = mx_parse_array_description(
-                                        pointer_to_value,
-                                        (record_field->num_dimensions - 1),
-                                        record, record_field,
-                                        &parse_status, token_parser );
-                	}
-
-			num_value_bytes = strlen( value_buffer );
-			break;
-
-		case MX_NETWORK_DATAFMT_RAW:
-			mx_status = mx_copy_network_buffer_to_array(
-					value_buffer,
-					buffer_left,
-					pointer_to_value,
-					array_is_dynamically_allocated,
-					record_field->datatype,
-					record_field->num_dimensions,
-					record_field->dimension,
-					record_field->data_element_size,
-					&num_value_bytes,
-				    socket_handler->use_64bit_network_longs );
-			break;
-
-		case MX_NETWORK_DATAFMT_XDR:
-#if HAVE_XDR
-			/* The XDR data pointer 'ptr' must be aligned on a
-			 * 4 byte address boundary for XDR data conversion
-			 * to work correctly on all architectures.  If the
-			 * pointer does not point to an address that is a
-			 * multiple of 4 bytes, we move it to the next address
-			 * that _is_ and fill the bytes inbetween with zeros.
-		 	 */
-
-#if defined(_WIN64)
-			xdr_ptr_address = (uint64_t) value_buffer;
-#else
-			xdr_ptr_address = (unsigned long) value_buffer;
-#endif
-
-			xdr_remainder = xdr_ptr_address % 4;
+		/* Get a pointer to the start of the value string. */
 
-			if ( xdr_remainder != 0 ) {
-				xdr_gap_size = 4 - xdr_remainder;
+		receive_buffer_message  = network_message->u.char_buffer;
+		receive_buffer_message += receive_buffer_header_length;
 
-				for ( i = 0; i < xdr_gap_size; i++ ) {
-					value_buffer[i] = '\0';
-				}
+		receive_buffer_message_length = 
+		   mx_ntohl(receive_buffer_header[ MX_NETWORK_MESSAGE_LENGTH ]);
 
-				value_buffer += xdr_gap_size;
+		value_buffer = (char *) value_buffer_ptr;
 
-				buffer_left -= xdr_gap_size;
-			}
+		message_buffer_used = value_buffer - receive_buffer_message;
 
-#if defined(_WIN64)
-			MX_DEBUG( 2,
-			("%s: ptr_address = %#I64x, value_buffer = %p",
-				fname, xdr_ptr_address, value_buffer));
-#else
-			MX_DEBUG( 2,
-			("%s: ptr_address = %#lx, value_buffer = %p",
-				fname, xdr_ptr_address, value_buffer));
-#endif
+		if ( message_buffer_used < 0 ) {
+			mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+				"The 'value_buffer_ptr' (%p) passed is "
+				"located before the 'receive_buffer_message' "
+				"pointer (%p).  This should not happen.",
+				value_buffer_ptr, receive_buffer_message );
 
-			/* Now we are ready to do the XDR data conversion. */
+			break;		/* Exit the do...while(0) loop. */
+		}
 
-			mx_status = mx_xdr_data_transfer(
-					MX_XDR_DECODE,
-					pointer_to_value,
-					array_is_dynamically_allocated,
-					record_field->datatype,
-					record_field->num_dimensions,
-					record_field->dimension,
-					record_field->data_element_size,
-					value_buffer,
-					buffer_left,
-					&num_value_bytes );
-#else
-			mx_status = mx_error( MXE_UNSUPPORTED, fname,
-				"XDR network data format is not supported "
-				"on this system." );
-#endif
-			break;
+		buffer_left = ((long) receive_buffer_message_length)
+					- ((long) message_buffer_used);
 
-		default:
+		if ( buffer_left <= 0 ) {
 			mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
-		    "Unrecognized network data format type %lu was requested.",
-		    		socket_handler->data_format );
-			break;
+				"The amount of buffer used (%ld) by the field "
+				"name or handle was greater than the total "
+				"amount of buffer available (%ld).",
+					message_buffer_used,
+					(long) receive_buffer_message_length );
+
+			break;		/* Exit the do...while(0) loop. */
 		}
 
+		mx_status = mxsrv_decode_field_value( socket_handler,
+					record, record_field,
+					value_buffer, buffer_left,
+					&num_value_bytes );
+
 		if ( mx_status.code != MXE_SUCCESS )
 			break;		/* Exit the do...while(0) loop. */
 
@@ -3299,6 +3714,420 @@ mxsrv_handle_put_array( MX_RECORD *record_list,
 
 /*--------------------------------------------------------------------------*/
 
+/* mxsrv_get_field_by_handle() finds the record and record field that
+ * a network field handle refers to.
+ */
+
+mx_status_type
+mxsrv_get_field_by_handle( MX_RECORD *record_list,
+			long record_handle,
+			long field_handle,
+			MX_RECORD **record,
+			MX_RECORD_FIELD **record_field )
+{
+	static const char fname[] = "mxsrv_get_field_by_handle()";
+
+	MX_LIST_HEAD *list_head;
+	MX_HANDLE_TABLE *handle_table;
+	void *record_ptr;
+	mx_status_type mx_status;
+
+	*record = NULL;
+	*record_field = NULL;
+
+	list_head = mx_get_record_list_head_struct( record_list );
+
+	handle_table = (MX_HANDLE_TABLE *) list_head->handle_table;
+
+	if ( handle_table == (MX_HANDLE_TABLE *) NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"The 'handle_table' pointer for the MX database is NULL." );
+	}
+
+	if ( (record_handle < 0) || (field_handle < 0) ) {
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"Illegal network field handle (%ld,%ld) requested.  "
+		"The two values in a network field handle must both "
+		"be non-negative.", record_handle, field_handle );
+	}
+
+	/* First find the record pointer. */
+
+	mx_status = mx_get_pointer_from_handle( &record_ptr,
+					handle_table, record_handle );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	if ( record_ptr == NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"The MX_RECORD pointer returned for network field "
+		"(%ld,%ld) is NULL.", record_handle, field_handle );
+	}
+
+	*record = (MX_RECORD *) record_ptr;
+
+	/* Then find the field pointer. */
+
+	if ( field_handle >= (*record)->num_record_fields ) {
+		return mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"The requested field handle %ld for network field "
+		"(%ld,%ld) is greater than or equal to the "
+		"number of record fields %ld for record '%s'.",
+			field_handle, record_handle, field_handle,
+			(*record)->num_record_fields, (*record)->name );
+	}
+
+	*record_field = &((*record)->record_field_array[ field_handle ]);
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*--------------------------------------------------------------------------*/
+
+#define MXSRV_ARRAYS_ENTRY_LENGTH	(4 * sizeof(uint32_t))
+
+#define mxsrv_arrays_padded_length(x)	( ((x) + 7) & ~((size_t) 7) )
+
+/* mxsrv_handle_transfer_arrays() handles GET_ARRAYS and PUT_ARRAYS
+ * messages.  The layout of these messages is described in mx_net.h.
+ * The entries are carried out in order and a failure in one of them
+ * is reported in its own entry of the response without stopping the
+ * others.  The response is built in a buffer of its own, since the
+ * request is still being read while the response is being written.
+ */
+
+mx_status_type
+mxsrv_handle_transfer_arrays( MX_RECORD *record_list,
+			MX_SOCKET_HANDLER *socket_handler,
+			MX_NETWORK_MESSAGE_BUFFER *network_message,
+			uint32_t message_type )
+{
+	static const char fname[] = "mxsrv_handle_transfer_arrays()";
+
+	MX_NETWORK_MESSAGE_BUFFER *response;
+	MX_RECORD *record;
+	MX_RECORD_FIELD *record_field;
+	uint32_t *header, *entry;
+	char *request_message, *value;
+	uint32_t header_length, message_length, message_id;
+	uint32_t response_header_length;
+	uint32_t num_entries, value_length, n;
+	size_t request_offset, response_offset;
+	size_t num_value_bytes, padded_length, min_length;
+	long record_handle, field_handle;
+	mx_bool_type truncated;
+	mx_status_type mx_status, entry_status;
+
+	header = network_message->u.uint32_buffer;
+
+	header_length  = mx_ntohl( header[ MX_NETWORK_HEADER_LENGTH ] );
+	message_length = mx_ntohl( header[ MX_NETWORK_MESSAGE_LENGTH ] );
+	message_id     = mx_ntohl( header[ MX_NETWORK_MESSAGE_ID ] );
+
+	request_message = network_message->u.char_buffer + header_length;
+
+	response = NULL;
+
+	if ( message_length < sizeof(uint32_t) ) {
+		mx_status = mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"The message from client socket %d is too short to hold "
+		"the number of entries.",
+			(int) socket_handler->synchronous_socket->socket_fd );
+	} else {
+		num_entries = mx_ntohl( *((uint32_t *) request_message) );
+
+		/* The entry count comes from the client, so make sure
+		 * that the message is long enough to hold that many
+		 * entries before doing anything else with it.
+		 */
+
+		if ( num_entries > MXU_NETWORK_MAX_ARRAYS_ENTRIES ) {
+			mx_status = mx_error( MXE_WOULD_EXCEED_LIMIT, fname,
+			"The %lu entries requested by client socket %d "
+			"exceed the limit of %d entries per message.",
+			    (unsigned long) num_entries,
+			    (int) socket_handler->synchronous_socket->socket_fd,
+			    MXU_NETWORK_MAX_ARRAYS_ENTRIES );
+		} else
+		if ( num_entries > ( (message_length - sizeof(uint32_t))
+					/ MXSRV_ARRAYS_ENTRY_LENGTH ) )
+		{
+			mx_status = mx_error( MXE_NETWORK_IO_ERROR, fname,
+			"The %lu byte message from client socket %d is "
+			"too short to hold the %lu entries that it claims.",
+			    (unsigned long) message_length,
+			    (int) socket_handler->synchronous_socket->socket_fd,
+			    (unsigned long) num_entries );
+		} else {
+			mx_status = mx_allocate_network_buffer( &response,
+				MXU_NETWORK_INITIAL_MESSAGE_BUFFER_LENGTH );
+		}
+	}
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		(void) mx_network_socket_send_error_message(
+					socket_handler->synchronous_socket,
+					message_id,
+					socket_handler->remote_header_length,
+					socket_handler->network_debug_flags,
+					MX_NETMSG_UNEXPECTED_ERROR,
+					mx_status );
+
+		return mx_status;
+	}
+
+	response->data_format = socket_handler->data_format;
+
+	response_header_length = mx_remote_header_length(socket_handler);
+
+	request_offset = sizeof(uint32_t);
+
+	response_offset = response_header_length + sizeof(uint32_t);
+
+	truncated = FALSE;
+
+	for ( n = 0; n < num_entries; n++ ) {
+
+		/* Leave each entry at least as much room for its value
+		 * as a message of its own would have, since ASCII values
+		 * cannot grow the buffer once they have been started.
+		 */
+
+		min_length = response_offset + MXSRV_ARRAYS_ENTRY_LENGTH
+				+ MXU_NETWORK_INITIAL_MESSAGE_BUFFER_LENGTH;
+
+		if ( response->buffer_length < min_length ) {
+			mx_status = mx_reallocate_network_buffer(
+						response, min_length );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				break;
+		}
+
+		record = NULL;
+		record_field = NULL;
+		value = NULL;
+		value_length = 0;
+		num_value_bytes = 0;
+
+		/* Find the record field that this entry refers to. */
+
+		if ( (request_offset + MXSRV_ARRAYS_ENTRY_LENGTH)
+			> message_length )
+		{
+			entry_status = mx_error( MXE_NETWORK_IO_ERROR, fname,
+			"Entry %lu of %lu was missing from the message.",
+				(unsigned long) n, (unsigned long) num_entries );
+
+			truncated = TRUE;
+		} else {
+			entry = (uint32_t *) ( request_message
+						+ request_offset );
+
+			record_handle = (long) mx_ntohl( entry[0] );
+			field_handle  = (long) mx_ntohl( entry[1] );
+			value_length  = mx_ntohl( entry[3] );
+
+			value = request_message + request_offset
+					+ MXSRV_ARRAYS_ENTRY_LENGTH;
+
+			request_offset += MXSRV_ARRAYS_ENTRY_LENGTH
+				+ mxsrv_arrays_padded_length( value_length );
+
+			if ( request_offset > message_length ) {
+				entry_status = mx_error( MXE_NETWORK_IO_ERROR,
+				fname, "The value for entry %lu extends past "
+				"the end of the message.", (unsigned long) n );
+
+				truncated = TRUE;
+			} else {
+				entry_status = mxsrv_get_field_by_handle(
+						record_list,
+						record_handle, field_handle,
+						&record, &record_field );
+			}
+		}
+
+		/* Check the record field's permissions. */
+
+		if ( entry_status.code == MXE_SUCCESS ) {
+			if ( record_field->flags & MXFF_NO_ACCESS ) {
+				entry_status = mx_error( MXE_PERMISSION_DENIED,
+				fname, "MX record field '%s.%s' can not be "
+				"accessed by an MX client program.",
+					record->name, record_field->name );
+			} else
+			if ( ( message_type == MX_NETMSG_PUT_ARRAYS )
+			  && ( record_field->flags & MXFF_READ_ONLY ) )
+			{
+				entry_status = mx_error( MXE_READ_ONLY, fname,
+				"MX record field '%s.%s' is read-only.",
+					record->name, record_field->name );
+			} else
+			if ( ( message_type == MX_NETMSG_PUT_ARRAYS )
+			  && ( socket_handler->data_format
+					== MX_NETWORK_DATAFMT_ASCII )
+			  && ( ( value_length == 0 )
+			    || ( value[value_length - 1] != '\0' ) ) )
+			{
+				entry_status = mx_error( MXE_NETWORK_IO_ERROR,
+				fname, "The ASCII value sent for MX record "
+				"field '%s.%s' is not null terminated.",
+					record->name, record_field->name );
+			}
+		}
+
+		/* Carry out the transfer. */
+
+		if ( entry_status.code == MXE_SUCCESS ) {
+			if ( message_type == MX_NETMSG_GET_ARRAYS ) {
+				entry_status = mx_process_record_field(
+						record, record_field,
+						MX_PROCESS_GET, NULL );
+
+				if ( entry_status.code == MXE_SUCCESS ) {
+					entry_status = mxsrv_encode_field_value(
+						socket_handler,
+						record, record_field,
+						response,
+						response_offset
+						    + MXSRV_ARRAYS_ENTRY_LENGTH,
+						&num_value_bytes );
+				}
+			} else {
+				entry_status = mxsrv_decode_field_value(
+						socket_handler,
+						record, record_field,
+						value, (long) value_length,
+						&num_value_bytes );
+
+				if ( entry_status.code == MXE_SUCCESS ) {
+					entry_status = mx_process_record_field(
+						record, record_field,
+						MX_PROCESS_PUT, NULL );
+				}
+
+				num_value_bytes = 0;
+			}
+
+			if ( record->event_time_manager != NULL ) {
+				(void) mx_update_next_allowed_event_time(
+						record, record_field );
+			}
+		}
+
+		/* If the entry failed, send back the error message instead. */
+
+		if ( entry_status.code != MXE_SUCCESS ) {
+			num_value_bytes = strlen( entry_status.message ) + 1;
+
+			min_length = response_offset + MXSRV_ARRAYS_ENTRY_LENGTH
+					+ num_value_bytes;
+
+			if ( response->buffer_length < min_length ) {
+				mx_status = mx_reallocate_network_buffer(
+						response, min_length );
+
+				if ( mx_status.code != MXE_SUCCESS )
+					break;
+			}
+
+			strlcpy( response->u.char_buffer + response_offset
+					+ MXSRV_ARRAYS_ENTRY_LENGTH,
+				entry_status.message, num_value_bytes );
+		}
+
+		padded_length = mxsrv_arrays_padded_length( num_value_bytes );
+
+		min_length = response_offset + MXSRV_ARRAYS_ENTRY_LENGTH
+				+ padded_length;
+
+		if ( response->buffer_length < min_length ) {
+			mx_status = mx_reallocate_network_buffer(
+						response, min_length );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				break;
+		}
+
+		memset( response->u.char_buffer + response_offset
+				+ MXSRV_ARRAYS_ENTRY_LENGTH + num_value_bytes,
+			0, padded_length - num_value_bytes );
+
+		entry = (uint32_t *) ( response->u.char_buffer
+						+ response_offset );
+
+		entry[0] = mx_htonl( entry_status.code );
+		entry[1] = mx_htonl( (record_field == NULL)
+					? 0 : record_field->datatype );
+		entry[2] = mx_htonl( num_value_bytes );
+		entry[3] = 0;
+
+		response_offset += MXSRV_ARRAYS_ENTRY_LENGTH + padded_length;
+
+		/* Nothing after a truncated entry can be found, so the
+		 * response ends with the error for that entry.
+		 */
+
+		if ( truncated ) {
+			num_entries = n + 1;
+			break;
+		}
+	}
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mx_free_network_buffer( response );
+
+		(void) mx_network_socket_send_error_message(
+					socket_handler->synchronous_socket,
+					message_id,
+					socket_handler->remote_header_length,
+					socket_handler->network_debug_flags,
+					MX_NETMSG_UNEXPECTED_ERROR,
+					mx_status );
+
+		return mx_status;
+	}
+
+	/* Fill in the header and send the response back to the client. */
+
+	header = response->u.uint32_buffer;
+
+	header[ MX_NETWORK_MAGIC ] = mx_htonl( MX_NETWORK_MAGIC_VALUE );
+	header[ MX_NETWORK_HEADER_LENGTH ] = mx_htonl( response_header_length );
+	header[ MX_NETWORK_MESSAGE_LENGTH ]
+		= mx_htonl( response_offset - response_header_length );
+	header[ MX_NETWORK_MESSAGE_TYPE ]
+		= mx_htonl( mx_server_response( message_type ) );
+	header[ MX_NETWORK_STATUS_CODE ] = mx_htonl( MXE_SUCCESS );
+	header[ MX_NETWORK_DATA_TYPE ] = mx_htonl( 0 );
+	header[ MX_NETWORK_MESSAGE_ID ] = mx_htonl( message_id );
+
+	header[ response_header_length / sizeof(uint32_t) ]
+		= mx_htonl( num_entries );
+
+#if NETWORK_DEBUG_MESSAGES
+	if ( socket_handler->network_debug_flags & MXF_NETDBG_VERBOSE ) {
+		fprintf( stderr, "\nMX NET: SERVER -> CLIENT (socket %d)\n",
+			(int) socket_handler->synchronous_socket->socket_fd );
+
+		mx_network_display_message( response, NULL,
+				socket_handler->use_64bit_network_longs );
+	}
+#endif
+
+	mx_status = mx_network_socket_send_message(
+				socket_handler->synchronous_socket,
+				-1.0, response );
+
+	mx_free_network_buffer( response );
+
+	return mx_status;
+}
+
+/*--------------------------------------------------------------------------*/
+
 mx_status_type
 mxsrv_handle_get_network_handle( MX_RECORD *record_list,
 				MX_SOCKET_HANDLER *socket_handler,
@@ -3921,6 +4750,9 @@ mxsrv_handle_set_attribute( MX_RECORD *record_list,
 	case MXNA_POLL:
 		if ( attribute_value >= 0.001 ) {
 			record_field->flags |= MXFF_POLL;
+
+			(void) mx_local_field_update_poll_schedule(
+							record_field );
 		} else {
 			record_field->flags &= (~MXFF_POLL);
 		}
@@ -5662,24 +6494,35 @@ mxsrv_ascii_client_socket_process_event( MX_RECORD *record_list,
 		break;
 	}
 
-	/* Now call the requested command handler. */
+	/* Now call the requested command handler.  ASCII clients are
+	 * handled by the main thread, so the record field is processed
+	 * while no worker threads are running.
+	 */
 
 	switch( command_type ) {
 	case MXT_ASCII_GET:
+		mxsrv_worker_pool_begin_exclusive();
+
 		mx_status = mxsrv_ascii_client_handle_get( record_list,
 							socket_handler,
 							ascii_debug,
 							mx_record, mx_field );
+
+		mxsrv_worker_pool_end_exclusive();
 		break;
 
 	case MXT_ASCII_PUT:
 		put_arguments = ptr;
 
+		mxsrv_worker_pool_begin_exclusive();
+
 		mx_status = mxsrv_ascii_client_handle_put( record_list,
 							socket_handler,
 							ascii_debug,
 							mx_record, mx_field,
 							put_arguments );
+
+		mxsrv_worker_pool_end_exclusive();
 		break;
 
 	default:
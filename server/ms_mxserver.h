@@ -107,6 +107,46 @@ extern mx_status_type mxsrv_send_field_value_to_client(
 			uint32_t message_type_for_client,
 			uint32_t message_id_for_client );
 
+extern mx_status_type mxsrv_encode_field_value(
+			MX_SOCKET_HANDLER *socket_handler,
+			MX_RECORD *record,
+			MX_RECORD_FIELD *record_field,
+			MX_NETWORK_MESSAGE_BUFFER *message_buffer,
+			size_t offset,
+			size_t *num_bytes_used );
+
+extern mx_status_type mxsrv_decode_field_value(
+			MX_SOCKET_HANDLER *socket_handler,
+			MX_RECORD *record,
+			MX_RECORD_FIELD *record_field,
+			char *value_buffer,
+			long buffer_left,
+			size_t *num_value_bytes );
+
+extern mx_status_type mxsrv_get_field_by_handle(
+			MX_RECORD *record_list,
+			long record_handle,
+			long field_handle,
+			MX_RECORD **record,
+			MX_RECORD_FIELD **record_field );
+
+/* Returns the 'mx_server_request_seconds' metric for a message type. */
+
+extern struct mx_metric_type *mxsrv_request_metric( uint32_t message_type );
+
+extern mx_status_type mxsrv_handle_transfer_arrays(
+			MX_RECORD *record_list,
+			MX_SOCKET_HANDLER *socket_handler,
+			MX_NETWORK_MESSAGE_BUFFER *message_buffer,
+			uint32_t message_type );
+
+extern mx_status_type mxsrv_handle_record_field_request(
+			MX_RECORD *record_list,
+			MX_SOCKET_HANDLER *socket_handler,
+			MX_RECORD *record,
+			MX_RECORD_FIELD *record_field,
+			uint32_t message_type );
+
 extern mx_status_type mxsrv_handle_get_array(
 			MX_RECORD *record_list,
 			MX_SOCKET_HANDLER *socket_handler,
@@ -114,6 +154,13 @@ extern mx_status_type mxsrv_handle_get_array(
 			MX_RECORD_FIELD *record_field,
 			MX_NETWORK_MESSAGE_BUFFER *message_buffer );
 
+extern mx_status_type mxsrv_handle_get_bulk(
+			MX_RECORD *record_list,
+			MX_SOCKET_HANDLER *socket_handler,
+			MX_RECORD *record,
+			MX_RECORD_FIELD *record_field,
+			MX_NETWORK_MESSAGE_BUFFER *message_buffer );
+
 extern mx_status_type mxsrv_handle_put_array(
 			MX_RECORD *record_list,
 			MX_SOCKET_HANDLER *socket_handler,
@@ -223,6 +270,42 @@ extern void mxsrv_process_sockets_with_select( MX_RECORD *record_list,
 extern void mxsrv_update_select_fds(
 				MX_SOCKET_HANDLER_LIST *socket_handler_list );
 
+#if HAVE_EPOLL
+
+extern mx_status_type mxsrv_epoll_initialize( MX_RECORD *record_list,
+				MX_SOCKET_HANDLER_LIST *socket_handler_list );
+
+extern void mxsrv_update_epoll_fds(
+				MX_SOCKET_HANDLER_LIST *socket_handler_list );
+
+extern void mxsrv_process_sockets_with_epoll( MX_RECORD *record_list,
+				MX_SOCKET_HANDLER_LIST *socket_handler_list,
+				int timeout_milliseconds );
+
+#endif
+
+/*---*/
+
+extern mx_status_type mxsrv_worker_pool_initialize( MX_RECORD *record_list,
+				long num_worker_threads );
+
+extern mx_bool_type mxsrv_worker_pool_is_active( void );
+
+extern mx_status_type mxsrv_worker_pool_get_completion_fd( int *fd );
+
+extern mx_status_type mxsrv_worker_pool_submit( MX_RECORD *record_list,
+				MX_SOCKET_HANDLER *socket_handler,
+				MX_SOCKET_HANDLER_LIST *socket_handler_list,
+				MX_RECORD *record,
+				MX_RECORD_FIELD *record_field,
+				uint32_t message_type );
+
+extern mx_status_type mxsrv_worker_pool_process_completions( void );
+
+extern void mxsrv_worker_pool_begin_exclusive( void );
+
+extern void mxsrv_worker_pool_end_exclusive( void );
+
 /*---*/
 
 #if HAVE_UNIX_DOMAIN_SOCKETS
@@ -0,0 +1,410 @@
+/*
+ * Name: ms_socket_epoll.c
+ *
+ * Purpose: Process incoming MX socket events with the Linux epoll() API.
+ *
+ *          Unlike the select() based event loop, the epoll() event loop
+ *          blocks until at least one socket is readable or the callback
+ *          pipe has been written to.  Only the socket handlers that
+ *          actually have events pending are visited, so the cost of
+ *          dispatching an event does not depend on the number of
+ *          connected clients.
+ *
+ * Author:  William Lavender
+ *
+ *--------------------------------------------------------------------------
+ *
+ * Copyright 2016 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#define MS_SOCKET_EPOLL_DEBUG		FALSE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+
+#include "mx_osdef.h"
+#include "mx_util.h"
+#include "mx_record.h"
+#include "mx_stdint.h"
+#include "mx_socket.h"
+#include "mx_select.h"
+#include "mx_pipe.h"
+#include "mx_process.h"
+
+#include "ms_mxserver.h"
+
+#if HAVE_EPOLL
+
+#include <unistd.h>
+#include <sys/epoll.h>
+
+/* Maximum number of events returned by a single call to epoll_wait(). */
+
+#define MXSRV_EPOLL_MAX_EVENTS		64
+
+/* The epoll_data of each registered socket contains the index of its
+ * socket handler in the upper 32 bits and the socket's file descriptor
+ * in the lower 32 bits.  This lets us detect events for socket handlers
+ * that were freed by an earlier event in the same epoll_wait() batch.
+ * The callback pipe and the worker thread completion pipe are tagged
+ * with values that no socket can have.
+ */
+
+#define MXSRV_EPOLL_CALLBACK_PIPE_TAG	(~((uint64_t) 0))
+
+#define MXSRV_EPOLL_WORKER_PIPE_TAG	(~((uint64_t) 1))
+
+#define MXSRV_EPOLL_TAG(i,fd) \
+		( ( ((uint64_t) (i)) << 32 ) | ((uint32_t) (fd)) )
+
+static struct epoll_event mxsrv_epoll_event_array[MXSRV_EPOLL_MAX_EVENTS];
+
+/*-------------------------------------------------------------------------*/
+
+mx_status_type
+mxsrv_epoll_initialize( MX_RECORD *mx_record_list,
+			MX_SOCKET_HANDLER_LIST *socket_handler_list )
+{
+	static const char fname[] = "mxsrv_epoll_initialize()";
+
+	MX_LIST_HEAD *list_head;
+	struct epoll_event event;
+	int i, epoll_fd, callback_pipe_fd, worker_pipe_fd;
+	int os_status, saved_errno;
+	mx_status_type mx_status;
+
+	if ( socket_handler_list == (MX_SOCKET_HANDLER_LIST *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_SOCKET_HANDLER_LIST pointer passed was NULL." );
+	}
+
+	list_head = mx_get_record_list_head_struct( mx_record_list );
+
+	if ( list_head == (MX_LIST_HEAD *) NULL ) {
+		return mx_error( MXE_CORRUPT_DATA_STRUCTURE, fname,
+		"The MX_LIST_HEAD pointer for the current database is NULL." );
+	}
+
+	socket_handler_list->epoll_registered_fd_array = (int *)
+		malloc( socket_handler_list->handler_array_size * sizeof(int) );
+
+	if ( socket_handler_list->epoll_registered_fd_array == (int *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate an epoll() registration "
+		"array for %d socket handlers.",
+			socket_handler_list->handler_array_size );
+	}
+
+	for ( i = 0; i < socket_handler_list->handler_array_size; i++ ) {
+		socket_handler_list->epoll_registered_fd_array[i] = -1;
+	}
+
+	epoll_fd = epoll_create( MXSRV_EPOLL_MAX_EVENTS );
+
+	if ( epoll_fd < 0 ) {
+		saved_errno = errno;
+
+		return mx_error( MXE_OPERATING_SYSTEM_ERROR, fname,
+		"The attempt to create an epoll() file descriptor failed.  "
+		"Errno = %d, error message = '%s'.",
+			saved_errno, strerror(saved_errno) );
+	}
+
+	socket_handler_list->epoll_fd = epoll_fd;
+
+	/* If callbacks are enabled, then the callback pipe must also
+	 * be able to wake us up.  Virtual timer events reach the main
+	 * loop via this pipe too.
+	 */
+
+	if ( list_head->callback_pipe != (MX_PIPE *) NULL ) {
+		mx_status = mx_pipe_get_read_fd( list_head->callback_pipe,
+							&callback_pipe_fd );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		memset( &event, 0, sizeof(event) );
+
+		event.events = EPOLLIN;
+		event.data.u64 = MXSRV_EPOLL_CALLBACK_PIPE_TAG;
+
+		os_status = epoll_ctl( epoll_fd, EPOLL_CTL_ADD,
+					callback_pipe_fd, &event );
+
+		if ( os_status < 0 ) {
+			saved_errno = errno;
+
+			return mx_error( MXE_OPERATING_SYSTEM_ERROR, fname,
+			"The attempt to add callback pipe fd %d to "
+			"epoll fd %d failed.  "
+			"Errno = %d, error message = '%s'.",
+				callback_pipe_fd, epoll_fd,
+				saved_errno, strerror(saved_errno) );
+		}
+	}
+
+	/* Worker threads, if any, write to their completion pipe when
+	 * they finish a request, so that the socket for that client
+	 * can be added back to the epoll set.
+	 */
+
+	if ( mxsrv_worker_pool_is_active() ) {
+		mx_status = mxsrv_worker_pool_get_completion_fd(
+							&worker_pipe_fd );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		memset( &event, 0, sizeof(event) );
+
+		event.events = EPOLLIN;
+		event.data.u64 = MXSRV_EPOLL_WORKER_PIPE_TAG;
+
+		os_status = epoll_ctl( epoll_fd, EPOLL_CTL_ADD,
+					worker_pipe_fd, &event );
+
+		if ( os_status < 0 ) {
+			saved_errno = errno;
+
+			return mx_error( MXE_OPERATING_SYSTEM_ERROR, fname,
+			"The attempt to add worker completion pipe fd %d to "
+			"epoll fd %d failed.  "
+			"Errno = %d, error message = '%s'.",
+				worker_pipe_fd, epoll_fd,
+				saved_errno, strerror(saved_errno) );
+		}
+	}
+
+	mxsrv_update_epoll_fds( socket_handler_list );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+void
+mxsrv_update_epoll_fds( MX_SOCKET_HANDLER_LIST *socket_handler_list )
+{
+	static const char fname[] = "mxsrv_update_epoll_fds()";
+
+	int i, old_fd, new_fd, epoll_fd, os_status, saved_errno;
+	int highest_socket_in_use;
+	struct epoll_event event;
+
+	if ( socket_handler_list == (MX_SOCKET_HANDLER_LIST *) NULL ) {
+		mx_warning( "%s: socket_handler_list is NULL!", fname );
+
+		return;
+	}
+
+	epoll_fd = socket_handler_list->epoll_fd;
+
+	/* If mxsrv_epoll_initialize() has not been called yet,
+	 * then there is nothing to do.
+	 */
+
+	if ( epoll_fd < 0 ) {
+		return;
+	}
+
+	highest_socket_in_use = -1;
+
+	/* Only the slots whose socket has changed since the last call
+	 * are passed to epoll_ctl().  This happens only when a client
+	 * connects or disconnects, not once per pass of the event loop.
+	 */
+
+	for ( i = 0; i < socket_handler_list->handler_array_size; i++ ) {
+
+		old_fd = socket_handler_list->epoll_registered_fd_array[i];
+
+		/* A socket handler whose request is still being executed
+		 * by a worker thread is left out of the epoll set until
+		 * the request has completed.
+		 */
+
+		if ( socket_handler_list->array[i] == NULL ) {
+			new_fd = -1;
+		} else
+		if ( socket_handler_list->array[i]->request_in_progress ) {
+			new_fd = -1;
+		} else {
+			new_fd = (int)
+		    socket_handler_list->array[i]->synchronous_socket->socket_fd;
+		}
+
+		if ( new_fd > highest_socket_in_use ) {
+			highest_socket_in_use = new_fd;
+		}
+
+		if ( old_fd == new_fd ) {
+			continue;
+		}
+
+		if ( old_fd >= 0 ) {
+			/* The socket may already have been closed, which
+			 * removes it from the epoll set automatically.
+			 * Thus, ENOENT and EBADF are not errors here.
+			 */
+
+			(void) epoll_ctl( epoll_fd, EPOLL_CTL_DEL,
+						old_fd, &event );
+
+			socket_handler_list->epoll_registered_fd_array[i] = -1;
+		}
+
+		if ( new_fd >= 0 ) {
+			memset( &event, 0, sizeof(event) );
+
+			event.events = EPOLLIN;
+			event.data.u64 = MXSRV_EPOLL_TAG( i, new_fd );
+
+			os_status = epoll_ctl( epoll_fd, EPOLL_CTL_ADD,
+						new_fd, &event );
+
+			if ( ( os_status < 0 ) && ( errno == EEXIST ) ) {
+				os_status = epoll_ctl( epoll_fd, EPOLL_CTL_MOD,
+							new_fd, &event );
+			}
+
+			if ( os_status < 0 ) {
+				saved_errno = errno;
+
+				(void) mx_error( MXE_OPERATING_SYSTEM_ERROR,
+				fname, "The attempt to add socket %d for "
+				"socket handler %d to epoll fd %d failed.  "
+				"Errno = %d, error message = '%s'.",
+					new_fd, i, epoll_fd,
+					saved_errno, strerror(saved_errno) );
+
+				continue;
+			}
+
+			socket_handler_list->epoll_registered_fd_array[i]
+								= new_fd;
+		}
+	}
+
+	socket_handler_list->highest_socket_in_use = highest_socket_in_use;
+
+	return;
+}
+
+/*-------------------------------------------------------------------------*/
+
+void
+mxsrv_process_sockets_with_epoll( MX_RECORD *mx_record_list,
+				MX_SOCKET_HANDLER_LIST *socket_handler_list,
+				int timeout_milliseconds )
+{
+	static const char fname[] = "mxsrv_process_sockets_with_epoll()";
+
+	MX_SOCKET_HANDLER *socket_handler;
+	MX_EVENT_HANDLER *event_handler;
+	uint64_t event_tag;
+	int n, i, fd, num_events, saved_errno;
+
+	mx_status_type ( *process_event_fn ) ( MX_RECORD *,
+					MX_SOCKET_HANDLER *,
+					MX_SOCKET_HANDLER_LIST *,
+					MX_EVENT_HANDLER * );
+
+	num_events = epoll_wait( socket_handler_list->epoll_fd,
+				mxsrv_epoll_event_array,
+				MXSRV_EPOLL_MAX_EVENTS,
+				timeout_milliseconds );
+
+	if ( num_events < 0 ) {
+		saved_errno = errno;
+
+		/* As with select(), EINTR just means that a signal
+		 * handler fired while we were blocked.
+		 */
+
+		if ( saved_errno != EINTR ) {
+			(void) mx_error( MXE_NETWORK_IO_ERROR, fname,
+			"Error in epoll_wait() while waiting for events.  "
+			"Errno = %d.  Error string = '%s'.",
+			saved_errno, strerror( saved_errno ) );
+		}
+		return;
+	}
+
+#if MS_SOCKET_EPOLL_DEBUG
+	MX_DEBUG(-2,("%s: epoll_wait() returned %d events.",
+		fname, num_events));
+#endif
+
+	for ( n = 0; n < num_events; n++ ) {
+
+		event_tag = mxsrv_epoll_event_array[n].data.u64;
+
+		/* Callback pipe and worker pipe events are handled
+		 * by the main loop after we return.
+		 */
+
+		if ( ( event_tag == MXSRV_EPOLL_CALLBACK_PIPE_TAG )
+		  || ( event_tag == MXSRV_EPOLL_WORKER_PIPE_TAG ) )
+		{
+			continue;
+		}
+
+		i  = (int) ( event_tag >> 32 );
+		fd = (int) ( event_tag & 0xffffffff );
+
+		if ( ( i < 0 ) || ( i >= socket_handler_list->handler_array_size ) )
+		{
+			continue;
+		}
+
+		socket_handler = socket_handler_list->array[i];
+
+		/* Skip events for socket handlers that have been freed
+		 * while processing earlier events in this batch.
+		 */
+
+		if ( socket_handler == (MX_SOCKET_HANDLER *) NULL )
+			continue;
+
+		if ( socket_handler->synchronous_socket->socket_fd != fd )
+			continue;
+
+		event_handler = socket_handler->event_handler;
+
+		if ( event_handler == NULL ) {
+			(void) mx_error( MXE_NETWORK_IO_ERROR, fname,
+		"Event handler pointer for socket handler %d is NULL.", i);
+
+			continue;
+		}
+
+		process_event_fn = event_handler->process_event;
+
+		if ( process_event_fn == NULL ) {
+			(void) mx_error( MXE_NETWORK_IO_ERROR, fname,
+	"process_event function pointer for socket handler %d is NULL.", i);
+
+			continue;
+		}
+
+		/* Process the event.  EPOLLHUP and EPOLLERR are also passed
+		 * on, so that the handler's own receive code sees the
+		 * disconnect and frees the socket handler.
+		 */
+
+		(void) ( *process_event_fn ) ( mx_record_list,
+						socket_handler,
+						socket_handler_list,
+						event_handler );
+	}
+
+	return;
+}
+
+#endif /* HAVE_EPOLL */
@@ -17,6 +17,7 @@
 #include <stdio.h>
 #include <errno.h>
 
+#include "mx_osdef.h"
 #include "mx_util.h"
 #include "mx_record.h"
 #include "mx_stdint.h"
@@ -45,6 +46,18 @@ mxsrv_update_select_fds( MX_SOCKET_HANDLER_LIST *socket_handler_list )
 		mx_warning( "%s: continuing anyway.", fname );
 	}
 
+#if HAVE_EPOLL
+	/* The epoll() event loop does not use an fd_set, which also means
+	 * that it is not limited to sockets below FD_SETSIZE.
+	 */
+
+	if ( socket_handler_list->event_loop_type == MXF_SRV_EPOLL_EVENT_LOOP )
+	{
+		mxsrv_update_epoll_fds( socket_handler_list );
+		return;
+	}
+#endif
+
 	handler_array_size = socket_handler_list->handler_array_size;
 
 	FD_ZERO(&select_readfds);
@@ -53,6 +66,15 @@ mxsrv_update_select_fds( MX_SOCKET_HANDLER_LIST *socket_handler_list )
 
 	for ( i = 0; i < handler_array_size; i++ ) {
 		if ( socket_handler_list->array[i] != NULL ) {
+
+			/* Sockets whose current request is still being
+			 * executed by a worker thread are not checked
+			 * until the request has completed.
+			 */
+
+			if ( socket_handler_list->array[i]->request_in_progress )
+				continue;
+
 			current_socket
 		    = socket_handler_list->array[i]->synchronous_socket;
 
@@ -0,0 +1,806 @@
+/*
+ * Name: ms_worker.c
+ *
+ * Purpose: Worker threads for executing client requests in the MX server.
+ *
+ *          Normally, mxserver executes every client request in its main
+ *          thread, so a slow request for one device delays the requests
+ *          of every other client.  If worker threads are enabled with
+ *          the -N option, requests that read or write a record field
+ *          are handed off to a pool of worker threads instead.
+ *
+ *          The following rules keep this safe:
+ *
+ *          1.  Each client has at most one request in progress.  While
+ *              a worker thread is executing it, the main thread stops
+ *              listening to that client's socket, so the worker thread
+ *              owns the socket and its message buffer.
+ *
+ *          2.  Records that depend on one another, such as a motor and
+ *              the RS-232 port that it talks through, share a single
+ *              record lock.  Requests for unrelated hardware can thus
+ *              run in parallel, while requests for the same interface
+ *              are serialized.
+ *
+ *          3.  Callbacks and client connection changes touch data shared
+ *              by all clients, so the main thread only performs them
+ *              while no worker threads are running.  Callbacks that are
+ *              triggered inside a worker thread are deferred until the
+ *              request has completed and are then invoked by the main
+ *              thread.
+ *
+ * Author:  William Lavender
+ *
+ *--------------------------------------------------------------------------
+ *
+ * Copyright 2016 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#define MS_WORKER_DEBUG			FALSE
+
+#define MS_WORKER_DEBUG_RECORD_LOCKS	FALSE
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mx_osdef.h"
+#include "mx_util.h"
+#include "mx_record.h"
+#include "mx_stdint.h"
+#include "mx_socket.h"
+#include "mx_net.h"
+#include "mx_pipe.h"
+#include "mx_thread.h"
+#include "mx_mutex.h"
+#include "mx_condition_variable.h"
+#include "mx_callback.h"
+#include "mx_process.h"
+#include "mx_metrics.h"
+
+#include "ms_mxserver.h"
+
+typedef struct {
+	MX_RECORD_FIELD *record_field;
+	unsigned long callback_type;
+} MXSRV_DEFERRED_CALLBACK;
+
+typedef struct mxsrv_work_item_type {
+	MX_RECORD *record_list;
+	MX_SOCKET_HANDLER *socket_handler;
+	MX_RECORD *record;
+	MX_RECORD_FIELD *record_field;
+	uint32_t message_type;
+
+	long num_deferred_callbacks;
+	long deferred_callback_array_size;
+	MXSRV_DEFERRED_CALLBACK *deferred_callback_array;
+
+	struct mxsrv_work_item_type *next_item;
+} MXSRV_WORK_ITEM;
+
+typedef struct {
+	MXSRV_WORK_ITEM *first_item;
+	MXSRV_WORK_ITEM *last_item;
+} MXSRV_WORK_QUEUE;
+
+static mx_bool_type mxsrv_worker_pool_active = FALSE;
+
+static long mxsrv_num_worker_threads = 0;
+static MX_THREAD **mxsrv_worker_thread_array = NULL;
+
+static MX_SOCKET_HANDLER_LIST *mxsrv_worker_socket_handler_list = NULL;
+
+/* queue_mutex protects the pending, done, and free queues. */
+
+static MX_MUTEX *mxsrv_worker_queue_mutex = NULL;
+static MX_CONDITION_VARIABLE *mxsrv_worker_queue_cv = NULL;
+
+static MXSRV_WORK_QUEUE mxsrv_pending_queue = { NULL, NULL };
+static MXSRV_WORK_QUEUE mxsrv_done_queue = { NULL, NULL };
+static MXSRV_WORK_QUEUE mxsrv_free_queue = { NULL, NULL };
+
+/* Worker threads write to the completion pipe to wake up the main thread
+ * when the done queue goes from empty to non-empty.
+ */
+
+static MX_PIPE *mxsrv_worker_completion_pipe = NULL;
+
+/* Each worker thread keeps a pointer to its current work item in
+ * thread local storage, so that the callback deferral function can
+ * find it.
+ */
+
+static MX_THREAD_LOCAL_STORAGE *mxsrv_worker_item_key = NULL;
+
+/* Requests for records that have no record lock of their own, such
+ * as the record list head, use the default record lock.
+ */
+
+static MX_MUTEX *mxsrv_default_record_lock = NULL;
+
+/* The gate lets any number of worker threads run at the same time,
+ * or the main thread run by itself.  A waiting main thread has priority
+ * over worker threads that have not started their request yet.
+ */
+
+static MX_MUTEX *mxsrv_gate_mutex = NULL;
+static MX_CONDITION_VARIABLE *mxsrv_gate_cv = NULL;
+
+static long mxsrv_gate_num_workers_running = 0;
+static mx_bool_type mxsrv_gate_exclusive = FALSE;
+static long mxsrv_gate_exclusive_depth = 0;
+
+/*-------------------------------------------------------------------------*/
+
+static void
+mxsrv_work_queue_append( MXSRV_WORK_QUEUE *queue, MXSRV_WORK_ITEM *item )
+{
+	item->next_item = NULL;
+
+	if ( queue->last_item == (MXSRV_WORK_ITEM *) NULL ) {
+		queue->first_item = item;
+	} else {
+		queue->last_item->next_item = item;
+	}
+
+	queue->last_item = item;
+}
+
+static MXSRV_WORK_ITEM *
+mxsrv_work_queue_remove( MXSRV_WORK_QUEUE *queue )
+{
+	MXSRV_WORK_ITEM *item;
+
+	item = queue->first_item;
+
+	if ( item != (MXSRV_WORK_ITEM *) NULL ) {
+		queue->first_item = item->next_item;
+
+		if ( queue->first_item == (MXSRV_WORK_ITEM *) NULL ) {
+			queue->last_item = NULL;
+		}
+
+		item->next_item = NULL;
+	}
+
+	return item;
+}
+
+/*-------------------------------------------------------------------------*/
+
+static void
+mxsrv_worker_pool_enter( void )
+{
+	mx_mutex_lock( mxsrv_gate_mutex );
+
+	while ( mxsrv_gate_exclusive ) {
+		(void) mx_condition_variable_wait( mxsrv_gate_cv,
+						mxsrv_gate_mutex );
+	}
+
+	mxsrv_gate_num_workers_running++;
+
+	mx_mutex_unlock( mxsrv_gate_mutex );
+}
+
+static void
+mxsrv_worker_pool_leave( void )
+{
+	mx_mutex_lock( mxsrv_gate_mutex );
+
+	mxsrv_gate_num_workers_running--;
+
+	if ( mxsrv_gate_num_workers_running <= 0 ) {
+		(void) mx_condition_variable_broadcast( mxsrv_gate_cv );
+	}
+
+	mx_mutex_unlock( mxsrv_gate_mutex );
+}
+
+/* mxsrv_worker_pool_begin_exclusive() and mxsrv_worker_pool_end_exclusive()
+ * are only called by the main thread.  Calls may be nested.
+ */
+
+void
+mxsrv_worker_pool_begin_exclusive( void )
+{
+	if ( mxsrv_worker_pool_active == FALSE )
+		return;
+
+	mxsrv_gate_exclusive_depth++;
+
+	if ( mxsrv_gate_exclusive_depth > 1 )
+		return;
+
+	mx_mutex_lock( mxsrv_gate_mutex );
+
+	mxsrv_gate_exclusive = TRUE;
+
+	while ( mxsrv_gate_num_workers_running > 0 ) {
+		(void) mx_condition_variable_wait( mxsrv_gate_cv,
+						mxsrv_gate_mutex );
+	}
+
+	mx_mutex_unlock( mxsrv_gate_mutex );
+}
+
+void
+mxsrv_worker_pool_end_exclusive( void )
+{
+	if ( mxsrv_worker_pool_active == FALSE )
+		return;
+
+	mxsrv_gate_exclusive_depth--;
+
+	if ( mxsrv_gate_exclusive_depth > 0 )
+		return;
+
+	mx_mutex_lock( mxsrv_gate_mutex );
+
+	mxsrv_gate_exclusive = FALSE;
+
+	(void) mx_condition_variable_broadcast( mxsrv_gate_cv );
+
+	mx_mutex_unlock( mxsrv_gate_mutex );
+}
+
+/*-------------------------------------------------------------------------*/
+
+/* mxsrv_worker_defer_callback() is installed as the libMx callback
+ * deferral function.  In the main thread it does nothing, so callbacks
+ * are invoked right away as usual.  In a worker thread, the callback is
+ * saved in the current work item instead.
+ */
+
+static mx_bool_type
+mxsrv_worker_defer_callback( MX_RECORD_FIELD *record_field,
+				unsigned long callback_type )
+{
+	MXSRV_WORK_ITEM *item;
+	MXSRV_DEFERRED_CALLBACK *deferred_callback, *new_array;
+	long i, new_array_size;
+
+	item = mx_tls_get_value( mxsrv_worker_item_key );
+
+	if ( item == (MXSRV_WORK_ITEM *) NULL )
+		return FALSE;
+
+	/* Only one invocation of each callback is needed. */
+
+	for ( i = 0; i < item->num_deferred_callbacks; i++ ) {
+		deferred_callback = &(item->deferred_callback_array[i]);
+
+		if ( ( deferred_callback->record_field == record_field )
+		  && ( deferred_callback->callback_type == callback_type ) )
+		{
+			return TRUE;
+		}
+	}
+
+	if ( item->num_deferred_callbacks >= item->deferred_callback_array_size )
+	{
+		new_array_size = 2 * item->deferred_callback_array_size;
+
+		if ( new_array_size < 4 ) {
+			new_array_size = 4;
+		}
+
+		new_array = (MXSRV_DEFERRED_CALLBACK *)
+			realloc( item->deferred_callback_array,
+			    new_array_size * sizeof(MXSRV_DEFERRED_CALLBACK) );
+
+		if ( new_array == (MXSRV_DEFERRED_CALLBACK *) NULL ) {
+			mx_warning( "Ran out of memory trying to defer a "
+			"callback for field '%s'.  The callback was dropped.",
+				record_field->name );
+
+			return TRUE;
+		}
+
+		item->deferred_callback_array = new_array;
+		item->deferred_callback_array_size = new_array_size;
+	}
+
+	deferred_callback =
+		&(item->deferred_callback_array[item->num_deferred_callbacks]);
+
+	deferred_callback->record_field = record_field;
+	deferred_callback->callback_type = callback_type;
+
+	item->num_deferred_callbacks++;
+
+	return TRUE;
+}
+
+/*-------------------------------------------------------------------------*/
+
+static mx_status_type
+mxsrv_worker_thread_fn( MX_THREAD *thread, void *args )
+{
+#if MS_WORKER_DEBUG
+	static const char fname[] = "mxsrv_worker_thread_fn()";
+#endif
+
+	MXSRV_WORK_ITEM *item;
+	MX_MUTEX *record_lock;
+	mx_bool_type wake_main_thread;
+	char wakeup_byte;
+	uint64_t metrics_start;
+	mx_status_type mx_status;
+
+	for (;;) {
+		/* Wait for the next request. */
+
+		mx_mutex_lock( mxsrv_worker_queue_mutex );
+
+		while ( mxsrv_pending_queue.first_item == NULL ) {
+			mx_status = mx_condition_variable_wait(
+						mxsrv_worker_queue_cv,
+						mxsrv_worker_queue_mutex );
+
+			if ( mx_status.code != MXE_SUCCESS ) {
+				mx_mutex_unlock( mxsrv_worker_queue_mutex );
+
+				return mx_status;
+			}
+		}
+
+		item = mxsrv_work_queue_remove( &mxsrv_pending_queue );
+
+		mx_mutex_unlock( mxsrv_worker_queue_mutex );
+
+#if MS_WORKER_DEBUG
+		MX_DEBUG(-2,("%s: message %#lx for '%s.%s' from client %ld",
+			fname, (unsigned long) item->message_type,
+			item->record->name, item->record_field->name,
+			item->socket_handler->handler_array_index));
+#endif
+
+		/* Execute the request.  The reply to the client is sent
+		 * from this thread.
+		 */
+
+		record_lock = (MX_MUTEX *) item->record->record_lock;
+
+		if ( record_lock == (MX_MUTEX *) NULL ) {
+			record_lock = mxsrv_default_record_lock;
+		}
+
+		(void) mx_tls_set_value( mxsrv_worker_item_key, item );
+
+		mxsrv_worker_pool_enter();
+
+		mx_mutex_lock( record_lock );
+
+		metrics_start = mx_metrics_start();
+
+		(void) mxsrv_handle_record_field_request( item->record_list,
+						item->socket_handler,
+						item->record,
+						item->record_field,
+						item->message_type );
+
+		if ( metrics_start != 0 ) {
+			mx_metrics_stop( mxsrv_request_metric(
+					item->message_type ), metrics_start );
+		}
+
+		mx_mutex_unlock( record_lock );
+
+		mxsrv_worker_pool_leave();
+
+		(void) mx_tls_set_value( mxsrv_worker_item_key, NULL );
+
+		/* Hand the request back to the main thread. */
+
+		mx_mutex_lock( mxsrv_worker_queue_mutex );
+
+		if ( mxsrv_done_queue.first_item == NULL ) {
+			wake_main_thread = TRUE;
+		} else {
+			wake_main_thread = FALSE;
+		}
+
+		mxsrv_work_queue_append( &mxsrv_done_queue, item );
+
+		mx_mutex_unlock( mxsrv_worker_queue_mutex );
+
+		if ( wake_main_thread ) {
+			wakeup_byte = 'W';
+
+			(void) mx_pipe_write( mxsrv_worker_completion_pipe,
+							&wakeup_byte, 1 );
+		}
+	}
+
+	MXW_NOT_REACHED( return MX_SUCCESSFUL_RESULT );
+}
+
+/*-------------------------------------------------------------------------*/
+
+/* Every set of records connected by parent/child dependencies gets its
+ * own record lock.  The dependencies are followed in both directions, so
+ * that all of the devices behind a given interface end up in the same set.
+ */
+
+static mx_status_type
+mxsrv_worker_pool_assign_record_locks( MX_RECORD *record_list )
+{
+	static const char fname[] = "mxsrv_worker_pool_assign_record_locks()";
+
+	MX_RECORD *current_record, *record, *neighbor;
+	MX_RECORD **record_stack;
+	MX_MUTEX *record_lock;
+	long i, num_records, stack_depth, num_record_locks;
+	mx_status_type mx_status;
+
+	num_records = 0;
+
+	current_record = record_list->next_record;
+
+	while ( current_record != record_list ) {
+		num_records++;
+
+		current_record = current_record->next_record;
+	}
+
+	if ( num_records == 0 ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	record_stack = (MX_RECORD **) malloc( num_records * sizeof(MX_RECORD *));
+
+	if ( record_stack == (MX_RECORD **) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a %ld element "
+		"record stack.", num_records );
+	}
+
+	num_record_locks = 0;
+
+	current_record = record_list->next_record;
+
+	while ( current_record != record_list ) {
+
+		if ( current_record->record_lock != NULL ) {
+			current_record = current_record->next_record;
+			continue;
+		}
+
+		mx_status = mx_mutex_create( &record_lock );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			mx_free( record_stack );
+			return mx_status;
+		}
+
+		num_record_locks++;
+
+		current_record->record_lock = record_lock;
+
+		record_stack[0] = current_record;
+		stack_depth = 1;
+
+		while ( stack_depth > 0 ) {
+			record = record_stack[ --stack_depth ];
+
+			for ( i = 0;
+			  i < record->num_parent_records + record->num_child_records;
+			  i++ )
+			{
+				if ( i < record->num_parent_records ) {
+					neighbor = record->parent_record_array[i];
+				} else {
+					neighbor = record->child_record_array[
+					    i - record->num_parent_records ];
+				}
+
+				if ( ( neighbor == (MX_RECORD *) NULL )
+				  || ( neighbor == record_list )
+				  || ( neighbor->record_lock != NULL ) )
+				{
+					continue;
+				}
+
+				neighbor->record_lock = record_lock;
+
+				record_stack[ stack_depth++ ] = neighbor;
+			}
+		}
+
+#if MS_WORKER_DEBUG_RECORD_LOCKS
+		MX_DEBUG(-2,("%s: record lock %p starts at record '%s'.",
+			fname, record_lock, current_record->name));
+#endif
+
+		current_record = current_record->next_record;
+	}
+
+	mx_free( record_stack );
+
+#if MS_WORKER_DEBUG_RECORD_LOCKS
+	MX_DEBUG(-2,("%s: %ld records share %ld record locks.",
+		fname, num_records, num_record_locks));
+#endif
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+mx_status_type
+mxsrv_worker_pool_initialize( MX_RECORD *record_list, long num_worker_threads )
+{
+	static const char fname[] = "mxsrv_worker_pool_initialize()";
+
+	long i;
+	mx_status_type mx_status;
+
+	if ( record_list == (MX_RECORD *) NULL ) {
+		return mx_error( MXE_NULL_ARGUMENT, fname,
+		"The MX_RECORD pointer passed was NULL." );
+	}
+
+	if ( num_worker_threads <= 0 ) {
+		return MX_SUCCESSFUL_RESULT;
+	}
+
+	mx_status = mxsrv_worker_pool_assign_record_locks( record_list );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_status = mx_mutex_create( &mxsrv_default_record_lock );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_status = mx_mutex_create( &mxsrv_worker_queue_mutex );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_status = mx_condition_variable_create( &mxsrv_worker_queue_cv );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_status = mx_mutex_create( &mxsrv_gate_mutex );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_status = mx_condition_variable_create( &mxsrv_gate_cv );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_status = mx_tls_alloc( &mxsrv_worker_item_key );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_status = mx_pipe_open( &mxsrv_worker_completion_pipe );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_status = mx_pipe_set_blocking_mode( mxsrv_worker_completion_pipe,
+					MXF_PIPE_READ | MXF_PIPE_WRITE, FALSE );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_set_callback_deferral_function( mxsrv_worker_defer_callback );
+
+	mxsrv_worker_thread_array = (MX_THREAD **)
+			calloc( num_worker_threads, sizeof(MX_THREAD *) );
+
+	if ( mxsrv_worker_thread_array == (MX_THREAD **) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate an array of "
+		"%ld worker thread pointers.", num_worker_threads );
+	}
+
+	mxsrv_worker_pool_active = TRUE;
+
+	for ( i = 0; i < num_worker_threads; i++ ) {
+		mx_status = mx_thread_create( &(mxsrv_worker_thread_array[i]),
+						mxsrv_worker_thread_fn, NULL );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		mxsrv_num_worker_threads++;
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+mx_bool_type
+mxsrv_worker_pool_is_active( void )
+{
+	return mxsrv_worker_pool_active;
+}
+
+/*-------------------------------------------------------------------------*/
+
+mx_status_type
+mxsrv_worker_pool_get_completion_fd( int *fd )
+{
+	static const char fname[] = "mxsrv_worker_pool_get_completion_fd()";
+
+	mx_status_type mx_status;
+
+	if ( mxsrv_worker_completion_pipe == (MX_PIPE *) NULL ) {
+		return mx_error( MXE_INITIALIZATION_ERROR, fname,
+		"The worker thread pool has not been initialized." );
+	}
+
+	mx_status = mx_pipe_get_read_fd( mxsrv_worker_completion_pipe, fd );
+
+	return mx_status;
+}
+
+/*-------------------------------------------------------------------------*/
+
+mx_status_type
+mxsrv_worker_pool_submit( MX_RECORD *record_list,
+			MX_SOCKET_HANDLER *socket_handler,
+			MX_SOCKET_HANDLER_LIST *socket_handler_list,
+			MX_RECORD *record,
+			MX_RECORD_FIELD *record_field,
+			uint32_t message_type )
+{
+	static const char fname[] = "mxsrv_worker_pool_submit()";
+
+	MXSRV_WORK_ITEM *item;
+
+	if ( mxsrv_worker_pool_active == FALSE ) {
+		return mx_error( MXE_INITIALIZATION_ERROR, fname,
+		"The worker thread pool has not been initialized." );
+	}
+
+	mxsrv_worker_socket_handler_list = socket_handler_list;
+
+	/* Reuse an old work item if one is available. */
+
+	mx_mutex_lock( mxsrv_worker_queue_mutex );
+
+	item = mxsrv_work_queue_remove( &mxsrv_free_queue );
+
+	mx_mutex_unlock( mxsrv_worker_queue_mutex );
+
+	if ( item == (MXSRV_WORK_ITEM *) NULL ) {
+		item = (MXSRV_WORK_ITEM *) calloc( 1, sizeof(MXSRV_WORK_ITEM) );
+
+		if ( item == (MXSRV_WORK_ITEM *) NULL ) {
+			return mx_error( MXE_OUT_OF_MEMORY, fname,
+			"Ran out of memory trying to allocate a work item "
+			"for client %ld.", socket_handler->handler_array_index);
+		}
+	}
+
+	item->record_list = record_list;
+	item->socket_handler = socket_handler;
+	item->record = record;
+	item->record_field = record_field;
+	item->message_type = message_type;
+	item->num_deferred_callbacks = 0;
+
+	/* Stop listening to this client until the request is complete. */
+
+	socket_handler->request_in_progress = TRUE;
+
+	mxsrv_update_select_fds( socket_handler_list );
+
+	/* Hand the request to the next available worker thread. */
+
+	mx_mutex_lock( mxsrv_worker_queue_mutex );
+
+	mxsrv_work_queue_append( &mxsrv_pending_queue, item );
+
+	mx_mutex_unlock( mxsrv_worker_queue_mutex );
+
+	(void) mx_condition_variable_signal( mxsrv_worker_queue_cv );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*-------------------------------------------------------------------------*/
+
+mx_status_type
+mxsrv_worker_pool_process_completions( void )
+{
+	MXSRV_WORK_QUEUE done_queue;
+	MXSRV_WORK_ITEM *item;
+	MXSRV_DEFERRED_CALLBACK *deferred_callback;
+	char buffer[80];
+	size_t num_bytes_available, bytes_to_read;
+	long i;
+	mx_status_type mx_status;
+
+	if ( mxsrv_worker_pool_active == FALSE )
+		return MX_SUCCESSFUL_RESULT;
+
+	/* Empty the completion pipe before looking at the done queue,
+	 * so that a wakeup for a later completion is never lost.
+	 */
+
+	mx_status = mx_pipe_num_bytes_available( mxsrv_worker_completion_pipe,
+							&num_bytes_available );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	while ( num_bytes_available > 0 ) {
+		bytes_to_read = num_bytes_available;
+
+		if ( bytes_to_read > sizeof(buffer) ) {
+			bytes_to_read = sizeof(buffer);
+		}
+
+		mx_status = mx_pipe_read( mxsrv_worker_completion_pipe,
+						buffer, bytes_to_read, NULL );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		num_bytes_available -= bytes_to_read;
+	}
+
+	/* Take all of the completed requests at once. */
+
+	mx_mutex_lock( mxsrv_worker_queue_mutex );
+
+	done_queue = mxsrv_done_queue;
+
+	mxsrv_done_queue.first_item = NULL;
+	mxsrv_done_queue.last_item = NULL;
+
+	mx_mutex_unlock( mxsrv_worker_queue_mutex );
+
+	if ( done_queue.first_item == (MXSRV_WORK_ITEM *) NULL )
+		return MX_SUCCESSFUL_RESULT;
+
+	while ( (item = mxsrv_work_queue_remove( &done_queue )) != NULL ) {
+
+		/* Invoke any callbacks that were deferred by the worker. */
+
+		if ( item->num_deferred_callbacks > 0 ) {
+			mxsrv_worker_pool_begin_exclusive();
+
+			for ( i = 0; i < item->num_deferred_callbacks; i++ ) {
+				deferred_callback =
+					&(item->deferred_callback_array[i]);
+
+				(void) mx_local_field_invoke_callback_list(
+					deferred_callback->record_field,
+					deferred_callback->callback_type );
+			}
+
+			mxsrv_worker_pool_end_exclusive();
+		}
+
+		item->socket_handler->request_in_progress = FALSE;
+
+		mx_mutex_lock( mxsrv_worker_queue_mutex );
+
+		mxsrv_work_queue_append( &mxsrv_free_queue, item );
+
+		mx_mutex_unlock( mxsrv_worker_queue_mutex );
+	}
+
+	/* Start listening to the clients again. */
+
+	mxsrv_update_select_fds( mxsrv_worker_socket_handler_list );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mx_osdef.h"
+#include "mx_util.h"
+#include "mx_hrt.h"
+#include "mx_virtual_timer.h"
+
+/* Measures the cost of managing a large number of active virtual timers.
+ *
+ * Usage: vtimer_bench [ num_timers [ run_time_in_seconds ] ]
+ */
+
+static void
+bench_callback( MX_VIRTUAL_TIMER *vtimer, void *args )
+{
+	unsigned long *counter_ptr;
+
+	counter_ptr = (unsigned long *) args;
+
+	(*counter_ptr)++;
+}
+
+static double
+elapsed_seconds( struct timespec start_time )
+{
+	struct timespec time_difference;
+
+	time_difference = mx_subtract_high_resolution_times(
+				mx_high_resolution_time(), start_time );
+
+	return mx_convert_high_resolution_time_to_seconds( time_difference );
+}
+
+int
+main( int argc, char *argv[] )
+{
+	MX_INTERVAL_TIMER *master_timer;
+	MX_VIRTUAL_TIMER **vtimer_array;
+	struct timespec start_time;
+	unsigned long i, num_timers, num_callbacks;
+	double run_time, period, seconds;
+	mx_status_type mx_status;
+
+	num_timers = 10000;
+	run_time = 5.0;
+
+	if ( argc > 1 ) {
+		num_timers = strtoul( argv[1], NULL, 0 );
+	}
+	if ( argc > 2 ) {
+		run_time = atof( argv[2] );
+	}
+
+	mx_set_debug_level(0);
+
+	vtimer_array = (MX_VIRTUAL_TIMER **)
+			calloc( num_timers, sizeof(MX_VIRTUAL_TIMER *) );
+
+	if ( vtimer_array == (MX_VIRTUAL_TIMER **) NULL ) {
+		fprintf( stderr, "Cannot allocate %lu timer pointers.\n",
+			num_timers );
+		exit(1);
+	}
+
+	mx_status = mx_virtual_timer_create_master( &master_timer, 0.01 );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		exit( mx_status.code );
+
+	num_callbacks = 0;
+
+	for ( i = 0; i < num_timers; i++ ) {
+		mx_status = mx_virtual_timer_create( &(vtimer_array[i]),
+				master_timer, MXIT_PERIODIC_TIMER,
+				bench_callback, &num_callbacks );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			exit( mx_status.code );
+	}
+
+	/* Start every timer with a period between 0.05 and 1 second. */
+
+	start_time = mx_high_resolution_time();
+
+	for ( i = 0; i < num_timers; i++ ) {
+		period = 0.05 + 0.95 * (double) ((i * 7919) % num_timers)
+						/ (double) num_timers;
+
+		mx_status = mx_virtual_timer_start( vtimer_array[i], period );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			exit( mx_status.code );
+	}
+
+	seconds = elapsed_seconds( start_time );
+
+	printf( "start:   %lu timers in %g sec (%g usec per timer)\n",
+		num_timers, seconds, 1.0e6 * seconds / (double) num_timers );
+
+	/* Restart every timer while they are all active. */
+
+	start_time = mx_high_resolution_time();
+
+	for ( i = 0; i < num_timers; i++ ) {
+		mx_status = mx_virtual_timer_restart( vtimer_array[i] );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			exit( mx_status.code );
+	}
+
+	seconds = elapsed_seconds( start_time );
+
+	printf( "restart: %lu timers in %g sec (%g usec per timer)\n",
+		num_timers, seconds, 1.0e6 * seconds / (double) num_timers );
+
+	/* Let the timers run. */
+
+	start_time = mx_high_resolution_time();
+
+	mx_msleep( (unsigned long) (1000.0 * run_time) );
+
+	seconds = elapsed_seconds( start_time );
+
+	printf( "run:     %lu callbacks in %g sec (%g callbacks per sec)\n",
+		num_callbacks, seconds, (double) num_callbacks / seconds );
+
+	/* Stop and destroy the timers. */
+
+	start_time = mx_high_resolution_time();
+
+	for ( i = 0; i < num_timers; i++ ) {
+		mx_status = mx_virtual_timer_destroy( vtimer_array[i] );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			exit( mx_status.code );
+	}
+
+	seconds = elapsed_seconds( start_time );
+
+	printf( "destroy: %lu timers in %g sec (%g usec per timer)\n",
+		num_timers, seconds, 1.0e6 * seconds / (double) num_timers );
+
+	(void) mx_virtual_timer_destroy_master( master_timer );
+
+	mx_free( vtimer_array );
+
+	return 0;
+}
+
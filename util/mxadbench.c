@@ -0,0 +1,934 @@
+/*
+ * Name:    mxadbench.c
+ *
+ * Purpose: Mxadbench measures the speed of each stage of the area detector
+ *          frame pipeline using a soft area detector and a soft video
+ *          input in a local MX database, so that no hardware or MX server
+ *          is needed.  The stages are:
+ *
+ *          readout    - mx_area_detector_readout_frame()
+ *          correct    - mx_area_detector_correct_frame() for every
+ *                       combination of the mask, bias, dark current and
+ *                       flat field correction flags, for each correction
+ *                       calculation format (u16, s32, flt, dbl) and for
+ *                       both the plain and precomputed correction methods.
+ *          rebin      - mx_image_rebin() to half size.
+ *          statistics - mx_image_statistics()
+ *          dezinger   - mx_image_dezinger() of 3 frames.
+ *          write      - mx_image_write_file() for each supported
+ *                       file format.
+ *
+ *          The results are written to stdout as comma separated values
+ *          with one line per measurement.  The last column is a histogram
+ *          of the latencies with power of two bins in microseconds, written
+ *          as a list of upper_limit:count pairs separated by semicolons.
+ *
+ * Author:  William Lavender
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Copyright 2016 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mx_util.h"
+#include "mx_unistd.h"
+#include "mx_record.h"
+#include "mx_hrt.h"
+#include "mx_image.h"
+#include "mx_area_detector.h"
+
+#include "mxbench_util.h"
+
+#define MXADB_MAX_ITEMS			16
+#define MXADB_HISTOGRAM_BINS		32
+#define MXADB_NUM_DEZINGER_FRAMES	3
+
+typedef struct {
+	char name[20];
+	long value;
+} MXADB_NAMED_VALUE;
+
+static MXADB_NAMED_VALUE mxadb_calc_format_list[] = {
+	{ "u16", MXT_IMAGE_FORMAT_GREY16 },
+	{ "s32", MXT_IMAGE_FORMAT_INT32 },
+	{ "flt", MXT_IMAGE_FORMAT_FLOAT },
+	{ "dbl", MXT_IMAGE_FORMAT_DOUBLE },
+};
+
+static int mxadb_num_calc_formats = sizeof( mxadb_calc_format_list )
+					/ sizeof( mxadb_calc_format_list[0] );
+
+static MXADB_NAMED_VALUE mxadb_method_list[] = {
+	{ "plain",   MXFT_AD_USE_LOW_MEMORY_METHODS },
+	{ "precomp", MXFT_AD_USE_HIGH_MEMORY_METHODS },
+};
+
+static int mxadb_num_methods = sizeof( mxadb_method_list )
+					/ sizeof( mxadb_method_list[0] );
+
+/* Only the file formats that mx_image_write_file() can write are listed.
+ * TIFF and CBF files need the 'libtiff' and 'cbflib' modules.  NOIR files
+ * are not listed, since they need a site specific static header file.
+ */
+
+static MXADB_NAMED_VALUE mxadb_file_format_list[] = {
+	{ "raw",  MXT_IMAGE_FILE_RAW_GREY16 },
+	{ "pnm",  MXT_IMAGE_FILE_PNM },
+	{ "tiff", MXT_IMAGE_FILE_TIFF },
+	{ "smv",  MXT_IMAGE_FILE_SMV },
+	{ "cbf",  MXT_IMAGE_FILE_CBF },
+};
+
+static int mxadb_num_file_formats = sizeof( mxadb_file_format_list )
+					/ sizeof( mxadb_file_format_list[0] );
+
+/* The correction flags that the soft area detector supports.  Geometrical
+ * correction is not implemented for it and so is not measured.
+ */
+
+static unsigned long mxadb_correction_bit[] = {
+	MXFT_AD_MASK_FRAME,
+	MXFT_AD_BIAS_FRAME,
+	MXFT_AD_DARK_CURRENT_FRAME,
+	MXFT_AD_FLAT_FIELD_FRAME,
+};
+
+static char *mxadb_correction_bit_name[] = {
+	"mask", "bias", "dark", "flat"
+};
+
+#define MXADB_NUM_CORRECTION_BITS \
+	( sizeof(mxadb_correction_bit) / sizeof(mxadb_correction_bit[0]) )
+
+/* The command line settings. */
+
+static unsigned long mxadb_num_iterations = 10;
+static char mxadb_directory[ MXU_FILENAME_LENGTH+1 ] = ".";
+
+static void
+print_usage( void )
+{
+	fprintf( stderr,
+"\n"
+"Usage: mxadbench <options>\n"
+"\n"
+"where the options are:\n"
+"   -D             Start the source code debugger.\n"
+"   -d directory   Directory for the image files written by the write\n"
+"                  stage (default .).  The files are deleted afterwards.\n"
+"   -F formats     List of correction calculation formats\n"
+"                  (default u16,s32,flt,dbl).\n"
+"   -H             Do not print the header line.\n"
+"   -M methods     List of correction methods (default plain,precomp).\n"
+"   -n count       Number of frames measured for each line of output\n"
+"                  (default 10).\n"
+"   -S stages      List of stages to run (default readout,correct,rebin,\n"
+"                  statistics,dezinger,write).\n"
+"   -s sizes       List of square frame sizes in pixels\n"
+"                  (default 512,1024,2048).\n"
+"   -W formats     List of file formats for the write stage\n"
+"                  (default raw,pnm,tiff,smv,cbf).\n"
+"\n"
+"Lists are separated by commas.\n"
+"\n"
+	);
+}
+
+/*------------------------------------------------------------------------*/
+
+static MXADB_NAMED_VALUE *
+mxadb_find_named_value( char *name, MXADB_NAMED_VALUE *list, int list_length )
+{
+	int i;
+
+	for ( i = 0; i < list_length; i++ ) {
+		if ( strcmp( name, list[i].name ) == 0 ) {
+			return &list[i];
+		}
+	}
+
+	return NULL;
+}
+
+static mx_bool_type
+mxadb_list_contains( char *name, char **item_array, int num_items )
+{
+	int i;
+
+	for ( i = 0; i < num_items; i++ ) {
+		if ( strcmp( name, item_array[i] ) == 0 ) {
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+mxadb_print_header( void )
+{
+	printf( "stage,variant,width,height,bytes,count,errors,seconds,"
+		"frames_per_sec,mbytes_per_sec,min_us,mean_us,p50_us,p90_us,"
+		"p99_us,max_us,histogram_us\n" );
+}
+
+/* mxadb_print_result() writes one line of output.  The times in
+ * 'sample_array' are in seconds and are sorted by this function.
+ */
+
+static void
+mxadb_print_result( char *stage_name, char *variant_name,
+			long width, long height, size_t num_bytes,
+			unsigned long num_errors,
+			unsigned long num_samples, double *sample_array )
+{
+	unsigned long histogram[MXADB_HISTOGRAM_BINS];
+	double sum, mean, frames_per_sec, mbytes_per_sec, limit_us;
+	unsigned long i;
+	int bin, first_entry;
+
+	if ( num_samples > 0 ) {
+		qsort( sample_array, num_samples, sizeof(double),
+					mxbench_compare_doubles );
+	}
+
+	memset( histogram, 0, sizeof(histogram) );
+
+	sum = 0.0;
+
+	for ( i = 0; i < num_samples; i++ ) {
+		sum += sample_array[i];
+
+		limit_us = 1.0;
+
+		for ( bin = 0; bin < (MXADB_HISTOGRAM_BINS - 1); bin++ ) {
+			if ( 1.0e6 * sample_array[i] < limit_us )
+				break;
+
+			limit_us *= 2.0;
+		}
+
+		histogram[bin]++;
+	}
+
+	if ( sum > 0.0 ) {
+		mean = sum / (double) num_samples;
+
+		frames_per_sec = (double) num_samples / sum;
+
+		mbytes_per_sec = 1.0e-6 * frames_per_sec * (double) num_bytes;
+	} else {
+		mean = 0.0;
+		frames_per_sec = 0.0;
+		mbytes_per_sec = 0.0;
+	}
+
+	printf( "%s,%s,%ld,%ld,%lu,%lu,%lu,%.6f,%.1f,%.3f,"
+		"%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,",
+		stage_name, variant_name, width, height,
+		(unsigned long) num_bytes, num_samples, num_errors, sum,
+		frames_per_sec, mbytes_per_sec,
+		1.0e6 * mxbench_percentile( sample_array, num_samples, 0.0 ),
+		1.0e6 * mean,
+		1.0e6 * mxbench_percentile( sample_array, num_samples, 0.5 ),
+		1.0e6 * mxbench_percentile( sample_array, num_samples, 0.9 ),
+		1.0e6 * mxbench_percentile( sample_array, num_samples, 0.99 ),
+		1.0e6 * mxbench_percentile( sample_array, num_samples, 1.0 ) );
+
+	first_entry = TRUE;
+	limit_us = 1.0;
+
+	for ( bin = 0; bin < MXADB_HISTOGRAM_BINS; bin++ ) {
+		if ( histogram[bin] > 0 ) {
+			printf( "%s%.0f:%lu", first_entry ? "" : ";",
+					limit_us, histogram[bin] );
+
+			first_entry = FALSE;
+		}
+
+		limit_us *= 2.0;
+	}
+
+	printf( "\n" );
+
+	fflush( stdout );
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+mxadb_discard_info( char *string )
+{
+	return;
+}
+
+/*------------------------------------------------------------------------*/
+
+/* mxadb_fill_frame() fills a 16-bit frame with a repeating pattern
+ * of 'modulus' values starting at 'offset'.  If 'zero_spacing' is not 0,
+ * then every zero_spacing'th pixel is set to 0 instead.
+ */
+
+static void
+mxadb_fill_frame( MX_IMAGE_FRAME *frame, unsigned long offset,
+			unsigned long modulus, unsigned long zero_spacing )
+{
+	uint16_t *pixel;
+	unsigned long i, num_pixels;
+
+	pixel = frame->image_data;
+
+	num_pixels = MXIF_ROW_FRAMESIZE(frame) * MXIF_COLUMN_FRAMESIZE(frame);
+
+	for ( i = 0; i < num_pixels; i++ ) {
+		if ( ( zero_spacing > 0 ) && ( ( i % zero_spacing ) == 0 ) ) {
+			pixel[i] = 0;
+		} else {
+			pixel[i] = (uint16_t) ( offset + ( i % modulus ) );
+		}
+	}
+}
+
+/* mxadb_setup_detector() creates a soft area detector of the requested
+ * size and installs synthetic mask, bias, dark current and flat field
+ * frames.  A copy of an uncorrected frame is returned in *raw_frame.
+ */
+
+static mx_status_type
+mxadb_setup_detector( long framesize, MX_RECORD **ad_record,
+			MX_IMAGE_FRAME **raw_frame )
+{
+	static const char fname[] = "mxadb_setup_detector()";
+
+	static unsigned long frame_type[] = {
+		MXFT_AD_MASK_FRAME,
+		MXFT_AD_BIAS_FRAME,
+		MXFT_AD_DARK_CURRENT_FRAME,
+		MXFT_AD_FLAT_FIELD_FRAME,
+	};
+
+	MX_RECORD *record_list;
+	MX_AREA_DETECTOR *ad;
+	char vinput_description[MXU_RECORD_DESCRIPTION_LENGTH+1];
+	char ad_description[MXU_RECORD_DESCRIPTION_LENGTH+1];
+	char *description_array[2];
+	mx_bool_type busy;
+	int i;
+	mx_status_type mx_status;
+
+	snprintf( vinput_description, sizeof(vinput_description),
+	"adb_vinput device video_input soft_vinput \"\" \"\" "
+	"%ld %ld GREY16 -1 1 \"\"", framesize, framesize );
+
+	snprintf( ad_description, sizeof(ad_description),
+	"adb_ad device area_detector soft_area_detector \"\" \"\" "
+	"8 0x0 0x0 \"\" \"\" \"\" \"\" \"\" adb_vinput 0x1" );
+
+	description_array[0] = vinput_description;
+	description_array[1] = ad_description;
+
+	mx_status = mx_setup_database_from_array( &record_list,
+						2, description_array );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	*ad_record = mx_get_record( record_list, "adb_ad" );
+
+	if ( (*ad_record) == (MX_RECORD *) NULL ) {
+		return mx_error( MXE_NOT_FOUND, fname,
+		"The area detector record 'adb_ad' was not created." );
+	}
+
+	ad = (*ad_record)->record_class_struct;
+
+	/* Take one frame so that the image frame is set up. */
+
+	mx_status = mx_area_detector_set_one_shot_mode( *ad_record, 0.001 );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_status = mx_area_detector_start( *ad_record );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	for ( i = 0; i < 10000; i++ ) {
+		mx_status = mx_area_detector_is_busy( *ad_record, &busy );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		if ( busy == FALSE )
+			break;
+
+		mx_msleep(1);
+	}
+
+	if ( busy ) {
+		return mx_error( MXE_TIMED_OUT, fname,
+		"Area detector '%s' did not finish its first frame.",
+			(*ad_record)->name );
+	}
+
+	/* Install the correction frames.  The mask frame comes first,
+	 * since the bias and flat field averages depend on it.
+	 */
+
+	for ( i = 0; i < 4; i++ ) {
+		mx_status = mx_area_detector_readout_frame( *ad_record, 0 );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+
+		switch( frame_type[i] ) {
+		case MXFT_AD_MASK_FRAME:
+			mxadb_fill_frame( ad->image_frame, 1, 1, 97 );
+			break;
+		case MXFT_AD_BIAS_FRAME:
+			mxadb_fill_frame( ad->image_frame, 100, 7, 0 );
+			break;
+		case MXFT_AD_DARK_CURRENT_FRAME:
+			mxadb_fill_frame( ad->image_frame, 120, 13, 0 );
+			break;
+		case MXFT_AD_FLAT_FIELD_FRAME:
+			mxadb_fill_frame( ad->image_frame, 1000, 101, 0 );
+			break;
+		}
+
+		mx_status = mx_area_detector_copy_frame( *ad_record,
+					MXFT_AD_IMAGE_FRAME, frame_type[i] );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			return mx_status;
+	}
+
+	mx_status = mx_area_detector_readout_frame( *ad_record, 0 );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	*raw_frame = NULL;
+
+	mx_status = mx_image_copy_frame( ad->image_frame, raw_frame );
+
+	return mx_status;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+mxadb_readout_stage( MX_RECORD *ad_record, long framesize,
+			double *sample_array )
+{
+	MX_AREA_DETECTOR *ad;
+	double start_time;
+	unsigned long i, num_samples, num_errors;
+	mx_status_type mx_status;
+
+	ad = ad_record->record_class_struct;
+
+	num_samples = 0;
+	num_errors = 0;
+
+	for ( i = 0; i < mxadb_num_iterations; i++ ) {
+		start_time = mx_high_resolution_time_as_double();
+
+		mx_status = mx_area_detector_readout_frame( ad_record, 0 );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			num_errors++;
+			break;
+		}
+
+		sample_array[num_samples++] =
+			mx_high_resolution_time_as_double() - start_time;
+	}
+
+	mxadb_print_result( "readout", "u16", framesize, framesize,
+			ad->image_frame->image_length,
+			num_errors, num_samples, sample_array );
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+mxadb_correct_stage( MX_RECORD *ad_record, long framesize,
+			MX_IMAGE_FRAME *raw_frame,
+			MXADB_NAMED_VALUE *calc_format,
+			MXADB_NAMED_VALUE *method,
+			double *sample_array )
+{
+	MX_AREA_DETECTOR *ad;
+	char variant_name[80];
+	double start_time;
+	unsigned long flags, combination, bit;
+	unsigned long i, num_samples, num_errors;
+	mx_status_type mx_status;
+
+	ad = ad_record->record_class_struct;
+
+	ad->correction_calc_format = calc_format->value;
+
+	ad->initial_correction_flags &=
+	    ~( MXFT_AD_USE_LOW_MEMORY_METHODS | MXFT_AD_USE_HIGH_MEMORY_METHODS );
+
+	ad->initial_correction_flags |= method->value;
+
+	for ( combination = 1;
+		combination < (1UL << MXADB_NUM_CORRECTION_BITS);
+		combination++ )
+	{
+		flags = 0;
+
+		snprintf( variant_name, sizeof(variant_name),
+			"%s-%s", calc_format->name, method->name );
+
+		for ( bit = 0; bit < MXADB_NUM_CORRECTION_BITS; bit++ ) {
+			if ( combination & (1UL << bit) ) {
+				flags |= mxadb_correction_bit[bit];
+
+				strlcat( variant_name, "-",
+						sizeof(variant_name) );
+				strlcat( variant_name,
+					mxadb_correction_bit_name[bit],
+					sizeof(variant_name) );
+			}
+		}
+
+		mx_status = mx_area_detector_set_correction_flags( ad_record,
+									flags );
+
+		num_samples = 0;
+		num_errors = 0;
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			num_errors++;
+		}
+
+		/* The first pass is not counted, since it builds
+		 * the precomputed arrays and the correction plan.
+		 */
+
+		for ( i = 0; i <= mxadb_num_iterations; i++ ) {
+			if ( num_errors > 0 )
+				break;
+
+			memcpy( ad->image_frame->image_data,
+				raw_frame->image_data,
+				raw_frame->image_length );
+
+			start_time = mx_high_resolution_time_as_double();
+
+			mx_status = mx_area_detector_correct_frame( ad_record );
+
+			if ( mx_status.code != MXE_SUCCESS ) {
+				num_errors++;
+				break;
+			}
+
+			if ( i > 0 ) {
+				sample_array[num_samples++] =
+				    mx_high_resolution_time_as_double()
+					- start_time;
+			}
+		}
+
+		mxadb_print_result( "correct", variant_name,
+			framesize, framesize, raw_frame->image_length,
+			num_errors, num_samples, sample_array );
+	}
+
+	(void) mx_area_detector_set_correction_flags( ad_record, 0 );
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+mxadb_image_stage( char *stage_name, MX_RECORD *ad_record, long framesize,
+			MX_IMAGE_FRAME *raw_frame, double *sample_array )
+{
+	MX_AREA_DETECTOR *ad;
+	MX_IMAGE_FRAME *result_frame;
+	MX_IMAGE_FRAME *dezinger_array[MXADB_NUM_DEZINGER_FRAMES];
+	double start_time;
+	unsigned long i, num_samples, num_errors;
+	int n;
+	mx_status_type mx_status;
+
+	ad = ad_record->record_class_struct;
+
+	result_frame = NULL;
+
+	num_samples = 0;
+	num_errors = 0;
+
+	for ( n = 0; n < MXADB_NUM_DEZINGER_FRAMES; n++ ) {
+		dezinger_array[n] = raw_frame;
+	}
+
+	dezinger_array[0] = ad->image_frame;
+
+	memcpy( ad->image_frame->image_data,
+		raw_frame->image_data, raw_frame->image_length );
+
+	/* mx_image_dezinger() expects the destination frame to exist. */
+
+	if ( strcmp( stage_name, "dezinger" ) == 0 ) {
+		mx_status = mx_image_copy_frame( raw_frame, &result_frame );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			num_errors++;
+		}
+	}
+
+	for ( i = 0; i < mxadb_num_iterations; i++ ) {
+		if ( num_errors > 0 )
+			break;
+
+		start_time = mx_high_resolution_time_as_double();
+
+		if ( strcmp( stage_name, "rebin" ) == 0 ) {
+			mx_status = mx_image_rebin( &result_frame,
+					ad->image_frame,
+					framesize / 2, framesize / 2 );
+		} else
+		if ( strcmp( stage_name, "statistics" ) == 0 ) {
+			mx_set_info_output_function( mxadb_discard_info );
+
+			mx_status = mx_image_statistics( ad->image_frame );
+
+			mx_set_info_output_function( NULL );
+		} else {
+			mx_status = mx_image_dezinger( &result_frame,
+					MXADB_NUM_DEZINGER_FRAMES,
+					dezinger_array, 1.0 );
+		}
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			num_errors++;
+			break;
+		}
+
+		sample_array[num_samples++] =
+			mx_high_resolution_time_as_double() - start_time;
+	}
+
+	mxadb_print_result( stage_name, "u16", framesize, framesize,
+			raw_frame->image_length,
+			num_errors, num_samples, sample_array );
+
+	if ( result_frame != (MX_IMAGE_FRAME *) NULL ) {
+		mx_image_free( result_frame );
+	}
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+mxadb_write_stage( MX_RECORD *ad_record, long framesize,
+			MX_IMAGE_FRAME *raw_frame,
+			MXADB_NAMED_VALUE *file_format,
+			double *sample_array )
+{
+	MX_AREA_DETECTOR *ad;
+	char filename[MXU_FILENAME_LENGTH+80];
+	double start_time;
+	unsigned long i, num_samples, num_errors;
+	mx_status_type mx_status;
+
+	ad = ad_record->record_class_struct;
+
+	snprintf( filename, sizeof(filename), "%s/mxadbench_%ld.%s",
+			mxadb_directory, framesize, file_format->name );
+
+	num_samples = 0;
+	num_errors = 0;
+
+	for ( i = 0; i < mxadb_num_iterations; i++ ) {
+
+		start_time = mx_high_resolution_time_as_double();
+
+		mx_status = mx_image_write_file( raw_frame, ad->dictionary,
+					file_format->value, filename );
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			num_errors++;
+			break;
+		}
+
+		sample_array[num_samples++] =
+			mx_high_resolution_time_as_double() - start_time;
+	}
+
+	(void) remove( filename );
+
+	mxadb_print_result( "write", file_format->name,
+			framesize, framesize, raw_frame->image_length,
+			num_errors, num_samples, sample_array );
+}
+
+/*------------------------------------------------------------------------*/
+
+int
+main( int argc, char *argv[] )
+{
+	static const char fname[] = "mxadbench";
+
+	char size_string[200] = "512,1024,2048";
+	char stage_string[200] =
+			"readout,correct,rebin,statistics,dezinger,write";
+	char calc_format_string[200] = "u16,s32,flt,dbl";
+	char method_string[200] = "plain,precomp";
+	char file_format_string[200] = "raw,pnm,tiff,smv,cbf";
+	char *size_item[MXADB_MAX_ITEMS];
+	char *stage_item[MXADB_MAX_ITEMS];
+	char *calc_format_item[MXADB_MAX_ITEMS];
+	char *method_item[MXADB_MAX_ITEMS];
+	char *file_format_item[MXADB_MAX_ITEMS];
+	int num_size_items, num_stage_items, num_calc_format_items;
+	int num_method_items, num_file_format_items;
+
+	MXADB_NAMED_VALUE *calc_format[MXADB_MAX_ITEMS];
+	MXADB_NAMED_VALUE *method[MXADB_MAX_ITEMS];
+	MXADB_NAMED_VALUE *file_format[MXADB_MAX_ITEMS];
+
+	MX_RECORD *ad_record;
+	MX_IMAGE_FRAME *raw_frame;
+	double *sample_array;
+	long framesize;
+	int c, i, j, k;
+	mx_bool_type start_debugger, print_header;
+	mx_status_type mx_status;
+
+	start_debugger = FALSE;
+	print_header = TRUE;
+
+	while ( (c = getopt(argc, argv, "Dd:F:HM:n:S:s:W:")) != -1 )
+	{
+		switch(c) {
+		case 'D':
+			start_debugger = TRUE;
+			break;
+		case 'd':
+			strlcpy( mxadb_directory, optarg,
+					sizeof(mxadb_directory) );
+			break;
+		case 'F':
+			strlcpy( calc_format_string, optarg,
+					sizeof(calc_format_string) );
+			break;
+		case 'H':
+			print_header = FALSE;
+			break;
+		case 'M':
+			strlcpy( method_string, optarg,
+					sizeof(method_string) );
+			break;
+		case 'n':
+			mxadb_num_iterations = strtoul( optarg, NULL, 0 );
+			break;
+		case 'S':
+			strlcpy( stage_string, optarg, sizeof(stage_string) );
+			break;
+		case 's':
+			strlcpy( size_string, optarg, sizeof(size_string) );
+			break;
+		case 'W':
+			strlcpy( file_format_string, optarg,
+					sizeof(file_format_string) );
+			break;
+		default:
+			print_usage();
+			exit(1);
+			break;
+		}
+	}
+
+	if ( start_debugger ) {
+		mx_breakpoint();
+	}
+
+	if ( mxadb_num_iterations == 0 ) {
+		mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"The number of frames per measurement must be "
+		"greater than zero." );
+
+		exit( mx_status.code );
+	}
+
+	num_size_items = mxbench_split_list( size_string,
+					size_item, MXADB_MAX_ITEMS );
+
+	num_stage_items = mxbench_split_list( stage_string,
+					stage_item, MXADB_MAX_ITEMS );
+
+	num_calc_format_items = mxbench_split_list( calc_format_string,
+					calc_format_item, MXADB_MAX_ITEMS );
+
+	num_method_items = mxbench_split_list( method_string,
+					method_item, MXADB_MAX_ITEMS );
+
+	num_file_format_items = mxbench_split_list( file_format_string,
+					file_format_item, MXADB_MAX_ITEMS );
+
+	/* Check all of the names before any measurements are made. */
+
+	for ( i = 0; i < num_calc_format_items; i++ ) {
+		calc_format[i] = mxadb_find_named_value( calc_format_item[i],
+			mxadb_calc_format_list, mxadb_num_calc_formats );
+
+		if ( calc_format[i] == (MXADB_NAMED_VALUE *) NULL ) {
+			mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+			"Unrecognized correction format '%s'.",
+				calc_format_item[i] );
+
+			exit( mx_status.code );
+		}
+	}
+
+	for ( i = 0; i < num_method_items; i++ ) {
+		method[i] = mxadb_find_named_value( method_item[i],
+			mxadb_method_list, mxadb_num_methods );
+
+		if ( method[i] == (MXADB_NAMED_VALUE *) NULL ) {
+			mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+			"Unrecognized correction method '%s'.",
+				method_item[i] );
+
+			exit( mx_status.code );
+		}
+	}
+
+	for ( i = 0; i < num_file_format_items; i++ ) {
+		file_format[i] = mxadb_find_named_value( file_format_item[i],
+			mxadb_file_format_list, mxadb_num_file_formats );
+
+		if ( file_format[i] == (MXADB_NAMED_VALUE *) NULL ) {
+			mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+			"Unrecognized file format '%s'.",
+				file_format_item[i] );
+
+			exit( mx_status.code );
+		}
+	}
+
+	for ( i = 0; i < num_stage_items; i++ ) {
+		if ( ( strcmp( stage_item[i], "readout" ) != 0 )
+		  && ( strcmp( stage_item[i], "correct" ) != 0 )
+		  && ( strcmp( stage_item[i], "rebin" ) != 0 )
+		  && ( strcmp( stage_item[i], "statistics" ) != 0 )
+		  && ( strcmp( stage_item[i], "dezinger" ) != 0 )
+		  && ( strcmp( stage_item[i], "write" ) != 0 ) )
+		{
+			mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+			"Unrecognized stage '%s'.", stage_item[i] );
+
+			exit( mx_status.code );
+		}
+	}
+
+	sample_array = malloc( (mxadb_num_iterations + 1) * sizeof(double) );
+
+	if ( sample_array == (double *) NULL ) {
+		mx_status = mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a %lu element "
+		"sample array.", mxadb_num_iterations + 1 );
+
+		exit( mx_status.code );
+	}
+
+	if ( print_header ) {
+		mxadb_print_header();
+	}
+
+	for ( i = 0; i < num_size_items; i++ ) {
+		framesize = atol( size_item[i] );
+
+		if ( ( framesize < 2 ) || ( framesize % 2 ) != 0 ) {
+			mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+			"The frame size %ld must be an even number "
+			"of at least 2.", framesize );
+
+			exit( mx_status.code );
+		}
+
+		mx_status = mxadb_setup_detector( framesize,
+						&ad_record, &raw_frame );
+
+		if ( mx_status.code != MXE_SUCCESS )
+			exit( mx_status.code );
+
+		if ( mxadb_list_contains( "readout",
+					stage_item, num_stage_items ) )
+		{
+			mxadb_readout_stage( ad_record, framesize,
+						sample_array );
+		}
+
+		if ( mxadb_list_contains( "correct",
+					stage_item, num_stage_items ) )
+		{
+			for ( j = 0; j < num_calc_format_items; j++ ) {
+			    for ( k = 0; k < num_method_items; k++ ) {
+				mxadb_correct_stage( ad_record, framesize,
+						raw_frame, calc_format[j],
+						method[k], sample_array );
+			    }
+			}
+		}
+
+		if ( mxadb_list_contains( "rebin",
+					stage_item, num_stage_items ) )
+		{
+			mxadb_image_stage( "rebin", ad_record, framesize,
+						raw_frame, sample_array );
+		}
+
+		if ( mxadb_list_contains( "statistics",
+					stage_item, num_stage_items ) )
+		{
+			mxadb_image_stage( "statistics", ad_record, framesize,
+						raw_frame, sample_array );
+		}
+
+		if ( mxadb_list_contains( "dezinger",
+					stage_item, num_stage_items ) )
+		{
+			mxadb_image_stage( "dezinger", ad_record, framesize,
+						raw_frame, sample_array );
+		}
+
+		if ( mxadb_list_contains( "write",
+					stage_item, num_stage_items ) )
+		{
+			for ( j = 0; j < num_file_format_items; j++ ) {
+				mxadb_write_stage( ad_record, framesize,
+					raw_frame, file_format[j],
+					sample_array );
+			}
+		}
+
+		mx_image_free( raw_frame );
+
+		(void) mx_shutdown_hardware( ad_record->list_head );
+	}
+
+	mx_free( sample_array );
+
+	exit(0);
+
+	MXW_NOT_REACHED( return 0 );
+}
+
@@ -0,0 +1,81 @@
+/*
+ * Name:    mxbench_util.c
+ *
+ * Purpose: Helper functions shared by the mxnetbench and mxadbench
+ *          benchmark programs.
+ *
+ * Author:  William Lavender
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Copyright 2016 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mx_util.h"
+#include "mxbench_util.h"
+
+int
+mxbench_split_list( char *string, char **item_array, int max_items )
+{
+	int num_items;
+	char *ptr;
+
+	num_items = 0;
+
+	while ( num_items < max_items ) {
+		ptr = mx_string_token( &string, "," );
+
+		if ( ptr == NULL )
+			break;
+
+		item_array[num_items] = ptr;
+
+		num_items++;
+	}
+
+	return num_items;
+}
+
+/*------------------------------------------------------------------------*/
+
+int
+mxbench_compare_doubles( const void *ptr1, const void *ptr2 )
+{
+	double value1 = *(const double *) ptr1;
+	double value2 = *(const double *) ptr2;
+
+	if ( value1 < value2 ) {
+		return (-1);
+	} else
+	if ( value1 > value2 ) {
+		return 1;
+	} else {
+		return 0;
+	}
+}
+
+double
+mxbench_percentile( double *sorted_array, unsigned long num_samples,
+			double fraction )
+{
+	unsigned long index;
+
+	if ( num_samples == 0 )
+		return 0.0;
+
+	index = (unsigned long) ( fraction * (double) num_samples );
+
+	if ( index >= num_samples ) {
+		index = num_samples - 1;
+	}
+
+	return sorted_array[index];
+}
+
@@ -0,0 +1,43 @@
+/*
+ * Name:    mxbench_util.h
+ *
+ * Purpose: Helper functions shared by the mxnetbench and mxadbench
+ *          benchmark programs.
+ *
+ * Author:  William Lavender
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Copyright 2016 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#ifndef __MXBENCH_UTIL_H__
+#define __MXBENCH_UTIL_H__
+
+/* mxbench_split_list() splits a comma separated list in place and
+ * returns the number of items found, up to a maximum of 'max_items'.
+ */
+
+extern int mxbench_split_list( char *string,
+				char **item_array, int max_items );
+
+/* mxbench_compare_doubles() is a qsort() comparison function for
+ * arrays of doubles.
+ */
+
+extern int mxbench_compare_doubles( const void *ptr1, const void *ptr2 );
+
+/* mxbench_percentile() returns the requested fraction of the way through
+ * an array of samples that has already been sorted in ascending order.
+ */
+
+extern double mxbench_percentile( double *sorted_array,
+				unsigned long num_samples,
+				double fraction );
+
+#endif /* __MXBENCH_UTIL_H__ */
+
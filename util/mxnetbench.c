@@ -0,0 +1,1028 @@
+/*
+ * Name:    mxnetbench.c
+ *
+ * Purpose: Mxnetbench measures the performance of the MX network protocol
+ *          against a running MX server.  Three kinds of measurement are
+ *          made for each combination of transport (TCP or Unix domain
+ *          socket) and data format (ASCII, RAW, XDR, and RAW with 64-bit
+ *          longs):
+ *
+ *          latency    - the round trip time of mx_get_array() and
+ *                       mx_put_array() for a scalar long.
+ *
+ *          throughput - the number of messages per second that the
+ *                       server handles for 1 to 256 concurrent clients.
+ *
+ *          bandwidth  - the transfer rate of mx_get_array() and
+ *                       mx_put_array() for arrays of 1 KB to 64 MB.
+ *
+ *          The results are written to stdout as comma separated values
+ *          with one line per measurement, so that runs can be compared
+ *          by scripts.  Error messages go to stderr.
+ *
+ *          The server must be running the database in the file
+ *          util/mxnetbench.dat, for example
+ *
+ *            mxserver -p 9727 -u /tmp/mxnetbench.sock \
+ *                      -f mxnetbench.dat -C mxnetbench.acl
+ *
+ * Author:  William Lavender
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Copyright 2016 Illinois Institute of Technology
+ *
+ * See the file "LICENSE" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mx_util.h"
+#include "mx_osdef.h"
+#include "mx_unistd.h"
+#include "mx_record.h"
+#include "mx_hrt.h"
+#include "mx_thread.h"
+#include "mx_net.h"
+
+#include "mxbench_util.h"
+
+#define MXNB_MAX_CLIENTS		256
+#define MXNB_MAX_ITEMS			16
+
+#define MXNB_TRANSPORT_TCP		1
+#define MXNB_TRANSPORT_UNIX		2
+
+#define MXNB_OP_GET			1
+#define MXNB_OP_PUT			2
+
+typedef struct {
+	char name[20];
+	unsigned long flags;
+} MXNB_FORMAT;
+
+static MXNB_FORMAT mxnb_format_list[] = {
+	{ "ascii", MXF_NETWORK_SERVER_USE_ASCII_FORMAT },
+	{ "raw",   MXF_NETWORK_SERVER_USE_RAW_FORMAT },
+	{ "xdr",   MXF_NETWORK_SERVER_USE_XDR_FORMAT },
+	{ "raw64", MXF_NETWORK_SERVER_USE_RAW_FORMAT
+			| MXF_NETWORK_SERVER_USE_64BIT_LONGS },
+};
+
+static int mxnb_num_formats = sizeof( mxnb_format_list )
+				/ sizeof( mxnb_format_list[0] );
+
+/* The command line settings. */
+
+static char mxnb_hostname[ MXU_HOSTNAME_LENGTH+1 ] = "localhost";
+static int mxnb_port = 9727;
+static char mxnb_pathname[ MXU_FILENAME_LENGTH+1 ] = "";
+static unsigned long mxnb_debug_flags = 0;
+static unsigned long mxnb_connect_count = 0;
+
+/* The state of one client during a throughput measurement. */
+
+typedef struct {
+	MX_RECORD *server_record;
+	MX_NETWORK_FIELD nf;
+	MX_THREAD *thread;
+
+	double start_time;
+	double end_time;
+
+	unsigned long num_samples;
+	unsigned long max_samples;
+	double *sample_array;
+	unsigned long num_errors;
+} MXNB_CLIENT;
+
+static void
+print_usage( void )
+{
+	fprintf( stderr,
+"\n"
+"Usage: mxnetbench <options>\n"
+"\n"
+"where the options are:\n"
+"   -a             Enable network debugging.\n"
+"   -b max_bytes   Largest array for the bandwidth test (default 64M).\n"
+"   -c clients     List of client counts for the throughput test\n"
+"                  (default 1,2,4,8,16,32,64,128,256).\n"
+"   -D             Start the source code debugger.\n"
+"   -d seconds     Duration of each throughput measurement (default 2).\n"
+"   -F formats     List of data formats (default ascii,raw,xdr,raw64).\n"
+"                  Available formats are ascii, raw, xdr and raw64.\n"
+"   -H             Do not print the header line.\n"
+"   -n count       Number of round trips for the latency test\n"
+"                  (default 10000).\n"
+"   -p port        TCP port of the MX server (default 9727).\n"
+"   -r count       Number of transfers of each array size for the\n"
+"                  bandwidth test (default 5).\n"
+"   -s hostname    Hostname of the MX server (default localhost).\n"
+"   -T tests       List of tests to run (default latency,throughput,"
+"bandwidth).\n"
+"   -t transports  List of transports (default tcp, plus unix if -u\n"
+"                  is given).\n"
+"   -u pathname    Unix domain socket of the MX server.\n"
+"\n"
+"Lists are separated by commas.  Sizes may end in k or m.\n"
+"\n"
+	);
+}
+
+/*------------------------------------------------------------------------*/
+
+static unsigned long
+mxnb_parse_size( char *string )
+{
+	unsigned long value;
+	char *end_ptr;
+
+	value = strtoul( string, &end_ptr, 0 );
+
+	switch( *end_ptr ) {
+	case 'k':
+	case 'K':
+		value *= 1024L;
+		break;
+	case 'm':
+	case 'M':
+		value *= 1048576L;
+		break;
+	}
+
+	return value;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+mxnb_print_header( void )
+{
+	printf( "test,transport,format,operation,clients,bytes,count,errors,"
+		"seconds,ops_per_sec,mbytes_per_sec,min_us,mean_us,"
+		"p50_us,p90_us,p99_us,p999_us,max_us\n" );
+}
+
+/* mxnb_print_result() writes one line of output.  The times in
+ * 'sample_array' are in seconds and are sorted by this function.
+ */
+
+static void
+mxnb_print_result( char *test_name, int transport, char *format_name,
+			int operation, unsigned long num_clients,
+			unsigned long num_bytes, unsigned long num_errors,
+			double elapsed_seconds,
+			unsigned long num_samples, double *sample_array )
+{
+	double sum, mean, ops_per_sec, mbytes_per_sec;
+	unsigned long i;
+
+	if ( num_samples > 0 ) {
+		qsort( sample_array, num_samples, sizeof(double),
+					mxbench_compare_doubles );
+	}
+
+	sum = 0.0;
+
+	for ( i = 0; i < num_samples; i++ ) {
+		sum += sample_array[i];
+	}
+
+	if ( num_samples > 0 ) {
+		mean = sum / (double) num_samples;
+	} else {
+		mean = 0.0;
+	}
+
+	if ( elapsed_seconds > 0.0 ) {
+		ops_per_sec = (double) num_samples / elapsed_seconds;
+
+		mbytes_per_sec = 1.0e-6 * ops_per_sec * (double) num_bytes;
+	} else {
+		ops_per_sec = 0.0;
+		mbytes_per_sec = 0.0;
+	}
+
+	printf( "%s,%s,%s,%s,%lu,%lu,%lu,%lu,%.6f,%.1f,%.3f,"
+		"%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n",
+		test_name,
+		( transport == MXNB_TRANSPORT_UNIX ) ? "unix" : "tcp",
+		format_name,
+		( operation == MXNB_OP_PUT ) ? "put" : "get",
+		num_clients, num_bytes, num_samples, num_errors,
+		elapsed_seconds, ops_per_sec, mbytes_per_sec,
+		1.0e6 * mxbench_percentile( sample_array, num_samples, 0.0 ),
+		1.0e6 * mean,
+		1.0e6 * mxbench_percentile( sample_array, num_samples, 0.5 ),
+		1.0e6 * mxbench_percentile( sample_array, num_samples, 0.9 ),
+		1.0e6 * mxbench_percentile( sample_array, num_samples, 0.99 ),
+		1.0e6 * mxbench_percentile( sample_array, num_samples, 0.999 ),
+		1.0e6 * mxbench_percentile( sample_array, num_samples, 1.0 ) );
+
+	fflush( stdout );
+}
+
+/*------------------------------------------------------------------------*/
+
+/* Each connection gets an MX database of its own, so that every client
+ * has a separate socket to the server even when all of them use the
+ * same transport and data format.
+ */
+
+static mx_status_type
+mxnb_connect( MX_RECORD **server_record, int transport,
+		MXNB_FORMAT *format )
+{
+	static const char fname[] = "mxnb_connect()";
+
+	MX_RECORD *record_list;
+	MX_LIST_HEAD *list_head_struct;
+	char description[MXU_FILENAME_LENGTH+MXU_HOSTNAME_LENGTH+80];
+	unsigned long server_flags;
+	mx_status_type mx_status;
+
+	record_list = mx_initialize_database();
+
+	if ( record_list == (MX_RECORD *) NULL ) {
+		return mx_error( MXE_FUNCTION_FAILED, fname,
+			"Unable to setup an MX record list." );
+	}
+
+	server_flags = format->flags | mxnb_debug_flags
+			| MXF_NETWORK_SERVER_NO_AUTO_RECONNECT
+			| MXF_NETWORK_SERVER_BLOCKING_IO;
+
+	if ( transport == MXNB_TRANSPORT_UNIX ) {
+		snprintf( description, sizeof(description),
+			"mxnb%lu server network unix_server \"\" \"\" %#lx %s",
+			mxnb_connect_count, server_flags, mxnb_pathname );
+	} else {
+		snprintf( description, sizeof(description),
+		"mxnb%lu server network tcpip_server \"\" \"\" %#lx %s %d",
+			mxnb_connect_count, server_flags,
+			mxnb_hostname, mxnb_port );
+	}
+
+	mxnb_connect_count++;
+
+	mx_status = mx_create_record_from_description( record_list,
+					description, server_record, 0 );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_status = mx_finish_record_initialization( *server_record );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	list_head_struct = mx_get_record_list_head_struct( record_list );
+
+	list_head_struct->list_is_active = TRUE;
+	list_head_struct->fixup_records_in_use = FALSE;
+	list_head_struct->network_debug_flags = mxnb_debug_flags;
+
+	mx_status = mx_open_hardware( *server_record );
+
+	if ( mx_status.code != MXE_SUCCESS )
+		return mx_status;
+
+	mx_status = mx_set_program_name( record_list, "mxnetbench" );
+
+	return mx_status;
+}
+
+static void
+mxnb_disconnect( MX_RECORD *server_record )
+{
+	MX_RECORD *record_list;
+
+	if ( server_record == (MX_RECORD *) NULL )
+		return;
+
+	record_list = server_record->list_head;
+
+	(void) mx_close_hardware( server_record );
+
+	(void) mx_delete_record_list( record_list );
+}
+
+/*------------------------------------------------------------------------*/
+
+/* 'bench_long' is a 1-dimensional array with one element.  The XDR
+ * format requires that the dimensions match those on the server.
+ */
+
+static mx_status_type
+mxnb_scalar_transfer( MX_NETWORK_FIELD *nf, int operation, long *value )
+{
+	long dimension[1] = { 1 };
+	mx_status_type mx_status;
+
+	if ( operation == MXNB_OP_PUT ) {
+		mx_status = mx_put_array( nf, MXFT_LONG, 1, dimension, value );
+	} else {
+		mx_status = mx_get_array( nf, MXFT_LONG, 1, dimension, value );
+	}
+
+	return mx_status;
+}
+
+/*------------------------------------------------------------------------*/
+
+static mx_status_type
+mxnb_latency_test( int transport, MXNB_FORMAT *format,
+			unsigned long num_iterations )
+{
+	static const char fname[] = "mxnb_latency_test()";
+
+	MX_RECORD *server_record;
+	MX_NETWORK_FIELD nf;
+	double *sample_array;
+	double start_time, op_time, end_time;
+	unsigned long i, num_warmups, num_samples, num_errors;
+	long value;
+	int n, operation;
+	mx_status_type mx_status;
+
+	sample_array = malloc( num_iterations * sizeof(double) );
+
+	if ( sample_array == (double *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a %lu element "
+		"latency sample array.", num_iterations );
+	}
+
+	server_record = NULL;
+
+	mx_status = mxnb_connect( &server_record, transport, format );
+
+	if ( mx_status.code == MXE_SUCCESS ) {
+		mx_status = mx_network_field_init( &nf, server_record,
+							"bench_long.value" );
+	}
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mxnb_disconnect( server_record );
+		mx_free( sample_array );
+		return mx_status;
+	}
+
+	num_warmups = num_iterations / 10;
+
+	if ( num_warmups > 100 ) {
+		num_warmups = 100;
+	}
+
+	for ( n = 0; n < 2; n++ ) {
+
+	    if ( n == 0 ) {
+		operation = MXNB_OP_GET;
+	    } else {
+		operation = MXNB_OP_PUT;
+	    }
+
+	    value = 0;
+
+	    for ( i = 0; i < num_warmups; i++ ) {
+		(void) mxnb_scalar_transfer( &nf, operation, &value );
+	    }
+
+	    num_samples = 0;
+	    num_errors = 0;
+
+	    start_time = mx_high_resolution_time_as_double();
+
+	    for ( i = 0; i < num_iterations; i++ ) {
+		value = (long) i;
+
+		op_time = mx_high_resolution_time_as_double();
+
+		mx_status = mxnb_scalar_transfer( &nf, operation, &value );
+
+		end_time = mx_high_resolution_time_as_double();
+
+		if ( mx_status.code == MXE_SUCCESS ) {
+			sample_array[num_samples] = end_time - op_time;
+
+			num_samples++;
+		} else {
+			num_errors++;
+		}
+	    }
+
+	    end_time = mx_high_resolution_time_as_double();
+
+	    mxnb_print_result( "latency", transport, format->name,
+			operation, 1, 0, num_errors, end_time - start_time,
+			num_samples, sample_array );
+	}
+
+	mxnb_disconnect( server_record );
+
+	mx_free( sample_array );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*------------------------------------------------------------------------*/
+
+/* Throughput clients send requests back to back until 'end_time'.
+ * Requests made before 'start_time' warm up the connection and
+ * are not counted.
+ */
+
+static mx_status_type
+mxnb_throughput_thread( MX_THREAD *thread, void *args )
+{
+	MXNB_CLIENT *client;
+	double op_time, now, *new_array;
+	long value;
+	mx_status_type mx_status;
+
+	client = (MXNB_CLIENT *) args;
+
+	value = 0;
+
+	while (1) {
+		op_time = mx_high_resolution_time_as_double();
+
+		if ( op_time >= client->end_time )
+			break;
+
+		mx_status = mxnb_scalar_transfer( &(client->nf),
+						MXNB_OP_GET, &value );
+
+		now = mx_high_resolution_time_as_double();
+
+		if ( op_time < client->start_time )
+			continue;
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			client->num_errors++;
+
+			if ( client->num_errors >= 10 )
+				break;
+
+			continue;
+		}
+
+		if ( client->num_samples >= client->max_samples ) {
+			new_array = realloc( client->sample_array,
+				2 * client->max_samples * sizeof(double) );
+
+			if ( new_array == (double *) NULL ) {
+				client->num_errors++;
+				break;
+			}
+
+			client->sample_array = new_array;
+			client->max_samples *= 2;
+		}
+
+		client->sample_array[ client->num_samples ] = now - op_time;
+
+		client->num_samples++;
+	}
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+static mx_status_type
+mxnb_throughput_test( int transport, MXNB_FORMAT *format,
+			unsigned long num_clients, double duration )
+{
+	static const char fname[] = "mxnb_throughput_test()";
+
+	MXNB_CLIENT *client_array, *client;
+	double start_time, end_time, *sample_array;
+	unsigned long i, num_connected, num_samples, num_errors;
+	long thread_exit_status;
+	mx_status_type mx_status;
+
+	client_array = calloc( num_clients, sizeof(MXNB_CLIENT) );
+
+	if ( client_array == (MXNB_CLIENT *) NULL ) {
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate %lu clients.",
+			num_clients );
+	}
+
+	/* Connect all of the clients before any of them starts, so that
+	 * the time spent connecting is not part of the measurement.
+	 */
+
+	mx_status = MX_SUCCESSFUL_RESULT;
+
+	for ( num_connected = 0; num_connected < num_clients; num_connected++ )
+	{
+		client = &client_array[num_connected];
+
+		client->max_samples = 1024;
+
+		client->sample_array =
+			malloc( client->max_samples * sizeof(double) );
+
+		if ( client->sample_array == (double *) NULL ) {
+			mx_status = mx_error( MXE_OUT_OF_MEMORY, fname,
+			"Ran out of memory trying to allocate a sample "
+			"array for client %lu.", num_connected );
+			break;
+		}
+
+		mx_status = mxnb_connect( &(client->server_record),
+						transport, format );
+
+		if ( mx_status.code == MXE_SUCCESS ) {
+			mx_status = mx_network_field_init( &(client->nf),
+				client->server_record, "bench_long.value" );
+		}
+
+		if ( mx_status.code != MXE_SUCCESS ) {
+			mxnb_disconnect( client->server_record );
+			client->server_record = NULL;
+			break;
+		}
+	}
+
+	if ( mx_status.code == MXE_SUCCESS ) {
+
+		/* Leave time for all of the threads to be created
+		 * before the measurement starts.
+		 */
+
+		start_time = mx_high_resolution_time_as_double()
+				+ 0.1 + 0.002 * (double) num_clients;
+
+		end_time = start_time + duration;
+
+		for ( i = 0; i < num_clients; i++ ) {
+			client = &client_array[i];
+
+			client->start_time = start_time;
+			client->end_time = end_time;
+
+			mx_status = mx_thread_create( &(client->thread),
+					mxnb_throughput_thread, client );
+
+			if ( mx_status.code != MXE_SUCCESS )
+				break;
+		}
+
+		num_samples = 0;
+		num_errors = 0;
+
+		for ( i = 0; i < num_clients; i++ ) {
+			client = &client_array[i];
+
+			if ( client->thread == (MX_THREAD *) NULL ) {
+				num_errors++;
+				continue;
+			}
+
+			(void) mx_thread_wait( client->thread,
+				&thread_exit_status, MX_THREAD_INFINITE_WAIT );
+
+			(void) mx_thread_free_data_structures(
+							client->thread );
+
+			num_samples += client->num_samples;
+			num_errors += client->num_errors;
+		}
+
+		sample_array = malloc( (num_samples + 1) * sizeof(double) );
+
+		if ( sample_array == (double *) NULL ) {
+			mx_status = mx_error( MXE_OUT_OF_MEMORY, fname,
+			"Ran out of memory trying to allocate a %lu element "
+			"throughput sample array.", num_samples );
+		} else {
+			num_samples = 0;
+
+			for ( i = 0; i < num_clients; i++ ) {
+				client = &client_array[i];
+
+				memcpy( sample_array + num_samples,
+					client->sample_array,
+					client->num_samples * sizeof(double) );
+
+				num_samples += client->num_samples;
+			}
+
+			mxnb_print_result( "throughput", transport,
+				format->name, MXNB_OP_GET, num_clients, 0,
+				num_errors, duration,
+				num_samples, sample_array );
+
+			mx_free( sample_array );
+		}
+	}
+
+	for ( i = 0; i < num_clients; i++ ) {
+		client = &client_array[i];
+
+		mxnb_disconnect( client->server_record );
+
+		mx_free( client->sample_array );
+	}
+
+	mx_free( client_array );
+
+	return mx_status;
+}
+
+/*------------------------------------------------------------------------*/
+
+/* The bandwidth test uses the string variables 'bench_bulk_1k' through
+ * 'bench_bulk_64m' from mxnetbench.dat.  The arrays are filled with
+ * non-zero characters, so that every data format must transfer all of
+ * the bytes in the array.
+ */
+
+static mx_status_type
+mxnb_bandwidth_test( int transport, MXNB_FORMAT *format,
+			unsigned long max_bytes, unsigned long num_repeats )
+{
+	static const char fname[] = "mxnb_bandwidth_test()";
+
+	MX_RECORD *server_record;
+	MX_NETWORK_FIELD nf;
+	char record_field_name[MXU_RECORD_FIELD_NAME_LENGTH+1];
+	char *buffer;
+	double *sample_array;
+	double start_time, op_time, end_time;
+	unsigned long num_bytes, i, num_samples, num_errors;
+	long dimension[1];
+	int n, operation;
+	mx_bool_type format_failed;
+	mx_status_type mx_status;
+
+	buffer = malloc( max_bytes );
+
+	sample_array = malloc( num_repeats * sizeof(double) );
+
+	if ( ( buffer == (char *) NULL )
+	  || ( sample_array == (double *) NULL ) )
+	{
+		mx_free( buffer );
+		mx_free( sample_array );
+
+		return mx_error( MXE_OUT_OF_MEMORY, fname,
+		"Ran out of memory trying to allocate a %lu byte "
+		"transfer buffer.", max_bytes );
+	}
+
+	server_record = NULL;
+
+	mx_status = mxnb_connect( &server_record, transport, format );
+
+	if ( mx_status.code != MXE_SUCCESS ) {
+		mxnb_disconnect( server_record );
+		mx_free( buffer );
+		mx_free( sample_array );
+		return mx_status;
+	}
+
+	format_failed = FALSE;
+
+	for ( num_bytes = 1024; num_bytes <= max_bytes; num_bytes *= 4 ) {
+
+	    if ( num_bytes >= 1048576L ) {
+		snprintf( record_field_name, sizeof(record_field_name),
+			"bench_bulk_%lum.value", num_bytes / 1048576L );
+	    } else {
+		snprintf( record_field_name, sizeof(record_field_name),
+			"bench_bulk_%luk.value", num_bytes / 1024L );
+	    }
+
+	    mx_status = mx_network_field_init( &nf, server_record,
+						record_field_name );
+
+	    if ( mx_status.code != MXE_SUCCESS )
+		break;
+
+	    dimension[0] = num_bytes;
+
+	    for ( n = 0; n < 2; n++ ) {
+
+		if ( n == 0 ) {
+			operation = MXNB_OP_PUT;
+		} else {
+			operation = MXNB_OP_GET;
+		}
+
+		num_samples = 0;
+		num_errors = 0;
+
+		start_time = mx_high_resolution_time_as_double();
+
+		for ( i = 0; i < num_repeats; i++ ) {
+
+			if ( operation == MXNB_OP_PUT ) {
+				memset( buffer, 'a' + (int) (i % 26),
+							num_bytes - 1 );
+
+				buffer[num_bytes - 1] = '\0';
+
+				op_time = mx_high_resolution_time_as_double();
+
+				mx_status = mx_put_array( &nf, MXFT_STRING,
+						1, dimension, buffer );
+			} else {
+				buffer[0] = '\0';
+
+				op_time = mx_high_resolution_time_as_double();
+
+				mx_status = mx_get_array( &nf, MXFT_STRING,
+						1, dimension, buffer );
+
+				if ( ( mx_status.code == MXE_SUCCESS )
+				  && ( strlen(buffer) != num_bytes - 1 ) )
+				{
+					mx_status = mx_error(
+					MXE_NETWORK_IO_ERROR, fname,
+					"Only %lu of the %lu bytes in '%s' "
+					"were transferred.",
+						(unsigned long) strlen(buffer),
+						num_bytes, record_field_name );
+				}
+			}
+
+			end_time = mx_high_resolution_time_as_double();
+
+			if ( mx_status.code != MXE_SUCCESS ) {
+				num_errors++;
+				break;
+			}
+
+			sample_array[num_samples] = end_time - op_time;
+
+			num_samples++;
+		}
+
+		end_time = mx_high_resolution_time_as_double();
+
+		mxnb_print_result( "bandwidth", transport, format->name,
+			operation, 1, num_bytes, num_errors,
+			end_time - start_time, num_samples, sample_array );
+
+		/* Formats like ASCII that cannot handle an array of
+		 * this size will not handle the larger ones either.
+		 */
+
+		if ( num_errors > 0 ) {
+			format_failed = TRUE;
+			break;
+		}
+	    }
+
+	    if ( format_failed )
+		break;
+	}
+
+	mxnb_disconnect( server_record );
+
+	mx_free( buffer );
+	mx_free( sample_array );
+
+	return MX_SUCCESSFUL_RESULT;
+}
+
+/*------------------------------------------------------------------------*/
+
+int
+main( int argc, char *argv[] )
+{
+	static const char fname[] = "mxnetbench";
+
+	char format_string[200] = "ascii,raw,xdr,raw64";
+	char client_string[200] = "1,2,4,8,16,32,64,128,256";
+	char test_string[200] = "latency,throughput,bandwidth";
+	char transport_string[200] = "";
+	char *format_item[MXNB_MAX_ITEMS];
+	char *client_item[MXNB_MAX_ITEMS];
+	char *test_item[MXNB_MAX_ITEMS];
+	char *transport_item[MXNB_MAX_ITEMS];
+	int num_format_items, num_client_items;
+	int num_test_items, num_transport_items;
+
+	MXNB_FORMAT *format;
+	unsigned long num_iterations, num_repeats, max_bytes, num_clients;
+	double duration;
+	int c, i, j, k, transport;
+	mx_bool_type start_debugger, print_header;
+	mx_status_type mx_status;
+
+	start_debugger = FALSE;
+	print_header = TRUE;
+	num_iterations = 10000;
+	num_repeats = 5;
+	max_bytes = 64L * 1048576L;
+	duration = 2.0;
+
+	while ( (c = getopt(argc, argv, "ab:c:Dd:F:Hn:p:r:s:T:t:u:")) != -1 )
+	{
+		switch(c) {
+		case 'a':
+			mxnb_debug_flags = MXF_NETDBG_SUMMARY;
+			break;
+		case 'b':
+			max_bytes = mxnb_parse_size( optarg );
+			break;
+		case 'c':
+			strlcpy( client_string, optarg, sizeof(client_string) );
+			break;
+		case 'D':
+			start_debugger = TRUE;
+			break;
+		case 'd':
+			duration = atof( optarg );
+			break;
+		case 'F':
+			strlcpy( format_string, optarg, sizeof(format_string) );
+			break;
+		case 'H':
+			print_header = FALSE;
+			break;
+		case 'n':
+			num_iterations = mxnb_parse_size( optarg );
+			break;
+		case 'p':
+			mxnb_port = atoi( optarg );
+			break;
+		case 'r':
+			num_repeats = mxnb_parse_size( optarg );
+			break;
+		case 's':
+			strlcpy( mxnb_hostname, optarg,
+					sizeof(mxnb_hostname) );
+			break;
+		case 'T':
+			strlcpy( test_string, optarg, sizeof(test_string) );
+			break;
+		case 't':
+			strlcpy( transport_string, optarg,
+					sizeof(transport_string) );
+			break;
+		case 'u':
+			strlcpy( mxnb_pathname, optarg,
+					sizeof(mxnb_pathname) );
+			break;
+		default:
+			print_usage();
+			exit(1);
+			break;
+		}
+	}
+
+	if ( start_debugger ) {
+		mx_breakpoint();
+	}
+
+	if ( strlen( transport_string ) == 0 ) {
+		if ( strlen( mxnb_pathname ) == 0 ) {
+			strlcpy( transport_string, "tcp",
+					sizeof(transport_string) );
+		} else {
+			strlcpy( transport_string, "tcp,unix",
+					sizeof(transport_string) );
+		}
+	}
+
+	if ( ( num_iterations == 0 ) || ( num_repeats == 0 ) ) {
+		mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+		"The number of latency and bandwidth transfers "
+		"must be greater than zero." );
+
+		exit( mx_status.code );
+	}
+
+	num_format_items = mxbench_split_list( format_string,
+					format_item, MXNB_MAX_ITEMS );
+
+	num_client_items = mxbench_split_list( client_string,
+					client_item, MXNB_MAX_ITEMS );
+
+	num_test_items = mxbench_split_list( test_string,
+					test_item, MXNB_MAX_ITEMS );
+
+	num_transport_items = mxbench_split_list( transport_string,
+					transport_item, MXNB_MAX_ITEMS );
+
+	mx_status = mx_initialize_drivers();
+
+	if ( mx_status.code != MXE_SUCCESS )
+		exit( mx_status.code );
+
+	if ( print_header ) {
+		mxnb_print_header();
+	}
+
+	for ( i = 0; i < num_test_items; i++ ) {
+	    for ( j = 0; j < num_transport_items; j++ ) {
+
+		if ( strcmp( transport_item[j], "unix" ) == 0 ) {
+#if HAVE_UNIX_DOMAIN_SOCKETS
+			if ( strlen( mxnb_pathname ) == 0 ) {
+				mx_status = mx_error( MXE_ILLEGAL_ARGUMENT,
+				fname, "The unix transport requires the "
+				"pathname of the server socket (-u)." );
+
+				exit( mx_status.code );
+			}
+
+			transport = MXNB_TRANSPORT_UNIX;
+#else
+			mx_status = mx_error( MXE_UNSUPPORTED, fname,
+			"Unix domain sockets are not supported "
+			"on this system." );
+
+			exit( mx_status.code );
+#endif
+		} else
+		if ( strcmp( transport_item[j], "tcp" ) == 0 ) {
+			transport = MXNB_TRANSPORT_TCP;
+		} else {
+			mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+			"Unrecognized transport '%s'.", transport_item[j] );
+
+			exit( mx_status.code );
+		}
+
+		for ( k = 0; k < num_format_items; k++ ) {
+
+		    format = NULL;
+
+		    for ( c = 0; c < mxnb_num_formats; c++ ) {
+			if ( strcmp( format_item[k],
+					mxnb_format_list[c].name ) == 0 )
+			{
+				format = &mxnb_format_list[c];
+				break;
+			}
+		    }
+
+		    if ( format == (MXNB_FORMAT *) NULL ) {
+			mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+			"Unrecognized data format '%s'.", format_item[k] );
+
+			exit( mx_status.code );
+		    }
+
+		    if ( strcmp( test_item[i], "latency" ) == 0 ) {
+			mx_status = mxnb_latency_test( transport, format,
+							num_iterations );
+		    } else
+		    if ( strcmp( test_item[i], "throughput" ) == 0 ) {
+			for ( c = 0; c < num_client_items; c++ ) {
+			    num_clients = mxnb_parse_size( client_item[c] );
+
+			    if ( ( num_clients == 0 )
+			      || ( num_clients > MXNB_MAX_CLIENTS ) )
+			    {
+				mx_status = mx_error( MXE_ILLEGAL_ARGUMENT,
+				fname, "The number of clients (%lu) must be "
+				"between 1 and %d.", num_clients,
+					MXNB_MAX_CLIENTS );
+
+				exit( mx_status.code );
+			    }
+
+			    mx_status = mxnb_throughput_test( transport,
+					format, num_clients, duration );
+
+			    if ( mx_status.code != MXE_SUCCESS )
+				break;
+			}
+		    } else
+		    if ( strcmp( test_item[i], "bandwidth" ) == 0 ) {
+			mx_status = mxnb_bandwidth_test( transport, format,
+						max_bytes, num_repeats );
+		    } else {
+			mx_status = mx_error( MXE_ILLEGAL_ARGUMENT, fname,
+			"Unrecognized test '%s'.", test_item[i] );
+
+			exit( mx_status.code );
+		    }
+
+		    /* A failure here usually means that the server
+		     * could not be reached, so there is no point in
+		     * going on.
+		     */
+
+		    if ( mx_status.code != MXE_SUCCESS )
+			exit( mx_status.code );
+		}
+	    }
+	}
+
+	exit(0);
+
+	MXW_NOT_REACHED( return 0 );
+}
+